@@ -142,6 +142,9 @@ class ServerSettingsGui;
 class NetworkSettingsGui;
 class LdnSettingsGui;
 class DebugSettingsGui;
+class LinkTestGui;
+class ThreadStatsGui;
+class TrendsGui;
 class HexKeyboardGui;
 
 //=============================================================================
@@ -977,6 +980,439 @@ public:
     }
 };
 
+/**
+ * @brief Link Test GUI
+ *
+ * Runs an on-demand link quality test against the configured server and
+ * shows the results:
+ * - Latency: RTT p50/p95/max and jitter from a ping burst
+ * - Echo: Loss, reordering and throughput of probes echoed by the server
+ * - Hosting: Whether a port mapping works and P2P hosting is possible
+ *
+ * The test runs in the sysmodule; this view only polls the report
+ * (every ~250ms while the test runs). Only available when no game is
+ * using LDN.
+ */
+class LinkTestGui : public tsl::Gui {
+public:
+    virtual tsl::elm::Element* createUI() override {
+        auto frame = new tsl::elm::OverlayFrame("Link Test", g_version);
+        auto list = new tsl::elm::List();
+
+        if (g_initState != InitState::Loaded || !ryuLdnGetService()) {
+            list->addItem(new tsl::elm::ListItem("Service not available"));
+            frame->setContent(list);
+            return frame;
+        }
+
+        m_runItem = new tsl::elm::ListItem("Run Link Test");
+        m_runItem->setValue("Press A");
+        m_runItem->setClickListener([this](u64 keys) {
+            if (keys & HidNpadButton_A) {
+                RyuLdnConfigService* svc = ryuLdnGetService();
+                u32 started = 0;
+                if (svc && R_SUCCEEDED(ryuLdnStartLinkTest(svc, &started)) && started) {
+                    m_runItem->setValue("Running...");
+                }
+                RefreshReport();
+                return true;
+            }
+            return false;
+        });
+        list->addItem(m_runItem);
+
+        m_stateItem = new tsl::elm::ListItem("State");
+        list->addItem(m_stateItem);
+
+        list->addItem(new tsl::elm::CategoryHeader("Latency"));
+        m_rttItem = new tsl::elm::ListItem("RTT p50/p95");
+        list->addItem(m_rttItem);
+        m_rttMaxItem = new tsl::elm::ListItem("RTT max / jitter");
+        list->addItem(m_rttMaxItem);
+        m_pingItem = new tsl::elm::ListItem("Ping replies");
+        list->addItem(m_pingItem);
+
+        list->addItem(new tsl::elm::CategoryHeader("Echo"));
+        m_lossItem = new tsl::elm::ListItem("Lost / Reordered");
+        list->addItem(m_lossItem);
+        m_uploadItem = new tsl::elm::ListItem("Upload");
+        list->addItem(m_uploadItem);
+        m_downloadItem = new tsl::elm::ListItem("Download");
+        list->addItem(m_downloadItem);
+
+        list->addItem(new tsl::elm::CategoryHeader("Hosting"));
+        m_upnpItem = new tsl::elm::ListItem("Port mapping");
+        list->addItem(m_upnpItem);
+        m_p2pItem = new tsl::elm::ListItem("P2P Hosting");
+        list->addItem(m_p2pItem);
+
+        RefreshReport();
+
+        frame->setContent(list);
+        return frame;
+    }
+
+    virtual void update() override {
+        if (!m_running) return;
+
+        m_updateCounter++;
+        if (m_updateCounter >= 15) {  // ~250ms at 60fps
+            m_updateCounter = 0;
+            RefreshReport();
+        }
+    }
+
+private:
+    static const char* ErrorToString(u8 error) {
+        switch (error) {
+            case 1:  return "Connect failed";
+            case 2:  return "Handshake failed";
+            case 3:  return "Connection lost";
+            case 4:  return "Game active";
+            default: return "Failed";
+        }
+    }
+
+    static void FormatUs(char* buf, size_t size, u32 us) {
+        snprintf(buf, size, "%u.%u ms", us / 1000, (us % 1000) / 100);
+    }
+
+    void RefreshReport() {
+        if (!m_stateItem) return;
+
+        RyuLdnConfigService* svc = ryuLdnGetService();
+        RyuLdnLinkTestReport r;
+        if (!svc || R_FAILED(ryuLdnGetLinkTestReport(svc, &r))) {
+            m_stateItem->setValue("Error");
+            m_running = false;
+            return;
+        }
+
+        RyuLdnLinkTestState state = (RyuLdnLinkTestState)r.state;
+        m_running = state != RyuLdnLinkTest_Idle &&
+                    state != RyuLdnLinkTest_Complete &&
+                    state != RyuLdnLinkTest_Failed;
+
+        if (state == RyuLdnLinkTest_Failed) {
+            m_stateItem->setValue(ErrorToString(r.error));
+        } else {
+            m_stateItem->setValue(ryuLdnLinkTestStateToString(state));
+        }
+        m_runItem->setValue(m_running ? "Running..." : "Press A");
+
+        char buf[48];
+        char a[16];
+        char b[16];
+
+        if (r.pings_received > 0) {
+            FormatUs(a, sizeof(a), r.rtt_p50_us);
+            FormatUs(b, sizeof(b), r.rtt_p95_us);
+            snprintf(buf, sizeof(buf), "%s / %s", a, b);
+            m_rttItem->setValue(buf);
+            FormatUs(a, sizeof(a), r.rtt_max_us);
+            FormatUs(b, sizeof(b), r.jitter_us);
+            snprintf(buf, sizeof(buf), "%s / %s", a, b);
+            m_rttMaxItem->setValue(buf);
+        } else {
+            m_rttItem->setValue("-");
+            m_rttMaxItem->setValue("-");
+        }
+        snprintf(buf, sizeof(buf), "%u/%u", r.pings_received, r.pings_sent);
+        m_pingItem->setValue(buf);
+
+        if (r.echo_available) {
+            snprintf(buf, sizeof(buf), "%u / %u of %u", r.echo_lost, r.echo_reordered, r.echo_sent);
+            m_lossItem->setValue(buf);
+            snprintf(buf, sizeof(buf), "%u kbit/s", r.upload_kbps);
+            m_uploadItem->setValue(buf);
+            snprintf(buf, sizeof(buf), "%u kbit/s", r.download_kbps);
+            m_downloadItem->setValue(buf);
+        } else {
+            const char* na = (state == RyuLdnLinkTest_Complete) ? "Unsupported" : "-";
+            m_lossItem->setValue(na);
+            m_uploadItem->setValue(na);
+            m_downloadItem->setValue(na);
+        }
+
+        if (state == RyuLdnLinkTest_Complete) {
+            m_upnpItem->setValue(r.upnp_available ? "Available" : "Unavailable");
+            m_p2pItem->setValue(r.p2p_possible ? "Possible" : "Not possible");
+        } else {
+            m_upnpItem->setValue("-");
+            m_p2pItem->setValue("-");
+        }
+    }
+
+    tsl::elm::ListItem* m_runItem = nullptr;
+    tsl::elm::ListItem* m_stateItem = nullptr;
+    tsl::elm::ListItem* m_rttItem = nullptr;
+    tsl::elm::ListItem* m_rttMaxItem = nullptr;
+    tsl::elm::ListItem* m_pingItem = nullptr;
+    tsl::elm::ListItem* m_lossItem = nullptr;
+    tsl::elm::ListItem* m_uploadItem = nullptr;
+    tsl::elm::ListItem* m_downloadItem = nullptr;
+    tsl::elm::ListItem* m_upnpItem = nullptr;
+    tsl::elm::ListItem* m_p2pItem = nullptr;
+    u32 m_updateCounter = 0;
+    bool m_running = false;
+};
+
+/**
+ * @brief Thread Stats GUI
+ *
+ * Shows the CPU usage and wakeup rate of each sysmodule thread role
+ * (MITM IPC, ldn_bg, P2P threads, config server...), as
+ * "CPU % / wakeups per second". CPU % is relative to one core.
+ *
+ * The sysmodule reports cumulative totals; rates are computed from the
+ * difference between two reads, refreshed every second (60 frames).
+ */
+class ThreadStatsGui : public tsl::Gui {
+public:
+    virtual tsl::elm::Element* createUI() override {
+        auto frame = new tsl::elm::OverlayFrame("Thread Stats", g_version);
+        auto list = new tsl::elm::List();
+
+        if (g_initState != InitState::Loaded || !ryuLdnGetService()) {
+            list->addItem(new tsl::elm::ListItem("Service not available"));
+            frame->setContent(list);
+            return frame;
+        }
+
+        list->addItem(new tsl::elm::CategoryHeader("CPU % / Wakeups per second"));
+        for (u32 i = 0; i < RyuLdnThreadRole_Count; i++) {
+            m_items[i] = new tsl::elm::ListItem(ryuLdnThreadRoleToString((RyuLdnThreadRole)i));
+            list->addItem(m_items[i]);
+        }
+
+        Refresh();
+
+        frame->setContent(list);
+        return frame;
+    }
+
+    virtual void update() override {
+        m_updateCounter++;
+        if (m_updateCounter >= 60) {  // ~1s at 60fps
+            m_updateCounter = 0;
+            Refresh();
+        }
+    }
+
+private:
+    void Refresh() {
+        RyuLdnConfigService* svc = ryuLdnGetService();
+        if (!svc) return;
+
+        char buf[32];
+        for (u32 i = 0; i < RyuLdnThreadRole_Count; i++) {
+            if (!m_items[i]) continue;
+
+            RyuLdnThreadStats stats;
+            if (R_FAILED(ryuLdnGetThreadStats(svc, (RyuLdnThreadRole)i, &stats))) {
+                m_items[i]->setValue("Error");
+                m_hasPrevious[i] = false;
+                continue;
+            }
+
+            if (stats.threads == 0 && stats.wakeups == 0) {
+                m_items[i]->setValue("Not running");
+            } else if (!m_hasPrevious[i] || stats.timestamp_us <= m_previous[i].timestamp_us) {
+                m_items[i]->setValue("...");
+            } else {
+                u64 elapsed_us = stats.timestamp_us - m_previous[i].timestamp_us;
+                u64 cpu_us = stats.cpu_us - m_previous[i].cpu_us;
+                u64 wakeups = stats.wakeups - m_previous[i].wakeups;
+                u32 permille = (u32)(cpu_us * 1000 / elapsed_us);
+                u32 per_second = (u32)(wakeups * 1000000 / elapsed_us);
+                snprintf(buf, sizeof(buf), "%u.%u%% / %u", permille / 10, permille % 10, per_second);
+                m_items[i]->setValue(buf);
+            }
+
+            m_previous[i] = stats;
+            m_hasPrevious[i] = true;
+        }
+    }
+
+    tsl::elm::ListItem* m_items[RyuLdnThreadRole_Count] = {};
+    RyuLdnThreadStats m_previous[RyuLdnThreadRole_Count] = {};
+    bool m_hasPrevious[RyuLdnThreadRole_Count] = {};
+    u32 m_updateCounter = 0;
+};
+
+/**
+ * @brief Trends GUI
+ *
+ * Sparklines of the metrics history kept by the sysmodule: RTT, receive
+ * and send throughput, packet rate, queued bytes and drops. Each bar is
+ * one point; the dim bar is the maximum and the bright bar the average.
+ *
+ * Press A on "Range" to switch between the last 60 seconds and the last
+ * 60 minutes. All series are fetched with one request per second.
+ */
+class TrendsGui : public tsl::Gui {
+public:
+    virtual tsl::elm::Element* createUI() override {
+        auto frame = new tsl::elm::OverlayFrame("Trends", g_version);
+        auto list = new tsl::elm::List();
+
+        if (g_initState != InitState::Loaded || !ryuLdnGetService()) {
+            list->addItem(new tsl::elm::ListItem("Service not available"));
+            frame->setContent(list);
+            return frame;
+        }
+
+        m_rangeItem = new tsl::elm::ListItem("Range");
+        m_rangeItem->setClickListener([this](u64 keys) {
+            if (keys & HidNpadButton_A) {
+                m_resolution = (m_resolution == RyuLdnHistoryResolution_Second)
+                                   ? RyuLdnHistoryResolution_Minute
+                                   : RyuLdnHistoryResolution_Second;
+                Refresh();
+                return true;
+            }
+            return false;
+        });
+        list->addItem(m_rangeItem);
+
+        for (u32 i = 0; i < RyuLdnHistory_Count; i++) {
+            m_items[i] = new tsl::elm::ListItem(SeriesName(i));
+            list->addItem(m_items[i]);
+            list->addItem(new tsl::elm::CustomDrawer([this, i](tsl::gfx::Renderer* renderer,
+                                                               s32 x, s32 y, s32 w, s32 h) {
+                DrawSparkline(renderer, i, x, y, w, h);
+            }), SparklineHeight);
+        }
+
+        Refresh();
+
+        frame->setContent(list);
+        return frame;
+    }
+
+    virtual void update() override {
+        m_updateCounter++;
+        if (m_updateCounter >= 60) {  // ~1s at 60fps
+            m_updateCounter = 0;
+            Refresh();
+        }
+    }
+
+private:
+    static constexpr u32 MaxPoints = 60;
+    static constexpr u16 SparklineHeight = 40;
+
+    static const char* SeriesName(u32 series) {
+        switch (series) {
+            case RyuLdnHistory_RttMs:       return "Server RTT";
+            case RyuLdnHistory_RxBytes:     return "Receive";
+            case RyuLdnHistory_TxBytes:     return "Send";
+            case RyuLdnHistory_Packets:     return "Packets";
+            case RyuLdnHistory_QueuedBytes: return "Queued";
+            case RyuLdnHistory_Drops:       return "Drops";
+            default:                        return "Unknown";
+        }
+    }
+
+    static void FormatValue(char* buf, size_t size, u32 series, u32 value) {
+        switch (series) {
+            case RyuLdnHistory_RttMs:
+                snprintf(buf, size, "%u ms", value);
+                break;
+            case RyuLdnHistory_RxBytes:
+            case RyuLdnHistory_TxBytes:
+                snprintf(buf, size, "%u.%u KB/s", value / 1024, (value % 1024) * 10 / 1024);
+                break;
+            case RyuLdnHistory_QueuedBytes:
+                snprintf(buf, size, "%u B", value);
+                break;
+            default:
+                snprintf(buf, size, "%u/s", value);
+                break;
+        }
+    }
+
+    void Refresh() {
+        RyuLdnConfigService* svc = ryuLdnGetService();
+        if (!svc || !m_rangeItem) return;
+
+        m_rangeItem->setValue(m_resolution == RyuLdnHistoryResolution_Second ? "Last 60 s" : "Last 60 min");
+
+        u32 size = 0;
+        m_count = 0;
+        if (R_FAILED(ryuLdnGetMetricsHistory(svc, m_resolution, MaxPoints, m_buffer, sizeof(m_buffer), &size)) ||
+            size < sizeof(RyuLdnHistoryHeader)) {
+            for (u32 i = 0; i < RyuLdnHistory_Count; i++) {
+                m_items[i]->setValue("Error");
+            }
+            return;
+        }
+
+        RyuLdnHistoryHeader header;
+        memcpy(&header, m_buffer, sizeof(header));
+        m_count = header.point_count;
+        if (m_count > MaxPoints || header.series_count < RyuLdnHistory_Count) {
+            m_count = 0;
+        }
+
+        char buf[32];
+        char peak[16];
+        for (u32 i = 0; i < RyuLdnHistory_Count; i++) {
+            const RyuLdnHistoryPoint* points = Points(i);
+            u32 newest = 0;
+            u32 highest = 0;
+            bool any = false;
+            for (u32 p = 0; p < m_count; p++) {
+                if (points[p].samples == 0) continue;
+                newest = points[p].avg;
+                if (points[p].max > highest) highest = points[p].max;
+                any = true;
+            }
+            if (!any) {
+                m_items[i]->setValue("-");
+                continue;
+            }
+            FormatValue(buf, sizeof(buf), i, newest);
+            FormatValue(peak, sizeof(peak), i, highest);
+            size_t len = strlen(buf);
+            snprintf(buf + len, sizeof(buf) - len, " (max %s)", peak);
+            m_items[i]->setValue(buf);
+        }
+    }
+
+    const RyuLdnHistoryPoint* Points(u32 series) const {
+        return reinterpret_cast<const RyuLdnHistoryPoint*>(m_buffer + sizeof(RyuLdnHistoryHeader)) +
+               series * m_count;
+    }
+
+    void DrawSparkline(tsl::gfx::Renderer* renderer, u32 series, s32 x, s32 y, s32 w, s32 h) {
+        const RyuLdnHistoryPoint* points = Points(series);
+        u32 highest = 0;
+        for (u32 p = 0; p < m_count; p++) {
+            if (points[p].samples > 0 && points[p].max > highest) highest = points[p].max;
+        }
+        if (highest == 0) return;
+
+        const s32 barWidth = w / static_cast<s32>(MaxPoints);
+        const s32 left = x + w - barWidth * static_cast<s32>(m_count);  // Newest point on the right
+        for (u32 p = 0; p < m_count; p++) {
+            if (points[p].samples == 0) continue;
+            s32 barX = left + barWidth * static_cast<s32>(p);
+            s32 maxHeight = static_cast<s32>(static_cast<u64>(points[p].max) * (h - 4) / highest);
+            s32 avgHeight = static_cast<s32>(static_cast<u64>(points[p].avg) * (h - 4) / highest);
+            renderer->drawRect(barX, y + h - 2 - maxHeight, barWidth - 1, maxHeight, tsl::gfx::Color(0x3, 0x7, 0xA, 0xF));
+            renderer->drawRect(barX, y + h - 2 - avgHeight, barWidth - 1, avgHeight, tsl::gfx::Color(0x5, 0xC, 0xF, 0xF));
+        }
+    }
+
+    tsl::elm::ListItem* m_rangeItem = nullptr;
+    tsl::elm::ListItem* m_items[RyuLdnHistory_Count] = {};
+    RyuLdnHistoryResolution m_resolution = RyuLdnHistoryResolution_Second;
+    alignas(8) u8 m_buffer[sizeof(RyuLdnHistoryHeader) + RyuLdnHistory_Count * MaxPoints * sizeof(RyuLdnHistoryPoint)];
+    u32 m_count = 0;
+    u32 m_updateCounter = 0;
+};
+
 //=============================================================================
 // Main GUI
 //=============================================================================
@@ -988,6 +1424,7 @@ public:
  * - Status section: Connection status
  * - Server section: Current server address
  * - Settings section: Links to configuration submenus
+ * - Diagnostics section: Link quality test, thread stats, trends
  * - Config section: Save/reload configuration buttons
  *
  * The status section updates automatically every second (60 frames).
@@ -1118,6 +1555,41 @@ public:
             });
             list->addItem(debugSettingsItem);
 
+            // Diagnostics section - link quality test, thread stats, trends
+            list->addItem(new tsl::elm::CategoryHeader("Diagnostics"));
+            auto linkTestItem = new tsl::elm::ListItem("Link Test");
+            linkTestItem->setValue(">");
+            linkTestItem->setClickListener([](u64 keys) {
+                if (keys & HidNpadButton_A) {
+                    tsl::changeTo<LinkTestGui>();
+                    return true;
+                }
+                return false;
+            });
+            list->addItem(linkTestItem);
+
+            auto threadStatsItem = new tsl::elm::ListItem("Thread Stats");
+            threadStatsItem->setValue(">");
+            threadStatsItem->setClickListener([](u64 keys) {
+                if (keys & HidNpadButton_A) {
+                    tsl::changeTo<ThreadStatsGui>();
+                    return true;
+                }
+                return false;
+            });
+            list->addItem(threadStatsItem);
+
+            auto trendsItem = new tsl::elm::ListItem("Trends");
+            trendsItem->setValue(">");
+            trendsItem->setClickListener([](u64 keys) {
+                if (keys & HidNpadButton_A) {
+                    tsl::changeTo<TrendsGui>();
+                    return true;
+                }
+                return false;
+            });
+            list->addItem(trendsItem);
+
             // Config persistence section - save/reload buttons
             list->addItem(new tsl::elm::CategoryHeader("Config"));
             list->addItem(new SaveConfigListItem());
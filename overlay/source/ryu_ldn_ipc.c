@@ -49,6 +49,16 @@ enum {
     RyuCfgCmd_GetLastRtt          = 26,
     RyuCfgCmd_ForceReconnect      = 27,
     RyuCfgCmd_GetActiveProcessId  = 28,
+
+    // P2P proxy control (29-30)
+    RyuCfgCmd_GetDisableP2p       = 29,
+    RyuCfgCmd_SetDisableP2p       = 30,
+
+    // Diagnostics (31-34)
+    RyuCfgCmd_StartLinkTest       = 31,
+    RyuCfgCmd_GetLinkTestReport   = 32,
+    RyuCfgCmd_GetThreadStats      = 33,
+    RyuCfgCmd_GetMetricsHistory   = 34,
 };
 
 /// Global service handle
@@ -273,3 +283,64 @@ const char* ryuLdnStateToString(RyuLdnState state) {
         default:                             return "Unknown";
     }
 }
+
+//=============================================================================
+// Diagnostics Commands (31-34)
+//=============================================================================
+
+Result ryuLdnStartLinkTest(RyuLdnConfigService* s, u32* started) {
+    return serviceDispatchOut(&s->s, RyuCfgCmd_StartLinkTest, *started);
+}
+
+Result ryuLdnGetLinkTestReport(RyuLdnConfigService* s, RyuLdnLinkTestReport* report) {
+    return serviceDispatchOut(&s->s, RyuCfgCmd_GetLinkTestReport, *report);
+}
+
+const char* ryuLdnLinkTestStateToString(RyuLdnLinkTestState state) {
+    switch (state) {
+        case RyuLdnLinkTest_Idle:            return "Not run";
+        case RyuLdnLinkTest_Connecting:      return "Connecting";
+        case RyuLdnLinkTest_Pinging:         return "Measuring RTT";
+        case RyuLdnLinkTest_CreatingNetwork: return "Preparing echo";
+        case RyuLdnLinkTest_Echoing:         return "Measuring throughput";
+        case RyuLdnLinkTest_Probing:         return "Checking UPnP";
+        case RyuLdnLinkTest_Complete:        return "Complete";
+        case RyuLdnLinkTest_Failed:          return "Failed";
+        default:                             return "Unknown";
+    }
+}
+
+Result ryuLdnGetThreadStats(RyuLdnConfigService* s, RyuLdnThreadRole role, RyuLdnThreadStats* stats) {
+    u32 in = (u32)role;
+    return serviceDispatchInOut(&s->s, RyuCfgCmd_GetThreadStats, in, *stats);
+}
+
+const char* ryuLdnThreadRoleToString(RyuLdnThreadRole role) {
+    switch (role) {
+        case RyuLdnThreadRole_MitmIpc:        return "MITM IPC";
+        case RyuLdnThreadRole_LdnBackground:  return "ldn_bg";
+        case RyuLdnThreadRole_P2pAccept:      return "P2P accept";
+        case RyuLdnThreadRole_P2pSession:     return "P2P sessions";
+        case RyuLdnThreadRole_P2pLease:       return "P2P lease";
+        case RyuLdnThreadRole_P2pClient:      return "P2P client";
+        case RyuLdnThreadRole_ConfigServer:   return "Config server";
+        case RyuLdnThreadRole_LogMaintenance: return "Log maintenance";
+        case RyuLdnThreadRole_NacpCache:      return "NACP cache";
+        case RyuLdnThreadRole_PortMapping:    return "Port mapping";
+        case RyuLdnThreadRole_LinkTest:       return "Link test";
+        default:                              return "Unknown";
+    }
+}
+
+Result ryuLdnGetMetricsHistory(RyuLdnConfigService* s, RyuLdnHistoryResolution resolution,
+                               u32 max_points, void* buffer, size_t size, u32* out_size) {
+    const struct {
+        u32 resolution;
+        u32 max_points;
+    } in = { (u32)resolution, max_points };
+
+    return serviceDispatchInOut(&s->s, RyuCfgCmd_GetMetricsHistory, in, *out_size,
+        .buffer_attrs = { SfBufferAttr_HipcMapAlias | SfBufferAttr_Out },
+        .buffers = { { buffer, size } },
+    );
+}
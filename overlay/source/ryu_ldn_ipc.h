@@ -41,6 +41,12 @@
  * | 26 | GetLastRtt         | Get last measured RTT (ms)        |
  * | 27 | ForceReconnect     | Request MITM to reconnect         |
  * | 28 | GetActiveProcessId | Get PID of active game (debug)    |
+ * | 29 | GetDisableP2p      | Check if P2P proxy is disabled    |
+ * | 30 | SetDisableP2p      | Toggle P2P proxy                  |
+ * | 31 | StartLinkTest      | Start a link quality test         |
+ * | 32 | GetLinkTestReport  | Get link test progress/result     |
+ * | 33 | GetThreadStats     | Get CPU time/wakeups of a thread  |
+ * | 34 | GetMetricsHistory  | Get metrics time series (buffer)  |
  *
  * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
  * @license GPL-2.0-or-later
@@ -92,6 +98,140 @@ typedef struct {
     u8 reserved[4];     ///< Reserved for future use
 } RyuLdnSessionInfo;
 
+/**
+ * @brief Link test phase
+ *
+ * Mirrors the LinkTestState enum from the sysmodule.
+ */
+typedef enum {
+    RyuLdnLinkTest_Idle = 0,            ///< Never run
+    RyuLdnLinkTest_Connecting = 1,      ///< Connecting to the server
+    RyuLdnLinkTest_Pinging = 2,         ///< Measuring round-trip time
+    RyuLdnLinkTest_CreatingNetwork = 3, ///< Creating the echo network
+    RyuLdnLinkTest_Echoing = 4,         ///< Measuring throughput and loss
+    RyuLdnLinkTest_Probing = 5,         ///< Checking port mapping / P2P
+    RyuLdnLinkTest_Complete = 6,        ///< Results are final
+    RyuLdnLinkTest_Failed = 7,          ///< Test failed, see error
+} RyuLdnLinkTestState;
+
+/**
+ * @brief Link test report
+ *
+ * Must match LinkTestReportIpc in the sysmodule (76 bytes).
+ */
+typedef struct {
+    u8 state;               ///< RyuLdnLinkTestState
+    u8 error;               ///< 1=Connect failed, 2=Handshake failed, 3=Connection lost, 4=Busy
+    u8 echo_available;      ///< 1 if the server echoed the probes
+    u8 upnp_available;      ///< 1 if a port mapping (UPnP or NAT-PMP/PCP) could be created
+    u8 p2p_possible;        ///< 1 if P2P hosting looks possible
+    u8 reserved[3];         ///< Padding
+
+    u32 pings_sent;         ///< Pings sent
+    u32 pings_received;     ///< Ping replies received
+    u32 rtt_min_us;         ///< Smallest RTT
+    u32 rtt_avg_us;         ///< Mean RTT
+    u32 rtt_p50_us;         ///< Median RTT
+    u32 rtt_p95_us;         ///< 95th percentile RTT
+    u32 rtt_p99_us;         ///< 99th percentile RTT
+    u32 rtt_max_us;         ///< Largest RTT
+    u32 jitter_us;          ///< Mean difference of consecutive RTTs
+
+    u32 echo_sent;          ///< Echo probes sent
+    u32 echo_received;      ///< Distinct probes echoed back
+    u32 echo_lost;          ///< Probes never echoed
+    u32 echo_reordered;     ///< Probes arriving out of order
+    u32 echo_duplicated;    ///< Probes echoed more than once
+    u32 upload_kbps;        ///< Upstream throughput (kbit/s)
+    u32 download_kbps;      ///< Downstream throughput (kbit/s)
+
+    u32 duration_ms;        ///< Total test duration
+} RyuLdnLinkTestReport;
+
+/**
+ * @brief Sysmodule thread role
+ *
+ * Mirrors the ThreadRole enum from the sysmodule.
+ */
+typedef enum {
+    RyuLdnThreadRole_MitmIpc = 0,           ///< ldn:u / bsd:u MITM server threads
+    RyuLdnThreadRole_LdnBackground = 1,     ///< Server client update, pings
+    RyuLdnThreadRole_P2pAccept = 2,         ///< P2P host listener
+    RyuLdnThreadRole_P2pSession = 3,        ///< P2P host, one per guest
+    RyuLdnThreadRole_P2pLease = 4,          ///< Port mapping renewal
+    RyuLdnThreadRole_P2pClient = 5,         ///< P2P guest receive thread
+    RyuLdnThreadRole_ConfigServer = 6,      ///< ryu:cfg server thread
+    RyuLdnThreadRole_LogMaintenance = 7,    ///< Log file idle timeout
+    RyuLdnThreadRole_NacpCache = 8,         ///< NACP cache refresh
+    RyuLdnThreadRole_PortMapping = 9,       ///< UPnP discovery
+    RyuLdnThreadRole_LinkTest = 10,         ///< Link quality test worker
+    RyuLdnThreadRole_Count = 11,
+} RyuLdnThreadRole;
+
+/**
+ * @brief CPU time and wakeups of one thread role
+ *
+ * Must match ThreadStatsIpc in the sysmodule (32 bytes). Values are
+ * cumulative since boot; rates come from the difference of two reads.
+ */
+typedef struct {
+    u64 cpu_us;             ///< CPU time of all threads of the role
+    u64 wakeups;            ///< Wakeups of all threads of the role
+    u64 timestamp_us;       ///< System tick at the time of the read
+    u32 threads;            ///< Threads of the role currently running
+    u32 reserved;           ///< Padding
+} RyuLdnThreadStats;
+
+/**
+ * @brief Metrics history series
+ *
+ * Mirrors the HistorySeries enum from the sysmodule.
+ */
+typedef enum {
+    RyuLdnHistory_RttMs = 0,        ///< Server round-trip time (ms)
+    RyuLdnHistory_RxBytes = 1,      ///< Proxy bytes received per second
+    RyuLdnHistory_TxBytes = 2,      ///< Proxy bytes sent per second
+    RyuLdnHistory_Packets = 3,      ///< Proxy packets per second
+    RyuLdnHistory_QueuedBytes = 4,  ///< Bytes waiting in proxy socket queues
+    RyuLdnHistory_Drops = 5,        ///< Dropped packets per second
+    RyuLdnHistory_Count = 6,
+} RyuLdnHistorySeries;
+
+/**
+ * @brief Metrics history resolution
+ */
+typedef enum {
+    RyuLdnHistoryResolution_Second = 0,    ///< Last 10 minutes
+    RyuLdnHistoryResolution_Minute = 1,    ///< Last 3 hours
+} RyuLdnHistoryResolution;
+
+/**
+ * @brief Header of the GetMetricsHistory buffer
+ *
+ * Must match HistoryHeader in the sysmodule (16 bytes). It is followed by
+ * series_count blocks of point_count RyuLdnHistoryPoint, oldest first.
+ */
+typedef struct {
+    u8 resolution;          ///< RyuLdnHistoryResolution
+    u8 series_count;        ///< Number of series blocks
+    u16 point_count;        ///< Points per series
+    u32 interval_s;         ///< Seconds per point (1 or 60)
+    u64 newest_time_s;      ///< Uptime at the end of the newest point
+} RyuLdnHistoryHeader;
+
+/**
+ * @brief Rollup of one series over one interval
+ *
+ * Must match HistoryPoint in the sysmodule (20 bytes).
+ */
+typedef struct {
+    u32 min;
+    u32 avg;
+    u32 max;
+    u32 p99;
+    u32 samples;            ///< 0 = no data for this interval
+} RyuLdnHistoryPoint;
+
 /**
  * @brief Configuration service handle
  */
@@ -409,6 +549,66 @@ Result ryuLdnGetActiveProcessId(RyuLdnConfigService* s, u64* pid);
  */
 const char* ryuLdnStateToString(RyuLdnState state);
 
+/**
+ * @brief Start a link quality test
+ *
+ * Refused while a game is using LDN or another test is running.
+ *
+ * @param s Configuration service
+ * @param started Output: 1 if the test was started, 0 otherwise
+ * @return Result code
+ */
+Result ryuLdnStartLinkTest(RyuLdnConfigService* s, u32* started);
+
+/**
+ * @brief Get link test progress or result
+ *
+ * @param s Configuration service
+ * @param report Output report
+ * @return Result code
+ */
+Result ryuLdnGetLinkTestReport(RyuLdnConfigService* s, RyuLdnLinkTestReport* report);
+
+/**
+ * @brief Convert link test state to human-readable string
+ *
+ * @param state Link test state value
+ * @return Static string describing the state
+ */
+const char* ryuLdnLinkTestStateToString(RyuLdnLinkTestState state);
+
+/**
+ * @brief Get the CPU time and wakeups of one thread role
+ *
+ * @param s Configuration service
+ * @param role Thread role
+ * @param stats Output totals
+ * @return Result code
+ */
+Result ryuLdnGetThreadStats(RyuLdnConfigService* s, RyuLdnThreadRole role, RyuLdnThreadStats* stats);
+
+/**
+ * @brief Convert thread role to a short display name
+ *
+ * @param role Thread role value
+ * @return Static string naming the role
+ */
+const char* ryuLdnThreadRoleToString(RyuLdnThreadRole role);
+
+/**
+ * @brief Get the metrics time series in one call
+ *
+ * @param s Configuration service
+ * @param resolution Per-second or per-minute points
+ * @param max_points Newest points wanted per series
+ * @param buffer Output: RyuLdnHistoryHeader followed by the points
+ * @param size Buffer size; fewer points are returned if it is too small
+ * @param out_size Output: bytes written
+ * @return Result code
+ */
+Result ryuLdnGetMetricsHistory(RyuLdnConfigService* s, RyuLdnHistoryResolution resolution,
+                               u32 max_points, void* buffer, size_t size, u32* out_size);
+
 #ifdef __cplusplus
 }
 #endif
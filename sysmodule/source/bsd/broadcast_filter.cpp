@@ -0,0 +1,111 @@
+/**
+ * @file broadcast_filter.cpp
+ * @brief Implementation of the broadcast repeat filter
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "broadcast_filter.hpp"
+
+namespace ams::mitm::bsd {
+
+BroadcastFilter::BroadcastFilter()
+    : m_config{}
+    , m_stats{}
+    , m_flows{}
+{
+}
+
+void BroadcastFilter::Configure(const BroadcastFilterConfig& config) {
+    std::scoped_lock lock(m_mutex);
+    m_config = config;
+    m_enabled.store(config.enabled, std::memory_order_relaxed);
+    for (auto& flow : m_flows) {
+        flow.used = false;
+    }
+}
+
+uint64_t BroadcastFilter::Fingerprint(const void* data, size_t data_len) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < data_len; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+BroadcastFilter::Flow* BroadcastFilter::FindFlow(uint16_t source_port, uint16_t dest_port, bool& created) {
+    // Caller must hold m_mutex
+    Flow* oldest = &m_flows[0];
+    for (auto& flow : m_flows) {
+        if (flow.used && flow.source_port == source_port && flow.dest_port == dest_port) {
+            created = false;
+            return &flow;
+        }
+        if (!flow.used) {
+            oldest = &flow;
+        } else if (oldest->used && flow.last_seen_ms < oldest->last_seen_ms) {
+            oldest = &flow;
+        }
+    }
+
+    created = true;
+    *oldest = Flow{};
+    oldest->source_port = source_port;
+    oldest->dest_port = dest_port;
+    oldest->used = true;
+    return oldest;
+}
+
+bool BroadcastFilter::ShouldSuppress(uint16_t source_port, uint32_t dest_ip, uint16_t dest_port,
+                                     ryu_ldn::bsd::ProtocolType protocol,
+                                     const void* data, size_t data_len, uint64_t now_ms) {
+    // Off by default: no hashing and no lock on the send path
+    if (!m_enabled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (protocol != ryu_ldn::bsd::ProtocolType::Udp || !ryu_ldn::bsd::IsBroadcastAddress(dest_ip)) {
+        return false;
+    }
+
+    // Hash outside the lock, payloads are small but senders are many
+    uint64_t fingerprint = Fingerprint(data, data_len);
+
+    // Configure() may have disabled it meanwhile
+    std::scoped_lock lock(m_mutex);
+    if (!m_config.enabled) {
+        return false;
+    }
+
+    bool created;
+    Flow* flow = FindFlow(source_port, dest_port, created);
+
+    bool repeat = !created &&
+                  flow->fingerprint == fingerprint &&
+                  flow->length == data_len &&
+                  now_ms - flow->last_seen_ms < m_config.window_ms;
+    flow->last_seen_ms = now_ms;
+
+    if (repeat && now_ms - flow->last_sent_ms < m_config.keepalive_ms) {
+        m_stats.suppressed_packets++;
+        m_stats.suppressed_bytes += data_len;
+        return true;
+    }
+
+    if (repeat) {
+        m_stats.keepalives_sent++;
+    }
+    flow->fingerprint = fingerprint;
+    flow->length = static_cast<uint32_t>(data_len);
+    flow->last_sent_ms = now_ms;
+    return false;
+}
+
+BroadcastFilterStats BroadcastFilter::GetStats() const {
+    std::scoped_lock lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace ams::mitm::bsd
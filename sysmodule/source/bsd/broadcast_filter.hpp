@@ -0,0 +1,136 @@
+/**
+ * @file broadcast_filter.hpp
+ * @brief Upstream suppression of repeated broadcast datagrams
+ *
+ * In lobbies many games broadcast the same discovery/advertisement datagram
+ * to 10.114.255.255 every frame. The master server fans each copy out to
+ * every player, so identical repeats multiply server and uplink load
+ * without telling anyone anything new.
+ *
+ * ## Rule
+ *
+ * Broadcast UDP payloads are fingerprinted per (source port, dest port):
+ *
+ * - A payload different from the previous one on the flow is always sent.
+ * - A byte-identical repeat arriving within `window_ms` of the previous copy
+ *   is dropped, unless `keepalive_ms` have passed since the last copy that
+ *   was sent: peers still see the advertisement at that rate.
+ * - A repeat after a longer silence than `window_ms` is sent (the game
+ *   resumed advertising).
+ *
+ * Unicast traffic and TCP are never touched. The fingerprint is a 64-bit
+ * FNV-1a hash plus the length, so a false match needs a hash collision
+ * between two consecutive payloads of the same flow and size.
+ *
+ * Off by default (`[ldn] broadcast_dedup = 1` enables it): peers see the
+ * advertisement at the keepalive rate instead of the game's own cadence,
+ * which not every title tolerates.
+ *
+ * ## Thread Safety
+ *
+ * All methods are thread-safe: games send from several threads.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "../platform/platform.hpp"
+#include "bsd_types.hpp"
+
+namespace ams::mitm::bsd {
+
+/**
+ * @brief Broadcast flows tracked at once (oldest is recycled)
+ */
+constexpr size_t BROADCAST_FILTER_MAX_FLOWS = 16;
+
+/**
+ * @brief Filter options
+ */
+struct BroadcastFilterConfig {
+    bool     enabled;        ///< Suppress repeats (off: everything is sent)
+    uint32_t window_ms;      ///< Max gap between two copies of the same repeat stream
+    uint32_t keepalive_ms;   ///< Min rate at which a repeated payload is still sent
+};
+
+/**
+ * @brief Filter counters
+ */
+struct BroadcastFilterStats {
+    uint64_t suppressed_packets;
+    uint64_t suppressed_bytes;
+    uint64_t keepalives_sent;
+};
+
+/**
+ * @brief Per-flow fingerprint filter for outgoing broadcast datagrams
+ */
+class BroadcastFilter {
+public:
+    BroadcastFilter();
+
+    /**
+     * @brief Apply options and forget every flow
+     */
+    void Configure(const BroadcastFilterConfig& config);
+
+    /**
+     * @brief Decide whether one outgoing datagram must be dropped
+     *
+     * @param source_port Source port (host byte order)
+     * @param dest_ip Destination IP (host byte order)
+     * @param dest_port Destination port (host byte order)
+     * @param protocol Protocol type
+     * @param data Payload
+     * @param data_len Payload length
+     * @param now_ms Monotonic time
+     * @return true if the datagram is a repeat to drop
+     */
+    bool ShouldSuppress(uint16_t source_port, uint32_t dest_ip, uint16_t dest_port,
+                        ryu_ldn::bsd::ProtocolType protocol,
+                        const void* data, size_t data_len, uint64_t now_ms);
+
+    /**
+     * @brief Snapshot of the counters
+     */
+    BroadcastFilterStats GetStats() const;
+
+    /**
+     * @brief 64-bit FNV-1a of a payload
+     */
+    static uint64_t Fingerprint(const void* data, size_t data_len);
+
+private:
+    struct Flow {
+        uint16_t source_port;
+        uint16_t dest_port;
+        uint32_t length;
+        uint64_t fingerprint;
+        uint64_t last_seen_ms;
+        uint64_t last_sent_ms;
+        bool     used;
+    };
+
+    /**
+     * @brief Find or recycle the entry of a flow (m_mutex held)
+     */
+    Flow* FindFlow(uint16_t source_port, uint16_t dest_port, bool& created);
+
+    mutable ryu_ldn::platform::Mutex m_mutex;
+    BroadcastFilterConfig m_config;
+
+    /**
+     * @brief Copy of m_config.enabled, read without m_mutex on every send
+     */
+    std::atomic<bool> m_enabled{false};
+
+    BroadcastFilterStats m_stats;
+    Flow m_flows[BROADCAST_FILTER_MAX_FLOWS];
+};
+
+} // namespace ams::mitm::bsd
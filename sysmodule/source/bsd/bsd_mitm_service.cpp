@@ -49,9 +49,12 @@
 
 #include "bsd_mitm_service.hpp"
 #include "proxy_socket_manager.hpp"
+#include "proxy_readiness.hpp"
 #include "bsd_types.hpp"
 #include "../debug/log.hpp"
 #include "../ldn/ldn_shared_state.hpp"
+#include "../diagnostics/ipc_recorder.hpp"
+#include "../diagnostics/flight_recorder.hpp"
 
 // Atmosphere MITM dispatch macros for IPC forwarding
 #include <stratosphere/sf/sf_mitm_dispatch.h>
@@ -92,6 +95,45 @@ struct SocketInfo {
  */
 static std::unordered_map<s32, SocketInfo> g_socket_info;
 
+// =============================================================================
+// IPC Recording
+// =============================================================================
+
+/**
+ * @brief Record this bsd:u command into the IPC trace (see ipc_recorder.hpp)
+ * and the flight recorder (see flight_recorder.hpp)
+ */
+#define BSD_IPC_RECORD(command, fd) \
+    ryu_ldn::diagnostics::ScopedIpcRecord ipc_record( \
+        ryu_ldn::diagnostics::IpcService::Bsd, ryu_ldn::diagnostics::bsd_cmd::command, fd); \
+    ryu_ldn::diagnostics::ScopedFlightIpc ipc_flight( \
+        static_cast<uint8_t>(ryu_ldn::diagnostics::IpcService::Bsd), ryu_ldn::diagnostics::bsd_cmd::command, \
+        BsdCallMayBlock(ryu_ldn::diagnostics::bsd_cmd::command))
+
+/**
+ * @brief Commands that wait for the network: their duration is no IPC latency
+ */
+static constexpr bool BsdCallMayBlock(u16 command) {
+    namespace cmd = ryu_ldn::diagnostics::bsd_cmd;
+    return command == cmd::Recv || command == cmd::RecvFrom || command == cmd::Select ||
+           command == cmd::Poll || command == cmd::Connect;
+}
+
+/**
+ * @brief Select() timeout in ms for the IPC trace (-1 = no timeout)
+ */
+static s32 TimevalToMs(const void* timeval, size_t size) {
+    struct {
+        s64 tv_sec;
+        s64 tv_usec;
+    } tv;
+    if (timeval == nullptr || size < sizeof(tv)) {
+        return -1;
+    }
+    std::memcpy(&tv, timeval, sizeof(tv));
+    return static_cast<s32>(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
 // =============================================================================
 // Constructor / Destructor
 // =============================================================================
@@ -339,6 +381,10 @@ Result BsdMitmService::Socket(
 {
     LOG_VERBOSE("BSD Socket domain=%d type=%d protocol=%d", domain, type, protocol);
 
+    BSD_IPC_RECORD(Socket, -1);
+    ipc_record.set_args(type, protocol);
+    ipc_record.watch(out_fd.GetPointer(), out_errno.GetPointer());
+
     struct {
         s32 domain;
         s32 type;
@@ -527,6 +573,9 @@ Result BsdMitmService::Close(
 {
     LOG_VERBOSE("BSD Close fd=%d", fd);
 
+    BSD_IPC_RECORD(Close, fd);
+    ipc_record.watch(nullptr, out_errno.GetPointer());
+
     // Check if this is a proxy socket
     auto it = g_socket_info.find(fd);
     if (it != g_socket_info.end()) {
@@ -641,6 +690,10 @@ Result BsdMitmService::Bind(
 {
     LOG_VERBOSE("BSD Bind fd=%d addr_size=%zu", fd, addr.GetSize());
 
+    BSD_IPC_RECORD(Bind, fd);
+    ipc_record.set_sockaddr(addr.GetPointer(), addr.GetSize());
+    ipc_record.watch(nullptr, out_errno.GetPointer());
+
     // Check if this is an LDN address (10.114.x.x)
     if (addr.GetSize() >= sizeof(ryu_ldn::bsd::SockAddrIn)) {
         const auto* sock_addr = reinterpret_cast<const ryu_ldn::bsd::SockAddrIn*>(addr.GetPointer());
@@ -665,7 +718,7 @@ Result BsdMitmService::Bind(
             } else {
                 // Create proxy socket
                 auto& manager = ProxySocketManager::GetInstance();
-                ProxySocket* proxy = manager.CreateProxySocket(fd, it->second.type, it->second.protocol);
+                std::shared_ptr<ProxySocket> proxy = manager.CreateProxySocket(fd, it->second.type, it->second.protocol);
 
                 if (proxy != nullptr) {
                     // Handle ephemeral port (port 0)
@@ -763,6 +816,10 @@ Result BsdMitmService::Connect(
 {
     LOG_VERBOSE("BSD Connect fd=%d addr_size=%zu", fd, addr.GetSize());
 
+    BSD_IPC_RECORD(Connect, fd);
+    ipc_record.set_sockaddr(addr.GetPointer(), addr.GetSize());
+    ipc_record.watch(nullptr, out_errno.GetPointer());
+
     // Check if this is an LDN address (10.114.x.x)
     if (addr.GetSize() >= sizeof(ryu_ldn::bsd::SockAddrIn)) {
         const auto* sock_addr = reinterpret_cast<const ryu_ldn::bsd::SockAddrIn*>(addr.GetPointer());
@@ -788,7 +845,7 @@ Result BsdMitmService::Connect(
                 auto& manager = ProxySocketManager::GetInstance();
 
                 // Check if we already have a proxy socket (from Bind)
-                ProxySocket* proxy = manager.GetProxySocket(fd);
+                std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
 
                 // If not bound yet, create one and auto-bind
                 if (proxy == nullptr) {
@@ -876,6 +933,14 @@ Result BsdMitmService::Connect(
  *   [0x22] Type-0x22 buffer (sockaddr, auto-select)
  * ```
  *
+ * ## LDN Proxy
+ *
+ * On a listening proxy socket, the connection comes from the backlog of
+ * ProxyConnect requests. The game still needs a real fd for it (Close and
+ * the calls we don't proxy are forwarded), so an unconnected TCP socket is
+ * created on the real service and the accepted proxy socket is registered
+ * under its fd.
+ *
  * @param[out] out_errno BSD errno
  * @param[out] out_fd New socket for accepted connection
  * @param[in] fd Listening socket
@@ -890,6 +955,80 @@ Result BsdMitmService::Accept(
 {
     LOG_VERBOSE("BSD Accept fd=%d", fd);
 
+    auto it = g_socket_info.find(fd);
+    if (it != g_socket_info.end() && it->second.is_proxy) {
+        auto& manager = ProxySocketManager::GetInstance();
+        std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
+
+        if (proxy != nullptr) {
+            out_fd.SetValue(-1);
+            if (proxy->GetState() != ProxySocketState::Listening) {
+                out_errno.SetValue(static_cast<s32>(ryu_ldn::bsd::BsdErrno::Inval));
+                R_SUCCEED();
+            }
+            auto listener = std::static_pointer_cast<ListenerProxySocket>(proxy);
+
+            // Blocks like accept() unless the listener is non-blocking
+            ryu_ldn::bsd::SockAddrIn peer{};
+            std::unique_ptr<StreamProxySocket> accepted = listener->Accept(&peer);
+            if (accepted == nullptr) {
+                out_errno.SetValue(static_cast<s32>(listener->GetState() == ProxySocketState::Listening
+                                                         ? ryu_ldn::bsd::BsdErrno::Again
+                                                         : ryu_ldn::bsd::BsdErrno::Inval));
+                R_SUCCEED();
+            }
+
+            // Real fd backing the connection
+            struct {
+                s32 domain;
+                s32 type;
+                s32 protocol;
+            } in = {
+                static_cast<s32>(ryu_ldn::bsd::AddressFamily::Inet),
+                static_cast<s32>(ryu_ldn::bsd::SocketType::Stream),
+                static_cast<s32>(ryu_ldn::bsd::ProtocolType::Tcp),
+            };
+            struct {
+                s32 errno_val;
+                s32 fd;
+            } created = {};
+            Result rc = serviceMitmDispatchInOut(m_forward_service.get(), 2, in, created);
+            if (R_FAILED(rc) || created.errno_val != 0 || created.fd < 0) {
+                LOG_ERROR("BSD Accept fd=%d no fd for the connection: rc=0x%x errno=%d",
+                          fd, rc.GetValue(), created.errno_val);
+                accepted->Close();
+                out_errno.SetValue(created.errno_val != 0 ? created.errno_val
+                                                          : static_cast<s32>(ryu_ldn::bsd::BsdErrno::MFile));
+                R_SUCCEED();
+            }
+
+            if (manager.RegisterAcceptedSocket(created.fd, std::move(accepted)) == nullptr) {
+                LOG_ERROR("BSD Accept fd=%d failed to register the connection", fd);
+                s32 close_errno = 0;
+                Result close_rc = serviceMitmDispatchInOut(m_forward_service.get(), 26, created.fd, close_errno);
+                AMS_UNUSED(close_rc);
+                out_errno.SetValue(static_cast<s32>(ryu_ldn::bsd::BsdErrno::NoMem));
+                R_SUCCEED();
+            }
+
+            g_socket_info[created.fd] = SocketInfo{
+                .type = ryu_ldn::bsd::SocketType::Stream,
+                .protocol = ryu_ldn::bsd::ProtocolType::Tcp,
+                .is_proxy = true,
+            };
+
+            if (addr_out.GetSize() >= sizeof(ryu_ldn::bsd::SockAddrIn)) {
+                std::memcpy(addr_out.GetPointer(), &peer, sizeof(ryu_ldn::bsd::SockAddrIn));
+            }
+
+            LOG_INFO("BSD Accept fd=%d -> fd=%d LDN proxy peer %08x:%d",
+                     fd, created.fd, peer.GetAddr(), peer.GetPort());
+            out_errno.SetValue(0);
+            out_fd.SetValue(created.fd);
+            R_SUCCEED();
+        }
+    }
+
     struct {
         s32 errno_val;
         s32 new_fd;
@@ -941,7 +1080,7 @@ Result BsdMitmService::GetPeerName(
 
     // Check if this is a proxy socket
     auto& manager = ProxySocketManager::GetInstance();
-    ProxySocket* proxy = manager.GetProxySocket(fd);
+    std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
     if (proxy != nullptr) {
         // Return the stored LDN peer address
         const auto& peer_addr = proxy->GetRemoteAddr();
@@ -1003,7 +1142,7 @@ Result BsdMitmService::GetSockName(
 
     // Check if this is a proxy socket
     auto& manager = ProxySocketManager::GetInstance();
-    ProxySocket* proxy = manager.GetProxySocket(fd);
+    std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
     if (proxy != nullptr) {
         // Return the stored LDN local address
         const auto& local_addr = proxy->GetLocalAddr();
@@ -1079,11 +1218,16 @@ Result BsdMitmService::Send(
 {
     LOG_VERBOSE("BSD Send fd=%d flags=%d size=%zu", fd, flags, buffer.GetSize());
 
+    BSD_IPC_RECORD(Send, fd);
+    ipc_record.set_args(flags, 0);
+    ipc_record.set_buffer(buffer.GetPointer(), buffer.GetSize());
+    ipc_record.watch(out_size.GetPointer(), out_errno.GetPointer());
+
     // Check if this is a proxy socket
     auto it = g_socket_info.find(fd);
     if (it != g_socket_info.end() && it->second.is_proxy) {
         auto& manager = ProxySocketManager::GetInstance();
-        ProxySocket* proxy = manager.GetProxySocket(fd);
+        std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
 
         if (proxy != nullptr) {
             // Send via proxy socket
@@ -1173,6 +1317,12 @@ Result BsdMitmService::SendTo(
     LOG_VERBOSE("BSD SendTo fd=%d flags=%d size=%zu addr_size=%zu",
                 fd, flags, buffer.GetSize(), addr.GetSize());
 
+    BSD_IPC_RECORD(SendTo, fd);
+    ipc_record.set_args(flags, 0);
+    ipc_record.set_buffer(buffer.GetPointer(), buffer.GetSize());
+    ipc_record.set_sockaddr(addr.GetPointer(), addr.GetSize());
+    ipc_record.watch(out_size.GetPointer(), out_errno.GetPointer());
+
     // Check if this is a proxy socket or if dest is LDN
     auto it = g_socket_info.find(fd);
     bool is_proxy = (it != g_socket_info.end() && it->second.is_proxy);
@@ -1192,7 +1342,7 @@ Result BsdMitmService::SendTo(
                 auto& manager = ProxySocketManager::GetInstance();
 
                 // Create proxy socket if needed
-                ProxySocket* proxy = manager.GetProxySocket(fd);
+                std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
                 if (proxy == nullptr) {
                     proxy = manager.CreateProxySocket(fd, it->second.type, it->second.protocol);
                     if (proxy != nullptr) {
@@ -1215,7 +1365,7 @@ Result BsdMitmService::SendTo(
 
     if (is_proxy) {
         auto& manager = ProxySocketManager::GetInstance();
-        ProxySocket* proxy = manager.GetProxySocket(fd);
+        std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
 
         if (proxy != nullptr && addr.GetSize() >= sizeof(ryu_ldn::bsd::SockAddrIn)) {
             const auto* dest_addr = reinterpret_cast<const ryu_ldn::bsd::SockAddrIn*>(addr.GetPointer());
@@ -1305,11 +1455,16 @@ Result BsdMitmService::Recv(
 {
     LOG_VERBOSE("BSD Recv fd=%d flags=%d buf_size=%zu", fd, flags, buffer.GetSize());
 
+    BSD_IPC_RECORD(Recv, fd);
+    ipc_record.set_args(flags, 0);
+    ipc_record.set_buffer(nullptr, buffer.GetSize());
+    ipc_record.watch(out_size.GetPointer(), out_errno.GetPointer());
+
     // Check if this is a proxy socket
     auto it = g_socket_info.find(fd);
     if (it != g_socket_info.end() && it->second.is_proxy) {
         auto& manager = ProxySocketManager::GetInstance();
-        ProxySocket* proxy = manager.GetProxySocket(fd);
+        std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
 
         if (proxy != nullptr) {
             // Receive from proxy socket queue
@@ -1391,11 +1546,16 @@ Result BsdMitmService::RecvFrom(
 {
     LOG_VERBOSE("BSD RecvFrom fd=%d flags=%d buf_size=%zu", fd, flags, buffer.GetSize());
 
+    BSD_IPC_RECORD(RecvFrom, fd);
+    ipc_record.set_args(flags, 0);
+    ipc_record.set_buffer(nullptr, buffer.GetSize());
+    ipc_record.watch(out_size.GetPointer(), out_errno.GetPointer());
+
     // Check if this is a proxy socket
     auto it = g_socket_info.find(fd);
     if (it != g_socket_info.end() && it->second.is_proxy) {
         auto& manager = ProxySocketManager::GetInstance();
-        ProxySocket* proxy = manager.GetProxySocket(fd);
+        std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
 
         if (proxy != nullptr) {
             // Receive from proxy socket queue with source address
@@ -1607,28 +1767,14 @@ Result BsdMitmService::Select(
 {
     LOG_VERBOSE("BSD Select nfds=%d", nfds);
 
+    BSD_IPC_RECORD(Select, -1);
+    ipc_record.set_args(nfds, TimevalToMs(timeout.GetPointer(), timeout.GetSize()));
+    ipc_record.watch(out_count.GetPointer(), out_errno.GetPointer());
+
     // fd_set is a bitmask array: each bit represents an fd
     // FD_SETSIZE on Switch is typically 1024, so max ~128 bytes per set
     auto& manager = ProxySocketManager::GetInstance();
 
-    // Helper to check if fd is set in fd_set
-    auto fd_isset = [](s32 fd, const void* fds, size_t size) -> bool {
-        if (fds == nullptr || fd < 0) return false;
-        size_t byte_idx = static_cast<size_t>(fd) / 8;
-        if (byte_idx >= size) return false;
-        uint8_t bit = 1u << (fd % 8);
-        return (static_cast<const uint8_t*>(fds)[byte_idx] & bit) != 0;
-    };
-
-    // Helper to set fd in fd_set
-    auto fd_set_bit = [](s32 fd, void* fds, size_t size) {
-        if (fds == nullptr || fd < 0) return;
-        size_t byte_idx = static_cast<size_t>(fd) / 8;
-        if (byte_idx >= size) return;
-        uint8_t bit = 1u << (fd % 8);
-        static_cast<uint8_t*>(fds)[byte_idx] |= bit;
-    };
-
     // Initialize output fd_sets to zero
     if (readfds_out.GetSize() > 0) {
         std::memset(readfds_out.GetPointer(), 0, readfds_out.GetSize());
@@ -1640,43 +1786,18 @@ Result BsdMitmService::Select(
         std::memset(errorfds_out.GetPointer(), 0, errorfds_out.GetSize());
     }
 
-    // Check for LDN proxy sockets in the fd sets
-    bool has_proxy_sockets = false;
-    bool has_real_sockets = false;
-    s32 ready_count = 0;
-
-    for (s32 fd = 0; fd < nfds; fd++) {
-        bool in_read = fd_isset(fd, readfds_in.GetPointer(), readfds_in.GetSize());
-        bool in_write = fd_isset(fd, writefds_in.GetPointer(), writefds_in.GetSize());
-        bool in_error = fd_isset(fd, errorfds_in.GetPointer(), errorfds_in.GetSize());
+    const SelectFdSet read_set{readfds_in.GetPointer(), readfds_in.GetSize(),
+                               readfds_out.GetPointer(), readfds_out.GetSize()};
+    const SelectFdSet write_set{writefds_in.GetPointer(), writefds_in.GetSize(),
+                                writefds_out.GetPointer(), writefds_out.GetSize()};
+    const SelectFdSet error_set{errorfds_in.GetPointer(), errorfds_in.GetSize(),
+                                errorfds_out.GetPointer(), errorfds_out.GetSize()};
 
-        if (!in_read && !in_write && !in_error) continue;
-
-        ProxySocket* proxy = manager.GetProxySocket(fd);
-        if (proxy != nullptr) {
-            has_proxy_sockets = true;
-
-            // Check read readiness
-            if (in_read && proxy->HasPendingData()) {
-                fd_set_bit(fd, readfds_out.GetPointer(), readfds_out.GetSize());
-                ready_count++;
-            }
-
-            // Proxy sockets are always writable
-            if (in_write) {
-                fd_set_bit(fd, writefds_out.GetPointer(), writefds_out.GetSize());
-                ready_count++;
-            }
-
-            // Check for errors (closed socket)
-            if (in_error && proxy->GetState() == ProxySocketState::Closed) {
-                fd_set_bit(fd, errorfds_out.GetPointer(), errorfds_out.GetSize());
-                ready_count++;
-            }
-        } else {
-            has_real_sockets = true;
-        }
-    }
+    // Check for LDN proxy sockets in the fd sets (see proxy_readiness.hpp)
+    ProxyReadiness readiness = SelectProxySockets(manager, nfds, read_set, write_set, error_set);
+    bool has_proxy_sockets = readiness.has_proxy_sockets;
+    bool has_real_sockets = readiness.has_real_sockets;
+    s32 ready_count = readiness.ready_count;
 
     // If we only have proxy sockets, return immediately
     if (has_proxy_sockets && !has_real_sockets) {
@@ -1724,27 +1845,7 @@ Result BsdMitmService::Select(
 
     // If we have proxy sockets, merge results after real select
     if (has_proxy_sockets && R_SUCCEEDED(rc)) {
-        for (s32 fd = 0; fd < nfds; fd++) {
-            ProxySocket* proxy = manager.GetProxySocket(fd);
-            if (proxy != nullptr) {
-                bool in_read = fd_isset(fd, readfds_in.GetPointer(), readfds_in.GetSize());
-                bool in_write = fd_isset(fd, writefds_in.GetPointer(), writefds_in.GetSize());
-                bool in_error = fd_isset(fd, errorfds_in.GetPointer(), errorfds_in.GetSize());
-
-                if (in_read && proxy->HasPendingData()) {
-                    fd_set_bit(fd, readfds_out.GetPointer(), readfds_out.GetSize());
-                    out.count++;
-                }
-                if (in_write) {
-                    fd_set_bit(fd, writefds_out.GetPointer(), writefds_out.GetSize());
-                    out.count++;
-                }
-                if (in_error && proxy->GetState() == ProxySocketState::Closed) {
-                    fd_set_bit(fd, errorfds_out.GetPointer(), errorfds_out.GetSize());
-                    out.count++;
-                }
-            }
-        }
+        out.count += SelectProxySockets(manager, nfds, read_set, write_set, error_set).ready_count;
     }
 
     out_errno.SetValue(out.errno_val);
@@ -1786,6 +1887,11 @@ Result BsdMitmService::Poll(
 {
     LOG_VERBOSE("BSD Poll nfds=%d timeout=%d", nfds, timeout);
 
+    BSD_IPC_RECORD(Poll, -1);
+    ipc_record.set_args(nfds, timeout);
+    ipc_record.set_buffer(fds_in.GetPointer(), fds_in.GetSize());
+    ipc_record.watch(out_count.GetPointer(), out_errno.GetPointer());
+
     // Copy input to output first
     if (fds_out.GetSize() >= fds_in.GetSize()) {
         std::memcpy(fds_out.GetPointer(), fds_in.GetPointer(), fds_in.GetSize());
@@ -1797,42 +1903,16 @@ Result BsdMitmService::Poll(
     size_t num_fds = std::min(static_cast<size_t>(nfds),
                                fds_out.GetSize() / sizeof(ryu_ldn::bsd::PollFd));
 
-    // Check which fds are proxy sockets and handle them
-    bool has_proxy_sockets = false;
-    bool has_real_sockets = false;
-    s32 ready_count = 0;
-
     for (size_t i = 0; i < num_fds; i++) {
         poll_fds[i].revents = 0;  // Clear revents
-
-        ProxySocket* proxy = manager.GetProxySocket(poll_fds[i].fd);
-        if (proxy != nullptr) {
-            has_proxy_sockets = true;
-
-            // Use system POLL* macros from poll.h
-            // Check read readiness
-            if ((poll_fds[i].events & POLLIN) && proxy->HasPendingData()) {
-                poll_fds[i].revents |= static_cast<int16_t>(POLLIN);
-            }
-
-            // Proxy sockets are always writable (write goes to queue)
-            if (poll_fds[i].events & POLLOUT) {
-                poll_fds[i].revents |= static_cast<int16_t>(POLLOUT);
-            }
-
-            // Check for errors/hangup
-            if (proxy->GetState() == ProxySocketState::Closed) {
-                poll_fds[i].revents |= static_cast<int16_t>(POLLHUP);
-            }
-
-            if (poll_fds[i].revents != 0) {
-                ready_count++;
-            }
-        } else {
-            has_real_sockets = true;
-        }
     }
 
+    // Check which fds are proxy sockets and handle them (see proxy_readiness.hpp)
+    ProxyReadiness readiness = PollProxySockets(manager, poll_fds, num_fds);
+    bool has_proxy_sockets = readiness.has_proxy_sockets;
+    bool has_real_sockets = readiness.has_real_sockets;
+    s32 ready_count = readiness.ready_count;
+
     // If we only have proxy sockets, return immediately
     if (has_proxy_sockets && !has_real_sockets) {
         // If no proxy sockets are ready and timeout != 0, we should wait
@@ -1881,28 +1961,9 @@ Result BsdMitmService::Poll(
         }
     );
 
-    // If we have proxy sockets, merge results
+    // If we have proxy sockets, merge results (count is entries with revents)
     if (has_proxy_sockets && R_SUCCEEDED(rc)) {
-        // Re-check proxy sockets after real poll returned
-        for (size_t i = 0; i < num_fds; i++) {
-            ProxySocket* proxy = manager.GetProxySocket(poll_fds[i].fd);
-            if (proxy != nullptr) {
-                poll_fds[i].revents = 0;
-
-                if ((poll_fds[i].events & POLLIN) && proxy->HasPendingData()) {
-                    poll_fds[i].revents |= static_cast<int16_t>(POLLIN);
-                    out.count++;
-                }
-                if (poll_fds[i].events & POLLOUT) {
-                    poll_fds[i].revents |= static_cast<int16_t>(POLLOUT);
-                    out.count++;
-                }
-                if (proxy->GetState() == ProxySocketState::Closed) {
-                    poll_fds[i].revents |= static_cast<int16_t>(POLLHUP);
-                    out.count++;
-                }
-            }
-        }
+        out.count += PollProxySockets(manager, poll_fds, num_fds).ready_count;
     }
 
     out_errno.SetValue(out.errno_val);
@@ -2002,7 +2063,7 @@ Result BsdMitmService::Ioctl(
 
     // Check if this is a proxy socket and handle FIONREAD
     auto& manager = ProxySocketManager::GetInstance();
-    ProxySocket* proxy = manager.GetProxySocket(fd);
+    std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
     if (proxy != nullptr) {
         constexpr u32 FIONREAD = 0x4004667F;
 
@@ -2085,7 +2146,7 @@ Result BsdMitmService::Fcntl(
 
     // Check if this is a proxy socket and handle non-blocking flag
     auto& manager = ProxySocketManager::GetInstance();
-    ProxySocket* proxy = manager.GetProxySocket(fd);
+    std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
     if (proxy != nullptr) {
         constexpr s32 F_GETFL = 3;
         constexpr s32 F_SETFL = 4;
@@ -2168,7 +2229,7 @@ Result BsdMitmService::GetSockOpt(
 
     // Check if this is a proxy socket
     auto& manager = ProxySocketManager::GetInstance();
-    ProxySocket* proxy = manager.GetProxySocket(fd);
+    std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
     if (proxy != nullptr) {
         // Delegate to ProxySocket::GetSockOpt
         size_t optlen = optval.GetSize();
@@ -2238,7 +2299,7 @@ Result BsdMitmService::SetSockOpt(
 
     // Check if this is a proxy socket
     auto& manager = ProxySocketManager::GetInstance();
-    ProxySocket* proxy = manager.GetProxySocket(fd);
+    std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
     if (proxy != nullptr) {
         // Delegate to ProxySocket::SetSockOpt
         Result rc = proxy->SetSockOpt(level, optname, optval.GetPointer(), optval.GetSize());
@@ -2288,6 +2349,12 @@ Result BsdMitmService::SetSockOpt(
  *   [4] s32 errno
  * ```
  *
+ * ## LDN Proxy
+ *
+ * A proxy socket bound to an LDN address listens in the proxy manager
+ * only: incoming ProxyConnect requests fill its backlog and Accept() takes
+ * them from there. The real socket is never bound, so nothing is forwarded.
+ *
  * @param[out] out_errno BSD errno
  * @param[in] fd Socket file descriptor
  * @param[in] backlog Connection queue size
@@ -2300,6 +2367,29 @@ Result BsdMitmService::Listen(
 {
     LOG_VERBOSE("BSD Listen fd=%d backlog=%d", fd, backlog);
 
+    BSD_IPC_RECORD(Listen, fd);
+    ipc_record.set_args(backlog, 0);
+    ipc_record.watch(nullptr, out_errno.GetPointer());
+
+    auto it = g_socket_info.find(fd);
+    if (it != g_socket_info.end() && it->second.is_proxy) {
+        auto& manager = ProxySocketManager::GetInstance();
+        if (manager.GetProxySocket(fd) != nullptr) {
+            // Same errno as a real stack for a datagram or unbound socket
+            if (manager.ListenProxySocket(fd, backlog) == nullptr) {
+                LOG_WARN("BSD Listen fd=%d proxy socket can't listen", fd);
+                out_errno.SetValue(static_cast<s32>(it->second.type == ryu_ldn::bsd::SocketType::Stream
+                                                        ? ryu_ldn::bsd::BsdErrno::Inval
+                                                        : ryu_ldn::bsd::BsdErrno::OpNotSupp));
+                R_SUCCEED();
+            }
+
+            LOG_INFO("BSD Listen fd=%d listening on LDN proxy, backlog=%d", fd, backlog);
+            out_errno.SetValue(0);
+            R_SUCCEED();
+        }
+    }
+
     struct {
         s32 fd;
         s32 backlog;
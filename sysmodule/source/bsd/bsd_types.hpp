@@ -62,6 +62,18 @@ inline bool IsLdnAddress(uint32_t ip) {
     return (ip & LDN_NETWORK_MASK) == LDN_NETWORK_BASE;
 }
 
+/**
+ * @brief Check if an IP address is a broadcast address
+ *
+ * x.x.x.255 or x.x.255.255: games broadcast on the /16 LDN subnet
+ * (10.114.255.255), some on a /24 inside it.
+ *
+ * @param ip IPv4 address in host byte order
+ */
+inline bool IsBroadcastAddress(uint32_t ip) {
+    return (ip & 0xFF) == 0xFF || (ip & 0xFFFF) == 0xFFFF;
+}
+
 /**
  * @brief Maximum number of proxy sockets we can manage
  */
@@ -0,0 +1,106 @@
+/**
+ * @file datagram_proxy_socket.cpp
+ * @brief Implementation of the UDP proxy socket
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "datagram_proxy_socket.hpp"
+
+namespace ams::mitm::bsd {
+
+using Errno = ryu_ldn::bsd::BsdErrno;
+
+DatagramProxySocket::DatagramProxySocket(ryu_ldn::bsd::ProtocolType protocol)
+    : ProxySocket(ryu_ldn::bsd::SocketType::Dgram, protocol)
+{
+}
+
+DatagramProxySocket::~DatagramProxySocket() {
+    // Datagrams still queued leave the gauge with the socket
+    ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Add(-static_cast<int64_t>(m_receive_queue.Size()));
+}
+
+Result DatagramProxySocket::ConnectImpl(const ryu_ldn::bsd::SockAddrIn& addr) {
+    // For UDP, just store the default destination
+    m_remote_addr = addr;
+    m_state = ProxySocketState::Connected;
+    R_SUCCEED();
+}
+
+s32 DatagramProxySocket::SendToImpl(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) {
+    // One datagram is one ProxyData packet
+    if (len > PROXY_SOCKET_MAX_PAYLOAD) {
+        return -static_cast<s32>(Errno::MsgSize);
+    }
+
+    return SendProxyData(data, len, dest);
+}
+
+s32 DatagramProxySocket::RecvFromImpl(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::SockAddrIn* from) {
+    return ReadQueue(m_receive_queue, buffer, len, flags, from);
+}
+
+void DatagramProxySocket::IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from) {
+    std::scoped_lock lock(m_queue_mutex);
+
+    // Drops the oldest datagram if the queue is full (UDP behavior)
+    size_t queued = m_receive_queue.Size();
+    // Timed only while the flight recorder watches the queueing delay
+    uint64_t queued_ns = ryu_ldn::diagnostics::g_flight_recorder.is_enabled() ? ryu_ldn::platform::GetTickNs() : 0;
+    if (!m_receive_queue.Push(data, len, from, queued_ns)) {
+        m_dropped++;
+        ryu_ldn::diagnostics::g_metrics.proxy_rx_dropped.Add();
+    }
+    ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Add(
+        static_cast<int64_t>(m_receive_queue.Size()) - static_cast<int64_t>(queued));
+
+    // Signal that data is available (moderated, see ProxySocket)
+    NotifyReadable();
+}
+
+void DatagramProxySocket::ClearQueue() {
+    ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Add(-static_cast<int64_t>(m_receive_queue.Size()));
+    m_receive_queue.Clear();
+}
+
+Result DatagramProxySocket::SetSockOpt(s32 level, s32 optname, const void* optval, size_t optlen) {
+    if (level == static_cast<s32>(ryu_ldn::bsd::SocketOptionLevel::Socket) &&
+        optname == static_cast<s32>(ryu_ldn::bsd::SocketOption::Broadcast)) {
+        // SO_BROADCAST - enable/disable broadcast reception
+        if (optval != nullptr && optlen >= sizeof(s32)) {
+            s32 value = *reinterpret_cast<const s32*>(optval);
+            m_broadcast = (value != 0);
+            R_SUCCEED();
+        }
+        R_THROW(static_cast<s32>(Errno::Inval));
+    }
+
+    R_RETURN(ProxySocket::SetSockOpt(level, optname, optval, optlen));
+}
+
+Result DatagramProxySocket::GetSockOpt(s32 level, s32 optname, void* optval, size_t* optlen) const {
+    if (level == static_cast<s32>(ryu_ldn::bsd::SocketOptionLevel::Socket) &&
+        optname == static_cast<s32>(ryu_ldn::bsd::SocketOption::Broadcast) &&
+        optval != nullptr && optlen != nullptr && *optlen >= sizeof(s32)) {
+        // SO_BROADCAST - return broadcast flag
+        *reinterpret_cast<s32*>(optval) = m_broadcast ? 1 : 0;
+        *optlen = sizeof(s32);
+        R_SUCCEED();
+    }
+
+    R_RETURN(ProxySocket::GetSockOpt(level, optname, optval, optlen));
+}
+
+bool DatagramProxySocket::HasPendingData() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return !m_receive_queue.Empty();
+}
+
+size_t DatagramProxySocket::GetPendingDataSize() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return m_receive_queue.Size();
+}
+
+} // namespace ams::mitm::bsd
@@ -0,0 +1,81 @@
+/**
+ * @file datagram_proxy_socket.hpp
+ * @brief UDP proxy socket
+ *
+ * Datagram sockets keep message boundaries and drop the oldest datagram when
+ * the game does not keep up, like a real UDP socket with a full buffer.
+ * They carry no connect handshake or accept state.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "proxy_socket.hpp"
+#include "proxy_socket_queue.hpp"
+
+namespace ams::mitm::bsd {
+
+/**
+ * @brief Proxy socket for SOCK_DGRAM / UDP
+ */
+class DatagramProxySocket final : public ProxySocket {
+public:
+    /**
+     * @brief Construct an unbound datagram socket
+     *
+     * @param protocol Protocol type (Udp)
+     */
+    explicit DatagramProxySocket(ryu_ldn::bsd::ProtocolType protocol);
+    ~DatagramProxySocket() override;
+
+    void IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from) override;
+
+    Result SetSockOpt(s32 level, s32 optname, const void* optval, size_t optlen) override;
+    Result GetSockOpt(s32 level, s32 optname, void* optval, size_t* optlen) const override;
+
+    bool HasPendingData() const override;
+    size_t GetPendingDataSize() const override;
+
+    /**
+     * @brief Get broadcast flag
+     * @return true if SO_BROADCAST is enabled
+     */
+    bool IsBroadcastEnabled() const { return m_broadcast; }
+
+    /**
+     * @brief Set broadcast flag (SO_BROADCAST)
+     * @param enabled true to enable broadcast reception
+     */
+    void SetBroadcastEnabled(bool enabled) { m_broadcast = enabled; }
+
+    /**
+     * @brief Number of datagrams dropped because the queue was full
+     */
+    u32 GetDroppedCount() const { return m_dropped; }
+
+protected:
+    Result ConnectImpl(const ryu_ldn::bsd::SockAddrIn& addr) override;
+    s32 SendToImpl(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) override;
+    s32 RecvFromImpl(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::SockAddrIn* from) override;
+    void ClearQueue() override;
+
+private:
+    /**
+     * @brief Receive queue (incoming datagrams)
+     */
+    PacketRing<PROXY_SOCKET_MAX_QUEUE_SIZE> m_receive_queue;
+
+    /**
+     * @brief Datagrams dropped on overflow
+     */
+    u32 m_dropped{0};
+
+    /**
+     * @brief Broadcast flag (SO_BROADCAST)
+     */
+    bool m_broadcast{false};
+};
+
+} // namespace ams::mitm::bsd
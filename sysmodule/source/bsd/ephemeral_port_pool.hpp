@@ -39,9 +39,9 @@
 
 #pragma once
 
-#include <stratosphere.hpp>
 #include <array>
 #include <bitset>
+#include "../platform/platform.hpp"
 #include "bsd_types.hpp"
 
 namespace ams::mitm::bsd {
@@ -227,7 +227,7 @@ private:
     /**
      * @brief Mutex for thread safety
      */
-    mutable os::Mutex m_mutex{false};
+    mutable ryu_ldn::platform::Mutex m_mutex;
 
     /**
      * @brief Port allocation bitset for UDP
@@ -0,0 +1,149 @@
+/**
+ * @file listener_proxy_socket.cpp
+ * @brief Implementation of the listening TCP proxy socket
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "listener_proxy_socket.hpp"
+
+#include <algorithm>
+
+namespace ams::mitm::bsd {
+
+using Errno = ryu_ldn::bsd::BsdErrno;
+
+ListenerProxySocket::ListenerProxySocket(ryu_ldn::bsd::ProtocolType protocol,
+                                         const ryu_ldn::bsd::SockAddrIn& local,
+                                         bool non_blocking, s32 backlog)
+    : ProxySocket(ryu_ldn::bsd::SocketType::Stream, protocol)
+    , m_backlog_limit(std::clamp<size_t>(backlog > 0 ? static_cast<size_t>(backlog) : 1,
+                                         1, PROXY_LISTENER_MAX_BACKLOG))
+{
+    m_local_addr = local;
+    m_non_blocking = non_blocking;
+    m_state = ProxySocketState::Listening;
+}
+
+// =============================================================================
+// Accept
+// =============================================================================
+
+std::unique_ptr<StreamProxySocket> ListenerProxySocket::PopConnection(ryu_ldn::bsd::SockAddrIn* out_addr) {
+    // Caller must hold m_queue_mutex
+    auto accepted = std::move(m_backlog[m_backlog_head]);
+    m_backlog_head = (m_backlog_head + 1) % PROXY_LISTENER_MAX_BACKLOG;
+    m_backlog_count--;
+
+    if (m_backlog_count == 0) {
+        m_receive_event.Clear();
+    }
+
+    if (out_addr != nullptr) {
+        *out_addr = accepted->GetRemoteAddr();
+    }
+    return accepted;
+}
+
+std::unique_ptr<StreamProxySocket> ListenerProxySocket::Accept(ryu_ldn::bsd::SockAddrIn* out_addr) {
+    while (m_state == ProxySocketState::Listening) {
+        {
+            std::scoped_lock lock(m_queue_mutex);
+            if (m_backlog_count > 0) {
+                return PopConnection(out_addr);
+            }
+            if (m_non_blocking) {
+                // EWOULDBLOCK
+                return nullptr;
+            }
+        }
+
+        // Woken by a new connection or Close()
+        m_receive_event.Wait();
+    }
+
+    return nullptr;
+}
+
+bool ListenerProxySocket::IncomingConnection(const ryu_ldn::protocol::ProxyConnectRequest& request) {
+    // Set remote address from request
+    ryu_ldn::bsd::SockAddrIn remote{};
+    remote.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    remote.sin_len = sizeof(ryu_ldn::bsd::SockAddrIn);
+    remote.sin_addr = __builtin_bswap32(request.info.source_ipv4);
+    remote.sin_port = __builtin_bswap16(request.info.source_port);
+
+    std::scoped_lock lock(m_queue_mutex);
+
+    // Backlog full: refuse, the caller answers the peer
+    if (m_backlog_count >= m_backlog_limit) {
+        return false;
+    }
+
+    // Local address is the listening socket's
+    size_t tail = (m_backlog_head + m_backlog_count) % PROXY_LISTENER_MAX_BACKLOG;
+    m_backlog[tail] = std::make_unique<StreamProxySocket>(m_protocol, m_local_addr, remote);
+    m_backlog_count++;
+
+    // Signal that a connection is available
+    m_receive_event.Signal();
+    return true;
+}
+
+void ListenerProxySocket::IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from) {
+    std::scoped_lock lock(m_queue_mutex);
+
+    for (size_t i = 0; i < m_backlog_count; i++) {
+        auto& connection = m_backlog[(m_backlog_head + i) % PROXY_LISTENER_MAX_BACKLOG];
+        const auto& remote = connection->GetRemoteAddr();
+        if (remote.sin_addr == from.sin_addr && remote.sin_port == from.sin_port) {
+            connection->IncomingData(data, len, from);
+            return;
+        }
+    }
+
+    // Not a pending connection: dropped like any data without a socket
+}
+
+size_t ListenerProxySocket::GetPendingConnectionCount() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return m_backlog_count;
+}
+
+bool ListenerProxySocket::HasPendingData() const {
+    return GetPendingConnectionCount() > 0;
+}
+
+size_t ListenerProxySocket::GetPendingDataSize() const {
+    return 0;
+}
+
+void ListenerProxySocket::ClearQueue() {
+    for (auto& connection : m_backlog) {
+        connection.reset();
+    }
+    m_backlog_head = 0;
+    m_backlog_count = 0;
+}
+
+// =============================================================================
+// Unsupported on a listening socket
+// =============================================================================
+
+Result ListenerProxySocket::ConnectImpl(const ryu_ldn::bsd::SockAddrIn& addr) {
+    AMS_UNUSED(addr);
+    R_THROW(static_cast<s32>(Errno::IsConn));
+}
+
+s32 ListenerProxySocket::SendToImpl(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) {
+    AMS_UNUSED(data, len, dest);
+    return -static_cast<s32>(Errno::NotConn);
+}
+
+s32 ListenerProxySocket::RecvFromImpl(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::SockAddrIn* from) {
+    AMS_UNUSED(buffer, len, flags, from);
+    return -static_cast<s32>(Errno::NotConn);
+}
+
+} // namespace ams::mitm::bsd
@@ -0,0 +1,104 @@
+/**
+ * @file listener_proxy_socket.hpp
+ * @brief Listening TCP proxy socket
+ *
+ * A listener only holds the backlog of connections received through
+ * ProxyConnect. It has no receive queue: it becomes readable (select/poll)
+ * when a connection is waiting in the backlog.
+ *
+ * A peer that connected optimistically may send data before the game calls
+ * accept(): that data is routed to the listener and queued, in order, on the
+ * pending connection it belongs to.
+ *
+ * ProxySocketManager::ListenProxySocket() replaces a bound StreamProxySocket
+ * with a ListenerProxySocket when the game calls listen().
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "stream_proxy_socket.hpp"
+
+namespace ams::mitm::bsd {
+
+/**
+ * @brief Largest accepted backlog
+ */
+constexpr size_t PROXY_LISTENER_MAX_BACKLOG = 16;
+
+/**
+ * @brief Proxy socket in the LISTEN state
+ */
+class ListenerProxySocket final : public ProxySocket {
+public:
+    /**
+     * @brief Start listening on a bound address
+     *
+     * @param protocol Protocol type (Tcp)
+     * @param local Address the stream socket was bound to
+     * @param non_blocking Non-blocking mode of the stream socket
+     * @param backlog Maximum pending connections (clamped to 1..PROXY_LISTENER_MAX_BACKLOG)
+     */
+    ListenerProxySocket(ryu_ldn::bsd::ProtocolType protocol,
+                        const ryu_ldn::bsd::SockAddrIn& local,
+                        bool non_blocking, s32 backlog);
+
+    /**
+     * @brief Accept a connection
+     *
+     * Blocks until a connection is available (unless non-blocking).
+     *
+     * @param out_addr Output: connecting peer's address
+     * @return New connected socket, or nullptr if none is available
+     *
+     * @note The returned socket is owned by the caller
+     */
+    std::unique_ptr<StreamProxySocket> Accept(ryu_ldn::bsd::SockAddrIn* out_addr);
+
+    /**
+     * @brief Queue an incoming connection
+     *
+     * @return false if the backlog is full (the connection is refused)
+     */
+    bool IncomingConnection(const ryu_ldn::protocol::ProxyConnectRequest& request) override;
+
+    /**
+     * @brief Queue early data on the pending connection of its sender
+     */
+    void IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from) override;
+
+    /**
+     * @brief Check if the backlog has pending connections
+     */
+    bool HasPendingData() const override;
+    size_t GetPendingDataSize() const override;
+
+    /**
+     * @brief Number of connections waiting in the backlog
+     */
+    size_t GetPendingConnectionCount() const;
+
+protected:
+    Result ConnectImpl(const ryu_ldn::bsd::SockAddrIn& addr) override;
+    s32 SendToImpl(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) override;
+    s32 RecvFromImpl(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::SockAddrIn* from) override;
+    void ClearQueue() override;
+
+private:
+    /**
+     * @brief Pop the oldest pending connection (m_queue_mutex held)
+     */
+    std::unique_ptr<StreamProxySocket> PopConnection(ryu_ldn::bsd::SockAddrIn* out_addr);
+
+    /**
+     * @brief Accept backlog (ring)
+     */
+    std::unique_ptr<StreamProxySocket> m_backlog[PROXY_LISTENER_MAX_BACKLOG];
+    size_t m_backlog_limit;
+    size_t m_backlog_head{0};
+    size_t m_backlog_count{0};
+};
+
+} // namespace ams::mitm::bsd
@@ -0,0 +1,115 @@
+/**
+ * @file proxy_readiness.cpp
+ * @brief Implementation of select()/poll() readiness of proxy sockets
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "proxy_readiness.hpp"
+
+namespace ams::mitm::bsd {
+
+bool FdIsSet(s32 fd, const void* fds, size_t size) {
+    if (fds == nullptr || fd < 0) {
+        return false;
+    }
+    size_t byte_idx = static_cast<size_t>(fd) / 8;
+    if (byte_idx >= size) {
+        return false;
+    }
+    uint8_t bit = static_cast<uint8_t>(1u << (fd % 8));
+    return (static_cast<const uint8_t*>(fds)[byte_idx] & bit) != 0;
+}
+
+void FdSetBit(s32 fd, void* fds, size_t size) {
+    if (fds == nullptr || fd < 0) {
+        return;
+    }
+    size_t byte_idx = static_cast<size_t>(fd) / 8;
+    if (byte_idx >= size) {
+        return;
+    }
+    static_cast<uint8_t*>(fds)[byte_idx] |= static_cast<uint8_t>(1u << (fd % 8));
+}
+
+ProxyReadiness SelectProxySockets(ProxySocketManager& manager, s32 nfds,
+                                  const SelectFdSet& read, const SelectFdSet& write,
+                                  const SelectFdSet& error) {
+    ProxyReadiness readiness{false, false, 0};
+
+    for (s32 fd = 0; fd < nfds; fd++) {
+        bool in_read = FdIsSet(fd, read.in, read.in_size);
+        bool in_write = FdIsSet(fd, write.in, write.in_size);
+        bool in_error = FdIsSet(fd, error.in, error.in_size);
+        if (!in_read && !in_write && !in_error) {
+            continue;
+        }
+
+        std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
+        if (proxy == nullptr) {
+            readiness.has_real_sockets = true;
+            continue;
+        }
+        readiness.has_proxy_sockets = true;
+
+        if (in_read && proxy->HasPendingData()) {
+            FdSetBit(fd, read.out, read.out_size);
+            readiness.ready_count++;
+        }
+
+        // Writable unless a stream waits for the peer's window
+        if (in_write && proxy->IsWritable()) {
+            FdSetBit(fd, write.out, write.out_size);
+            readiness.ready_count++;
+        }
+
+        if (in_error && proxy->GetState() == ProxySocketState::Closed) {
+            FdSetBit(fd, error.out, error.out_size);
+            readiness.ready_count++;
+        }
+    }
+
+    return readiness;
+}
+
+int16_t PollProxySocket(ProxySocket& proxy, int16_t events) {
+    int16_t revents = 0;
+
+    if ((events & static_cast<int16_t>(ryu_ldn::bsd::PollEvents::In)) && proxy.HasPendingData()) {
+        revents |= static_cast<int16_t>(ryu_ldn::bsd::PollEvents::In);
+    }
+    if ((events & static_cast<int16_t>(ryu_ldn::bsd::PollEvents::Out)) && proxy.IsWritable()) {
+        revents |= static_cast<int16_t>(ryu_ldn::bsd::PollEvents::Out);
+    }
+
+    // Reported whether requested or not, like POLLHUP
+    if (proxy.GetState() == ProxySocketState::Closed) {
+        revents |= static_cast<int16_t>(ryu_ldn::bsd::PollEvents::Hup);
+    }
+
+    return revents;
+}
+
+ProxyReadiness PollProxySockets(ProxySocketManager& manager,
+                                ryu_ldn::bsd::PollFd* fds, size_t count) {
+    ProxyReadiness readiness{false, false, 0};
+
+    for (size_t i = 0; i < count; i++) {
+        std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fds[i].fd);
+        if (proxy == nullptr) {
+            readiness.has_real_sockets = true;
+            continue;
+        }
+        readiness.has_proxy_sockets = true;
+
+        fds[i].revents = PollProxySocket(*proxy, fds[i].events);
+        if (fds[i].revents != 0) {
+            readiness.ready_count++;
+        }
+    }
+
+    return readiness;
+}
+
+} // namespace ams::mitm::bsd
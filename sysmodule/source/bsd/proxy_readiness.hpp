@@ -0,0 +1,94 @@
+/**
+ * @file proxy_readiness.hpp
+ * @brief select()/poll() readiness of proxy sockets
+ *
+ * BsdMitmService::Select and ::Poll answer for proxy sockets themselves and
+ * forward the other fds to the real bsd service. What a proxy socket
+ * reports is decided here, outside the IPC layer, so the host build covers
+ * it:
+ *
+ * | Condition                         | select     | poll    |
+ * |-----------------------------------|------------|---------|
+ * | HasPendingData()                  | read set   | POLLIN  |
+ * | IsWritable() (stream has window)  | write set  | POLLOUT |
+ * | State is Closed                   | error set  | POLLHUP |
+ *
+ * A moderated datagram is readable as soon as it is queued: the moderation
+ * window only delays the wakeup of a reader blocked in RecvFrom.
+ *
+ * Fd sets are the raw bitmask buffers of the IPC call (bit fd % 8 of byte
+ * fd / 8). An fd past the end of a buffer is not set.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "proxy_socket_manager.hpp"
+#include "bsd_types.hpp"
+
+namespace ams::mitm::bsd {
+
+/**
+ * @brief One select() fd set: the game's input and the reply buffer
+ */
+struct SelectFdSet {
+    const void* in;    ///< Requested fds (nullptr = none)
+    size_t in_size;
+    void* out;         ///< Ready fds, only proxy bits are set here
+    size_t out_size;
+};
+
+/**
+ * @brief Result of a readiness scan
+ */
+struct ProxyReadiness {
+    bool has_proxy_sockets;  ///< At least one requested fd is a proxy socket
+    bool has_real_sockets;   ///< At least one requested fd needs the real service
+    s32 ready_count;         ///< select: bits set, poll: entries with revents
+};
+
+/**
+ * @brief Check whether fd is set in a select() bitmask buffer
+ */
+bool FdIsSet(s32 fd, const void* fds, size_t size);
+
+/**
+ * @brief Set fd in a select() bitmask buffer (ignored past its end)
+ */
+void FdSetBit(s32 fd, void* fds, size_t size);
+
+/**
+ * @brief Mark the ready proxy sockets of a select() call
+ *
+ * Only sets bits of proxy fds, so it can run again on the reply of the
+ * real service to merge both. Output buffers are not cleared.
+ *
+ * @param manager Proxy socket registry
+ * @param nfds Highest fd + 1
+ */
+ProxyReadiness SelectProxySockets(ProxySocketManager& manager, s32 nfds,
+                                  const SelectFdSet& read, const SelectFdSet& write,
+                                  const SelectFdSet& error);
+
+/**
+ * @brief poll() revents of one proxy socket
+ *
+ * @param events Requested events (PollEvents bits)
+ * @return POLLIN/POLLOUT among the requested ones, plus POLLHUP if closed
+ */
+int16_t PollProxySocket(ProxySocket& proxy, int16_t events);
+
+/**
+ * @brief Fill revents of the proxy sockets of a poll() array
+ *
+ * Entries that are not proxy sockets are left untouched, so it can run
+ * again on the reply of the real service to merge both.
+ */
+ProxyReadiness PollProxySockets(ProxySocketManager& manager,
+                                ryu_ldn::bsd::PollFd* fds, size_t count);
+
+} // namespace ams::mitm::bsd
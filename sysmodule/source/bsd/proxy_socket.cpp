@@ -2,9 +2,10 @@
  * @file proxy_socket.cpp
  * @brief Implementation of the Proxy Socket for LDN Traffic Routing
  *
- * This file implements the ProxySocket class. Data transfer operations
- * (Send/Recv) interact with the ProxySocketManager to encode/decode
- * ProxyData packets.
+ * This file implements the parts of ProxySocket shared by every socket
+ * type: binding, argument and state checks, socket options, shutdown and
+ * close. Type-specific behavior lives in datagram_proxy_socket.cpp,
+ * stream_proxy_socket.cpp and listener_proxy_socket.cpp.
  *
  * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
  * @license GPL-2.0-or-later
@@ -13,6 +14,8 @@
 #include "proxy_socket.hpp"
 #include "proxy_socket_manager.hpp"
 
+#include <cstring>
+
 namespace ams::mitm::bsd {
 
 // =============================================================================
@@ -86,56 +89,7 @@ Result ProxySocket::Connect(const ryu_ldn::bsd::SockAddrIn& addr) {
         R_THROW(static_cast<s32>(Errno::AfNoSupport));
     }
 
-    // Store remote address
-    m_remote_addr = addr;
-
-    // For TCP, perform connect handshake
-    if (m_type == ryu_ldn::bsd::SocketType::Stream) {
-        m_state = ProxySocketState::Connecting;
-        m_connect_response_received = false;
-        m_connect_event.Clear();
-
-        // Send ProxyConnect via ProxySocketManager
-        auto& manager = ProxySocketManager::GetInstance();
-        bool sent = manager.SendProxyConnect(
-            m_local_addr.GetAddr(), m_local_addr.GetPort(),
-            addr.GetAddr(), addr.GetPort(),
-            m_protocol
-        );
-
-        if (!sent) {
-            m_state = ProxySocketState::Bound;
-            R_THROW(static_cast<s32>(Errno::NetUnreach));
-        }
-
-        // Wait for ProxyConnectReply (with timeout)
-        if (!m_non_blocking) {
-            // Blocking connect - wait up to 4 seconds (like Ryujinx)
-            bool got_response = m_connect_event.TimedWait(TimeSpan::FromSeconds(4));
-
-            if (!got_response || !m_connect_response_received) {
-                m_state = ProxySocketState::Bound;
-                R_THROW(static_cast<s32>(Errno::TimedOut));
-            }
-
-            // Check if connection was refused (protocol != Unspecified means error)
-            if (m_connect_response.info.protocol != ryu_ldn::protocol::ProtocolType::Unspecified) {
-                m_state = ProxySocketState::Bound;
-                R_THROW(static_cast<s32>(Errno::ConnRefused));
-            }
-
-            m_state = ProxySocketState::Connected;
-        } else {
-            // Non-blocking connect - return EINPROGRESS
-            // The connect will complete asynchronously
-            R_THROW(static_cast<s32>(Errno::InProgress));
-        }
-    } else {
-        // For UDP, just store the default destination
-        m_state = ProxySocketState::Connected;
-    }
-
-    R_SUCCEED();
+    R_RETURN(ConnectImpl(addr));
 }
 
 Result ProxySocket::GetSockName(ryu_ldn::bsd::SockAddrIn* out_addr) const {
@@ -205,28 +159,29 @@ s32 ProxySocket::SendTo(const void* data, size_t len, s32 flags, const ryu_ldn::
         return -static_cast<s32>(Errno::Fault);
     }
 
-    // Check max payload size
-    if (len > PROXY_SOCKET_MAX_PAYLOAD) {
-        return -static_cast<s32>(Errno::MsgSize);
-    }
+    return SendToImpl(data, len, dest);
+}
 
+s32 ProxySocket::SendProxyData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) {
     // Send via ProxySocketManager which routes to LDN server
     // Extract addresses in host byte order for the manager
-    uint32_t source_ip = m_local_addr.GetAddr();
-    uint16_t source_port = m_local_addr.GetPort();
-    uint32_t dest_ip = dest.GetAddr();
-    uint16_t dest_port = dest.GetPort();
-
     auto& manager = ProxySocketManager::GetInstance();
-    bool sent = manager.SendProxyData(source_ip, source_port, dest_ip, dest_port,
-                                       m_protocol, data, len);
+    bool sent = manager.SendProxyData(m_local_addr.GetAddr(), m_local_addr.GetPort(),
+                                      dest.GetAddr(), dest.GetPort(),
+                                      m_protocol, data, len);
+
+    ryu_ldn::diagnostics::g_flight_recorder.proxy_tx(dest.GetPort(), len, sent);
 
     if (!sent) {
         // No send callback registered or send failed
         // Return ENETUNREACH to indicate network is unreachable
+        ryu_ldn::diagnostics::g_metrics.proxy_tx_failed.Add();
         return -static_cast<s32>(Errno::NetUnreach);
     }
 
+    ryu_ldn::diagnostics::g_metrics.proxy_tx_packets.Add();
+    ryu_ldn::diagnostics::g_metrics.proxy_tx_bytes.Add(len);
+
     return static_cast<s32>(len);
 }
 
@@ -256,133 +211,12 @@ s32 ProxySocket::RecvFrom(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::Soc
         return -static_cast<s32>(Errno::Fault);
     }
 
-    bool peek = (flags & 0x2) != 0; // MSG_PEEK = 0x2
-    bool dontwait = (flags & 0x40) != 0 || m_non_blocking; // MSG_DONTWAIT = 0x40
-
-    // Try to get data from queue
-    {
-        std::scoped_lock lock(m_queue_mutex);
-
-        if (m_receive_queue.empty()) {
-            if (dontwait) {
-                // Non-blocking and no data
-                return -static_cast<s32>(Errno::Again);
-            }
-        } else {
-            // Data available - get packet
-            ReceivedPacket packet = PopFrontPacket(peek);
-
-            // Copy data to buffer
-            size_t copy_len = std::min(len, packet.data.size());
-            std::memcpy(buffer, packet.data.data(), copy_len);
-
-            // Set source address if requested
-            if (from != nullptr) {
-                *from = packet.from;
-            }
-
-            // Clear event if queue is now empty
-            if (m_receive_queue.empty()) {
-                m_receive_event.Clear();
-            }
-
-            return static_cast<s32>(copy_len);
-        }
-    }
-
-    // Blocking wait for data
-    if (!dontwait) {
-        // Wait for receive event
-        m_receive_event.Wait();
-
-        // Try again after waking up
-        std::scoped_lock lock(m_queue_mutex);
-
-        if (!m_receive_queue.empty()) {
-            ReceivedPacket packet = PopFrontPacket(peek);
-
-            size_t copy_len = std::min(len, packet.data.size());
-            std::memcpy(buffer, packet.data.data(), copy_len);
-
-            if (from != nullptr) {
-                *from = packet.from;
-            }
-
-            if (m_receive_queue.empty()) {
-                m_receive_event.Clear();
-            }
-
-            return static_cast<s32>(copy_len);
-        }
-    }
-
-    // No data and non-blocking
-    return -static_cast<s32>(Errno::Again);
+    return RecvFromImpl(buffer, len, flags, from);
 }
 
 void ProxySocket::IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from) {
-    // Check if this is a broadcast packet and filter if SO_BROADCAST not set
-    // Broadcast packets have destination IP matching the broadcast address
-    // (e.g., 10.114.255.255 for LDN network)
-    if (m_broadcast_address != 0 && !m_broadcast) {
-        // Get local address to check if packet was sent to broadcast
-        uint32_t local_ip = m_local_addr.GetAddr();
-
-        // If we're bound to a specific IP and not the broadcast address,
-        // check if the packet came from broadcast (source would be broadcast addr)
-        // Actually, for UDP the check is: if packet destination was broadcast
-        // Since we receive based on our local port, we need to check if
-        // the packet was originally sent to broadcast address.
-        // The 'from' address is the source, not destination.
-        // We filter based on whether packet destination matched broadcast.
-        // Since IncomingData is called after routing, we check our local binding.
-
-        // If bound to INADDR_ANY (0.0.0.0), we accept packets to broadcast
-        // only if SO_BROADCAST is set
-        if (local_ip == 0) {
-            // We can't easily determine if this was a broadcast packet
-            // without the original destination. For safety, we use heuristic:
-            // If source IP matches broadcast pattern, it might be a broadcast response
-            // Skip filtering for now - proper filtering requires destination IP
-        }
-    }
-
-    std::scoped_lock lock(m_queue_mutex);
-
-    // Drop if queue is full (UDP behavior)
-    if (m_receive_queue.size() >= PROXY_SOCKET_MAX_QUEUE_SIZE) {
-        m_receive_queue.pop_front(); // Drop oldest
-    }
-
-    // Create packet and add to queue
-    ReceivedPacket packet;
-    packet.data.resize(len);
-    if (len > 0 && data != nullptr) {
-        std::memcpy(packet.data.data(), data, len);
-    }
-    packet.from = from;
-
-    m_receive_queue.push_back(std::move(packet));
-
-    // Signal that data is available
-    m_receive_event.Signal();
-}
-
-ReceivedPacket ProxySocket::PopFrontPacket(bool peek) {
-    // Caller must hold m_queue_mutex
-    if (m_receive_queue.empty()) {
-        return {};
-    }
-
-    if (peek) {
-        // Return copy, don't remove
-        return m_receive_queue.front();
-    } else {
-        // Move out and remove
-        ReceivedPacket packet = std::move(m_receive_queue.front());
-        m_receive_queue.pop_front();
-        return packet;
-    }
+    // Sockets without a receive path drop the data
+    AMS_UNUSED(data, len, from);
 }
 
 // =============================================================================
@@ -393,15 +227,6 @@ Result ProxySocket::SetSockOpt(s32 level, s32 optname, const void* optval, size_
     // Handle SOL_SOCKET level options
     if (level == static_cast<s32>(ryu_ldn::bsd::SocketOptionLevel::Socket)) {
         switch (static_cast<ryu_ldn::bsd::SocketOption>(optname)) {
-            case ryu_ldn::bsd::SocketOption::Broadcast:
-                // SO_BROADCAST - enable/disable broadcast reception
-                if (optval != nullptr && optlen >= sizeof(s32)) {
-                    s32 value = *reinterpret_cast<const s32*>(optval);
-                    m_broadcast = (value != 0);
-                    R_SUCCEED();
-                }
-                R_THROW(static_cast<s32>(Errno::Inval));
-
             case ryu_ldn::bsd::SocketOption::ReuseAddr:
             case ryu_ldn::bsd::SocketOption::KeepAlive:
             case ryu_ldn::bsd::SocketOption::DontRoute:
@@ -445,18 +270,9 @@ Result ProxySocket::GetSockOpt(s32 level, s32 optname, void* optval, size_t* opt
                 break;
 
             case ryu_ldn::bsd::SocketOption::Error:
-                // SO_ERROR - return 0 (no error)
+                // SO_ERROR - return the pending error (0 if none)
                 if (*optlen >= sizeof(s32)) {
-                    *reinterpret_cast<s32*>(optval) = 0;
-                    *optlen = sizeof(s32);
-                    R_SUCCEED();
-                }
-                break;
-
-            case ryu_ldn::bsd::SocketOption::Broadcast:
-                // SO_BROADCAST - return broadcast flag
-                if (*optlen >= sizeof(s32)) {
-                    *reinterpret_cast<s32*>(optval) = m_broadcast ? 1 : 0;
+                    *reinterpret_cast<s32*>(optval) = m_socket_error;
                     *optlen = sizeof(s32);
                     R_SUCCEED();
                 }
@@ -472,128 +288,36 @@ Result ProxySocket::GetSockOpt(s32 level, s32 optname, void* optval, size_t* opt
 }
 
 // =============================================================================
-// TCP-specific Operations
+// TCP Handshake Events
 // =============================================================================
 
-Result ProxySocket::Listen(s32 backlog) {
-    AMS_UNUSED(backlog);
-
-    // Must be TCP
-    if (m_type != ryu_ldn::bsd::SocketType::Stream) {
-        R_THROW(static_cast<s32>(Errno::OpNotSupp));
-    }
-
-    // Must be bound
-    if (m_state == ProxySocketState::Created) {
-        R_THROW(static_cast<s32>(Errno::Inval));
-    }
-
-    m_state = ProxySocketState::Listening;
-    R_SUCCEED();
+bool ProxySocket::IncomingConnection(const ryu_ldn::protocol::ProxyConnectRequest& request) {
+    // Only listener sockets accept connections
+    AMS_UNUSED(request);
+    return false;
 }
 
-std::unique_ptr<ProxySocket> ProxySocket::Accept(ryu_ldn::bsd::SockAddrIn* out_addr) {
-    // Must be listening
-    if (m_state != ProxySocketState::Listening) {
-        return nullptr;
-    }
-
-    // Check if non-blocking and no connections available
-    {
-        std::scoped_lock lock(m_queue_mutex);
-        if (m_accept_queue.empty()) {
-            if (m_non_blocking) {
-                // EWOULDBLOCK
-                return nullptr;
-            }
-        } else {
-            // Connection available - return it
-            auto accepted = std::move(m_accept_queue.front());
-            m_accept_queue.pop_front();
-
-            if (m_accept_queue.empty()) {
-                m_accept_event.Clear();
-            }
-
-            if (out_addr != nullptr) {
-                *out_addr = accepted->GetRemoteAddr();
-            }
-
-            return accepted;
-        }
-    }
-
-    // Blocking wait for connection
-    m_accept_event.Wait();
-
-    // Try again after waking up
-    {
-        std::scoped_lock lock(m_queue_mutex);
-        if (!m_accept_queue.empty()) {
-            auto accepted = std::move(m_accept_queue.front());
-            m_accept_queue.pop_front();
-
-            if (m_accept_queue.empty()) {
-                m_accept_event.Clear();
-            }
-
-            if (out_addr != nullptr) {
-                *out_addr = accepted->GetRemoteAddr();
-            }
-
-            return accepted;
-        }
-    }
-
-    // No connection (spurious wakeup or shutdown)
-    return nullptr;
+void ProxySocket::HandleConnectResponse(const ryu_ldn::protocol::ProxyConnectResponse& response) {
+    // Only stream sockets wait for a connect response
+    AMS_UNUSED(response);
 }
 
-void ProxySocket::IncomingConnection(const ryu_ldn::protocol::ProxyConnectRequest& request) {
-    // Only accept on listening sockets
-    if (m_state != ProxySocketState::Listening) {
-        return;
-    }
-
-    std::scoped_lock lock(m_queue_mutex);
-
-    // Create a new socket for the accepted connection
-    auto accepted = std::make_unique<ProxySocket>(m_type, m_protocol);
-
-    // Set local address (same as listening socket)
-    accepted->m_local_addr = m_local_addr;
-    accepted->m_state = ProxySocketState::Bound;
-
-    // Set remote address from request
-    accepted->m_remote_addr.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
-    accepted->m_remote_addr.sin_len = sizeof(ryu_ldn::bsd::SockAddrIn);
-    accepted->m_remote_addr.sin_addr = __builtin_bswap32(request.info.source_ipv4);
-    accepted->m_remote_addr.sin_port = __builtin_bswap16(request.info.source_port);
-
-    // Mark as connected
-    accepted->m_state = ProxySocketState::Connected;
-
-    // Add to accept queue
-    m_accept_queue.push_back(std::move(accepted));
-
-    // Signal that a connection is available
-    m_accept_event.Signal();
-
-    // TODO: Send ProxyConnectReply back to the peer via ProxySocketManager
+bool ProxySocket::IsAwaitingConnectResponse() const {
+    return m_state == ProxySocketState::Connecting;
 }
 
-void ProxySocket::HandleConnectResponse(const ryu_ldn::protocol::ProxyConnectResponse& response) {
-    // Store the response
-    m_connect_response = response;
-    m_connect_response_received = true;
+void ProxySocket::HandleStreamWindow(uint32_t peer_read_total) {
+    // Only stream sockets are flow controlled
+    AMS_UNUSED(peer_read_total);
+}
 
-    // Signal that connect response arrived
-    m_connect_event.Signal();
+void ProxySocket::RetryStreamWindow() {
+    // Only stream sockets send window updates
 }
 
-bool ProxySocket::HasPendingConnections() const {
-    std::scoped_lock lock(m_queue_mutex);
-    return !m_accept_queue.empty();
+bool ProxySocket::IsWritable() const {
+    // Sends never wait, datagrams that do not fit are dropped by the receiver
+    return true;
 }
 
 // =============================================================================
@@ -633,7 +357,7 @@ Result ProxySocket::Close() {
     // Clear queues
     {
         std::scoped_lock lock(m_queue_mutex);
-        m_receive_queue.clear();
+        ClearQueue();
     }
 
     // TODO: For TCP, send ProxyDisconnect to server
@@ -645,30 +369,74 @@ Result ProxySocket::Close() {
 // Event Handling
 // =============================================================================
 
-bool ProxySocket::HasPendingData() const {
-    std::scoped_lock lock(m_queue_mutex);
-    return !m_receive_queue.empty();
+bool ProxySocket::WaitForData(u64 timeout_ms) {
+    if (HasPendingData()) {
+        return true;
+    }
+
+    if (timeout_ms == 0) {
+        // Also woken by Shutdown() and Close(), which queue nothing
+        WaitReadable();
+        return HasPendingData();
+    } else {
+        // Moderated datagrams are queued without a signal
+        return m_receive_event.TimedWait(timeout_ms) || HasPendingData();
+    }
 }
 
-size_t ProxySocket::GetPendingDataSize() const {
+void ProxySocket::SetReceiveModeration(uint32_t window_us) {
     std::scoped_lock lock(m_queue_mutex);
-    size_t total = 0;
-    for (const auto& packet : m_receive_queue) {
-        total += packet.data.size();
+    m_moderation_ns = static_cast<uint64_t>(window_us) * 1000ULL;
+    m_moderation_until_ns = 0;
+}
+
+void ProxySocket::NotifyReadable() {
+    uint64_t now_ns = ryu_ldn::platform::GetTickNs();
+
+    if (m_moderation_ns != 0 && now_ns < m_moderation_until_ns) {
+        // Inside the window: the blocked reader wakes at its end
+        if (m_deferred_since_ns == 0) {
+            m_deferred_since_ns = now_ns;
+        }
+        ryu_ldn::diagnostics::g_metrics.proxy_rx_coalesced.Add();
+        return;
     }
-    return total;
+
+    m_moderation_until_ns = now_ns + m_moderation_ns;
+    m_receive_event.Signal();
+    ryu_ldn::diagnostics::g_metrics.proxy_rx_wakeups.Add();
 }
 
-bool ProxySocket::WaitForData(u64 timeout_ms) {
-    if (HasPendingData()) {
-        return true;
+void ProxySocket::WaitReadable() {
+    uint64_t until_ns;
+    uint64_t now_ns;
+    bool deferred;
+    {
+        // Read together: a datagram queued after this is at now_ns or later
+        std::scoped_lock lock(m_queue_mutex);
+        until_ns = m_moderation_until_ns;
+        now_ns = ryu_ldn::platform::GetTickNs();
+        deferred = m_deferred_since_ns != 0;
     }
 
-    if (timeout_ms == 0) {
-        m_receive_event.Wait();
-        return true;
-    } else {
-        return m_receive_event.TimedWait(TimeSpan::FromMilliSeconds(timeout_ms));
+    if (until_ns <= now_ns) {
+        // Idle: the next datagram signals at once. One queued inside a window
+        // that ended before we got here was never signaled, deliver it now
+        if (!deferred) {
+            m_receive_event.Wait();
+            return;
+        }
+    } else if (m_receive_event.TimedWaitNs(until_ns - now_ns)) {
+        return;
+    }
+
+    // Window over: whatever arrived inside it is delivered now
+    std::scoped_lock lock(m_queue_mutex);
+    if (m_deferred_since_ns != 0) {
+        uint64_t delay_ns = ryu_ldn::platform::GetTickNs() - m_deferred_since_ns;
+        ryu_ldn::diagnostics::g_metrics.proxy_rx_moderation_us.Observe(delay_ns / 1000ULL);
+        ryu_ldn::diagnostics::g_metrics.proxy_rx_wakeups.Add();
+        m_deferred_since_ns = 0;
     }
 }
 
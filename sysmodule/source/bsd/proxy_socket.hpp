@@ -2,9 +2,10 @@
  * @file proxy_socket.hpp
  * @brief Proxy Socket for LDN Traffic Routing
  *
- * This file defines the ProxySocket class which represents a virtual socket
- * for LDN network communication. Instead of using real network sockets,
- * ProxySockets route data through ProxyData packets to the Ryujinx LDN server.
+ * This file defines the ProxySocket base class which represents a virtual
+ * socket for LDN network communication. Instead of using real network
+ * sockets, ProxySockets route data through ProxyData packets to the Ryujinx
+ * LDN server.
  *
  * ## Design
  *
@@ -13,6 +14,19 @@
  * - Receives data from a local queue populated by incoming ProxyData packets
  * - Tracks local/remote addresses in the virtual 10.114.x.x network
  *
+ * ProxySocket is a thin dispatch base holding the state every socket has
+ * (addresses, state, flags, receive event). The concrete type is picked by
+ * ProxySocketManager and only carries what its protocol needs:
+ *
+ * | Type                  | Receive queue          | Extra state             |
+ * |-----------------------|------------------------|-------------------------|
+ * | DatagramProxySocket   | PacketRing (64 slots)  | SO_BROADCAST            |
+ * | StreamProxySocket     | ByteRing (grows)       | Connect handshake       |
+ * | ListenerProxySocket   | Accept backlog         | -                       |
+ *
+ * The per-packet paths (IncomingData, RecvFrom, SendTo) are one virtual call
+ * into code specialized for the queue type, with no type or state branching.
+ *
  * ## Data Flow
  *
  * ```
@@ -28,6 +42,20 @@
  * The receive queue is protected by a mutex. The receive event can be used
  * to block until data is available (for blocking Recv calls).
  *
+ * ## Receive-Event Moderation
+ *
+ * With several peers broadcasting every frame, signaling each datagram
+ * wakes a blocked reader (and costs the game a Recv round trip) for one
+ * small packet at a time. Datagram sockets can moderate the signal: the
+ * first datagram after an idle window signals at once and opens a window;
+ * datagrams arriving inside it are only queued, and a reader blocked
+ * meanwhile wakes once at the end of the window to drain them all. The
+ * delay this adds is at most the window, and is observed into
+ * g_metrics.proxy_rx_moderation_us. Readers that poll or do not block
+ * always see queued data at once: select() and poll() report readiness
+ * from the queue, so only readers blocked in Recv/RecvFrom are batched.
+ * The window is therefore off unless configured (rx_moderation_us).
+ *
  * ## Lifecycle
  *
  * 1. Create: Socket() creates a new ProxySocket (unbound, unconnected)
@@ -42,9 +70,10 @@
 
 #pragma once
 
-#include <stratosphere.hpp>
-#include <deque>
-#include <vector>
+#include <memory>
+#include "../platform/platform.hpp"
+#include "../diagnostics/flight_recorder.hpp"
+#include "../diagnostics/metrics.hpp"
 #include "bsd_types.hpp"
 #include "../protocol/types.hpp"
 
@@ -54,7 +83,7 @@ namespace ams::mitm::bsd {
 class ProxySocketManager;
 
 /**
- * @brief Maximum size of the receive queue per socket
+ * @brief Maximum size of the receive queue per datagram socket
  *
  * Limits memory usage per socket. If the queue is full, oldest
  * packets are dropped (UDP behavior).
@@ -69,6 +98,16 @@ constexpr size_t PROXY_SOCKET_MAX_QUEUE_SIZE = 64;
  */
 constexpr size_t PROXY_SOCKET_MAX_PAYLOAD = 1400;
 
+/**
+ * @brief MSG_PEEK receive flag
+ */
+constexpr s32 PROXY_SOCKET_MSG_PEEK = 0x2;
+
+/**
+ * @brief MSG_DONTWAIT receive flag
+ */
+constexpr s32 PROXY_SOCKET_MSG_DONTWAIT = 0x40;
+
 /**
  * @brief State of a proxy socket
  */
@@ -81,77 +120,50 @@ enum class ProxySocketState {
     Closed,         ///< Socket closed, awaiting cleanup
 };
 
-/**
- * @brief Received packet data with source information
- *
- * Stores a received ProxyData packet along with the source address
- * for RecvFrom() calls.
- */
-struct ReceivedPacket {
-    std::vector<uint8_t> data;     ///< Packet payload
-    ryu_ldn::bsd::SockAddrIn from; ///< Source address
-};
-
 /**
  * @brief Proxy Socket for LDN Network Communication
  *
  * This class represents a virtual socket that routes traffic through
  * the Ryujinx LDN server via ProxyData packets instead of using real
- * network sockets.
+ * network sockets. Instances are created by ProxySocketManager as one of
+ * DatagramProxySocket, StreamProxySocket or ListenerProxySocket.
  *
  * ## Key Features
  *
  * - Mimics BSD socket API (bind, connect, send, recv)
  * - Routes data via ProxyData protocol to server
  * - Maintains receive queue for incoming data
- * - Supports both UDP and TCP semantics
  * - Thread-safe receive queue
  *
  * ## Example Usage
  *
  * ```cpp
  * // Create and bind a UDP proxy socket
- * auto socket = std::make_unique<ProxySocket>(SocketType::Dgram, ProtocolType::Udp);
+ * auto* socket = manager.CreateProxySocket(fd, SocketType::Dgram, ProtocolType::Udp);
  * socket->Bind(local_addr);
  *
  * // Send data to a peer
- * socket->SendTo(data, data_len, remote_addr);
+ * socket->SendTo(data, data_len, 0, remote_addr);
  *
  * // Receive data (blocking if no data available)
- * socket->RecvFrom(buffer, buffer_size, &from_addr);
+ * socket->RecvFrom(buffer, buffer_size, 0, &from_addr);
  * ```
  */
 class ProxySocket {
 public:
-    /**
-     * @brief Construct a new proxy socket
-     *
-     * Creates an unbound, unconnected proxy socket of the specified type.
-     *
-     * @param type Socket type (Stream for TCP, Dgram for UDP)
-     * @param protocol Protocol type (Tcp or Udp)
-     */
-    ProxySocket(ryu_ldn::bsd::SocketType type, ryu_ldn::bsd::ProtocolType protocol);
-
     /**
      * @brief Destructor
      *
      * Cleans up resources. Does NOT send ProxyDisconnect - call Close() first.
      */
-    ~ProxySocket();
+    virtual ~ProxySocket();
 
     /**
-     * @brief Non-copyable (socket identity is unique)
+     * @brief Non-copyable, non-movable (socket identity is unique)
      */
     ProxySocket(const ProxySocket&) = delete;
     ProxySocket& operator=(const ProxySocket&) = delete;
 
-    /**
-     * @brief Move constructor
-     */
-    ProxySocket(ProxySocket&&) = default;
-    ProxySocket& operator=(ProxySocket&&) = default;
-
     // =========================================================================
     // Socket State
     // =========================================================================
@@ -211,8 +223,6 @@ public:
      *
      * @param addr Remote address to connect to
      * @return Success or error
-     *
-     * @note For TCP, this should trigger sending ProxyConnect to the server
      */
     Result Connect(const ryu_ldn::bsd::SockAddrIn& addr);
 
@@ -263,12 +273,10 @@ public:
     /**
      * @brief Send data to a specific address
      *
-     * Sends data to the specified destination. Does not require connection.
-     *
      * @param data Pointer to data to send
      * @param len Length of data
      * @param flags Send flags (currently ignored)
-     * @param dest Destination address
+     * @param dest Destination address (ignored by connected stream sockets)
      * @return Bytes sent or negative errno on error
      */
     s32 SendTo(const void* data, size_t len, s32 flags, const ryu_ldn::bsd::SockAddrIn& dest);
@@ -302,7 +310,7 @@ public:
      * @brief Queue incoming data from a ProxyData packet
      *
      * Called by the ProxySocketManager when a ProxyData packet arrives
-     * that matches this socket.
+     * that matches this socket. Ignored by sockets that cannot receive data.
      *
      * @param data Packet payload
      * @param len Payload length
@@ -310,7 +318,7 @@ public:
      *
      * @note Thread-safe. Signals the receive event.
      */
-    void IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from);
+    virtual void IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from);
 
     // =========================================================================
     // Socket Options
@@ -328,7 +336,7 @@ public:
      * @param optlen Option value length
      * @return Success or error
      */
-    Result SetSockOpt(s32 level, s32 optname, const void* optval, size_t optlen);
+    virtual Result SetSockOpt(s32 level, s32 optname, const void* optval, size_t optlen);
 
     /**
      * @brief Get a socket option
@@ -339,74 +347,61 @@ public:
      * @param optlen Input/Output: option value length
      * @return Success or error
      */
-    Result GetSockOpt(s32 level, s32 optname, void* optval, size_t* optlen) const;
+    virtual Result GetSockOpt(s32 level, s32 optname, void* optval, size_t* optlen) const;
 
     // =========================================================================
-    // TCP-specific Operations
+    // TCP Handshake Events
     // =========================================================================
 
     /**
-     * @brief Start listening for connections (TCP only)
-     *
-     * @param backlog Maximum pending connections (currently ignored)
-     * @return Success or error if not TCP or not bound
-     */
-    Result Listen(s32 backlog);
-
-    /**
-     * @brief Accept a connection (TCP only)
-     *
-     * Blocks until a connection is available (unless non-blocking).
-     *
-     * @param out_addr Output: connecting peer's address
-     * @return New connected ProxySocket or nullptr on error
-     *
-     * @note The returned socket is owned by the caller
-     */
-    std::unique_ptr<ProxySocket> Accept(ryu_ldn::bsd::SockAddrIn* out_addr);
-
-    /**
-     * @brief Queue an incoming connection request (TCP listen socket)
+     * @brief Queue an incoming connection request (listener sockets)
      *
      * Called by ProxySocketManager when a ProxyConnect packet arrives
-     * for this listening socket.
+     * for this socket. Ignored by other socket types.
      *
      * @param request The connection request info
+     * @return true if the connection was queued (the peer is sent an accepting
+     *         ProxyConnectReply), false otherwise
      */
-    void IncomingConnection(const ryu_ldn::protocol::ProxyConnectRequest& request);
+    virtual bool IncomingConnection(const ryu_ldn::protocol::ProxyConnectRequest& request);
 
     /**
-     * @brief Handle connect response (for TCP connect handshake)
+     * @brief Handle connect response (stream sockets)
      *
      * Called by ProxySocketManager when ProxyConnectReply arrives.
+     * Ignored by other socket types.
      *
      * @param response The connect response
      */
-    void HandleConnectResponse(const ryu_ldn::protocol::ProxyConnectResponse& response);
-
-    /**
-     * @brief Check if accept queue has pending connections
-     * @return true if there are pending connections
-     */
-    bool HasPendingConnections() const;
+    virtual void HandleConnectResponse(const ryu_ldn::protocol::ProxyConnectResponse& response);
 
     /**
-     * @brief Get broadcast flag
-     * @return true if SO_BROADCAST is enabled
+     * @brief Check if a ProxyConnectReply is expected for this socket
+     *
+     * True while connecting, and for an optimistically connected stream
+     * until its reply arrives.
      */
-    bool IsBroadcastEnabled() const { return m_broadcast; }
+    virtual bool IsAwaitingConnectResponse() const;
 
     /**
-     * @brief Set broadcast flag (SO_BROADCAST)
-     * @param enabled true to enable broadcast reception
+     * @brief Handle a window update from the peer (stream sockets)
+     *
+     * Called by ProxySocketManager when the peer reports how much of the
+     * stream its game has read. Ignored by other socket types.
+     *
+     * @param peer_read_total Bytes the peer has read since the stream opened (wraps)
      */
-    void SetBroadcastEnabled(bool enabled) { m_broadcast = enabled; }
+    virtual void HandleStreamWindow(uint32_t peer_read_total);
 
     /**
-     * @brief Set broadcast address for filtering
-     * @param addr Broadcast address (e.g., 10.114.255.255)
+     * @brief Re-send a window update whose send failed (stream sockets)
+     *
+     * Called periodically by ProxySocketManager::RetryStreamWindows(): a
+     * reader that drained its queue reads nothing more, so the next read
+     * would never retry it and the peer would wait forever. Ignored by other
+     * socket types.
      */
-    void SetBroadcastAddress(uint32_t addr) { m_broadcast_address = addr; }
+    virtual void RetryStreamWindow();
 
     // =========================================================================
     // Shutdown and Close
@@ -435,16 +430,23 @@ public:
     // =========================================================================
 
     /**
-     * @brief Check if data is available to read
-     * @return true if receive queue is not empty
+     * @brief Check if the socket is readable
+     * @return true if data (or, for listeners, a connection) is queued
      */
-    bool HasPendingData() const;
+    virtual bool HasPendingData() const = 0;
 
     /**
      * @brief Get the number of bytes available to read
      * @return Total bytes in receive queue
      */
-    size_t GetPendingDataSize() const;
+    virtual size_t GetPendingDataSize() const = 0;
+
+    /**
+     * @brief Check if the socket is writable
+     * @return false only while a send would block (stream waiting for the
+     *         peer's window)
+     */
+    virtual bool IsWritable() const;
 
     /**
      * @brief Wait for data to be available
@@ -452,7 +454,8 @@ public:
      * Blocks until data is available or timeout expires.
      *
      * @param timeout_ms Timeout in milliseconds (0 = infinite)
-     * @return true if data is available, false if timeout
+     * @return true if data is available, false on timeout, Shutdown()
+     *         or Close()
      */
     bool WaitForData(u64 timeout_ms);
 
@@ -463,117 +466,187 @@ public:
      *
      * @return Reference to the receive event
      */
-    os::Event& GetReceiveEvent() { return m_receive_event; }
+    ryu_ldn::platform::Event& GetReceiveEvent() { return m_receive_event; }
 
-private:
     /**
-     * @brief Pop the front packet from the receive queue
+     * @brief Set the receive-event moderation window
      *
-     * @param peek If true, don't remove from queue (MSG_PEEK)
-     * @return The front packet, or empty if queue is empty
+     * @param window_us Window in microseconds, 0 to signal every packet
+     */
+    void SetReceiveModeration(uint32_t window_us);
+
+protected:
+    /**
+     * @brief Construct the common part of a proxy socket
      *
-     * @note Caller must hold m_queue_mutex
+     * Creates an unbound, unconnected proxy socket of the specified type.
+     *
+     * @param type Socket type (Stream for TCP, Dgram for UDP)
+     * @param protocol Protocol type (Tcp or Udp)
      */
-    ReceivedPacket PopFrontPacket(bool peek);
+    ProxySocket(ryu_ldn::bsd::SocketType type, ryu_ldn::bsd::ProtocolType protocol);
 
     /**
-     * @brief Socket type (Stream or Dgram)
+     * @brief Type-specific part of Connect(), after state and family checks
      */
-    ryu_ldn::bsd::SocketType m_type;
+    virtual Result ConnectImpl(const ryu_ldn::bsd::SockAddrIn& addr) = 0;
 
     /**
-     * @brief Protocol type (Tcp or Udp)
+     * @brief Type-specific part of SendTo(), after state and argument checks
      */
-    ryu_ldn::bsd::ProtocolType m_protocol;
+    virtual s32 SendToImpl(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) = 0;
 
     /**
-     * @brief Current socket state
+     * @brief Type-specific part of RecvFrom(), after state and argument checks
      */
-    ProxySocketState m_state{ProxySocketState::Created};
+    virtual s32 RecvFromImpl(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::SockAddrIn* from) = 0;
 
     /**
-     * @brief Non-blocking mode flag
+     * @brief Drop everything queued for reading
+     *
+     * @note Called with m_queue_mutex held
      */
-    bool m_non_blocking{false};
+    virtual void ClearQueue() = 0;
 
     /**
-     * @brief Shutdown flags
+     * @brief Shared RecvFrom body, specialized per queue type
+     *
+     * Handles MSG_PEEK, MSG_DONTWAIT/non-blocking and the blocking wait on
+     * m_receive_event. Queue is PacketRing or ByteRing. A pending
+     * m_socket_error is reported once the queue is drained.
+     *
+     * @return Bytes read, -EAGAIN or -m_socket_error
      */
-    bool m_shutdown_read{false};
-    bool m_shutdown_write{false};
+    template <typename Queue>
+    s32 ReadQueue(Queue& queue, void* buffer, size_t len, s32 flags,
+                  ryu_ldn::bsd::SockAddrIn* from) {
+        bool peek = (flags & PROXY_SOCKET_MSG_PEEK) != 0;
+        bool dontwait = (flags & PROXY_SOCKET_MSG_DONTWAIT) != 0 || m_non_blocking;
+
+        while (true) {
+            {
+                std::scoped_lock lock(m_queue_mutex);
+                if (!queue.Empty()) {
+                    size_t queued = queue.Size();
+                    uint64_t queued_ns = peek ? 0 : queue.FrontQueuedNs();
+                    size_t copied = queue.Read(buffer, len, peek, from);
+                    ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Add(
+                        static_cast<int64_t>(queue.Size()) - static_cast<int64_t>(queued));
+                    if (queued_ns != 0) {
+                        ryu_ldn::diagnostics::g_flight_recorder.queue_delay(
+                            m_local_addr.GetPort(), ryu_ldn::platform::GetTickNs() - queued_ns, queue.Size());
+                    }
+                    if (queue.Empty()) {
+                        m_receive_event.Clear();
+                        m_deferred_since_ns = 0;
+                    }
+                    return static_cast<s32>(copied);
+                }
+                if (m_socket_error != 0) {
+                    return -m_socket_error;
+                }
+                if (dontwait || m_shutdown_read) {
+                    break;
+                }
+            }
+
+            // Woken by new data, the end of a moderation window, Shutdown() or Close()
+            WaitReadable();
+            if (m_shutdown_read) {
+                return 0;
+            }
+        }
+
+        return m_shutdown_read ? 0 : -static_cast<s32>(ryu_ldn::bsd::BsdErrno::Again);
+    }
 
     /**
-     * @brief Local address (set by Bind)
+     * @brief Wake blocked readers for newly queued data, moderated
+     *
+     * @note Called with m_queue_mutex held
      */
-    ryu_ldn::bsd::SockAddrIn m_local_addr{};
+    void NotifyReadable();
 
     /**
-     * @brief Remote address (set by Connect)
+     * @brief Block until signaled or, inside a moderation window, its end
+     *
+     * @note Called without m_queue_mutex
      */
-    ryu_ldn::bsd::SockAddrIn m_remote_addr{};
+    void WaitReadable();
 
     /**
-     * @brief Receive queue mutex
+     * @brief Send one ProxyData packet from the local address
+     *
+     * @return len, or -ENETUNREACH if no server connection is registered
      */
-    mutable os::Mutex m_queue_mutex{false};
+    s32 SendProxyData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest);
 
     /**
-     * @brief Receive queue (incoming packets)
+     * @brief Socket type (Stream or Dgram)
      */
-    std::deque<ReceivedPacket> m_receive_queue;
+    ryu_ldn::bsd::SocketType m_type;
 
     /**
-     * @brief Event signaled when data is available
+     * @brief Protocol type (Tcp or Udp)
      */
-    os::Event m_receive_event{os::EventClearMode_ManualClear};
+    ryu_ldn::bsd::ProtocolType m_protocol;
 
     /**
-     * @brief TCP accept queue (pending connections)
+     * @brief Current socket state
      */
-    std::deque<std::unique_ptr<ProxySocket>> m_accept_queue;
+    ProxySocketState m_state{ProxySocketState::Created};
 
     /**
-     * @brief Event signaled when accept queue has connections
+     * @brief Non-blocking mode flag
      */
-    os::Event m_accept_event{os::EventClearMode_ManualClear};
+    bool m_non_blocking{false};
 
     /**
-     * @brief TCP connect response received flag
+     * @brief Shutdown flags
      */
-    bool m_connect_response_received{false};
+    bool m_shutdown_read{false};
+    bool m_shutdown_write{false};
 
     /**
-     * @brief TCP connect response data (valid when m_connect_response_received is true)
+     * @brief Pending error (errno) reported by RecvFrom and SO_ERROR, 0 if none
      */
-    ryu_ldn::protocol::ProxyConnectResponse m_connect_response{};
+    s32 m_socket_error{0};
 
     /**
-     * @brief Event signaled when connect response is received
+     * @brief Local address (set by Bind)
      */
-    os::Event m_connect_event{os::EventClearMode_ManualClear};
+    ryu_ldn::bsd::SockAddrIn m_local_addr{};
 
     /**
-     * @brief Broadcast flag (SO_BROADCAST)
-     *
-     * When false, incoming broadcast packets are filtered out.
-     * When true, broadcast packets are accepted.
+     * @brief Remote address (set by Connect)
      */
-    bool m_broadcast{false};
+    ryu_ldn::bsd::SockAddrIn m_remote_addr{};
 
     /**
-     * @brief Broadcast address for filtering
-     *
-     * Calculated as: local_ip | ~subnet_mask (e.g., 10.114.255.255)
+     * @brief Receive queue mutex
      */
-    uint32_t m_broadcast_address{0};
+    mutable ryu_ldn::platform::Mutex m_queue_mutex;
 
     /**
-     * @brief Socket options storage
-     *
-     * Most options are stored locally since we're proxying.
-     * Format: map of (level << 16 | optname) -> value
+     * @brief Event signaled when the socket is readable
+     */
+    ryu_ldn::platform::Event m_receive_event{ryu_ldn::platform::EventClearMode::Manual};
+
+    /**
+     * @brief Moderation window (ns), 0 = signal every packet
+     */
+    uint64_t m_moderation_ns{0};
+
+    /**
+     * @brief End of the current moderation window (guarded by m_queue_mutex)
+     */
+    uint64_t m_moderation_until_ns{0};
+
+    /**
+     * @brief Arrival of the first datagram queued without a signal, 0 if none
+     * (guarded by m_queue_mutex)
      */
-    // TODO: Add options storage if needed
+    uint64_t m_deferred_since_ns{0};
 };
 
 } // namespace ams::mitm::bsd
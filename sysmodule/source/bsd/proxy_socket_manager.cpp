@@ -11,6 +11,8 @@
 
 #include "proxy_socket_manager.hpp"
 
+#include <array>
+
 namespace ams::mitm::bsd {
 
 // =============================================================================
@@ -26,14 +28,14 @@ ProxySocketManager& ProxySocketManager::GetInstance() {
 // Socket Management
 // =============================================================================
 
-ProxySocket* ProxySocketManager::CreateProxySocket(s32 fd, ryu_ldn::bsd::SocketType type,
+std::shared_ptr<ProxySocket> ProxySocketManager::CreateProxySocket(s32 fd, ryu_ldn::bsd::SocketType type,
                                                     ryu_ldn::bsd::ProtocolType protocol) {
     std::scoped_lock lock(m_mutex);
 
     // Check if fd already has a proxy socket
     if (m_sockets.find(fd) != m_sockets.end()) {
         // Already exists - return existing
-        return m_sockets[fd].get();
+        return m_sockets[fd];
     }
 
     // Check limit
@@ -41,22 +43,80 @@ ProxySocket* ProxySocketManager::CreateProxySocket(s32 fd, ryu_ldn::bsd::SocketT
         return nullptr;
     }
 
-    // Create new proxy socket
-    auto socket = std::make_unique<ProxySocket>(type, protocol);
-    ProxySocket* result = socket.get();
+    // Create new proxy socket of the matching type
+    std::shared_ptr<ProxySocket> socket;
+    if (type == ryu_ldn::bsd::SocketType::Stream) {
+        socket = std::make_shared<StreamProxySocket>(protocol);
+    } else {
+        socket = std::make_shared<DatagramProxySocket>(protocol);
+        socket->SetReceiveModeration(m_rx_moderation_us);
+    }
 
     // Add to registry
+    m_sockets[fd] = socket;
+    ryu_ldn::diagnostics::g_metrics.proxy_sockets.Set(static_cast<int64_t>(m_sockets.size()));
+
+    return socket;
+}
+
+std::shared_ptr<ListenerProxySocket> ProxySocketManager::ListenProxySocket(s32 fd, s32 backlog) {
+    std::scoped_lock lock(m_mutex);
+
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end() || it->second == nullptr) {
+        return nullptr;
+    }
+
+    const std::shared_ptr<ProxySocket>& socket = it->second;
+    if (socket->GetType() != ryu_ldn::bsd::SocketType::Stream) {
+        return nullptr;
+    }
+
+    // listen() twice only updates the backlog on a real stack
+    if (socket->GetState() == ProxySocketState::Listening) {
+        return std::static_pointer_cast<ListenerProxySocket>(socket);
+    }
+
+    // Must be bound, and not connected
+    if (socket->GetState() != ProxySocketState::Bound) {
+        return nullptr;
+    }
+
+    auto listener = std::make_shared<ListenerProxySocket>(
+        socket->GetProtocol(), socket->GetLocalAddr(), socket->IsNonBlocking(), backlog);
+
+    // Callers still holding the stream socket keep it alive until they are
+    // done; closing it wakes the ones blocked on it
+    std::shared_ptr<ProxySocket> replaced = std::move(it->second);
+    it->second = listener;
+    replaced->Close();
+
+    return listener;
+}
+
+StreamProxySocket* ProxySocketManager::RegisterAcceptedSocket(s32 fd, std::unique_ptr<StreamProxySocket> socket) {
+    std::scoped_lock lock(m_mutex);
+
+    if (socket == nullptr || m_sockets.find(fd) != m_sockets.end()) {
+        return nullptr;
+    }
+    if (m_sockets.size() >= MAX_PROXY_SOCKETS) {
+        return nullptr;
+    }
+
+    StreamProxySocket* result = socket.get();
     m_sockets[fd] = std::move(socket);
+    ryu_ldn::diagnostics::g_metrics.proxy_sockets.Set(static_cast<int64_t>(m_sockets.size()));
 
     return result;
 }
 
-ProxySocket* ProxySocketManager::GetProxySocket(s32 fd) {
+std::shared_ptr<ProxySocket> ProxySocketManager::GetProxySocket(s32 fd) {
     std::scoped_lock lock(m_mutex);
 
     auto it = m_sockets.find(fd);
     if (it != m_sockets.end()) {
-        return it->second.get();
+        return it->second;
     }
 
     return nullptr;
@@ -78,9 +138,9 @@ bool ProxySocketManager::CloseProxySocket(s32 fd) {
     // Get socket info before closing
     ProxySocket* socket = it->second.get();
     if (socket != nullptr) {
-        // Release the port
+        // Release the port, unless a listener and its accepted sockets still share it
         const auto& local_addr = socket->GetLocalAddr();
-        if (local_addr.GetPort() != 0) {
+        if (local_addr.GetPort() != 0 && !IsPortShared(socket)) {
             m_port_pool.ReleasePort(local_addr.GetPort(), socket->GetProtocol());
         }
 
@@ -94,10 +154,25 @@ bool ProxySocketManager::CloseProxySocket(s32 fd) {
 
     // Remove from registry
     m_sockets.erase(it);
+    ryu_ldn::diagnostics::g_metrics.proxy_sockets.Set(static_cast<int64_t>(m_sockets.size()));
 
     return true;
 }
 
+bool ProxySocketManager::IsPortShared(const ProxySocket* socket) const {
+    // Caller must hold m_mutex
+    for (const auto& [fd, other] : m_sockets) {
+        if (other == nullptr || other.get() == socket) {
+            continue;
+        }
+        if (other->GetProtocol() == socket->GetProtocol() &&
+            other->GetLocalAddr().GetPort() == socket->GetLocalAddr().GetPort()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void ProxySocketManager::CloseAllProxySockets() {
     std::scoped_lock lock(m_mutex);
 
@@ -114,6 +189,7 @@ void ProxySocketManager::CloseAllProxySockets() {
 
     // Clear registry
     m_sockets.clear();
+    ryu_ldn::diagnostics::g_metrics.proxy_sockets.Set(0);
 
     // Release all ports
     m_port_pool.ReleaseAll();
@@ -158,9 +234,35 @@ bool ProxySocketManager::SendProxyData(uint32_t source_ip, uint16_t source_port,
         return false;
     }
 
+    // A repeat the peers already have is reported as sent to the game
+    if (m_broadcast_filter.ShouldSuppress(source_port, dest_ip, dest_port, protocol,
+                                          data, data_len, ryu_ldn::platform::GetTickMs())) {
+        ryu_ldn::diagnostics::g_metrics.proxy_tx_suppressed.Add();
+        ryu_ldn::diagnostics::g_metrics.proxy_tx_suppressed_bytes.Add(data_len);
+        return true;
+    }
+
     return callback(source_ip, source_port, dest_ip, dest_port, protocol, data, data_len);
 }
 
+void ProxySocketManager::ConfigureBroadcastFilter(const BroadcastFilterConfig& config) {
+    m_broadcast_filter.Configure(config);
+}
+
+BroadcastFilterStats ProxySocketManager::GetBroadcastFilterStats() const {
+    return m_broadcast_filter.GetStats();
+}
+
+void ProxySocketManager::SetReceiveModeration(uint32_t window_us) {
+    std::scoped_lock lock(m_mutex);
+    m_rx_moderation_us = window_us;
+    for (auto& [fd, socket] : m_sockets) {
+        if (socket != nullptr && socket->GetType() == ryu_ldn::bsd::SocketType::Dgram) {
+            socket->SetReceiveModeration(window_us);
+        }
+    }
+}
+
 void ProxySocketManager::SetProxyConnectCallback(SendProxyConnectCallback callback) {
     std::scoped_lock lock(m_mutex);
     m_proxy_connect_callback = callback;
@@ -182,10 +284,25 @@ bool ProxySocketManager::SendProxyConnect(uint32_t source_ip, uint16_t source_po
     return callback(source_ip, source_port, dest_ip, dest_port, protocol);
 }
 
+void ProxySocketManager::SetOptimisticPeerCallback(OptimisticPeerCallback callback) {
+    std::scoped_lock lock(m_mutex);
+    m_optimistic_peer_callback = callback;
+}
+
+bool ProxySocketManager::IsOptimisticPeer(uint32_t ip) {
+    OptimisticPeerCallback callback;
+    {
+        std::scoped_lock lock(m_mutex);
+        callback = m_optimistic_peer_callback;
+    }
+
+    return callback != nullptr && callback(ip);
+}
+
 bool ProxySocketManager::RouteConnectResponse(const ryu_ldn::protocol::ProxyConnectResponse& response) {
     std::scoped_lock lock(m_mutex);
 
-    // Find socket in Connecting state that matches the destination
+    // Find socket waiting for a reply (connecting, or connected optimistically)
     uint32_t dest_ip = response.info.source_ipv4;  // Response comes back to our source
     uint16_t dest_port = response.info.source_port;
 
@@ -194,8 +311,7 @@ bool ProxySocketManager::RouteConnectResponse(const ryu_ldn::protocol::ProxyConn
             continue;
         }
 
-        // Check if socket is connecting
-        if (socket->GetState() != ProxySocketState::Connecting) {
+        if (!socket->IsAwaitingConnectResponse()) {
             continue;
         }
 
@@ -250,8 +366,7 @@ bool ProxySocketManager::RouteConnectRequest(const ryu_ldn::protocol::ProxyConne
         }
 
         // Found matching listener - queue the connection
-        socket->IncomingConnection(request);
-        return true;
+        return socket->IncomingConnection(request);
     }
 
     return false;
@@ -261,6 +376,61 @@ bool ProxySocketManager::RouteConnectRequest(const ryu_ldn::protocol::ProxyConne
 // Data Routing
 // =============================================================================
 
+void ProxySocketManager::SetStreamWindowCallback(SendStreamWindowCallback callback) {
+    std::scoped_lock lock(m_mutex);
+    m_stream_window_callback = callback;
+}
+
+bool ProxySocketManager::SendStreamWindow(uint32_t source_ip, uint16_t source_port,
+                                          uint32_t dest_ip, uint16_t dest_port,
+                                          uint32_t read_total) {
+    SendStreamWindowCallback callback;
+    {
+        std::scoped_lock lock(m_mutex);
+        callback = m_stream_window_callback;
+    }
+
+    if (callback == nullptr) {
+        return false;
+    }
+
+    return callback(source_ip, source_port, dest_ip, dest_port, read_total);
+}
+
+bool ProxySocketManager::RouteStreamWindow(uint32_t source_ip, uint16_t source_port,
+                                           uint32_t dest_ip, uint16_t dest_port,
+                                           uint32_t read_total) {
+    std::scoped_lock lock(m_mutex);
+
+    // Same match as the stream's data, a listener on the port does not count
+    ProxySocket* socket = FindSocketByDestination(source_ip, source_port, dest_ip, dest_port,
+                                                  ryu_ldn::bsd::ProtocolType::Tcp);
+    if (socket == nullptr || socket->GetState() != ProxySocketState::Connected) {
+        return false;
+    }
+
+    socket->HandleStreamWindow(read_total);
+    return true;
+}
+
+void ProxySocketManager::RetryStreamWindows() {
+    std::array<std::shared_ptr<ProxySocket>, MAX_PROXY_SOCKETS> streams;
+    size_t count = 0;
+    {
+        std::scoped_lock lock(m_mutex);
+        for (const auto& [fd, socket] : m_sockets) {
+            if (socket != nullptr && socket->GetType() == ryu_ldn::bsd::SocketType::Stream &&
+                count < streams.size()) {
+                streams[count++] = socket;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        streams[i]->RetryStreamWindow();
+    }
+}
+
 bool ProxySocketManager::RouteIncomingData(uint32_t source_ip, uint16_t source_port,
                                             uint32_t dest_ip, uint16_t dest_port,
                                             ryu_ldn::bsd::ProtocolType protocol,
@@ -268,12 +438,16 @@ bool ProxySocketManager::RouteIncomingData(uint32_t source_ip, uint16_t source_p
     std::scoped_lock lock(m_mutex);
 
     // Find socket matching destination
-    ProxySocket* socket = FindSocketByDestination(dest_ip, dest_port, protocol);
+    ProxySocket* socket = FindSocketByDestination(source_ip, source_port, dest_ip, dest_port, protocol);
     if (socket == nullptr) {
         // No matching socket found
+        ryu_ldn::diagnostics::g_metrics.proxy_rx_unrouted.Add();
         return false;
     }
 
+    ryu_ldn::diagnostics::g_metrics.proxy_rx_packets.Add();
+    ryu_ldn::diagnostics::g_metrics.proxy_rx_bytes.Add(data_len);
+
     // Build source address for RecvFrom
     ryu_ldn::bsd::SockAddrIn from_addr{};
     from_addr.sin_len = sizeof(from_addr);
@@ -283,19 +457,21 @@ bool ProxySocketManager::RouteIncomingData(uint32_t source_ip, uint16_t source_p
 
     // Queue data to socket
     socket->IncomingData(data, data_len, from_addr);
+    int64_t queued = ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Load();
+    ryu_ldn::diagnostics::g_flight_recorder.proxy_rx(dest_port, data_len,
+                                                     queued > 0 ? static_cast<size_t>(queued) : 0);
 
     return true;
 }
 
-ProxySocket* ProxySocketManager::FindSocketByDestination(uint32_t dest_ip, uint16_t dest_port,
+ProxySocket* ProxySocketManager::FindSocketByDestination(uint32_t source_ip, uint16_t source_port,
+                                                          uint32_t dest_ip, uint16_t dest_port,
                                                           ryu_ldn::bsd::ProtocolType protocol) {
     // Caller must hold m_mutex
 
-    // Check if dest_ip is a broadcast address (ends in .255 or .255.255)
-    // LDN subnet is 10.114.x.x with mask 255.255.0.0, so broadcast is 10.114.255.255
-    bool is_broadcast = ((dest_ip & 0xFF) == 0xFF) ||     // x.x.x.255
-                        ((dest_ip & 0xFFFF) == 0xFFFF);   // x.x.255.255
+    bool is_broadcast = ryu_ldn::bsd::IsBroadcastAddress(dest_ip);
 
+    ProxySocket* listener_match = nullptr;
     for (auto& [fd, socket] : m_sockets) {
         if (socket == nullptr) {
             continue;
@@ -314,29 +490,40 @@ ProxySocket* ProxySocketManager::FindSocketByDestination(uint32_t dest_ip, uint1
             continue;
         }
 
+        // A connected TCP socket only receives from its peer: a listener and
+        // its accepted connections share the port
+        bool connected_stream = protocol == ryu_ldn::bsd::ProtocolType::Tcp &&
+                                socket->GetState() == ProxySocketState::Connected;
+        if (connected_stream) {
+            const auto& remote_addr = socket->GetRemoteAddr();
+            if (remote_addr.GetAddr() != source_ip || remote_addr.GetPort() != source_port) {
+                continue;
+            }
+        }
+
         // IP matching:
         // 1. INADDR_ANY (bound to 0.0.0.0 - accepts any destination)
         // 2. Exact match (bound to specific IP)
         // 3. Broadcast: any socket on the same port receives broadcast packets
+        //    (same subnet, 10.114.x.x)
         uint32_t local_ip = local_addr.GetAddr();
-        if (local_ip == 0) {
-            // Bound to INADDR_ANY - accepts all
-            return socket.get();
-        }
-        if (local_ip == dest_ip) {
-            // Exact match
-            return socket.get();
+        bool matches = local_ip == 0 || local_ip == dest_ip ||
+                       (is_broadcast && (local_ip & 0xFFFF0000) == (dest_ip & 0xFFFF0000));
+        if (!matches) {
+            continue;
         }
-        if (is_broadcast) {
-            // Broadcast packet - deliver to any socket bound on this port
-            // Check if socket is in the same subnet (10.114.x.x)
-            if ((local_ip & 0xFFFF0000) == (dest_ip & 0xFFFF0000)) {
-                return socket.get();
+
+        // The connection itself wins over the listener it came from
+        if (protocol == ryu_ldn::bsd::ProtocolType::Tcp && !connected_stream) {
+            if (listener_match == nullptr) {
+                listener_match = socket.get();
             }
+            continue;
         }
+        return socket.get();
     }
 
-    return nullptr;
+    return listener_match;
 }
 
 // =============================================================================
@@ -61,11 +61,14 @@
 
 #pragma once
 
-#include <stratosphere.hpp>
 #include <unordered_map>
 #include <memory>
-#include "proxy_socket.hpp"
+#include "../platform/platform.hpp"
+#include "datagram_proxy_socket.hpp"
+#include "stream_proxy_socket.hpp"
+#include "listener_proxy_socket.hpp"
 #include "ephemeral_port_pool.hpp"
+#include "broadcast_filter.hpp"
 #include "bsd_types.hpp"
 #include "../protocol/types.hpp"
 
@@ -127,26 +130,63 @@ public:
      * Called when we detect that a socket should be proxied (LDN address
      * in Bind or Connect).
      *
+     * Stream types get a StreamProxySocket, everything else a
+     * DatagramProxySocket.
+     *
      * @param fd File descriptor from the real BSD service
      * @param type Socket type (Stream or Dgram)
      * @param protocol Protocol type (Tcp or Udp)
-     * @return Pointer to the created ProxySocket, or nullptr if failed
+     * @return Shared handle to the created ProxySocket, or nullptr if failed
      *
      * @note Thread-safe
      * @note Returns nullptr if fd already has a proxy socket
      */
-    ProxySocket* CreateProxySocket(s32 fd, ryu_ldn::bsd::SocketType type, ryu_ldn::bsd::ProtocolType protocol);
+    std::shared_ptr<ProxySocket> CreateProxySocket(s32 fd, ryu_ldn::bsd::SocketType type, ryu_ldn::bsd::ProtocolType protocol);
+
+    /**
+     * @brief Put a bound stream socket in the LISTEN state
+     *
+     * Replaces the StreamProxySocket of fd with a ListenerProxySocket on the
+     * same address. The stream socket is closed; handles previously returned
+     * by GetProxySocket() keep it alive, so concurrent calls on fd end on it
+     * instead of touching freed memory.
+     *
+     * @param fd File descriptor of a bound stream proxy socket
+     * @param backlog Maximum pending connections
+     * @return The listener (existing one if already listening), or nullptr
+     *         if fd is not a bound stream proxy socket
+     *
+     * @note Thread-safe
+     */
+    std::shared_ptr<ListenerProxySocket> ListenProxySocket(s32 fd, s32 backlog);
+
+    /**
+     * @brief Register a connection returned by ListenerProxySocket::Accept()
+     *
+     * From then on, data from the peer is routed to this socket instead of
+     * the listener. The socket shares the listener's port, which is only
+     * released when the last socket using it is closed.
+     *
+     * @param fd File descriptor given to the game for the connection
+     * @param socket Accepted connection
+     * @return The registered socket, or nullptr if fd is in use or the
+     *         registry is full
+     *
+     * @note Thread-safe
+     */
+    StreamProxySocket* RegisterAcceptedSocket(s32 fd, std::unique_ptr<StreamProxySocket> socket);
 
     /**
      * @brief Get the proxy socket for a file descriptor
      *
      * @param fd File descriptor to look up
-     * @return Pointer to the ProxySocket, or nullptr if not a proxy socket
+     * @return Shared handle to the ProxySocket, or nullptr if not a proxy socket
      *
      * @note Thread-safe
-     * @note The returned pointer is valid as long as the socket is not closed
+     * @note The handle keeps the socket alive even if fd is closed or
+     *       replaced by ListenProxySocket() meanwhile
      */
-    ProxySocket* GetProxySocket(s32 fd);
+    std::shared_ptr<ProxySocket> GetProxySocket(s32 fd);
 
     /**
      * @brief Check if a file descriptor has an associated proxy socket
@@ -228,6 +268,9 @@ public:
      * Finds the socket that matches the destination address/port and queues
      * the data for that socket.
      *
+     * A connected TCP socket only receives from its peer, so that accepted
+     * connections sharing a port each get their own stream.
+     *
      * @param source_ip Source IP (host byte order)
      * @param source_port Source port (host byte order)
      * @param dest_ip Destination IP (host byte order)
@@ -291,7 +334,8 @@ public:
      * @param protocol Protocol type
      * @param data Packet payload
      * @param data_len Payload length
-     * @return true if data was sent, false if no callback registered or send failed
+     * @return true if data was sent or suppressed as a broadcast repeat,
+     *         false if no callback registered or send failed
      *
      * @note Thread-safe
      */
@@ -300,6 +344,34 @@ public:
                        ryu_ldn::bsd::ProtocolType protocol,
                        const void* data, size_t data_len);
 
+    /**
+     * @brief Configure the upstream broadcast repeat filter
+     *
+     * Disabled until configured. See BroadcastFilter for the rule.
+     *
+     * @param config Filter options
+     *
+     * @note Thread-safe
+     */
+    void ConfigureBroadcastFilter(const BroadcastFilterConfig& config);
+
+    /**
+     * @brief Get the broadcast repeat filter counters
+     */
+    BroadcastFilterStats GetBroadcastFilterStats() const;
+
+    /**
+     * @brief Set the receive-event moderation window of datagram sockets
+     *
+     * Applies to open datagram sockets and to those created later.
+     * Disabled (0) until configured. See ProxySocket for the rule.
+     *
+     * @param window_us Window in microseconds, 0 to signal every packet
+     *
+     * @note Thread-safe
+     */
+    void SetReceiveModeration(uint32_t window_us);
+
     /**
      * @brief Callback type for sending ProxyConnect to the LDN server
      *
@@ -345,6 +417,35 @@ public:
                           uint32_t dest_ip, uint16_t dest_port,
                           ryu_ldn::bsd::ProtocolType protocol);
 
+    /**
+     * @brief Callback type telling whether a peer runs ryu_ldn_nx
+     *
+     * @param ip Peer IP (host byte order)
+     * @return true if the peer is known to handle an optimistic connect
+     */
+    using OptimisticPeerCallback = bool (*)(uint32_t ip);
+
+    /**
+     * @brief Set the callback enabling optimistic TCP connects
+     *
+     * Without a callback every connect waits for the ProxyConnectReply.
+     *
+     * @param callback Function to call on each TCP connect, or nullptr
+     *
+     * @note Thread-safe
+     */
+    void SetOptimisticPeerCallback(OptimisticPeerCallback callback);
+
+    /**
+     * @brief Check if a connect to this peer may complete before its reply
+     *
+     * @param ip Peer IP (host byte order)
+     * @return true if the peer runs ryu_ldn_nx (see StreamProxySocket)
+     *
+     * @note Thread-safe
+     */
+    bool IsOptimisticPeer(uint32_t ip);
+
     /**
      * @brief Route incoming ProxyConnectReply to the connecting socket
      *
@@ -364,12 +465,83 @@ public:
      * for a listening socket (incoming TCP connection).
      *
      * @param request The connect request
-     * @return true if routed successfully, false if no matching listener
+     * @return true if a listener queued the connection, false if there is no
+     *         matching listener or its backlog is full
      *
      * @note Thread-safe
      */
     bool RouteConnectRequest(const ryu_ldn::protocol::ProxyConnectRequest& request);
 
+    // =========================================================================
+    // Stream Flow Control
+    // =========================================================================
+
+    /**
+     * @brief Callback type for sending a stream window update to the peer
+     *
+     * @param source_ip Source IP (host byte order)
+     * @param source_port Source port (host byte order)
+     * @param dest_ip Destination IP (host byte order)
+     * @param dest_port Destination port (host byte order)
+     * @param read_total Bytes the game has read from the stream (wraps)
+     * @return true if sent, false if the peer has no flow control or the send failed
+     */
+    using SendStreamWindowCallback = bool (*)(uint32_t source_ip, uint16_t source_port,
+                                              uint32_t dest_ip, uint16_t dest_port,
+                                              uint32_t read_total);
+
+    /**
+     * @brief Set the callback for sending stream window updates
+     *
+     * Without a callback no updates are sent and peers never throttle.
+     *
+     * @param callback Function to call when a stream reader advances, or nullptr
+     *
+     * @note Thread-safe
+     */
+    void SetStreamWindowCallback(SendStreamWindowCallback callback);
+
+    /**
+     * @brief Send a stream window update (see StreamProxySocket)
+     *
+     * @return true if sent, false if no callback or the callback failed
+     *
+     * @note Thread-safe
+     */
+    bool SendStreamWindow(uint32_t source_ip, uint16_t source_port,
+                          uint32_t dest_ip, uint16_t dest_port,
+                          uint32_t read_total);
+
+    /**
+     * @brief Route an incoming window update to the connected stream
+     *
+     * Called by the LDN MITM service for a ProxyData carrying
+     * PROXY_STREAM_WINDOW_FLAG.
+     *
+     * @param source_ip Source IP of the update, the stream's remote (host byte order)
+     * @param source_port Source port of the update (host byte order)
+     * @param dest_ip Destination IP of the update, the stream's local (host byte order)
+     * @param dest_port Destination port of the update (host byte order)
+     * @param read_total Bytes the peer has read from the stream (wraps)
+     * @return true if a connected stream took the update
+     *
+     * @note Thread-safe
+     */
+    bool RouteStreamWindow(uint32_t source_ip, uint16_t source_port,
+                           uint32_t dest_ip, uint16_t dest_port,
+                           uint32_t read_total);
+
+    /**
+     * @brief Re-send the window updates whose send failed
+     *
+     * Called periodically by the LDN background thread, see
+     * ProxySocket::RetryStreamWindow(). The updates are sent without the
+     * registry lock held.
+     *
+     * @note Thread-safe
+     */
+    void RetryStreamWindows();
+
     // =========================================================================
     // LDN Network Configuration
     // =========================================================================
@@ -446,6 +618,8 @@ private:
     /**
      * @brief Find a socket matching the given destination
      *
+     * @param source_ip Source IP (host byte order)
+     * @param source_port Source port (host byte order)
      * @param dest_ip Destination IP (host byte order)
      * @param dest_port Destination port (host byte order)
      * @param protocol Protocol type
@@ -453,29 +627,47 @@ private:
      *
      * @note Caller must hold m_mutex
      */
-    ProxySocket* FindSocketByDestination(uint32_t dest_ip, uint16_t dest_port,
+    ProxySocket* FindSocketByDestination(uint32_t source_ip, uint16_t source_port,
+                                          uint32_t dest_ip, uint16_t dest_port,
                                           ryu_ldn::bsd::ProtocolType protocol);
 
+    /**
+     * @brief Check if another registered socket uses a local port
+     *
+     * @note Caller must hold m_mutex
+     */
+    bool IsPortShared(const ProxySocket* socket) const;
+
     /**
      * @brief Mutex for thread safety
      */
-    mutable os::Mutex m_mutex{false};
+    mutable ryu_ldn::platform::Mutex m_mutex;
 
     /**
      * @brief Map of file descriptor to ProxySocket
      */
-    std::unordered_map<s32, std::unique_ptr<ProxySocket>> m_sockets;
+    std::unordered_map<s32, std::shared_ptr<ProxySocket>> m_sockets;
 
     /**
      * @brief Ephemeral port pool
      */
     EphemeralPortPool m_port_pool;
 
+    /**
+     * @brief Upstream filter for repeated broadcast datagrams (own lock)
+     */
+    BroadcastFilter m_broadcast_filter;
+
     /**
      * @brief Local LDN IP address (host byte order)
      */
     uint32_t m_local_ip{0};
 
+    /**
+     * @brief Receive-event moderation window of datagram sockets (us)
+     */
+    uint32_t m_rx_moderation_us{0};
+
     /**
      * @brief Callback for sending ProxyData to LDN server
      */
@@ -485,6 +677,16 @@ private:
      * @brief Callback for sending ProxyConnect to LDN server (TCP handshake)
      */
     SendProxyConnectCallback m_proxy_connect_callback{nullptr};
+
+    /**
+     * @brief Callback selecting peers for optimistic connects
+     */
+    OptimisticPeerCallback m_optimistic_peer_callback{nullptr};
+
+    /**
+     * @brief Callback for sending stream window updates
+     */
+    SendStreamWindowCallback m_stream_window_callback{nullptr};
 };
 
 } // namespace ams::mitm::bsd
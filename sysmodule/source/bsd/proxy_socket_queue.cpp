@@ -0,0 +1,95 @@
+/**
+ * @file proxy_socket_queue.cpp
+ * @brief Implementation of the stream proxy socket byte ring
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "proxy_socket_queue.hpp"
+#include "../platform/platform.hpp"
+
+namespace ams::mitm::bsd {
+
+ByteRing::ByteRing(size_t initial_capacity, size_t max_capacity)
+    : m_initial_capacity(initial_capacity)
+    , m_max_capacity(max_capacity)
+{
+}
+
+bool ByteRing::Reserve(size_t needed) {
+    if (needed <= m_capacity) {
+        return true;
+    }
+    if (needed > m_max_capacity) {
+        return false;
+    }
+
+    size_t capacity = m_capacity != 0 ? m_capacity : m_initial_capacity;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    capacity = std::min(capacity, m_max_capacity);
+
+    // Unwrap into the new buffer so m_head restarts at 0
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[capacity]);
+    if (m_size > 0) {
+        size_t first = std::min(m_size, m_capacity - m_head);
+        std::memcpy(buffer.get(), m_buffer.get() + m_head, first);
+        std::memcpy(buffer.get() + first, m_buffer.get(), m_size - first);
+    }
+
+    m_buffer = std::move(buffer);
+    m_capacity = capacity;
+    m_head = 0;
+    return true;
+}
+
+bool ByteRing::Write(const void* data, size_t len) {
+    if (len == 0) {
+        return true;
+    }
+    if (!Reserve(m_size + len)) {
+        return false;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t tail = (m_head + m_size) % m_capacity;
+    size_t first = std::min(len, m_capacity - tail);
+    std::memcpy(m_buffer.get() + tail, bytes, first);
+    std::memcpy(m_buffer.get(), bytes + first, len - first);
+    m_size += len;
+    return true;
+}
+
+size_t ByteRing::Read(void* buffer, size_t len, bool peek, ryu_ldn::bsd::SockAddrIn* from) {
+    AMS_UNUSED(from);
+
+    size_t copy_len = std::min(len, m_size);
+    if (copy_len == 0) {
+        return 0;
+    }
+
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    size_t first = std::min(copy_len, m_capacity - m_head);
+    std::memcpy(out, m_buffer.get() + m_head, first);
+    std::memcpy(out + first, m_buffer.get(), copy_len - first);
+
+    if (!peek) {
+        m_head = (m_head + copy_len) % m_capacity;
+        m_size -= copy_len;
+        if (m_size == 0) {
+            m_head = 0;
+        }
+    }
+    return copy_len;
+}
+
+void ByteRing::Clear() {
+    m_buffer.reset();
+    m_capacity = 0;
+    m_head = 0;
+    m_size = 0;
+}
+
+} // namespace ams::mitm::bsd
@@ -0,0 +1,205 @@
+/**
+ * @file proxy_socket_queue.hpp
+ * @brief Receive queues of the datagram and stream proxy sockets
+ *
+ * Each proxy socket type owns exactly one of these:
+ *
+ * - PacketRing: fixed ring of datagrams with their source address. The
+ *   slot array is allocated on the first datagram (send-only sockets never
+ *   pay for it) and slots keep their buffer between packets, so a socket
+ *   that receives steadily stops allocating after the first lap.
+ * - ByteRing: contiguous byte stream, allocated on first data and grown in
+ *   powers of two up to a hard limit (the advertised receive window).
+ *
+ * Both expose the interface used by ProxySocket::ReadQueue():
+ *
+ * ```cpp
+ * bool   Empty() const;
+ * size_t Size() const;                   // bytes readable
+ * size_t Read(void* buffer, size_t len, bool peek, SockAddrIn* from);
+ * void   Clear();
+ * ```
+ *
+ * ## Thread Safety
+ *
+ * NOT thread-safe. The owning socket holds its mutex around every call.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "bsd_types.hpp"
+
+namespace ams::mitm::bsd {
+
+/**
+ * @brief Fixed-capacity ring of datagrams
+ *
+ * When full, pushing drops the oldest datagram (UDP behavior).
+ *
+ * @tparam Capacity Maximum number of queued datagrams
+ */
+template <size_t Capacity>
+class PacketRing {
+public:
+    bool Empty() const { return m_count == 0; }
+    size_t Count() const { return m_count; }
+    size_t Size() const { return m_bytes; }
+
+    /**
+     * @brief Queue a datagram
+     *
+     * @param queued_ns Arrival time reported by FrontQueuedNs() (0 = untimed)
+     * @return false if the oldest datagram was dropped to make room
+     */
+    bool Push(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from,
+              uint64_t queued_ns = 0) {
+        if (!m_slots) {
+            m_slots = std::make_unique<Slot[]>(Capacity);
+        }
+
+        bool dropped = false;
+        if (m_count == Capacity) {
+            Pop();
+            dropped = true;
+        }
+
+        Slot& slot = m_slots[(m_head + m_count) % Capacity];
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        slot.data.assign(bytes, bytes + (data != nullptr ? len : 0));
+        slot.from = from;
+        slot.queued_ns = queued_ns;
+        m_bytes += slot.data.size();
+        m_count++;
+        return !dropped;
+    }
+
+    /**
+     * @brief Arrival time of the front datagram (0 if empty or untimed)
+     */
+    uint64_t FrontQueuedNs() const {
+        return m_count != 0 ? m_slots[m_head].queued_ns : 0;
+    }
+
+    /**
+     * @brief Copy the front datagram, truncated to len
+     *
+     * @param peek Keep the datagram queued (MSG_PEEK)
+     * @return Bytes copied
+     */
+    size_t Read(void* buffer, size_t len, bool peek, ryu_ldn::bsd::SockAddrIn* from) {
+        if (m_count == 0) {
+            return 0;
+        }
+
+        const Slot& slot = m_slots[m_head];
+        size_t copy_len = std::min(len, slot.data.size());
+        if (copy_len > 0) {
+            std::memcpy(buffer, slot.data.data(), copy_len);
+        }
+        if (from != nullptr) {
+            *from = slot.from;
+        }
+
+        if (!peek) {
+            Pop();
+        }
+        return copy_len;
+    }
+
+    /**
+     * @brief Drop every datagram and release the slots
+     */
+    void Clear() {
+        m_slots.reset();
+        m_head = 0;
+        m_count = 0;
+        m_bytes = 0;
+    }
+
+private:
+    struct Slot {
+        std::vector<uint8_t> data;      ///< Payload (capacity reused)
+        ryu_ldn::bsd::SockAddrIn from;  ///< Source address
+        uint64_t queued_ns;             ///< Push() time, 0 = untimed
+    };
+
+    void Pop() {
+        m_bytes -= m_slots[m_head].data.size();
+        m_slots[m_head].data.clear();
+        m_head = (m_head + 1) % Capacity;
+        m_count--;
+    }
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_head{0};
+    size_t m_count{0};
+    size_t m_bytes{0};  ///< Sum of queued payload sizes
+};
+
+/**
+ * @brief Growable byte ring for stream sockets
+ *
+ * Starts without storage, allocates initial_capacity on the first write and
+ * doubles up to max_capacity. A write that does not fit in max_capacity is
+ * refused as a whole.
+ */
+class ByteRing {
+public:
+    ByteRing(size_t initial_capacity, size_t max_capacity);
+
+    bool Empty() const { return m_size == 0; }
+    size_t Size() const { return m_size; }
+    size_t Capacity() const { return m_capacity; }
+
+    /**
+     * @brief Bytes that can still be written before the limit
+     */
+    size_t Window() const { return m_max_capacity - m_size; }
+
+    /**
+     * @brief Append bytes
+     *
+     * @return false if len exceeds Window() (nothing written)
+     */
+    bool Write(const void* data, size_t len);
+
+    /**
+     * @brief Copy up to len bytes from the front
+     *
+     * @param peek Keep the bytes queued (MSG_PEEK)
+     * @param from Unused, streams carry no per-read source
+     * @return Bytes copied
+     */
+    size_t Read(void* buffer, size_t len, bool peek, ryu_ldn::bsd::SockAddrIn* from);
+
+    /**
+     * @brief Always 0: bytes of a stream have no arrival time
+     */
+    uint64_t FrontQueuedNs() const { return 0; }
+
+    /**
+     * @brief Drop all bytes and release the storage
+     */
+    void Clear();
+
+private:
+    bool Reserve(size_t needed);
+
+    std::unique_ptr<uint8_t[]> m_buffer;
+    size_t m_capacity{0};
+    size_t m_initial_capacity;
+    size_t m_max_capacity;
+    size_t m_head{0};
+    size_t m_size{0};
+};
+
+} // namespace ams::mitm::bsd
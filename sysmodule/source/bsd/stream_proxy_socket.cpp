@@ -0,0 +1,353 @@
+/**
+ * @file stream_proxy_socket.cpp
+ * @brief Implementation of the TCP proxy socket
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "stream_proxy_socket.hpp"
+#include "proxy_socket_manager.hpp"
+
+#include <algorithm>
+
+namespace ams::mitm::bsd {
+
+using Errno = ryu_ldn::bsd::BsdErrno;
+
+StreamProxySocket::StreamProxySocket(ryu_ldn::bsd::ProtocolType protocol)
+    : ProxySocket(ryu_ldn::bsd::SocketType::Stream, protocol)
+{
+}
+
+StreamProxySocket::StreamProxySocket(ryu_ldn::bsd::ProtocolType protocol,
+                                     const ryu_ldn::bsd::SockAddrIn& local,
+                                     const ryu_ldn::bsd::SockAddrIn& remote)
+    : ProxySocket(ryu_ldn::bsd::SocketType::Stream, protocol)
+{
+    m_local_addr = local;
+    m_remote_addr = remote;
+    m_state = ProxySocketState::Connected;
+}
+
+StreamProxySocket::~StreamProxySocket() {
+    // Bytes still queued leave the gauge with the socket
+    ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Add(-static_cast<int64_t>(m_receive_queue.Size()));
+}
+
+// =============================================================================
+// Connect Handshake
+// =============================================================================
+
+Result StreamProxySocket::ConnectImpl(const ryu_ldn::bsd::SockAddrIn& addr) {
+    // Store remote address
+    m_remote_addr = addr;
+
+    auto& manager = ProxySocketManager::GetInstance();
+    bool optimistic = manager.IsOptimisticPeer(addr.GetAddr());
+
+    {
+        std::scoped_lock lock(m_queue_mutex);
+        m_socket_error = 0;
+        m_optimistic_pending = optimistic;
+        m_connect_start_ms = ryu_ldn::platform::GetTickMs();
+
+        // Optimistic: writable before the reply, early data queues behind the ProxyConnect
+        m_state = optimistic ? ProxySocketState::Connected : ProxySocketState::Connecting;
+    }
+    m_connect_response_received = false;
+    m_connect_event.Clear();
+
+    // Send ProxyConnect via ProxySocketManager
+    bool sent = manager.SendProxyConnect(
+        m_local_addr.GetAddr(), m_local_addr.GetPort(),
+        addr.GetAddr(), addr.GetPort(),
+        m_protocol
+    );
+
+    if (!sent) {
+        std::scoped_lock lock(m_queue_mutex);
+        m_optimistic_pending = false;
+        m_state = ProxySocketState::Bound;
+        R_THROW(static_cast<s32>(Errno::NetUnreach));
+    }
+
+    if (optimistic) {
+        R_SUCCEED();
+    }
+
+    if (m_non_blocking) {
+        // Non-blocking connect - return EINPROGRESS
+        // HandleConnectResponse completes the connect asynchronously
+        R_THROW(static_cast<s32>(Errno::InProgress));
+    }
+
+    // Blocking connect - wait for the reply
+    bool got_response = m_connect_event.TimedWait(PROXY_CONNECT_TIMEOUT_MS);
+
+    if (!got_response || !m_connect_response_received) {
+        m_state = ProxySocketState::Bound;
+        R_THROW(static_cast<s32>(Errno::TimedOut));
+    }
+
+    // Check if connection was refused (protocol != Unspecified means error)
+    if (m_connect_response.info.protocol != ryu_ldn::protocol::ProtocolType::Unspecified) {
+        m_state = ProxySocketState::Bound;
+        R_THROW(static_cast<s32>(Errno::ConnRefused));
+    }
+
+    m_state = ProxySocketState::Connected;
+    R_SUCCEED();
+}
+
+void StreamProxySocket::HandleConnectResponse(const ryu_ldn::protocol::ProxyConnectResponse& response) {
+    bool accepted = response.info.protocol == ryu_ldn::protocol::ProtocolType::Unspecified;
+
+    {
+        std::scoped_lock lock(m_queue_mutex);
+
+        // Optimistic connect: already connected, a rejection breaks the stream
+        if (m_optimistic_pending) {
+            m_optimistic_pending = false;
+            if (!accepted) {
+                m_socket_error = static_cast<s32>(Errno::ConnRefused);
+                m_receive_event.Signal();
+            }
+            return;
+        }
+
+        // Non-blocking connect: nobody waits on m_connect_event, complete it here
+        if (m_non_blocking && m_state == ProxySocketState::Connecting) {
+            if (accepted) {
+                m_state = ProxySocketState::Connected;
+            } else {
+                m_state = ProxySocketState::Bound;
+                m_socket_error = static_cast<s32>(Errno::ConnRefused);
+            }
+            m_receive_event.Signal();
+        }
+    }
+
+    // Store the response
+    m_connect_response = response;
+    m_connect_response_received = true;
+
+    // Signal that connect response arrived
+    m_connect_event.Signal();
+}
+
+bool StreamProxySocket::IsAwaitingConnectResponse() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return m_state == ProxySocketState::Connecting || m_optimistic_pending;
+}
+
+s32 StreamProxySocket::CheckConnectError() {
+    std::scoped_lock lock(m_queue_mutex);
+
+    if (m_optimistic_pending &&
+        ryu_ldn::platform::GetTickMs() - m_connect_start_ms >= PROXY_CONNECT_TIMEOUT_MS) {
+        m_optimistic_pending = false;
+        m_socket_error = static_cast<s32>(Errno::TimedOut);
+    }
+    return m_socket_error;
+}
+
+// =============================================================================
+// Data Transfer
+// =============================================================================
+
+s32 StreamProxySocket::SendToImpl(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) {
+    // Connected stream sockets ignore the sendto() address
+    AMS_UNUSED(dest);
+
+    if (m_state != ProxySocketState::Connected) {
+        return -static_cast<s32>(Errno::NotConn);
+    }
+
+    // A broken stream (reset, refused optimistic connect) sends nothing more
+    if (s32 error = CheckConnectError(); error != 0) {
+        return -error;
+    }
+
+    // A ryu_ldn_nx peer advertises its window: throttle from the first byte
+    if (!m_peer_window_checked) {
+        bool flow_control = ProxySocketManager::GetInstance().IsOptimisticPeer(m_remote_addr.GetAddr());
+        std::scoped_lock lock(m_queue_mutex);
+        m_peer_window_checked = true;
+        m_peer_window = m_peer_window || flow_control;
+    }
+
+    // Segment into ProxyData payloads, no more than the peer's window allows
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t sent = 0;
+    while (sent < len) {
+        size_t window = WaitSendWindow(!m_non_blocking);
+        if (window == 0) {
+            if (sent > 0) {
+                return static_cast<s32>(sent);
+            }
+            if (s32 error = CheckConnectError(); error != 0) {
+                return -error;
+            }
+            return -static_cast<s32>(m_shutdown_write ? Errno::Inval : Errno::Again);
+        }
+
+        size_t chunk = std::min({len - sent, PROXY_SOCKET_MAX_PAYLOAD, window});
+        s32 result = SendProxyData(bytes + sent, chunk, m_remote_addr);
+        if (result < 0) {
+            // Report the partial write if some segments went out
+            return sent > 0 ? static_cast<s32>(sent) : result;
+        }
+        {
+            std::scoped_lock lock(m_queue_mutex);
+            m_sent_total += static_cast<uint32_t>(chunk);
+        }
+        sent += chunk;
+    }
+
+    return static_cast<s32>(sent);
+}
+
+size_t StreamProxySocket::WaitSendWindow(bool block) {
+    while (true) {
+        {
+            std::scoped_lock lock(m_queue_mutex);
+            size_t window = SendWindowLocked();
+            if (window != 0 || !block || m_socket_error != 0 || m_shutdown_write) {
+                return m_socket_error != 0 || m_shutdown_write ? 0 : window;
+            }
+            m_window_event.Clear();
+        }
+
+        // Woken by the next window update, the timeout rechecks Shutdown() and Close()
+        m_window_event.TimedWait(PROXY_STREAM_SEND_WAIT_MS);
+    }
+}
+
+size_t StreamProxySocket::SendWindowLocked() const {
+    if (!m_peer_window) {
+        return SIZE_MAX;
+    }
+    uint32_t unread = m_sent_total - m_peer_read_total;
+    return unread >= PROXY_STREAM_RECEIVE_WINDOW ? 0 : PROXY_STREAM_RECEIVE_WINDOW - unread;
+}
+
+s32 StreamProxySocket::RecvFromImpl(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::SockAddrIn* from) {
+    if (m_state != ProxySocketState::Connected) {
+        return -static_cast<s32>(Errno::NotConn);
+    }
+
+    // Only to expire an unanswered optimistic connect, queued bytes are read first
+    CheckConnectError();
+
+    s32 result = ReadQueue(m_receive_queue, buffer, len, flags, nullptr);
+    if (result >= 0 && from != nullptr) {
+        *from = m_remote_addr;
+    }
+    if (result > 0 && (flags & PROXY_SOCKET_MSG_PEEK) == 0) {
+        ConsumeReceived(static_cast<size_t>(result));
+    }
+    return result;
+}
+
+void StreamProxySocket::ConsumeReceived(size_t len) {
+    {
+        std::scoped_lock lock(m_queue_mutex);
+        m_read_total += static_cast<uint32_t>(len);
+    }
+    AdvertiseWindow();
+}
+
+void StreamProxySocket::RetryStreamWindow() {
+    if (m_state == ProxySocketState::Connected) {
+        AdvertiseWindow();
+    }
+}
+
+void StreamProxySocket::AdvertiseWindow() {
+    uint32_t read_total;
+    {
+        std::scoped_lock lock(m_queue_mutex);
+        if (m_read_total - m_read_advertised < PROXY_STREAM_WINDOW_UPDATE_STEP) {
+            return;
+        }
+        read_total = m_read_total;
+    }
+
+    // Not sent to peers without flow control, retried later if it fails
+    auto& manager = ProxySocketManager::GetInstance();
+    if (manager.SendStreamWindow(m_local_addr.GetAddr(), m_local_addr.GetPort(),
+                                 m_remote_addr.GetAddr(), m_remote_addr.GetPort(), read_total)) {
+        std::scoped_lock lock(m_queue_mutex);
+        m_read_advertised = read_total;
+    }
+}
+
+void StreamProxySocket::HandleStreamWindow(uint32_t peer_read_total) {
+    std::scoped_lock lock(m_queue_mutex);
+
+    // An update overtaken by a newer one (P2P and relay paths) is stale
+    if (m_peer_window && static_cast<int32_t>(peer_read_total - m_peer_read_total) < 0) {
+        return;
+    }
+    m_peer_read_total = peer_read_total;
+    m_peer_window = true;
+    m_window_event.Signal();
+}
+
+void StreamProxySocket::IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from) {
+    AMS_UNUSED(from);
+
+    std::scoped_lock lock(m_queue_mutex);
+
+    // A broken stream accepts nothing more
+    if (m_socket_error != 0) {
+        return;
+    }
+
+    if (m_receive_queue.Write(data, len)) {
+        ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Add(static_cast<int64_t>(len));
+    } else {
+        // Only a peer without flow control overruns the window, and losing a
+        // segment would corrupt the stream
+        ryu_ldn::diagnostics::g_metrics.proxy_rx_dropped.Add();
+        m_socket_error = static_cast<s32>(Errno::ConnReset);
+        m_window_event.Signal();
+    }
+
+    // Signal that data (or the error) is available
+    m_receive_event.Signal();
+}
+
+void StreamProxySocket::ClearQueue() {
+    ryu_ldn::diagnostics::g_metrics.proxy_queued_bytes.Add(-static_cast<int64_t>(m_receive_queue.Size()));
+    m_receive_queue.Clear();
+}
+
+bool StreamProxySocket::HasPendingData() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return !m_receive_queue.Empty() || m_socket_error != 0;
+}
+
+size_t StreamProxySocket::GetPendingDataSize() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return m_receive_queue.Size();
+}
+
+bool StreamProxySocket::IsWritable() const {
+    std::scoped_lock lock(m_queue_mutex);
+    // A broken stream is writable: the send reports the error
+    return m_socket_error != 0 || SendWindowLocked() != 0;
+}
+
+size_t StreamProxySocket::GetReceiveWindow() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return m_socket_error != 0 ? 0 : m_receive_queue.Window();
+}
+
+size_t StreamProxySocket::GetSendWindow() const {
+    std::scoped_lock lock(m_queue_mutex);
+    return SendWindowLocked();
+}
+
+} // namespace ams::mitm::bsd
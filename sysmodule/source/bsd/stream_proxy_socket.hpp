@@ -0,0 +1,234 @@
+/**
+ * @file stream_proxy_socket.hpp
+ * @brief TCP proxy socket (connecting side or accepted connection)
+ *
+ * Stream sockets deliver an ordered byte stream without message boundaries:
+ * incoming ProxyData payloads are appended to a ByteRing and Recv() returns
+ * whatever is available, up to the caller's buffer.
+ *
+ * ## Flow Control
+ *
+ * - **Send**: writes larger than one ProxyData payload are split into
+ *   PROXY_SOCKET_MAX_PAYLOAD segments instead of failing with EMSGSIZE.
+ * - **Receive**: the ring starts empty, grows from
+ *   PROXY_STREAM_INITIAL_BUFFER_SIZE and never exceeds
+ *   PROXY_STREAM_RECEIVE_WINDOW.
+ * - **Window**: between ryu_ldn_nx consoles the receiver reports how much
+ *   the game has read every PROXY_STREAM_WINDOW_UPDATE_STEP bytes, and the
+ *   sender keeps at most PROXY_STREAM_RECEIVE_WINDOW bytes unread from its
+ *   first byte on (both ends know each other from the Hello exchange that
+ *   precedes the ProxyConnect, see ProxySocketManager::IsOptimisticPeer): a
+ *   blocking send waits for the next update, a non-blocking one returns
+ *   EAGAIN (or a partial write) and select()/poll() report it unwritable.
+ *   A slow reader slows the transfer down instead of losing it. An update
+ *   that fails to send is retried by the next read and by the periodic
+ *   ProxySocketManager::RetryStreamWindows().
+ * - A peer without flow control (Ryujinx) is never sent window updates and
+ *   never throttled. ProxyData has no acknowledgement to slow it down, so a
+ *   segment from it that does not fit breaks the stream: it is dropped,
+ *   counted in proxy_rx_dropped, and the socket reports ECONNRESET once the
+ *   buffered bytes have been read, rather than silently losing data in the
+ *   middle of a stream.
+ *
+ * Window update (ProxyData, stream addresses, receiver to sender):
+ * ```
+ * ProxyInfo.protocol = Tcp | PROXY_STREAM_WINDOW_FLAG
+ * payload            = uint32_t bytes read since the stream opened (wraps)
+ * ```
+ *
+ * ## Optimistic Connect
+ *
+ * Toward a peer known to run ryu_ldn_nx (ProxySocketManager::IsOptimisticPeer)
+ * Connect() succeeds as soon as the ProxyConnect is sent: the socket is
+ * writable at once and early data follows the ProxyConnect on the same
+ * ordered path, saving a round trip. The ProxyConnectReply is still awaited
+ * in the background; a rejection or no reply within
+ * PROXY_CONNECT_TIMEOUT_MS breaks the stream with ECONNREFUSED or ETIMEDOUT,
+ * the errors a classic connect would have returned.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "proxy_socket.hpp"
+#include "proxy_socket_queue.hpp"
+
+namespace ams::mitm::bsd {
+
+/**
+ * @brief Initial receive buffer of a stream socket (allocated on first data)
+ */
+constexpr size_t PROXY_STREAM_INITIAL_BUFFER_SIZE = 4 * 1024;
+
+/**
+ * @brief Maximum unread bytes per stream socket
+ */
+constexpr size_t PROXY_STREAM_RECEIVE_WINDOW = 64 * 1024;
+
+/**
+ * @brief Bytes read between two window updates sent to the peer
+ */
+constexpr size_t PROXY_STREAM_WINDOW_UPDATE_STEP = 16 * 1024;
+
+/**
+ * @brief Flag OR-ed into ProxyInfo::protocol of a window update
+ *
+ * Not a valid ProtocolType value, and distinct from REDUNDANT_TAGGED_FLAG.
+ */
+constexpr int32_t PROXY_STREAM_WINDOW_FLAG = 0x20000000;
+
+/**
+ * @brief Longest wait of a blocked send before it rechecks Shutdown()/Close()
+ */
+constexpr u64 PROXY_STREAM_SEND_WAIT_MS = 100;
+
+/**
+ * @brief Time allowed for the ProxyConnectReply (like Ryujinx)
+ */
+constexpr u64 PROXY_CONNECT_TIMEOUT_MS = 4000;
+
+/**
+ * @brief Proxy socket for SOCK_STREAM / TCP connections
+ */
+class StreamProxySocket final : public ProxySocket {
+public:
+    /**
+     * @brief Construct an unbound, unconnected stream socket
+     *
+     * @param protocol Protocol type (Tcp)
+     */
+    explicit StreamProxySocket(ryu_ldn::bsd::ProtocolType protocol);
+
+    /**
+     * @brief Construct an accepted connection
+     *
+     * @param protocol Protocol type (Tcp)
+     * @param local Address of the listening socket
+     * @param remote Address of the connecting peer
+     */
+    StreamProxySocket(ryu_ldn::bsd::ProtocolType protocol,
+                      const ryu_ldn::bsd::SockAddrIn& local,
+                      const ryu_ldn::bsd::SockAddrIn& remote);
+
+    ~StreamProxySocket() override;
+
+    void IncomingData(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& from) override;
+    void HandleConnectResponse(const ryu_ldn::protocol::ProxyConnectResponse& response) override;
+    bool IsAwaitingConnectResponse() const override;
+    void HandleStreamWindow(uint32_t peer_read_total) override;
+    void RetryStreamWindow() override;
+
+    bool HasPendingData() const override;
+    size_t GetPendingDataSize() const override;
+    bool IsWritable() const override;
+
+    /**
+     * @brief Bytes that can still be received before the stream is reset
+     */
+    size_t GetReceiveWindow() const;
+
+    /**
+     * @brief Bytes that can be sent before the peer's window is full
+     *
+     * @return SIZE_MAX while the peer is not known to have flow control
+     */
+    size_t GetSendWindow() const;
+
+protected:
+    Result ConnectImpl(const ryu_ldn::bsd::SockAddrIn& addr) override;
+    s32 SendToImpl(const void* data, size_t len, const ryu_ldn::bsd::SockAddrIn& dest) override;
+    s32 RecvFromImpl(void* buffer, size_t len, s32 flags, ryu_ldn::bsd::SockAddrIn* from) override;
+    void ClearQueue() override;
+
+private:
+    /**
+     * @brief Break the stream if an optimistic connect was never answered
+     *
+     * @return Pending socket error, 0 if none
+     */
+    s32 CheckConnectError();
+
+    /**
+     * @brief Send window, waiting for it to open if block is set
+     *
+     * @return 0 if still closed (non-blocking, broken or shut down stream)
+     */
+    size_t WaitSendWindow(bool block);
+
+    /**
+     * @brief Count bytes handed to the game, send a window update every step
+     */
+    void ConsumeReceived(size_t len);
+
+    /**
+     * @brief Send a window update if a step was read since the last one sent
+     */
+    void AdvertiseWindow();
+
+    /**
+     * @brief GetSendWindow() body
+     *
+     * @note Called with m_queue_mutex held
+     */
+    size_t SendWindowLocked() const;
+
+    /**
+     * @brief Receive queue (ordered byte stream)
+     */
+    ByteRing m_receive_queue{PROXY_STREAM_INITIAL_BUFFER_SIZE, PROXY_STREAM_RECEIVE_WINDOW};
+
+    /**
+     * @brief TCP connect response received flag
+     */
+    bool m_connect_response_received{false};
+
+    /**
+     * @brief TCP connect response data (valid when m_connect_response_received is true)
+     */
+    ryu_ldn::protocol::ProxyConnectResponse m_connect_response{};
+
+    /**
+     * @brief Event signaled when connect response is received
+     */
+    ryu_ldn::platform::Event m_connect_event{ryu_ldn::platform::EventClearMode::Manual};
+
+    /**
+     * @brief Connected optimistically, ProxyConnectReply not received yet
+     *
+     * Protected by m_queue_mutex.
+     */
+    bool m_optimistic_pending{false};
+
+    /**
+     * @brief Time the ProxyConnect was sent (ms)
+     */
+    u64 m_connect_start_ms{0};
+
+    /**
+     * @brief Flow control counters (wrap), protected by m_queue_mutex
+     */
+    uint32_t m_read_total{0};        ///< Bytes read by the game
+    uint32_t m_read_advertised{0};   ///< m_read_total last sent to the peer
+    uint32_t m_sent_total{0};        ///< Bytes sent
+    uint32_t m_peer_read_total{0};   ///< Peer's read total from its last update
+
+    /**
+     * @brief The peer has flow control (runs ryu_ldn_nx or sent a window
+     * update), sends are throttled
+     */
+    bool m_peer_window{false};
+
+    /**
+     * @brief The peer was looked up on the first send (sending thread only)
+     */
+    bool m_peer_window_checked{false};
+
+    /**
+     * @brief Event signaled by window updates
+     */
+    ryu_ldn::platform::Event m_window_event{ryu_ldn::platform::EventClearMode::Manual};
+};
+
+} // namespace ams::mitm::bsd
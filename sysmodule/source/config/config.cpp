@@ -148,6 +148,30 @@ void process_ldn_key(const char* key, const char* value, LdnConfig& config) {
         safe_strcpy(config.interface_name, value, MAX_INTERFACE_LENGTH);
     } else if (std::strcmp(key, "disable_p2p") == 0) {
         config.disable_p2p = parse_bool(value);
+    } else if (std::strcmp(key, "redundant_udp") == 0) {
+        config.redundant_udp = parse_bool(value);
+    } else if (std::strcmp(key, "redundant_udp_titles") == 0) {
+        safe_strcpy(config.redundant_udp_titles, value, MAX_TITLE_LIST_LENGTH);
+    } else if (std::strcmp(key, "redundant_udp_ports") == 0) {
+        safe_strcpy(config.redundant_udp_ports, value, MAX_PORT_LIST_LENGTH);
+    } else if (std::strcmp(key, "redundant_udp_budget") == 0) {
+        config.redundant_udp_budget = parse_uint32(value);
+    } else if (std::strcmp(key, "broadcast_dedup") == 0) {
+        config.broadcast_dedup = parse_bool(value);
+    } else if (std::strcmp(key, "broadcast_dedup_window") == 0) {
+        config.broadcast_dedup_window_ms = parse_uint32(value);
+    } else if (std::strcmp(key, "broadcast_dedup_keepalive") == 0) {
+        config.broadcast_dedup_keepalive_ms = parse_uint32(value);
+    } else if (std::strcmp(key, "broadcast_dedup_exclude") == 0) {
+        safe_strcpy(config.broadcast_dedup_exclude, value, MAX_TITLE_LIST_LENGTH);
+    } else if (std::strcmp(key, "relay_delegation") == 0) {
+        config.relay_delegation = parse_bool(value);
+    } else if (std::strcmp(key, "uplink_kbps") == 0) {
+        config.uplink_kbps = parse_uint32(value);
+    } else if (std::strcmp(key, "rx_moderation_us") == 0) {
+        config.rx_moderation_us = parse_uint32(value);
+    } else if (std::strcmp(key, "lan_discovery") == 0) {
+        config.lan_discovery = parse_bool(value);
     }
 }
 
@@ -161,6 +185,28 @@ void process_debug_key(const char* key, const char* value, DebugConfig& config)
         config.level = parse_uint32(value);
     } else if (std::strcmp(key, "log_to_file") == 0) {
         config.log_to_file = parse_bool(value);
+    } else if (std::strcmp(key, "metrics") == 0) {
+        config.metrics_enabled = parse_bool(value);
+    } else if (std::strcmp(key, "metrics_port") == 0) {
+        config.metrics_port = parse_uint16(value);
+    } else if (std::strcmp(key, "log_udp_host") == 0) {
+        safe_strcpy(config.log_udp_host, value, MAX_HOST_LENGTH);
+    } else if (std::strcmp(key, "log_udp_port") == 0) {
+        config.log_udp_port = parse_uint16(value);
+    } else if (std::strcmp(key, "ipc_record") == 0) {
+        config.ipc_record = parse_bool(value);
+    } else if (std::strcmp(key, "ipc_record_payload") == 0) {
+        config.ipc_record_payload = parse_bool(value);
+    } else if (std::strcmp(key, "flight_recorder") == 0) {
+        config.flight_recorder = parse_bool(value);
+    } else if (std::strcmp(key, "flight_rtt_ms") == 0) {
+        config.flight_rtt_ms = parse_uint32(value);
+    } else if (std::strcmp(key, "flight_queue_us") == 0) {
+        config.flight_queue_us = parse_uint32(value);
+    } else if (std::strcmp(key, "flight_ipc_us") == 0) {
+        config.flight_ipc_us = parse_uint32(value);
+    } else if (std::strcmp(key, "flight_interval_s") == 0) {
+        config.flight_interval_s = parse_uint32(value);
     }
 }
 
@@ -292,6 +338,30 @@ size_t format_config_content(char* buffer, size_t buffer_size, const Config& con
     WRITE_LINE("interface = %s", config.ldn.interface_name);
     WRITE_LINE("; Disable P2P proxy (0/1) - like Ryujinx MultiplayerDisableP2p");
     WRITE_LINE("disable_p2p = %d", config.ldn.disable_p2p ? 1 : 0);
+    WRITE_LINE("; Send small UDP packets on both P2P and relay (0/1)");
+    WRITE_LINE("redundant_udp = %d", config.ldn.redundant_udp ? 1 : 0);
+    WRITE_LINE("; Titles to duplicate for, hex program IDs separated by commas (empty = all)");
+    WRITE_LINE("redundant_udp_titles = %s", config.ldn.redundant_udp_titles);
+    WRITE_LINE("; Flows to duplicate, game ports separated by commas (empty = all)");
+    WRITE_LINE("redundant_udp_ports = %s", config.ldn.redundant_udp_ports);
+    WRITE_LINE("; Extra upload allowed for duplicates in bytes per second");
+    WRITE_LINE("redundant_udp_budget = %u", config.ldn.redundant_udp_budget);
+    WRITE_LINE("; Drop identical repeated broadcast datagrams before the server (0/1)");
+    WRITE_LINE("broadcast_dedup = %d", config.ldn.broadcast_dedup ? 1 : 0);
+    WRITE_LINE("; Max gap between two repeats of the same broadcast in ms");
+    WRITE_LINE("broadcast_dedup_window = %u", config.ldn.broadcast_dedup_window_ms);
+    WRITE_LINE("; Still send a repeated broadcast every N ms");
+    WRITE_LINE("broadcast_dedup_keepalive = %u", config.ldn.broadcast_dedup_keepalive_ms);
+    WRITE_LINE("; Titles to never filter, hex program IDs separated by commas");
+    WRITE_LINE("broadcast_dedup_exclude = %s", config.ldn.broadcast_dedup_exclude);
+    WRITE_LINE("; Hand part of the P2P host broadcast fan-out to a better connected guest (0/1)");
+    WRITE_LINE("relay_delegation = %d", config.ldn.relay_delegation ? 1 : 0);
+    WRITE_LINE("; Upload capacity of this connection in kbit/s (0 = unknown, no delegation)");
+    WRITE_LINE("uplink_kbps = %u", config.ldn.uplink_kbps);
+    WRITE_LINE("; Batch datagram wakeups of a waiting game thread within this window (us, 0 = off)");
+    WRITE_LINE("rx_moderation_us = %u", config.ldn.rx_moderation_us);
+    WRITE_LINE("; Also reach a P2P host on the same LAN by its private address (0/1)");
+    WRITE_LINE("lan_discovery = %d", config.ldn.lan_discovery ? 1 : 0);
     WRITE_LINE("");
 
     WRITE_LINE("[debug]");
@@ -301,6 +371,28 @@ size_t format_config_content(char* buffer, size_t buffer_size, const Config& con
     WRITE_LINE("level = %u", config.debug.level);
     WRITE_LINE("; Log to file (0/1)");
     WRITE_LINE("log_to_file = %d", config.debug.log_to_file ? 1 : 0);
+    WRITE_LINE("; Serve Prometheus metrics over HTTP on the LAN (0/1)");
+    WRITE_LINE("metrics = %d", config.debug.metrics_enabled ? 1 : 0);
+    WRITE_LINE("; Metrics endpoint port");
+    WRITE_LINE("metrics_port = %u", config.debug.metrics_port);
+    WRITE_LINE("; Stream logs over UDP to this LAN collector (IPv4, empty = off)");
+    WRITE_LINE("log_udp_host = %s", config.debug.log_udp_host);
+    WRITE_LINE("; Log collector port");
+    WRITE_LINE("log_udp_port = %u", config.debug.log_udp_port);
+    WRITE_LINE("; Record bsd:u/ldn:u calls to ipc_trace.bin for offline replay (0/1)");
+    WRITE_LINE("ipc_record = %d", config.debug.ipc_record ? 1 : 0);
+    WRITE_LINE("; Also keep the first bytes the game sends in the trace (0/1)");
+    WRITE_LINE("ipc_record_payload = %d", config.debug.ipc_record_payload ? 1 : 0);
+    WRITE_LINE("; Dump recent packet events to flight_N.bin on latency spikes (0/1, 4 files rotating)");
+    WRITE_LINE("flight_recorder = %d", config.debug.flight_recorder ? 1 : 0);
+    WRITE_LINE("; Server RTT that triggers a dump (ms, 0 = off)");
+    WRITE_LINE("flight_rtt_ms = %u", config.debug.flight_rtt_ms);
+    WRITE_LINE("; Time a packet waits in a socket queue that triggers a dump (us, 0 = off)");
+    WRITE_LINE("flight_queue_us = %u", config.debug.flight_queue_us);
+    WRITE_LINE("; IPC call latency that triggers a dump (us, 0 = off)");
+    WRITE_LINE("flight_ipc_us = %u", config.debug.flight_ipc_us);
+    WRITE_LINE("; Minimum time between two dumps (seconds)");
+    WRITE_LINE("flight_interval_s = %u", config.debug.flight_interval_s);
 
     #undef WRITE_LINE
 
@@ -333,11 +425,34 @@ Config get_default_config() {
     config.ldn.passphrase[0] = '\0';
     config.ldn.interface_name[0] = '\0';
     config.ldn.disable_p2p = DEFAULT_DISABLE_P2P;
+    config.ldn.redundant_udp = DEFAULT_REDUNDANT_UDP;
+    config.ldn.redundant_udp_titles[0] = '\0';
+    config.ldn.redundant_udp_ports[0] = '\0';
+    config.ldn.redundant_udp_budget = DEFAULT_REDUNDANT_UDP_BUDGET;
+    config.ldn.broadcast_dedup = DEFAULT_BROADCAST_DEDUP;
+    config.ldn.broadcast_dedup_window_ms = DEFAULT_BROADCAST_DEDUP_WINDOW_MS;
+    config.ldn.broadcast_dedup_keepalive_ms = DEFAULT_BROADCAST_DEDUP_KEEPALIVE_MS;
+    config.ldn.broadcast_dedup_exclude[0] = '\0';
+    config.ldn.relay_delegation = DEFAULT_RELAY_DELEGATION;
+    config.ldn.uplink_kbps = DEFAULT_UPLINK_KBPS;
+    config.ldn.rx_moderation_us = DEFAULT_RX_MODERATION_US;
+    config.ldn.lan_discovery = DEFAULT_LAN_DISCOVERY;
 
     // Debug defaults
     config.debug.enabled = DEFAULT_DEBUG_ENABLED;
     config.debug.level = DEFAULT_DEBUG_LEVEL;
     config.debug.log_to_file = DEFAULT_LOG_TO_FILE;
+    config.debug.metrics_enabled = DEFAULT_METRICS_ENABLED;
+    config.debug.metrics_port = DEFAULT_METRICS_PORT;
+    config.debug.log_udp_host[0] = '\0';
+    config.debug.log_udp_port = DEFAULT_LOG_UDP_PORT;
+    config.debug.ipc_record = DEFAULT_IPC_RECORD;
+    config.debug.ipc_record_payload = DEFAULT_IPC_RECORD_PAYLOAD;
+    config.debug.flight_recorder = DEFAULT_FLIGHT_RECORDER;
+    config.debug.flight_rtt_ms = DEFAULT_FLIGHT_RTT_MS;
+    config.debug.flight_queue_us = DEFAULT_FLIGHT_QUEUE_US;
+    config.debug.flight_ipc_us = DEFAULT_FLIGHT_IPC_US;
+    config.debug.flight_interval_s = DEFAULT_FLIGHT_INTERVAL_S;
 
     return config;
 }
@@ -609,7 +724,31 @@ ConfigResult save_config(const char* path, const Config& config) {
     std::fprintf(file, "; Network interface (empty = auto)\n");
     std::fprintf(file, "interface = %s\n", config.ldn.interface_name);
     std::fprintf(file, "; Disable P2P proxy (0/1) - like Ryujinx MultiplayerDisableP2p\n");
-    std::fprintf(file, "disable_p2p = %d\n\n", config.ldn.disable_p2p ? 1 : 0);
+    std::fprintf(file, "disable_p2p = %d\n", config.ldn.disable_p2p ? 1 : 0);
+    std::fprintf(file, "; Send small UDP packets on both P2P and relay (0/1)\n");
+    std::fprintf(file, "redundant_udp = %d\n", config.ldn.redundant_udp ? 1 : 0);
+    std::fprintf(file, "; Titles to duplicate for, hex program IDs separated by commas (empty = all)\n");
+    std::fprintf(file, "redundant_udp_titles = %s\n", config.ldn.redundant_udp_titles);
+    std::fprintf(file, "; Flows to duplicate, game ports separated by commas (empty = all)\n");
+    std::fprintf(file, "redundant_udp_ports = %s\n", config.ldn.redundant_udp_ports);
+    std::fprintf(file, "; Extra upload allowed for duplicates in bytes per second\n");
+    std::fprintf(file, "redundant_udp_budget = %u\n", config.ldn.redundant_udp_budget);
+    std::fprintf(file, "; Drop identical repeated broadcast datagrams before the server (0/1)\n");
+    std::fprintf(file, "broadcast_dedup = %d\n", config.ldn.broadcast_dedup ? 1 : 0);
+    std::fprintf(file, "; Max gap between two repeats of the same broadcast in ms\n");
+    std::fprintf(file, "broadcast_dedup_window = %u\n", config.ldn.broadcast_dedup_window_ms);
+    std::fprintf(file, "; Still send a repeated broadcast every N ms\n");
+    std::fprintf(file, "broadcast_dedup_keepalive = %u\n", config.ldn.broadcast_dedup_keepalive_ms);
+    std::fprintf(file, "; Titles to never filter, hex program IDs separated by commas\n");
+    std::fprintf(file, "broadcast_dedup_exclude = %s\n", config.ldn.broadcast_dedup_exclude);
+    std::fprintf(file, "; Hand part of the P2P host broadcast fan-out to a better connected guest (0/1)\n");
+    std::fprintf(file, "relay_delegation = %d\n", config.ldn.relay_delegation ? 1 : 0);
+    std::fprintf(file, "; Upload capacity of this connection in kbit/s (0 = unknown, no delegation)\n");
+    std::fprintf(file, "uplink_kbps = %u\n", config.ldn.uplink_kbps);
+    std::fprintf(file, "; Batch datagram wakeups of a waiting game thread within this window (us, 0 = off)\n");
+    std::fprintf(file, "rx_moderation_us = %u\n", config.ldn.rx_moderation_us);
+    std::fprintf(file, "; Also reach a P2P host on the same LAN by its private address (0/1)\n");
+    std::fprintf(file, "lan_discovery = %d\n\n", config.ldn.lan_discovery ? 1 : 0);
 
     std::fprintf(file, "[debug]\n");
     std::fprintf(file, "; Enable debug logging (0/1)\n");
@@ -618,6 +757,28 @@ ConfigResult save_config(const char* path, const Config& config) {
     std::fprintf(file, "level = %u\n", config.debug.level);
     std::fprintf(file, "; Log to file (0/1)\n");
     std::fprintf(file, "log_to_file = %d\n", config.debug.log_to_file ? 1 : 0);
+    std::fprintf(file, "; Serve Prometheus metrics over HTTP on the LAN (0/1)\n");
+    std::fprintf(file, "metrics = %d\n", config.debug.metrics_enabled ? 1 : 0);
+    std::fprintf(file, "; Metrics endpoint port\n");
+    std::fprintf(file, "metrics_port = %u\n", config.debug.metrics_port);
+    std::fprintf(file, "; Stream logs over UDP to this LAN collector (IPv4, empty = off)\n");
+    std::fprintf(file, "log_udp_host = %s\n", config.debug.log_udp_host);
+    std::fprintf(file, "; Log collector port\n");
+    std::fprintf(file, "log_udp_port = %u\n", config.debug.log_udp_port);
+    std::fprintf(file, "; Record bsd:u/ldn:u calls to ipc_trace.bin for offline replay (0/1)\n");
+    std::fprintf(file, "ipc_record = %d\n", config.debug.ipc_record ? 1 : 0);
+    std::fprintf(file, "; Also keep the first bytes the game sends in the trace (0/1)\n");
+    std::fprintf(file, "ipc_record_payload = %d\n", config.debug.ipc_record_payload ? 1 : 0);
+    std::fprintf(file, "; Dump recent packet events to flight_N.bin on latency spikes (0/1)\n");
+    std::fprintf(file, "flight_recorder = %d\n", config.debug.flight_recorder ? 1 : 0);
+    std::fprintf(file, "; Server RTT that triggers a dump (ms, 0 = off)\n");
+    std::fprintf(file, "flight_rtt_ms = %u\n", config.debug.flight_rtt_ms);
+    std::fprintf(file, "; Time a packet waits in a socket queue that triggers a dump (us, 0 = off)\n");
+    std::fprintf(file, "flight_queue_us = %u\n", config.debug.flight_queue_us);
+    std::fprintf(file, "; IPC call latency that triggers a dump (us, 0 = off)\n");
+    std::fprintf(file, "flight_ipc_us = %u\n", config.debug.flight_ipc_us);
+    std::fprintf(file, "; Minimum time between two dumps (seconds)\n");
+    std::fprintf(file, "flight_interval_s = %u\n", config.debug.flight_interval_s);
 
     std::fclose(file);
     return ConfigResult::Success;
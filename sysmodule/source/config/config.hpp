@@ -94,6 +94,20 @@ constexpr size_t MAX_PASSPHRASE_LENGTH = 64;
  */
 constexpr size_t MAX_INTERFACE_LENGTH = 32;
 
+/**
+ * @brief Maximum length of a comma-separated title ID list (excluding null terminator)
+ *
+ * Room for 15 program IDs written as 16 hex digits.
+ */
+constexpr size_t MAX_TITLE_LIST_LENGTH = 255;
+
+/**
+ * @brief Maximum length of a comma-separated port list (excluding null terminator)
+ *
+ * Room for 8 ports written as 5 decimal digits.
+ */
+constexpr size_t MAX_PORT_LIST_LENGTH = 47;
+
 /**
  * @brief Default configuration file path on SD card
  *
@@ -114,6 +128,20 @@ constexpr const char* CONFIG_DIR = "sdmc:/config/ryu_ldn_nx";
  */
 constexpr const char* LOG_PATH = "sdmc:/config/ryu_ldn_nx/ryu_ldn_nx.log";
 
+/**
+ * @brief IPC trace path on SD card
+ *
+ * Written when a game finalizes ldn:u while ipc_record is enabled.
+ */
+constexpr const char* IPC_TRACE_PATH = "sdmc:/config/ryu_ldn_nx/ipc_trace.bin";
+
+/**
+ * @brief Flight recorder dump path on SD card (%u = 0..FLIGHT_DUMP_FILES-1)
+ *
+ * Written when a flight recorder threshold is crossed, rotating.
+ */
+constexpr const char* FLIGHT_DUMP_PATH_FORMAT = "sdmc:/config/ryu_ldn_nx/flight_%u.bin";
+
 // -----------------------------------------------------------------------------
 // Default Values - Server
 // -----------------------------------------------------------------------------
@@ -153,6 +181,39 @@ constexpr bool DEFAULT_LDN_ENABLED = true;
 /** @brief Default P2P proxy disabled state (like Ryujinx MultiplayerDisableP2p) */
 constexpr bool DEFAULT_DISABLE_P2P = false;
 
+/** @brief Default dual-path redundant UDP state (off: costs upload bandwidth) */
+constexpr bool DEFAULT_REDUNDANT_UDP = false;
+
+/** @brief Default duplication budget in bytes per second */
+constexpr uint32_t DEFAULT_REDUNDANT_UDP_BUDGET = 16 * 1024;
+
+/** @brief Default broadcast repeat suppression state (off: changes the cadence games see) */
+constexpr bool DEFAULT_BROADCAST_DEDUP = false;
+
+/** @brief Default gap below which identical broadcasts are one repeat stream (ms) */
+constexpr uint32_t DEFAULT_BROADCAST_DEDUP_WINDOW_MS = 1000;
+
+/** @brief Default rate at which a repeated broadcast is still sent (ms) */
+constexpr uint32_t DEFAULT_BROADCAST_DEDUP_KEEPALIVE_MS = 200;
+
+/** @brief Default P2P broadcast fan-out delegation state (off: needs uplink_kbps) */
+constexpr bool DEFAULT_RELAY_DELEGATION = false;
+
+/** @brief Default uplink capacity in kbit/s (0 = unknown) */
+constexpr uint32_t DEFAULT_UPLINK_KBPS = 0;
+
+/**
+ * @brief Default receive-event moderation window (us, 0 = signal every datagram)
+ *
+ * Off: only readers blocked in Recv/RecvFrom are batched, while most games
+ * wait in select()/poll(), which report queued data at once. Enabling it
+ * there would only add latency.
+ */
+constexpr uint32_t DEFAULT_RX_MODERATION_US = 0;
+
+/** @brief Default same-LAN P2P host discovery state (off: opt-in on trusted LANs) */
+constexpr bool DEFAULT_LAN_DISCOVERY = false;
+
 // -----------------------------------------------------------------------------
 // Default Values - Debug
 // -----------------------------------------------------------------------------
@@ -166,6 +227,36 @@ constexpr uint32_t DEFAULT_DEBUG_LEVEL = 1;
 /** @brief Default file logging state */
 constexpr bool DEFAULT_LOG_TO_FILE = false;
 
+/** @brief Default metrics endpoint state (off: opens a LAN port) */
+constexpr bool DEFAULT_METRICS_ENABLED = false;
+
+/** @brief Default metrics endpoint port */
+constexpr uint16_t DEFAULT_METRICS_PORT = 9100;
+
+/** @brief Default UDP log collector port (no host = remote logging off) */
+constexpr uint16_t DEFAULT_LOG_UDP_PORT = 5140;
+
+/** @brief Default IPC call recording state */
+constexpr bool DEFAULT_IPC_RECORD = false;
+
+/** @brief Default IPC payload capture state (off: traces carry no game data) */
+constexpr bool DEFAULT_IPC_RECORD_PAYLOAD = false;
+
+/** @brief Default flight recorder state (off: dumps are SD card writes) */
+constexpr bool DEFAULT_FLIGHT_RECORDER = false;
+
+/** @brief Default server RTT that triggers a flight dump (ms, 0 = off) */
+constexpr uint32_t DEFAULT_FLIGHT_RTT_MS = 250;
+
+/** @brief Default proxy queueing delay that triggers a flight dump (us, 0 = off) */
+constexpr uint32_t DEFAULT_FLIGHT_QUEUE_US = 20000;
+
+/** @brief Default IPC handler latency that triggers a flight dump (us, 0 = off) */
+constexpr uint32_t DEFAULT_FLIGHT_IPC_US = 20000;
+
+/** @brief Default minimum time between two flight dumps (s) */
+constexpr uint32_t DEFAULT_FLIGHT_INTERVAL_S = 300;
+
 // =============================================================================
 // Result Codes
 // =============================================================================
@@ -231,12 +322,36 @@ struct NetworkConfig {
  * - `passphrase`: Passphrase for private rooms (max 64 chars)
  * - `interface`: Preferred network interface (empty = auto)
  * - `disable_p2p`: Disable P2P proxy (0/1) - like Ryujinx MultiplayerDisableP2p
+ * - `redundant_udp`: Send small UDP packets on both P2P and relay (0/1)
+ * - `redundant_udp_titles`: Comma-separated hex program IDs (empty = all titles)
+ * - `redundant_udp_ports`: Comma-separated game ports, either end of a flow (empty = all flows)
+ * - `redundant_udp_budget`: Extra upload allowed for duplicates (bytes/s)
+ * - `broadcast_dedup`: Drop identical repeated broadcast datagrams (0/1)
+ * - `broadcast_dedup_window`: Max gap between repeats of one stream (ms)
+ * - `broadcast_dedup_keepalive`: Send one repeat at least this often (ms)
+ * - `broadcast_dedup_exclude`: Comma-separated hex program IDs never filtered
+ * - `relay_delegation`: Hand part of the P2P host fan-out to a guest (0/1)
+ * - `uplink_kbps`: Upload capacity of this console's connection (kbit/s, 0 = unknown)
+ * - `rx_moderation_us`: Batch datagram wakeups of a reader blocked in Recv (us, 0 = off)
+ * - `lan_discovery`: Find a P2P host on the LAN and race its private address (0/1)
  */
 struct LdnConfig {
     bool enabled;                                    ///< Enable LDN emulation
     char passphrase[MAX_PASSPHRASE_LENGTH + 1];      ///< Room passphrase (null-terminated)
     char interface_name[MAX_INTERFACE_LENGTH + 1];   ///< Network interface (null-terminated)
     bool disable_p2p;                                ///< Disable P2P proxy (like Ryujinx)
+    bool redundant_udp;                              ///< Duplicate small UDP packets on both paths
+    char redundant_udp_titles[MAX_TITLE_LIST_LENGTH + 1];  ///< Titles to duplicate for (empty = all)
+    char redundant_udp_ports[MAX_PORT_LIST_LENGTH + 1];    ///< Flows to duplicate by port (empty = all)
+    uint32_t redundant_udp_budget;                   ///< Duplication budget (bytes/s)
+    bool broadcast_dedup;                            ///< Suppress repeated broadcasts upstream
+    uint32_t broadcast_dedup_window_ms;              ///< Repeat stream gap (ms)
+    uint32_t broadcast_dedup_keepalive_ms;           ///< Keepalive copy interval (ms)
+    char broadcast_dedup_exclude[MAX_TITLE_LIST_LENGTH + 1];  ///< Titles to never filter
+    bool relay_delegation;                           ///< Delegate P2P host fan-out / volunteer
+    uint32_t uplink_kbps;                            ///< Upload capacity (kbit/s, 0 = unknown)
+    uint32_t rx_moderation_us;                       ///< Receive wakeup window (us, 0 = off)
+    bool lan_discovery;                              ///< Race the P2P host's LAN address
 };
 
 /**
@@ -249,6 +364,18 @@ struct LdnConfig {
  * - `enabled`: Enable debug logging (0/1)
  * - `level`: Log verbosity (0=errors, 1=warnings, 2=info, 3=verbose)
  * - `log_to_file`: Also write logs to file (0/1)
+ * - `metrics`: Serve Prometheus metrics over HTTP (0/1)
+ * - `metrics_port`: TCP port of the metrics endpoint
+ * - `log_udp_host`: Stream logs over UDP to this IPv4 collector (empty = off)
+ * - `log_udp_port`: UDP port of the log collector
+ * - `ipc_record`: Record bsd:u/ldn:u calls to ipc_trace.bin (0/1)
+ * - `ipc_record_payload`: Also keep the first bytes sent by the game (0/1)
+ * - `flight_recorder`: Dump recent packet events on latency spikes (0/1, at most one
+ *   dump per `flight_interval_s`, 4 rotating 64 KiB files)
+ * - `flight_rtt_ms`: Server RTT that triggers a dump (ms, 0 = off)
+ * - `flight_queue_us`: Proxy socket queueing delay that triggers a dump (us, 0 = off)
+ * - `flight_ipc_us`: IPC handler latency that triggers a dump (us, 0 = off)
+ * - `flight_interval_s`: Minimum time between two dumps (s)
  *
  * ## Log Levels
  * - 0: Errors only (critical issues)
@@ -260,6 +387,17 @@ struct DebugConfig {
     bool enabled;       ///< Enable debug logging
     uint32_t level;     ///< Log level (0-3)
     bool log_to_file;   ///< Write logs to file
+    bool metrics_enabled;   ///< Serve /metrics on the LAN
+    uint16_t metrics_port;  ///< Metrics endpoint port
+    char log_udp_host[MAX_HOST_LENGTH + 1];  ///< Log collector IPv4 (empty = off)
+    uint16_t log_udp_port;  ///< Log collector port
+    bool ipc_record;        ///< Record intercepted IPC calls
+    bool ipc_record_payload;    ///< Keep payload prefixes in the IPC trace
+    bool flight_recorder;       ///< Dump recent events on latency spikes
+    uint32_t flight_rtt_ms;     ///< RTT trigger (ms, 0 = off)
+    uint32_t flight_queue_us;   ///< Queueing delay trigger (us, 0 = off)
+    uint32_t flight_ipc_us;     ///< IPC latency trigger (us, 0 = off)
+    uint32_t flight_interval_s; ///< Minimum time between dumps
 };
 
 /**
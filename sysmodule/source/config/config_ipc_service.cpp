@@ -34,6 +34,9 @@
 #include "config.hpp"
 #include "../debug/log.hpp"
 #include "../ldn/ldn_shared_state.hpp"
+#include "../diagnostics/link_test_runner.hpp"
+#include "../diagnostics/thread_stats.hpp"
+#include "../diagnostics/metrics_history.hpp"
 #include <cstring>
 
 namespace ryu_ldn::ipc {
@@ -703,4 +706,93 @@ ams::Result ConfigService::SetDisableP2p(u32 disabled) {
     R_SUCCEED();
 }
 
+// ============================================================================
+// Diagnostics
+// ============================================================================
+
+/**
+ * @brief Start a link quality test
+ *
+ * The test runs on its own worker thread and server connection; poll
+ * GetLinkTestReport for progress. Refused while a game is using LDN or
+ * while another test is running.
+ *
+ * @param out Output: 1 if the test was started, 0 otherwise
+ * @return Always succeeds
+ */
+ams::Result ConfigService::StartLinkTest(ams::sf::Out<u32> out) {
+    *out = ams::mitm::diagnostics::LinkTestRunner::GetInstance().Start() ? 1 : 0;
+
+    LOG_INFO("Config IPC: StartLinkTest -> %u", *out);
+    R_SUCCEED();
+}
+
+/**
+ * @brief Get the progress or result of the last link test
+ *
+ * @param out Output report (state Idle if no test was ever run)
+ * @return Always succeeds
+ */
+ams::Result ConfigService::GetLinkTestReport(ams::sf::Out<LinkTestReportIpc> out) {
+    ryu_ldn::diagnostics::LinkTestReport report;
+    ams::mitm::diagnostics::LinkTestRunner::GetInstance().GetReport(report);
+
+    static_assert(sizeof(LinkTestReportIpc) == sizeof(report),
+                  "LinkTestReportIpc must mirror LinkTestReport");
+    LinkTestReportIpc ipc;
+    std::memcpy(&ipc, &report, sizeof(ipc));
+    *out = ipc;
+
+    LOG_VERBOSE("Config IPC: GetLinkTestReport -> state %u", ipc.state);
+    R_SUCCEED();
+}
+
+/**
+ * @brief Get the CPU time and wakeups of one thread role
+ *
+ * @param role ryu_ldn::diagnostics::ThreadRole index; out of range
+ *             roles report no threads
+ * @param out Output totals (cumulative since boot)
+ * @return Always succeeds
+ */
+ams::Result ConfigService::GetThreadStats(u32 role, ams::sf::Out<ThreadStatsIpc> out) {
+    ryu_ldn::diagnostics::ThreadRoleStats stats{};
+    if (role < static_cast<u32>(ryu_ldn::diagnostics::ThreadRole::Count)) {
+        stats = ryu_ldn::diagnostics::g_thread_registry.role_stats(
+            static_cast<ryu_ldn::diagnostics::ThreadRole>(role));
+    }
+
+    ThreadStatsIpc ipc{};
+    ipc.cpu_us = stats.cpu_ns / 1000ULL;
+    ipc.wakeups = stats.wakeups;
+    ipc.timestamp_us = armTicksToNs(armGetSystemTick()) / 1000ULL;
+    ipc.threads = stats.threads;
+    *out = ipc;
+
+    R_SUCCEED();
+}
+
+/**
+ * @brief Get the metrics time series (see metrics_history.hpp, Wire Format)
+ *
+ * One call returns every series, so the overlay can draw all sparklines
+ * from a single request.
+ *
+ * @param resolution 0 = per-second points, 1 = per-minute points
+ * @param max_points Newest points wanted per series
+ * @param out Output buffer (header + points); fewer points are returned if it is too small
+ * @param out_size Output: bytes written, 0 if the buffer cannot hold the header
+ * @return Always succeeds
+ */
+ams::Result ConfigService::GetMetricsHistory(u32 resolution, u32 max_points, const ams::sf::OutBuffer& out,
+                                             ams::sf::Out<u32> out_size) {
+    const auto res = resolution == static_cast<u32>(ryu_ldn::diagnostics::HistoryResolution::Minute)
+                         ? ryu_ldn::diagnostics::HistoryResolution::Minute
+                         : ryu_ldn::diagnostics::HistoryResolution::Second;
+    *out_size = static_cast<u32>(ryu_ldn::diagnostics::g_metrics_history.serialize(
+        res, max_points, out.GetPointer(), out.GetSize()));
+
+    R_SUCCEED();
+}
+
 } // namespace ryu_ldn::ipc
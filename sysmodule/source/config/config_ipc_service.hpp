@@ -58,6 +58,12 @@ enum class ConfigCmd : u32 {
     // P2P Proxy control (29-30)
     GetDisableP2p       = 29,  ///< Returns 1 if P2P proxy is disabled
     SetDisableP2p       = 30,  ///< Sets P2P proxy disabled state (like Ryujinx MultiplayerDisableP2p)
+
+    // Diagnostics (31-34)
+    StartLinkTest       = 31,  ///< Starts a link quality test, returns 1 if started
+    GetLinkTestReport   = 32,  ///< Returns LinkTestReportIpc (progress or result)
+    GetThreadStats      = 33,  ///< Returns ThreadStatsIpc for one ThreadRole
+    GetMetricsHistory   = 34,  ///< Fills a buffer with the metrics time series
 };
 
 /**
@@ -95,6 +101,57 @@ struct SessionInfoIpc {
 };
 static_assert(sizeof(SessionInfoIpc) == 8);
 
+/**
+ * @brief Link test report structure for IPC
+ *
+ * Field-for-field copy of ryu_ldn::diagnostics::LinkTestReport.
+ * Times are in microseconds, throughput in kbit/s.
+ */
+struct LinkTestReportIpc {
+    u8 state;               ///< LinkTestState (0=Idle ... 6=Complete, 7=Failed)
+    u8 error;               ///< LinkTestError (Failed only)
+    u8 echo_available;      ///< 1 if the server echoed the probes
+    u8 upnp_available;      ///< 1 if a port mapping (UPnP or NAT-PMP/PCP) could be created
+    u8 p2p_possible;        ///< 1 if P2P hosting looks possible
+    u8 reserved[3];         ///< Padding
+
+    u32 pings_sent;         ///< Pings sent
+    u32 pings_received;     ///< Ping replies received
+    u32 rtt_min_us;         ///< Smallest RTT
+    u32 rtt_avg_us;         ///< Mean RTT
+    u32 rtt_p50_us;         ///< Median RTT
+    u32 rtt_p95_us;         ///< 95th percentile RTT
+    u32 rtt_p99_us;         ///< 99th percentile RTT
+    u32 rtt_max_us;         ///< Largest RTT
+    u32 jitter_us;          ///< Mean difference of consecutive RTTs
+
+    u32 echo_sent;          ///< Echo probes sent
+    u32 echo_received;      ///< Distinct probes echoed back
+    u32 echo_lost;          ///< Probes never echoed
+    u32 echo_reordered;     ///< Probes arriving out of order
+    u32 echo_duplicated;    ///< Probes echoed more than once
+    u32 upload_kbps;        ///< Upstream throughput
+    u32 download_kbps;      ///< Downstream throughput
+
+    u32 duration_ms;        ///< Total test duration
+};
+static_assert(sizeof(LinkTestReportIpc) == 76);
+
+/**
+ * @brief Thread role totals for IPC
+ *
+ * Cumulative since boot; the overlay derives CPU % and wakeups per second
+ * from two reads and their timestamps.
+ */
+struct ThreadStatsIpc {
+    u64 cpu_us;             ///< CPU time of all threads of the role
+    u64 wakeups;            ///< Wakeups of all threads of the role
+    u64 timestamp_us;       ///< System tick at the time of the read
+    u32 threads;            ///< Threads of the role currently running
+    u32 reserved;           ///< Padding
+};
+static_assert(sizeof(ThreadStatsIpc) == 32);
+
 /**
  * @brief Global configuration instance
  *
@@ -189,6 +246,23 @@ public:
 
     /// Sets P2P proxy disabled state (like Ryujinx MultiplayerDisableP2p)
     ams::Result SetDisableP2p(u32 disabled);
+
+    // =========================================================================
+    // Diagnostics
+    // =========================================================================
+
+    /// Starts a link quality test; out is 0 if busy or a game is active
+    ams::Result StartLinkTest(ams::sf::Out<u32> out);
+
+    /// Returns the progress or result of the last link test
+    ams::Result GetLinkTestReport(ams::sf::Out<LinkTestReportIpc> out);
+
+    /// Returns the CPU time and wakeups of one thread role (ThreadRole index)
+    ams::Result GetThreadStats(u32 role, ams::sf::Out<ThreadStatsIpc> out);
+
+    /// Serializes the newest max_points of every metrics history series into out
+    ams::Result GetMetricsHistory(u32 resolution, u32 max_points, const ams::sf::OutBuffer& out,
+                                  ams::sf::Out<u32> out_size);
 };
 
 } // namespace ryu_ldn::ipc
@@ -200,9 +274,11 @@ public:
 /**
  * @brief SF interface macro for ryu:cfg service
  *
- * Defines all IPC commands (0-28) for the configuration service.
+ * Defines all IPC commands (0-32) for the configuration service.
  * Commands 0-22: Configuration commands
  * Commands 23-28: Runtime LDN state commands
+ * Commands 29-30: P2P proxy control
+ * Commands 31-32: Diagnostics
  * Uses 9-arg form of AMS_SF_METHOD_INFO with explicit version range.
  */
 #define AMS_RYU_CFG_SERVICE_INTERFACE(C, H)                                                                                        \
@@ -239,7 +315,12 @@ public:
     AMS_SF_METHOD_INFO(C, H, 28, ams::Result, GetActiveProcessId, (ams::sf::Out<u64> out),                             (out),       ams::hos::Version_Min, ams::hos::Version_Max)    \
     /* P2P Proxy control commands (29-30) */                                                                                       \
     AMS_SF_METHOD_INFO(C, H, 29, ams::Result, GetDisableP2p,      (ams::sf::Out<u32> out),                             (out),       ams::hos::Version_Min, ams::hos::Version_Max)    \
-    AMS_SF_METHOD_INFO(C, H, 30, ams::Result, SetDisableP2p,      (u32 disabled),                                      (disabled),  ams::hos::Version_Min, ams::hos::Version_Max)
+    AMS_SF_METHOD_INFO(C, H, 30, ams::Result, SetDisableP2p,      (u32 disabled),                                      (disabled),  ams::hos::Version_Min, ams::hos::Version_Max)    \
+    /* Diagnostics commands (31-34) */                                                                                             \
+    AMS_SF_METHOD_INFO(C, H, 31, ams::Result, StartLinkTest,      (ams::sf::Out<u32> out),                             (out),       ams::hos::Version_Min, ams::hos::Version_Max)    \
+    AMS_SF_METHOD_INFO(C, H, 32, ams::Result, GetLinkTestReport,  (ams::sf::Out<ryu_ldn::ipc::LinkTestReportIpc> out), (out),       ams::hos::Version_Min, ams::hos::Version_Max)    \
+    AMS_SF_METHOD_INFO(C, H, 33, ams::Result, GetThreadStats,     (u32 role, ams::sf::Out<ryu_ldn::ipc::ThreadStatsIpc> out), (role, out), ams::hos::Version_Min, ams::hos::Version_Max)    \
+    AMS_SF_METHOD_INFO(C, H, 34, ams::Result, GetMetricsHistory,  (u32 resolution, u32 max_points, const ams::sf::OutBuffer &out, ams::sf::Out<u32> out_size), (resolution, max_points, out, out_size), ams::hos::Version_Min, ams::hos::Version_Max)
 
 /**
  * @brief Define the IConfigService interface
@@ -215,7 +215,7 @@ void Logger::log_v(LogLevel level, const char* format, va_list args) {
     char message[MAX_LOG_MESSAGE_LENGTH];
     format_log_message_v(message, sizeof(message), level, format, args);
 
-    output_message(message);
+    output_message(level, message);
 }
 
 void Logger::flush() {
@@ -230,13 +230,18 @@ void Logger::flush() {
 #endif
 }
 
-void Logger::output_message(const char* message) {
+void Logger::output_message(LogLevel level, const char* message) {
     // Add to circular buffer (for overlay display)
     m_buffer.add(message);
 
     // Output to console (printf on Switch goes to debug console)
     std::printf("%s\n", message);
 
+    // Output to the remote sink if set
+    if (m_sink != nullptr) {
+        m_sink->write(level, message);
+    }
+
     // Output to file if enabled
     if (m_log_to_file) {
         // Open file on-demand if not already open
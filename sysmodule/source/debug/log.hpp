@@ -44,6 +44,12 @@
  *
  * When enabled, logs are written to: `/config/ryu_ldn_nx/ryu_ldn_nx.log`
  *
+ * ## Remote Logging
+ *
+ * A LogSink set with set_sink() receives every logged message as well.
+ * LogUdpSink (log_udp_sink.hpp) streams them to a LAN collector without
+ * any storage I/O.
+ *
  * @see config/config.hpp for DebugConfig structure
  */
 
@@ -197,6 +203,30 @@ private:
     size_t m_tail = 0;  // Index where next message will be written
 };
 
+// =============================================================================
+// Log Sink
+// =============================================================================
+
+/**
+ * @brief Additional destination for log messages
+ *
+ * write() is called from whichever thread logs, for every message that
+ * passes the level filter. Implementations must not block and must not
+ * log themselves.
+ */
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    /**
+     * @brief Receive one formatted message
+     *
+     * @param level Log level of the message
+     * @param message Formatted message (with timestamp and level prefix)
+     */
+    virtual void write(LogLevel level, const char* message) = 0;
+};
+
 // =============================================================================
 // Logger Class
 // =============================================================================
@@ -288,8 +318,18 @@ public:
      */
     void check_idle_timeout();
 
+    /**
+     * @brief Forward every logged message to an additional sink
+     *
+     * Set it before other threads log (at startup), clear it before the
+     * sink is destroyed.
+     *
+     * @param sink Sink to forward to, or nullptr to stop forwarding
+     */
+    void set_sink(LogSink* sink) { m_sink = sink; }
+
 private:
-    void output_message(const char* message);
+    void output_message(LogLevel level, const char* message);
     void open_file();
     void close_file();
 
@@ -298,6 +338,7 @@ private:
     bool m_log_to_file = false;
     char m_log_path[256] = {0};
     LogBuffer m_buffer;
+    LogSink* m_sink = nullptr;
     void* m_file = nullptr;  // FILE* on PC, unused on Switch
     bool m_file_open = false;
     size_t m_file_offset = 0;
@@ -0,0 +1,251 @@
+/**
+ * @file log_udp_sink.cpp
+ * @brief UDP log sink implementation
+ *
+ * Nothing in this file may log: write() runs inside Logger, and logging
+ * from the sender thread would feed its own output back into the queue.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "log_udp_sink.hpp"
+
+#include <cstring>
+#include <mutex>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace ryu_ldn::debug {
+
+namespace {
+
+// Sender thread stack - static, only one sink runs at a time
+alignas(0x1000) uint8_t g_log_udp_thread_stack[0x2000];
+
+} // anonymous namespace
+
+// =============================================================================
+// LogDatagramReader
+// =============================================================================
+
+LogDatagramReader::LogDatagramReader(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_offset(sizeof(LogDatagramHeader))
+    , m_remaining(0)
+    , m_valid(false)
+    , m_header{}
+{
+    if (data == nullptr || size < sizeof(LogDatagramHeader)) {
+        return;
+    }
+    std::memcpy(&m_header, data, sizeof(m_header));
+    m_valid = m_header.magic == LOG_UDP_MAGIC && m_header.version == LOG_UDP_VERSION;
+    m_remaining = m_valid ? m_header.record_count : 0;
+}
+
+bool LogDatagramReader::next(LogRecordView& record) {
+    if (m_remaining == 0 || m_offset + sizeof(LogRecordHeader) > m_size) {
+        return false;
+    }
+
+    LogRecordHeader header;
+    std::memcpy(&header, m_data + m_offset, sizeof(header));
+    if (m_offset + sizeof(header) + header.length > m_size) {
+        m_remaining = 0;
+        return false;
+    }
+
+    record.time_ms = header.time_ms;
+    record.level = static_cast<LogLevel>(header.level);
+    record.text = reinterpret_cast<const char*>(m_data + m_offset + sizeof(header));
+    record.length = header.length;
+
+    m_offset += sizeof(header) + header.length;
+    m_remaining--;
+    return true;
+}
+
+// =============================================================================
+// LogUdpSink
+// =============================================================================
+
+LogUdpSink::LogUdpSink()
+    : m_fd(-1)
+    , m_running(false)
+    , m_sequence(0)
+    , m_dropped(0)
+    , m_active(0)
+    , m_staged(0)
+    , m_wake(platform::EventClearMode::Auto)
+{
+}
+
+LogUdpSink::~LogUdpSink() {
+    stop();
+}
+
+bool LogUdpSink::start(const char* host, uint16_t port) {
+    if (m_running) {
+        return true;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (host == nullptr || inet_pton(AF_INET, host, &addr.sin_addr) != 1 || port == 0) {
+        return false;
+    }
+
+    m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    // Connected so send() needs no address; non-blocking so a full socket
+    // buffer drops the datagram instead of stalling the sender
+    if (::connect(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    int flags = ::fcntl(m_fd, F_GETFL, 0);
+    ::fcntl(m_fd, F_SETFL, flags | O_NONBLOCK);
+
+    m_sequence = 0;
+    m_dropped = 0;
+    m_staged = 0;
+    m_running = true;
+    if (!m_thread.Start(&LogUdpSink::thread_entry, this, g_log_udp_thread_stack,
+                        sizeof(g_log_udp_thread_stack), platform::LowestThreadPriority, "ryu_ldn::LogUdp")) {
+        m_running = false;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void LogUdpSink::stop() {
+    if (!m_running) {
+        return;
+    }
+
+    m_running = false;
+    m_wake.Signal();
+    m_thread.Join();
+
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+void LogUdpSink::write(LogLevel level, const char* message) {
+    if (!m_running || message == nullptr) {
+        return;
+    }
+
+    size_t length = std::strlen(message);
+    if (length > MAX_LOG_MESSAGE_LENGTH) {
+        length = MAX_LOG_MESSAGE_LENGTH;
+    }
+
+    LogRecordHeader header{};
+    header.time_ms = static_cast<uint32_t>(platform::GetTickMs());
+    header.level = static_cast<uint8_t>(level);
+    header.length = static_cast<uint16_t>(length);
+    size_t record_size = sizeof(header) + length;
+
+    bool wake = false;
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_staged + record_size > LOG_UDP_QUEUE_SIZE) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        uint8_t* out = m_buffers[m_active] + m_staged;
+        std::memcpy(out, &header, sizeof(header));
+        std::memcpy(out + sizeof(header), message, length);
+
+        // Wake the sender once a full datagram is waiting
+        size_t threshold = LOG_UDP_MAX_DATAGRAM - sizeof(LogDatagramHeader);
+        wake = m_staged < threshold && m_staged + record_size >= threshold;
+        m_staged += record_size;
+    }
+
+    if (wake) {
+        m_wake.Signal();
+    }
+}
+
+void LogUdpSink::thread_entry(void* arg) {
+    static_cast<LogUdpSink*>(arg)->run();
+}
+
+void LogUdpSink::run() {
+    while (m_running) {
+        m_wake.TimedWait(LOG_UDP_FLUSH_MS);
+        drain();
+    }
+
+    // Whatever was logged before stop()
+    drain();
+}
+
+void LogUdpSink::drain() {
+    const uint8_t* records;
+    size_t size;
+    uint32_t dropped;
+    {
+        std::scoped_lock lock(m_mutex);
+        records = m_buffers[m_active];
+        size = m_staged;
+        dropped = m_dropped.load(std::memory_order_relaxed);
+        m_active ^= 1;
+        m_staged = 0;
+    }
+
+    // Pack whole records into datagrams
+    size_t offset = 0;
+    size_t datagram_size = sizeof(LogDatagramHeader);
+    uint16_t record_count = 0;
+    while (offset < size) {
+        LogRecordHeader header;
+        std::memcpy(&header, records + offset, sizeof(header));
+        size_t record_size = sizeof(header) + header.length;
+
+        if (datagram_size + record_size > LOG_UDP_MAX_DATAGRAM) {
+            send_datagram(datagram_size, record_count, dropped);
+            datagram_size = sizeof(LogDatagramHeader);
+            record_count = 0;
+        }
+
+        std::memcpy(m_datagram + datagram_size, records + offset, record_size);
+        datagram_size += record_size;
+        record_count++;
+        offset += record_size;
+    }
+
+    if (record_count > 0) {
+        send_datagram(datagram_size, record_count, dropped);
+    }
+}
+
+void LogUdpSink::send_datagram(size_t size, uint16_t record_count, uint32_t dropped) {
+    LogDatagramHeader header{};
+    header.magic = LOG_UDP_MAGIC;
+    header.version = LOG_UDP_VERSION;
+    header.record_count = record_count;
+    header.sequence = m_sequence.fetch_add(1);
+    header.dropped = dropped;
+    std::memcpy(m_datagram, &header, sizeof(header));
+
+    // A failed send shows up as a sequence gap at the collector
+    ::send(m_fd, m_datagram, size, 0);
+}
+
+} // namespace ryu_ldn::debug
@@ -0,0 +1,236 @@
+/**
+ * @file log_udp_sink.hpp
+ * @brief Streams log messages over UDP to a LAN collector
+ *
+ * File logging does a flushed SD card write per message: milliseconds of
+ * jitter on whatever thread logs, card wear, and the tail of the log is
+ * still lost on a crash. LogUdpSink instead copies each message into a
+ * staging buffer (a memcpy under a short lock) and a low priority thread
+ * batches the records into datagrams sent to a collector on the LAN.
+ *
+ * ## Behavior
+ *
+ * - write() never blocks on I/O. When the staging buffer is full the
+ *   message is dropped and counted.
+ * - The sender wakes every LOG_UDP_FLUSH_MS, or as soon as a datagram's
+ *   worth of records is staged.
+ * - Every datagram carries a sequence number (gaps = datagrams lost on the
+ *   network) and the running count of dropped records (gaps = staging
+ *   overflow), so the collector can show where the log is incomplete.
+ *
+ * ## Wire Format (little-endian)
+ *
+ * ```
+ * LogDatagramHeader (16 bytes)
+ *   0 magic "RLOG" | 4 version=1 | 5 reserved | 6 record_count(2)
+ *   8 sequence(4) | 12 dropped records since start(4)
+ * record_count x
+ *   LogRecordHeader (8 bytes)
+ *     0 time_ms(4) | 4 level(1) | 5 reserved | 6 length(2)
+ *   message text (length bytes, not null-terminated)
+ * ```
+ *
+ * ## Usage
+ *
+ * ```ini
+ * [debug]
+ * enabled = 1
+ * log_udp_host = 192.168.1.10
+ * log_udp_port = 5140
+ * ```
+ *
+ * On the PC: `tests/run_log_collector 5140`.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "log.hpp"
+#include "../platform/platform.hpp"
+
+namespace ryu_ldn::debug {
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+/** @brief Datagram magic ("RLOG" little-endian) */
+constexpr uint32_t LOG_UDP_MAGIC = 0x474F4C52;
+
+/** @brief Wire format version */
+constexpr uint8_t LOG_UDP_VERSION = 1;
+
+/** @brief Default collector port */
+constexpr uint16_t LOG_UDP_DEFAULT_PORT = 5140;
+
+/** @brief Largest datagram sent (stays under a 1500 byte MTU) */
+constexpr size_t LOG_UDP_MAX_DATAGRAM = 1200;
+
+/** @brief Staging buffer size (records waiting for the sender) */
+constexpr size_t LOG_UDP_QUEUE_SIZE = 8 * 1024;
+
+/** @brief Sender wakeup period */
+constexpr uint32_t LOG_UDP_FLUSH_MS = 100;
+
+// =============================================================================
+// Wire Format
+// =============================================================================
+
+#pragma pack(push, 1)
+
+/**
+ * @brief Datagram header
+ */
+struct LogDatagramHeader {
+    uint32_t magic;          ///< LOG_UDP_MAGIC
+    uint8_t version;         ///< LOG_UDP_VERSION
+    uint8_t reserved;
+    uint16_t record_count;   ///< Records following the header
+    uint32_t sequence;       ///< Datagram sequence number (starts at 0)
+    uint32_t dropped;        ///< Records dropped on overflow since start
+};
+
+/**
+ * @brief Record header, followed by the message text
+ */
+struct LogRecordHeader {
+    uint32_t time_ms;        ///< Console uptime in ms (wraps after ~49 days)
+    uint8_t level;           ///< LogLevel
+    uint8_t reserved;
+    uint16_t length;         ///< Message length in bytes
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(LogDatagramHeader) == 16, "LogDatagramHeader must be 16 bytes");
+static_assert(sizeof(LogRecordHeader) == 8, "LogRecordHeader must be 8 bytes");
+static_assert(sizeof(LogDatagramHeader) + sizeof(LogRecordHeader) + MAX_LOG_MESSAGE_LENGTH <= LOG_UDP_MAX_DATAGRAM,
+              "A full message must fit in one datagram");
+
+/**
+ * @brief One decoded record (text points into the datagram)
+ */
+struct LogRecordView {
+    uint32_t time_ms;
+    LogLevel level;
+    const char* text;
+    size_t length;
+};
+
+/**
+ * @brief Iterates the records of a received datagram
+ *
+ * Used by the host collector and the tests.
+ *
+ * @code
+ * LogDatagramReader reader(data, size);
+ * if (reader.valid()) {
+ *     LogRecordView record;
+ *     while (reader.next(record)) { ... }
+ * }
+ * @endcode
+ */
+class LogDatagramReader {
+public:
+    LogDatagramReader(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Magic, version and header size are correct
+     */
+    bool valid() const { return m_valid; }
+
+    const LogDatagramHeader& header() const { return m_header; }
+
+    /**
+     * @brief Decode the next record
+     *
+     * @return false at the end, or if a record is truncated
+     */
+    bool next(LogRecordView& record);
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+    uint16_t m_remaining;
+    bool m_valid;
+    LogDatagramHeader m_header;
+};
+
+// =============================================================================
+// UDP Sink
+// =============================================================================
+
+/**
+ * @brief LogSink that batches messages into UDP datagrams
+ *
+ * Only one sink may run at a time (the sender thread stack is static).
+ */
+class LogUdpSink : public LogSink {
+public:
+    LogUdpSink();
+    ~LogUdpSink() override;
+
+    LogUdpSink(const LogUdpSink&) = delete;
+    LogUdpSink& operator=(const LogUdpSink&) = delete;
+
+    /**
+     * @brief Open the socket and start the sender thread
+     *
+     * @param host Collector IPv4 address (dotted decimal)
+     * @param port Collector UDP port
+     * @return false if the address is invalid or the socket/thread failed
+     */
+    bool start(const char* host, uint16_t port);
+
+    /**
+     * @brief Send what is staged and stop the sender thread
+     */
+    void stop();
+
+    bool is_running() const { return m_running.load(); }
+
+    /**
+     * @brief Stage one message (never blocks on I/O)
+     */
+    void write(LogLevel level, const char* message) override;
+
+    /**
+     * @brief Datagrams handed to the network since start()
+     */
+    uint32_t get_sent_count() const { return m_sequence.load(); }
+
+    /**
+     * @brief Records dropped on staging overflow since start()
+     */
+    uint32_t get_dropped_count() const { return m_dropped.load(); }
+
+private:
+    static void thread_entry(void* arg);
+    void run();
+    void drain();
+    void send_datagram(size_t size, uint16_t record_count, uint32_t dropped);
+
+    int m_fd;
+    std::atomic<bool> m_running;
+    std::atomic<uint32_t> m_sequence;
+    std::atomic<uint32_t> m_dropped;
+
+    // Producers append to m_buffers[m_active]; drain() swaps and sends the other
+    platform::Mutex m_mutex;
+    uint8_t m_buffers[2][LOG_UDP_QUEUE_SIZE];
+    size_t m_active;
+    size_t m_staged;
+
+    uint8_t m_datagram[LOG_UDP_MAX_DATAGRAM];
+    platform::Event m_wake;
+    platform::Thread m_thread;
+};
+
+} // namespace ryu_ldn::debug
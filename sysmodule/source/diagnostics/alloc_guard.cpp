@@ -0,0 +1,245 @@
+/**
+ * @file alloc_guard.cpp
+ * @brief Allocation counters, no-allocation scopes and the host allocator hook
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "alloc_guard.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "../platform/platform.hpp"
+
+#if !defined(__SWITCH__) && (defined(__GLIBC__) || defined(__APPLE__))
+#include <execinfo.h>
+#include <unistd.h>
+#define RYU_ALLOC_GUARD_BACKTRACE 1
+#endif
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+namespace {
+
+struct GuardSlot {
+    std::atomic<uint64_t> thread_id{0};    ///< 0 = free
+    uint32_t depth = 0;                    ///< Nested scopes (owner only)
+    bool reporting = false;                ///< Handler running (owner only)
+    std::atomic<uint64_t> violations{0};
+};
+
+GuardSlot g_slots[ALLOC_GUARD_SLOTS];
+std::atomic<uint32_t> g_guarded_threads{0};
+std::atomic<uint64_t> g_alloc_count{0};
+std::atomic<uint64_t> g_alloc_bytes{0};
+std::atomic<AllocViolationHandler> g_handler{nullptr};
+std::atomic<void*> g_handler_user_data{nullptr};
+
+GuardSlot* find_slot(uint64_t id) {
+    for (auto& slot : g_slots) {
+        if (slot.thread_id.load(std::memory_order_acquire) == id) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+size_t capture_stack(void** frames, size_t max_frames) {
+#ifdef RYU_ALLOC_GUARD_BACKTRACE
+    int count = backtrace(frames, static_cast<int>(max_frames));
+    return count > 0 ? static_cast<size_t>(count) : 0;
+#else
+    // The console crash report carries the full stack once we abort
+    if (max_frames == 0) {
+        return 0;
+    }
+    frames[0] = __builtin_return_address(0);
+    return 1;
+#endif
+}
+
+} // namespace
+
+void alloc_guard_note(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (g_guarded_threads.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    GuardSlot* slot = find_slot(platform::GetCurrentThreadId());
+    if (slot == nullptr || slot->depth == 0 || slot->reporting) {
+        return;
+    }
+
+    // Set first: capturing the stack or the handler may allocate themselves
+    slot->reporting = true;
+    slot->violations.fetch_add(1, std::memory_order_relaxed);
+
+    AllocViolation violation;
+    violation.size = size;
+    violation.frame_count = capture_stack(violation.frames, ALLOC_GUARD_MAX_FRAMES);
+
+    AllocViolationHandler handler = g_handler.load(std::memory_order_acquire);
+    if (handler != nullptr) {
+        handler(violation, g_handler_user_data.load(std::memory_order_relaxed));
+    } else {
+        print_alloc_violation(violation);
+        std::abort();
+    }
+    slot->reporting = false;
+}
+
+uint64_t alloc_guard_count() {
+    return g_alloc_count.load(std::memory_order_relaxed);
+}
+
+uint64_t alloc_guard_bytes() {
+    return g_alloc_bytes.load(std::memory_order_relaxed);
+}
+
+void set_alloc_violation_handler(AllocViolationHandler handler, void* user_data) {
+    g_handler_user_data.store(user_data, std::memory_order_relaxed);
+    g_handler.store(handler, std::memory_order_release);
+}
+
+void print_alloc_violation(const AllocViolation& violation) {
+    std::fprintf(stderr, "alloc_guard: %zu byte allocation inside a NoAllocScope\n", violation.size);
+#ifdef RYU_ALLOC_GUARD_BACKTRACE
+    std::fflush(stderr);
+    backtrace_symbols_fd(violation.frames, static_cast<int>(violation.frame_count), STDERR_FILENO);
+#else
+    for (size_t i = 0; i < violation.frame_count; i++) {
+        std::fprintf(stderr, "  #%zu %p\n", i, violation.frames[i]);
+    }
+#endif
+}
+
+// =============================================================================
+// NoAllocScope
+// =============================================================================
+
+NoAllocScope::NoAllocScope()
+    : m_slot(SIZE_MAX)
+    , m_violations_at_open(0)
+{
+    const uint64_t id = platform::GetCurrentThreadId();
+
+    GuardSlot* slot = find_slot(id);
+    if (slot == nullptr) {
+        for (auto& candidate : g_slots) {
+            uint64_t expected = 0;
+            if (candidate.thread_id.compare_exchange_strong(expected, id, std::memory_order_acq_rel)) {
+                candidate.depth = 0;
+                candidate.reporting = false;
+                candidate.violations.store(0, std::memory_order_relaxed);
+                g_guarded_threads.fetch_add(1, std::memory_order_relaxed);
+                slot = &candidate;
+                break;
+            }
+        }
+        if (slot == nullptr) {
+            return;
+        }
+    }
+
+    slot->depth++;
+    m_slot = static_cast<size_t>(slot - g_slots);
+    m_violations_at_open = slot->violations.load(std::memory_order_relaxed);
+}
+
+NoAllocScope::~NoAllocScope() {
+    if (!active()) {
+        return;
+    }
+
+    GuardSlot& slot = g_slots[m_slot];
+    if (--slot.depth == 0) {
+        g_guarded_threads.fetch_sub(1, std::memory_order_relaxed);
+        slot.thread_id.store(0, std::memory_order_release);
+    }
+}
+
+uint64_t NoAllocScope::violations() const {
+    if (!active()) {
+        return 0;
+    }
+    return g_slots[m_slot].violations.load(std::memory_order_relaxed) - m_violations_at_open;
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
+
+#ifndef __SWITCH__
+
+// =============================================================================
+// Host allocator hook
+// =============================================================================
+//
+// Any host binary that links this file counts its allocations. On the
+// console the hook is mitm::Allocate (main.cpp), under RYU_ALLOC_GUARD.
+
+namespace {
+
+void* guarded_malloc(size_t size) {
+    ryu_ldn::diagnostics::alloc_guard_note(size);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* guarded_aligned_alloc(size_t size, std::align_val_t alignment) {
+    ryu_ldn::diagnostics::alloc_guard_note(size);
+    const size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(align, ((size != 0 ? size : 1) + align - 1) / align * align);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    void* p = guarded_malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return guarded_malloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return guarded_malloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* p = guarded_aligned_alloc(size, alignment);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+#endif // __SWITCH__
@@ -0,0 +1,147 @@
+/**
+ * @file alloc_guard.hpp
+ * @brief Allocation tracker proving the packet hot path is allocation-free
+ *
+ * Every heap allocation goes through alloc_guard_note(): the global
+ * operator new replacement of the host test build (alloc_guard.cpp), and
+ * mitm::Allocate on the console when the sysmodule is built with
+ * `make ALLOC_GUARD=1`. The tracker keeps two things:
+ *
+ * - Process-wide totals (count and bytes), read by the benchmark to report
+ *   allocations per packet.
+ * - "No-allocation" scopes: a NoAllocScope marks the calling thread, and
+ *   any allocation that thread makes before the scope ends is a violation.
+ *   The default handler prints the allocating call stack and aborts, so a
+ *   regression in the steady-state ProxyData path fails the test that
+ *   covers it instead of slowly eating the 64 KB sysmodule heap.
+ *
+ * @code
+ * WarmUp(socket);                       // first lap sizes the queues
+ * {
+ *     NoAllocScope no_alloc;
+ *     dispatcher.dispatch(header, payload, size);
+ *     socket->RecvFrom(buffer, sizeof(buffer), 0, &from);
+ * }                                     // aborts with a stack if either allocated
+ * @endcode
+ *
+ * ## Overhead
+ *
+ * - Outside any scope: one relaxed add per counter and one relaxed load.
+ * - With scopes open: a scan of ALLOC_GUARD_SLOTS atomic thread ids.
+ * - The tracker itself never allocates; scopes live in a fixed table like
+ *   ThreadRegistry, so nothing depends on thread_local support.
+ *
+ * ## Thread Safety
+ *
+ * alloc_guard_note() and the counters are safe from any thread. A scope
+ * only guards the thread that opened it.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+/** @brief Threads that can hold a NoAllocScope at the same time */
+constexpr size_t ALLOC_GUARD_SLOTS = 8;
+
+/** @brief Return addresses captured per violation */
+constexpr size_t ALLOC_GUARD_MAX_FRAMES = 24;
+
+/**
+ * @brief An allocation made inside a NoAllocScope
+ */
+struct AllocViolation {
+    size_t size;                           ///< Bytes requested
+    size_t frame_count;                    ///< Valid entries of frames
+    void* frames[ALLOC_GUARD_MAX_FRAMES];  ///< Call stack, innermost first
+};
+
+/**
+ * @brief Violation handler
+ *
+ * Runs on the allocating thread, inside the allocator. Allocations it makes
+ * itself are counted but not reported again.
+ */
+using AllocViolationHandler = void (*)(const AllocViolation& violation, void* user_data);
+
+// =============================================================================
+// Tracker
+// =============================================================================
+
+/**
+ * @brief Record one allocation (called by the allocation hooks)
+ */
+void alloc_guard_note(size_t size);
+
+/**
+ * @brief Allocations recorded since start, all threads
+ */
+uint64_t alloc_guard_count();
+
+/**
+ * @brief Bytes requested since start, all threads
+ */
+uint64_t alloc_guard_bytes();
+
+/**
+ * @brief Replace the violation handler
+ *
+ * @param handler New handler, nullptr restores the default
+ *        (print the stack to stderr and abort)
+ * @param user_data Passed to handler
+ */
+void set_alloc_violation_handler(AllocViolationHandler handler, void* user_data);
+
+/**
+ * @brief Print a violation and its call stack to stderr
+ *
+ * The default handler, minus the abort. Frames are symbolized when the
+ * binary exports them (host: link with -rdynamic), otherwise printed as
+ * addresses for addr2line.
+ */
+void print_alloc_violation(const AllocViolation& violation);
+
+/**
+ * @brief Forbids allocations on the calling thread for its lifetime
+ *
+ * Scopes nest. If ALLOC_GUARD_SLOTS other threads already hold a scope,
+ * this one is inactive (active() is false) and guards nothing.
+ */
+class NoAllocScope {
+public:
+    NoAllocScope();
+    ~NoAllocScope();
+
+    NoAllocScope(const NoAllocScope&) = delete;
+    NoAllocScope& operator=(const NoAllocScope&) = delete;
+
+    /**
+     * @brief Whether the calling thread is guarded
+     */
+    bool active() const { return m_slot != SIZE_MAX; }
+
+    /**
+     * @brief Violations on this thread since the scope was opened
+     *
+     * Only useful with a handler that returns.
+     */
+    uint64_t violations() const;
+
+private:
+    size_t m_slot;
+    uint64_t m_violations_at_open;
+};
+
+} // namespace diagnostics
+} // namespace ryu_ldn
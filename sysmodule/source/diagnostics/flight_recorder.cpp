@@ -0,0 +1,242 @@
+/**
+ * @file flight_recorder.cpp
+ * @brief Flight recorder start, dump writer and reader
+ *
+ * On the console the dump is written with ams::fs (see config.cpp for why
+ * stdio is avoided there), on the host with stdio.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "flight_recorder.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef __SWITCH__
+#include <stratosphere.hpp>
+#endif
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+const char* flight_event_to_string(FlightEventType type) {
+    switch (type) {
+        case FlightEventType::ProxyRx:     return "ProxyRx";
+        case FlightEventType::ProxyTx:     return "ProxyTx";
+        case FlightEventType::QueueDelay:  return "QueueDelay";
+        case FlightEventType::IpcCall:     return "IpcCall";
+        case FlightEventType::Rtt:         return "Rtt";
+        case FlightEventType::StateChange: return "StateChange";
+        case FlightEventType::Reconnect:   return "Reconnect";
+        case FlightEventType::Trigger:     return "Trigger";
+        default:                           return "Invalid";
+    }
+}
+
+const char* flight_trigger_to_string(FlightTrigger trigger) {
+    switch (trigger) {
+        case FlightTrigger::None:       return "None";
+        case FlightTrigger::Rtt:        return "Rtt";
+        case FlightTrigger::QueueDelay: return "QueueDelay";
+        case FlightTrigger::IpcLatency: return "IpcLatency";
+        default:                        return "Invalid";
+    }
+}
+
+// =============================================================================
+// Reader
+// =============================================================================
+
+FlightDumpReader::FlightDumpReader(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_offset(sizeof(FlightDumpHeader))
+    , m_remaining(0)
+    , m_valid(false)
+    , m_header{}
+{
+    if (data == nullptr || size < sizeof(FlightDumpHeader)) {
+        return;
+    }
+
+    std::memcpy(&m_header, data, sizeof(m_header));
+    if (m_header.magic != FLIGHT_DUMP_MAGIC ||
+        m_header.version != FLIGHT_DUMP_VERSION ||
+        m_header.event_size != sizeof(FlightEvent)) {
+        return;
+    }
+
+    size_t events_size = static_cast<size_t>(m_header.event_count) * sizeof(FlightEvent);
+    if (size - sizeof(FlightDumpHeader) < events_size) {
+        return;
+    }
+
+    m_remaining = m_header.event_count;
+    m_valid = true;
+}
+
+bool FlightDumpReader::next(FlightEvent& event) {
+    if (!m_valid || m_remaining == 0) {
+        return false;
+    }
+
+    std::memcpy(&event, m_data + m_offset, sizeof(event));
+    m_offset += sizeof(event);
+    m_remaining--;
+    return true;
+}
+
+int64_t FlightDumpReader::relative_us(const FlightEvent& event) const {
+    // Both wrap together: the difference of the low 32 bits is exact
+    const uint32_t trigger_low = static_cast<uint32_t>(m_header.trigger_time_us);
+    return static_cast<int32_t>(event.time_us - trigger_low);
+}
+
+// =============================================================================
+// Recorder
+// =============================================================================
+
+void FlightRecorder::start(const FlightThresholds& thresholds) {
+    std::scoped_lock lock(m_mutex);
+    m_thresholds[static_cast<size_t>(FlightTrigger::None)].store(0);
+    m_thresholds[static_cast<size_t>(FlightTrigger::Rtt)].store(thresholds.rtt_ms);
+    m_thresholds[static_cast<size_t>(FlightTrigger::QueueDelay)].store(thresholds.queue_delay_us);
+    m_thresholds[static_cast<size_t>(FlightTrigger::IpcLatency)].store(thresholds.ipc_latency_us);
+    m_min_interval_us = static_cast<uint64_t>(thresholds.min_interval_s) * 1000000ULL;
+    m_written = 0;
+    m_frozen = false;
+    m_has_triggered = false;
+    m_last_trigger_us = 0;
+    m_reason = FlightTrigger::None;
+    m_value = 0;
+    m_threshold = 0;
+    m_suppressed = 0;
+    m_dumps = 0;
+    m_enabled.store(true);
+}
+
+FlightDumpHeader FlightRecorder::make_header_locked() const {
+    FlightDumpHeader header{};
+    header.magic = FLIGHT_DUMP_MAGIC;
+    header.version = FLIGHT_DUMP_VERSION;
+    header.reason = static_cast<uint8_t>(m_reason);
+    header.event_size = sizeof(FlightEvent);
+    header.event_count = static_cast<uint32_t>(
+        m_written < FLIGHT_RECORDER_CAPACITY ? m_written : FLIGHT_RECORDER_CAPACITY);
+    header.suppressed = m_suppressed;
+    header.value = m_value;
+    header.threshold = m_threshold;
+    header.trigger_time_us = m_last_trigger_us;
+    return header;
+}
+
+void FlightRecorder::release_locked() {
+    // The next dump starts from a fresh window
+    m_written = 0;
+    m_suppressed = 0;
+    m_frozen = false;
+}
+
+void FlightRecorder::discard_pending() {
+    std::scoped_lock lock(m_mutex);
+    if (m_frozen) {
+        release_locked();
+    }
+}
+
+size_t FlightRecorder::serialize(uint8_t* out, size_t capacity) const {
+    std::scoped_lock lock(m_mutex);
+    if (!m_frozen) {
+        return 0;
+    }
+
+    FlightDumpHeader header = make_header_locked();
+    size_t total = sizeof(header) + header.event_count * sizeof(FlightEvent);
+    if (out == nullptr || capacity < total) {
+        return 0;
+    }
+
+    std::memcpy(out, &header, sizeof(header));
+    size_t offset = sizeof(header);
+    uint64_t first = m_written - header.event_count;
+    for (uint64_t i = first; i < m_written; i++) {
+        std::memcpy(out + offset, &m_ring[i % FLIGHT_RECORDER_CAPACITY], sizeof(FlightEvent));
+        offset += sizeof(FlightEvent);
+    }
+    return total;
+}
+
+bool FlightRecorder::write_pending(const char* path) {
+    // Frozen: record() leaves the ring alone, so it is written without the lock
+    FlightDumpHeader header;
+    size_t head;
+    {
+        std::scoped_lock lock(m_mutex);
+        if (!m_frozen) {
+            return false;
+        }
+        header = make_header_locked();
+        head = static_cast<size_t>((m_written - header.event_count) % FLIGHT_RECORDER_CAPACITY);
+    }
+
+    // Oldest first: [head, end) then [0, head) once the ring has wrapped
+    size_t first_count = header.event_count;
+    if (head + first_count > FLIGHT_RECORDER_CAPACITY) {
+        first_count = FLIGHT_RECORDER_CAPACITY - head;
+    }
+    size_t second_count = header.event_count - first_count;
+    size_t total = sizeof(header) + header.event_count * sizeof(FlightEvent);
+    bool ok = path != nullptr;
+
+#ifdef __SWITCH__
+    if (ok) {
+        ams::fs::DirectoryEntryType entry_type;
+        if (R_SUCCEEDED(ams::fs::GetEntryType(&entry_type, path))) {
+            ams::fs::DeleteFile(path);
+        }
+
+        ams::fs::FileHandle file;
+        ok = R_SUCCEEDED(ams::fs::CreateFile(path, total)) &&
+             R_SUCCEEDED(ams::fs::OpenFile(&file, path, ams::fs::OpenMode_Write));
+        if (ok) {
+            int64_t offset = 0;
+            ok = R_SUCCEEDED(ams::fs::WriteFile(file, offset, &header, sizeof(header), ams::fs::WriteOption::None));
+            offset += sizeof(header);
+            if (ok && first_count > 0) {
+                ok = R_SUCCEEDED(ams::fs::WriteFile(file, offset, &m_ring[head],
+                                                    first_count * sizeof(FlightEvent),
+                                                    ams::fs::WriteOption::None));
+                offset += first_count * sizeof(FlightEvent);
+            }
+            if (ok && second_count > 0) {
+                ok = R_SUCCEEDED(ams::fs::WriteFile(file, offset, &m_ring[0],
+                                                    second_count * sizeof(FlightEvent),
+                                                    ams::fs::WriteOption::None));
+            }
+            ams::fs::FlushFile(file);
+            ams::fs::CloseFile(file);
+        }
+    }
+#else
+    if (ok) {
+        std::FILE* file = std::fopen(path, "wb");
+        ok = file != nullptr;
+        if (ok) {
+            ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 std::fwrite(&m_ring[head], sizeof(FlightEvent), first_count, file) == first_count &&
+                 std::fwrite(&m_ring[0], sizeof(FlightEvent), second_count, file) == second_count;
+            ok = (std::fclose(file) == 0) && ok;
+        }
+    }
+    (void)total;
+#endif
+
+    std::scoped_lock lock(m_mutex);
+    m_dumps++;
+    release_locked();
+    return ok;
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
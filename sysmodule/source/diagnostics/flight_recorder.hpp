@@ -0,0 +1,479 @@
+/**
+ * @file flight_recorder.hpp
+ * @brief Opt-in event ring dumped to the SD card on latency spikes
+ *
+ * Metrics and the history show that a spike happened, not what led to it.
+ * FlightRecorder keeps the last FLIGHT_RECORDER_CAPACITY data path events
+ * in a fixed RAM ring. When the server RTT, the time a datagram waited in a
+ * proxy socket queue or an IPC handler crosses its threshold, the ring is
+ * frozen and the ldn_bg thread writes it to the SD card (flight_N.bin).
+ * `tests/run_flight_decode` prints a dump as a timeline.
+ *
+ * Off by default (`[debug] flight_recorder = 1` enables it), like the
+ * metrics endpoint: dumps are SD card writes nobody asked for otherwise.
+ *
+ * ## Overhead
+ *
+ * - Off: one relaxed atomic load per event.
+ * - On: a 16 byte copy under a short lock, no allocation, no I/O.
+ * - The ring is static (FLIGHT_RECORDER_CAPACITY x 16 bytes).
+ * - Frozen: events are dropped until the dump is written.
+ *
+ * ## Rate Limit
+ *
+ * A trigger less than min_interval_s after the previous one only counts as
+ * suppressed (reported in the next dump). Dumps rotate over
+ * FLIGHT_DUMP_FILES files, so the SD card never holds more than that.
+ *
+ * ## Events
+ *
+ * | Type        | sub                 | a         | b              | c              |
+ * |-------------|---------------------|-----------|----------------|----------------|
+ * | ProxyRx     |                     | dest port | bytes          | queued bytes   |
+ * | ProxyTx     | 1 = sent            | dest port | bytes          |                |
+ * | QueueDelay  |                     | port      | waited (us)    | queued bytes   |
+ * | IpcCall     | IpcService          | command   | duration (us)  | 1 = may block  |
+ * | Rtt         |                     |           | RTT (ms)       |                |
+ * | StateChange | FlightStateMachine  | event     | old state      | new state      |
+ * | Reconnect   |                     |           | retry count    |                |
+ * | Trigger     | FlightTrigger       |           | value          | threshold      |
+ *
+ * time_us holds the low 32 bits of the uptime in microseconds; the window
+ * is seconds long, so it is placed relative to trigger_time_us.
+ *
+ * ## File Format (little-endian)
+ *
+ * ```
+ * FlightDumpHeader (32 bytes)
+ *   0 magic "RFLT" | 4 version=1 | 5 reason | 6 event_size(2)
+ *   8 event_count(4) | 12 suppressed triggers(4) | 16 value(4)
+ *   20 threshold(4) | 24 trigger_time_us(8)
+ * event_count x FlightEvent (16 bytes), oldest first
+ * ```
+ *
+ * ## Usage
+ *
+ * ```ini
+ * [debug]
+ * flight_recorder = 1
+ * flight_rtt_ms = 250
+ * ```
+ *
+ * After a stutter, on the PC: `tests/run_flight_decode flight_0.bin`.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "../platform/platform.hpp"
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+/** @brief Dump file magic ("RFLT" little-endian) */
+constexpr uint32_t FLIGHT_DUMP_MAGIC = 0x544C4652;
+
+/** @brief Dump file version */
+constexpr uint8_t FLIGHT_DUMP_VERSION = 1;
+
+/** @brief Events kept in the ring (64 KiB, a few seconds of a busy session) */
+constexpr size_t FLIGHT_RECORDER_CAPACITY = 4096;
+
+/** @brief Dump files kept on the SD card (flight_0.bin ... rotating) */
+constexpr uint32_t FLIGHT_DUMP_FILES = 4;
+
+/**
+ * @brief Event types
+ */
+enum class FlightEventType : uint8_t {
+    ProxyRx     = 1,  ///< ProxyData routed to a proxy socket
+    ProxyTx     = 2,  ///< ProxyData sent by a proxy socket
+    QueueDelay  = 3,  ///< Datagram read after waiting in a socket queue
+    IpcCall     = 4,  ///< bsd:u or ldn:u handler finished
+    Rtt         = 5,  ///< Server keepalive RTT measured
+    StateChange = 6,  ///< Server connection or LDN state transition
+    Reconnect   = 7,  ///< Server reconnection attempt
+    Trigger     = 8,  ///< Threshold crossed, the ring froze here
+};
+
+/**
+ * @brief Thresholds that freeze the ring
+ */
+enum class FlightTrigger : uint8_t {
+    None       = 0,
+    Rtt        = 1,  ///< Server RTT (ms)
+    QueueDelay = 2,  ///< Time a datagram waited in a proxy socket queue (us)
+    IpcLatency = 3,  ///< IPC handler duration (us)
+    Count
+};
+
+/**
+ * @brief State machine of a StateChange event
+ */
+enum class FlightStateMachine : uint8_t {
+    Server = 0,  ///< network::ConnectionStateMachine
+    Ldn    = 1,  ///< ldn::LdnStateMachine (CommState)
+};
+
+/**
+ * @brief One ring entry (fields per type, see Events)
+ */
+struct __attribute__((packed)) FlightEvent {
+    uint32_t time_us;   ///< Low 32 bits of the uptime (us)
+    uint8_t type;       ///< FlightEventType
+    uint8_t sub;
+    uint16_t a;
+    uint32_t b;
+    uint32_t c;
+};
+static_assert(sizeof(FlightEvent) == 16, "FlightEvent is part of the dump format");
+
+/**
+ * @brief Dump file header
+ */
+struct __attribute__((packed)) FlightDumpHeader {
+    uint32_t magic;             ///< FLIGHT_DUMP_MAGIC
+    uint8_t version;            ///< FLIGHT_DUMP_VERSION
+    uint8_t reason;             ///< FlightTrigger
+    uint16_t event_size;        ///< sizeof(FlightEvent)
+    uint32_t event_count;
+    uint32_t suppressed;        ///< Triggers skipped by the rate limit since the last dump
+    uint32_t value;             ///< Value that crossed the threshold
+    uint32_t threshold;
+    uint64_t trigger_time_us;   ///< Uptime of the trigger (us)
+};
+static_assert(sizeof(FlightDumpHeader) == 32, "FlightDumpHeader is part of the dump format");
+
+/**
+ * @brief Trigger thresholds (0 disables a trigger)
+ */
+struct FlightThresholds {
+    uint32_t rtt_ms;
+    uint32_t queue_delay_us;
+    uint32_t ipc_latency_us;
+    uint32_t min_interval_s;    ///< Minimum time between two dumps
+};
+
+/**
+ * @brief Convert FlightEventType to string for logging
+ */
+const char* flight_event_to_string(FlightEventType type);
+
+/**
+ * @brief Convert FlightTrigger to string for logging
+ */
+const char* flight_trigger_to_string(FlightTrigger trigger);
+
+// =============================================================================
+// Reader
+// =============================================================================
+
+/**
+ * @brief Sequential reader of a dump file loaded in memory
+ */
+class FlightDumpReader {
+public:
+    /**
+     * @param data File contents (must outlive the reader)
+     * @param size File size
+     */
+    FlightDumpReader(const uint8_t* data, size_t size);
+
+    /** @brief Header is valid and every event fits in the buffer */
+    bool valid() const { return m_valid; }
+
+    const FlightDumpHeader& header() const { return m_header; }
+
+    /**
+     * @brief Read the next event
+     *
+     * @return false at the end or if the dump is invalid
+     */
+    bool next(FlightEvent& event);
+
+    /**
+     * @brief Time of an event relative to the trigger (us, negative before it)
+     */
+    int64_t relative_us(const FlightEvent& event) const;
+
+private:
+    const uint8_t* m_data;
+    size_t m_offset;
+    uint32_t m_remaining;
+    bool m_valid;
+    FlightDumpHeader m_header;
+};
+
+// =============================================================================
+// Recorder
+// =============================================================================
+
+/**
+ * @brief Event ring with threshold triggers and rate-limited dumps
+ *
+ * The event methods are inline so the data path only needs this header.
+ * start(), serialize() and write_pending() live in flight_recorder.cpp.
+ */
+class FlightRecorder {
+public:
+    FlightRecorder()
+        : m_enabled(false)
+        , m_thresholds{}
+        , m_min_interval_us(0)
+        , m_written(0)
+        , m_frozen(false)
+        , m_has_triggered(false)
+        , m_last_trigger_us(0)
+        , m_reason(FlightTrigger::None)
+        , m_value(0)
+        , m_threshold(0)
+        , m_suppressed(0)
+        , m_dumps(0)
+        , m_ring{}
+    {
+    }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * @brief Clear the ring and start recording
+     */
+    void start(const FlightThresholds& thresholds);
+
+    /**
+     * @brief Stop recording (the ring and a pending dump are kept)
+     */
+    void stop() { m_enabled.store(false); }
+
+    bool is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // -------------------------------------------------------------------------
+    // Events
+    // -------------------------------------------------------------------------
+
+    void proxy_rx(uint16_t port, size_t bytes, size_t queued_bytes) {
+        record(FlightEventType::ProxyRx, 0, port, Clamp(bytes), Clamp(queued_bytes));
+    }
+
+    void proxy_tx(uint16_t port, size_t bytes, bool sent) {
+        record(FlightEventType::ProxyTx, sent ? 1 : 0, port, Clamp(bytes), 0);
+    }
+
+    /**
+     * @param waited_ns Time between the datagram being queued and read
+     */
+    void queue_delay(uint16_t port, uint64_t waited_ns, size_t queued_bytes) {
+        const uint32_t waited_us = Clamp(waited_ns / 1000);
+        record(FlightEventType::QueueDelay, 0, port, waited_us, Clamp(queued_bytes));
+        check(FlightTrigger::QueueDelay, waited_us);
+    }
+
+    /**
+     * @param may_block The call waits for data (Recv, Select...): recorded,
+     *        but its duration is not a latency and never triggers
+     */
+    void ipc_call(uint8_t service, uint16_t command, uint64_t duration_ns, bool may_block) {
+        const uint32_t duration_us = Clamp(duration_ns / 1000);
+        record(FlightEventType::IpcCall, service, command, duration_us, may_block ? 1 : 0);
+        if (!may_block) {
+            check(FlightTrigger::IpcLatency, duration_us);
+        }
+    }
+
+    void rtt(uint64_t rtt_ms) {
+        record(FlightEventType::Rtt, 0, 0, Clamp(rtt_ms), 0);
+        check(FlightTrigger::Rtt, Clamp(rtt_ms));
+    }
+
+    void state_change(FlightStateMachine machine, uint32_t old_state, uint32_t new_state, uint16_t event = 0) {
+        record(FlightEventType::StateChange, static_cast<uint8_t>(machine), event, old_state, new_state);
+    }
+
+    void reconnect(uint32_t retry_count) {
+        record(FlightEventType::Reconnect, 0, 0, retry_count, 0);
+    }
+
+    /**
+     * @brief Append one event, unless stopped or frozen
+     */
+    void record(FlightEventType type, uint8_t sub, uint16_t a, uint32_t b, uint32_t c) {
+        if (!is_enabled()) {
+            return;
+        }
+        const uint64_t now_us = platform::GetTickNs() / 1000;
+        std::scoped_lock lock(m_mutex);
+        if (!m_frozen) {
+            append_locked(now_us, type, sub, a, b, c);
+        }
+    }
+
+    /**
+     * @brief Freeze the ring if value crosses the threshold of a trigger
+     *
+     * @return true if this call froze the ring
+     */
+    bool check(FlightTrigger trigger, uint32_t value) {
+        if (trigger >= FlightTrigger::Count || !is_enabled()) {
+            return false;
+        }
+        const uint32_t threshold = m_thresholds[static_cast<size_t>(trigger)].load(std::memory_order_relaxed);
+        if (threshold == 0 || value < threshold) {
+            return false;
+        }
+
+        const uint64_t now_us = platform::GetTickNs() / 1000;
+        std::scoped_lock lock(m_mutex);
+        if (m_frozen) {
+            return false;
+        }
+        if (m_has_triggered && now_us - m_last_trigger_us < m_min_interval_us) {
+            m_suppressed++;
+            return false;
+        }
+
+        append_locked(now_us, FlightEventType::Trigger, static_cast<uint8_t>(trigger), 0, value, threshold);
+        m_frozen = true;
+        m_has_triggered = true;
+        m_last_trigger_us = now_us;
+        m_reason = trigger;
+        m_value = value;
+        m_threshold = threshold;
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // Dumps
+    // -------------------------------------------------------------------------
+
+    /** @brief A trigger froze the ring and the dump is not written yet */
+    bool has_pending() const {
+        std::scoped_lock lock(m_mutex);
+        return m_frozen;
+    }
+
+    /** @brief Dumps written (or attempted) since start() */
+    uint32_t dumps() const {
+        std::scoped_lock lock(m_mutex);
+        return m_dumps;
+    }
+
+    /** @brief Events in the ring */
+    size_t size() const {
+        std::scoped_lock lock(m_mutex);
+        return m_written < FLIGHT_RECORDER_CAPACITY ? static_cast<size_t>(m_written) : FLIGHT_RECORDER_CAPACITY;
+    }
+
+    /**
+     * @brief Serialize the frozen ring, oldest first
+     *
+     * @param out Destination buffer
+     * @param capacity Buffer size
+     * @return Bytes written, 0 if nothing is pending or the buffer is too small
+     */
+    size_t serialize(uint8_t* out, size_t capacity) const;
+
+    /**
+     * @brief Write the frozen ring to a dump file and resume recording
+     *
+     * Recording resumes even if the write fails, so a missing SD card
+     * cannot stop the recorder for good.
+     *
+     * @param path File path (sdmc: on the console)
+     * @return false if nothing was pending or on I/O error
+     */
+    bool write_pending(const char* path);
+
+    /**
+     * @brief Resume recording without writing the pending dump
+     */
+    void discard_pending();
+
+private:
+    static uint32_t Clamp(uint64_t value) {
+        return value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+    }
+
+    void append_locked(uint64_t now_us, FlightEventType type, uint8_t sub,
+                       uint16_t a, uint32_t b, uint32_t c) {
+        FlightEvent& event = m_ring[m_written % FLIGHT_RECORDER_CAPACITY];
+        event.time_us = static_cast<uint32_t>(now_us);
+        event.type = static_cast<uint8_t>(type);
+        event.sub = sub;
+        event.a = a;
+        event.b = b;
+        event.c = c;
+        m_written++;
+    }
+
+    FlightDumpHeader make_header_locked() const;
+    void release_locked();
+
+    mutable platform::Mutex m_mutex;
+    std::atomic<bool> m_enabled;
+    std::atomic<uint32_t> m_thresholds[static_cast<size_t>(FlightTrigger::Count)];
+    uint64_t m_min_interval_us;
+    uint64_t m_written;          ///< Events written since start()
+    bool m_frozen;               ///< Trigger fired, dump pending
+    bool m_has_triggered;
+    uint64_t m_last_trigger_us;
+    FlightTrigger m_reason;
+    uint32_t m_value;
+    uint32_t m_threshold;
+    uint32_t m_suppressed;       ///< Since the last dump
+    uint32_t m_dumps;
+    FlightEvent m_ring[FLIGHT_RECORDER_CAPACITY];
+};
+
+/**
+ * @brief Recorder fed by the data path and dumped by the ldn_bg thread
+ */
+inline FlightRecorder g_flight_recorder;
+
+/**
+ * @brief Adds one IPC handler call to the flight recorder when it goes out of scope
+ *
+ * ```cpp
+ * ScopedFlightIpc flight(static_cast<uint8_t>(IpcService::Bsd), bsd_cmd::RecvFrom, true);
+ * ```
+ */
+class ScopedFlightIpc {
+public:
+    ScopedFlightIpc(uint8_t service, uint16_t command, bool may_block = false,
+                    FlightRecorder& recorder = g_flight_recorder)
+        : m_recorder(recorder.is_enabled() ? &recorder : nullptr)
+        , m_service(service)
+        , m_command(command)
+        , m_may_block(may_block)
+        , m_start_ns(m_recorder != nullptr ? platform::GetTickNs() : 0) {}
+
+    ~ScopedFlightIpc() {
+        if (m_recorder != nullptr) {
+            m_recorder->ipc_call(m_service, m_command, platform::GetTickNs() - m_start_ns, m_may_block);
+        }
+    }
+
+    ScopedFlightIpc(const ScopedFlightIpc&) = delete;
+    ScopedFlightIpc& operator=(const ScopedFlightIpc&) = delete;
+
+private:
+    FlightRecorder* m_recorder;
+    uint8_t m_service;
+    uint16_t m_command;
+    bool m_may_block;
+    uint64_t m_start_ns;
+};
+
+} // namespace diagnostics
+} // namespace ryu_ldn
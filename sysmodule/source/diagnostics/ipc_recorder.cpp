@@ -0,0 +1,305 @@
+/**
+ * @file ipc_recorder.cpp
+ * @brief IPC call ring, trace file writer and reader
+ *
+ * On the console the trace is written with ams::fs (see config.cpp for why
+ * stdio is avoided there), on the host with stdio.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "ipc_recorder.hpp"
+#include "../bsd/bsd_types.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#ifdef __SWITCH__
+#include <stratosphere.hpp>
+#endif
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+IpcRecorder g_ipc_recorder;
+
+// =============================================================================
+// Reader
+// =============================================================================
+
+IpcTraceReader::IpcTraceReader(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_offset(sizeof(IpcTraceHeader))
+    , m_remaining(0)
+    , m_valid(false)
+    , m_header{}
+{
+    if (data == nullptr || size < sizeof(IpcTraceHeader)) {
+        return;
+    }
+
+    std::memcpy(&m_header, data, sizeof(m_header));
+    if (m_header.magic != IPC_TRACE_MAGIC ||
+        m_header.version != IPC_TRACE_VERSION ||
+        m_header.record_size != sizeof(IpcRecord)) {
+        return;
+    }
+
+    size_t records_size = static_cast<size_t>(m_header.record_count) * sizeof(IpcRecord);
+    if (size - sizeof(IpcTraceHeader) < records_size) {
+        return;
+    }
+
+    m_remaining = m_header.record_count;
+    m_valid = true;
+}
+
+bool IpcTraceReader::next(IpcRecord& record) {
+    if (!m_valid || m_remaining == 0) {
+        return false;
+    }
+
+    std::memcpy(&record, m_data + m_offset, sizeof(record));
+    m_offset += sizeof(record);
+    m_remaining--;
+    return true;
+}
+
+// =============================================================================
+// Recorder
+// =============================================================================
+
+IpcRecorder::IpcRecorder()
+    : m_recording(false)
+    , m_capture_payload(false)
+    , m_start_ns(0)
+    , m_written(0)
+    , m_ring{}
+{
+}
+
+void IpcRecorder::start(bool capture_payload) {
+    std::scoped_lock lock(m_mutex);
+    m_capture_payload = capture_payload;
+    m_start_ns = platform::GetTickNs();
+    m_written = 0;
+    m_recording.store(true);
+}
+
+void IpcRecorder::stop() {
+    std::scoped_lock lock(m_mutex);
+    m_recording.store(false);
+}
+
+void IpcRecorder::record(const IpcRecord& record) {
+    std::scoped_lock lock(m_mutex);
+    // Re-checked under the lock: write_file() pauses recording
+    if (!m_recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    IpcRecord& slot = m_ring[m_written % IPC_RECORDER_CAPACITY];
+    slot = record;
+    slot.time_ns = record.time_ns >= m_start_ns ? record.time_ns - m_start_ns : 0;
+    m_written++;
+}
+
+void IpcRecorder::clear() {
+    std::scoped_lock lock(m_mutex);
+    m_start_ns = platform::GetTickNs();
+    m_written = 0;
+}
+
+size_t IpcRecorder::size() const {
+    std::scoped_lock lock(m_mutex);
+    return m_written < IPC_RECORDER_CAPACITY ? static_cast<size_t>(m_written) : IPC_RECORDER_CAPACITY;
+}
+
+size_t IpcRecorder::serialized_size() const {
+    return sizeof(IpcTraceHeader) + size() * sizeof(IpcRecord);
+}
+
+namespace {
+
+IpcTraceHeader MakeHeader(uint64_t written) {
+    IpcTraceHeader header{};
+    header.magic = IPC_TRACE_MAGIC;
+    header.version = IPC_TRACE_VERSION;
+    header.record_size = sizeof(IpcRecord);
+    header.record_count = static_cast<uint32_t>(
+        written < IPC_RECORDER_CAPACITY ? written : IPC_RECORDER_CAPACITY);
+    header.overwritten = static_cast<uint32_t>(
+        written > IPC_RECORDER_CAPACITY ? written - IPC_RECORDER_CAPACITY : 0);
+    return header;
+}
+
+} // namespace
+
+size_t IpcRecorder::serialize(uint8_t* out, size_t capacity) const {
+    std::scoped_lock lock(m_mutex);
+    IpcTraceHeader header = MakeHeader(m_written);
+    size_t total = sizeof(header) + header.record_count * sizeof(IpcRecord);
+    if (out == nullptr || capacity < total) {
+        return 0;
+    }
+
+    std::memcpy(out, &header, sizeof(header));
+    size_t offset = sizeof(header);
+    uint64_t first = m_written - header.record_count;
+    for (uint64_t i = first; i < m_written; i++) {
+        std::memcpy(out + offset, &m_ring[i % IPC_RECORDER_CAPACITY], sizeof(IpcRecord));
+        offset += sizeof(IpcRecord);
+    }
+    return total;
+}
+
+bool IpcRecorder::write_file(const char* path) {
+    // Pause so the ring can be written without holding the lock over I/O
+    IpcTraceHeader header;
+    size_t head;
+    bool was_recording;
+    {
+        std::scoped_lock lock(m_mutex);
+        header = MakeHeader(m_written);
+        head = static_cast<size_t>((m_written - header.record_count) % IPC_RECORDER_CAPACITY);
+        was_recording = m_recording.exchange(false);
+    }
+
+    bool ok = header.record_count > 0;
+
+    // Oldest first: [head, end) then [0, head) once the ring has wrapped
+    size_t first_count = header.record_count;
+    if (head + first_count > IPC_RECORDER_CAPACITY) {
+        first_count = IPC_RECORDER_CAPACITY - head;
+    }
+    size_t second_count = header.record_count - first_count;
+    size_t total = sizeof(header) + header.record_count * sizeof(IpcRecord);
+
+#ifdef __SWITCH__
+    if (ok) {
+        ams::fs::DirectoryEntryType entry_type;
+        if (R_SUCCEEDED(ams::fs::GetEntryType(&entry_type, path))) {
+            ams::fs::DeleteFile(path);
+        }
+
+        ams::fs::FileHandle file;
+        ok = R_SUCCEEDED(ams::fs::CreateFile(path, total)) &&
+             R_SUCCEEDED(ams::fs::OpenFile(&file, path, ams::fs::OpenMode_Write));
+        if (ok) {
+            int64_t offset = 0;
+            ok = R_SUCCEEDED(ams::fs::WriteFile(file, offset, &header, sizeof(header), ams::fs::WriteOption::None));
+            offset += sizeof(header);
+            if (ok) {
+                ok = R_SUCCEEDED(ams::fs::WriteFile(file, offset, &m_ring[head],
+                                                    first_count * sizeof(IpcRecord),
+                                                    ams::fs::WriteOption::None));
+                offset += first_count * sizeof(IpcRecord);
+            }
+            if (ok && second_count > 0) {
+                ok = R_SUCCEEDED(ams::fs::WriteFile(file, offset, &m_ring[0],
+                                                    second_count * sizeof(IpcRecord),
+                                                    ams::fs::WriteOption::None));
+            }
+            ams::fs::FlushFile(file);
+            ams::fs::CloseFile(file);
+        }
+    }
+#else
+    if (ok) {
+        std::FILE* file = std::fopen(path, "wb");
+        ok = file != nullptr;
+        if (ok) {
+            ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 std::fwrite(&m_ring[head], sizeof(IpcRecord), first_count, file) == first_count &&
+                 std::fwrite(&m_ring[0], sizeof(IpcRecord), second_count, file) == second_count;
+            ok = (std::fclose(file) == 0) && ok;
+        }
+    }
+    (void)total;
+#endif
+
+    if (was_recording) {
+        m_recording.store(true);
+    }
+    return ok;
+}
+
+// =============================================================================
+// ScopedIpcRecord
+// =============================================================================
+
+ScopedIpcRecord::ScopedIpcRecord(IpcService service, uint16_t command, int32_t fd,
+                                 IpcRecorder& recorder)
+    : m_recorder(recorder.is_recording() ? &recorder : nullptr)
+    , m_result(nullptr)
+    , m_error(nullptr)
+{
+    if (m_recorder == nullptr) {
+        return;
+    }
+
+    std::memset(&m_record, 0, sizeof(m_record));
+    m_record.time_ns = platform::GetTickNs();
+    m_record.service = static_cast<uint8_t>(service);
+    m_record.command = command;
+    m_record.fd = fd;
+}
+
+ScopedIpcRecord::~ScopedIpcRecord() {
+    if (m_recorder == nullptr) {
+        return;
+    }
+
+    uint64_t duration = platform::GetTickNs() - m_record.time_ns;
+    m_record.duration_ns = duration > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(duration);
+    if (m_result != nullptr || m_error != nullptr) {
+        m_record.flags |= IPC_RECORD_HAS_RESULT;
+        m_record.result = m_result != nullptr ? *m_result : 0;
+        m_record.error = m_error != nullptr ? *m_error : 0;
+    }
+    m_recorder->record(m_record);
+}
+
+void ScopedIpcRecord::set_args(int32_t arg0, int32_t arg1) {
+    if (m_recorder == nullptr) {
+        return;
+    }
+    m_record.arg0 = arg0;
+    m_record.arg1 = arg1;
+}
+
+void ScopedIpcRecord::set_buffer(const void* data, size_t size) {
+    if (m_recorder == nullptr) {
+        return;
+    }
+    m_record.size = static_cast<uint32_t>(size);
+    if (m_recorder->captures_payload() && data != nullptr) {
+        size_t captured = size < IPC_RECORD_PAYLOAD ? size : IPC_RECORD_PAYLOAD;
+        std::memcpy(m_record.payload, data, captured);
+        m_record.payload_len = static_cast<uint16_t>(captured);
+    }
+}
+
+void ScopedIpcRecord::set_sockaddr(const void* sockaddr, size_t size) {
+    if (m_recorder == nullptr || sockaddr == nullptr || size < sizeof(bsd::SockAddrIn)) {
+        return;
+    }
+    bsd::SockAddrIn addr;
+    std::memcpy(&addr, sockaddr, sizeof(addr));
+    if (addr.sin_family != static_cast<uint8_t>(bsd::AddressFamily::Inet)) {
+        return;
+    }
+    m_record.flags |= IPC_RECORD_HAS_ADDR;
+    m_record.addr_ip = addr.GetAddr();
+    m_record.addr_port = addr.GetPort();
+}
+
+void ScopedIpcRecord::watch(const int32_t* result, const int32_t* error) {
+    m_result = result;
+    m_error = error;
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
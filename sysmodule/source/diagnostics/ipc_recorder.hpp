@@ -0,0 +1,346 @@
+/**
+ * @file ipc_recorder.hpp
+ * @brief Binary recorder of intercepted bsd:u and ldn:u calls
+ *
+ * Packet captures show what reaches the network, not what the game asked
+ * for. IpcRecorder keeps the last IPC_RECORDER_CAPACITY intercepted calls
+ * (command, fd, sizes, flags, address, result, timing and optionally the
+ * first bytes of the payload) in a fixed RAM ring. The ring is written to
+ * the SD card when the game finalizes ldn:u, and `tests/run_ipc_replay`
+ * drives the same sequence through the host build of ProxySocketManager
+ * and the LDN packet handling.
+ *
+ * ## Overhead
+ *
+ * - Off: one relaxed atomic load per call.
+ * - On: a 64 byte copy under a short lock, no allocation, no I/O.
+ * - The ring is static (IPC_RECORDER_CAPACITY x 64 bytes), the oldest
+ *   records are overwritten and counted.
+ *
+ * ## Record Fields
+ *
+ * | Command (bsd:u)    | fd | arg0    | arg1       | size    | addr   | result        |
+ * |--------------------|----|---------|------------|---------|--------|---------------|
+ * | Socket (2)         | -  | type    | protocol   |         |        | fd            |
+ * | Select (5)         | -  | nfds    | timeout ms |         |        | ready count   |
+ * | Poll (6)           | -  | nfds    | timeout ms |         |        | ready count   |
+ * | Recv (8)           | fd | flags   |            | buffer  |        | bytes         |
+ * | RecvFrom (9)       | fd | flags   |            | buffer  |        | bytes         |
+ * | Send (10)          | fd | flags   |            | payload |        | bytes         |
+ * | SendTo (11)        | fd | flags   |            | payload | dest   | bytes         |
+ * | Bind (13)          | fd |         |            |         | local  |               |
+ * | Connect (14)       | fd |         |            |         | remote |               |
+ * | Listen (18)        | fd | backlog |            |         |        |               |
+ * | Close (26)         | fd |         |            |         |        |               |
+ *
+ * `error` holds the BSD errno of every bsd:u record. ldn:u records carry
+ * the command and its timing only (handlers return through R_TRY).
+ *
+ * ## File Format (little-endian)
+ *
+ * ```
+ * IpcTraceHeader (16 bytes)
+ *   0 magic "RIPC" | 4 version=1 | 5 reserved | 6 record_size(2)
+ *   8 record_count(4) | 12 overwritten records(4)
+ * record_count x IpcRecord (64 bytes), oldest first
+ * ```
+ *
+ * ## Usage
+ *
+ * ```ini
+ * [debug]
+ * ipc_record = 1
+ * ipc_record_payload = 1
+ * ```
+ *
+ * Play, leave the LDN session, then on the PC:
+ * `tests/run_ipc_replay ipc_trace.bin`.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "../platform/platform.hpp"
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+/** @brief Trace file magic ("RIPC" little-endian) */
+constexpr uint32_t IPC_TRACE_MAGIC = 0x43504952;
+
+/** @brief Trace file version */
+constexpr uint8_t IPC_TRACE_VERSION = 1;
+
+/** @brief Records kept in the ring (64 KiB) */
+constexpr size_t IPC_RECORDER_CAPACITY = 1024;
+
+/** @brief Payload bytes kept per record when payload capture is on */
+constexpr size_t IPC_RECORD_PAYLOAD = 16;
+
+/** @brief bsd:u command ids recorded (switchbrew numbering) */
+namespace bsd_cmd {
+    constexpr uint16_t Socket   = 2;
+    constexpr uint16_t Select   = 5;
+    constexpr uint16_t Poll     = 6;
+    constexpr uint16_t Recv     = 8;
+    constexpr uint16_t RecvFrom = 9;
+    constexpr uint16_t Send     = 10;
+    constexpr uint16_t SendTo   = 11;
+    constexpr uint16_t Bind     = 13;
+    constexpr uint16_t Connect  = 14;
+    constexpr uint16_t Listen   = 18;
+    constexpr uint16_t Close    = 26;
+}
+
+/** @brief ldn:u ICommunicationService command ids recorded */
+namespace ldn_cmd {
+    constexpr uint16_t GetState                   = 0;
+    constexpr uint16_t GetNetworkInfo             = 1;
+    constexpr uint16_t GetIpv4Address             = 2;
+    constexpr uint16_t GetNetworkInfoLatestUpdate = 101;
+    constexpr uint16_t Scan                       = 102;
+    constexpr uint16_t CreateNetwork              = 202;
+    constexpr uint16_t CreateNetworkPrivate       = 203;
+    constexpr uint16_t DestroyNetwork             = 204;
+    constexpr uint16_t SetAdvertiseData           = 206;
+    constexpr uint16_t Connect                    = 302;
+    constexpr uint16_t ConnectPrivate             = 303;
+    constexpr uint16_t Disconnect                 = 304;
+}
+
+// =============================================================================
+// File Format
+// =============================================================================
+
+/**
+ * @brief Service a record belongs to
+ */
+enum class IpcService : uint8_t {
+    Bsd = 0,   ///< bsd:u / bsd:s
+    Ldn = 1,   ///< ldn:u ICommunicationService
+};
+
+/** @brief IpcRecord::flags: addr_ip/addr_port are set */
+constexpr uint8_t IPC_RECORD_HAS_ADDR = 0x01;
+
+/** @brief IpcRecord::flags: result/error are set */
+constexpr uint8_t IPC_RECORD_HAS_RESULT = 0x02;
+
+#pragma pack(push, 1)
+
+/**
+ * @brief Trace file header
+ */
+struct IpcTraceHeader {
+    uint32_t magic;          ///< IPC_TRACE_MAGIC
+    uint8_t version;         ///< IPC_TRACE_VERSION
+    uint8_t reserved;
+    uint16_t record_size;    ///< sizeof(IpcRecord)
+    uint32_t record_count;   ///< Records following the header
+    uint32_t overwritten;    ///< Older records lost to the ring wrapping
+};
+
+/**
+ * @brief One intercepted call (see the field table above)
+ */
+struct IpcRecord {
+    uint64_t time_ns;        ///< Call start, relative to IpcRecorder::start()
+    uint32_t duration_ns;    ///< Time spent in the handler (saturates)
+    uint8_t service;         ///< IpcService
+    uint8_t flags;           ///< IPC_RECORD_* flags
+    uint16_t command;        ///< Command id
+    int32_t fd;              ///< Socket fd, -1 if none
+    int32_t arg0;
+    int32_t arg1;
+    int32_t result;          ///< Return value (bytes, fd, ready count)
+    int32_t error;           ///< BSD errno
+    uint32_t size;           ///< Buffer size passed by the game
+    uint32_t addr_ip;        ///< Address (host byte order)
+    uint16_t addr_port;      ///< Port (host byte order)
+    uint16_t payload_len;    ///< Payload bytes captured below
+    uint8_t payload[IPC_RECORD_PAYLOAD];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(IpcTraceHeader) == 16, "IpcTraceHeader must be 16 bytes");
+static_assert(sizeof(IpcRecord) == 64, "IpcRecord must be 64 bytes");
+
+/**
+ * @brief Iterates the records of a trace file loaded in memory
+ *
+ * Used by the host replayer and the tests.
+ */
+class IpcTraceReader {
+public:
+    IpcTraceReader(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Magic, version, record size and length are correct
+     */
+    bool valid() const { return m_valid; }
+
+    const IpcTraceHeader& header() const { return m_header; }
+
+    /**
+     * @brief Copy the next record
+     *
+     * @return false at the end
+     */
+    bool next(IpcRecord& record);
+
+private:
+    const uint8_t* m_data;
+    size_t m_offset;
+    uint32_t m_remaining;
+    bool m_valid;
+    IpcTraceHeader m_header;
+};
+
+// =============================================================================
+// Recorder
+// =============================================================================
+
+/**
+ * @brief Fixed-memory ring of IpcRecord
+ *
+ * Thread-safe: game threads record concurrently.
+ */
+class IpcRecorder {
+public:
+    IpcRecorder();
+
+    IpcRecorder(const IpcRecorder&) = delete;
+    IpcRecorder& operator=(const IpcRecorder&) = delete;
+
+    /**
+     * @brief Clear the ring and start recording
+     *
+     * @param capture_payload Keep the first IPC_RECORD_PAYLOAD bytes sent
+     */
+    void start(bool capture_payload);
+
+    /**
+     * @brief Stop recording (the ring is kept)
+     */
+    void stop();
+
+    bool is_recording() const { return m_recording.load(std::memory_order_relaxed); }
+    bool captures_payload() const { return m_capture_payload; }
+
+    /**
+     * @brief Append one record, overwriting the oldest when full
+     *
+     * @param record Record with time_ns as a GetTickNs() value
+     */
+    void record(const IpcRecord& record);
+
+    /**
+     * @brief Forget every record (keeps recording state)
+     */
+    void clear();
+
+    /**
+     * @brief Number of records in the ring
+     */
+    size_t size() const;
+
+    /**
+     * @brief Serialize the ring, oldest first
+     *
+     * @param out Destination buffer
+     * @param capacity Buffer size
+     * @return Bytes written, 0 if the buffer is too small
+     */
+    size_t serialize(uint8_t* out, size_t capacity) const;
+
+    /**
+     * @brief Bytes serialize() needs for the current ring
+     */
+    size_t serialized_size() const;
+
+    /**
+     * @brief Write the ring to a trace file
+     *
+     * Recording pauses while the file is written.
+     *
+     * @param path File path (sdmc: on the console)
+     * @return false on I/O error or empty ring
+     */
+    bool write_file(const char* path);
+
+private:
+    mutable platform::Mutex m_mutex;
+    std::atomic<bool> m_recording;
+    bool m_capture_payload;
+    uint64_t m_start_ns;
+    uint64_t m_written;      ///< Records written since clear()
+    IpcRecord m_ring[IPC_RECORDER_CAPACITY];
+};
+
+/**
+ * @brief Recorder shared by the bsd:u and ldn:u handlers
+ */
+extern IpcRecorder g_ipc_recorder;
+
+/**
+ * @brief Records one IPC handler call when it goes out of scope
+ *
+ * Results are read through pointers at destruction so every return path of
+ * the handler is covered.
+ *
+ * @code
+ * ScopedIpcRecord ipc_record(IpcService::Bsd, bsd_cmd::SendTo, fd);
+ * ipc_record.set_args(flags, 0);
+ * ipc_record.set_buffer(buffer.GetPointer(), buffer.GetSize());
+ * ipc_record.watch(out_size.GetPointer(), out_errno.GetPointer());
+ * @endcode
+ */
+class ScopedIpcRecord {
+public:
+    ScopedIpcRecord(IpcService service, uint16_t command, int32_t fd = -1,
+                    IpcRecorder& recorder = g_ipc_recorder);
+    ~ScopedIpcRecord();
+
+    ScopedIpcRecord(const ScopedIpcRecord&) = delete;
+    ScopedIpcRecord& operator=(const ScopedIpcRecord&) = delete;
+
+    void set_args(int32_t arg0, int32_t arg1);
+
+    /**
+     * @brief Record a buffer size, and its first bytes if payload capture is on
+     */
+    void set_buffer(const void* data, size_t size);
+
+    /**
+     * @brief Record an address given in network byte order (sockaddr_in)
+     */
+    void set_sockaddr(const void* sockaddr, size_t size);
+
+    /**
+     * @brief Read result and errno when the handler returns
+     *
+     * @param result Return value slot, or nullptr
+     * @param error BSD errno slot, or nullptr
+     */
+    void watch(const int32_t* result, const int32_t* error);
+
+private:
+    IpcRecorder* m_recorder;   ///< nullptr when not recording
+    const int32_t* m_result;
+    const int32_t* m_error;
+    IpcRecord m_record;
+};
+
+} // namespace diagnostics
+} // namespace ryu_ldn
@@ -0,0 +1,523 @@
+/**
+ * @file link_test.cpp
+ * @brief On-demand link quality test engine implementation
+ *
+ * See link_test.hpp for the phase overview. All timing uses the platform
+ * clock in microseconds; the client is driven with millisecond time like
+ * every other RyuLdnClient user.
+ *
+ * ## Throughput Measurement
+ *
+ * Probes are sent with at most `echo_window` in flight, so the kernel send
+ * buffer cannot hide the uplink. Upstream throughput is probe bytes sent
+ * over the span between the first and last send; downstream throughput is
+ * echoed bytes over the span between the first and last echo arrival.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "link_test.hpp"
+#include "../debug/log.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+namespace {
+
+/// Ping IDs used by the burst start here so they never collide with keepalives
+constexpr uint8_t PING_ID_BASE = 0x80;
+
+/// User name advertised for the throw-away access point
+constexpr const char* LINK_TEST_USER_NAME = "ryu_ldn_nx linktest";
+
+/**
+ * @brief Nearest-rank percentile of a sorted array
+ */
+uint32_t percentile(const uint32_t* sorted, size_t count, uint32_t pct) {
+    size_t rank = (static_cast<size_t>(pct) * count + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+} // namespace
+
+// ============================================================================
+// LinkTestConfig
+// ============================================================================
+
+/**
+ * @brief Default test parameters
+ *
+ * - 20 pings, 50ms apart, 1s grace for late replies
+ * - 256 probes of 1024 bytes, 16 in flight, 2s stall timeout
+ * - 5s timeout for connect and network creation
+ *
+ * A full run takes a few seconds on a healthy link.
+ */
+LinkTestConfig::LinkTestConfig()
+    : ping_count(20)
+    , ping_interval_ms(50)
+    , ping_timeout_ms(1000)
+    , echo_count(256)
+    , echo_payload_size(1024)
+    , echo_window(16)
+    , echo_timeout_ms(2000)
+    , phase_timeout_ms(5000)
+{
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+void compute_rtt_stats(const uint32_t* samples, size_t count, RttStats& out) {
+    out = RttStats{};
+    if (samples == nullptr || count == 0) {
+        return;
+    }
+    count = std::min<size_t>(count, LINK_TEST_MAX_PINGS);
+
+    uint32_t sorted[LINK_TEST_MAX_PINGS];
+    std::memcpy(sorted, samples, count * sizeof(uint32_t));
+    std::sort(sorted, sorted + count);
+
+    uint64_t sum = 0;
+    uint64_t jitter_sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += samples[i];
+        if (i > 0) {
+            jitter_sum += (samples[i] > samples[i - 1])
+                ? samples[i] - samples[i - 1]
+                : samples[i - 1] - samples[i];
+        }
+    }
+
+    out.min_us = sorted[0];
+    out.max_us = sorted[count - 1];
+    out.avg_us = static_cast<uint32_t>(sum / count);
+    out.p50_us = percentile(sorted, count, 50);
+    out.p95_us = percentile(sorted, count, 95);
+    out.p99_us = percentile(sorted, count, 99);
+    out.jitter_us = (count > 1) ? static_cast<uint32_t>(jitter_sum / (count - 1)) : 0;
+}
+
+uint32_t throughput_kbps(uint64_t bytes, uint64_t duration_us) {
+    if (duration_us == 0) {
+        return 0;
+    }
+    // bits / ms == kbit/s
+    uint64_t kbps = (bytes * 8 * 1000) / duration_us;
+    return kbps > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(kbps);
+}
+
+const char* link_test_state_to_string(LinkTestState state) {
+    switch (state) {
+        case LinkTestState::Idle:            return "Idle";
+        case LinkTestState::Connecting:      return "Connecting";
+        case LinkTestState::Pinging:         return "Pinging";
+        case LinkTestState::CreatingNetwork: return "CreatingNetwork";
+        case LinkTestState::Echoing:         return "Echoing";
+        case LinkTestState::Probing:         return "Probing";
+        case LinkTestState::Complete:        return "Complete";
+        case LinkTestState::Failed:          return "Failed";
+        default:                             return "Unknown";
+    }
+}
+
+// ============================================================================
+// LinkTest - Lifecycle
+// ============================================================================
+
+LinkTest::LinkTest()
+    : m_client()
+    , m_config()
+    , m_platform{}
+    , m_report{}
+    , m_start_us(0)
+    , m_phase_start_us(0)
+    , m_ping_sent_us{}
+    , m_rtt_samples{}
+    , m_last_ping_us(0)
+    , m_virtual_ip(0)
+    , m_network_created(false)
+    , m_received_bitmap{}
+    , m_highest_sequence(0)
+    , m_bytes_sent(0)
+    , m_bytes_received(0)
+    , m_first_send_us(0)
+    , m_last_send_us(0)
+    , m_first_recv_us(0)
+    , m_last_recv_us(0)
+    , m_probe_buffer{}
+{
+}
+
+LinkTest::~LinkTest() {
+    abort();
+}
+
+bool LinkTest::start(const network::RyuLdnClientConfig& client_config,
+                     const LinkTestConfig& config,
+                     const LinkTestPlatform& platform) {
+    abort();
+
+    m_config = config;
+    m_config.ping_count = std::min(m_config.ping_count, LINK_TEST_MAX_PINGS);
+    m_config.echo_count = std::min(m_config.echo_count, LINK_TEST_MAX_ECHOES);
+    m_config.echo_payload_size = std::clamp<uint32_t>(m_config.echo_payload_size,
+                                                      sizeof(LinkTestProbeHeader),
+                                                      LINK_TEST_MAX_PAYLOAD);
+    m_config.echo_window = std::max<uint32_t>(m_config.echo_window, 1);
+    m_platform = platform;
+
+    m_report = LinkTestReport{};
+    std::memset(m_ping_sent_us, 0, sizeof(m_ping_sent_us));
+    std::memset(m_rtt_samples, 0, sizeof(m_rtt_samples));
+    std::memset(m_received_bitmap, 0, sizeof(m_received_bitmap));
+    m_last_ping_us = 0;
+    m_virtual_ip = 0;
+    m_network_created = false;
+    m_highest_sequence = 0;
+    m_bytes_sent = 0;
+    m_bytes_received = 0;
+    m_first_send_us = 0;
+    m_last_send_us = 0;
+    m_first_recv_us = 0;
+    m_last_recv_us = 0;
+
+    // Dedicated connection: no keepalive pings, no automatic reconnection,
+    // and a short receive poll so echoes are timestamped promptly
+    network::RyuLdnClientConfig cfg = client_config;
+    cfg.ping_interval_ms = 0;
+    cfg.recv_timeout_ms = LINK_TEST_RECV_TIMEOUT_MS;
+    cfg.auto_reconnect = false;
+    m_client.set_config(cfg);
+    m_client.set_pong_callback(pong_callback, this);
+    m_client.set_packet_callback(packet_callback, this);
+
+    m_start_us = now_us();
+    enter(LinkTestState::Connecting, m_start_us);
+
+    LOG_INFO("LinkTest: starting against %s:%u", cfg.host, cfg.port);
+
+    if (m_client.connect() != network::ClientOpResult::Success || !m_client.is_connected()) {
+        fail(LinkTestError::ConnectFailed);
+        return false;
+    }
+    return true;
+}
+
+bool LinkTest::update() {
+    if (!is_running()) {
+        return false;
+    }
+
+    uint64_t now = now_us();
+    m_client.update(now / 1000);
+
+    switch (m_report.state) {
+        case LinkTestState::Pinging:
+        case LinkTestState::CreatingNetwork:
+        case LinkTestState::Echoing:
+            if (!m_client.is_ready()) {
+                fail(LinkTestError::ConnectionLost);
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+
+    switch (m_report.state) {
+        case LinkTestState::Connecting:      update_connecting(now);       break;
+        case LinkTestState::Pinging:         update_pinging(now);          break;
+        case LinkTestState::CreatingNetwork: update_creating_network(now); break;
+        case LinkTestState::Echoing:         update_echoing(now);          break;
+        case LinkTestState::Probing:         update_probing(now);          break;
+        default:                                                            break;
+    }
+
+    return is_running();
+}
+
+void LinkTest::abort() {
+    if (is_running()) {
+        LOG_INFO("LinkTest: aborted in %s", link_test_state_to_string(m_report.state));
+        m_report.state = LinkTestState::Failed;
+    }
+    m_client.disconnect();
+}
+
+bool LinkTest::is_running() const {
+    return m_report.state != LinkTestState::Idle &&
+           m_report.state != LinkTestState::Complete &&
+           m_report.state != LinkTestState::Failed;
+}
+
+// ============================================================================
+// LinkTest - Phases
+// ============================================================================
+
+void LinkTest::update_connecting(uint64_t now) {
+    if (m_client.is_ready()) {
+        enter(LinkTestState::Pinging, now);
+        return;
+    }
+
+    if (!m_client.is_connected() ||
+        now - m_phase_start_us >= static_cast<uint64_t>(m_config.phase_timeout_ms) * 1000) {
+        fail(LinkTestError::HandshakeFailed);
+    }
+}
+
+void LinkTest::update_pinging(uint64_t now) {
+    uint64_t interval_us = static_cast<uint64_t>(m_config.ping_interval_ms) * 1000;
+
+    if (m_report.pings_sent < m_config.ping_count &&
+        (m_report.pings_sent == 0 || now - m_last_ping_us >= interval_us)) {
+        uint32_t index = m_report.pings_sent;
+        m_ping_sent_us[index] = now;
+        m_last_ping_us = now;
+        m_report.pings_sent++;
+        m_client.send_ping_request(static_cast<uint8_t>(PING_ID_BASE + index));
+    }
+
+    bool all_sent = m_report.pings_sent >= m_config.ping_count;
+    bool all_received = m_report.pings_received >= m_config.ping_count;
+    bool timed_out = all_sent &&
+        now - m_last_ping_us >= static_cast<uint64_t>(m_config.ping_timeout_ms) * 1000;
+
+    if (all_received || timed_out) {
+        compute_rtt_stats(m_rtt_samples, m_report.pings_received, m_report.rtt);
+        LOG_INFO("LinkTest: ping %u/%u, rtt p50=%uus p95=%uus max=%uus",
+                 m_report.pings_received, m_report.pings_sent,
+                 m_report.rtt.p50_us, m_report.rtt.p95_us, m_report.rtt.max_us);
+
+        if (m_config.echo_count > 0 && send_create_network()) {
+            enter(LinkTestState::CreatingNetwork, now);
+        } else {
+            enter(LinkTestState::Probing, now);
+        }
+    }
+}
+
+void LinkTest::update_creating_network(uint64_t now) {
+    if (m_network_created) {
+        enter(LinkTestState::Echoing, now);
+        return;
+    }
+
+    if (now - m_phase_start_us >= static_cast<uint64_t>(m_config.phase_timeout_ms) * 1000) {
+        LOG_WARN("LinkTest: server did not create the test network, skipping echo");
+        enter(LinkTestState::Probing, now);
+    }
+}
+
+void LinkTest::update_echoing(uint64_t now) {
+    // Keep the window full
+    while (m_report.echo_sent < m_config.echo_count &&
+           m_report.echo_sent - m_report.echo_received < m_config.echo_window) {
+        LinkTestProbeHeader probe{};
+        probe.magic = LINK_TEST_PROBE_MAGIC;
+        probe.sequence = m_report.echo_sent;
+        probe.send_time_us = now;
+        std::memcpy(m_probe_buffer, &probe, sizeof(probe));
+
+        protocol::ProxyDataHeader header{};
+        header.info.source_ipv4 = m_virtual_ip;
+        header.info.source_port = LINK_TEST_PROBE_PORT;
+        header.info.dest_ipv4 = m_virtual_ip;
+        header.info.dest_port = LINK_TEST_PROBE_PORT;
+        header.info.protocol = protocol::ProtocolType::Udp;
+        header.data_length = m_config.echo_payload_size;
+
+        if (m_client.send_proxy_data(header, m_probe_buffer, m_config.echo_payload_size) !=
+            network::ClientOpResult::Success) {
+            break;
+        }
+
+        if (m_report.echo_sent == 0) {
+            m_first_send_us = now;
+        }
+        m_last_send_us = now_us();
+        m_bytes_sent += m_config.echo_payload_size;
+        m_report.echo_sent++;
+    }
+
+    bool all_received = m_report.echo_received >= m_config.echo_count;
+    // Receive stamps are taken inside m_client.update(), so they may be newer than now
+    uint64_t last_progress = std::max(m_first_send_us, m_last_recv_us);
+    bool stalled = m_report.echo_sent > 0 && now > last_progress &&
+        now - last_progress >= static_cast<uint64_t>(m_config.echo_timeout_ms) * 1000;
+
+    if (all_received || stalled) {
+        finalize_echo_stats();
+        m_client.send_disconnect_network();
+        enter(LinkTestState::Probing, now);
+    }
+}
+
+void LinkTest::update_probing(uint64_t /*now*/) {
+    // The server connection is no longer needed; probes may block for seconds
+    m_client.disconnect();
+
+    bool upnp_ok = false;
+    if (m_platform.probe_upnp != nullptr) {
+        upnp_ok = m_platform.probe_upnp(m_platform.user_data);
+    }
+    m_report.upnp_available = upnp_ok ? 1 : 0;
+
+    if (m_platform.probe_p2p != nullptr) {
+        m_report.p2p_possible = m_platform.probe_p2p(upnp_ok, m_platform.user_data) ? 1 : 0;
+    }
+
+    // Probes can take seconds, so stamp completion after they return
+    finish(now_us());
+}
+
+// ============================================================================
+// LinkTest - Internal Helpers
+// ============================================================================
+
+uint64_t LinkTest::now_us() const {
+    return m_platform.now_us != nullptr ? m_platform.now_us(m_platform.user_data) : 0;
+}
+
+void LinkTest::enter(LinkTestState state, uint64_t now) {
+    LOG_VERBOSE("LinkTest: %s -> %s", link_test_state_to_string(m_report.state),
+                link_test_state_to_string(state));
+    m_report.state = state;
+    m_phase_start_us = now;
+}
+
+void LinkTest::fail(LinkTestError error) {
+    LOG_WARN("LinkTest: failed in %s (error=%u)", link_test_state_to_string(m_report.state),
+             static_cast<uint32_t>(error));
+    m_report.error = error;
+    m_report.state = LinkTestState::Failed;
+    m_report.duration_ms = static_cast<uint32_t>((now_us() - m_start_us) / 1000);
+    m_client.disconnect();
+}
+
+void LinkTest::finish(uint64_t now) {
+    m_report.duration_ms = static_cast<uint32_t>((now - m_start_us) / 1000);
+    enter(LinkTestState::Complete, now);
+    LOG_INFO("LinkTest: complete in %ums (upnp=%u, p2p=%u)",
+             m_report.duration_ms, m_report.upnp_available, m_report.p2p_possible);
+}
+
+bool LinkTest::send_create_network() {
+    protocol::CreateAccessPointRequest request{};
+    request.security_config.security_mode = static_cast<uint16_t>(protocol::SecurityMode::Product);
+    std::strncpy(request.user_config.user_name, LINK_TEST_USER_NAME,
+                 sizeof(request.user_config.user_name) - 1);
+    request.network_config.intent_id.local_communication_id = LINK_TEST_LOCAL_COMM_ID;
+    request.network_config.channel = 1;
+    request.network_config.node_count_max = 1;
+
+    return m_client.send_create_access_point(request) == network::ClientOpResult::Success;
+}
+
+void LinkTest::finalize_echo_stats() {
+    m_report.echo_lost = m_report.echo_sent - m_report.echo_received;
+    m_report.echo_available = m_report.echo_received > 0 ? 1 : 0;
+    m_report.upload_kbps = throughput_kbps(m_bytes_sent, m_last_send_us - m_first_send_us);
+    m_report.download_kbps = throughput_kbps(m_bytes_received, m_last_recv_us - m_first_recv_us);
+
+    LOG_INFO("LinkTest: echo %u/%u (lost=%u, reordered=%u, dup=%u), up=%ukbps down=%ukbps",
+             m_report.echo_received, m_report.echo_sent, m_report.echo_lost,
+             m_report.echo_reordered, m_report.echo_duplicated,
+             m_report.upload_kbps, m_report.download_kbps);
+}
+
+// ============================================================================
+// LinkTest - Client Callbacks
+// ============================================================================
+
+void LinkTest::on_pong(uint8_t ping_id) {
+    if (m_report.state != LinkTestState::Pinging || ping_id < PING_ID_BASE) {
+        return;
+    }
+
+    uint32_t index = ping_id - PING_ID_BASE;
+    if (index >= m_report.pings_sent || m_ping_sent_us[index] == 0) {
+        return;  // Unknown or already answered
+    }
+
+    uint64_t rtt = now_us() - m_ping_sent_us[index];
+    m_ping_sent_us[index] = 0;
+    m_rtt_samples[m_report.pings_received++] =
+        rtt > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(rtt);
+}
+
+void LinkTest::on_packet(protocol::PacketId id, const uint8_t* data, size_t size) {
+    switch (id) {
+        case protocol::PacketId::Connected:
+        case protocol::PacketId::SyncNetwork: {
+            if (m_report.state != LinkTestState::CreatingNetwork ||
+                size < sizeof(protocol::NetworkInfo)) {
+                break;
+            }
+            protocol::NetworkInfo info;
+            std::memcpy(&info, data, sizeof(info));
+            // We created the network, so we are node 0
+            m_virtual_ip = info.ldn.nodes[0].ipv4_address;
+            m_network_created = true;
+            break;
+        }
+
+        case protocol::PacketId::ProxyData: {
+            if (m_report.state != LinkTestState::Echoing ||
+                size < sizeof(protocol::ProxyDataHeader) + sizeof(LinkTestProbeHeader)) {
+                break;
+            }
+
+            LinkTestProbeHeader probe;
+            std::memcpy(&probe, data + sizeof(protocol::ProxyDataHeader), sizeof(probe));
+            if (probe.magic != LINK_TEST_PROBE_MAGIC || probe.sequence >= m_report.echo_sent) {
+                break;
+            }
+
+            uint8_t mask = static_cast<uint8_t>(1u << (probe.sequence % 8));
+            uint8_t& slot = m_received_bitmap[probe.sequence / 8];
+            if (slot & mask) {
+                m_report.echo_duplicated++;
+                break;
+            }
+            slot |= mask;
+
+            uint64_t now = now_us();
+            if (m_report.echo_received == 0) {
+                m_first_recv_us = now;
+            } else if (probe.sequence < m_highest_sequence) {
+                m_report.echo_reordered++;
+            }
+            m_highest_sequence = std::max(m_highest_sequence, probe.sequence);
+            m_last_recv_us = now;
+            m_bytes_received += size - sizeof(protocol::ProxyDataHeader);
+            m_report.echo_received++;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void LinkTest::pong_callback(uint8_t ping_id, void* user_data) {
+    static_cast<LinkTest*>(user_data)->on_pong(ping_id);
+}
+
+void LinkTest::packet_callback(protocol::PacketId id, const uint8_t* data,
+                               size_t size, void* user_data) {
+    static_cast<LinkTest*>(user_data)->on_packet(id, data, size);
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
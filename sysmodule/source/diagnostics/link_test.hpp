@@ -0,0 +1,340 @@
+/**
+ * @file link_test.hpp
+ * @brief On-demand link quality test engine
+ *
+ * Measures whether the connection between this console and the RyuLdn
+ * master server is good enough for online play. The test is run on demand
+ * (from the overlay) on a dedicated server connection, never while a game
+ * is using LDN.
+ *
+ * ## Test Phases
+ *
+ * ```
+ * Connecting -> Pinging -> CreatingNetwork -> Echoing -> Probing -> Complete
+ * ```
+ *
+ * 1. **Connecting**: Open a private RyuLdnClient connection and handshake
+ * 2. **Pinging**: Burst of client pings (requester=1), RTT per reply
+ * 3. **CreatingNetwork**: Create a throw-away access point so the server
+ *    assigns us a virtual IP we can address ProxyData to
+ * 4. **Echoing**: Send sequenced ProxyData probes to our own virtual IP;
+ *    the server routes them back, giving upstream/downstream throughput,
+ *    loss, reordering and duplication counts
+ * 5. **Probing**: Ask the platform whether a port mapping can be created
+ *    and whether P2P hosting is possible
+ *
+ * If the server refuses the access point or never echoes the probes, the
+ * echo section of the report is marked unavailable and the test continues.
+ *
+ * ## Platform Independence
+ *
+ * The engine only depends on RyuLdnClient and a small set of platform
+ * callbacks (clock, port mapping/P2P probes), so it runs unchanged on the host
+ * against a local stand-in server (see tests/link_test_tests.cpp).
+ *
+ * ## Usage Example
+ *
+ * ```cpp
+ * LinkTest test;
+ * test.start(client_config, LinkTestConfig(), platform);
+ * while (test.update()) {
+ *     sleep_ms(1);
+ * }
+ * const LinkTestReport& report = test.get_report();
+ * ```
+ *
+ * ## Thread Safety
+ *
+ * Not thread-safe. The owner must serialize start()/update()/get_report().
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "../network/client.hpp"
+#include "../protocol/types.hpp"
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+/// Maximum number of pings in one burst (bounded by the 8-bit ping ID)
+constexpr uint32_t LINK_TEST_MAX_PINGS = 64;
+
+/// Maximum number of echo probes (bounded by the sequence bitmap)
+constexpr uint32_t LINK_TEST_MAX_ECHOES = 1024;
+
+/// Maximum echo probe payload (must fit the client receive buffer)
+constexpr uint32_t LINK_TEST_MAX_PAYLOAD = 1400;
+
+/// Magic at the start of every echo probe payload ("RLTP")
+constexpr uint32_t LINK_TEST_PROBE_MAGIC = 0x50544C52;
+
+/// Virtual UDP port used for echo probes (source and destination)
+constexpr uint16_t LINK_TEST_PROBE_PORT = 39999;
+
+/// Client receive timeout while testing (short, so update() keeps the window full)
+constexpr uint32_t LINK_TEST_RECV_TIMEOUT_MS = 1;
+
+/// Local communication ID used for the throw-away access point
+constexpr uint64_t LINK_TEST_LOCAL_COMM_ID = 0x0100000000DEC0DEULL;
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Current phase of a link test
+ */
+enum class LinkTestState : uint8_t {
+    Idle            = 0,  ///< Never started
+    Connecting      = 1,  ///< Connecting and handshaking with the server
+    Pinging         = 2,  ///< Ping burst in progress
+    CreatingNetwork = 3,  ///< Waiting for the throw-away access point
+    Echoing         = 4,  ///< ProxyData echo probes in flight
+    Probing         = 5,  ///< Port mapping / P2P probes
+    Complete        = 6,  ///< Report is final
+    Failed          = 7,  ///< Aborted, see LinkTestError
+};
+
+/**
+ * @brief Reason a link test failed
+ */
+enum class LinkTestError : uint8_t {
+    None             = 0,  ///< No error
+    ConnectFailed    = 1,  ///< TCP connection could not be established
+    HandshakeFailed  = 2,  ///< Server rejected or never answered the handshake
+    ConnectionLost   = 3,  ///< Connection dropped during the test
+    Busy             = 4,  ///< A game is using LDN, test refused
+};
+
+/**
+ * @brief Link test parameters
+ */
+struct LinkTestConfig {
+    uint32_t ping_count;          ///< Pings in the burst (max LINK_TEST_MAX_PINGS)
+    uint32_t ping_interval_ms;    ///< Delay between pings
+    uint32_t ping_timeout_ms;     ///< Wait for outstanding replies after the last ping
+    uint32_t echo_count;          ///< Echo probes to send (max LINK_TEST_MAX_ECHOES)
+    uint32_t echo_payload_size;   ///< Probe payload size (max LINK_TEST_MAX_PAYLOAD)
+    uint32_t echo_window;         ///< Maximum probes in flight
+    uint32_t echo_timeout_ms;     ///< Give up when no echo arrives for this long
+    uint32_t phase_timeout_ms;    ///< Timeout for connect / network creation
+
+    /**
+     * @brief Default constructor with sensible defaults
+     */
+    LinkTestConfig();
+};
+
+/**
+ * @brief Platform hooks used by the engine
+ *
+ * now_us is mandatory. The probes may be nullptr, in which case the
+ * corresponding report field stays 0.
+ */
+struct LinkTestPlatform {
+    uint64_t (*now_us)(void* user_data);      ///< Monotonic clock in microseconds
+    bool (*probe_upnp)(void* user_data);      ///< Can a port mapping be created?
+    bool (*probe_p2p)(bool upnp_ok, void* user_data); ///< Can this console host P2P?
+    void* user_data;                          ///< Passed back to every hook
+};
+
+/**
+ * @brief Summary statistics of a set of RTT samples
+ */
+struct RttStats {
+    uint32_t min_us;     ///< Smallest sample
+    uint32_t avg_us;     ///< Arithmetic mean
+    uint32_t p50_us;     ///< Median (nearest rank)
+    uint32_t p95_us;     ///< 95th percentile (nearest rank)
+    uint32_t p99_us;     ///< 99th percentile (nearest rank)
+    uint32_t max_us;     ///< Largest sample
+    uint32_t jitter_us;  ///< Mean absolute difference of consecutive samples
+};
+
+/**
+ * @brief Link test result
+ *
+ * Plain data so it can be copied straight into the IPC reply.
+ */
+struct LinkTestReport {
+    LinkTestState state;        ///< Current phase
+    LinkTestError error;        ///< Failure reason (Failed only)
+    uint8_t  echo_available;    ///< 1 if the server echoed at least one probe
+    uint8_t  upnp_available;    ///< 1 if a port mapping (UPnP or NAT-PMP/PCP) could be created
+    uint8_t  p2p_possible;      ///< 1 if P2P hosting looks possible
+    uint8_t  reserved[3];       ///< Padding
+
+    uint32_t pings_sent;        ///< Pings sent
+    uint32_t pings_received;    ///< Ping replies received
+    RttStats rtt;               ///< RTT distribution of the replies
+
+    uint32_t echo_sent;         ///< Probes sent
+    uint32_t echo_received;     ///< Distinct probes echoed back
+    uint32_t echo_lost;         ///< Probes never echoed
+    uint32_t echo_reordered;    ///< Probes arriving after a higher sequence
+    uint32_t echo_duplicated;   ///< Probes echoed more than once
+    uint32_t upload_kbps;       ///< Upstream throughput (kbit/s)
+    uint32_t download_kbps;     ///< Downstream throughput (kbit/s)
+
+    uint32_t duration_ms;       ///< Total test duration
+};
+
+/**
+ * @brief Header at the start of every echo probe payload
+ */
+struct __attribute__((packed)) LinkTestProbeHeader {
+    uint32_t magic;         ///< LINK_TEST_PROBE_MAGIC
+    uint32_t sequence;      ///< Probe sequence number (0-based)
+    uint64_t send_time_us;  ///< Sender clock at send time
+};
+static_assert(sizeof(LinkTestProbeHeader) == 16, "LinkTestProbeHeader must be 16 bytes");
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+/**
+ * @brief Compute RTT statistics
+ *
+ * @param samples RTT samples in microseconds, in arrival order (not modified)
+ * @param count Number of samples (at most LINK_TEST_MAX_PINGS)
+ * @param out Output statistics (all zero when count is 0)
+ */
+void compute_rtt_stats(const uint32_t* samples, size_t count, RttStats& out);
+
+/**
+ * @brief Convert bytes over a duration to kbit/s
+ *
+ * @param bytes Number of bytes transferred
+ * @param duration_us Duration in microseconds (0 yields 0)
+ * @return Throughput in kbit/s, saturated to UINT32_MAX
+ */
+uint32_t throughput_kbps(uint64_t bytes, uint64_t duration_us);
+
+/**
+ * @brief Convert a LinkTestState to string for logging
+ */
+const char* link_test_state_to_string(LinkTestState state);
+
+// ============================================================================
+// LinkTest
+// ============================================================================
+
+/**
+ * @brief Link quality test engine
+ *
+ * Owns a private RyuLdnClient and drives it through the test phases.
+ * update() never blocks longer than the client's receive timeout.
+ */
+class LinkTest {
+public:
+    LinkTest();
+    ~LinkTest();
+
+    LinkTest(const LinkTest&) = delete;
+    LinkTest& operator=(const LinkTest&) = delete;
+
+    /**
+     * @brief Start a new test
+     *
+     * Any running test is aborted first. The TCP connection is attempted
+     * synchronously; the remaining phases advance in update().
+     *
+     * @param client_config Server address and client settings
+     * @param config Test parameters (clamped to the engine limits)
+     * @param platform Platform hooks (now_us is required)
+     * @return true if the test started, false if the connection failed
+     */
+    bool start(const network::RyuLdnClientConfig& client_config,
+               const LinkTestConfig& config,
+               const LinkTestPlatform& platform);
+
+    /**
+     * @brief Advance the test
+     *
+     * @return true while the test is still running
+     */
+    bool update();
+
+    /**
+     * @brief Abort a running test and close its connection
+     */
+    void abort();
+
+    /**
+     * @brief Check if a test is running
+     */
+    bool is_running() const;
+
+    /**
+     * @brief Get the (possibly partial) report
+     */
+    const LinkTestReport& get_report() const { return m_report; }
+
+private:
+    // ========================================================================
+    // Internal State
+    // ========================================================================
+
+    network::RyuLdnClient m_client;   ///< Dedicated server connection
+    LinkTestConfig m_config;          ///< Active parameters
+    LinkTestPlatform m_platform;      ///< Platform hooks
+    LinkTestReport m_report;          ///< Report being filled
+
+    uint64_t m_start_us;              ///< Test start time
+    uint64_t m_phase_start_us;        ///< Current phase start time
+
+    uint64_t m_ping_sent_us[LINK_TEST_MAX_PINGS];  ///< Send time per ping ID
+    uint32_t m_rtt_samples[LINK_TEST_MAX_PINGS];   ///< RTT samples in arrival order
+    uint64_t m_last_ping_us;          ///< Time of the last ping sent
+
+    uint32_t m_virtual_ip;            ///< Our virtual IP (0 until Connected)
+    bool m_network_created;           ///< Connected packet received
+    uint8_t m_received_bitmap[LINK_TEST_MAX_ECHOES / 8]; ///< Echoed sequences
+    uint32_t m_highest_sequence;      ///< Highest sequence echoed so far
+    uint64_t m_bytes_sent;            ///< Probe payload bytes sent
+    uint64_t m_bytes_received;        ///< Probe payload bytes echoed back
+    uint64_t m_first_send_us;         ///< First probe send time
+    uint64_t m_last_send_us;          ///< Last probe send time
+    uint64_t m_first_recv_us;         ///< First echo arrival
+    uint64_t m_last_recv_us;          ///< Last echo arrival
+    uint8_t m_probe_buffer[LINK_TEST_MAX_PAYLOAD]; ///< Probe payload scratch
+
+    // ========================================================================
+    // Internal Methods
+    // ========================================================================
+
+    uint64_t now_us() const;
+    void enter(LinkTestState state, uint64_t now);
+    void fail(LinkTestError error);
+    void finish(uint64_t now);
+
+    void update_connecting(uint64_t now);
+    void update_pinging(uint64_t now);
+    void update_creating_network(uint64_t now);
+    void update_echoing(uint64_t now);
+    void update_probing(uint64_t now);
+
+    bool send_create_network();
+    void finalize_echo_stats();
+
+    void on_pong(uint8_t ping_id);
+    void on_packet(protocol::PacketId id, const uint8_t* data, size_t size);
+
+    static void pong_callback(uint8_t ping_id, void* user_data);
+    static void packet_callback(protocol::PacketId id, const uint8_t* data,
+                                size_t size, void* user_data);
+};
+
+} // namespace diagnostics
+} // namespace ryu_ldn
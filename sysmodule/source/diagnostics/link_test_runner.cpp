@@ -0,0 +1,168 @@
+/**
+ * @file link_test_runner.cpp
+ * @brief Console-side driver for the on-demand link quality test
+ *
+ * The worker thread sleeps on an event until Start() is called, then runs
+ * one LinkTest to completion, publishing a copy of the report after every
+ * step so the overlay can show progress.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "link_test_runner.hpp"
+#include "../config/config_ipc_service.hpp"
+#include "../ldn/ldn_shared_state.hpp"
+#include "../p2p/port_mapping_service.hpp"
+#include "../debug/log.hpp"
+#include "thread_stats.hpp"
+#include <cstring>
+
+namespace ams::mitm::diagnostics {
+
+namespace {
+
+/// Worker thread priority (same as the log maintenance thread)
+constexpr s32 ThreadPriority = 15;
+
+/// Worker stack; port mapping discovery parses UPnP XML on this thread
+constexpr size_t ThreadStackSize = 0x4000;
+
+alignas(os::MemoryPageSize) u8 g_thread_stack[ThreadStackSize];
+os::ThreadType g_thread;
+
+/// Engine instance; holds the client buffers, too large for the stack
+ryu_ldn::diagnostics::LinkTest g_link_test;
+
+/// Delay between engine steps while a test runs
+constexpr s64 StepSleepNs = 1000000;  // 1ms
+
+uint64_t PlatformNowUs(void*) {
+    return armTicksToNs(armGetSystemTick()) / 1000ULL;
+}
+
+/**
+ * @brief Check that the router accepts a mapping on the first P2P port
+ *
+ * The mapping is removed again immediately; it only proves that hosting
+ * would be able to open its port.
+ */
+bool PlatformProbePortMapping(void*) {
+    auto& mapper = p2p::PortMappingService::GetInstance();
+    if (!mapper.Discover()) {
+        return false;
+    }
+
+    uint16_t mapped_port = mapper.AddPortMapping(p2p::P2P_PORT_BASE, p2p::P2P_PORT_BASE);
+    if (mapped_port == 0) {
+        return false;
+    }
+    mapper.DeletePortMapping(p2p::P2P_PORT_BASE, mapped_port);
+    return true;
+}
+
+/**
+ * @brief P2P hosting needs a port mapping and must not be disabled by the user
+ */
+bool PlatformProbeP2p(bool upnp_ok, void*) {
+    std::scoped_lock lock(ryu_ldn::ipc::g_config_mutex);
+    return upnp_ok && !ryu_ldn::ipc::g_config.ldn.disable_p2p;
+}
+
+} // namespace
+
+LinkTestRunner& LinkTestRunner::GetInstance() {
+    static LinkTestRunner instance;
+    return instance;
+}
+
+LinkTestRunner::LinkTestRunner()
+    : m_mutex()
+    , m_start_event(os::EventClearMode_AutoClear)
+    , m_pending(false)
+    , m_report()
+{
+}
+
+void LinkTestRunner::Initialize() {
+    R_ABORT_UNLESS(os::CreateThread(&g_thread, ThreadFunc, this,
+                                    g_thread_stack, ThreadStackSize, ThreadPriority));
+    os::SetThreadNamePointer(&g_thread, "ryu_ldn::LinkTestThread");
+    os::StartThread(&g_thread);
+}
+
+bool LinkTestRunner::Start() {
+    std::scoped_lock lock(m_mutex);
+
+    // m_pending stays set until the worker has finished the test
+    if (m_pending) {
+        return false;
+    }
+
+    if (ldn::SharedState::GetInstance().IsGameActive()) {
+        std::memset(&m_report, 0, sizeof(m_report));
+        m_report.state = ryu_ldn::diagnostics::LinkTestState::Failed;
+        m_report.error = ryu_ldn::diagnostics::LinkTestError::Busy;
+        LOG_WARN("LinkTest: refused, a game is using LDN");
+        return false;
+    }
+
+    // Show Connecting right away so the overlay does not see the old report
+    std::memset(&m_report, 0, sizeof(m_report));
+    m_report.state = ryu_ldn::diagnostics::LinkTestState::Connecting;
+    m_pending = true;
+    m_start_event.Signal();
+    return true;
+}
+
+void LinkTestRunner::GetReport(ryu_ldn::diagnostics::LinkTestReport& out) const {
+    std::scoped_lock lock(m_mutex);
+    out = m_report;
+}
+
+void LinkTestRunner::PublishReport(const ryu_ldn::diagnostics::LinkTestReport& report) {
+    std::scoped_lock lock(m_mutex);
+    m_report = report;
+}
+
+void LinkTestRunner::ThreadFunc(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::LinkTest);
+    static_cast<LinkTestRunner*>(arg)->Run();
+}
+
+void LinkTestRunner::Run() {
+    while (true) {
+        m_start_event.Wait();
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
+        RunOnce();
+
+        std::scoped_lock lock(m_mutex);
+        m_pending = false;
+    }
+}
+
+void LinkTestRunner::RunOnce() {
+    ryu_ldn::network::RyuLdnClientConfig client_config;
+    {
+        std::scoped_lock lock(ryu_ldn::ipc::g_config_mutex);
+        client_config = ryu_ldn::network::RyuLdnClientConfig(ryu_ldn::ipc::g_config);
+    }
+
+    ryu_ldn::diagnostics::LinkTestPlatform platform{};
+    platform.now_us = PlatformNowUs;
+    platform.probe_upnp = PlatformProbePortMapping;
+    platform.probe_p2p = PlatformProbeP2p;
+    platform.user_data = nullptr;
+
+    g_link_test.start(client_config, ryu_ldn::diagnostics::LinkTestConfig(), platform);
+    PublishReport(g_link_test.get_report());
+
+    while (g_link_test.update()) {
+        PublishReport(g_link_test.get_report());
+        svc::SleepThread(StepSleepNs);
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
+    }
+    PublishReport(g_link_test.get_report());
+}
+
+} // namespace ams::mitm::diagnostics
@@ -0,0 +1,75 @@
+/**
+ * @file link_test_runner.hpp
+ * @brief Console-side driver for the on-demand link quality test
+ *
+ * Owns the LinkTest engine and a dedicated worker thread. The ryu:cfg
+ * service calls Start() when the overlay asks for a test and polls
+ * GetReport() to display progress and results.
+ *
+ * The test opens its own server connection, so it is refused while a game
+ * is using LDN.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <stratosphere.hpp>
+#include "link_test.hpp"
+
+namespace ams::mitm::diagnostics {
+
+/**
+ * @brief Singleton running LinkTest on a worker thread
+ *
+ * Thread-safe: Start() and GetReport() may be called from IPC threads
+ * while the worker is running a test.
+ */
+class LinkTestRunner {
+public:
+    /**
+     * @brief Get the singleton instance
+     */
+    static LinkTestRunner& GetInstance();
+
+    LinkTestRunner(const LinkTestRunner&) = delete;
+    LinkTestRunner& operator=(const LinkTestRunner&) = delete;
+
+    /**
+     * @brief Create and start the worker thread
+     *
+     * Must be called once at startup, before the ryu:cfg service is up.
+     */
+    void Initialize();
+
+    /**
+     * @brief Request a new link test
+     *
+     * @return true if the test was queued, false if one is already running
+     *         or a game is using LDN (report error set to Busy)
+     */
+    bool Start();
+
+    /**
+     * @brief Copy the latest report
+     *
+     * Safe to call at any time; reflects progress while a test runs.
+     */
+    void GetReport(ryu_ldn::diagnostics::LinkTestReport& out) const;
+
+private:
+    LinkTestRunner();
+
+    static void ThreadFunc(void* arg);
+    void Run();
+    void RunOnce();
+    void PublishReport(const ryu_ldn::diagnostics::LinkTestReport& report);
+
+    mutable os::SdkMutex m_mutex;
+    os::Event m_start_event;
+    bool m_pending;
+    ryu_ldn::diagnostics::LinkTestReport m_report;
+};
+
+} // namespace ams::mitm::diagnostics
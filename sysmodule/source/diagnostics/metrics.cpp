@@ -0,0 +1,133 @@
+/**
+ * @file metrics.cpp
+ * @brief Prometheus text rendering of the metrics registry
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "metrics.hpp"
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+namespace {
+
+/**
+ * @brief Appends formatted lines, dropping any line that does not fit
+ */
+class TextWriter {
+public:
+    TextWriter(char* buffer, size_t size) : m_buffer(buffer), m_size(size) {}
+
+    void Line(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        if (m_full) {
+            return;
+        }
+        va_list args;
+        va_start(args, fmt);
+        int written = std::vsnprintf(m_buffer + m_offset, m_size - m_offset, fmt, args);
+        va_end(args);
+
+        // Keep room for the newline and the terminator
+        if (written < 0 || m_offset + static_cast<size_t>(written) + 2 > m_size) {
+            m_buffer[m_offset] = '\0';
+            m_full = true;
+            return;
+        }
+        m_offset += static_cast<size_t>(written);
+        m_buffer[m_offset++] = '\n';
+        m_buffer[m_offset] = '\0';
+    }
+
+    size_t Size() const { return m_offset; }
+
+private:
+    char* m_buffer;
+    size_t m_size;
+    size_t m_offset = 0;
+    bool m_full = false;
+};
+
+void WriteCounter(TextWriter& out, const char* name, const char* help, const Counter& counter) {
+    out.Line("# HELP ryu_ldn_%s_total %s", name, help);
+    out.Line("# TYPE ryu_ldn_%s_total counter", name);
+    out.Line("ryu_ldn_%s_total %" PRIu64, name, counter.Load());
+}
+
+void WriteGauge(TextWriter& out, const char* name, const char* help, const Gauge& gauge) {
+    out.Line("# HELP ryu_ldn_%s %s", name, help);
+    out.Line("# TYPE ryu_ldn_%s gauge", name);
+    out.Line("ryu_ldn_%s %" PRId64, name, gauge.Load());
+}
+
+void WriteHistogram(TextWriter& out, const char* name, const char* help, const Histogram& histogram) {
+    out.Line("# HELP ryu_ldn_%s %s", name, help);
+    out.Line("# TYPE ryu_ldn_%s histogram", name);
+
+    // Buckets are read once; _count is their total so the output is self-consistent
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        cumulative += histogram.BucketCount(i);
+        out.Line("ryu_ldn_%s_bucket{le=\"%" PRIu64 "\"} %" PRIu64, name, histogram.Bound(i), cumulative);
+    }
+    cumulative += histogram.BucketCount(HISTOGRAM_BUCKETS);
+    out.Line("ryu_ldn_%s_bucket{le=\"+Inf\"} %" PRIu64, name, cumulative);
+    out.Line("ryu_ldn_%s_sum %" PRIu64, name, histogram.Sum());
+    out.Line("ryu_ldn_%s_count %" PRIu64, name, cumulative);
+}
+
+} // anonymous namespace
+
+size_t render_prometheus(const Metrics& metrics, char* buffer, size_t buffer_size) {
+    if (buffer == nullptr || buffer_size == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+
+    TextWriter out(buffer, buffer_size);
+
+    WriteCounter(out, "proxy_rx_packets", "ProxyData packets routed to game sockets", metrics.proxy_rx_packets);
+    WriteCounter(out, "proxy_rx_bytes", "ProxyData payload bytes routed to game sockets", metrics.proxy_rx_bytes);
+    WriteCounter(out, "proxy_rx_unrouted", "ProxyData packets with no socket bound on the destination port",
+                 metrics.proxy_rx_unrouted);
+    WriteCounter(out, "proxy_rx_dropped", "Packets dropped on receive queue overflow", metrics.proxy_rx_dropped);
+    WriteCounter(out, "proxy_tx_packets", "ProxyData packets sent by game sockets", metrics.proxy_tx_packets);
+    WriteCounter(out, "proxy_tx_bytes", "ProxyData payload bytes sent by game sockets", metrics.proxy_tx_bytes);
+    WriteCounter(out, "proxy_tx_failed", "ProxyData sends that found no server connection", metrics.proxy_tx_failed);
+    WriteCounter(out, "proxy_tx_p2p", "ProxyData packets sent over the P2P link", metrics.proxy_tx_p2p);
+    WriteCounter(out, "proxy_tx_duplicated", "ProxyData packets sent on both P2P and relay",
+                 metrics.proxy_tx_duplicated);
+    WriteCounter(out, "proxy_tx_suppressed", "Repeated broadcast datagrams not sent upstream",
+                 metrics.proxy_tx_suppressed);
+    WriteCounter(out, "proxy_tx_suppressed_bytes", "Payload bytes of suppressed broadcast datagrams",
+                 metrics.proxy_tx_suppressed_bytes);
+    WriteGauge(out, "proxy_sockets", "Open proxy sockets", metrics.proxy_sockets);
+    WriteGauge(out, "proxy_queued_bytes", "Bytes waiting in proxy socket receive queues", metrics.proxy_queued_bytes);
+    WriteCounter(out, "proxy_rx_wakeups", "Receive events signaled to waiting game readers",
+                 metrics.proxy_rx_wakeups);
+    WriteCounter(out, "proxy_rx_coalesced", "Datagrams queued inside a receive moderation window",
+                 metrics.proxy_rx_coalesced);
+    WriteHistogram(out, "proxy_rx_moderation_us",
+                   "Delivery delay added by receive moderation to a waiting reader in microseconds",
+                   metrics.proxy_rx_moderation_us);
+    WriteCounter(out, "p2p_fanout_delegated", "Broadcast copies left to the fan-out delegate by the P2P host",
+                 metrics.p2p_fanout_delegated);
+    WriteCounter(out, "p2p_fanout_relayed", "Broadcast copies re-sent as fan-out delegate",
+                 metrics.p2p_fanout_relayed);
+    WriteCounter(out, "server_link_reconnects", "Server reconnects fired by the network link coming back",
+                 metrics.server_link_reconnects);
+    WriteHistogram(out, "server_rtt_ms", "Master server keepalive round-trip time in milliseconds",
+                   metrics.server_rtt_ms);
+    WriteHistogram(out, "ipc_latency_us", "ldn:u command handling time in microseconds", metrics.ipc_latency_us);
+    WriteGauge(out, "memory_used_bytes", "Memory used by the sysmodule process", metrics.memory_used_bytes);
+
+    return out.Size();
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
@@ -0,0 +1,234 @@
+/**
+ * @file metrics.hpp
+ * @brief Process-wide counters, gauges and histograms
+ *
+ * Hot paths (proxy data, IPC commands, server pings) update the metrics with
+ * relaxed atomics: no lock, no allocation, a few nanoseconds per update.
+ * Readers (the metrics HTTP endpoint) take a snapshot with atomic loads, so
+ * rendering never blocks the data path. A snapshot is not a consistent cut
+ * across metrics, which is fine for monitoring.
+ *
+ * ## Available Metrics
+ *
+ * | Name                                | Type      | Updated by                  |
+ * |-------------------------------------|-----------|-----------------------------|
+ * | proxy_rx_packets / proxy_rx_bytes   | counter   | ProxySocketManager routing  |
+ * | proxy_rx_unrouted                   | counter   | No socket bound on the port |
+ * | proxy_rx_dropped                    | counter   | Receive queue overflow      |
+ * | proxy_tx_packets / proxy_tx_bytes   | counter   | ProxySocket sends           |
+ * | proxy_tx_failed                     | counter   | No server connection        |
+ * | proxy_tx_p2p / proxy_tx_duplicated  | counter   | ICommunicationService       |
+ * | proxy_tx_suppressed(_bytes)         | counter   | Broadcast repeat filter     |
+ * | proxy_sockets                       | gauge     | ProxySocketManager          |
+ * | proxy_queued_bytes                  | gauge     | Proxy socket receive queues |
+ * | proxy_rx_wakeups                    | counter   | Receive events signaled     |
+ * | proxy_rx_coalesced                  | counter   | Receive-event moderation    |
+ * | proxy_rx_moderation_us              | histogram | Receive-event moderation    |
+ * | p2p_fanout_delegated                | counter   | P2pProxyServer (host)       |
+ * | p2p_fanout_relayed                  | counter   | Fan-out delegate (guest)    |
+ * | server_link_reconnects              | counter   | RyuLdnClient link return    |
+ * | server_rtt_ms                       | histogram | RyuLdnClient keepalive      |
+ * | ipc_latency_us                      | histogram | ldn:u command handlers      |
+ * | memory_used_bytes                   | gauge     | Sampled when scraped        |
+ *
+ * ## Usage Example
+ *
+ * ```cpp
+ * g_metrics.proxy_rx_packets.Add();
+ * g_metrics.proxy_rx_bytes.Add(len);
+ *
+ * {
+ *     ScopedLatency timer(g_metrics.ipc_latency_us);
+ *     // ... handle the command ...
+ * }
+ * ```
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "../platform/platform.hpp"
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+// ============================================================================
+// Metric Types
+// ============================================================================
+
+/**
+ * @brief Monotonic counter
+ */
+class Counter {
+public:
+    void Add(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Load() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/**
+ * @brief Value that goes up and down
+ */
+class Gauge {
+public:
+    void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void Add(int64_t delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t Load() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+/// Finite buckets per histogram (an overflow bucket is added on top)
+constexpr size_t HISTOGRAM_BUCKETS = 12;
+
+/**
+ * @brief Distribution over power-of-two buckets
+ *
+ * Bucket i counts values <= first_bound << i; the last bucket counts the
+ * rest. With HISTOGRAM_BUCKETS = 12 the finite range is first_bound to
+ * 2048 * first_bound.
+ */
+class Histogram {
+public:
+    explicit constexpr Histogram(uint64_t first_bound) : m_first_bound(first_bound) {}
+
+    void Observe(uint64_t value) {
+        size_t bucket = 0;
+        uint64_t bound = m_first_bound;
+        while (bucket < HISTOGRAM_BUCKETS && value > bound) {
+            bound <<= 1;
+            bucket++;
+        }
+        m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Upper bound of finite bucket i
+     */
+    uint64_t Bound(size_t bucket) const { return m_first_bound << bucket; }
+
+    /**
+     * @brief Count of bucket i (HISTOGRAM_BUCKETS = overflow), not cumulative
+     */
+    uint64_t BucketCount(size_t bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+    uint64_t Sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Upper bound of the bucket holding the given percentile
+     *
+     * @param percent Percentile (1-100)
+     * @return Bucket bound, UINT64_MAX if it falls in the overflow bucket,
+     *         0 if nothing was observed
+     */
+    uint64_t QuantileBound(uint32_t percent) const {
+        uint64_t total = 0;
+        for (size_t i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+            total += BucketCount(i);
+        }
+        if (total == 0) {
+            return 0;
+        }
+
+        uint64_t rank = (total * percent + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            seen += BucketCount(i);
+            if (seen >= rank) {
+                return Bound(i);
+            }
+        }
+        return UINT64_MAX;
+    }
+
+private:
+    uint64_t m_first_bound;
+    std::atomic<uint64_t> m_buckets[HISTOGRAM_BUCKETS + 1]{};
+    std::atomic<uint64_t> m_sum{0};
+};
+
+/**
+ * @brief Observes the lifetime of a scope in microseconds
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Histogram& histogram)
+        : m_histogram(histogram), m_start_ns(platform::GetTickNs()) {}
+    ~ScopedLatency() { m_histogram.Observe((platform::GetTickNs() - m_start_ns) / 1000); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    Histogram& m_histogram;
+    uint64_t m_start_ns;
+};
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+/**
+ * @brief Every metric exported by the sysmodule
+ */
+struct Metrics {
+    // Proxy data path (BSD MITM <-> server/P2P)
+    Counter proxy_rx_packets;
+    Counter proxy_rx_bytes;
+    Counter proxy_rx_unrouted;
+    Counter proxy_rx_dropped;
+    Counter proxy_tx_packets;
+    Counter proxy_tx_bytes;
+    Counter proxy_tx_failed;
+    Counter proxy_tx_p2p;
+    Counter proxy_tx_duplicated;
+    Counter proxy_tx_suppressed;
+    Counter proxy_tx_suppressed_bytes;
+    Gauge proxy_sockets;
+    Gauge proxy_queued_bytes;
+    Counter proxy_rx_wakeups;
+    Counter proxy_rx_coalesced;
+    Histogram proxy_rx_moderation_us{8};  ///< 8 us .. 16 ms
+
+    // P2P broadcast fan-out delegation
+    Counter p2p_fanout_delegated;
+    Counter p2p_fanout_relayed;
+
+    // Server connection
+    Counter server_link_reconnects;
+    Histogram server_rtt_ms{1};      ///< 1 ms .. 2 s
+
+    // IPC
+    Histogram ipc_latency_us{16};    ///< 16 us .. 32 ms
+
+    // Process
+    Gauge memory_used_bytes;
+};
+
+/**
+ * @brief Process-wide metrics
+ */
+inline Metrics g_metrics;
+
+/**
+ * @brief Render metrics in the Prometheus text exposition format (0.0.4)
+ *
+ * @param metrics Metrics to render (read with atomic loads only)
+ * @param buffer Output buffer
+ * @param buffer_size Buffer size
+ * @return Bytes written (output is truncated at a line boundary if too small)
+ */
+size_t render_prometheus(const Metrics& metrics, char* buffer, size_t buffer_size);
+
+} // namespace diagnostics
+} // namespace ryu_ldn
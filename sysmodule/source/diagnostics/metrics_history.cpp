@@ -0,0 +1,339 @@
+/**
+ * @file metrics_history.cpp
+ * @brief Metric sampling, second/minute rollups and serialization
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "metrics_history.hpp"
+
+#include <cstring>
+#include <mutex>
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+MetricsHistory g_metrics_history;
+
+namespace {
+
+uint32_t Clamp32(uint64_t value) {
+    return value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+}
+
+/**
+ * @brief Nearest-rank p99 of a small array (sorted in place)
+ */
+uint32_t P99(uint32_t* values, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    // Insertion sort: at most 60 values
+    for (size_t i = 1; i < count; i++) {
+        uint32_t value = values[i];
+        size_t j = i;
+        while (j > 0 && values[j - 1] > value) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = value;
+    }
+    size_t rank = (count * 99 + 99) / 100;
+    return values[rank - 1];
+}
+
+uint64_t HistogramCount(const Histogram& histogram) {
+    uint64_t total = 0;
+    for (size_t i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+        total += histogram.BucketCount(i);
+    }
+    return total;
+}
+
+} // anonymous namespace
+
+const char* history_series_to_string(HistorySeries series) {
+    switch (series) {
+        case HistorySeries::RttMs:       return "RttMs";
+        case HistorySeries::RxBytes:     return "RxBytes";
+        case HistorySeries::TxBytes:     return "TxBytes";
+        case HistorySeries::Packets:     return "Packets";
+        case HistorySeries::QueuedBytes: return "QueuedBytes";
+        case HistorySeries::Drops:       return "Drops";
+        default:                         return "Invalid";
+    }
+}
+
+MetricsHistory::MetricsHistory()
+    : m_mutex()
+{
+    reset_locked();
+}
+
+// =============================================================================
+// Sampling
+// =============================================================================
+
+void MetricsHistory::sample(const Metrics& metrics, uint64_t now_ms) {
+    const uint64_t rtt_count = HistogramCount(metrics.server_rtt_ms);
+    const uint64_t rtt_sum = metrics.server_rtt_ms.Sum();
+    const uint64_t rx_bytes = metrics.proxy_rx_bytes.Load();
+    const uint64_t tx_bytes = metrics.proxy_tx_bytes.Load();
+    const uint64_t packets = metrics.proxy_rx_packets.Load() + metrics.proxy_tx_packets.Load();
+    const uint64_t drops = metrics.proxy_rx_dropped.Load() + metrics.proxy_tx_failed.Load();
+    const int64_t queued = metrics.proxy_queued_bytes.Load();
+
+    std::scoped_lock lock(m_mutex);
+
+    if (m_has_baseline && now_ms > m_last_sample_ms) {
+        const uint64_t elapsed_ms = now_ms - m_last_sample_ms;
+        auto rate = [elapsed_ms](uint64_t current, uint64_t last) {
+            return current >= last ? (current - last) * 1000ULL / elapsed_ms : 0;
+        };
+
+        if (rtt_count > m_last_rtt_count) {
+            record_locked(HistorySeries::RttMs,
+                          (rtt_sum - m_last_rtt_sum) / (rtt_count - m_last_rtt_count), now_ms);
+        }
+        record_locked(HistorySeries::RxBytes, rate(rx_bytes, m_last_rx_bytes), now_ms);
+        record_locked(HistorySeries::TxBytes, rate(tx_bytes, m_last_tx_bytes), now_ms);
+        record_locked(HistorySeries::Packets, rate(packets, m_last_packets), now_ms);
+        record_locked(HistorySeries::QueuedBytes, queued > 0 ? static_cast<uint64_t>(queued) : 0, now_ms);
+        record_locked(HistorySeries::Drops, rate(drops, m_last_drops), now_ms);
+    } else if (!m_has_baseline) {
+        advance_locked(now_ms / 1000);
+    }
+
+    m_has_baseline = true;
+    m_last_sample_ms = now_ms;
+    m_last_rtt_count = rtt_count;
+    m_last_rtt_sum = rtt_sum;
+    m_last_rx_bytes = rx_bytes;
+    m_last_tx_bytes = tx_bytes;
+    m_last_packets = packets;
+    m_last_drops = drops;
+}
+
+void MetricsHistory::record(HistorySeries series, uint64_t value, uint64_t now_ms) {
+    std::scoped_lock lock(m_mutex);
+    record_locked(series, value, now_ms);
+}
+
+void MetricsHistory::advance(uint64_t now_ms) {
+    std::scoped_lock lock(m_mutex);
+    advance_locked(now_ms / 1000);
+}
+
+void MetricsHistory::clear() {
+    std::scoped_lock lock(m_mutex);
+    reset_locked();
+}
+
+void MetricsHistory::record_locked(HistorySeries series, uint64_t value, uint64_t now_ms) {
+    if (series >= HistorySeries::Count) {
+        return;
+    }
+    advance_locked(now_ms / 1000);
+
+    SecondAccumulator& acc = m_second[static_cast<size_t>(series)];
+    const uint32_t v = Clamp32(value);
+    if (acc.count == 0 || v < acc.min) {
+        acc.min = v;
+    }
+    if (acc.count == 0 || v > acc.max) {
+        acc.max = v;
+    }
+    if (acc.count < HISTORY_SAMPLES_PER_SECOND) {
+        acc.kept[acc.count] = v;
+    }
+    acc.sum += v;
+    acc.count++;
+}
+
+// =============================================================================
+// Rollups
+// =============================================================================
+
+void MetricsHistory::advance_locked(uint64_t second) {
+    if (!m_started) {
+        m_started = true;
+        m_current_second = second;
+        return;
+    }
+    if (second <= m_current_second) {
+        return;
+    }
+
+    // Gap longer than the minute ring: every stored point would roll out
+    if (second - m_current_second > HISTORY_MINUTE_POINTS * 60) {
+        reset_locked();
+        m_started = true;
+        m_current_second = second;
+        return;
+    }
+
+    while (m_current_second < second) {
+        close_second();
+        m_current_second++;
+    }
+}
+
+void MetricsHistory::close_second() {
+    HistoryPoint points[SERIES];
+    for (size_t s = 0; s < SERIES; s++) {
+        SecondAccumulator& acc = m_second[s];
+        HistoryPoint& point = points[s];
+        point = {};
+        if (acc.count > 0) {
+            const size_t kept = acc.count < HISTORY_SAMPLES_PER_SECOND ? acc.count : HISTORY_SAMPLES_PER_SECOND;
+            point.min = acc.min;
+            point.max = acc.max;
+            point.avg = static_cast<uint32_t>(acc.sum / acc.count);
+            point.p99 = P99(acc.kept, kept);
+            point.samples = acc.count;
+
+            MinuteAccumulator& minute = m_minute[s];
+            if (minute.samples == 0 || point.min < minute.min) {
+                minute.min = point.min;
+            }
+            if (minute.samples == 0 || point.max > minute.max) {
+                minute.max = point.max;
+            }
+            minute.weighted_sum += static_cast<uint64_t>(point.avg) * point.samples;
+            minute.samples += point.samples;
+            if (minute.p99_count < 60) {
+                minute.p99s[minute.p99_count++] = point.p99;
+            }
+        }
+        acc = {};
+    }
+    push(m_seconds, points);
+
+    // Last second of an uptime minute
+    if ((m_current_second + 1) % 60 == 0) {
+        close_minute();
+    }
+}
+
+void MetricsHistory::close_minute() {
+    HistoryPoint points[SERIES];
+    for (size_t s = 0; s < SERIES; s++) {
+        MinuteAccumulator& minute = m_minute[s];
+        HistoryPoint& point = points[s];
+        point = {};
+        if (minute.samples > 0) {
+            point.min = minute.min;
+            point.max = minute.max;
+            point.avg = static_cast<uint32_t>(minute.weighted_sum / minute.samples);
+            point.p99 = P99(minute.p99s, minute.p99_count);
+            point.samples = minute.samples;
+        }
+        minute = {};
+    }
+    push(m_minutes, points);
+}
+
+void MetricsHistory::reset_locked() {
+    m_started = false;
+    m_current_second = 0;
+    std::memset(m_second, 0, sizeof(m_second));
+    std::memset(m_minute, 0, sizeof(m_minute));
+    m_seconds.head = 0;
+    m_seconds.count = 0;
+    m_minutes.head = 0;
+    m_minutes.count = 0;
+    m_has_baseline = false;
+    m_last_sample_ms = 0;
+    m_last_rtt_count = 0;
+    m_last_rtt_sum = 0;
+    m_last_rx_bytes = 0;
+    m_last_tx_bytes = 0;
+    m_last_packets = 0;
+    m_last_drops = 0;
+}
+
+template<size_t N>
+void MetricsHistory::push(Ring<N>& ring, const HistoryPoint* points) {
+    for (size_t s = 0; s < SERIES; s++) {
+        ring.points[s][ring.head] = points[s];
+    }
+    ring.head = (ring.head + 1) % N;
+    if (ring.count < N) {
+        ring.count++;
+    }
+}
+
+// =============================================================================
+// Readers
+// =============================================================================
+
+template<size_t N>
+size_t MetricsHistory::read_ring(const Ring<N>& ring, size_t series, HistoryPoint* out, size_t max_points) {
+    const size_t count = max_points < ring.count ? max_points : ring.count;
+    size_t index = (ring.head + N - count) % N;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = ring.points[series][index];
+        index = (index + 1) % N;
+    }
+    return count;
+}
+
+size_t MetricsHistory::size(HistoryResolution resolution) const {
+    std::scoped_lock lock(m_mutex);
+    return resolution == HistoryResolution::Minute ? m_minutes.count : m_seconds.count;
+}
+
+size_t MetricsHistory::read(HistoryResolution resolution, HistorySeries series,
+                            HistoryPoint* out, size_t max_points) const {
+    if (series >= HistorySeries::Count || out == nullptr) {
+        return 0;
+    }
+    std::scoped_lock lock(m_mutex);
+    const size_t s = static_cast<size_t>(series);
+    if (resolution == HistoryResolution::Minute) {
+        return read_ring(m_minutes, s, out, max_points);
+    }
+    return read_ring(m_seconds, s, out, max_points);
+}
+
+size_t MetricsHistory::serialize(HistoryResolution resolution, size_t max_points,
+                                 uint8_t* out, size_t capacity) const {
+    if (out == nullptr || capacity < sizeof(HistoryHeader)) {
+        return 0;
+    }
+
+    std::scoped_lock lock(m_mutex);
+    const bool minutes = resolution == HistoryResolution::Minute;
+    const size_t stored = minutes ? m_minutes.count : m_seconds.count;
+    const size_t fit = (capacity - sizeof(HistoryHeader)) / (SERIES * sizeof(HistoryPoint));
+
+    size_t count = max_points;
+    if (count > stored) {
+        count = stored;
+    }
+    if (count > fit) {
+        count = fit;
+    }
+
+    HistoryHeader header{};
+    header.resolution = static_cast<uint8_t>(resolution);
+    header.series_count = static_cast<uint8_t>(SERIES);
+    header.point_count = static_cast<uint16_t>(count);
+    header.interval_s = minutes ? 60 : 1;
+    header.newest_time_s = minutes ? (m_current_second / 60) * 60 : m_current_second;
+    std::memcpy(out, &header, sizeof(header));
+
+    HistoryPoint* points = reinterpret_cast<HistoryPoint*>(out + sizeof(header));
+    for (size_t s = 0; s < SERIES; s++) {
+        if (minutes) {
+            read_ring(m_minutes, s, points + s * count, count);
+        } else {
+            read_ring(m_seconds, s, points + s * count, count);
+        }
+    }
+    return sizeof(header) + SERIES * count * sizeof(HistoryPoint);
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
@@ -0,0 +1,254 @@
+/**
+ * @file metrics_history.hpp
+ * @brief Fixed-memory time series of the key metrics
+ *
+ * g_metrics and SharedState only hold the current values, so nothing shows
+ * how latency or throughput changed during a match. MetricsHistory samples
+ * the metrics periodically and keeps rollups of each series in two rings:
+ *
+ * | Resolution | Points                | Covers     |
+ * |------------|-----------------------|------------|
+ * | Second     | HISTORY_SECOND_POINTS | 10 minutes |
+ * | Minute     | HISTORY_MINUTE_POINTS | 3 hours    |
+ *
+ * ## Series
+ *
+ * | Series       | Unit    | Source                                   |
+ * |--------------|---------|------------------------------------------|
+ * | RttMs        | ms      | server_rtt_ms observations               |
+ * | RxBytes      | bytes/s | proxy_rx_bytes                           |
+ * | TxBytes      | bytes/s | proxy_tx_bytes                           |
+ * | Packets      | pkts/s  | proxy_rx_packets + proxy_tx_packets      |
+ * | QueuedBytes  | bytes   | proxy_queued_bytes                       |
+ * | Drops        | pkts/s  | proxy_rx_dropped + proxy_tx_failed       |
+ *
+ * ## Rollups
+ *
+ * Each sample() turns counter deltas into rates. The samples of one second
+ * become one HistoryPoint (min/avg/max/p99, nearest rank). A minute point
+ * merges its 60 second points: min of the minimums, max of the maximums,
+ * sample-weighted average, and p99 of the per-second p99 values. Seconds
+ * without a sample (no RTT measured, sysmodule idle) are kept as empty
+ * points so the timeline has no holes.
+ *
+ * No allocation: the rings and accumulators take about 92 KiB of static memory.
+ *
+ * ## Wire Format (ryu:cfg GetMetricsHistory, little-endian)
+ *
+ * ```
+ * HistoryHeader (16 bytes)
+ * series_count x point_count x HistoryPoint (20 bytes), per series,
+ * oldest first
+ * ```
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "metrics.hpp"
+#include "../platform/platform.hpp"
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+/** @brief Second points kept per series (10 minutes) */
+constexpr size_t HISTORY_SECOND_POINTS = 600;
+
+/** @brief Minute points kept per series (3 hours) */
+constexpr size_t HISTORY_MINUTE_POINTS = 180;
+
+/** @brief Samples kept per second for the p99 (min/max/avg use all of them) */
+constexpr size_t HISTORY_SAMPLES_PER_SECOND = 32;
+
+/**
+ * @brief Metric series kept in the history
+ */
+enum class HistorySeries : uint8_t {
+    RttMs       = 0,  ///< Server round-trip time (ms)
+    RxBytes     = 1,  ///< Proxy bytes received per second
+    TxBytes     = 2,  ///< Proxy bytes sent per second
+    Packets     = 3,  ///< Proxy packets (rx + tx) per second
+    QueuedBytes = 4,  ///< Bytes waiting in proxy socket queues
+    Drops       = 5,  ///< Packets dropped (rx overflow + tx failed) per second
+    Count
+};
+
+/**
+ * @brief Ring to read
+ */
+enum class HistoryResolution : uint8_t {
+    Second = 0,
+    Minute = 1,
+};
+
+/**
+ * @brief Rollup of one series over one second or minute
+ */
+struct HistoryPoint {
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint32_t p99;
+    uint32_t samples;   ///< 0 = no data for this interval
+};
+static_assert(sizeof(HistoryPoint) == 20, "HistoryPoint is part of the IPC format");
+
+/**
+ * @brief Header of a serialized history
+ */
+struct HistoryHeader {
+    uint8_t resolution;        ///< HistoryResolution
+    uint8_t series_count;      ///< HistorySeries::Count
+    uint16_t point_count;      ///< Points per series
+    uint32_t interval_s;       ///< 1 or 60
+    uint64_t newest_time_s;    ///< Uptime at the end of the newest point
+};
+static_assert(sizeof(HistoryHeader) == 16, "HistoryHeader is part of the IPC format");
+
+/**
+ * @brief Convert HistorySeries to string for logging
+ */
+const char* history_series_to_string(HistorySeries series);
+
+// =============================================================================
+// MetricsHistory
+// =============================================================================
+
+/**
+ * @brief Per-second and per-minute rollups of the key metrics
+ *
+ * sample() and the readers take the same short lock.
+ */
+class MetricsHistory {
+public:
+    MetricsHistory();
+
+    MetricsHistory(const MetricsHistory&) = delete;
+    MetricsHistory& operator=(const MetricsHistory&) = delete;
+
+    /**
+     * @brief Take one sample of the metrics
+     *
+     * The first call only records the counter baseline. Calls should come
+     * a few times per second (the ldn_bg loop samples every 100 ms).
+     *
+     * @param metrics Metrics to read
+     * @param now_ms Monotonic time
+     */
+    void sample(const Metrics& metrics, uint64_t now_ms);
+
+    /**
+     * @brief Record a raw value (used by sample(), exposed for tests)
+     */
+    void record(HistorySeries series, uint64_t value, uint64_t now_ms);
+
+    /**
+     * @brief Close every second before now_ms
+     */
+    void advance(uint64_t now_ms);
+
+    /**
+     * @brief Drop all points and the counter baseline
+     */
+    void clear();
+
+    /**
+     * @brief Closed points stored for a resolution (same for every series)
+     */
+    size_t size(HistoryResolution resolution) const;
+
+    /**
+     * @brief Copy the newest points of one series, oldest first
+     *
+     * @return Points written
+     */
+    size_t read(HistoryResolution resolution, HistorySeries series,
+                HistoryPoint* out, size_t max_points) const;
+
+    /**
+     * @brief Serialize the newest points of every series (see Wire Format)
+     *
+     * @param resolution Ring to read
+     * @param max_points Points per series (capped to what is stored)
+     * @param out Destination buffer
+     * @param capacity Buffer size; point_count shrinks to fit
+     * @return Bytes written, 0 if not even the header fits
+     */
+    size_t serialize(HistoryResolution resolution, size_t max_points,
+                     uint8_t* out, size_t capacity) const;
+
+private:
+    static constexpr size_t SERIES = static_cast<size_t>(HistorySeries::Count);
+
+    /// Samples of the open second of one series
+    struct SecondAccumulator {
+        uint64_t sum;
+        uint32_t min;
+        uint32_t max;
+        uint32_t count;
+        uint32_t kept[HISTORY_SAMPLES_PER_SECOND];
+    };
+
+    /// Second points of the open minute of one series
+    struct MinuteAccumulator {
+        uint64_t weighted_sum;   ///< sum of avg * samples
+        uint32_t min;
+        uint32_t max;
+        uint32_t samples;
+        uint32_t p99_count;
+        uint32_t p99s[60];
+    };
+
+    template<size_t N>
+    struct Ring {
+        HistoryPoint points[SERIES][N];
+        size_t head;    ///< Next write index
+        size_t count;
+    };
+
+    void record_locked(HistorySeries series, uint64_t value, uint64_t now_ms);
+    void advance_locked(uint64_t second);
+    void close_second();
+    void close_minute();
+    void reset_locked();
+
+    template<size_t N>
+    static void push(Ring<N>& ring, const HistoryPoint* points);
+    template<size_t N>
+    static size_t read_ring(const Ring<N>& ring, size_t series, HistoryPoint* out, size_t max_points);
+
+    mutable platform::Mutex m_mutex;
+    bool m_started;              ///< A second is open
+    uint64_t m_current_second;   ///< Open second (now_ms / 1000)
+    SecondAccumulator m_second[SERIES];
+    MinuteAccumulator m_minute[SERIES];
+    Ring<HISTORY_SECOND_POINTS> m_seconds;
+    Ring<HISTORY_MINUTE_POINTS> m_minutes;
+
+    // Counter baseline for rates
+    bool m_has_baseline;
+    uint64_t m_last_sample_ms;
+    uint64_t m_last_rtt_count;
+    uint64_t m_last_rtt_sum;
+    uint64_t m_last_rx_bytes;
+    uint64_t m_last_tx_bytes;
+    uint64_t m_last_packets;
+    uint64_t m_last_drops;
+};
+
+/**
+ * @brief History sampled by the ldn_bg thread, read by ryu:cfg
+ */
+extern MetricsHistory g_metrics_history;
+
+} // namespace diagnostics
+} // namespace ryu_ldn
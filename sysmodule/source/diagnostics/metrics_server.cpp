@@ -0,0 +1,250 @@
+/**
+ * @file metrics_server.cpp
+ * @brief Implementation of the metrics HTTP endpoint
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "metrics_server.hpp"
+#include "../debug/log.hpp"
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+namespace {
+
+/// How often the accept loop checks for Stop()
+constexpr uint32_t ACCEPT_POLL_MS = 250;
+
+// Server thread stack - static, only one server runs at a time
+alignas(0x1000) uint8_t g_metrics_thread_stack[0x4000];
+
+void SetTimeouts(int fd, uint32_t timeout_ms) {
+    timeval tv{};
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+bool SendAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = ::send(fd, data, len, 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        len -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+void SendStatus(int fd, const char* status) {
+    char header[128];
+    int len = std::snprintf(header, sizeof(header),
+                            "HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+    SendAll(fd, header, static_cast<size_t>(len));
+}
+
+} // anonymous namespace
+
+void sample_memory_usage(Metrics& metrics) {
+#ifdef __SWITCH__
+    u64 used = 0;
+    if (R_SUCCEEDED(svcGetInfo(&used, InfoType_UsedMemorySize, CUR_PROCESS_HANDLE, 0))) {
+        metrics.memory_used_bytes.Set(static_cast<int64_t>(used));
+    }
+#else
+    // statm: size resident shared ... (in pages)
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (file == nullptr) {
+        return;
+    }
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    if (std::fscanf(file, "%lu %lu", &size, &resident) == 2) {
+        metrics.memory_used_bytes.Set(static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE));
+    }
+    std::fclose(file);
+#endif
+}
+
+MetricsServer::MetricsServer(Metrics& metrics)
+    : m_metrics(metrics)
+    , m_listen_fd(-1)
+    , m_port(0)
+    , m_running(false)
+    , m_requests(0)
+    , m_response(nullptr)
+{
+}
+
+MetricsServer::~MetricsServer() {
+    Stop();
+}
+
+bool MetricsServer::Start(uint16_t port, bool loopback_only) {
+    if (m_running) {
+        return true;
+    }
+
+    m_listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listen_fd < 0) {
+        LOG_ERROR("Metrics: socket failed: errno=%d", errno);
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(loopback_only ? INADDR_LOOPBACK : INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (::bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(m_listen_fd, 4) < 0) {
+        LOG_ERROR("Metrics: cannot listen on port %u: errno=%d", port, errno);
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    if (::getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0) {
+        m_port = ntohs(addr.sin_port);
+    } else {
+        m_port = port;
+    }
+
+    m_response = new (std::nothrow) char[METRICS_RESPONSE_SIZE];
+    if (m_response == nullptr) {
+        LOG_ERROR("Metrics: out of memory");
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+
+    m_requests = 0;
+    m_running = true;
+    if (!m_thread.Start(&MetricsServer::ThreadEntry, this, g_metrics_thread_stack,
+                        sizeof(g_metrics_thread_stack), platform::LowestThreadPriority, "ryu_ldn::Metrics")) {
+        LOG_ERROR("Metrics: cannot start thread");
+        m_running = false;
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        delete[] m_response;
+        m_response = nullptr;
+        return false;
+    }
+
+    LOG_INFO("Metrics endpoint listening on port %u", m_port);
+    return true;
+}
+
+void MetricsServer::Stop() {
+    if (!m_running) {
+        return;
+    }
+
+    // The accept loop polls m_running
+    m_running = false;
+    m_thread.Join();
+
+    ::close(m_listen_fd);
+    m_listen_fd = -1;
+    delete[] m_response;
+    m_response = nullptr;
+}
+
+void MetricsServer::ThreadEntry(void* arg) {
+    static_cast<MetricsServer*>(arg)->Run();
+}
+
+void MetricsServer::Run() {
+    while (m_running) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(m_listen_fd, &read_fds);
+        timeval tv{};
+        tv.tv_usec = ACCEPT_POLL_MS * 1000;
+
+        int ready = ::select(m_listen_fd + 1, &read_fds, nullptr, nullptr, &tv);
+        if (ready <= 0) {
+            continue;
+        }
+
+        int client_fd = ::accept(m_listen_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+
+        SetTimeouts(client_fd, METRICS_IO_TIMEOUT_MS);
+        HandleClient(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsServer::HandleClient(int fd) {
+    // Read until the end of the request header
+    char request[METRICS_REQUEST_SIZE + 1];
+    size_t received = 0;
+    while (received < METRICS_REQUEST_SIZE) {
+        ssize_t n = ::recv(fd, request + received, METRICS_REQUEST_SIZE - received, 0);
+        if (n <= 0) {
+            return;
+        }
+        received += static_cast<size_t>(n);
+        request[received] = '\0';
+        if (std::strstr(request, "\r\n\r\n") != nullptr || std::strstr(request, "\n\n") != nullptr) {
+            break;
+        }
+    }
+    request[received] = '\0';
+
+    m_requests++;
+
+    if (std::strncmp(request, "GET ", 4) != 0) {
+        SendStatus(fd, "405 Method Not Allowed");
+        return;
+    }
+
+    // Path ends at the next space (query strings are ignored)
+    const char* path = request + 4;
+    size_t path_len = std::strcspn(path, " ?\r\n");
+    bool is_metrics = (path_len == 8 && std::strncmp(path, "/metrics", 8) == 0) ||
+                      (path_len == 1 && path[0] == '/');
+    if (!is_metrics) {
+        SendStatus(fd, "404 Not Found");
+        return;
+    }
+
+    sample_memory_usage(m_metrics);
+    size_t body_len = render_prometheus(m_metrics, m_response, METRICS_RESPONSE_SIZE);
+
+    char header[160];
+    int header_len = std::snprintf(header, sizeof(header),
+                                   "HTTP/1.1 200 OK\r\n"
+                                   "Content-Type: text/plain; version=0.0.4\r\n"
+                                   "Content-Length: %zu\r\n"
+                                   "Connection: close\r\n\r\n",
+                                   body_len);
+    if (SendAll(fd, header, static_cast<size_t>(header_len))) {
+        SendAll(fd, m_response, body_len);
+    }
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
@@ -0,0 +1,117 @@
+/**
+ * @file metrics_server.hpp
+ * @brief Minimal HTTP endpoint serving metrics in Prometheus text format
+ *
+ * Off by default (`[debug] metrics = 1` enables it). When enabled, the
+ * sysmodule listens on `metrics_port` (default 9100) on every interface so
+ * a Prometheus server on the LAN can scrape many consoles:
+ *
+ * ```yaml
+ * scrape_configs:
+ *   - job_name: ryu_ldn_nx
+ *     static_configs:
+ *       - targets: ['192.168.1.20:9100', '192.168.1.21:9100']
+ * ```
+ *
+ * ## Protocol
+ *
+ * - `GET /metrics` (or `GET /`): 200, `text/plain; version=0.0.4`
+ * - Any other path: 404; any other method: 405
+ * - One request per connection (`Connection: close`), one client at a time
+ *
+ * The server thread renders from atomic snapshots of g_metrics (see
+ * metrics.hpp), so a scrape never blocks the data path.
+ *
+ * ## Thread Safety
+ *
+ * Start() and Stop() must not race each other. Only one server may run at a
+ * time (the thread stack is static).
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "metrics.hpp"
+#include "../platform/platform.hpp"
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+/// Default TCP port (node_exporter's, what dashboards expect)
+constexpr uint16_t METRICS_DEFAULT_PORT = 9100;
+
+/// Largest rendered response body
+constexpr size_t METRICS_RESPONSE_SIZE = 12 * 1024;
+
+/// Largest request header read before answering
+constexpr size_t METRICS_REQUEST_SIZE = 1024;
+
+/// Per-connection receive/send timeout
+constexpr uint32_t METRICS_IO_TIMEOUT_MS = 2000;
+
+/**
+ * @brief Sample the process memory usage into metrics.memory_used_bytes
+ *
+ * Console: svcGetInfo(UsedMemorySize). Host: resident set size.
+ */
+void sample_memory_usage(Metrics& metrics);
+
+/**
+ * @brief HTTP listener for the metrics registry
+ */
+class MetricsServer {
+public:
+    explicit MetricsServer(Metrics& metrics);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Bind and start serving
+     *
+     * @param port TCP port (0 = ephemeral, see GetPort())
+     * @param loopback_only Bind 127.0.0.1 instead of every interface (tests)
+     * @return false if the socket could not be bound or the thread not started
+     */
+    bool Start(uint16_t port, bool loopback_only = false);
+
+    /**
+     * @brief Stop serving and join the thread
+     */
+    void Stop();
+
+    bool IsRunning() const { return m_running.load(); }
+
+    /**
+     * @brief Port actually bound (valid after Start())
+     */
+    uint16_t GetPort() const { return m_port; }
+
+    /**
+     * @brief Requests answered since Start()
+     */
+    uint64_t GetRequestCount() const { return m_requests.load(); }
+
+private:
+    static void ThreadEntry(void* arg);
+    void Run();
+    void HandleClient(int fd);
+
+    Metrics& m_metrics;
+    int m_listen_fd;
+    uint16_t m_port;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_requests;
+    char* m_response;  ///< Allocated by Start(), released by Stop()
+    platform::Thread m_thread;
+};
+
+} // namespace diagnostics
+} // namespace ryu_ldn
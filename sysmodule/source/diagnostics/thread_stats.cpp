@@ -0,0 +1,158 @@
+/**
+ * @file thread_stats.cpp
+ * @brief Thread registry and per-role CPU/wakeup totals
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "thread_stats.hpp"
+
+#include <mutex>
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+ThreadRegistry g_thread_registry;
+
+const char* thread_role_to_string(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::MitmIpc:        return "MitmIpc";
+        case ThreadRole::LdnBackground:  return "LdnBackground";
+        case ThreadRole::P2pAccept:      return "P2pAccept";
+        case ThreadRole::P2pSession:     return "P2pSession";
+        case ThreadRole::P2pLease:       return "P2pLease";
+        case ThreadRole::P2pClient:      return "P2pClient";
+        case ThreadRole::ConfigServer:   return "ConfigServer";
+        case ThreadRole::LogMaintenance: return "LogMaintenance";
+        case ThreadRole::NacpCache:      return "NacpCache";
+        case ThreadRole::PortMapping:    return "PortMapping";
+        case ThreadRole::LinkTest:       return "LinkTest";
+        default:                         return "Invalid";
+    }
+}
+
+ThreadRegistry::ThreadRegistry(uint64_t sample_interval_ns)
+    : m_mutex()
+    , m_sample_interval_ns(sample_interval_ns)
+    , m_retired_cpu_ns{}
+    , m_retired_wakeups{}
+{
+}
+
+bool ThreadRegistry::register_current(ThreadRole role) {
+    if (role >= ThreadRole::Count) {
+        return false;
+    }
+
+    const uint64_t id = platform::GetCurrentThreadId();
+    std::scoped_lock lock(m_mutex);
+
+    Slot* free_slot = nullptr;
+    for (auto& slot : m_slots) {
+        const uint64_t slot_id = slot.thread_id.load(std::memory_order_relaxed);
+        if (slot_id == id) {
+            return false;
+        }
+        if (slot_id == 0 && free_slot == nullptr) {
+            free_slot = &slot;
+        }
+    }
+    if (free_slot == nullptr) {
+        return false;
+    }
+
+    free_slot->role = role;
+    free_slot->cpu_ns.store(platform::GetThreadCpuNs(), std::memory_order_relaxed);
+    free_slot->wakeups.store(0, std::memory_order_relaxed);
+    free_slot->next_sample_ns = platform::GetTickNs() + m_sample_interval_ns;
+    free_slot->thread_id.store(id, std::memory_order_release);
+    return true;
+}
+
+void ThreadRegistry::unregister_current() {
+    Slot* slot = find_current();
+    if (slot == nullptr) {
+        return;
+    }
+
+    sample(*slot, platform::GetTickNs(), m_sample_interval_ns);
+
+    std::scoped_lock lock(m_mutex);
+    const size_t role = static_cast<size_t>(slot->role);
+    m_retired_cpu_ns[role] += slot->cpu_ns.load(std::memory_order_relaxed);
+    m_retired_wakeups[role] += slot->wakeups.load(std::memory_order_relaxed);
+    slot->thread_id.store(0, std::memory_order_release);
+}
+
+void ThreadRegistry::wakeup() {
+    Slot* slot = find_current();
+    if (slot == nullptr) {
+        return;
+    }
+
+    slot->wakeups.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t now_ns = platform::GetTickNs();
+    if (now_ns >= slot->next_sample_ns) {
+        sample(*slot, now_ns, m_sample_interval_ns);
+    }
+}
+
+void ThreadRegistry::sample_current() {
+    Slot* slot = find_current();
+    if (slot != nullptr) {
+        sample(*slot, platform::GetTickNs(), m_sample_interval_ns);
+    }
+}
+
+ThreadRoleStats ThreadRegistry::role_stats(ThreadRole role) const {
+    ThreadRoleStats stats{};
+    if (role >= ThreadRole::Count) {
+        return stats;
+    }
+
+    std::scoped_lock lock(m_mutex);
+    stats.cpu_ns = m_retired_cpu_ns[static_cast<size_t>(role)];
+    stats.wakeups = m_retired_wakeups[static_cast<size_t>(role)];
+    for (const auto& slot : m_slots) {
+        if (slot.thread_id.load(std::memory_order_acquire) == 0 || slot.role != role) {
+            continue;
+        }
+        stats.cpu_ns += slot.cpu_ns.load(std::memory_order_relaxed);
+        stats.wakeups += slot.wakeups.load(std::memory_order_relaxed);
+        stats.threads++;
+    }
+    return stats;
+}
+
+size_t ThreadRegistry::size() const {
+    std::scoped_lock lock(m_mutex);
+    size_t count = 0;
+    for (const auto& slot : m_slots) {
+        if (slot.thread_id.load(std::memory_order_relaxed) != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+ThreadRegistry::Slot* ThreadRegistry::find_current() {
+    const uint64_t id = platform::GetCurrentThreadId();
+    for (auto& slot : m_slots) {
+        if (slot.thread_id.load(std::memory_order_acquire) == id) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadRegistry::sample(Slot& slot, uint64_t now_ns, uint64_t interval_ns) {
+    const uint64_t cpu_ns = platform::GetThreadCpuNs();
+    if (cpu_ns != 0) {
+        slot.cpu_ns.store(cpu_ns, std::memory_order_relaxed);
+    }
+    slot.next_sample_ns = now_ns + interval_ns;
+}
+
+} // namespace diagnostics
+} // namespace ryu_ldn
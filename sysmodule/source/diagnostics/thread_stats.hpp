@@ -0,0 +1,196 @@
+/**
+ * @file thread_stats.hpp
+ * @brief Per-thread CPU time and wakeup accounting for the sysmodule threads
+ *
+ * The sysmodule runs a dozen threads next to the game (MITM IPC, ldn_bg,
+ * P2P accept/session/lease, config server, log maintenance...). The
+ * ThreadRegistry tells which of them actually costs CPU and how often each
+ * one wakes up, so a busy poll loop or a chatty game shows up by role.
+ *
+ * ## Accounting
+ *
+ * - Each thread registers itself with its ThreadRole when it starts
+ *   (ScopedThreadAccount) and calls wakeup() each time it leaves a wait.
+ * - wakeup() counts the wakeup and, at most every THREAD_SAMPLE_INTERVAL_NS,
+ *   samples the thread's own CPU time (the console kernel only reports it
+ *   for the calling thread). A thread's CPU figure therefore lags by the
+ *   work done since its last sample.
+ * - Threads that exit fold their totals into per-role counters, so P2P
+ *   sessions that come and go keep adding to P2pSession.
+ *
+ * ## Overhead
+ *
+ * - wakeup(): a scan of THREAD_REGISTRY_SLOTS atomic ids and a tick read;
+ *   one svcGetInfo (console) or clock_gettime (host) per sample interval.
+ * - No allocation; the registry is a fixed array.
+ *
+ * Per-role totals are read through ryu:cfg GetThreadStats; the overlay
+ * turns two reads into CPU % and wakeups per second.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "../platform/platform.hpp"
+
+namespace ryu_ldn {
+namespace diagnostics {
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+/** @brief Threads that can be registered at the same time */
+constexpr size_t THREAD_REGISTRY_SLOTS = 24;
+
+/** @brief Minimum time between two CPU samples of the same thread */
+constexpr uint64_t THREAD_SAMPLE_INTERVAL_NS = 50ULL * 1000000ULL;
+
+/**
+ * @brief What a thread is for (ryu:cfg GetThreadStats index)
+ */
+enum class ThreadRole : uint8_t {
+    MitmIpc        = 0,   ///< ldn:u / bsd:u MITM server threads
+    LdnBackground  = 1,   ///< ldn_bg (server client update, pings)
+    P2pAccept      = 2,   ///< p2p_accept (P2P host listener)
+    P2pSession     = 3,   ///< p2p_session (one per P2P guest)
+    P2pLease       = 4,   ///< p2p_lease (port mapping renewal)
+    P2pClient      = 5,   ///< P2P guest receive thread
+    ConfigServer   = 6,   ///< ryu:cfg server thread
+    LogMaintenance = 7,   ///< Log file idle timeout thread
+    NacpCache      = 8,   ///< NACP cache refresh worker
+    PortMapping    = 9,   ///< UPnP discovery
+    LinkTest       = 10,  ///< Link quality test worker
+    Count
+};
+
+/**
+ * @brief Convert ThreadRole to string for logging
+ */
+const char* thread_role_to_string(ThreadRole role);
+
+/**
+ * @brief Totals of all threads of one role, live and exited
+ */
+struct ThreadRoleStats {
+    uint64_t cpu_ns;     ///< CPU time consumed
+    uint64_t wakeups;    ///< Waits left
+    uint32_t threads;    ///< Threads currently registered
+};
+
+// =============================================================================
+// ThreadRegistry
+// =============================================================================
+
+/**
+ * @brief Fixed table of the registered threads
+ *
+ * register/unregister and role_stats() take a lock; wakeup() does not.
+ * Only the owning thread writes its slot counters.
+ */
+class ThreadRegistry {
+public:
+    /**
+     * @param sample_interval_ns Minimum time between two CPU samples
+     *        of a thread (0 samples on every wakeup)
+     */
+    explicit ThreadRegistry(uint64_t sample_interval_ns = THREAD_SAMPLE_INTERVAL_NS);
+
+    ThreadRegistry(const ThreadRegistry&) = delete;
+    ThreadRegistry& operator=(const ThreadRegistry&) = delete;
+
+    /**
+     * @brief Register the calling thread
+     * @return false if the table is full or the thread is already registered
+     */
+    bool register_current(ThreadRole role);
+
+    /**
+     * @brief Take a last sample and fold the calling thread into its role totals
+     */
+    void unregister_current();
+
+    /**
+     * @brief Count a wakeup of the calling thread (no-op if unregistered)
+     */
+    void wakeup();
+
+    /**
+     * @brief Sample the calling thread's CPU time now
+     */
+    void sample_current();
+
+    /**
+     * @brief Totals of one role
+     */
+    ThreadRoleStats role_stats(ThreadRole role) const;
+
+    /**
+     * @brief Threads currently registered
+     */
+    size_t size() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> thread_id{0};    ///< 0 = free
+        ThreadRole role = ThreadRole::Count;
+        std::atomic<uint64_t> cpu_ns{0};       ///< Last CPU sample
+        std::atomic<uint64_t> wakeups{0};
+        uint64_t next_sample_ns = 0;           ///< Owner only
+    };
+
+    Slot* find_current();
+    static void sample(Slot& slot, uint64_t now_ns, uint64_t interval_ns);
+
+    mutable platform::Mutex m_mutex;
+    uint64_t m_sample_interval_ns;
+    Slot m_slots[THREAD_REGISTRY_SLOTS];
+    uint64_t m_retired_cpu_ns[static_cast<size_t>(ThreadRole::Count)];
+    uint64_t m_retired_wakeups[static_cast<size_t>(ThreadRole::Count)];
+};
+
+/**
+ * @brief Registry shared by all sysmodule threads
+ */
+extern ThreadRegistry g_thread_registry;
+
+/**
+ * @brief Registers the calling thread for the lifetime of the scope
+ *
+ * @code
+ * void WorkerThreadFunc() {
+ *     ScopedThreadAccount account(ThreadRole::NacpCache);
+ *     while (running) {
+ *         m_event.Wait();
+ *         g_thread_registry.wakeup();
+ *         ...
+ *     }
+ * }
+ * @endcode
+ */
+class ScopedThreadAccount {
+public:
+    explicit ScopedThreadAccount(ThreadRole role, ThreadRegistry& registry = g_thread_registry)
+        : m_registry(registry.register_current(role) ? &registry : nullptr) {}
+
+    ~ScopedThreadAccount() {
+        if (m_registry != nullptr) {
+            m_registry->unregister_current();
+        }
+    }
+
+    ScopedThreadAccount(const ScopedThreadAccount&) = delete;
+    ScopedThreadAccount& operator=(const ScopedThreadAccount&) = delete;
+
+private:
+    ThreadRegistry* m_registry;
+};
+
+} // namespace diagnostics
+} // namespace ryu_ldn
@@ -8,12 +8,19 @@
 
 #include "ldn_icommunication.hpp"
 #include "ldn_shared_state.hpp"
+#include "nacp_cache_service.hpp"
 #include "../config/config_ipc_service.hpp"
 #include "../debug/log.hpp"
 #include "../bsd/proxy_socket_manager.hpp"
+#include "../diagnostics/metrics.hpp"
+#include "../diagnostics/ipc_recorder.hpp"
+#include "../diagnostics/flight_recorder.hpp"
+#include "../diagnostics/thread_stats.hpp"
+#include "../diagnostics/metrics_history.hpp"
+#include "../p2p/relay_delegation.hpp"
+#include "../p2p/lan_discovery.hpp"
 #include <arpa/inet.h>
-#include <switch/services/ns.h>
-#include <switch/nacp.h>
+#include <cstdio>
 
 namespace ams::mitm::ldn {
 
@@ -31,6 +38,221 @@ namespace ams::mitm::ldn {
 static ICommunicationService* g_active_ldn_service = nullptr;
 static os::Mutex g_active_service_mutex{false};
 
+/**
+ * @brief Dual-path redundancy state (see redundant_path.hpp)
+ *
+ * Shared by the relay receive path, the P2P receive thread and the BSD send
+ * callback. Kept outside the service so the P2P receive thread never needs
+ * g_active_service_mutex, which is held while the P2P client is torn down.
+ */
+static ryu_ldn::ldn::RedundantPath g_redundant_path;
+static os::Mutex g_redundant_mutex{false};
+
+/**
+ * @brief P2P client whose receive thread delivers packets
+ *
+ * Set before the client connects and cleared once it is deleted. Disconnect()
+ * joins the receive thread first, so that thread can use it without
+ * g_active_service_mutex to answer a ProxyConnect on the path it came from.
+ */
+static p2p::P2pProxyClient* g_p2p_receiving_client = nullptr;
+
+/**
+ * @brief Broadcast fan-out delegation, guest side (see relay_delegation.hpp)
+ *
+ * Shared by the P2P receive thread (host control, forwards to re-send), the
+ * relay receive path (last-hop forwards) and the background thread
+ * (reports). g_relay_server_client is the relay connection a delegate
+ * re-sends on: set while connected to the server, cleared before the
+ * connection is closed. g_relay_buffer is guarded by g_relay_mutex.
+ */
+static ryu_ldn::p2p::RelayMember g_relay_member;
+static os::Mutex g_relay_mutex{false};
+static ryu_ldn::network::RyuLdnClient* g_relay_server_client = nullptr;
+static uint8_t g_relay_buffer[ryu_ldn::p2p::RELAY_FORWARD_OVERHEAD + ryu_ldn::p2p::RELAY_MAX_PAYLOAD];
+
+/**
+ * @brief Run an incoming ProxyData through the duplicate filter
+ *
+ * @param info Addressing of the packet, tag flag already cleared
+ * @param tagged The sender marked the packet as carrying a trailer
+ * @param payload Payload as received
+ * @param payload_size In: received size. Out: size to route.
+ * @param reply_ack Set when a Hello must be answered
+ * @return true if the packet must be routed to the game
+ */
+static bool FilterRedundantProxyData(const ryu_ldn::protocol::ProxyInfo& info, bool tagged,
+                                     const uint8_t* payload, uint32_t& payload_size,
+                                     bool& reply_ack) {
+    uint64_t now_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
+
+    std::scoped_lock lock(g_redundant_mutex);
+    auto verdict = g_redundant_path.on_receive(info, tagged, payload, payload_size, reply_ack, now_ms);
+    return verdict == ryu_ldn::ldn::RedundantVerdict::Deliver;
+}
+
+/**
+ * @brief Hand a stream window update to the proxy sockets
+ *
+ * @param info Addressing of the packet, tag flag already cleared
+ * @param payload Payload as received
+ * @param payload_size Payload size
+ * @return true if the packet was a window update (consumed)
+ */
+static bool HandleStreamWindowUpdate(const ryu_ldn::protocol::ProxyInfo& info,
+                                     const uint8_t* payload, uint32_t payload_size) {
+    if ((static_cast<int32_t>(info.protocol) & mitm::bsd::PROXY_STREAM_WINDOW_FLAG) == 0) {
+        return false;
+    }
+
+    uint32_t read_total;
+    if (payload_size >= sizeof(read_total)) {
+        std::memcpy(&read_total, payload, sizeof(read_total));
+        mitm::bsd::ProxySocketManager::GetInstance().RouteStreamWindow(
+            info.source_ipv4, info.source_port, info.dest_ipv4, info.dest_port, read_total);
+    }
+    return true;
+}
+
+/**
+ * @brief Deliver the broadcast carried by a Forward to the local proxy sockets
+ */
+static void RouteRelayedBroadcast(const ryu_ldn::protocol::ProxyInfo& info,
+                                  const uint8_t* payload, uint32_t payload_size) {
+    if (info.protocol != ryu_ldn::protocol::ProtocolType::Udp) {
+        return;
+    }
+
+    mitm::bsd::ProxySocketManager::GetInstance().RouteIncomingData(
+        info.source_ipv4, info.source_port, info.dest_ipv4, info.dest_port,
+        ryu_ldn::bsd::ProtocolType::Udp, payload, payload_size);
+}
+
+/**
+ * @brief Handle a delegation message received from the P2P host
+ *
+ * Assign/Join/Release are answered on the P2P link. A Forward is delivered
+ * locally, then re-sent through the relay to each target the host listed,
+ * as a last-hop Forward (no targets) from this console's virtual IP.
+ *
+ * @param outer Addressing of the received ProxyData (dest: our virtual IP)
+ * @param control Parsed control header
+ * @param payload Payload as received
+ * @param payload_size Payload size
+ */
+static void HandleHostRelayControl(const ryu_ldn::protocol::ProxyInfo& outer,
+                                   const ryu_ldn::p2p::RelayControl& control,
+                                   const uint8_t* payload, uint32_t payload_size) {
+    uint64_t now_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
+
+    if (control.type != ryu_ldn::p2p::RelayControlType::Forward) {
+        ryu_ldn::p2p::RelayControl reply;
+        bool send_reply;
+        {
+            std::scoped_lock lock(g_relay_mutex);
+            send_reply = g_relay_member.on_host_control(control, now_ms, reply);
+        }
+        if (send_reply && g_p2p_receiving_client != nullptr) {
+            ryu_ldn::protocol::ProxyDataHeader header{};
+            header.info.source_ipv4 = outer.dest_ipv4;
+            header.info.source_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+            header.info.dest_ipv4 = outer.source_ipv4;
+            header.info.dest_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+            header.info.protocol = ryu_ldn::protocol::ProtocolType::Udp;
+            header.data_length = sizeof(reply);
+            g_p2p_receiving_client->SendProxyData(header, reinterpret_cast<const uint8_t*>(&reply),
+                                                  sizeof(reply));
+        }
+        return;
+    }
+
+    ryu_ldn::p2p::RelayControl forward;
+    ryu_ldn::protocol::ProxyInfo info;
+    const uint8_t* inner = nullptr;
+    uint32_t inner_size = 0;
+    if (!ryu_ldn::p2p::parse_relay_forward(payload, payload_size, forward, info, inner, inner_size)) {
+        return;
+    }
+
+    // Our own copy first, then the guests the host handed over
+    RouteRelayedBroadcast(info, inner, inner_size);
+
+    std::scoped_lock lock(g_relay_mutex);
+    uint32_t targets[ryu_ldn::p2p::RELAY_MAX_TARGETS];
+    size_t target_count = g_relay_member.forward_targets(forward, targets);
+    if (target_count == 0 || g_relay_server_client == nullptr) {
+        return;
+    }
+
+    size_t wrapped_len = ryu_ldn::p2p::build_relay_forward(nullptr, 0, info, inner, inner_size,
+                                                           g_relay_buffer, sizeof(g_relay_buffer));
+    if (wrapped_len == 0) {
+        return;
+    }
+
+    ryu_ldn::protocol::ProxyDataHeader header{};
+    header.info.source_ipv4 = outer.dest_ipv4;
+    header.info.source_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+    header.info.dest_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+    header.info.protocol = ryu_ldn::protocol::ProtocolType::Udp;
+    header.data_length = static_cast<uint32_t>(wrapped_len);
+
+    for (size_t i = 0; i < target_count; i++) {
+        header.info.dest_ipv4 = targets[i];
+        auto result = g_relay_server_client->send_proxy_data(header, g_relay_buffer, wrapped_len);
+        if (result == ryu_ldn::network::ClientOpResult::Success) {
+            g_relay_member.on_relayed(static_cast<uint32_t>(sizeof(ryu_ldn::protocol::LdnHeader) +
+                                                            sizeof(header) + wrapped_len), now_ms);
+            ryu_ldn::diagnostics::g_metrics.p2p_fanout_relayed.Add();
+        }
+    }
+}
+
+/**
+ * @brief Handle a last-hop Forward received through the relay
+ *
+ * Only accepted from the delegate this console joined (or just left).
+ */
+static void HandleRelayedForward(const ryu_ldn::protocol::ProxyInfo& outer,
+                                 const uint8_t* payload, uint32_t payload_size) {
+    uint64_t now_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
+    {
+        std::scoped_lock lock(g_relay_mutex);
+        if (!g_relay_member.accept_forward(outer.source_ipv4, now_ms)) {
+            return;
+        }
+    }
+
+    ryu_ldn::p2p::RelayControl forward;
+    ryu_ldn::protocol::ProxyInfo info;
+    const uint8_t* inner = nullptr;
+    uint32_t inner_size = 0;
+    if (ryu_ldn::p2p::parse_relay_forward(payload, payload_size, forward, info, inner, inner_size)) {
+        RouteRelayedBroadcast(info, inner, inner_size);
+    }
+}
+
+/**
+ * @brief Time an ldn:u command into the ipc_latency_us histogram, the IPC trace
+ * and the flight recorder
+ */
+#define LDN_IPC_TIMER(command) \
+    ryu_ldn::diagnostics::ScopedLatency ipc_timer(ryu_ldn::diagnostics::g_metrics.ipc_latency_us); \
+    ryu_ldn::diagnostics::ScopedIpcRecord ipc_record( \
+        ryu_ldn::diagnostics::IpcService::Ldn, ryu_ldn::diagnostics::ldn_cmd::command); \
+    ryu_ldn::diagnostics::ScopedFlightIpc ipc_flight( \
+        static_cast<uint8_t>(ryu_ldn::diagnostics::IpcService::Ldn), ryu_ldn::diagnostics::ldn_cmd::command, \
+        LdnCallMayBlock(ryu_ldn::diagnostics::ldn_cmd::command))
+
+/**
+ * @brief Commands that wait for the server: their duration is no IPC latency
+ */
+static constexpr bool LdnCallMayBlock(u16 command) {
+    namespace cmd = ryu_ldn::diagnostics::ldn_cmd;
+    return command == cmd::Scan || command == cmd::CreateNetwork || command == cmd::CreateNetworkPrivate ||
+           command == cmd::Connect || command == cmd::ConnectPrivate;
+}
+
 // Background thread stack - allocated statically to avoid bloating class size
 alignas(os::ThreadStackAlignment) static u8 g_background_thread_stack[0x4000];
 
@@ -101,12 +323,132 @@ static bool SendProxyDataCallback(uint32_t source_ip, uint16_t source_port,
     return result == ryu_ldn::network::ClientOpResult::Success;
 }
 
+/**
+ * @brief Callback for BSD MITM to send ProxyConnect (TCP connect)
+ *
+ * @param source_ip Source IP (host byte order)
+ * @param source_port Source port (host byte order)
+ * @param dest_ip Destination IP (host byte order)
+ * @param dest_port Destination port (host byte order)
+ * @param protocol Protocol type (TCP)
+ * @return true if sent successfully
+ */
+static bool SendProxyConnectCallback(uint32_t source_ip, uint16_t source_port,
+                                     uint32_t dest_ip, uint16_t dest_port,
+                                     ryu_ldn::bsd::ProtocolType protocol) {
+    std::scoped_lock lock(g_active_service_mutex);
+
+    if (g_active_ldn_service == nullptr || protocol != ryu_ldn::bsd::ProtocolType::Tcp) {
+        return false;
+    }
+
+    ryu_ldn::protocol::ProxyConnectRequest request{};
+    request.info.source_ipv4 = source_ip;
+    request.info.source_port = source_port;
+    request.info.dest_ipv4 = dest_ip;
+    request.info.dest_port = dest_port;
+    request.info.protocol = ryu_ldn::protocol::ProtocolType::Tcp;
+
+    auto result = g_active_ldn_service->SendProxyConnectToServer(request);
+    return result == ryu_ldn::network::ClientOpResult::Success;
+}
+
+/**
+ * @brief Callback for BSD MITM: may a TCP connect to this peer be optimistic
+ *
+ * Only peers that answered a Hello run ryu_ldn_nx and accept data queued
+ * behind a ProxyConnect.
+ */
+static bool IsOptimisticPeerCallback(uint32_t ip) {
+    std::scoped_lock lock(g_redundant_mutex);
+    return g_redundant_path.is_capable(ip);
+}
+
+/**
+ * @brief Callback for BSD MITM to send a stream window update
+ *
+ * Only peers that answered a Hello run ryu_ldn_nx and understand the flag;
+ * a Ryujinx peer would reject the protocol value.
+ *
+ * @param source_ip Source IP (host byte order)
+ * @param source_port Source port (host byte order)
+ * @param dest_ip Destination IP (host byte order)
+ * @param dest_port Destination port (host byte order)
+ * @param read_total Bytes the game has read from the stream
+ * @return true if sent successfully
+ */
+static bool SendStreamWindowCallback(uint32_t source_ip, uint16_t source_port,
+                                     uint32_t dest_ip, uint16_t dest_port,
+                                     uint32_t read_total) {
+    if (!IsOptimisticPeerCallback(dest_ip)) {
+        return false;
+    }
+
+    std::scoped_lock lock(g_active_service_mutex);
+
+    if (g_active_ldn_service == nullptr) {
+        return false;
+    }
+
+    ryu_ldn::protocol::ProxyDataHeader header{};
+    header.info.source_ipv4 = source_ip;
+    header.info.source_port = source_port;
+    header.info.dest_ipv4 = dest_ip;
+    header.info.dest_port = dest_port;
+    header.info.protocol = static_cast<ryu_ldn::protocol::ProtocolType>(
+        static_cast<int32_t>(ryu_ldn::protocol::ProtocolType::Tcp) | mitm::bsd::PROXY_STREAM_WINDOW_FLAG);
+    header.data_length = sizeof(read_total);
+
+    auto result = g_active_ldn_service->SendProxyDataToServer(header, &read_total, sizeof(read_total));
+    return result == ryu_ldn::network::ClientOpResult::Success;
+}
+
+/**
+ * @brief Hand an incoming ProxyConnect to the listening proxy sockets
+ *
+ * @param request Request received from the relay or the P2P host
+ * @return Reply for the connecting peer: Unspecified if accepted, Tcp if refused
+ */
+static ryu_ldn::protocol::ProxyConnectResponse RouteProxyConnect(
+    const ryu_ldn::protocol::ProxyConnectRequest& request)
+{
+    bool accepted = mitm::bsd::ProxySocketManager::GetInstance().RouteConnectRequest(request);
+    LOG_VERBOSE("ProxyConnect: src=0x%08X:%u dst=0x%08X:%u %s",
+                request.info.source_ipv4, request.info.source_port,
+                request.info.dest_ipv4, request.info.dest_port,
+                accepted ? "accepted" : "refused");
+
+    ryu_ldn::protocol::ProxyConnectResponse response{};
+    response.info = request.info;
+    response.info.protocol = accepted ? ryu_ldn::protocol::ProtocolType::Unspecified
+                                      : ryu_ldn::protocol::ProtocolType::Tcp;
+    return response;
+}
+
+/**
+ * @brief Link state for the server client's reconnect scheduling (nifm)
+ *
+ * Anything but an established internet connection counts as down, nifm
+ * reports an error when no network is selected at all.
+ */
+static ryu_ldn::network::LinkState NifmLinkState(void* user_data) {
+    AMS_UNUSED(user_data);
+    NifmInternetConnectionType type;
+    u32 wifi_strength;
+    NifmInternetConnectionStatus status;
+    if (R_FAILED(nifmGetInternetConnectionStatus(&type, &wifi_strength, &status))) {
+        return ryu_ldn::network::LinkState::Down;
+    }
+    return status == NifmInternetConnectionStatus_Connected ? ryu_ldn::network::LinkState::Up
+                                                             : ryu_ldn::network::LinkState::Down;
+}
+
 // Verify struct sizes match Nintendo's expectations
 static_assert(sizeof(NetworkInfo) == 0x480, "sizeof(NetworkInfo) should be 0x480");
 static_assert(sizeof(ConnectNetworkData) == 0x7C, "sizeof(ConnectNetworkData) should be 0x7C");
 static_assert(sizeof(ScanFilter) == 0x60, "sizeof(ScanFilter) should be 0x60");
 
-ICommunicationService::ICommunicationService(ncm::ProgramId program_id)
+ICommunicationService::ICommunicationService(ncm::ProgramId program_id, u64 client_pid)
     : m_state_machine()
     , m_error_state(0)
     , m_client_process_id(0)
@@ -140,6 +482,7 @@ ICommunicationService::ICommunicationService(ncm::ProgramId program_id)
     , m_background_thread_running(false)
     , m_client_mutex(false)
     , m_program_id(program_id)
+    , m_client_pid(client_pid)
     , m_local_communication_id(0)
 {
     LOG_INFO("ICommunicationService created with program_id=0x%016lx", m_program_id.value);
@@ -159,6 +502,9 @@ ICommunicationService::ICommunicationService(ncm::ProgramId program_id)
         this
     );
 
+    // Retry as soon as Wi-Fi comes back instead of at the end of the backoff
+    m_server_client.set_link_state_source({NifmLinkState, nullptr});
+
     // Start background thread for processing server pings
     // Uses static stack (g_background_thread_stack) to avoid class bloat
     m_background_thread_running = true;
@@ -196,70 +542,24 @@ ICommunicationService::~ICommunicationService() {
 // ============================================================================
 
 u64 ICommunicationService::LoadLocalCommunicationIdFromNacp() {
-    // Read the NACP from the application to get the real LocalCommunicationId
-    // This is what the Nintendo SDK does internally when LocalCommunicationId=-1
-    // See: https://switchbrew.org/wiki/LDN_services - "When -1, this is overwritten
-    // with the first LocalCommunicationId from the user-process NACP"
-
-    Result rc;
-    u64 local_comm_id = 0;
-
-    // Initialize ns service
-    rc = nsInitialize();
-    if (R_FAILED(rc)) {
-        LOG_ERROR("Failed to initialize ns service: 0x%x", rc);
-        // Fallback to program_id if ns fails
-        return m_program_id.value;
-    }
-
-    // Allocate buffer for control data (NACP + icon)
-    // NsApplicationControlData is large (~128KB) due to the icon, allocate on heap
-    NsApplicationControlData* control_data = static_cast<NsApplicationControlData*>(std::malloc(sizeof(NsApplicationControlData)));
-    if (!control_data) {
-        LOG_ERROR("Failed to allocate memory for NsApplicationControlData");
-        nsExit();
-        return m_program_id.value;
-    }
-
-    std::memset(control_data, 0, sizeof(NsApplicationControlData));
-
-    u64 actual_size = 0;
-    rc = nsGetApplicationControlData(
-        NsApplicationControlSource_Storage,
-        m_program_id.value,
-        control_data,
-        sizeof(NsApplicationControlData),
-        &actual_size
-    );
-
-    if (R_SUCCEEDED(rc) && actual_size >= sizeof(NacpStruct)) {
-        // Get the first LocalCommunicationId from NACP
-        local_comm_id = control_data->nacp.local_communication_id[0];
-        LOG_INFO("Read LocalCommunicationId[0] from NACP: 0x%016lx", local_comm_id);
-
-        // Log other LocalCommunicationIds if present (for debugging)
-        for (int i = 1; i < 8; i++) {
-            u64 other_id = control_data->nacp.local_communication_id[i];
-            if (other_id != 0) {
-                LOG_VERBOSE("LocalCommunicationId[%d]: 0x%016lx", i, other_id);
-            }
+    // The Nintendo SDK replaces LocalCommunicationId=-1 with the first
+    // LocalCommunicationId from the user-process NACP
+    // See: https://switchbrew.org/wiki/LDN_services
+    //
+    // The NACP rarely changes, so it is read once per title version and
+    // cached on the SD card instead of on every session
+    ryu_ldn::ldn::NacpCacheEntry entry;
+    if (!NacpCacheService::GetInstance().Resolve(m_program_id.value, m_client_pid, entry)) {
+        LOG_ERROR("NACP unavailable, using program_id as LocalCommunicationId");
+    }
+
+    for (size_t i = 1; i < entry.id_count; i++) {
+        if (entry.local_communication_ids[i] != 0) {
+            LOG_VERBOSE("LocalCommunicationId[%zu]: 0x%016lx", i, entry.local_communication_ids[i]);
         }
-    } else {
-        LOG_ERROR("Failed to get application control data: 0x%x (size=%lu)", rc, actual_size);
-        // Fallback to program_id
-        local_comm_id = m_program_id.value;
-    }
-
-    std::free(control_data);
-    nsExit();
-
-    // If LocalCommunicationId is 0 in NACP, fallback to program_id
-    if (local_comm_id == 0) {
-        LOG_INFO("NACP LocalCommunicationId is 0, using program_id as fallback");
-        local_comm_id = m_program_id.value;
     }
 
-    return local_comm_id;
+    return entry.primary_id();
 }
 
 // ============================================================================
@@ -332,8 +632,62 @@ Result ICommunicationService::ConnectToServer() {
         g_active_ldn_service = this;
     }
 
-    // Register the send callback with ProxySocketManager
-    mitm::bsd::ProxySocketManager::GetInstance().SetSendCallback(SendProxyDataCallback);
+    // Dual-path redundancy: options of this title, fresh peer/flow state
+    {
+        const auto& ldn_config = ryu_ldn::ipc::g_config.ldn;
+        ryu_ldn::ldn::RedundantPathConfig redundant_config{};
+        redundant_config.enabled = ldn_config.redundant_udp &&
+            ryu_ldn::ldn::redundant_title_selected(ldn_config.redundant_udp_titles, m_program_id.value);
+        redundant_config.budget_bytes_per_sec = ldn_config.redundant_udp_budget;
+        ryu_ldn::ldn::redundant_parse_ports(ldn_config.redundant_udp_ports, redundant_config);
+
+        std::scoped_lock lock(g_redundant_mutex);
+        g_redundant_path.configure(redundant_config);
+        g_redundant_path.reset();
+        if (redundant_config.enabled) {
+            LOG_INFO("Dual-path redundant UDP enabled (budget %u B/s)", redundant_config.budget_bytes_per_sec);
+        }
+    }
+
+    // Fan-out delegation: volunteer as delegate only with a known uplink
+    {
+        const auto& ldn_config = ryu_ldn::ipc::g_config.ldn;
+        ryu_ldn::p2p::RelayDelegationConfig relay_config{};
+        relay_config.enabled = ldn_config.relay_delegation;
+        relay_config.uplink_kbps = ldn_config.uplink_kbps;
+
+        std::scoped_lock lock(g_relay_mutex);
+        g_relay_member.configure(relay_config);
+        g_relay_member.reset();
+        g_relay_server_client = &m_server_client;
+    }
+
+    // Register the send callbacks with ProxySocketManager
+    auto& socket_manager = mitm::bsd::ProxySocketManager::GetInstance();
+
+    // Broadcast repeat filter: an empty exclude list excludes nothing
+    {
+        const auto& ldn_config = ryu_ldn::ipc::g_config.ldn;
+        bool excluded = ldn_config.broadcast_dedup_exclude[0] != '\0' &&
+            ryu_ldn::ldn::redundant_title_selected(ldn_config.broadcast_dedup_exclude, m_program_id.value);
+
+        mitm::bsd::BroadcastFilterConfig filter_config{};
+        filter_config.enabled = ldn_config.broadcast_dedup && !excluded;
+        filter_config.window_ms = ldn_config.broadcast_dedup_window_ms;
+        filter_config.keepalive_ms = ldn_config.broadcast_dedup_keepalive_ms;
+        socket_manager.ConfigureBroadcastFilter(filter_config);
+        if (filter_config.enabled) {
+            LOG_INFO("Broadcast repeat filter enabled (window %u ms, keepalive %u ms)",
+                     filter_config.window_ms, filter_config.keepalive_ms);
+        }
+    }
+
+    socket_manager.SetReceiveModeration(ryu_ldn::ipc::g_config.ldn.rx_moderation_us);
+
+    socket_manager.SetSendCallback(SendProxyDataCallback);
+    socket_manager.SetProxyConnectCallback(SendProxyConnectCallback);
+    socket_manager.SetOptimisticPeerCallback(IsOptimisticPeerCallback);
+    socket_manager.SetStreamWindowCallback(SendStreamWindowCallback);
 
     LOG_INFO("Connected to RyuLdn server successfully");
     R_SUCCEED();
@@ -354,8 +708,27 @@ void ICommunicationService::DisconnectFromServer() {
             }
         }
 
-        // Clear the send callback
-        mitm::bsd::ProxySocketManager::GetInstance().SetSendCallback(nullptr);
+        // Clear the send callbacks
+        auto& socket_manager = mitm::bsd::ProxySocketManager::GetInstance();
+        socket_manager.SetSendCallback(nullptr);
+        socket_manager.SetProxyConnectCallback(nullptr);
+        socket_manager.SetOptimisticPeerCallback(nullptr);
+        socket_manager.SetStreamWindowCallback(nullptr);
+
+        // Cost of the receive moderation so far (bucket bound, process-wide)
+        const auto& metrics = ryu_ldn::diagnostics::g_metrics;
+        if (metrics.proxy_rx_coalesced.Load() != 0) {
+            LOG_INFO("Receive moderation: %lu wakeups, %lu datagrams batched, p99 added delay <= %lu us",
+                     metrics.proxy_rx_wakeups.Load(), metrics.proxy_rx_coalesced.Load(),
+                     metrics.proxy_rx_moderation_us.QuantileBound(99));
+        }
+
+        // Delegates stop re-sending before the relay connection goes away
+        {
+            std::scoped_lock lock(g_relay_mutex);
+            g_relay_member.reset();
+            g_relay_server_client = nullptr;
+        }
 
         m_server_client.disconnect();
         m_server_connected = false;
@@ -417,6 +790,17 @@ Result ICommunicationService::Finalize() {
     m_ipv4_address = 0;
     m_subnet_mask = 0;
 
+    // Keep the IPC trace of the session that just ended, then start afresh
+    auto& recorder = ryu_ldn::diagnostics::g_ipc_recorder;
+    if (recorder.is_recording() && recorder.size() > 0) {
+        if (recorder.write_file(ryu_ldn::config::IPC_TRACE_PATH)) {
+            LOG_INFO("IPC trace written to %s", ryu_ldn::config::IPC_TRACE_PATH);
+        } else {
+            LOG_WARN("Cannot write IPC trace to %s", ryu_ldn::config::IPC_TRACE_PATH);
+        }
+        recorder.clear();
+    }
+
     R_SUCCEED();
 }
 
@@ -425,6 +809,7 @@ Result ICommunicationService::Finalize() {
 // ============================================================================
 
 Result ICommunicationService::GetState(ams::sf::Out<u32> state) {
+    LDN_IPC_TIMER(GetState);
     // Process incoming packets (like pings) to keep connection alive
     // This is critical because the server expects ping responses within ~6 seconds
     if (m_server_connected && m_server_client.is_connected()) {
@@ -448,6 +833,7 @@ Result ICommunicationService::GetState(ams::sf::Out<u32> state) {
 }
 
 Result ICommunicationService::GetNetworkInfo(ams::sf::Out<NetworkInfo> buffer) {
+    LDN_IPC_TIMER(GetNetworkInfo);
     // Process incoming packets (like pings) to keep connection alive
     if (m_server_connected && m_server_client.is_connected()) {
         uint64_t current_time_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
@@ -461,6 +847,7 @@ Result ICommunicationService::GetNetworkInfo(ams::sf::Out<NetworkInfo> buffer) {
 }
 
 Result ICommunicationService::GetIpv4Address(ams::sf::Out<u32> address, ams::sf::Out<u32> mask) {
+    LDN_IPC_TIMER(GetIpv4Address);
     // If connected to RyuLdn server and we have a proxy config, return the virtual IP
     // This is critical for LDN communication - the game needs to use the proxy IP
     if (m_server_connected && m_proxy_config.proxy_ip != 0) {
@@ -514,6 +901,7 @@ Result ICommunicationService::GetNetworkInfoLatestUpdate(
     ams::sf::Out<NetworkInfo> buffer,
     ams::sf::OutArray<NodeLatestUpdate> pUpdates)
 {
+    LDN_IPC_TIMER(GetNetworkInfoLatestUpdate);
     buffer.SetValue(m_network_info);
 
     // Clear updates - no changes to report yet
@@ -531,6 +919,7 @@ Result ICommunicationService::Scan(
     u16 channel,
     ScanFilter filter)
 {
+    LDN_IPC_TIMER(Scan);
     AMS_UNUSED(channel);
 
     // Replace LocalCommunicationId=-1 or 0 with real LocalCommunicationId from NACP
@@ -721,6 +1110,7 @@ Result ICommunicationService::CloseAccessPoint() {
 }
 
 Result ICommunicationService::CreateNetwork(CreateNetworkConfig data) {
+    LDN_IPC_TIMER(CreateNetwork);
     // Replace LocalCommunicationId=-1 with real LocalCommunicationId from NACP
     // See Ryujinx NeedsRealId handling - uses NACP LocalCommunicationId[0], not program_id
     u64 local_comm_id = data.networkConfig.intentId.localCommunicationId;
@@ -765,12 +1155,12 @@ Result ICommunicationService::CreateNetwork(CreateNetworkConfig data) {
     // Start P2P proxy server for hosting (like Ryujinx CreateNetworkAsync)
     // This allows direct P2P connections from joiners
     if (m_use_p2p_proxy && StartP2pProxyServer()) {
-        // Attempt UPnP NAT punch to open public port
+        // Attempt NAT punch (NAT-PMP/PCP or UPnP) to open public port
         uint16_t public_port = m_p2p_server->NatPunch();
 
         // Fill RyuNetworkConfig with P2P port information
         // Like Ryujinx: request.PrivateIp = GetLocalIPv4(), request.ExternalProxyPort = public_port
-        uint32_t local_ip = p2p::UpnpPortMapper::GetInstance().GetLocalIPv4();
+        uint32_t local_ip = p2p::PortMappingService::GetInstance().GetLocalIPv4();
 
         // Store local IP as 16-byte buffer (first 4 bytes for IPv4)
         std::memset(request.ryu_network_config.private_ip, 0, sizeof(request.ryu_network_config.private_ip));
@@ -837,6 +1227,7 @@ Result ICommunicationService::CreateNetwork(CreateNetworkConfig data) {
 }
 
 Result ICommunicationService::DestroyNetwork() {
+    LDN_IPC_TIMER(DestroyNetwork);
     LOG_INFO("DestroyNetwork() called");
 
     // Stop P2P server if running (host cleanup)
@@ -860,6 +1251,7 @@ Result ICommunicationService::DestroyNetwork() {
 }
 
 Result ICommunicationService::SetAdvertiseData(ams::sf::InAutoSelectBuffer data) {
+    LDN_IPC_TIMER(SetAdvertiseData);
     LOG_INFO("SetAdvertiseData() called, size=%zu", data.GetSize());
 
     // Store advertise data locally (like Ryujinx _advertiseData)
@@ -944,6 +1336,7 @@ Result ICommunicationService::CloseStation() {
 }
 
 Result ICommunicationService::Connect(ConnectNetworkData dat, const NetworkInfo& data) {
+    LDN_IPC_TIMER(Connect);
     // Replace LocalCommunicationId=-1 with real LocalCommunicationId from NACP
     // See Ryujinx NeedsRealId handling - uses NACP LocalCommunicationId[0], not program_id
     u64 local_comm_id = data.networkId.intentId.localCommunicationId;
@@ -1030,6 +1423,7 @@ Result ICommunicationService::Connect(ConnectNetworkData dat, const NetworkInfo&
 }
 
 Result ICommunicationService::Disconnect() {
+    LDN_IPC_TIMER(Disconnect);
     LOG_INFO("Disconnect() called");
 
     auto result = m_state_machine.Disconnect();
@@ -1079,6 +1473,7 @@ Result ICommunicationService::ScanPrivate(
 Result ICommunicationService::CreateNetworkPrivate(
         CreateNetworkPrivateConfig data,
         ams::sf::InPointerBuffer addressList) {
+    LDN_IPC_TIMER(CreateNetworkPrivate);
     R_UNLESS(IsServerConnected(), MAKERESULT(0x10, 2)); // Not connected
 
     auto result = m_state_machine.CreateNetwork();
@@ -1151,6 +1546,7 @@ Result ICommunicationService::CreateNetworkPrivate(
 }
 
 Result ICommunicationService::ConnectPrivate(ConnectPrivateData data) {
+    LDN_IPC_TIMER(ConnectPrivate);
     R_UNLESS(IsServerConnected(), MAKERESULT(0x10, 2)); // Not connected
 
     auto result = m_state_machine.Connect();
@@ -1524,10 +1920,19 @@ void ICommunicationService::HandleServerPacket(ryu_ldn::protocol::PacketId id, c
                                 static_cast<unsigned>(proxy_header->info.protocol),
                                 proxy_header->data_length);
 
+                    // A duplicated copy is flagged in its protocol field, clear it before routing
+                    ryu_ldn::protocol::ProxyInfo info = proxy_header->info;
+                    bool tagged = ryu_ldn::ldn::redundant_take_tag(info);
+
+                    // Flow control of a proxied TCP stream
+                    if (HandleStreamWindowUpdate(info, payload, proxy_header->data_length)) {
+                        break;
+                    }
+
                     // Convert protocol type for BSD layer
                     ryu_ldn::bsd::ProtocolType bsd_protocol;
                     bool protocol_valid = true;
-                    switch (proxy_header->info.protocol) {
+                    switch (info.protocol) {
                         case ryu_ldn::protocol::ProtocolType::Tcp:
                             bsd_protocol = ryu_ldn::bsd::ProtocolType::Tcp;
                             break;
@@ -1536,7 +1941,7 @@ void ICommunicationService::HandleServerPacket(ryu_ldn::protocol::PacketId id, c
                             break;
                         default:
                             LOG_WARN("ProxyData: unknown protocol type %u",
-                                     static_cast<unsigned>(proxy_header->info.protocol));
+                                     static_cast<unsigned>(info.protocol));
                             protocol_valid = false;
                             break;
                     }
@@ -1545,17 +1950,38 @@ void ICommunicationService::HandleServerPacket(ryu_ldn::protocol::PacketId id, c
                         break;
                     }
 
+                    // Last hop of a broadcast the P2P host delegated
+                    ryu_ldn::p2p::RelayControl relay_control;
+                    if (ryu_ldn::p2p::parse_relay_control(info, payload,
+                                                          proxy_header->data_length, relay_control)) {
+                        if (relay_control.type == ryu_ldn::p2p::RelayControlType::Forward) {
+                            HandleRelayedForward(info, payload, proxy_header->data_length);
+                        }
+                        break;
+                    }
+
+                    // Drop the second copy of a duplicated packet, consume control messages
+                    uint32_t data_length = proxy_header->data_length;
+                    bool reply_ack = false;
+                    if (!FilterRedundantProxyData(info, tagged, payload, data_length, reply_ack)) {
+                        if (reply_ack) {
+                            SendRedundantControl(info.dest_ipv4, info.source_ipv4,
+                                                 ryu_ldn::ldn::RedundantControlType::Ack);
+                        }
+                        break;
+                    }
+
                     // Route to BSD MITM proxy socket manager
                     // The manager finds the socket bound to the destination port and queues the data
                     auto& socket_manager = mitm::bsd::ProxySocketManager::GetInstance();
                     bool routed = socket_manager.RouteIncomingData(
-                        proxy_header->info.source_ipv4,
-                        proxy_header->info.source_port,
-                        proxy_header->info.dest_ipv4,
-                        proxy_header->info.dest_port,
+                        info.source_ipv4,
+                        info.source_port,
+                        info.dest_ipv4,
+                        info.dest_port,
                         bsd_protocol,
                         payload,
-                        proxy_header->data_length
+                        data_length
                     );
 
                     if (routed) {
@@ -1563,7 +1989,9 @@ void ICommunicationService::HandleServerPacket(ryu_ldn::protocol::PacketId id, c
                     } else {
                         // No matching proxy socket - fallback to legacy buffer for direct reads
                         LOG_VERBOSE("ProxyData: no matching proxy socket, storing in buffer");
-                        if (!m_proxy_buffer.Write(*proxy_header, payload, proxy_header->data_length)) {
+                        ryu_ldn::protocol::ProxyDataHeader routed_header = *proxy_header;
+                        routed_header.info = info;
+                        if (!m_proxy_buffer.Write(routed_header, payload, data_length)) {
                             LOG_WARN("ProxyData: buffer full, dropping packet");
                         }
                     }
@@ -1575,6 +2003,24 @@ void ICommunicationService::HandleServerPacket(ryu_ldn::protocol::PacketId id, c
             break;
         }
 
+        case ryu_ldn::protocol::PacketId::ProxyConnect: {
+            // A peer connects to one of our listening TCP sockets, answer on the relay
+            if (size >= sizeof(ryu_ldn::protocol::ProxyConnectRequest)) {
+                const auto* request = reinterpret_cast<const ryu_ldn::protocol::ProxyConnectRequest*>(data);
+                SendProxyConnectReplyToServer(RouteProxyConnect(*request));
+            }
+            break;
+        }
+
+        case ryu_ldn::protocol::PacketId::ProxyConnectReply: {
+            // Completes a classic connect, confirms or breaks an optimistic one
+            if (size >= sizeof(ryu_ldn::protocol::ProxyConnectResponse)) {
+                const auto* response = reinterpret_cast<const ryu_ldn::protocol::ProxyConnectResponse*>(data);
+                mitm::bsd::ProxySocketManager::GetInstance().RouteConnectResponse(*response);
+            }
+            break;
+        }
+
         default:
             LOG_VERBOSE("Unhandled packet type: %u", static_cast<unsigned>(id));
             break;
@@ -1694,10 +2140,43 @@ ryu_ldn::network::ClientOpResult ICommunicationService::SendProxyDataToServer(
                 header.info.dest_ipv4, header.info.dest_port,
                 static_cast<unsigned>(header.info.protocol), data_len);
 
+    bool p2p_ready = m_p2p_client != nullptr && m_p2p_client->IsReady();
+
+    // Dual-path redundancy: discover ryu_ldn_nx peers, duplicate small UDP packets
+    ryu_ldn::ldn::RedundantSendPlan plan;
+    {
+        uint64_t now_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
+        std::scoped_lock lock(g_redundant_mutex);
+        plan = g_redundant_path.plan_send(header.info, data_len, p2p_ready, now_ms);
+    }
+
+    if (plan.send_hello) {
+        SendRedundantControl(header.info.source_ipv4, header.info.dest_ipv4,
+                             ryu_ldn::ldn::RedundantControlType::Hello);
+    }
+
+    if (plan.duplicate) {
+        // Same tagged copy on both paths, the receiver keeps whichever arrives first
+        uint8_t tagged[ryu_ldn::ldn::REDUNDANT_MAX_PAYLOAD + sizeof(ryu_ldn::ldn::RedundantTrailer)];
+        std::memcpy(tagged, data, data_len);
+        std::memcpy(tagged + data_len, &plan.trailer, sizeof(plan.trailer));
+
+        ryu_ldn::protocol::ProxyDataHeader tagged_header = header;
+        tagged_header.info.protocol = ryu_ldn::ldn::redundant_tagged_protocol(header.info.protocol);
+        size_t tagged_len = data_len + sizeof(plan.trailer);
+        tagged_header.data_length = static_cast<uint32_t>(tagged_len);
+
+        bool p2p_sent = m_p2p_client->SendProxyData(tagged_header, tagged, tagged_len);
+        auto relay_result = m_server_client.send_proxy_data(tagged_header, tagged, tagged_len);
+        ryu_ldn::diagnostics::g_metrics.proxy_tx_duplicated.Add();
+        return p2p_sent ? ryu_ldn::network::ClientOpResult::Success : relay_result;
+    }
+
     // If P2P client is connected, send through P2P instead of master server
-    if (m_p2p_client != nullptr && m_p2p_client->IsReady()) {
+    if (p2p_ready) {
         LOG_VERBOSE("SendProxyDataToServer: routing via P2P client");
         if (m_p2p_client->SendProxyData(header, static_cast<const uint8_t*>(data), data_len)) {
+            ryu_ldn::diagnostics::g_metrics.proxy_tx_p2p.Add();
             return ryu_ldn::network::ClientOpResult::Success;
         }
         // Fall through to master server if P2P send fails
@@ -1707,6 +2186,66 @@ ryu_ldn::network::ClientOpResult ICommunicationService::SendProxyDataToServer(
     return m_server_client.send_proxy_data(header, static_cast<const uint8_t*>(data), data_len);
 }
 
+ryu_ldn::network::ClientOpResult ICommunicationService::SendProxyConnectToServer(
+    const ryu_ldn::protocol::ProxyConnectRequest& request)
+{
+    if (!IsServerConnected()) {
+        return ryu_ldn::network::ClientOpResult::NotConnected;
+    }
+
+    // Discover ryu_ldn_nx peers: once the Hello is answered, later connects are optimistic
+    bool send_hello;
+    {
+        uint64_t now_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
+        std::scoped_lock lock(g_redundant_mutex);
+        send_hello = g_redundant_path.plan_hello(request.info.dest_ipv4, now_ms);
+    }
+    if (send_hello) {
+        SendRedundantControl(request.info.source_ipv4, request.info.dest_ipv4,
+                             ryu_ldn::ldn::RedundantControlType::Hello);
+    }
+
+    // Same path as the TCP ProxyData, so that early data never overtakes it
+    if (m_p2p_client != nullptr && m_p2p_client->IsReady()) {
+        if (m_p2p_client->SendProxyConnect(request)) {
+            return ryu_ldn::network::ClientOpResult::Success;
+        }
+        LOG_WARN("P2P send failed, falling back to master server");
+    }
+
+    uint8_t packet[ryu_ldn::protocol::get_packet_size<ryu_ldn::protocol::ProxyConnectRequest>()];
+    size_t packet_size = 0;
+    ryu_ldn::protocol::encode(packet, sizeof(packet), ryu_ldn::protocol::PacketId::ProxyConnect,
+                              request, packet_size);
+    return m_server_client.send_raw_packet(packet, packet_size);
+}
+
+void ICommunicationService::SendProxyConnectReplyToServer(
+    const ryu_ldn::protocol::ProxyConnectResponse& response)
+{
+    uint8_t packet[ryu_ldn::protocol::get_packet_size<ryu_ldn::protocol::ProxyConnectResponse>()];
+    size_t packet_size = 0;
+    ryu_ldn::protocol::encode(packet, sizeof(packet), ryu_ldn::protocol::PacketId::ProxyConnectReply,
+                              response, packet_size);
+    m_server_client.send_raw_packet(packet, packet_size);
+}
+
+void ICommunicationService::SendRedundantControl(uint32_t source_ip, uint32_t dest_ip,
+                                                 ryu_ldn::ldn::RedundantControlType type) {
+    auto control = ryu_ldn::ldn::RedundantPath::make_control(type);
+
+    ryu_ldn::protocol::ProxyDataHeader header{};
+    header.info.source_ipv4 = source_ip;
+    header.info.source_port = ryu_ldn::ldn::REDUNDANT_CONTROL_PORT;
+    header.info.dest_ipv4 = dest_ip;
+    header.info.dest_port = ryu_ldn::ldn::REDUNDANT_CONTROL_PORT;
+    header.info.protocol = ryu_ldn::protocol::ProtocolType::Udp;
+    header.data_length = sizeof(control);
+
+    // Always the relay: it is the path every peer has
+    m_server_client.send_proxy_data(header, reinterpret_cast<const uint8_t*>(&control), sizeof(control));
+}
+
 // ============================================================================
 // P2P Proxy Methods
 // ============================================================================
@@ -1725,6 +2264,23 @@ void ICommunicationService::HandleExternalProxyConnect(
                               const void* data, size_t size) {
         // Route packets received from P2P host to BSD MITM
         // This is called from P2pProxyClient's receive thread
+        if (type == ryu_ldn::protocol::PacketId::ProxyConnect) {
+            if (size >= sizeof(ryu_ldn::protocol::ProxyConnectRequest)) {
+                const auto* request = reinterpret_cast<const ryu_ldn::protocol::ProxyConnectRequest*>(data);
+                auto response = RouteProxyConnect(*request);
+                if (g_p2p_receiving_client != nullptr) {
+                    g_p2p_receiving_client->SendProxyConnectReply(response);
+                }
+            }
+            return;
+        }
+        if (type == ryu_ldn::protocol::PacketId::ProxyConnectReply) {
+            if (size >= sizeof(ryu_ldn::protocol::ProxyConnectResponse)) {
+                const auto* response = reinterpret_cast<const ryu_ldn::protocol::ProxyConnectResponse*>(data);
+                mitm::bsd::ProxySocketManager::GetInstance().RouteConnectResponse(*response);
+            }
+            return;
+        }
         if (type == ryu_ldn::protocol::PacketId::ProxyData) {
             if (size >= sizeof(ryu_ldn::protocol::ProxyDataHeader)) {
                 const auto* proxy_header = reinterpret_cast<const ryu_ldn::protocol::ProxyDataHeader*>(data);
@@ -1732,9 +2288,17 @@ void ICommunicationService::HandleExternalProxyConnect(
                 size_t payload_size = size - sizeof(ryu_ldn::protocol::ProxyDataHeader);
 
                 if (payload_size >= proxy_header->data_length) {
+                    ryu_ldn::protocol::ProxyInfo info = proxy_header->info;
+                    bool tagged = ryu_ldn::ldn::redundant_take_tag(info);
+
+                    // Flow control of a proxied TCP stream
+                    if (HandleStreamWindowUpdate(info, payload, proxy_header->data_length)) {
+                        return;
+                    }
+
                     // Convert protocol type
                     ryu_ldn::bsd::ProtocolType bsd_protocol;
-                    switch (proxy_header->info.protocol) {
+                    switch (info.protocol) {
                         case ryu_ldn::protocol::ProtocolType::Tcp:
                             bsd_protocol = ryu_ldn::bsd::ProtocolType::Tcp;
                             break;
@@ -1745,32 +2309,66 @@ void ICommunicationService::HandleExternalProxyConnect(
                             return;
                     }
 
+                    // Fan-out delegation messages from the host
+                    ryu_ldn::p2p::RelayControl relay_control;
+                    if (ryu_ldn::p2p::parse_relay_control(info, payload,
+                                                          proxy_header->data_length, relay_control)) {
+                        HandleHostRelayControl(info, relay_control, payload,
+                                               proxy_header->data_length);
+                        return;
+                    }
+
+                    // Drop the second copy of a duplicated packet (control messages only use the relay)
+                    uint32_t data_length = proxy_header->data_length;
+                    bool reply_ack = false;
+                    if (!FilterRedundantProxyData(info, tagged, payload, data_length, reply_ack)) {
+                        return;
+                    }
+
                     // Route to BSD MITM
                     auto& socket_manager = mitm::bsd::ProxySocketManager::GetInstance();
                     socket_manager.RouteIncomingData(
-                        proxy_header->info.source_ipv4,
-                        proxy_header->info.source_port,
-                        proxy_header->info.dest_ipv4,
-                        proxy_header->info.dest_port,
+                        info.source_ipv4,
+                        info.source_port,
+                        info.dest_ipv4,
+                        info.dest_port,
                         bsd_protocol,
                         payload,
-                        proxy_header->data_length
+                        data_length
                     );
                 }
             }
         }
     };
 
+    // A new host knows nothing of a previous delegation
+    {
+        std::scoped_lock lock(g_relay_mutex);
+        g_relay_member.reset();
+    }
+
     // Create new P2P client
     m_p2p_client = new p2p::P2pProxyClient(packet_callback);
+    g_p2p_receiving_client = m_p2p_client;
+
+    // Same-LAN hosts are also asked for their private address: the external
+    // one only works if the router hairpins (see p2p/lan_discovery.hpp)
+    uint32_t lan_query_ip = 0;
+    if (ryu_ldn::ipc::g_config.ldn.lan_discovery) {
+        u32 addr, netmask, gateway, primary_dns, secondary_dns;
+        if (R_SUCCEEDED(nifmGetCurrentIpConfigInfo(&addr, &netmask, &gateway,
+                                                   &primary_dns, &secondary_dns))) {
+            lan_query_ip = ryu_ldn::p2p::lan_broadcast_address(ntohl(addr), ntohl(netmask));
+        }
+    }
 
-    // Connect to P2P host using IP from config
+    // Connect to P2P host using IP from config, authenticating with it
     // ExternalProxyConfig has proxy_ip[16] for IPv4/IPv6
     // address_family indicates IPv4 (2) or IPv6 (23)
     bool connected = false;
     if (config.address_family == 2) {  // AF_INET
-        // IPv4 address - first 4 bytes of proxy_ip
-        connected = m_p2p_client->Connect(config.proxy_ip, 4, config.proxy_port);
+        // IPv4 address - first 4 bytes of proxy_ip, raced against LAN replies
+        connected = m_p2p_client->Dial(config, lan_query_ip);
     } else {
         LOG_WARN("Unsupported address family: %u", config.address_family);
     }
@@ -1781,13 +2379,6 @@ void ICommunicationService::HandleExternalProxyConnect(
         return;
     }
 
-    // Perform authentication with ExternalProxyConfig
-    if (!m_p2p_client->PerformAuth(config)) {
-        LOG_ERROR("P2P authentication failed");
-        DisconnectP2pProxy();
-        return;
-    }
-
     // Wait for ProxyConfig response from host
     if (!m_p2p_client->EnsureProxyReady()) {
         LOG_ERROR("P2P proxy not ready (timeout waiting for ProxyConfig)");
@@ -1797,8 +2388,8 @@ void ICommunicationService::HandleExternalProxyConnect(
 
     // Store P2P proxy config
     m_proxy_config = m_p2p_client->GetProxyConfig();
-    LOG_INFO("P2P connection established: virtual_ip=0x%08X",
-             m_proxy_config.proxy_ip);
+    LOG_INFO("P2P connection established: virtual_ip=0x%08X (%s path)",
+             m_proxy_config.proxy_ip, m_p2p_client->IsLanPath() ? "LAN" : "external");
 }
 
 void ICommunicationService::DisconnectP2pProxy() {
@@ -1807,6 +2398,7 @@ void ICommunicationService::DisconnectP2pProxy() {
         m_p2p_client->Disconnect();
         delete m_p2p_client;
         m_p2p_client = nullptr;
+        g_p2p_receiving_client = nullptr;
     }
 }
 
@@ -1838,6 +2430,15 @@ bool ICommunicationService::StartP2pProxyServer() {
     };
     m_p2p_server = new p2p::P2pProxyServer(master_send_callback, this);
 
+    // Same-LAN joiners may authenticate from any address of our subnet
+    if (ryu_ldn::ipc::g_config.ldn.lan_discovery) {
+        u32 addr, netmask, gateway, primary_dns, secondary_dns;
+        if (R_SUCCEEDED(nifmGetCurrentIpConfigInfo(&addr, &netmask, &gateway,
+                                                   &primary_dns, &secondary_dns))) {
+            m_p2p_server->SetLanDiscovery(true, ntohl(addr), ntohl(netmask));
+        }
+    }
+
     // Start listening on an available port
     if (!m_p2p_server->Start()) {
         LOG_ERROR("StartP2pProxyServer: failed to start TCP server");
@@ -1845,6 +2446,11 @@ bool ICommunicationService::StartP2pProxyServer() {
         return false;
     }
 
+    ryu_ldn::p2p::RelayDelegationConfig relay_config{};
+    relay_config.enabled = ryu_ldn::ipc::g_config.ldn.relay_delegation;
+    relay_config.uplink_kbps = ryu_ldn::ipc::g_config.ldn.uplink_kbps;
+    m_p2p_server->ConfigureRelayDelegation(relay_config);
+
     LOG_INFO("StartP2pProxyServer: server started on port %u",
              m_p2p_server->GetPrivatePort());
     return true;
@@ -1882,10 +2488,63 @@ void ICommunicationService::HandleExternalProxyToken(
 // ============================================================================
 
 void ICommunicationService::BackgroundThreadEntry(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::LdnBackground);
     auto* self = static_cast<ICommunicationService*>(arg);
     self->BackgroundThreadFunc();
 }
 
+/**
+ * @brief Fan-out delegation tick: uplink report to the P2P host, host planning
+ *
+ * Under g_active_service_mutex, which is held while the P2P client and
+ * server are torn down.
+ */
+void ICommunicationService::UpdateRelayDelegation(uint64_t now_ms) {
+    std::scoped_lock lock(g_active_service_mutex);
+    if (g_active_ldn_service != this) {
+        return;
+    }
+
+    if (m_p2p_client != nullptr && m_p2p_client->IsReady()) {
+        ryu_ldn::p2p::RelayControl report;
+        bool report_due;
+        {
+            std::scoped_lock relay_lock(g_relay_mutex);
+            report_due = g_relay_member.make_report(
+                ryu_ldn::diagnostics::g_metrics.proxy_tx_bytes.Load(), now_ms, report);
+        }
+        if (report_due) {
+            ryu_ldn::protocol::ProxyDataHeader header{};
+            header.info.source_ipv4 = m_proxy_config.proxy_ip;
+            header.info.source_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+            header.info.dest_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+            header.info.protocol = ryu_ldn::protocol::ProtocolType::Udp;
+            header.data_length = sizeof(report);
+            m_p2p_client->SendProxyData(header, reinterpret_cast<const uint8_t*>(&report), sizeof(report));
+        }
+    }
+
+    if (m_p2p_server != nullptr) {
+        m_p2p_server->UpdateRelayDelegation();
+    }
+}
+
+void ICommunicationService::WritePendingFlightDump() {
+    auto& recorder = ryu_ldn::diagnostics::g_flight_recorder;
+    if (!recorder.has_pending()) {
+        return;
+    }
+
+    char path[64];
+    std::snprintf(path, sizeof(path), ryu_ldn::config::FLIGHT_DUMP_PATH_FORMAT,
+                  recorder.dumps() % ryu_ldn::diagnostics::FLIGHT_DUMP_FILES);
+    if (recorder.write_pending(path)) {
+        LOG_INFO("Latency spike, flight recorder written to %s", path);
+    } else {
+        LOG_WARN("Cannot write flight recorder to %s", path);
+    }
+}
+
 void ICommunicationService::BackgroundThreadFunc() {
     LOG_VERBOSE("Background thread started");
 
@@ -1899,11 +2558,20 @@ void ICommunicationService::BackgroundThreadFunc() {
             // Also check inactivity timeout
             m_inactivity_timeout.CheckTimeout(current_time_ms);
             m_client_mutex.Unlock();
+
+            UpdateRelayDelegation(current_time_ms);
+            ryu_ldn::diagnostics::g_metrics_history.sample(ryu_ldn::diagnostics::g_metrics, current_time_ms);
         }
 
+        WritePendingFlightDump();
+
+        // A reader that drained its queue no longer retries a failed window update
+        mitm::bsd::ProxySocketManager::GetInstance().RetryStreamWindows();
+
         // Sleep 100ms between checks - fast enough to respond to pings
         // (server pings after 10s of inactivity, so 100ms is plenty)
         svcSleepThread(100 * 1000000ULL);  // 100ms
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
     }
 
     LOG_VERBOSE("Background thread stopped");
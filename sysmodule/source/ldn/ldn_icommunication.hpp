@@ -18,6 +18,7 @@
 #include "ldn_node_mapper.hpp"
 #include "ldn_proxy_buffer.hpp"
 #include "ldn_network_timeout.hpp"
+#include "redundant_path.hpp"
 #include "interfaces/icommunication.hpp"
 #include "../network/client.hpp"
 #include "../p2p/p2p_proxy_client.hpp"
@@ -49,8 +50,9 @@ public:
      * @brief Constructor
      *
      * @param program_id Program ID of the client process (used to replace LocalCommunicationId=-1)
+     * @param client_pid Process ID of the client (used to read its NACP)
      */
-    explicit ICommunicationService(ncm::ProgramId program_id);
+    ICommunicationService(ncm::ProgramId program_id, u64 client_pid);
 
     /**
      * @brief Destructor
@@ -427,17 +429,30 @@ private:
      */
     void BackgroundThreadFunc();
 
+    /**
+     * @brief Broadcast fan-out delegation tick (guest report, host planning)
+     * @param now_ms Monotonic time
+     */
+    void UpdateRelayDelegation(uint64_t now_ms);
+
+    /**
+     * @brief Write the flight recorder dump if a latency spike froze it
+     */
+    void WritePendingFlightDump();
+
     // Program ID for LocalCommunicationId replacement (like Ryujinx NeedsRealId handling)
     ncm::ProgramId m_program_id;                            ///< Client program ID (title ID)
+    u64 m_client_pid;                                       ///< Client process ID (for NACP lookup)
     u64 m_local_communication_id;                           ///< LocalCommunicationId from NACP (for LDN filtering)
 
     /**
      * @brief Load LocalCommunicationId from NACP
      *
-     * Reads the application's NACP to get the first LocalCommunicationId.
-     * This is the ID used by LDN for game filtering, which may differ from program_id.
+     * Gets the first LocalCommunicationId of the application's NACP through
+     * NacpCacheService. This is the ID used by LDN for game filtering, which
+     * may differ from program_id.
      *
-     * @return First LocalCommunicationId from NACP, or 0 on failure
+     * @return First LocalCommunicationId from NACP, or program_id if unavailable
      */
     u64 LoadLocalCommunicationIdFromNacp();
 
@@ -506,6 +521,23 @@ private:
      */
     void HandleExternalProxyToken(const ryu_ldn::protocol::ExternalProxyToken& token);
 
+    /**
+     * @brief Send a dual-path control message through the relay
+     *
+     * @param source_ip Our virtual IP
+     * @param dest_ip Peer virtual IP
+     * @param type Hello or Ack
+     */
+    void SendRedundantControl(uint32_t source_ip, uint32_t dest_ip,
+                              ryu_ldn::ldn::RedundantControlType type);
+
+    /**
+     * @brief Answer a ProxyConnect received from the relay
+     *
+     * @param response Request addressing, protocol Unspecified if accepted
+     */
+    void SendProxyConnectReplyToServer(const ryu_ldn::protocol::ProxyConnectResponse& response);
+
 public:
     /**
      * @brief Send ProxyData to server (for BSD MITM callback)
@@ -522,6 +554,18 @@ public:
         const ryu_ldn::protocol::ProxyDataHeader& header,
         const void* data,
         size_t data_len);
+
+    /**
+     * @brief Send ProxyConnect (for BSD MITM callback)
+     *
+     * Goes on the same path as TCP ProxyData (P2P if ready, else the relay)
+     * and sends a Hello to a peer not yet known to run ryu_ldn_nx.
+     *
+     * @param request Addressing of the connection
+     * @return ClientOpResult indicating success or failure
+     */
+    ryu_ldn::network::ClientOpResult SendProxyConnectToServer(
+        const ryu_ldn::protocol::ProxyConnectRequest& request);
 };
 
 // Verify interface compliance
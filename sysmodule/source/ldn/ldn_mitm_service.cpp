@@ -45,7 +45,7 @@ Result LdnMitMService::CreateUserLocalCommunicationService(
     LOG_INFO("Creating UserLocalCommunicationService for program_id=0x%016lx", m_program_id.value);
     // Create our custom communication service with the client's program ID
     // The program_id is used to replace LocalCommunicationId=-1 with the real title ID
-    auto service = sf::CreateSharedObjectEmplaced<ICommunicationInterface, ICommunicationService>(m_program_id);
+    auto service = sf::CreateSharedObjectEmplaced<ICommunicationInterface, ICommunicationService>(m_program_id, m_client_pid);
     out.SetValue(std::move(service));
     R_SUCCEED();
 }
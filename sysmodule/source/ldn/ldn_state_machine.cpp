@@ -7,6 +7,7 @@
  */
 
 #include "ldn_state_machine.hpp"
+#include "../diagnostics/flight_recorder.hpp"
 
 namespace ams::mitm::ldn {
 
@@ -64,6 +65,7 @@ StateTransitionResult LdnStateMachine::Initialize() {
     CommState old_state = m_state;
     m_state = CommState::Initialized;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -82,6 +84,7 @@ StateTransitionResult LdnStateMachine::Finalize() {
     CommState old_state = m_state;
     m_state = CommState::None;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -103,6 +106,7 @@ StateTransitionResult LdnStateMachine::OpenAccessPoint() {
     CommState old_state = m_state;
     m_state = CommState::AccessPoint;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -124,6 +128,7 @@ StateTransitionResult LdnStateMachine::CloseAccessPoint() {
     CommState old_state = m_state;
     m_state = CommState::Initialized;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -145,6 +150,7 @@ StateTransitionResult LdnStateMachine::CreateNetwork() {
     CommState old_state = m_state;
     m_state = CommState::AccessPointCreated;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -166,6 +172,7 @@ StateTransitionResult LdnStateMachine::DestroyNetwork() {
     CommState old_state = m_state;
     m_state = CommState::AccessPoint;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -187,6 +194,7 @@ StateTransitionResult LdnStateMachine::OpenStation() {
     CommState old_state = m_state;
     m_state = CommState::Station;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -208,6 +216,7 @@ StateTransitionResult LdnStateMachine::CloseStation() {
     CommState old_state = m_state;
     m_state = CommState::Initialized;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -229,6 +238,7 @@ StateTransitionResult LdnStateMachine::Connect() {
     CommState old_state = m_state;
     m_state = CommState::StationConnected;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -250,6 +260,7 @@ StateTransitionResult LdnStateMachine::Disconnect() {
     CommState old_state = m_state;
     m_state = CommState::Station;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -268,6 +279,7 @@ StateTransitionResult LdnStateMachine::SetError() {
     CommState old_state = m_state;
     m_state = CommState::Error;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -332,6 +344,7 @@ StateTransitionResult LdnStateMachine::TransitionTo(CommState new_state) {
     CommState old_state = m_state;
     m_state = new_state;
     SignalStateChange();
+    RecordTransition(old_state);
 
     if (m_callback) {
         m_callback(old_state, m_state, m_callback_user_data);
@@ -378,4 +391,10 @@ void LdnStateMachine::SignalStateChange() {
     m_state_event.Signal();
 }
 
+void LdnStateMachine::RecordTransition(CommState old_state) {
+    ryu_ldn::diagnostics::g_flight_recorder.state_change(
+        ryu_ldn::diagnostics::FlightStateMachine::Ldn,
+        static_cast<uint32_t>(old_state), static_cast<uint32_t>(m_state));
+}
+
 } // namespace ams::mitm::ldn
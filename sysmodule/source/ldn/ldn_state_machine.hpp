@@ -237,6 +237,12 @@ private:
      */
     static bool IsValidTransition(CommState from, CommState to);
 
+    /**
+     * @brief Add a completed transition to the flight recorder
+     * @param old_state State before the transition (m_state is the new one)
+     */
+    void RecordTransition(CommState old_state);
+
 private:
     mutable os::SdkMutex m_mutex;           ///< Mutex for thread safety
     CommState m_state;                       ///< Current state
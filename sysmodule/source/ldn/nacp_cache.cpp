@@ -0,0 +1,404 @@
+/**
+ * @file nacp_cache.cpp
+ * @brief Program ID -> NACP LDN metadata cache
+ *
+ * On Nintendo Switch, file access goes through ams::fs like config.cpp.
+ * For testing on PC, uses standard C file I/O.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "nacp_cache.hpp"
+#include <cstring>
+#include <cstdio>
+#include <new>
+
+#ifdef __SWITCH__
+#include <stratosphere.hpp>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace ryu_ldn::ldn {
+
+namespace {
+
+constexpr uint8_t ENTRY_FLAG_LDN_CAPABLE = 0x01;
+
+void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = static_cast<uint8_t>(v >> (i * 8));
+    }
+}
+
+void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = static_cast<uint8_t>(v >> (i * 8));
+    }
+}
+
+uint16_t get_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+/**
+ * @brief FNV-1a 32-bit, enough to reject a truncated or corrupted file
+ */
+uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+bool same_content(const NacpCacheEntry& a, const NacpCacheEntry& b) {
+    if (a.program_id != b.program_id || a.title_version != b.title_version ||
+        a.ldn_capable != b.ldn_capable || a.id_count != b.id_count) {
+        return false;
+    }
+    for (uint8_t i = 0; i < a.id_count; i++) {
+        if (a.local_communication_ids[i] != b.local_communication_ids[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Create the parent directory of path
+ */
+void ensure_parent_directory(const char* path) {
+    char dir_path[256];
+    std::snprintf(dir_path, sizeof(dir_path), "%s", path);
+
+    char* last_slash = std::strrchr(dir_path, '/');
+    if (last_slash) {
+        *last_slash = '\0';
+#ifdef __SWITCH__
+        ams::fs::EnsureDirectory(dir_path);
+#else
+        mkdir(dir_path, 0755);
+#endif
+    }
+}
+
+/**
+ * @brief Read a whole file (up to buffer_size bytes)
+ *
+ * @return Bytes read, 0 if missing, empty or unreadable
+ */
+size_t read_file(const char* path, uint8_t* buffer, size_t buffer_size) {
+#ifdef __SWITCH__
+    ams::fs::DirectoryEntryType entry_type;
+    if (R_FAILED(ams::fs::GetEntryType(&entry_type, path)) ||
+        entry_type != ams::fs::DirectoryEntryType_File) {
+        return 0;
+    }
+
+    ams::fs::FileHandle file;
+    if (R_FAILED(ams::fs::OpenFile(&file, path, ams::fs::OpenMode_Read))) {
+        return 0;
+    }
+
+    s64 file_size = 0;
+    size_t bytes_read = 0;
+    if (R_FAILED(ams::fs::GetFileSize(&file_size, file)) ||
+        file_size <= 0 || static_cast<size_t>(file_size) > buffer_size ||
+        R_FAILED(ams::fs::ReadFile(&bytes_read, file, 0, buffer, static_cast<size_t>(file_size)))) {
+        bytes_read = 0;
+    }
+    ams::fs::CloseFile(file);
+    return bytes_read;
+#else
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    size_t bytes_read = std::fread(buffer, 1, buffer_size, file);
+    // Larger than any valid cache: treat as corrupt
+    if (bytes_read == buffer_size && std::fgetc(file) != EOF) {
+        bytes_read = 0;
+    }
+    std::fclose(file);
+    return bytes_read;
+#endif
+}
+
+/**
+ * @brief Replace path with the given content
+ */
+bool write_file(const char* path, const uint8_t* data, size_t size) {
+    ensure_parent_directory(path);
+
+#ifdef __SWITCH__
+    ams::fs::DirectoryEntryType entry_type;
+    if (R_SUCCEEDED(ams::fs::GetEntryType(&entry_type, path))) {
+        ams::fs::DeleteFile(path);
+    }
+
+    if (R_FAILED(ams::fs::CreateFile(path, static_cast<s64>(size)))) {
+        return false;
+    }
+
+    ams::fs::FileHandle file;
+    if (R_FAILED(ams::fs::OpenFile(&file, path, ams::fs::OpenMode_Write))) {
+        return false;
+    }
+
+    ams::Result write_result = ams::fs::WriteFile(file, 0, data, size, ams::fs::WriteOption::Flush);
+    ams::fs::CloseFile(file);
+    return R_SUCCEEDED(write_result);
+#else
+    FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(data, 1, size, file) == size;
+    ok = (std::fclose(file) == 0) && ok;
+    return ok;
+#endif
+}
+
+} // namespace
+
+// ============================================================================
+// NacpCacheEntry
+// ============================================================================
+
+NacpCacheEntry NacpCacheEntry::FromNacp(uint64_t program_id, uint32_t title_version,
+                                        const uint64_t (&nacp_ids)[NACP_LOCAL_COMMUNICATION_ID_COUNT]) {
+    NacpCacheEntry entry{};
+    entry.program_id = program_id;
+    entry.title_version = title_version;
+
+    // Keep positions (games index into this array), only trailing zeros are dropped
+    for (size_t i = 0; i < NACP_LOCAL_COMMUNICATION_ID_COUNT; i++) {
+        entry.local_communication_ids[i] = nacp_ids[i];
+        if (nacp_ids[i] != 0) {
+            entry.id_count = static_cast<uint8_t>(i + 1);
+        }
+    }
+    entry.ldn_capable = entry.id_count > 0;
+    return entry;
+}
+
+// ============================================================================
+// NacpCache
+// ============================================================================
+
+NacpCache::NacpCache()
+    : m_entries{}
+    , m_last_used{}
+    , m_count(0)
+    , m_clock(0)
+    , m_dirty(false)
+{
+}
+
+int NacpCache::index_of(uint64_t program_id) const {
+    for (size_t i = 0; i < m_count; i++) {
+        if (m_entries[i].program_id == program_id) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+const NacpCacheEntry* NacpCache::find(uint64_t program_id) {
+    int index = index_of(program_id);
+    if (index < 0) {
+        return nullptr;
+    }
+    m_last_used[index] = ++m_clock;
+    return &m_entries[index];
+}
+
+void NacpCache::store(const NacpCacheEntry& entry) {
+    int index = index_of(entry.program_id);
+
+    if (index < 0) {
+        if (m_count < NACP_CACHE_MAX_ENTRIES) {
+            index = static_cast<int>(m_count++);
+        } else {
+            // Evict the least recently used title
+            index = 0;
+            for (size_t i = 1; i < m_count; i++) {
+                if (m_last_used[i] < m_last_used[index]) {
+                    index = static_cast<int>(i);
+                }
+            }
+        }
+    } else if (same_content(m_entries[index], entry)) {
+        // Unchanged, no need to rewrite the file
+        m_last_used[index] = ++m_clock;
+        return;
+    }
+
+    m_entries[index] = entry;
+    m_last_used[index] = ++m_clock;
+    m_dirty = true;
+}
+
+bool NacpCache::erase(uint64_t program_id) {
+    int index = index_of(program_id);
+    if (index < 0) {
+        return false;
+    }
+
+    // Keep the table dense: move the last entry into the hole
+    m_count--;
+    m_entries[index] = m_entries[m_count];
+    m_last_used[index] = m_last_used[m_count];
+    m_dirty = true;
+    return true;
+}
+
+void NacpCache::clear() {
+    m_dirty = m_dirty || m_count > 0;
+    m_count = 0;
+}
+
+size_t NacpCache::serialize(uint8_t* buffer, size_t buffer_size) {
+    if (buffer == nullptr || buffer_size < NACP_CACHE_HEADER_SIZE) {
+        return 0;
+    }
+
+    size_t offset = NACP_CACHE_HEADER_SIZE;
+    for (size_t i = 0; i < m_count; i++) {
+        const NacpCacheEntry& entry = m_entries[i];
+        size_t entry_size = NACP_CACHE_ENTRY_FIXED_SIZE + entry.id_count * sizeof(uint64_t);
+        if (offset + entry_size > buffer_size) {
+            return 0;
+        }
+
+        uint8_t* p = buffer + offset;
+        put_u64(p, entry.program_id);
+        put_u32(p + 8, entry.title_version);
+        p[12] = entry.ldn_capable ? ENTRY_FLAG_LDN_CAPABLE : 0;
+        p[13] = entry.id_count;
+        for (uint8_t id = 0; id < entry.id_count; id++) {
+            put_u64(p + NACP_CACHE_ENTRY_FIXED_SIZE + id * sizeof(uint64_t),
+                    entry.local_communication_ids[id]);
+        }
+        offset += entry_size;
+    }
+
+    put_u32(buffer, NACP_CACHE_MAGIC);
+    put_u16(buffer + 4, static_cast<uint16_t>(m_count));
+    put_u16(buffer + 6, 0);
+    put_u32(buffer + 8, checksum(buffer + NACP_CACHE_HEADER_SIZE, offset - NACP_CACHE_HEADER_SIZE));
+
+    m_dirty = false;
+    return offset;
+}
+
+bool NacpCache::deserialize(const uint8_t* buffer, size_t buffer_size) {
+    m_count = 0;
+    m_dirty = false;
+
+    if (buffer == nullptr || buffer_size < NACP_CACHE_HEADER_SIZE ||
+        get_u32(buffer) != NACP_CACHE_MAGIC) {
+        return false;
+    }
+
+    size_t entry_count = get_u16(buffer + 4);
+    if (entry_count > NACP_CACHE_MAX_ENTRIES ||
+        get_u32(buffer + 8) != checksum(buffer + NACP_CACHE_HEADER_SIZE,
+                                        buffer_size - NACP_CACHE_HEADER_SIZE)) {
+        return false;
+    }
+
+    size_t offset = NACP_CACHE_HEADER_SIZE;
+    for (size_t i = 0; i < entry_count; i++) {
+        if (offset + NACP_CACHE_ENTRY_FIXED_SIZE > buffer_size) {
+            m_count = 0;
+            return false;
+        }
+
+        const uint8_t* p = buffer + offset;
+        NacpCacheEntry entry{};
+        entry.program_id = get_u64(p);
+        entry.title_version = get_u32(p + 8);
+        entry.ldn_capable = (p[12] & ENTRY_FLAG_LDN_CAPABLE) != 0;
+        entry.id_count = p[13];
+
+        size_t entry_size = NACP_CACHE_ENTRY_FIXED_SIZE + entry.id_count * sizeof(uint64_t);
+        if (entry.id_count > NACP_LOCAL_COMMUNICATION_ID_COUNT || offset + entry_size > buffer_size) {
+            m_count = 0;
+            return false;
+        }
+        for (uint8_t id = 0; id < entry.id_count; id++) {
+            entry.local_communication_ids[id] =
+                get_u64(p + NACP_CACHE_ENTRY_FIXED_SIZE + id * sizeof(uint64_t));
+        }
+
+        m_entries[m_count] = entry;
+        m_last_used[m_count] = 0;
+        m_count++;
+        offset += entry_size;
+    }
+
+    if (offset != buffer_size) {
+        m_count = 0;
+        return false;
+    }
+    return true;
+}
+
+bool NacpCache::load(const char* path) {
+    uint8_t* buffer = new (std::nothrow) uint8_t[NACP_CACHE_MAX_FILE_SIZE];
+    if (buffer == nullptr) {
+        return false;
+    }
+
+    size_t size = read_file(path, buffer, NACP_CACHE_MAX_FILE_SIZE);
+    bool ok = size > 0 && deserialize(buffer, size);
+    if (!ok) {
+        m_count = 0;
+    }
+
+    delete[] buffer;
+    return ok;
+}
+
+bool NacpCache::save(const char* path) {
+    uint8_t* buffer = new (std::nothrow) uint8_t[NACP_CACHE_MAX_FILE_SIZE];
+    if (buffer == nullptr) {
+        return false;
+    }
+
+    size_t size = serialize(buffer, NACP_CACHE_MAX_FILE_SIZE);
+    bool ok = size > 0 && write_file(path, buffer, size);
+    if (!ok) {
+        m_dirty = true;
+    }
+
+    delete[] buffer;
+    return ok;
+}
+
+} // namespace ryu_ldn::ldn
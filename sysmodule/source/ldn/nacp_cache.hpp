@@ -0,0 +1,191 @@
+/**
+ * @file nacp_cache.hpp
+ * @brief Program ID -> NACP LDN metadata cache with a compact on-disk format
+ *
+ * Every ldn:u session needs the first LocalCommunicationId from the game's
+ * NACP. Reading it costs an ns/arp round trip and a large control data
+ * buffer, for 64 bytes of information that only change with a title update.
+ * NacpCache keeps those bytes per program ID, plus the title version they
+ * were read from so a stale entry can be detected and refreshed.
+ *
+ * ## File Format (little endian)
+ *
+ * ```
+ * Offset  Size  Field
+ * 0x00    4     magic ("RNC1")
+ * 0x04    2     entry_count
+ * 0x06    2     reserved
+ * 0x08    4     checksum (FNV-1a 32 of everything after the header)
+ * 0x0C    ...   entries
+ *
+ * Entry:
+ * 0x00    8     program_id
+ * 0x08    4     title_version
+ * 0x0C    1     flags (bit 0: LDN capable)
+ * 0x0D    1     id_count (0-8)
+ * 0x0E    8*n   local_communication_ids (up to the last non-zero id)
+ * ```
+ *
+ * A typical entry is 22 bytes; a full cache fits in a few KB.
+ *
+ * ## Usage Example
+ *
+ * ```cpp
+ * NacpCache cache;
+ * cache.load("sdmc:/config/ryu_ldn_nx/nacp_cache.bin");
+ *
+ * if (const NacpCacheEntry* entry = cache.find(program_id)) {
+ *     use(entry->primary_id());
+ * } else {
+ *     cache.store(read_from_nacp(program_id));
+ *     cache.save("sdmc:/config/ryu_ldn_nx/nacp_cache.bin");
+ * }
+ * ```
+ *
+ * ## Thread Safety
+ *
+ * NOT thread-safe. The console wrapper (NacpCacheService) serializes access.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ryu_ldn::ldn {
+
+/**
+ * @brief Number of LocalCommunicationIds in a NACP
+ */
+constexpr size_t NACP_LOCAL_COMMUNICATION_ID_COUNT = 8;
+
+/**
+ * @brief Maximum number of titles kept (least recently used is evicted)
+ */
+constexpr size_t NACP_CACHE_MAX_ENTRIES = 64;
+
+/**
+ * @brief Magic at the start of the cache file ("RNC1")
+ */
+constexpr uint32_t NACP_CACHE_MAGIC = 0x31434E52;
+
+/**
+ * @brief Size of the file header in bytes
+ */
+constexpr size_t NACP_CACHE_HEADER_SIZE = 12;
+
+/**
+ * @brief Size of one serialized entry without its ids
+ */
+constexpr size_t NACP_CACHE_ENTRY_FIXED_SIZE = 14;
+
+/**
+ * @brief Largest possible serialized cache
+ */
+constexpr size_t NACP_CACHE_MAX_FILE_SIZE =
+    NACP_CACHE_HEADER_SIZE +
+    NACP_CACHE_MAX_ENTRIES * (NACP_CACHE_ENTRY_FIXED_SIZE + NACP_LOCAL_COMMUNICATION_ID_COUNT * 8);
+
+/**
+ * @brief LDN metadata of one title
+ */
+struct NacpCacheEntry {
+    uint64_t program_id;
+    uint32_t title_version;                                            ///< Version the ids were read from
+    bool     ldn_capable;                                              ///< NACP declares at least one id
+    uint8_t  id_count;                                                 ///< Valid entries in local_communication_ids
+    uint64_t local_communication_ids[NACP_LOCAL_COMMUNICATION_ID_COUNT];
+
+    /**
+     * @brief Build an entry from the raw NACP id array
+     *
+     * Ids keep their NACP index; trailing zero ids are not counted.
+     */
+    static NacpCacheEntry FromNacp(uint64_t program_id, uint32_t title_version,
+                                   const uint64_t (&nacp_ids)[NACP_LOCAL_COMMUNICATION_ID_COUNT]);
+
+    /**
+     * @brief Id used for LocalCommunicationId=-1: NACP id 0, or the program ID if unset
+     */
+    uint64_t primary_id() const {
+        return (id_count > 0 && local_communication_ids[0] != 0) ? local_communication_ids[0]
+                                                                 : program_id;
+    }
+};
+
+/**
+ * @brief Fixed-capacity LRU table of NacpCacheEntry
+ */
+class NacpCache {
+public:
+    NacpCache();
+
+    /**
+     * @brief Look up a title and mark it as recently used
+     *
+     * @return Entry, or nullptr if not cached. Valid until the next store().
+     */
+    const NacpCacheEntry* find(uint64_t program_id);
+
+    /**
+     * @brief Insert or replace a title, evicting the least recently used one if full
+     */
+    void store(const NacpCacheEntry& entry);
+
+    /**
+     * @brief Drop a title
+     * @return true if it was cached
+     */
+    bool erase(uint64_t program_id);
+
+    /**
+     * @brief Drop everything
+     */
+    void clear();
+
+    size_t size() const { return m_count; }
+
+    /**
+     * @brief Whether the table changed since the last load/save/serialize
+     */
+    bool dirty() const { return m_dirty; }
+
+    /**
+     * @brief Write the file format into buffer
+     *
+     * @return Bytes written, 0 if buffer is too small
+     */
+    size_t serialize(uint8_t* buffer, size_t buffer_size);
+
+    /**
+     * @brief Replace the table with the content of buffer
+     *
+     * @return false if the magic, checksum or layout is invalid (table left empty)
+     */
+    bool deserialize(const uint8_t* buffer, size_t buffer_size);
+
+    /**
+     * @brief Load the cache file
+     *
+     * @return false if missing or invalid (table left empty)
+     */
+    bool load(const char* path);
+
+    /**
+     * @brief Write the cache file, creating its directory if needed
+     *
+     * @return false on I/O error
+     */
+    bool save(const char* path);
+
+private:
+    int index_of(uint64_t program_id) const;
+
+    NacpCacheEntry m_entries[NACP_CACHE_MAX_ENTRIES];
+    uint32_t m_last_used[NACP_CACHE_MAX_ENTRIES];   ///< LRU stamps
+    size_t m_count;
+    uint32_t m_clock;                               ///< Next LRU stamp
+    bool m_dirty;
+};
+
+} // namespace ryu_ldn::ldn
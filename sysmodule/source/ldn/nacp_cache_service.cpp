@@ -0,0 +1,198 @@
+/**
+ * @file nacp_cache_service.cpp
+ * @brief Console NACP metadata cache backed by arp and the SD card
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "nacp_cache_service.hpp"
+#include "../debug/log.hpp"
+#include "../diagnostics/thread_stats.hpp"
+
+#include <switch/services/arp.h>
+
+namespace ams::mitm::ldn {
+
+using ryu_ldn::ldn::NacpCacheEntry;
+
+namespace {
+
+/**
+ * @brief Entry point for the cache worker thread
+ *
+ * @param arg Pointer to NacpCacheService instance
+ */
+void NacpCacheThreadEntry(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::NacpCache);
+    static_cast<NacpCacheService*>(arg)->WorkerThreadFunc();
+}
+
+} // namespace
+
+NacpCacheService& NacpCacheService::GetInstance() {
+    static NacpCacheService instance;
+    return instance;
+}
+
+NacpCacheService::NacpCacheService()
+    : m_cache()
+    , m_started(false)
+    , m_pending{}
+    , m_pending_count(0)
+    , m_thread{}
+    , m_nacp{}
+{
+}
+
+void NacpCacheService::EnsureStarted() {
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+
+    if (m_cache.load(NACP_CACHE_PATH)) {
+        LOG_INFO("NACP cache loaded: %zu titles", m_cache.size());
+    } else {
+        LOG_INFO("NACP cache empty or invalid, starting fresh");
+    }
+
+    R_ABORT_UNLESS(os::CreateThread(
+        &m_thread,
+        NacpCacheThreadEntry,
+        this,
+        m_thread_stack,
+        sizeof(m_thread_stack),
+        os::LowestThreadPriority
+    ));
+    os::SetThreadNamePointer(&m_thread, "nacp_cache");
+    os::StartThread(&m_thread);
+}
+
+bool NacpCacheService::Resolve(u64 program_id, u64 process_id, NacpCacheEntry& out) {
+    {
+        std::scoped_lock lock(m_mutex);
+        EnsureStarted();
+
+        if (const NacpCacheEntry* entry = m_cache.find(program_id)) {
+            out = *entry;
+
+            // Verify the title version off the IPC path
+            if (m_pending_count < NACP_CACHE_MAX_PENDING_CHECKS) {
+                m_pending[m_pending_count++] = PendingCheck{program_id, process_id};
+            }
+            m_wake_event.Signal();
+            return true;
+        }
+    }
+
+    // Miss: the caller needs the ids before it can scan or create a network
+    if (!ReadFromArp(program_id, process_id, out)) {
+        out = NacpCacheEntry{};
+        out.program_id = program_id;
+        return false;
+    }
+
+    {
+        std::scoped_lock lock(m_mutex);
+        m_cache.store(out);
+    }
+    m_wake_event.Signal();  // Persist in the background
+    return true;
+}
+
+bool NacpCacheService::ReadTitleVersion(u64 program_id, u64 process_id, u32& version) {
+    if (R_FAILED(arpInitialize())) {
+        return false;
+    }
+
+    ArpApplicationLaunchProperty property{};
+    Result rc = arpGetApplicationLaunchProperty(&property, process_id);
+    arpExit();
+
+    if (R_FAILED(rc) || property.application_id != program_id) {
+        LOG_WARN("arp launch property unavailable for 0x%016lx: 0x%x", program_id, rc.GetValue());
+        return false;
+    }
+
+    version = property.version;
+    return true;
+}
+
+bool NacpCacheService::ReadFromArp(u64 program_id, u64 process_id, NacpCacheEntry& out) {
+    u32 version = 0;
+    if (!ReadTitleVersion(program_id, process_id, version)) {
+        return false;
+    }
+
+    std::scoped_lock lock(m_arp_mutex);
+
+    if (R_FAILED(arpInitialize())) {
+        return false;
+    }
+    Result rc = arpGetApplicationControlProperty(&m_nacp, process_id);
+    arpExit();
+
+    if (R_FAILED(rc)) {
+        LOG_ERROR("Failed to read NACP of 0x%016lx from arp: 0x%x", program_id, rc.GetValue());
+        return false;
+    }
+
+    out = NacpCacheEntry::FromNacp(program_id, version, m_nacp.local_communication_id);
+    LOG_INFO("NACP of 0x%016lx v%u: %u LocalCommunicationId(s), first 0x%016lx",
+             program_id, version, out.id_count, out.primary_id());
+    return true;
+}
+
+void NacpCacheService::WorkerThreadFunc() {
+    while (true) {
+        m_wake_event.Wait();
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
+
+        PendingCheck checks[NACP_CACHE_MAX_PENDING_CHECKS];
+        size_t check_count;
+        {
+            std::scoped_lock lock(m_mutex);
+            check_count = m_pending_count;
+            for (size_t i = 0; i < check_count; i++) {
+                checks[i] = m_pending[i];
+            }
+            m_pending_count = 0;
+        }
+
+        for (size_t i = 0; i < check_count; i++) {
+            u32 version = 0;
+            if (!ReadTitleVersion(checks[i].program_id, checks[i].process_id, version)) {
+                continue;
+            }
+
+            u32 cached_version;
+            {
+                std::scoped_lock lock(m_mutex);
+                const NacpCacheEntry* entry = m_cache.find(checks[i].program_id);
+                if (entry == nullptr) {
+                    continue;
+                }
+                cached_version = entry->title_version;
+            }
+            if (cached_version == version) {
+                continue;
+            }
+
+            LOG_INFO("Title 0x%016lx updated (v%u -> v%u), refreshing NACP cache",
+                     checks[i].program_id, cached_version, version);
+            NacpCacheEntry refreshed;
+            if (ReadFromArp(checks[i].program_id, checks[i].process_id, refreshed)) {
+                std::scoped_lock lock(m_mutex);
+                m_cache.store(refreshed);
+            }
+        }
+
+        std::scoped_lock lock(m_mutex);
+        if (m_cache.dirty() && !m_cache.save(NACP_CACHE_PATH)) {
+            LOG_WARN("Failed to write %s", NACP_CACHE_PATH);
+        }
+    }
+}
+
+} // namespace ams::mitm::ldn
@@ -0,0 +1,111 @@
+/**
+ * @file nacp_cache_service.hpp
+ * @brief Console NACP metadata cache backed by arp and the SD card
+ *
+ * Replaces the per-session NACP read done when a game opens ldn:u. That
+ * used to initialize ns, malloc a whole NsApplicationControlData (NACP and
+ * icon, over 128KB) from the sysmodule heap and read it, only to use the
+ * LocalCommunicationIds.
+ *
+ * - **Hit**: Resolve() is a table lookup. A background thread then checks
+ *   the running title version through arp and re-reads the NACP if the
+ *   game was updated; the refreshed ids apply from the next session.
+ * - **Miss**: the NACP (16KB, no icon) is read synchronously from arp into
+ *   a buffer owned by the service, then the cache file is rewritten in the
+ *   background.
+ *
+ * The cache lives at NACP_CACHE_PATH and survives reboots.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <stratosphere.hpp>
+#include "nacp_cache.hpp"
+
+namespace ams::mitm::ldn {
+
+/**
+ * @brief Location of the persisted cache
+ */
+constexpr const char* NACP_CACHE_PATH = "sdmc:/config/ryu_ldn_nx/nacp_cache.bin";
+
+/**
+ * @brief Title version checks that can be queued before the worker catches up
+ */
+constexpr size_t NACP_CACHE_MAX_PENDING_CHECKS = 4;
+
+/**
+ * @brief NACP metadata cache singleton used by ICommunicationService
+ *
+ * ## Thread Safety
+ *
+ * All methods are thread-safe.
+ */
+class NacpCacheService {
+public:
+    /**
+     * @brief Get the singleton instance
+     */
+    static NacpCacheService& GetInstance();
+
+    NacpCacheService(const NacpCacheService&) = delete;
+    NacpCacheService& operator=(const NacpCacheService&) = delete;
+
+    /**
+     * @brief Get the LDN metadata of a running title
+     *
+     * @param program_id Title of the client process
+     * @param process_id Client process, used to query arp on a miss
+     * @param out Cached or freshly read entry. If the NACP cannot be read,
+     *            an entry without ids (primary_id() == program_id).
+     * @return false if the NACP could not be read
+     */
+    bool Resolve(u64 program_id, u64 process_id, ryu_ldn::ldn::NacpCacheEntry& out);
+
+    /**
+     * @brief Worker thread body (public for the thread entry point)
+     */
+    void WorkerThreadFunc();
+
+private:
+    struct PendingCheck {
+        u64 program_id;
+        u64 process_id;
+    };
+
+    NacpCacheService();
+
+    /**
+     * @brief Load the file and start the worker on first use (m_mutex held)
+     */
+    void EnsureStarted();
+
+    /**
+     * @brief Read title version and NACP ids of a running process from arp
+     */
+    bool ReadFromArp(u64 program_id, u64 process_id, ryu_ldn::ldn::NacpCacheEntry& out);
+
+    /**
+     * @brief Read only the title version of a running process from arp
+     */
+    bool ReadTitleVersion(u64 program_id, u64 process_id, u32& version);
+
+    os::Mutex m_mutex{false};               ///< Guards m_cache and m_pending
+    os::Mutex m_arp_mutex{false};           ///< Guards m_nacp
+    ryu_ldn::ldn::NacpCache m_cache;
+    bool m_started;
+
+    PendingCheck m_pending[NACP_CACHE_MAX_PENDING_CHECKS];
+    size_t m_pending_count;
+
+    os::Event m_wake_event{os::EventClearMode_AutoClear};
+    os::ThreadType m_thread;
+    alignas(0x1000) uint8_t m_thread_stack[0x3000];
+
+    NacpStruct m_nacp;                      ///< Reused arp output buffer
+};
+
+} // namespace ams::mitm::ldn
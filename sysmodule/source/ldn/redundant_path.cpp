@@ -0,0 +1,367 @@
+/**
+ * @file redundant_path.cpp
+ * @brief Dual-path redundant transmission of small UDP ProxyData packets
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "redundant_path.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "../bsd/bsd_types.hpp"
+
+namespace ryu_ldn::ldn {
+
+bool redundant_title_selected(const char* titles, uint64_t program_id) {
+    if (titles == nullptr) {
+        return true;
+    }
+
+    bool empty = true;
+    const char* p = titles;
+    while (*p != '\0') {
+        while (*p == ',' || *p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+
+        char* end = nullptr;
+        uint64_t id = std::strtoull(p, &end, 16);
+        if (end == p) {
+            // Not a number: skip the entry
+            while (*p != '\0' && *p != ',') {
+                p++;
+            }
+            continue;
+        }
+
+        empty = false;
+        if (id == program_id) {
+            return true;
+        }
+        p = end;
+        while (*p != '\0' && *p != ',') {
+            p++;
+        }
+    }
+
+    return empty;
+}
+
+void redundant_parse_ports(const char* ports, RedundantPathConfig& config) {
+    config.port_count = 0;
+    if (ports == nullptr) {
+        return;
+    }
+
+    const char* p = ports;
+    while (*p != '\0' && config.port_count < REDUNDANT_MAX_PORTS) {
+        char* end = nullptr;
+        unsigned long port = std::strtoul(p, &end, 10);
+        if (end != p && port != 0 && port <= 0xFFFF) {
+            config.ports[config.port_count++] = static_cast<uint16_t>(port);
+            p = end;
+        }
+        while (*p != '\0' && *p != ',') {
+            p++;
+        }
+        if (*p == ',') {
+            p++;
+        }
+    }
+}
+
+protocol::ProtocolType redundant_tagged_protocol(protocol::ProtocolType protocol) {
+    return static_cast<protocol::ProtocolType>(static_cast<int32_t>(protocol) | REDUNDANT_TAGGED_FLAG);
+}
+
+bool redundant_take_tag(protocol::ProxyInfo& info) {
+    int32_t value = static_cast<int32_t>(info.protocol);
+    if ((value & REDUNDANT_TAGGED_FLAG) == 0) {
+        return false;
+    }
+    info.protocol = static_cast<protocol::ProtocolType>(value & ~REDUNDANT_TAGGED_FLAG);
+    return true;
+}
+
+RedundantPath::RedundantPath()
+    : m_config{false, REDUNDANT_DEFAULT_BUDGET, {}, 0}
+{
+    reset();
+}
+
+void RedundantPath::configure(const RedundantPathConfig& config) {
+    m_config = config;
+}
+
+void RedundantPath::reset() {
+    m_stats = RedundantPathStats{};
+    std::memset(m_peers, 0, sizeof(m_peers));
+    m_peer_count = 0;
+    std::memset(m_send_flows, 0, sizeof(m_send_flows));
+    std::memset(m_receive_flows, 0, sizeof(m_receive_flows));
+
+    // Start with a full bucket (milli-bytes)
+    m_budget_tokens = static_cast<uint64_t>(m_config.budget_bytes_per_sec) * 1000;
+    m_budget_refill_ms = 0;
+}
+
+RedundantControl RedundantPath::make_control(RedundantControlType type) {
+    RedundantControl control{};
+    control.magic = REDUNDANT_CONTROL_MAGIC;
+    control.version = REDUNDANT_VERSION;
+    control.type = type;
+    return control;
+}
+
+// =============================================================================
+// Tables
+// =============================================================================
+
+RedundantPath::Peer* RedundantPath::find_peer(uint32_t ip, bool create, uint64_t now_ms) {
+    for (size_t i = 0; i < m_peer_count; i++) {
+        if (m_peers[i].ip == ip) {
+            m_peers[i].last_used_ms = now_ms;
+            return &m_peers[i];
+        }
+    }
+    if (!create) {
+        return nullptr;
+    }
+
+    size_t index = m_peer_count;
+    if (m_peer_count < REDUNDANT_MAX_PEERS) {
+        m_peer_count++;
+    } else {
+        index = 0;
+        for (size_t i = 1; i < REDUNDANT_MAX_PEERS; i++) {
+            if (m_peers[i].last_used_ms < m_peers[index].last_used_ms) {
+                index = i;
+            }
+        }
+    }
+
+    m_peers[index] = Peer{ip, false, 0, 0, now_ms};
+    return &m_peers[index];
+}
+
+bool RedundantPath::plan_hello(uint32_t ip, uint64_t now_ms) {
+    if (bsd::IsBroadcastAddress(ip)) {
+        return false;
+    }
+
+    Peer* peer = find_peer(ip, true, now_ms);
+    if (peer->capable) {
+        return false;
+    }
+
+    // Discover ryu_ldn_nx peers; Ryujinx peers never answer
+    if (peer->hello_attempts >= REDUNDANT_HELLO_ATTEMPTS ||
+        (peer->hello_attempts != 0 && now_ms - peer->last_hello_ms < REDUNDANT_HELLO_INTERVAL_MS)) {
+        return false;
+    }
+
+    peer->hello_attempts++;
+    peer->last_hello_ms = now_ms;
+    m_stats.hellos_sent++;
+    return true;
+}
+
+bool RedundantPath::is_capable(uint32_t ip) const {
+    for (size_t i = 0; i < m_peer_count; i++) {
+        if (m_peers[i].ip == ip) {
+            return m_peers[i].capable;
+        }
+    }
+    return false;
+}
+
+RedundantPath::Flow* RedundantPath::find_flow(Flow* flows, uint32_t remote_ip, uint16_t local_port,
+                                              uint16_t remote_port, uint64_t now_ms, bool& created) {
+    Flow* victim = &flows[0];
+    for (size_t i = 0; i < REDUNDANT_MAX_FLOWS; i++) {
+        Flow& flow = flows[i];
+        if (flow.used && flow.remote_ip == remote_ip &&
+            flow.local_port == local_port && flow.remote_port == remote_port) {
+            created = false;
+            return &flow;
+        }
+        if (!flow.used) {
+            if (victim->used) {
+                victim = &flow;
+            }
+        } else if (victim->used && flow.last_used_ms < victim->last_used_ms) {
+            victim = &flow;
+        }
+    }
+
+    *victim = Flow{};
+    victim->used = true;
+    victim->remote_ip = remote_ip;
+    victim->local_port = local_port;
+    victim->remote_port = remote_port;
+    victim->last_used_ms = now_ms;
+    created = true;
+    return victim;
+}
+
+bool RedundantPath::flow_selected(const protocol::ProxyInfo& info) const {
+    if (m_config.port_count == 0) {
+        return true;
+    }
+    for (size_t i = 0; i < m_config.port_count; i++) {
+        if (m_config.ports[i] == info.dest_port || m_config.ports[i] == info.source_port) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RedundantPath::take_budget(uint32_t bytes, uint64_t now_ms) {
+    // Tokens are milli-bytes so that frequent small refills are not rounded away
+    uint64_t capacity = static_cast<uint64_t>(m_config.budget_bytes_per_sec) * 1000;
+    if (now_ms > m_budget_refill_ms) {
+        m_budget_tokens += (now_ms - m_budget_refill_ms) * m_config.budget_bytes_per_sec;
+        if (m_budget_tokens > capacity) {
+            m_budget_tokens = capacity;
+        }
+    }
+    m_budget_refill_ms = now_ms;
+
+    uint64_t cost = static_cast<uint64_t>(bytes) * 1000;
+    if (m_budget_tokens < cost) {
+        return false;
+    }
+    m_budget_tokens -= cost;
+    return true;
+}
+
+// =============================================================================
+// Send
+// =============================================================================
+
+RedundantSendPlan RedundantPath::plan_send(const protocol::ProxyInfo& info, size_t payload_size,
+                                           bool two_paths, uint64_t now_ms) {
+    RedundantSendPlan plan{};
+
+    if (!m_config.enabled ||
+        info.protocol != protocol::ProtocolType::Udp ||
+        payload_size > REDUNDANT_MAX_PAYLOAD ||
+        bsd::IsBroadcastAddress(info.dest_ipv4) ||
+        !flow_selected(info)) {
+        return plan;
+    }
+
+    Peer* peer = find_peer(info.dest_ipv4, true, now_ms);
+    if (!peer->capable) {
+        plan.send_hello = plan_hello(info.dest_ipv4, now_ms);
+        return plan;
+    }
+
+    if (!two_paths) {
+        return plan;
+    }
+
+    // Second LDN header + ProxyData header + payload, and both trailers
+    uint32_t cost = static_cast<uint32_t>(sizeof(protocol::LdnHeader) + sizeof(protocol::ProxyDataHeader) +
+                                          payload_size + 2 * sizeof(RedundantTrailer));
+    if (!take_budget(cost, now_ms)) {
+        m_stats.budget_limited++;
+        return plan;
+    }
+
+    bool created;
+    Flow* flow = find_flow(m_send_flows, info.dest_ipv4, info.source_port, info.dest_port, now_ms, created);
+    if (created) {
+        // Arbitrary start so a restarted sender does not replay old numbers
+        flow->sequence = static_cast<uint16_t>(now_ms);
+    }
+    flow->last_used_ms = now_ms;
+
+    plan.duplicate = true;
+    plan.trailer.sequence = flow->sequence++;
+    plan.trailer.version = REDUNDANT_VERSION;
+    plan.trailer.magic = REDUNDANT_TRAILER_MAGIC;
+
+    m_stats.duplicated++;
+    m_stats.duplicated_bytes += cost;
+    return plan;
+}
+
+// =============================================================================
+// Receive
+// =============================================================================
+
+RedundantVerdict RedundantPath::on_receive(const protocol::ProxyInfo& info, bool tagged, const uint8_t* payload,
+                                           uint32_t& payload_size, bool& reply_ack, uint64_t now_ms) {
+    reply_ack = false;
+
+    if (info.dest_port == REDUNDANT_CONTROL_PORT && payload_size == sizeof(RedundantControl)) {
+        RedundantControl control;
+        std::memcpy(&control, payload, sizeof(control));
+        if (control.magic != REDUNDANT_CONTROL_MAGIC || control.version < 1) {
+            return RedundantVerdict::Deliver;
+        }
+
+        // Hello or Ack: the sender understands tagged payloads
+        find_peer(info.source_ipv4, true, now_ms)->capable = true;
+        reply_ack = (control.type == RedundantControlType::Hello);
+        return RedundantVerdict::Control;
+    }
+
+    // Only a sender-marked packet has a trailer, whatever its payload ends with
+    if (!tagged || payload_size < sizeof(RedundantTrailer)) {
+        return RedundantVerdict::Deliver;
+    }
+
+    RedundantTrailer trailer;
+    std::memcpy(&trailer, payload + payload_size - sizeof(trailer), sizeof(trailer));
+    if (trailer.magic != REDUNDANT_TRAILER_MAGIC) {
+        return RedundantVerdict::Deliver;
+    }
+    payload_size -= sizeof(trailer);
+
+    bool created;
+    Flow* flow = find_flow(m_receive_flows, info.source_ipv4, info.dest_port, info.source_port, now_ms, created);
+    if (!created && now_ms > flow->last_used_ms + REDUNDANT_FLOW_IDLE_MS) {
+        created = true;  // Sender may have restarted its numbering
+    }
+    flow->last_used_ms = std::max(flow->last_used_ms, now_ms);
+
+    if (created) {
+        flow->sequence = trailer.sequence;
+        flow->window = 1;
+        m_stats.tagged_received++;
+        return RedundantVerdict::Deliver;
+    }
+
+    int16_t diff = static_cast<int16_t>(trailer.sequence - flow->sequence);
+    if (diff > 0) {
+        // Newer than anything seen: slide the window
+        flow->window = (diff >= REDUNDANT_WINDOW) ? 1 : ((flow->window << diff) | 1);
+        flow->sequence = trailer.sequence;
+        m_stats.tagged_received++;
+        return RedundantVerdict::Deliver;
+    }
+
+    uint16_t offset = static_cast<uint16_t>(-diff);
+    uint64_t bit = (offset < REDUNDANT_WINDOW) ? (1ULL << offset) : 0;
+    if (bit == 0 || (flow->window & bit) != 0) {
+        // Already delivered, or too old to tell
+        m_stats.duplicates_dropped++;
+        return RedundantVerdict::Duplicate;
+    }
+
+    // Reordered first copy
+    flow->window |= bit;
+    m_stats.tagged_received++;
+    return RedundantVerdict::Deliver;
+}
+
+} // namespace ryu_ldn::ldn
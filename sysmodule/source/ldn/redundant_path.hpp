@@ -0,0 +1,354 @@
+/**
+ * @file redundant_path.hpp
+ * @brief Dual-path redundant transmission of small UDP ProxyData packets
+ *
+ * On lossy Wi-Fi a single lost segment on the P2P TCP link costs a
+ * retransmission timeout (tens to hundreds of ms) for input packets of a few
+ * dozen bytes. When enabled, small unicast UDP packets are sent on both the
+ * P2P link and the master server relay; whichever copy arrives first is
+ * delivered and the other one is dropped by the receiver.
+ *
+ * ## Wire Format
+ *
+ * Ryujinx peers must never see anything but plain ProxyData, so the extra
+ * bytes are only used between ryu_ldn_nx consoles that have found each other:
+ *
+ * ```
+ * Control (ProxyData to port REDUNDANT_CONTROL_PORT, 8 bytes):
+ * 0x00    4     magic ("RDPC")
+ * 0x04    1     version
+ * 0x05    1     type (Hello / Ack)
+ * 0x06    2     reserved
+ *
+ * Tagged ProxyData (ProxyInfo.protocol |= REDUNDANT_TAGGED_FLAG):
+ * 0x00    n     game payload
+ * n       2     sequence (per flow)
+ * n+2     1     version
+ * n+3     1     reserved
+ * n+4     4     magic ("RDPT")
+ * ```
+ *
+ * The receiver only strips a trailer from a packet carrying the flag, never
+ * on the strength of the payload tail: game data ending with the magic is
+ * delivered untouched. The LDN header is rebuilt by the relay, so the flag
+ * lives in ProxyInfo, which the relay and P2P hosts forward as is (they
+ * route on the addresses only). The receiver clears it before routing.
+ *
+ * A sender sends a Hello to a destination before tagging anything for it.
+ * Every ryu_ldn_nx console answers with an Ack whether or not it has the
+ * option enabled, and marks the sender as capable. No port is ever bound to
+ * 0, so Ryujinx peers drop the Hello and stay untagged forever.
+ *
+ * ## Flow Selection
+ *
+ * A packet is duplicated when all of these hold:
+ * - UDP, unicast, payload <= REDUNDANT_MAX_PAYLOAD (latency-critical input)
+ * - The flow is selected: title in `redundant_udp_titles` and, if
+ *   `redundant_udp_ports` is set, source or destination port in it
+ * - Destination answered the Hello
+ * - Two paths are available (P2P link ready)
+ * - The duplication byte budget has room for it
+ *
+ * Everything else is sent once, untagged, exactly as before.
+ *
+ * ## Byte Budget
+ *
+ * A token bucket refilled at budget_bytes_per_sec (burst: one second worth)
+ * bounds the extra upload: the second ProxyData header, its payload and the
+ * two trailers.
+ *
+ * ## Thread Safety
+ *
+ * NOT thread-safe. ICommunicationService serializes access.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "../protocol/types.hpp"
+
+namespace ryu_ldn::ldn {
+
+/**
+ * @brief Magic at the end of a tagged payload ("RDPT")
+ */
+constexpr uint32_t REDUNDANT_TRAILER_MAGIC = 0x54504452;
+
+/**
+ * @brief Magic of a control message ("RDPC")
+ */
+constexpr uint32_t REDUNDANT_CONTROL_MAGIC = 0x43504452;
+
+/**
+ * @brief Protocol version carried in trailers and control messages
+ */
+constexpr uint8_t REDUNDANT_VERSION = 1;
+
+/**
+ * @brief Destination port of control messages (never bound by a game)
+ */
+constexpr uint16_t REDUNDANT_CONTROL_PORT = 0;
+
+/**
+ * @brief Flag OR-ed into ProxyInfo::protocol of a tagged packet
+ *
+ * Not a valid ProtocolType value, so a receiver that does not know the flag
+ * rejects the packet instead of delivering the trailer to the game.
+ */
+constexpr int32_t REDUNDANT_TAGGED_FLAG = 0x40000000;
+
+/**
+ * @brief Ports of the per-flow selection (`redundant_udp_ports`)
+ */
+constexpr size_t REDUNDANT_MAX_PORTS = 8;
+
+/**
+ * @brief Largest payload that is duplicated (game input/state packets)
+ */
+constexpr uint32_t REDUNDANT_MAX_PAYLOAD = 128;
+
+/**
+ * @brief Default duplication budget in bytes per second
+ */
+constexpr uint32_t REDUNDANT_DEFAULT_BUDGET = 16 * 1024;
+
+/**
+ * @brief Peers tracked (an LDN network has at most 8 nodes)
+ */
+constexpr size_t REDUNDANT_MAX_PEERS = 16;
+
+/**
+ * @brief Flows tracked per direction (least recently used is evicted)
+ */
+constexpr size_t REDUNDANT_MAX_FLOWS = 32;
+
+/**
+ * @brief Hellos sent to a destination before it is considered a Ryujinx peer
+ */
+constexpr uint32_t REDUNDANT_HELLO_ATTEMPTS = 3;
+
+/**
+ * @brief Delay between two Hellos to the same destination
+ */
+constexpr uint64_t REDUNDANT_HELLO_INTERVAL_MS = 2000;
+
+/**
+ * @brief Idle time after which a receive flow restarts its window
+ */
+constexpr uint64_t REDUNDANT_FLOW_IDLE_MS = 5000;
+
+/**
+ * @brief Width of the duplicate detection window, in sequence numbers
+ */
+constexpr uint16_t REDUNDANT_WINDOW = 64;
+
+/**
+ * @brief Trailer appended to a tagged payload - 8 bytes
+ */
+struct __attribute__((packed)) RedundantTrailer {
+    uint16_t sequence;
+    uint8_t  version;
+    uint8_t  reserved;
+    uint32_t magic;
+};
+static_assert(sizeof(RedundantTrailer) == 8, "RedundantTrailer must be 8 bytes");
+
+/**
+ * @brief Control message type
+ */
+enum class RedundantControlType : uint8_t {
+    Hello = 1,  ///< "I understand tagged payloads, do you?"
+    Ack = 2,    ///< Reply to Hello
+};
+
+/**
+ * @brief Control message - 8 bytes
+ */
+struct __attribute__((packed)) RedundantControl {
+    uint32_t magic;
+    uint8_t  version;
+    RedundantControlType type;
+    uint16_t reserved;
+};
+static_assert(sizeof(RedundantControl) == 8, "RedundantControl must be 8 bytes");
+
+/**
+ * @brief Sender options
+ */
+struct RedundantPathConfig {
+    bool     enabled;               ///< Duplicate eligible packets (receiving always works)
+    uint32_t budget_bytes_per_sec;  ///< Extra upload allowed for duplicates
+    uint16_t ports[REDUNDANT_MAX_PORTS];  ///< Selected flows by game port
+    size_t   port_count;            ///< 0 = every flow
+};
+
+/**
+ * @brief Counters since the last reset()
+ */
+struct RedundantPathStats {
+    uint64_t duplicated;          ///< Packets sent on both paths
+    uint64_t duplicated_bytes;    ///< Extra bytes charged to the budget
+    uint64_t budget_limited;      ///< Eligible packets sent once for lack of budget
+    uint64_t hellos_sent;
+    uint64_t tagged_received;     ///< Tagged packets delivered
+    uint64_t duplicates_dropped;  ///< Second copies dropped
+};
+
+/**
+ * @brief What to do with an outgoing packet
+ */
+struct RedundantSendPlan {
+    bool duplicate;            ///< Append trailer and send on both paths
+    bool send_hello;           ///< Send a Hello to the destination first
+    RedundantTrailer trailer;  ///< Valid when duplicate
+};
+
+/**
+ * @brief What to do with an incoming packet
+ */
+enum class RedundantVerdict {
+    Deliver,     ///< Route to the game (payload size may have been trimmed)
+    Duplicate,   ///< Second copy, drop
+    Control,     ///< Consumed control message, do not route
+};
+
+/**
+ * @brief Check a title against the `redundant_udp_titles` list
+ *
+ * @param titles Comma-separated hex program IDs ("0100..., 0x0100..."), may be empty
+ * @param program_id Running title
+ * @return true if the list is empty or contains program_id
+ */
+bool redundant_title_selected(const char* titles, uint64_t program_id);
+
+/**
+ * @brief Parse the `redundant_udp_ports` list
+ *
+ * @param ports Comma-separated decimal ports, may be empty
+ * @param config Receives ports and port_count (invalid entries skipped,
+ *        extra entries beyond REDUNDANT_MAX_PORTS ignored)
+ */
+void redundant_parse_ports(const char* ports, RedundantPathConfig& config);
+
+/**
+ * @brief Protocol value of a tagged copy
+ */
+protocol::ProtocolType redundant_tagged_protocol(protocol::ProtocolType protocol);
+
+/**
+ * @brief Clear REDUNDANT_TAGGED_FLAG from an incoming packet
+ *
+ * @return true if the flag was set (the payload ends with a trailer)
+ */
+bool redundant_take_tag(protocol::ProxyInfo& info);
+
+/**
+ * @brief Sequencing, duplicate filtering and peer discovery for both directions
+ */
+class RedundantPath {
+public:
+    RedundantPath();
+
+    /**
+     * @brief Apply sender options (receiving is always active)
+     */
+    void configure(const RedundantPathConfig& config);
+
+    const RedundantPathConfig& config() const { return m_config; }
+
+    /**
+     * @brief Forget peers, flows and counters (new network)
+     */
+    void reset();
+
+    /**
+     * @brief Decide how to send one packet
+     *
+     * @param info Addressing of the packet
+     * @param payload_size Game payload size
+     * @param two_paths Whether the P2P link is ready next to the relay
+     * @param now_ms Monotonic time
+     */
+    RedundantSendPlan plan_send(const protocol::ProxyInfo& info, size_t payload_size,
+                                bool two_paths, uint64_t now_ms);
+
+    /**
+     * @brief Decide whether to send a Hello to a destination
+     *
+     * Discovery on behalf of other features (optimistic TCP connect): active
+     * even when duplication is disabled, same attempt limit and interval.
+     *
+     * @param ip Destination IP
+     * @param now_ms Monotonic time
+     * @return true if a Hello must be sent now
+     */
+    bool plan_hello(uint32_t ip, uint64_t now_ms);
+
+    /**
+     * @brief Inspect one incoming packet
+     *
+     * @param info Addressing of the packet, flag already cleared
+     * @param tagged Result of redundant_take_tag()
+     * @param payload Payload as received
+     * @param payload_size In: received size. Out: game payload size.
+     * @param reply_ack Set when the caller must answer with an Ack
+     * @param now_ms Monotonic time
+     */
+    RedundantVerdict on_receive(const protocol::ProxyInfo& info, bool tagged, const uint8_t* payload,
+                                uint32_t& payload_size, bool& reply_ack, uint64_t now_ms);
+
+    /**
+     * @brief Whether a destination answered the Hello
+     */
+    bool is_capable(uint32_t ip) const;
+
+    const RedundantPathStats& stats() const { return m_stats; }
+
+    /**
+     * @brief Build a control message
+     */
+    static RedundantControl make_control(RedundantControlType type);
+
+private:
+    struct Peer {
+        uint32_t ip;
+        bool     capable;
+        uint32_t hello_attempts;
+        uint64_t last_hello_ms;
+        uint64_t last_used_ms;
+    };
+
+    struct Flow {
+        uint32_t remote_ip;
+        uint16_t local_port;
+        uint16_t remote_port;
+        uint16_t sequence;      ///< Send: next sequence. Receive: highest seen.
+        uint64_t window;        ///< Receive: bit i = highest - i seen
+        uint64_t last_used_ms;
+        bool     used;
+    };
+
+    bool flow_selected(const protocol::ProxyInfo& info) const;
+    Peer* find_peer(uint32_t ip, bool create, uint64_t now_ms);
+    static Flow* find_flow(Flow* flows, uint32_t remote_ip, uint16_t local_port,
+                           uint16_t remote_port, uint64_t now_ms, bool& created);
+    bool take_budget(uint32_t bytes, uint64_t now_ms);
+
+    RedundantPathConfig m_config;
+    RedundantPathStats m_stats;
+
+    Peer m_peers[REDUNDANT_MAX_PEERS];
+    size_t m_peer_count;
+
+    Flow m_send_flows[REDUNDANT_MAX_FLOWS];
+    Flow m_receive_flows[REDUNDANT_MAX_FLOWS];
+
+    uint64_t m_budget_tokens;     ///< Bytes available for duplicates
+    uint64_t m_budget_refill_ms;  ///< Last refill
+};
+
+} // namespace ryu_ldn::ldn
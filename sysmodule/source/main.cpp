@@ -23,6 +23,15 @@ extern "C" {
 #include "config/config.hpp"
 #include "config/config_ipc_service.hpp"
 #include "debug/log.hpp"
+#include "debug/log_udp_sink.hpp"
+#include "diagnostics/link_test_runner.hpp"
+#include "diagnostics/metrics_server.hpp"
+#include "diagnostics/ipc_recorder.hpp"
+#include "diagnostics/flight_recorder.hpp"
+#include "diagnostics/thread_stats.hpp"
+#ifdef RYU_ALLOC_GUARD
+#include "diagnostics/alloc_guard.hpp"
+#endif
 
 namespace ams {
 
@@ -38,6 +47,12 @@ namespace ams {
         constexpr size_t MallocBufferSize = 1_MB;
         alignas(os::MemoryPageSize) constinit u8 g_malloc_buffer[MallocBufferSize];
 
+        /// Prometheus endpoint (started only when [debug] metrics = 1)
+        ryu_ldn::diagnostics::MetricsServer g_metrics_server(ryu_ldn::diagnostics::g_metrics);
+
+        /// Remote log sink (started only when [debug] log_udp_host is set)
+        ryu_ldn::debug::LogUdpSink g_log_udp_sink;
+
         /// Socket buffer configuration
         consteval size_t GetLibnxBsdTransferMemorySize(const ::SocketInitConfig* config) {
             const u32 tcp_tx_buf_max_size = config->tcp_tx_buf_max_size != 0
@@ -125,6 +140,10 @@ namespace ams {
         }
 
         void* Allocate(size_t size) {
+#ifdef RYU_ALLOC_GUARD
+            // Debug builds (make ALLOC_GUARD=1): count it, fail inside a NoAllocScope
+            ryu_ldn::diagnostics::alloc_guard_note(size);
+#endif
             return lmem::AllocateFromExpHeap(GetHeapHandle(), size);
         }
 
@@ -194,8 +213,13 @@ namespace ams {
             alignas(os::MemoryPageSize) u8 g_extra_thread_stacks[NumExtraThreads][ThreadStackSize];
             os::ThreadType g_extra_threads[NumExtraThreads];
 
+            /// One wakeup per processed request (LoopProcess() without the stop check)
             void LoopServerThread(void*) {
-                g_server_manager.LoopProcess();
+                ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::MitmIpc);
+                while (true) {
+                    g_server_manager.WaitAndProcess();
+                    ryu_ldn::diagnostics::g_thread_registry.wakeup();
+                }
             }
 
             void ProcessForServerOnAllThreads(void*) {
@@ -266,7 +290,11 @@ namespace ams {
 
         /// Config service thread entry point
         void LoopConfigServerThread(void*) {
-            g_config_server_manager.LoopProcess();
+            ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::ConfigServer);
+            while (true) {
+                g_config_server_manager.WaitAndProcess();
+                ryu_ldn::diagnostics::g_thread_registry.wakeup();
+            }
         }
 
         /// Log maintenance thread stack
@@ -275,9 +303,11 @@ namespace ams {
 
         /// Log maintenance thread entry point (checks file idle timeout)
         void LoopLogMaintenanceThread(void*) {
+            ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::LogMaintenance);
             while (true) {
                 // Sleep for 2 seconds
                 svc::SleepThread(TimeSpan::FromSeconds(2).GetNanoSeconds());
+                ryu_ldn::diagnostics::g_thread_registry.wakeup();
 
                 // Check if log file should be closed due to idle timeout
                 ryu_ldn::debug::g_logger.check_idle_timeout();
@@ -324,10 +354,44 @@ namespace ams {
                                           LibnxSocketInitConfig.num_bsd_sessions,
                                           LibnxSocketInitConfig.bsd_service_type));
             R_ABORT_UNLESS(socketInitialize(&LibnxSocketInitConfig));
+
+            // Optional LAN metrics endpoint (failure only costs the metrics)
+            if (config.debug.metrics_enabled) {
+                g_metrics_server.Start(config.debug.metrics_port);
+            }
+
+            // Optional IPC call recording (written on ldn:u Finalize)
+            if (config.debug.ipc_record) {
+                ryu_ldn::diagnostics::g_ipc_recorder.start(config.debug.ipc_record_payload);
+                LOG_INFO("Recording IPC calls to %s", ryu_ldn::config::IPC_TRACE_PATH);
+            }
+
+            // Always-on event ring, dumped by ldn_bg when a threshold is crossed
+            if (config.debug.flight_recorder) {
+                ryu_ldn::diagnostics::FlightThresholds thresholds{};
+                thresholds.rtt_ms = config.debug.flight_rtt_ms;
+                thresholds.queue_delay_us = config.debug.flight_queue_us;
+                thresholds.ipc_latency_us = config.debug.flight_ipc_us;
+                thresholds.min_interval_s = config.debug.flight_interval_s;
+                ryu_ldn::diagnostics::g_flight_recorder.start(thresholds);
+            }
+
+            // Optional remote logging (needs sockets, so started here)
+            if (config.debug.enabled && config.debug.log_udp_host[0] != '\0') {
+                if (g_log_udp_sink.start(config.debug.log_udp_host, config.debug.log_udp_port)) {
+                    ryu_ldn::debug::g_logger.set_sink(&g_log_udp_sink);
+                    LOG_INFO("Streaming logs to %s:%u", config.debug.log_udp_host, config.debug.log_udp_port);
+                } else {
+                    LOG_WARN("Cannot stream logs to %s:%u", config.debug.log_udp_host, config.debug.log_udp_port);
+                }
+            }
         }
 
         void FinalizeSystemModule() {
             LOG_INFO("ryu_ldn_nx sysmodule shutting down");
+            g_metrics_server.Stop();
+            ryu_ldn::debug::g_logger.set_sink(nullptr);
+            g_log_udp_sink.stop();
             ryu_ldn::debug::g_logger.flush();
             socketExit();
             bsdExit();
@@ -398,6 +462,9 @@ namespace ams {
         os::SetThreadNamePointer(&cfg::g_log_thread, "ryu_ldn::LogThread");
         os::StartThread(&cfg::g_log_thread);
 
+        // Start the link test worker (idle until the overlay requests a test)
+        mitm::diagnostics::LinkTestRunner::GetInstance().Initialize();
+
         // ====================================================================
         // Register MITM services
         // ====================================================================
@@ -24,7 +24,7 @@
  * - **Connected**: Send Initialize handshake
  * - **Handshaking**: Wait for server response (implicit in Connected for now)
  * - **Ready**: Process packets, send keepalives
- * - **Backoff**: Wait for timer, then retry
+ * - **Backoff**: Wait for timer (or the network link to return), then retry
  * - **Error**: Requires manual disconnect/reconnect
  *
  * ## Packet Processing
@@ -42,6 +42,8 @@
 #include "client.hpp"
 #include "socket.hpp"
 #include "../debug/log.hpp"
+#include "../diagnostics/flight_recorder.hpp"
+#include "../diagnostics/metrics.hpp"
 #include <cstring>
 
 namespace ryu_ldn {
@@ -125,9 +127,13 @@ RyuLdnClient::RyuLdnClient()
     , m_state_callback(nullptr)
     , m_packet_callback(nullptr)
     , m_packet_callback_user_data(nullptr)
+    , m_pong_callback(nullptr)
+    , m_pong_callback_user_data(nullptr)
     , m_last_ping_time_ms(0)
     , m_backoff_start_time_ms(0)
     , m_current_backoff_delay_ms(0)
+    , m_link_source{}
+    , m_link_state(LinkState::Unknown)
     , m_session_id{}
     , m_mac_address{}
     , m_handshake_sent(false)
@@ -157,9 +163,13 @@ RyuLdnClient::RyuLdnClient(const RyuLdnClientConfig& config)
     , m_state_callback(nullptr)
     , m_packet_callback(nullptr)
     , m_packet_callback_user_data(nullptr)
+    , m_pong_callback(nullptr)
+    , m_pong_callback_user_data(nullptr)
     , m_last_ping_time_ms(0)
     , m_backoff_start_time_ms(0)
     , m_current_backoff_delay_ms(0)
+    , m_link_source{}
+    , m_link_state(LinkState::Unknown)
     , m_session_id{}
     , m_mac_address{}
     , m_handshake_sent(false)
@@ -200,9 +210,13 @@ RyuLdnClient::RyuLdnClient(RyuLdnClient&& other) noexcept
     , m_state_callback(other.m_state_callback)
     , m_packet_callback(other.m_packet_callback)
     , m_packet_callback_user_data(other.m_packet_callback_user_data)
+    , m_pong_callback(other.m_pong_callback)
+    , m_pong_callback_user_data(other.m_pong_callback_user_data)
     , m_last_ping_time_ms(other.m_last_ping_time_ms)
     , m_backoff_start_time_ms(other.m_backoff_start_time_ms)
     , m_current_backoff_delay_ms(other.m_current_backoff_delay_ms)
+    , m_link_source(other.m_link_source)
+    , m_link_state(other.m_link_state)
     , m_session_id(other.m_session_id)
     , m_mac_address(other.m_mac_address)
     , m_handshake_sent(other.m_handshake_sent)
@@ -218,6 +232,8 @@ RyuLdnClient::RyuLdnClient(RyuLdnClient&& other) noexcept
     other.m_state_callback = nullptr;
     other.m_packet_callback = nullptr;
     other.m_packet_callback_user_data = nullptr;
+    other.m_pong_callback = nullptr;
+    other.m_pong_callback_user_data = nullptr;
     other.m_initialized = false;
 }
 
@@ -238,9 +254,13 @@ RyuLdnClient& RyuLdnClient::operator=(RyuLdnClient&& other) noexcept {
         m_state_callback = other.m_state_callback;
         m_packet_callback = other.m_packet_callback;
         m_packet_callback_user_data = other.m_packet_callback_user_data;
+        m_pong_callback = other.m_pong_callback;
+        m_pong_callback_user_data = other.m_pong_callback_user_data;
         m_last_ping_time_ms = other.m_last_ping_time_ms;
         m_backoff_start_time_ms = other.m_backoff_start_time_ms;
         m_current_backoff_delay_ms = other.m_current_backoff_delay_ms;
+        m_link_source = other.m_link_source;
+        m_link_state = other.m_link_state;
         m_session_id = other.m_session_id;
         m_mac_address = other.m_mac_address;
         m_handshake_sent = other.m_handshake_sent;
@@ -256,6 +276,8 @@ RyuLdnClient& RyuLdnClient::operator=(RyuLdnClient&& other) noexcept {
         other.m_state_callback = nullptr;
         other.m_packet_callback = nullptr;
         other.m_packet_callback_user_data = nullptr;
+        other.m_pong_callback = nullptr;
+        other.m_pong_callback_user_data = nullptr;
         other.m_initialized = false;
     }
     return *this;
@@ -299,6 +321,27 @@ void RyuLdnClient::set_packet_callback(ClientPacketCallback callback, void* user
     m_packet_callback_user_data = user_data;
 }
 
+/**
+ * @brief Set callback for ping replies
+ *
+ * @param callback Function to call when a client ping is echoed
+ * @param user_data User-provided context pointer passed to callback
+ */
+void RyuLdnClient::set_pong_callback(ClientPongCallback callback, void* user_data) {
+    m_pong_callback = callback;
+    m_pong_callback_user_data = user_data;
+}
+
+/**
+ * @brief Set the network link state source
+ *
+ * @param source Link state query (get_state nullptr to disable)
+ */
+void RyuLdnClient::set_link_state_source(const LinkStateSource& source) {
+    m_link_source = source;
+    m_link_state = LinkState::Unknown;
+}
+
 // ============================================================================
 // Connection Management
 // ============================================================================
@@ -436,6 +479,7 @@ void RyuLdnClient::update(uint64_t current_time_ms) {
             if (is_handshake_timeout(current_time_ms)) {
                 m_last_error_code = protocol::NetworkErrorCode::HandshakeTimeout;
                 m_state_machine.process_event(ConnectionEvent::HandshakeFailed);
+                m_reconnect_manager.record_failure();
                 if (m_config.auto_reconnect) {
                     start_backoff();
                 }
@@ -462,7 +506,9 @@ void RyuLdnClient::update(uint64_t current_time_ms) {
                         // Handshake completed (success or failure handled inside)
                     }
                 } else if (result == ClientResult::ConnectionLost) {
+                    // Dropped before the handshake completed: counts as a failed attempt
                     m_state_machine.process_event(ConnectionEvent::ConnectionLost);
+                    m_reconnect_manager.record_failure();
                     if (m_config.auto_reconnect) {
                         start_backoff();
                     }
@@ -473,7 +519,7 @@ void RyuLdnClient::update(uint64_t current_time_ms) {
 
         case ConnectionState::Ready:
             // Normal operation - process packets and send keepalives
-            process_packets();
+            process_packets(current_time_ms);
 
             // Check for ping timeout (no pong received)
             if (m_pending_ping_count > 0 && m_ping_timeout_ms > 0) {
@@ -499,6 +545,26 @@ void RyuLdnClient::update(uint64_t current_time_ms) {
             break;
 
         case ConnectionState::Backoff:
+            // The backoff period starts at the first update after the failure
+            if (m_backoff_start_time_ms == 0) {
+                m_backoff_start_time_ms = current_time_ms;
+            }
+
+            if (poll_link_state()) {
+                // The failures were the link's, not the server's: start over now
+                LOG_INFO("Network link is back, reconnecting without waiting for backoff");
+                diagnostics::g_metrics.server_link_reconnects.Add();
+                m_reconnect_manager.reset();
+                m_state_machine.process_event(ConnectionEvent::BackoffExpired);
+                try_connect();
+                break;
+            }
+
+            // Nothing to reach without a link: wait for it instead of spending retries
+            if (m_link_state == LinkState::Down) {
+                break;
+            }
+
             // Check if backoff has expired
             if (is_backoff_expired(current_time_ms)) {
                 m_state_machine.process_event(ConnectionEvent::BackoffExpired);
@@ -751,6 +817,31 @@ ClientOpResult RyuLdnClient::send_ping() {
     return ClientOpResult::Success;
 }
 
+/**
+ * @brief Send a client ping with an explicit ID
+ *
+ * @param ping_id ID to put in the ping request
+ * @return ClientOpResult indicating success or failure
+ */
+ClientOpResult RyuLdnClient::send_ping_request(uint8_t ping_id) {
+    if (!is_ready()) {
+        return ClientOpResult::NotReady;
+    }
+
+    protocol::PingMessage msg{};
+    msg.requester = 1;  // Client requesting
+    msg.id = ping_id;
+    ClientResult result = m_tcp_client.send_ping(msg);
+    if (result != ClientResult::Success) {
+        if (result == ClientResult::ConnectionLost) {
+            m_state_machine.process_event(ConnectionEvent::ConnectionLost);
+        }
+        return ClientOpResult::SendFailed;
+    }
+
+    return ClientOpResult::Success;
+}
+
 ClientOpResult RyuLdnClient::send_ping_response(uint8_t ping_id) {
     if (!is_ready()) {
         return ClientOpResult::NotReady;
@@ -877,9 +968,12 @@ void RyuLdnClient::try_connect() {
 
     if (result == ClientResult::Success) {
         LOG_INFO("TCP connection established");
-        // Connection successful
+        // Connection successful. The retry count is only reset once the
+        // handshake succeeds: a server that accepts and then drops us must
+        // still be backed off, not retried at the initial delay forever.
         m_state_machine.process_event(ConnectionEvent::ConnectSuccess);
-        m_reconnect_manager.reset();
+        // Every new connection needs its own handshake (reconnects included)
+        m_handshake_sent = false;
     } else {
         LOG_WARN("TCP connection failed: %s", client_result_to_string(result));
         // Connection failed
@@ -899,7 +993,7 @@ void RyuLdnClient::try_connect() {
  *
  * Polls TCP client for packets and handles each one.
  */
-void RyuLdnClient::process_packets() {
+void RyuLdnClient::process_packets(uint64_t current_time_ms) {
     if (!m_tcp_client.is_connected()) {
         return;
     }
@@ -937,7 +1031,7 @@ void RyuLdnClient::process_packets() {
         }
 
         // Handle the packet
-        handle_packet(packet_id, recv_buffer, recv_size);
+        handle_packet(packet_id, recv_buffer, recv_size, current_time_ms);
     }
 }
 
@@ -947,10 +1041,12 @@ void RyuLdnClient::process_packets() {
  * @param id Packet type
  * @param data Packet payload
  * @param size Payload size
+ * @param current_time_ms Time of the update that received the packet
  */
 void RyuLdnClient::handle_packet(protocol::PacketId id,
                                   const uint8_t* data,
-                                  size_t size) {
+                                  size_t size,
+                                  uint64_t current_time_ms) {
     // Handle protocol-level packets
     switch (id) {
         case protocol::PacketId::Ping: {
@@ -967,9 +1063,17 @@ void RyuLdnClient::handle_packet(protocol::PacketId id,
                 } else {
                     // Response to our ping - connection is alive
                     if (m_pending_ping_count > 0) {
+                        // Keepalive reply: RTT at update() resolution
+                        m_last_rtt_ms = current_time_ms - m_last_ping_time_ms;
+                        diagnostics::g_metrics.server_rtt_ms.Observe(m_last_rtt_ms);
+                        diagnostics::g_flight_recorder.rtt(m_last_rtt_ms);
                         m_pending_ping_count = 0;
                     }
                     m_last_pong_time_ms = m_last_ping_time_ms;
+
+                    if (m_pong_callback != nullptr) {
+                        m_pong_callback(ping_msg->id, m_pong_callback_user_data);
+                    }
                 }
             }
             break;
@@ -1052,7 +1156,7 @@ void RyuLdnClient::generate_mac_address() {
  * Records the current time and calculates backoff delay.
  */
 void RyuLdnClient::start_backoff() {
-    m_backoff_start_time_ms = 0;  // Will be set on first update check
+    m_backoff_start_time_ms = 0;  // Set by the next update()
     m_current_backoff_delay_ms = m_reconnect_manager.get_next_delay_ms();
 }
 
@@ -1063,16 +1167,36 @@ void RyuLdnClient::start_backoff() {
  * @return true if backoff period has elapsed
  */
 bool RyuLdnClient::is_backoff_expired(uint64_t current_time_ms) const {
-    // If start time not set, this is the first check - set it
+    // Not started yet (update() sets the start time)
     if (m_backoff_start_time_ms == 0) {
-        // Workaround: can't modify const, so check will fail first time
-        // Real implementation would handle this differently
         return false;
     }
 
     return (current_time_ms - m_backoff_start_time_ms) >= m_current_backoff_delay_ms;
 }
 
+/**
+ * @brief Read the link state source
+ *
+ * Only polled in backoff: a link that drops and returns while connected
+ * is handled by the TCP connection itself.
+ *
+ * @return true if the link just came back (Down -> Up)
+ */
+bool RyuLdnClient::poll_link_state() {
+    if (m_link_source.get_state == nullptr) {
+        return false;
+    }
+
+    LinkState previous = m_link_state;
+    m_link_state = m_link_source.get_state(m_link_source.user_data);
+    if (m_link_state != previous) {
+        LOG_INFO("Network link %s -> %s", link_state_to_string(previous),
+                 link_state_to_string(m_link_state));
+    }
+    return previous == LinkState::Down && m_link_state == LinkState::Up;
+}
+
 /**
  * @brief Check if handshake has timed out
  *
@@ -1126,6 +1250,7 @@ bool RyuLdnClient::process_handshake_response(protocol::PacketId id,
 
             m_last_error_code = protocol::NetworkErrorCode::None;
             m_state_machine.process_event(ConnectionEvent::HandshakeSuccess);
+            m_reconnect_manager.reset();
             return true;
         }
 
@@ -1150,6 +1275,7 @@ bool RyuLdnClient::process_handshake_response(protocol::PacketId id,
             } else {
                 // Other errors might be recoverable
                 m_state_machine.process_event(ConnectionEvent::HandshakeFailed);
+                m_reconnect_manager.record_failure();
                 if (m_config.auto_reconnect) {
                     start_backoff();
                 }
@@ -1162,6 +1288,7 @@ bool RyuLdnClient::process_handshake_response(protocol::PacketId id,
             LOG_INFO("Handshake successful (SyncNetwork) - ready");
             m_last_error_code = protocol::NetworkErrorCode::None;
             m_state_machine.process_event(ConnectionEvent::HandshakeSuccess);
+            m_reconnect_manager.reset();
             return true;
         }
 
@@ -1170,6 +1297,7 @@ bool RyuLdnClient::process_handshake_response(protocol::PacketId id,
             LOG_WARN("Server disconnected during handshake");
             m_last_error_code = protocol::NetworkErrorCode::ConnectionRejected;
             m_state_machine.process_event(ConnectionEvent::HandshakeFailed);
+            m_reconnect_manager.record_failure();
             if (m_config.auto_reconnect) {
                 start_backoff();
             }
@@ -83,6 +83,7 @@
 #include "tcp_client.hpp"
 #include "connection_state.hpp"
 #include "reconnect.hpp"
+#include "link_state.hpp"
 #include "../config/config.hpp"
 #include "../protocol/types.hpp"
 
@@ -130,6 +131,18 @@ using ClientPacketCallback = void (*)(protocol::PacketId packet_id,
                                        size_t size,
                                        void* user_data);
 
+/**
+ * @brief Callback type for ping replies
+ *
+ * Called when the server echoes back a client-requested ping
+ * (requester=1). Keepalive bookkeeping still happens internally;
+ * this only exposes the reply, e.g. for RTT measurement.
+ *
+ * @param ping_id ID of the echoed ping
+ * @param user_data User-provided context pointer
+ */
+using ClientPongCallback = void (*)(uint8_t ping_id, void* user_data);
+
 /**
  * @brief Configuration for RyuLdnClient
  */
@@ -288,6 +301,24 @@ public:
      */
     void set_packet_callback(ClientPacketCallback callback, void* user_data = nullptr);
 
+    /**
+     * @brief Set callback for ping replies
+     *
+     * @param callback Function to call when a client ping is echoed (nullptr to disable)
+     * @param user_data User-provided context pointer passed to callback
+     */
+    void set_pong_callback(ClientPongCallback callback, void* user_data = nullptr);
+
+    /**
+     * @brief Set the network link state source (see link_state.hpp)
+     *
+     * While backing off, no retry is made with the link down, and a retry
+     * is made as soon as it comes back instead of when the backoff expires.
+     *
+     * @param source Link state query (get_state nullptr to disable)
+     */
+    void set_link_state_source(const LinkStateSource& source);
+
     // ========================================================================
     // Connection Management
     // ========================================================================
@@ -396,6 +427,13 @@ public:
      */
     uint64_t get_last_rtt_ms() const;
 
+    /**
+     * @brief Get the link state last read from the link state source
+     *
+     * @return LinkState::Unknown if no source is set or not polled yet
+     */
+    LinkState get_link_state() const { return m_link_state; }
+
     // ========================================================================
     // Packet Sending
     // ========================================================================
@@ -462,6 +500,17 @@ public:
      */
     ClientOpResult send_ping();
 
+    /**
+     * @brief Send a client ping with a caller-chosen ID
+     *
+     * Unlike send_ping(), this does not touch the keepalive counters.
+     * The server echo is reported through the pong callback.
+     *
+     * @param ping_id ID to put in the ping request
+     * @return ClientOpResult indicating success or failure
+     */
+    ClientOpResult send_ping_request(uint8_t ping_id);
+
     /**
      * @brief Send a ping response to echo back a server ping
      *
@@ -536,11 +585,16 @@ private:
     ClientStateCallback m_state_callback;   ///< User callback for state changes
     ClientPacketCallback m_packet_callback; ///< User callback for packets
     void* m_packet_callback_user_data;      ///< User data for packet callback
+    ClientPongCallback m_pong_callback;     ///< User callback for ping replies
+    void* m_pong_callback_user_data;        ///< User data for pong callback
 
     uint64_t m_last_ping_time_ms;           ///< Time of last ping sent
     uint64_t m_backoff_start_time_ms;       ///< Start of current backoff period
     uint32_t m_current_backoff_delay_ms;    ///< Current backoff delay
 
+    LinkStateSource m_link_source;          ///< Network link state query
+    LinkState m_link_state;                 ///< Last link state read (in backoff)
+
     protocol::SessionId m_session_id;       ///< Our session ID (from server)
     protocol::MacAddress m_mac_address;     ///< Our MAC address
 
@@ -575,13 +629,16 @@ private:
 
     /**
      * @brief Process received packets
+     *
+     * @param current_time_ms Time of this update (for RTT measurement)
      */
-    void process_packets();
+    void process_packets(uint64_t current_time_ms);
 
     /**
      * @brief Handle a single received packet
      */
-    void handle_packet(protocol::PacketId id, const uint8_t* data, size_t size);
+    void handle_packet(protocol::PacketId id, const uint8_t* data, size_t size,
+                       uint64_t current_time_ms);
 
     /**
      * @brief Send Initialize handshake message
@@ -624,6 +681,13 @@ private:
      * @brief Check if backoff has expired
      */
     bool is_backoff_expired(uint64_t current_time_ms) const;
+
+    /**
+     * @brief Read the link state source
+     *
+     * @return true if the link just came back (Down -> Up)
+     */
+    bool poll_link_state();
 };
 
 /**
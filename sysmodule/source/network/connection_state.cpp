@@ -23,6 +23,7 @@
  */
 
 #include "connection_state.hpp"
+#include "../diagnostics/flight_recorder.hpp"
 
 namespace ryu_ldn {
 namespace network {
@@ -305,6 +306,7 @@ void ConnectionStateMachine::transition_to(ConnectionState new_state,
         if (old_state == ConnectionState::Backoff ||
             old_state == ConnectionState::Retrying) {
             m_retry_count++;
+            diagnostics::g_flight_recorder.reconnect(m_retry_count);
         }
     }
 
@@ -313,6 +315,11 @@ void ConnectionStateMachine::transition_to(ConnectionState new_state,
         m_retry_count = 0;
     }
 
+    diagnostics::g_flight_recorder.state_change(diagnostics::FlightStateMachine::Server,
+                                                static_cast<uint32_t>(old_state),
+                                                static_cast<uint32_t>(new_state),
+                                                static_cast<uint16_t>(event));
+
     // Notify callback if registered
     if (m_callback != nullptr) {
         m_callback(old_state, new_state, event);
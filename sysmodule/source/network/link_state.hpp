@@ -0,0 +1,61 @@
+/**
+ * @file link_state.hpp
+ * @brief Network link state source for reconnect scheduling
+ *
+ * RyuLdnClient backs off exponentially after a failed connection. When the
+ * failure is the local network going away (Wi-Fi drop, sleep), retrying on
+ * a timer is pointless while the link is down and slow once it is back. A
+ * LinkStateSource tells the client which case it is in:
+ *
+ * - Down: no retry is attempted and no retry is spent.
+ * - Down -> Up: the backoff is skipped and a reconnect is fired at once.
+ * - Up or Unknown: the usual backoff applies (server-side failures).
+ *
+ * The console reads the nifm internet connection status; host tests plug in
+ * a simulated source.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace ryu_ldn {
+namespace network {
+
+/**
+ * @brief State of the local network link
+ */
+enum class LinkState : uint8_t {
+    Unknown,    ///< No source, or the source cannot tell
+    Down,       ///< No usable network
+    Up          ///< Network available
+};
+
+/**
+ * @brief Pluggable link state query
+ *
+ * Polled from RyuLdnClient::update() while the client is in backoff, so it
+ * must be cheap and must not block.
+ */
+struct LinkStateSource {
+    LinkState (*get_state)(void* user_data);    ///< Current link state
+    void* user_data;                            ///< Passed to get_state
+};
+
+/**
+ * @brief Convert LinkState to string for logging
+ */
+inline const char* link_state_to_string(LinkState state) {
+    switch (state) {
+        case LinkState::Unknown: return "Unknown";
+        case LinkState::Down:    return "Down";
+        case LinkState::Up:      return "Up";
+        default:                 return "Invalid";
+    }
+}
+
+} // namespace network
+} // namespace ryu_ldn
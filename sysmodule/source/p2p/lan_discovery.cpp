@@ -0,0 +1,555 @@
+/**
+ * @file lan_discovery.cpp
+ * @brief LAN address discovery of a P2P host and the joiner's dial race
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "lan_discovery.hpp"
+#include "../protocol/ryu_protocol.hpp"
+#include "../platform/platform.hpp"
+
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
+namespace ryu_ldn::p2p {
+
+namespace {
+
+void set_non_blocking(int fd, bool enabled) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        ::fcntl(fd, F_SETFL, enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+    }
+}
+
+sockaddr_in make_address(uint32_t ipv4, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(ipv4);
+    return addr;
+}
+
+constexpr uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+void sha256_block(uint32_t* state, const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) | (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<uint32_t>(block[i * 4 + 2]) << 8) | static_cast<uint32_t>(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/**
+ * @brief Truncated SHA-256 of label || parts, the label separating uses
+ */
+void lan_digest(const char* label, const uint8_t* first, size_t first_size,
+                const uint8_t* second, size_t second_size, uint8_t* out) {
+    uint8_t input[64];
+    size_t label_size = std::strlen(label);
+    std::memcpy(input, label, label_size);
+    std::memcpy(input + label_size, first, first_size);
+    if (second_size != 0) {
+        std::memcpy(input + label_size + first_size, second, second_size);
+    }
+
+    uint8_t hash[32];
+    sha256(input, label_size + first_size + second_size, hash);
+    std::memcpy(out, hash, LAN_DIGEST_SIZE);
+}
+
+} // namespace
+
+// ============================================================================
+// Wire Format
+// ============================================================================
+
+void sha256(const void* data, size_t size, uint8_t* out) {
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t remaining = size;
+    while (remaining >= 64) {
+        sha256_block(state, bytes);
+        bytes += 64;
+        remaining -= 64;
+    }
+
+    // Padding: 0x80, zeros, then the length in bits (big endian)
+    uint8_t tail[128] = {};
+    std::memcpy(tail, bytes, remaining);
+    tail[remaining] = 0x80;
+    size_t tail_size = remaining < 56 ? 64 : 128;
+    uint64_t bits = static_cast<uint64_t>(size) * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[tail_size - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+    sha256_block(state, tail);
+    if (tail_size == 128) {
+        sha256_block(state, tail + 64);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        out[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+        out[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+        out[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+        out[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+    }
+}
+
+void lan_query_digest(const uint8_t* token, uint8_t* out) {
+    lan_digest("RLAN query", token, 16, nullptr, 0, out);
+}
+
+void lan_reply_digest(const uint8_t* token, const uint8_t* nonce, uint8_t* out) {
+    lan_digest("RLAN reply", nonce, LAN_NONCE_SIZE, token, 16, out);
+}
+
+LanMessage make_lan_query(const uint8_t* token, const uint8_t* nonce) {
+    LanMessage message{};
+    message.magic = LAN_DISCOVERY_MAGIC;
+    message.version = LAN_DISCOVERY_VERSION;
+    message.type = LanMessageType::Query;
+    lan_query_digest(token, message.digest);
+    std::memcpy(message.nonce, nonce, sizeof(message.nonce));
+    return message;
+}
+
+LanMessage make_lan_reply(const uint8_t* token, const uint8_t* nonce, uint16_t port) {
+    LanMessage message{};
+    message.magic = LAN_DISCOVERY_MAGIC;
+    message.version = LAN_DISCOVERY_VERSION;
+    message.type = LanMessageType::Reply;
+    message.port = port;
+    lan_reply_digest(token, nonce, message.digest);
+    std::memcpy(message.nonce, nonce, sizeof(message.nonce));
+    return message;
+}
+
+bool parse_lan_message(const uint8_t* data, size_t size, LanMessage& out) {
+    if (data == nullptr || size != sizeof(LanMessage)) {
+        return false;
+    }
+
+    std::memcpy(&out, data, sizeof(out));
+    if (out.magic != LAN_DISCOVERY_MAGIC || out.version != LAN_DISCOVERY_VERSION) {
+        return false;
+    }
+    return out.type == LanMessageType::Query || out.type == LanMessageType::Reply;
+}
+
+bool is_same_subnet(uint32_t ipv4, uint32_t own_ipv4, uint32_t netmask) {
+    if (own_ipv4 == 0 || netmask == 0) {
+        return false;
+    }
+    return (ipv4 & netmask) == (own_ipv4 & netmask);
+}
+
+uint32_t lan_broadcast_address(uint32_t ipv4, uint32_t netmask) {
+    if (ipv4 == 0 || netmask == 0) {
+        return 0;
+    }
+    return (ipv4 & netmask) | ~netmask;
+}
+
+// ============================================================================
+// LanResponder
+// ============================================================================
+
+LanResponder::LanResponder()
+    : m_fd(-1)
+    , m_port(0)
+{
+}
+
+LanResponder::~LanResponder() {
+    close();
+}
+
+bool LanResponder::open(uint32_t bind_ipv4, uint16_t port) {
+    close();
+
+    m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    int reuse = 1;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr = make_address(bind_ipv4, port);
+    if (::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close();
+        return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    if (::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0) {
+        m_port = ntohs(addr.sin_port);
+    }
+
+    set_non_blocking(m_fd, true);
+    return true;
+}
+
+void LanResponder::close() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_port = 0;
+}
+
+size_t LanResponder::poll(uint16_t p2p_port, TokenLookup lookup, void* user_data) {
+    if (m_fd < 0) {
+        return 0;
+    }
+
+    size_t replies = 0;
+    uint8_t buf[sizeof(LanMessage) + 1];
+    while (true) {
+        sockaddr_in from{};
+        socklen_t from_len = sizeof(from);
+        ssize_t n = ::recvfrom(m_fd, buf, sizeof(buf), 0,
+                               reinterpret_cast<sockaddr*>(&from), &from_len);
+        if (n < 0) {
+            break;  // Drained
+        }
+
+        LanMessage query;
+        if (!parse_lan_message(buf, static_cast<size_t>(n), query) ||
+            query.type != LanMessageType::Query) {
+            continue;
+        }
+
+        // Silent unless the master server announced this joiner to us
+        uint8_t token[16];
+        if (lookup == nullptr || !lookup(query.digest, token, user_data)) {
+            continue;
+        }
+
+        LanMessage reply = make_lan_reply(token, query.nonce, p2p_port);
+        if (::sendto(m_fd, &reply, sizeof(reply), 0,
+                     reinterpret_cast<sockaddr*>(&from), from_len) == sizeof(reply)) {
+            replies++;
+        }
+    }
+    return replies;
+}
+
+// ============================================================================
+// P2pDialer
+// ============================================================================
+
+P2pDialer::P2pDialer()
+    : m_attempts{}
+    , m_count(0)
+    , m_query_fd(-1)
+    , m_token{}
+    , m_nonce{}
+    , m_auth{}
+    , m_auth_size(0)
+    , m_proxy_config{}
+    , m_winner{}
+{
+}
+
+P2pDialer::~P2pDialer() {
+    close_all(-1);
+}
+
+void P2pDialer::close_all(int keep_fd) {
+    for (size_t i = 0; i < m_count; i++) {
+        if (m_attempts[i].fd >= 0 && m_attempts[i].fd != keep_fd) {
+            ::close(m_attempts[i].fd);
+        }
+        m_attempts[i].fd = -1;
+    }
+    if (m_query_fd >= 0) {
+        ::close(m_query_fd);
+        m_query_fd = -1;
+    }
+}
+
+void P2pDialer::add_candidate(uint32_t ipv4, uint16_t port, bool lan) {
+    if (ipv4 == 0 || port == 0) {
+        return;
+    }
+    for (size_t i = 0; i < m_count; i++) {
+        if (m_attempts[i].candidate.ipv4 == ipv4 && m_attempts[i].candidate.port == port) {
+            return;  // Repeated reply, or the LAN address is the external one
+        }
+    }
+    if (m_count >= P2P_DIAL_MAX_CANDIDATES) {
+        return;
+    }
+
+    Attempt& attempt = m_attempts[m_count++];
+    attempt.candidate = P2pDialCandidate{ipv4, port, lan};
+    attempt.fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    attempt.state = State::Failed;
+    attempt.received = 0;
+    if (attempt.fd < 0) {
+        return;
+    }
+
+    int nodelay = 1;
+    ::setsockopt(attempt.fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    set_non_blocking(attempt.fd, true);
+
+    sockaddr_in addr = make_address(ipv4, port);
+    int result = ::connect(attempt.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    if (result == 0 || errno == EINPROGRESS) {
+        attempt.state = State::Connecting;  // POLLOUT reports the outcome either way
+    } else {
+        ::close(attempt.fd);
+        attempt.fd = -1;
+    }
+}
+
+bool P2pDialer::open_query_socket() {
+    m_query_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_query_fd < 0) {
+        return false;
+    }
+
+    int broadcast = 1;
+    ::setsockopt(m_query_fd, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+    set_non_blocking(m_query_fd, true);
+    return true;
+}
+
+void P2pDialer::send_query(uint32_t ipv4, uint16_t port) {
+    LanMessage query = make_lan_query(m_token, m_nonce);
+    sockaddr_in addr = make_address(ipv4, port);
+    ::sendto(m_query_fd, &query, sizeof(query), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+}
+
+void P2pDialer::receive_replies() {
+    uint8_t buf[sizeof(LanMessage) + 1];
+    while (true) {
+        sockaddr_in from{};
+        socklen_t from_len = sizeof(from);
+        ssize_t n = ::recvfrom(m_query_fd, buf, sizeof(buf), 0,
+                               reinterpret_cast<sockaddr*>(&from), &from_len);
+        if (n < 0) {
+            return;
+        }
+
+        // Only a host that knows the token can answer our nonce
+        uint8_t expected[LAN_DIGEST_SIZE];
+        lan_reply_digest(m_token, m_nonce, expected);
+
+        LanMessage reply;
+        if (parse_lan_message(buf, static_cast<size_t>(n), reply) &&
+            reply.type == LanMessageType::Reply &&
+            std::memcmp(reply.digest, expected, sizeof(expected)) == 0) {
+            // The host's LAN address is the one the reply came from
+            add_candidate(ntohl(from.sin_addr.s_addr), reply.port, true);
+        }
+    }
+}
+
+void P2pDialer::on_writable(Attempt& attempt) {
+    int so_error = 0;
+    socklen_t len = sizeof(so_error);
+    if (::getsockopt(attempt.fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0 || so_error != 0 ||
+        ::send(attempt.fd, m_auth, m_auth_size, 0) != static_cast<ssize_t>(m_auth_size)) {
+        attempt.state = State::Failed;
+        return;
+    }
+    attempt.state = State::Authenticating;
+}
+
+bool P2pDialer::on_readable(Attempt& attempt) {
+    // Read the header, then exactly its payload: later packets stay queued
+    size_t needed = sizeof(protocol::LdnHeader);
+    if (attempt.received >= sizeof(protocol::LdnHeader)) {
+        needed = sizeof(attempt.buffer);
+    }
+
+    ssize_t n = ::recv(attempt.fd, attempt.buffer + attempt.received, needed - attempt.received, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return false;
+    }
+    if (n <= 0) {
+        attempt.state = State::Failed;  // Refused: the token was consumed by another attempt
+        return false;
+    }
+    attempt.received += static_cast<size_t>(n);
+
+    if (attempt.received == sizeof(protocol::LdnHeader)) {
+        protocol::LdnHeader header;
+        std::memcpy(&header, attempt.buffer, sizeof(header));
+        if (header.magic != protocol::PROTOCOL_MAGIC ||
+            header.version != protocol::PROTOCOL_VERSION ||
+            header.type != static_cast<uint8_t>(protocol::PacketId::ProxyConfig) ||
+            header.data_size != static_cast<int32_t>(sizeof(protocol::ProxyConfig))) {
+            attempt.state = State::Failed;
+        }
+        return false;
+    }
+    return attempt.received == sizeof(attempt.buffer);
+}
+
+bool P2pDialer::pending() const {
+    for (size_t i = 0; i < m_count; i++) {
+        if (m_attempts[i].state != State::Failed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int P2pDialer::dial(const protocol::ExternalProxyConfig& config, uint32_t lan_query_ipv4,
+                    uint16_t lan_query_port, uint32_t timeout_ms) {
+    close_all(-1);
+    m_count = 0;
+    m_proxy_config = {};
+    m_winner = {};
+    std::memcpy(m_token, config.token, sizeof(m_token));
+    platform::FillRandom(m_nonce, sizeof(m_nonce));
+
+    if (protocol::encode(m_auth, sizeof(m_auth), protocol::PacketId::ExternalProxy,
+                         config, m_auth_size) != protocol::EncodeResult::Success) {
+        return -1;
+    }
+
+    // ExternalProxyConfig carries the address in network order
+    if (config.address_family == AF_INET) {
+        uint32_t external = (static_cast<uint32_t>(config.proxy_ip[0]) << 24) |
+                            (static_cast<uint32_t>(config.proxy_ip[1]) << 16) |
+                            (static_cast<uint32_t>(config.proxy_ip[2]) << 8) |
+                            static_cast<uint32_t>(config.proxy_ip[3]);
+        add_candidate(external, config.proxy_port, false);
+    }
+
+    const uint64_t start_ms = platform::GetTickMs();
+    const uint64_t deadline_ms = start_ms + timeout_ms;
+    int queries_left = (lan_query_ipv4 != 0 && open_query_socket()) ? LAN_QUERY_ATTEMPTS : 0;
+    uint64_t next_query_ms = start_ms;
+    uint64_t replies_until_ms = start_ms;
+
+    while (true) {
+        uint64_t now_ms = platform::GetTickMs();
+        if (queries_left > 0 && now_ms >= next_query_ms) {
+            send_query(lan_query_ipv4, lan_query_port);
+            queries_left--;
+            next_query_ms = now_ms + LAN_QUERY_INTERVAL_MS;
+            replies_until_ms = now_ms + LAN_REPLY_WAIT_MS;
+        }
+
+        bool listening = m_query_fd >= 0 && (queries_left > 0 || now_ms < replies_until_ms);
+        if (now_ms >= deadline_ms || (!listening && !pending())) {
+            break;
+        }
+
+        pollfd fds[P2P_DIAL_MAX_CANDIDATES + 1];
+        size_t owners[P2P_DIAL_MAX_CANDIDATES + 1];
+        nfds_t nfds = 0;
+        if (listening) {
+            fds[nfds] = pollfd{m_query_fd, POLLIN, 0};
+            owners[nfds++] = P2P_DIAL_MAX_CANDIDATES;
+        }
+        for (size_t i = 0; i < m_count; i++) {
+            const Attempt& attempt = m_attempts[i];
+            if (attempt.state == State::Failed) {
+                continue;
+            }
+            short events = attempt.state == State::Connecting ? POLLOUT : POLLIN;
+            fds[nfds] = pollfd{attempt.fd, events, 0};
+            owners[nfds++] = i;
+        }
+
+        uint64_t wake_ms = deadline_ms;
+        if (queries_left > 0 && next_query_ms < wake_ms) {
+            wake_ms = next_query_ms;
+        } else if (listening && replies_until_ms < wake_ms) {
+            wake_ms = replies_until_ms;
+        }
+
+        int ready = ::poll(fds, nfds, static_cast<int>(wake_ms > now_ms ? wake_ms - now_ms : 0));
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        for (nfds_t i = 0; i < nfds; i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            if (owners[i] == P2P_DIAL_MAX_CANDIDATES) {
+                receive_replies();
+                continue;
+            }
+
+            Attempt& attempt = m_attempts[owners[i]];
+            if (attempt.state == State::Connecting) {
+                on_writable(attempt);
+            } else if (attempt.state == State::Authenticating && on_readable(attempt)) {
+                std::memcpy(&m_proxy_config, attempt.buffer + sizeof(protocol::LdnHeader),
+                            sizeof(m_proxy_config));
+                m_winner = attempt.candidate;
+
+                int fd = attempt.fd;
+                close_all(fd);
+                set_non_blocking(fd, false);
+                return fd;
+            }
+        }
+    }
+
+    close_all(-1);
+    return -1;
+}
+
+} // namespace ryu_ldn::p2p
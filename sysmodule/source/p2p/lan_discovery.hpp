@@ -0,0 +1,342 @@
+/**
+ * @file lan_discovery.hpp
+ * @brief LAN address discovery of a P2P host and the joiner's dial race
+ *
+ * The master server sends a joiner the host's external (port-mapped)
+ * address in ExternalProxyConfig. When both consoles sit behind the same
+ * router, that address only works if the router hairpins, and many
+ * consumer routers either don't or do it on a slow path: the P2P link
+ * fails and the session falls back to the internet relay.
+ *
+ * A ryu_ldn_nx joiner therefore also asks the LAN: it broadcasts a query
+ * identifying the auth token it received, and a ryu_ldn_nx host expecting
+ * that token answers with its private P2P port. The joiner dials the
+ * external address and every LAN answer in parallel, sends the same auth
+ * on each connection, and keeps the first one the host answers with
+ * ProxyConfig. The host consumes the token on the first auth, so the other
+ * connections are refused and closed.
+ *
+ * Off by default (`[ldn] lan_discovery = 1` enables it).
+ *
+ * ## Security
+ *
+ * The LAN may be shared (venue Wi-Fi), and whoever presents the token
+ * first takes the joiner's slot, so the token itself never goes on the
+ * broadcast:
+ *
+ * - The query carries lan_query_digest(token), a truncated SHA-256 the
+ *   host compares with the tokens it expects, and a random nonce.
+ * - The reply carries lan_reply_digest(token, nonce). Only a host that
+ *   knows the token can produce it, so a forged or replayed reply never
+ *   makes the joiner send its auth to another device.
+ * - The host accepts an auth from a source address other than the one the
+ *   master server announced only if it is on the host's own subnet.
+ *
+ * ## Wire Format
+ *
+ * UDP to LAN_DISCOVERY_PORT (query: subnet broadcast, reply: unicast back):
+ *
+ * ```
+ * 0x00    4     magic ("RLAN")
+ * 0x04    1     version
+ * 0x05    1     type (Query, Reply)
+ * 0x06    2     port (Reply: host's private P2P port)
+ * 0x08    16    digest (Query: lan_query_digest, Reply: lan_reply_digest)
+ * 0x18    16    nonce (Query: random per dial, Reply: echoed)
+ * ```
+ *
+ * The query is repeated every LAN_QUERY_INTERVAL_MS: the joiner's
+ * ExternalProxyConfig and the host's ExternalProxyToken leave the master
+ * server together, so the first query can reach the host before its token.
+ *
+ * ## Platform Independence
+ *
+ * Uses BSD sockets only; libnx provides the same API on the console. The
+ * query destination is supplied by the caller (subnet broadcast from nifm
+ * on the console, a loopback alias in tests/lan_discovery_tests.cpp).
+ *
+ * ## Thread Safety
+ *
+ * NOT thread-safe. Each instance is used by one thread.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "../protocol/types.hpp"
+
+namespace ryu_ldn::p2p {
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+/// Magic of a discovery message ("RLAN")
+constexpr uint32_t LAN_DISCOVERY_MAGIC = 0x4E414C52;
+
+/// Protocol version carried in discovery messages
+constexpr uint8_t LAN_DISCOVERY_VERSION = 2;
+
+/// Bytes of a token digest on the wire (truncated SHA-256)
+constexpr size_t LAN_DIGEST_SIZE = 16;
+
+/// Bytes of the joiner's query nonce
+constexpr size_t LAN_NONCE_SIZE = 16;
+
+/// UDP port hosts listen on (just below P2pProxyServer's private port range)
+constexpr uint16_t LAN_DISCOVERY_PORT = 39989;
+
+/// Interval between two queries of one dial
+constexpr uint32_t LAN_QUERY_INTERVAL_MS = 100;
+
+/// Queries sent per dial
+constexpr int LAN_QUERY_ATTEMPTS = 4;
+
+/// Time a reply is still waited for after the last query
+constexpr uint32_t LAN_REPLY_WAIT_MS = 200;
+
+/// Addresses dialed in parallel (external + LAN answers)
+constexpr size_t P2P_DIAL_MAX_CANDIDATES = 4;
+
+/**
+ * @brief Discovery message type
+ */
+enum class LanMessageType : uint8_t {
+    Query = 1,  ///< Joiner -> LAN broadcast: who expects this token?
+    Reply = 2,  ///< Host -> joiner: I do, dial this port
+};
+
+/**
+ * @brief Discovery message - 40 bytes
+ */
+struct __attribute__((packed)) LanMessage {
+    uint32_t magic;
+    uint8_t  version;
+    LanMessageType type;
+    uint16_t port;
+    uint8_t  digest[LAN_DIGEST_SIZE];
+    uint8_t  nonce[LAN_NONCE_SIZE];
+};
+static_assert(sizeof(LanMessage) == 40, "LanMessage must be 40 bytes");
+
+/**
+ * @brief SHA-256 of a buffer
+ *
+ * @param out 32 bytes
+ */
+void sha256(const void* data, size_t size, uint8_t* out);
+
+/**
+ * @brief Digest of a token identifying it in a query
+ *
+ * @param token 16-byte auth token
+ * @param out LAN_DIGEST_SIZE bytes
+ */
+void lan_query_digest(const uint8_t* token, uint8_t* out);
+
+/**
+ * @brief Digest proving a reply comes from a host that knows the token
+ *
+ * @param token 16-byte auth token
+ * @param nonce LAN_NONCE_SIZE bytes from the query
+ * @param out LAN_DIGEST_SIZE bytes
+ */
+void lan_reply_digest(const uint8_t* token, const uint8_t* nonce, uint8_t* out);
+
+/**
+ * @brief Build a query for a token
+ *
+ * @param token 16-byte auth token
+ * @param nonce LAN_NONCE_SIZE random bytes
+ */
+LanMessage make_lan_query(const uint8_t* token, const uint8_t* nonce);
+
+/**
+ * @brief Build the reply to a query
+ *
+ * @param token 16-byte auth token the query matched
+ * @param nonce Nonce of the query
+ * @param port Private P2P port
+ */
+LanMessage make_lan_reply(const uint8_t* token, const uint8_t* nonce, uint16_t port);
+
+/**
+ * @brief Validate a received discovery message
+ *
+ * @return true if magic, version, size and type are valid
+ */
+bool parse_lan_message(const uint8_t* data, size_t size, LanMessage& out);
+
+/**
+ * @brief Whether an address is on the given subnet
+ *
+ * @param ipv4 Address to check (host byte order)
+ * @param own_ipv4 Own address (host byte order)
+ * @param netmask Own subnet mask (host byte order)
+ * @return false if either own_ipv4 or netmask is unknown (0)
+ */
+bool is_same_subnet(uint32_t ipv4, uint32_t own_ipv4, uint32_t netmask);
+
+/**
+ * @brief Subnet-directed broadcast address
+ *
+ * @param ipv4 Own address (host byte order)
+ * @param netmask Subnet mask (host byte order)
+ * @return Broadcast address, or 0 if either is unknown
+ */
+uint32_t lan_broadcast_address(uint32_t ipv4, uint32_t netmask);
+
+// ============================================================================
+// LanResponder - Host Side
+// ============================================================================
+
+/**
+ * @brief Answers discovery queries for the tokens a host is expecting
+ *
+ * Non-blocking: the owner polls fd() for POLLIN and calls poll().
+ */
+class LanResponder {
+public:
+    /**
+     * @brief Token lookup supplied by the owner
+     *
+     * @param digest lan_query_digest of the queried token
+     * @param token_out Receives the 16-byte token on a match
+     * @return true if a joiner with this token is expected
+     */
+    using TokenLookup = bool (*)(const uint8_t* digest, uint8_t* token_out, void* user_data);
+
+    LanResponder();
+    ~LanResponder();
+
+    LanResponder(const LanResponder&) = delete;
+    LanResponder& operator=(const LanResponder&) = delete;
+
+    /**
+     * @brief Bind the UDP socket
+     *
+     * @param bind_ipv4 Local address (host byte order, 0 = any)
+     * @param port LAN_DISCOVERY_PORT, or 0 for an ephemeral port (tests)
+     */
+    bool open(uint32_t bind_ipv4, uint16_t port);
+
+    void close();
+
+    int fd() const { return m_fd; }
+
+    /**
+     * @brief Bound port
+     */
+    uint16_t port() const { return m_port; }
+
+    /**
+     * @brief Answer every pending query
+     *
+     * @param p2p_port Private P2P port to advertise
+     * @param lookup Token lookup
+     * @param user_data Passed to lookup
+     * @return Number of replies sent
+     */
+    size_t poll(uint16_t p2p_port, TokenLookup lookup, void* user_data);
+
+private:
+    int m_fd;
+    uint16_t m_port;
+};
+
+// ============================================================================
+// P2pDialer - Joiner Side
+// ============================================================================
+
+/**
+ * @brief Address the dialer tried
+ */
+struct P2pDialCandidate {
+    uint32_t ipv4;  ///< Host byte order
+    uint16_t port;
+    bool     lan;   ///< Learned from a LAN reply
+};
+
+/**
+ * @brief Dials the external address and the LAN answers in parallel
+ *
+ * Each connection sends the ExternalProxy auth as soon as it is
+ * established; the first to receive ProxyConfig wins. Exactly the
+ * ProxyConfig packet is read from the winner, so anything the host sent
+ * after it is still in the socket for the receive loop.
+ */
+class P2pDialer {
+public:
+    P2pDialer();
+    ~P2pDialer();
+
+    P2pDialer(const P2pDialer&) = delete;
+    P2pDialer& operator=(const P2pDialer&) = delete;
+
+    /**
+     * @brief Dial and authenticate (blocking)
+     *
+     * @param config ExternalProxyConfig from the master server
+     * @param lan_query_ipv4 Query destination (host byte order, 0 = external only)
+     * @param lan_query_port LAN_DISCOVERY_PORT (tests: a responder's port)
+     * @param timeout_ms Overall budget (connect + auth)
+     * @return Authenticated blocking socket owned by the caller, or -1
+     */
+    int dial(const protocol::ExternalProxyConfig& config, uint32_t lan_query_ipv4,
+             uint16_t lan_query_port, uint32_t timeout_ms);
+
+    /**
+     * @brief ProxyConfig the host answered (valid after a successful dial)
+     */
+    const protocol::ProxyConfig& proxy_config() const { return m_proxy_config; }
+
+    /**
+     * @brief Address that won (valid after a successful dial)
+     */
+    const P2pDialCandidate& winner() const { return m_winner; }
+
+    /**
+     * @brief Addresses tried by the last dial
+     */
+    size_t candidate_count() const { return m_count; }
+
+private:
+    enum class State : uint8_t {
+        Connecting,
+        Authenticating,
+        Failed,
+    };
+
+    struct Attempt {
+        P2pDialCandidate candidate;
+        int      fd;
+        State    state;
+        size_t   received;
+        uint8_t  buffer[sizeof(protocol::LdnHeader) + sizeof(protocol::ProxyConfig)];
+    };
+
+    void add_candidate(uint32_t ipv4, uint16_t port, bool lan);
+    bool open_query_socket();
+    void send_query(uint32_t ipv4, uint16_t port);
+    void receive_replies();
+    void on_writable(Attempt& attempt);
+    bool on_readable(Attempt& attempt);
+    bool pending() const;
+    void close_all(int keep_fd);
+
+    Attempt m_attempts[P2P_DIAL_MAX_CANDIDATES];
+    size_t m_count;
+    int m_query_fd;
+    uint8_t m_token[16];
+    uint8_t m_nonce[LAN_NONCE_SIZE];
+    uint8_t m_auth[64];
+    size_t m_auth_size;
+    protocol::ProxyConfig m_proxy_config;
+    P2pDialCandidate m_winner;
+};
+
+} // namespace ryu_ldn::p2p
@@ -0,0 +1,496 @@
+/**
+ * @file natpmp_client.cpp
+ * @brief NAT-PMP (RFC 6886) and PCP (RFC 6887) port mapping backend
+ *
+ * ## Packet Layouts (all fields big-endian)
+ *
+ * NAT-PMP mapping request (12 bytes):
+ * ```
+ * 0 version=0 | 1 opcode=2 (TCP) | 2 reserved(2) | 4 internal port(2)
+ * 6 suggested external port(2) | 8 lifetime(4)
+ * ```
+ *
+ * PCP MAP request (24 byte header + 36 byte MAP payload):
+ * ```
+ * 0 version=2 | 1 R=0,opcode=1 | 2 reserved(2) | 4 lifetime(4)
+ * 8 client IP (IPv4-mapped IPv6, 16)
+ * 24 nonce(12) | 36 protocol=6 | 37 reserved(3) | 40 internal port(2)
+ * 42 suggested external port(2) | 44 suggested external IP(16)
+ * ```
+ *
+ * Responses set the high bit of the opcode (PCP) or add 128 (NAT-PMP)
+ * and carry a result code, the gateway epoch and the granted values.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "natpmp_client.hpp"
+#include "../debug/log.hpp"
+
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
+namespace ryu_ldn::p2p {
+
+namespace {
+
+void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+uint16_t get_u16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t get_u32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8)  |  static_cast<uint32_t>(p[3]);
+}
+
+/// Write an IPv4 address as IPv4-mapped IPv6 (::ffff:a.b.c.d)
+void put_mapped_ipv4(uint8_t* p, uint32_t ipv4) {
+    std::memset(p, 0, 10);
+    p[10] = 0xFF;
+    p[11] = 0xFF;
+    put_u32(p + 12, ipv4);
+}
+
+/// Read an IPv4-mapped IPv6 address, 0 if it is a real IPv6 address
+uint32_t get_mapped_ipv4(const uint8_t* p) {
+    static const uint8_t prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+    if (std::memcmp(p, prefix, sizeof(prefix)) != 0) {
+        return 0;
+    }
+    return get_u32(p + 12);
+}
+
+constexpr size_t PCP_HEADER_SIZE = 24;
+constexpr size_t PCP_MAP_SIZE = PCP_HEADER_SIZE + 36;
+constexpr size_t NATPMP_ERROR_SIZE = 8;
+constexpr uint8_t PCP_RESPONSE_BIT = 0x80;
+constexpr uint8_t NATPMP_RESPONSE_OFFSET = 128;
+
+} // namespace
+
+// ============================================================================
+// Wire Format
+// ============================================================================
+
+size_t encode_natpmp_address_request(uint8_t* buf) {
+    buf[0] = NATPMP_VERSION;
+    buf[1] = NATPMP_OP_EXTERNAL_ADDRESS;
+    return 2;
+}
+
+size_t encode_natpmp_map_request(uint8_t* buf, uint16_t internal_port,
+                                 uint16_t external_port, uint32_t lifetime_s) {
+    buf[0] = NATPMP_VERSION;
+    buf[1] = NATPMP_OP_MAP_TCP;
+    put_u16(buf + 2, 0);
+    put_u16(buf + 4, internal_port);
+    put_u16(buf + 6, external_port);
+    put_u32(buf + 8, lifetime_s);
+    return 12;
+}
+
+size_t encode_pcp_announce_request(uint8_t* buf, uint32_t client_ipv4) {
+    std::memset(buf, 0, PCP_HEADER_SIZE);
+    buf[0] = PCP_VERSION;
+    buf[1] = PCP_OP_ANNOUNCE;
+    put_mapped_ipv4(buf + 8, client_ipv4);
+    return PCP_HEADER_SIZE;
+}
+
+size_t encode_pcp_map_request(uint8_t* buf, const uint8_t nonce[PCP_NONCE_SIZE],
+                              uint32_t client_ipv4, uint16_t internal_port,
+                              uint16_t external_port, uint32_t lifetime_s) {
+    std::memset(buf, 0, PCP_MAP_SIZE);
+    buf[0] = PCP_VERSION;
+    buf[1] = PCP_OP_MAP;
+    put_u32(buf + 4, lifetime_s);
+    put_mapped_ipv4(buf + 8, client_ipv4);
+
+    std::memcpy(buf + 24, nonce, PCP_NONCE_SIZE);
+    buf[36] = PCP_PROTOCOL_TCP;
+    put_u16(buf + 40, internal_port);
+    put_u16(buf + 42, external_port);
+    put_mapped_ipv4(buf + 44, 0);  // No preferred external address
+    return PCP_MAP_SIZE;
+}
+
+bool decode_natpmp_response(const uint8_t* buf, size_t size, NatPmpResponse& out) {
+    std::memset(&out, 0, sizeof(out));
+    if (buf == nullptr || size < 2) {
+        return false;
+    }
+
+    if (buf[0] == NATPMP_VERSION) {
+        if (size < NATPMP_ERROR_SIZE || buf[1] < NATPMP_RESPONSE_OFFSET) {
+            return false;
+        }
+        out.protocol = NatPmpProtocol::NatPmp;
+        out.opcode = static_cast<uint8_t>(buf[1] - NATPMP_RESPONSE_OFFSET);
+        out.result = get_u16(buf + 2);
+        out.epoch = get_u32(buf + 4);
+        if (out.result != 0) {
+            return true;  // Error responses may be truncated to 8 bytes
+        }
+
+        if (out.opcode == NATPMP_OP_EXTERNAL_ADDRESS) {
+            if (size < 12) return false;
+            out.external_ipv4 = get_u32(buf + 8);
+        } else if (out.opcode == NATPMP_OP_MAP_UDP || out.opcode == NATPMP_OP_MAP_TCP) {
+            if (size < 16) return false;
+            out.internal_port = get_u16(buf + 8);
+            out.external_port = get_u16(buf + 10);
+            out.lifetime_s = get_u32(buf + 12);
+        }
+        return true;
+    }
+
+    if (buf[0] == PCP_VERSION) {
+        if (size < PCP_HEADER_SIZE || (buf[1] & PCP_RESPONSE_BIT) == 0) {
+            return false;
+        }
+        out.protocol = NatPmpProtocol::Pcp;
+        out.opcode = static_cast<uint8_t>(buf[1] & ~PCP_RESPONSE_BIT);
+        out.result = buf[3];
+        out.lifetime_s = get_u32(buf + 4);
+        out.epoch = get_u32(buf + 8);
+
+        if (out.opcode == PCP_OP_MAP) {
+            if (size < PCP_MAP_SIZE) return false;
+            std::memcpy(out.nonce, buf + 24, PCP_NONCE_SIZE);
+            out.internal_port = get_u16(buf + 40);
+            out.external_port = get_u16(buf + 42);
+            out.external_ipv4 = get_mapped_ipv4(buf + 44);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// ============================================================================
+// NatPmpClient - Lifecycle
+// ============================================================================
+
+NatPmpClient::NatPmpClient()
+    : m_gateway_ipv4(0)
+    , m_gateway_port(NATPMP_PORT)
+    , m_fd(-1)
+    , m_local_ipv4(0)
+    , m_external_ipv4(0)
+    , m_protocol(NatPmpProtocol::None)
+    , m_status(DiscoverStatus::Idle)
+    , m_probing(NatPmpProtocol::None)
+    , m_attempt(0)
+    , m_deadline_ms(0)
+    , m_timeout_ms(NATPMP_INITIAL_TIMEOUT_MS)
+    , m_nonce{}
+{
+}
+
+NatPmpClient::~NatPmpClient() {
+    close_socket();
+}
+
+void NatPmpClient::set_gateway(uint32_t gateway_ipv4, uint16_t port) {
+    if (gateway_ipv4 == m_gateway_ipv4 && port == m_gateway_port) {
+        return;
+    }
+    close_socket();
+    m_gateway_ipv4 = gateway_ipv4;
+    m_gateway_port = port;
+    m_protocol = NatPmpProtocol::None;
+    m_status = DiscoverStatus::Idle;
+    m_external_ipv4 = 0;
+}
+
+const char* NatPmpClient::name() const {
+    return m_protocol == NatPmpProtocol::Pcp ? "PCP" : "NAT-PMP";
+}
+
+bool NatPmpClient::open_socket() {
+    if (m_fd >= 0) {
+        return true;
+    }
+    if (m_gateway_ipv4 == 0) {
+        return false;
+    }
+
+    m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    // Connecting filters replies to the gateway and tells us our LAN address
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_gateway_port);
+    addr.sin_addr.s_addr = htonl(m_gateway_ipv4);
+    if (::connect(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close_socket();
+        return false;
+    }
+
+    sockaddr_in local{};
+    socklen_t local_len = sizeof(local);
+    if (::getsockname(m_fd, reinterpret_cast<sockaddr*>(&local), &local_len) == 0) {
+        m_local_ipv4 = ntohl(local.sin_addr.s_addr);
+    }
+
+    int flags = ::fcntl(m_fd, F_GETFL, 0);
+    ::fcntl(m_fd, F_SETFL, flags | O_NONBLOCK);
+    return true;
+}
+
+void NatPmpClient::close_socket() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool NatPmpClient::send_packet(const uint8_t* data, size_t size) {
+    return ::send(m_fd, data, size, 0) == static_cast<ssize_t>(size);
+}
+
+bool NatPmpClient::try_receive(NatPmpResponse& out) {
+    uint8_t buf[NATPMP_MAX_PACKET + 4];
+    while (true) {
+        ssize_t n = ::recv(m_fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return false;  // Nothing waiting, or ICMP port unreachable
+        }
+        if (decode_natpmp_response(buf, static_cast<size_t>(n), out)) {
+            return true;
+        }
+    }
+}
+
+// ============================================================================
+// NatPmpClient - Discovery
+// ============================================================================
+
+size_t NatPmpClient::encode_discover_request(uint8_t* buf) const {
+    if (m_probing == NatPmpProtocol::Pcp) {
+        return encode_pcp_announce_request(buf, m_local_ipv4);
+    }
+    return encode_natpmp_address_request(buf);
+}
+
+void NatPmpClient::send_discover_request(uint64_t now_ms) {
+    uint8_t buf[NATPMP_MAX_PACKET];
+    size_t size = encode_discover_request(buf);
+    send_packet(buf, size);
+    m_deadline_ms = now_ms + m_timeout_ms;
+}
+
+void NatPmpClient::begin_discover(uint64_t now_ms) {
+    // Keep the negotiated protocol; the gateway does not change under us
+    if (m_protocol != NatPmpProtocol::None && m_fd >= 0) {
+        m_status = DiscoverStatus::Ready;
+        return;
+    }
+
+    if (!open_socket()) {
+        m_status = DiscoverStatus::Failed;
+        return;
+    }
+
+    // One nonce for the lifetime of the client so renewals match (RFC 6887 11.1)
+    bool have_nonce = false;
+    for (uint8_t b : m_nonce) have_nonce |= (b != 0);
+    if (!have_nonce) {
+        uint64_t x = now_ms ^ reinterpret_cast<uintptr_t>(this) ^ 0x9E3779B97F4A7C15ULL;
+        for (size_t i = 0; i < PCP_NONCE_SIZE; i++) {
+            // splitmix64 step
+            x += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            m_nonce[i] = static_cast<uint8_t>(z ^ (z >> 31));
+        }
+    }
+
+    m_probing = NatPmpProtocol::Pcp;
+    m_attempt = 0;
+    m_timeout_ms = NATPMP_INITIAL_TIMEOUT_MS;
+    m_status = DiscoverStatus::Pending;
+    send_discover_request(now_ms);
+}
+
+DiscoverStatus NatPmpClient::poll_discover(uint64_t now_ms) {
+    if (m_status != DiscoverStatus::Pending) {
+        return m_status;
+    }
+
+    NatPmpResponse resp;
+    while (try_receive(resp)) {
+        if (m_probing == NatPmpProtocol::Pcp) {
+            if (resp.protocol == NatPmpProtocol::Pcp && resp.opcode == PCP_OP_ANNOUNCE &&
+                resp.result == 0) {
+                m_protocol = NatPmpProtocol::Pcp;
+                m_status = DiscoverStatus::Ready;
+                LOG_INFO("NatPmp: gateway speaks PCP");
+                return m_status;
+            }
+            // NAT-PMP-only gateways answer a v2 request with UNSUPP_VERSION
+            LOG_VERBOSE("NatPmp: PCP refused (result %u), trying NAT-PMP", resp.result);
+            m_probing = NatPmpProtocol::NatPmp;
+            m_attempt = 0;
+            m_timeout_ms = NATPMP_INITIAL_TIMEOUT_MS;
+            send_discover_request(now_ms);
+            continue;
+        }
+
+        if (resp.protocol == NatPmpProtocol::NatPmp &&
+            resp.opcode == NATPMP_OP_EXTERNAL_ADDRESS) {
+            if (resp.result != 0) {
+                m_status = DiscoverStatus::Failed;
+                return m_status;
+            }
+            m_external_ipv4 = resp.external_ipv4;
+            m_protocol = NatPmpProtocol::NatPmp;
+            m_status = DiscoverStatus::Ready;
+            LOG_INFO("NatPmp: gateway speaks NAT-PMP");
+            return m_status;
+        }
+    }
+
+    if (now_ms >= m_deadline_ms) {
+        m_attempt++;
+        int max_attempts = (m_probing == NatPmpProtocol::Pcp) ? PCP_DISCOVER_ATTEMPTS
+                                                               : NATPMP_MAX_ATTEMPTS;
+        if (m_attempt >= max_attempts) {
+            if (m_probing == NatPmpProtocol::Pcp) {
+                // Some old NAT-PMP gateways silently drop unknown versions
+                m_probing = NatPmpProtocol::NatPmp;
+                m_attempt = 0;
+                m_timeout_ms = NATPMP_INITIAL_TIMEOUT_MS;
+            } else {
+                m_status = DiscoverStatus::Failed;
+                return m_status;
+            }
+        } else {
+            m_timeout_ms *= 2;
+        }
+        send_discover_request(now_ms);
+    }
+
+    return m_status;
+}
+
+// ============================================================================
+// NatPmpClient - Mappings
+// ============================================================================
+
+bool NatPmpClient::transact(const uint8_t* data, size_t size, uint8_t opcode,
+                            NatPmpResponse& out) {
+    uint32_t timeout_ms = NATPMP_INITIAL_TIMEOUT_MS;
+
+    for (int attempt = 0; attempt < NATPMP_MAX_ATTEMPTS; attempt++) {
+        if (!send_packet(data, size)) {
+            return false;
+        }
+
+        pollfd pfd{};
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        while (::poll(&pfd, 1, static_cast<int>(timeout_ms)) > 0) {
+            if (!try_receive(out)) {
+                break;
+            }
+            if (out.protocol != m_protocol || out.opcode != opcode) {
+                continue;
+            }
+            if (m_protocol == NatPmpProtocol::Pcp && out.result == 0 &&
+                std::memcmp(out.nonce, m_nonce, PCP_NONCE_SIZE) != 0) {
+                continue;  // Reply for someone else's mapping
+            }
+            return true;
+        }
+        timeout_ms *= 2;
+    }
+    return false;
+}
+
+bool NatPmpClient::request_mapping(uint16_t internal_port, uint16_t external_port,
+                                   uint32_t lifetime_s, NatPmpResponse& out) {
+    uint8_t buf[NATPMP_MAX_PACKET];
+
+    if (m_protocol == NatPmpProtocol::Pcp) {
+        size_t size = encode_pcp_map_request(buf, m_nonce, m_local_ipv4, internal_port,
+                                             external_port, lifetime_s);
+        return transact(buf, size, PCP_OP_MAP, out);
+    }
+
+    size_t size = encode_natpmp_map_request(buf, internal_port, external_port, lifetime_s);
+    return transact(buf, size, NATPMP_OP_MAP_TCP, out);
+}
+
+bool NatPmpClient::add_mapping(uint16_t internal_port, uint16_t external_port,
+                               uint32_t lifetime_s, uint16_t& mapped_port,
+                               uint32_t& granted_lifetime_s) {
+    if (m_protocol == NatPmpProtocol::None || m_fd < 0) {
+        return false;
+    }
+
+    NatPmpResponse resp;
+    if (!request_mapping(internal_port, external_port, lifetime_s, resp)) {
+        LOG_WARN("NatPmp: no reply to mapping request for port %u", external_port);
+        return false;
+    }
+    if (resp.result != 0 || resp.external_port == 0) {
+        LOG_WARN("NatPmp: mapping for port %u refused (result %u)", external_port, resp.result);
+        return false;
+    }
+
+    if (resp.external_ipv4 != 0) {
+        m_external_ipv4 = resp.external_ipv4;
+    }
+    mapped_port = resp.external_port;
+    granted_lifetime_s = resp.lifetime_s;
+    return true;
+}
+
+bool NatPmpClient::delete_mapping(uint16_t internal_port, uint16_t external_port) {
+    if (m_protocol == NatPmpProtocol::None || m_fd < 0) {
+        return false;
+    }
+
+    // NAT-PMP deletes with external port 0 (RFC 6886 3.4); PCP matches by nonce
+    uint16_t suggested = (m_protocol == NatPmpProtocol::Pcp) ? external_port : 0;
+    NatPmpResponse resp;
+    if (!request_mapping(internal_port, suggested, 0, resp)) {
+        return false;
+    }
+    return resp.result == 0;
+}
+
+uint32_t NatPmpClient::get_external_ipv4() {
+    return m_external_ipv4;
+}
+
+uint32_t NatPmpClient::get_local_ipv4() {
+    return m_local_ipv4;
+}
+
+} // namespace ryu_ldn::p2p
@@ -0,0 +1,235 @@
+/**
+ * @file natpmp_client.hpp
+ * @brief NAT-PMP (RFC 6886) and PCP (RFC 6887) port mapping backend
+ *
+ * Both protocols map a port with a single UDP request to the default
+ * gateway on port 5351, so a mapping takes one round trip on the LAN
+ * instead of the SSDP wait and SOAP calls UPnP needs.
+ *
+ * ## Version Negotiation
+ *
+ * ```
+ * PCP ANNOUNCE ──► gateway
+ *   ◄── PCP reply (v2)           -> use PCP
+ *   ◄── NAT-PMP reply (v0,
+ *        UNSUPP_VERSION)         -> NAT-PMP external address request
+ *          ◄── NAT-PMP reply     -> use NAT-PMP
+ *   (no reply after retries)     -> Failed
+ * ```
+ *
+ * Requests are retransmitted after 250ms, doubling each time (RFC 6886
+ * section 3.1), with fewer attempts than the RFC because UPnP is raced
+ * in parallel anyway. A silent gateway is given up after 2.5 seconds,
+ * the same budget as UPnP discovery.
+ *
+ * ## Platform Independence
+ *
+ * Uses BSD sockets only; libnx provides the same API on the console.
+ * The gateway address is supplied by the caller (nifm on the console, a
+ * loopback stand-in responder in tests/natpmp_tests.cpp).
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "port_mapper.hpp"
+
+namespace ryu_ldn::p2p {
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+/// Gateway port for NAT-PMP and PCP
+constexpr uint16_t NATPMP_PORT = 5351;
+
+/// NAT-PMP protocol version
+constexpr uint8_t NATPMP_VERSION = 0;
+
+/// PCP protocol version
+constexpr uint8_t PCP_VERSION = 2;
+
+/// First retransmission timeout
+constexpr uint32_t NATPMP_INITIAL_TIMEOUT_MS = 250;
+
+/// Transmissions per request (250 + 500 + 1000 ms worst case)
+constexpr int NATPMP_MAX_ATTEMPTS = 3;
+
+/// PCP ANNOUNCE transmissions before falling back to NAT-PMP (250 + 500 ms)
+constexpr int PCP_DISCOVER_ATTEMPTS = 2;
+
+/// Size of a PCP mapping nonce
+constexpr size_t PCP_NONCE_SIZE = 12;
+
+/// NAT-PMP opcodes (requests; responses add 128)
+constexpr uint8_t NATPMP_OP_EXTERNAL_ADDRESS = 0;
+constexpr uint8_t NATPMP_OP_MAP_UDP = 1;
+constexpr uint8_t NATPMP_OP_MAP_TCP = 2;
+
+/// PCP opcodes (responses set the high bit)
+constexpr uint8_t PCP_OP_ANNOUNCE = 0;
+constexpr uint8_t PCP_OP_MAP = 1;
+
+/// Result code meaning "unsupported version" in both protocols
+constexpr uint16_t NATPMP_RESULT_UNSUPPORTED_VERSION = 1;
+
+/// IANA protocol number used in PCP MAP requests
+constexpr uint8_t PCP_PROTOCOL_TCP = 6;
+
+/// Largest request or response we handle (PCP MAP)
+constexpr size_t NATPMP_MAX_PACKET = 60;
+
+// ============================================================================
+// Wire Format
+// ============================================================================
+
+/**
+ * @brief Which protocol a gateway speaks
+ */
+enum class NatPmpProtocol : uint8_t {
+    None   = 0,  ///< Not determined / invalid packet
+    NatPmp = 1,  ///< RFC 6886
+    Pcp    = 2,  ///< RFC 6887
+};
+
+/**
+ * @brief Decoded gateway response (either protocol)
+ */
+struct NatPmpResponse {
+    NatPmpProtocol protocol;           ///< Protocol of the response
+    uint8_t opcode;                    ///< Request opcode (response bit stripped)
+    uint16_t result;                   ///< Result code (0 = success)
+    uint32_t epoch;                    ///< Seconds since gateway start
+    uint32_t lifetime_s;               ///< Granted lifetime (mapping responses)
+    uint16_t internal_port;            ///< Internal port (mapping responses)
+    uint16_t external_port;            ///< Assigned public port (mapping responses)
+    uint32_t external_ipv4;            ///< Public IPv4, host byte order (0 if not carried)
+    uint8_t nonce[PCP_NONCE_SIZE];     ///< Mapping nonce (PCP MAP only)
+};
+
+/**
+ * @brief Encode a NAT-PMP external address request
+ * @return Bytes written (2)
+ */
+size_t encode_natpmp_address_request(uint8_t* buf);
+
+/**
+ * @brief Encode a NAT-PMP TCP mapping request
+ *
+ * A lifetime of 0 with external port 0 deletes the mapping.
+ *
+ * @return Bytes written (12)
+ */
+size_t encode_natpmp_map_request(uint8_t* buf, uint16_t internal_port,
+                                 uint16_t external_port, uint32_t lifetime_s);
+
+/**
+ * @brief Encode a PCP ANNOUNCE request
+ *
+ * @param client_ipv4 Our address as seen by the gateway (host byte order)
+ * @return Bytes written (24)
+ */
+size_t encode_pcp_announce_request(uint8_t* buf, uint32_t client_ipv4);
+
+/**
+ * @brief Encode a PCP MAP request for TCP
+ *
+ * A lifetime of 0 deletes the mapping identified by nonce and internal port.
+ *
+ * @return Bytes written (60)
+ */
+size_t encode_pcp_map_request(uint8_t* buf, const uint8_t nonce[PCP_NONCE_SIZE],
+                              uint32_t client_ipv4, uint16_t internal_port,
+                              uint16_t external_port, uint32_t lifetime_s);
+
+/**
+ * @brief Decode a NAT-PMP or PCP response
+ *
+ * @return false if the packet is not a well-formed response
+ */
+bool decode_natpmp_response(const uint8_t* buf, size_t size, NatPmpResponse& out);
+
+// ============================================================================
+// NatPmpClient
+// ============================================================================
+
+/**
+ * @brief PortMappingBackend speaking PCP with NAT-PMP fallback
+ */
+class NatPmpClient : public PortMappingBackend {
+public:
+    NatPmpClient();
+    ~NatPmpClient() override;
+
+    NatPmpClient(const NatPmpClient&) = delete;
+    NatPmpClient& operator=(const NatPmpClient&) = delete;
+
+    /**
+     * @brief Set the gateway to talk to
+     *
+     * Must be called before begin_discover(). Changing the gateway drops
+     * the negotiated protocol.
+     *
+     * @param gateway_ipv4 Gateway address (host byte order)
+     * @param port Gateway port (NATPMP_PORT except in tests)
+     */
+    void set_gateway(uint32_t gateway_ipv4, uint16_t port = NATPMP_PORT);
+
+    /**
+     * @brief Protocol negotiated during discovery
+     */
+    NatPmpProtocol protocol() const { return m_protocol; }
+
+    // PortMappingBackend
+    const char* name() const override;
+    void begin_discover(uint64_t now_ms) override;
+    DiscoverStatus poll_discover(uint64_t now_ms) override;
+    bool add_mapping(uint16_t internal_port, uint16_t external_port,
+                     uint32_t lifetime_s, uint16_t& mapped_port,
+                     uint32_t& granted_lifetime_s) override;
+    bool delete_mapping(uint16_t internal_port, uint16_t external_port) override;
+    uint32_t get_external_ipv4() override;
+    uint32_t get_local_ipv4() override;
+
+private:
+    bool open_socket();
+    void close_socket();
+    bool send_packet(const uint8_t* data, size_t size);
+
+    /// Non-blocking receive; false if nothing (valid) is waiting
+    bool try_receive(NatPmpResponse& out);
+
+    /// Send and wait with retransmissions for a response to opcode
+    bool transact(const uint8_t* data, size_t size, uint8_t opcode, NatPmpResponse& out);
+
+    /// Encode the discovery request for the current phase
+    size_t encode_discover_request(uint8_t* buf) const;
+
+    /// Send the discovery request for the current phase and arm the timer
+    void send_discover_request(uint64_t now_ms);
+
+    bool request_mapping(uint16_t internal_port, uint16_t external_port,
+                         uint32_t lifetime_s, NatPmpResponse& out);
+
+    uint32_t m_gateway_ipv4;
+    uint16_t m_gateway_port;
+    int m_fd;
+    uint32_t m_local_ipv4;
+    uint32_t m_external_ipv4;
+
+    NatPmpProtocol m_protocol;
+    DiscoverStatus m_status;
+    NatPmpProtocol m_probing;          ///< Protocol of the outstanding discovery request
+    int m_attempt;
+    uint64_t m_deadline_ms;
+    uint32_t m_timeout_ms;
+
+    uint8_t m_nonce[PCP_NONCE_SIZE];
+};
+
+} // namespace ryu_ldn::p2p
@@ -65,7 +65,9 @@
  */
 
 #include "p2p_proxy_client.hpp"
+#include "lan_discovery.hpp"
 #include "../debug/log.hpp"
+#include "../diagnostics/thread_stats.hpp"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -91,6 +93,7 @@ namespace ams::mitm::p2p {
  * @param arg Pointer to P2pProxyClient instance
  */
 void ClientRecvThreadEntry(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::P2pClient);
     auto* client = static_cast<P2pProxyClient*>(arg);
     client->ReceiveLoop();
 }
@@ -111,6 +114,7 @@ P2pProxyClient::P2pProxyClient(ProxyPacketCallback packet_callback)
     : m_socket_fd(-1)
     , m_connected(false)
     , m_disposed(false)
+    , m_lan_path(false)
     , m_ready(false)
     , m_proxy_config{}
     , m_recv_thread_running(false)
@@ -286,6 +290,68 @@ bool P2pProxyClient::Connect(const uint8_t* ip_bytes, size_t ip_len, uint16_t po
     // Step 6: Start Receive Thread
     // =========================================================================
 
+    if (!StartReceiveThread()) {
+        return false;
+    }
+
+    LOG_INFO("P2P client: connected to %s:%u", ip_str, port);
+    return true;
+}
+
+/**
+ * @brief Connect and authenticate, racing the external and LAN addresses
+ *
+ * @param config ExternalProxyConfig received from master server
+ * @param lan_query_ip Subnet broadcast for the LAN query (0 = external only)
+ * @return true if the host answered with ProxyConfig on one of the paths
+ *
+ * P2pDialer sends the auth itself and reads exactly the ProxyConfig packet,
+ * so the receive thread starts on the next packet and the client is ready
+ * without waiting in EnsureProxyReady().
+ */
+bool P2pProxyClient::Dial(const ryu_ldn::protocol::ExternalProxyConfig& config,
+                          uint32_t lan_query_ip) {
+    std::scoped_lock lock(m_mutex);
+
+    if (m_connected) {
+        LOG_WARN("P2P client: already connected");
+        return true;
+    }
+
+    ryu_ldn::p2p::P2pDialer dialer;
+    int fd = dialer.dial(config, lan_query_ip, ryu_ldn::p2p::LAN_DISCOVERY_PORT,
+                         CONNECT_TIMEOUT_MS + FAILURE_TIMEOUT_MS);
+    if (fd < 0) {
+        LOG_ERROR("P2P client: no path to host authenticated (%zu tried)",
+                  dialer.candidate_count());
+        return false;
+    }
+
+    const auto& winner = dialer.winner();
+    LOG_INFO("P2P client: authenticated via %s address %u.%u.%u.%u:%u (%zu tried)",
+             winner.lan ? "LAN" : "external",
+             (winner.ipv4 >> 24) & 0xFF, (winner.ipv4 >> 16) & 0xFF,
+             (winner.ipv4 >> 8) & 0xFF, winner.ipv4 & 0xFF, winner.port,
+             dialer.candidate_count());
+
+    m_socket_fd = fd;
+    m_lan_path = winner.lan;
+    if (!StartReceiveThread()) {
+        return false;
+    }
+
+    m_proxy_config = dialer.proxy_config();
+    m_ready = true;
+    m_ready_cv.Broadcast();
+    return true;
+}
+
+/**
+ * @brief Start the receive thread on the connected socket
+ *
+ * Closes the socket if the thread cannot be created.
+ */
+bool P2pProxyClient::StartReceiveThread() {
     m_connected = true;
     m_recv_thread_running = true;
 
@@ -303,8 +369,6 @@ bool P2pProxyClient::Connect(const uint8_t* ip_bytes, size_t ip_len, uint16_t po
     }
 
     os::StartThread(&m_recv_thread);
-
-    LOG_INFO("P2P client: connected to %s:%u", ip_str, port);
     return true;
 }
 
@@ -546,6 +610,7 @@ void P2pProxyClient::ReceiveLoop() {
     while (m_recv_thread_running && !m_disposed) {
         // Receive data (blocking)
         ssize_t received = recv(m_socket_fd, m_recv_buffer, RECV_BUFFER_SIZE, 0);
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
 
         if (received <= 0) {
             if (received == 0) {
@@ -24,11 +24,15 @@
  * ## Flow
  *
  * 1. Master server sends ExternalProxyConfig to joiner
- * 2. Joiner creates P2pProxyClient and calls Connect()
+ * 2. Joiner creates P2pProxyClient and calls Dial() (or Connect())
  * 3. Client sends ExternalProxyConfig for authentication
  * 4. Host validates token and sends ProxyConfig
  * 5. Client is now ready for direct P2P communication
  *
+ * Dial() also asks the LAN for the host (see lan_discovery.hpp) and races
+ * its private address against the external one, for routers that don't
+ * hairpin.
+ *
  * ## Ryujinx Compatibility
  *
  * This implementation mirrors Ryujinx's P2pProxyClient:
@@ -132,6 +136,23 @@ public:
      */
     bool Connect(const uint8_t* ip_bytes, size_t ip_len, uint16_t port);
 
+    /**
+     * @brief Connect and authenticate, racing the external and LAN addresses
+     * @param config ExternalProxyConfig from master server
+     * @param lan_query_ip Subnet broadcast to ask for the host's LAN address
+     *                     (host byte order, 0 = external address only)
+     * @return true if ready (ProxyConfig received)
+     *
+     * Replaces Connect() + PerformAuth() + EnsureProxyReady(): the first
+     * connection the host authenticates is kept, the others are closed.
+     */
+    bool Dial(const ryu_ldn::protocol::ExternalProxyConfig& config, uint32_t lan_query_ip);
+
+    /**
+     * @brief Whether the last Dial() reached the host through its LAN address
+     */
+    bool IsLanPath() const { return m_lan_path; }
+
     /**
      * @brief Disconnect from the host
      */
@@ -249,6 +270,12 @@ private:
      */
     void ReceiveLoop();
 
+    /**
+     * @brief Start the receive thread on a connected m_socket_fd
+     * @note Caller must hold m_mutex
+     */
+    bool StartReceiveThread();
+
     /**
      * @brief Process received data
      * @param data Buffer containing packet(s)
@@ -274,6 +301,7 @@ private:
     int m_socket_fd;
     bool m_connected;
     bool m_disposed;
+    bool m_lan_path;
 
     // Authentication state
     bool m_ready;
@@ -19,7 +19,7 @@
  *     │  └──────────────┘    └─────────────────────────────────────┘   │
  *     │                                                                  │
  *     │  ┌──────────────┐    ┌─────────────────────────────────────┐   │
- *     │  │ Lease Renew  │───►│ Refreshes UPnP port mapping every  │   │
+ *     │  │ Lease Renew  │───►│ Refreshes the port mapping every    │   │
  *     │  │ (Thread)     │    │ 50 seconds to maintain 60s lease    │   │
  *     │  └──────────────┘    └─────────────────────────────────────┘   │
  *     │                                                                  │
@@ -56,10 +56,10 @@
  *     │   └─ spawn accept thread                      │
  *     │                                               │
  *     │ NatPunch()                                    │
- *     │   ├─ UPnP Discovery (SSDP) ─────────────────►│
- *     │   │◄─────────────── IGD Response ────────────│
+ *     │   ├─ NAT-PMP/PCP + UPnP discovery race ─────►│
+ *     │   │◄─────────────── First response ──────────│
  *     │   │                                           │
- *     │   ├─ UPNP_AddPortMapping(39990) ────────────►│
+ *     │   ├─ AddPortMapping(39990) ─────────────────►│
  *     │   │◄─────────────── Success ─────────────────│
  *     │   │                                           │
  *     │   └─ spawn lease renewal thread               │
@@ -118,7 +118,7 @@
  * | Thread          | Priority | Stack  | Purpose                           |
  * |-----------------|----------|--------|-----------------------------------|
  * | p2p_accept      | High-1   | 16KB   | Accept incoming TCP connections   |
- * | p2p_lease       | Lowest   | 8KB    | UPnP lease renewal every 50s     |
+ * | p2p_lease       | Lowest   | 8KB    | Port mapping renewal every 50s   |
  * | p2p_session[n]  | High-2   | 16KB   | Receive data from each client    |
  *
  * ## Error Handling
@@ -126,7 +126,7 @@
  * | Error Scenario          | Action                                   |
  * |-------------------------|------------------------------------------|
  * | Bind fails              | Try next port in range (39990-39999)    |
- * | UPnP discovery fails    | Log warning, continue without NAT punch |
+ * | Port mapping unavailable| Log warning, continue without NAT punch |
  * | Auth timeout            | Disconnect client                        |
  * | Invalid packet magic    | Disconnect client                        |
  * | Session limit reached   | Reject new connections                   |
@@ -138,7 +138,7 @@
  * | Parameter        | Value   | Notes                              |
  * |------------------|---------|-------------------------------------|
  * | Port range       | 39990-9 | Both private and public             |
- * | Lease duration   | 60s     | UPnP port mapping lifetime          |
+ * | Lease duration   | 60s     | Port mapping lifetime               |
  * | Lease renewal    | 50s     | Renew before expiry                 |
  * | Auth timeout     | 1s      | Wait for token match                |
  * | Max players      | 8       | Maximum concurrent sessions         |
@@ -151,6 +151,8 @@
 
 #include "p2p_proxy_server.hpp"
 #include "../debug/log.hpp"
+#include "../diagnostics/metrics.hpp"
+#include "../diagnostics/thread_stats.hpp"
 
 // =============================================================================
 // BSD Socket Headers
@@ -163,6 +165,7 @@
 #include <arpa/inet.h>    // inet_ntop() for logging
 #include <unistd.h>       // close()
 #include <fcntl.h>        // fcntl() for non-blocking (if needed)
+#include <poll.h>         // poll() on the listen and LAN discovery sockets
 #include <cerrno>         // errno
 #include <cstring>        // memcmp(), memset()
 
@@ -190,20 +193,33 @@ namespace ams::mitm::p2p {
  * @param arg Pointer to P2pProxyServer instance
  */
 void AcceptThreadEntry(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::P2pAccept);
     auto* server = static_cast<P2pProxyServer*>(arg);
     server->AcceptLoop();
 }
 
 /**
- * @brief Entry point for the UPnP lease renewal thread
+ * @brief LanResponder token lookup
+ *
+ * @param digest Token digest from a LAN discovery query
+ * @param token_out Receives the matching token
+ * @param user_data Pointer to P2pProxyServer instance
+ */
+bool LanTokenLookup(const uint8_t* digest, uint8_t* token_out, void* user_data) {
+    return static_cast<const P2pProxyServer*>(user_data)->FindWaitingToken(digest, token_out);
+}
+
+/**
+ * @brief Entry point for the port mapping lease renewal thread
  *
  * This thread wakes up every PORT_LEASE_RENEW seconds (50s) to
- * refresh the UPnP port mapping, preventing it from expiring
+ * refresh the port mapping, preventing it from expiring
  * (which happens after PORT_LEASE_LENGTH seconds = 60s).
  *
  * @param arg Pointer to P2pProxyServer instance
  */
 void LeaseThreadEntry(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::P2pLease);
     auto* server = static_cast<P2pProxyServer*>(arg);
     server->LeaseRenewalLoop();
 }
@@ -217,6 +233,7 @@ void LeaseThreadEntry(void* arg) {
  * @param arg Pointer to P2pProxySession instance
  */
 void SessionRecvThreadEntry(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::P2pSession);
     auto* session = static_cast<P2pProxySession*>(arg);
     session->ReceiveLoop();
 }
@@ -247,7 +264,11 @@ P2pProxyServer::P2pProxyServer(MasterSendCallback master_callback, void* user_da
     , m_lease_thread_running(false)
     , m_session_count(0)
     , m_waiting_token_count(0)
+    , m_lan_discovery(false)
+    , m_lan_ipv4(0)
+    , m_lan_netmask(0)
     , m_broadcast_address(0)
+    , m_local_ip(0)
     , m_master_callback(master_callback)
     , m_callback_user_data(user_data)
 {
@@ -263,7 +284,7 @@ P2pProxyServer::P2pProxyServer(MasterSendCallback master_callback, void* user_da
  *
  * Ensures clean shutdown:
  * 1. Stop() - Closes listen socket, disconnects sessions, stops accept thread
- * 2. ReleaseNatPunch() - Stops lease thread, deletes UPnP port mapping
+ * 2. ReleaseNatPunch() - Stops lease thread, deletes the port mapping
  * 3. Sets m_disposed flag to prevent further operations
  */
 P2pProxyServer::~P2pProxyServer() {
@@ -416,6 +437,14 @@ bool P2pProxyServer::Start(uint16_t port) {
         return false;
     }
 
+    // Same-LAN joiners ask for our private address (lan_discovery.hpp).
+    // Not fatal: they still have the external address.
+    if (m_lan_discovery &&
+        !m_lan_responder.open(0, ryu_ldn::p2p::LAN_DISCOVERY_PORT)) {
+        LOG_WARN("LAN discovery port %u busy (errno=%d), joiners use the external address",
+                 ryu_ldn::p2p::LAN_DISCOVERY_PORT, errno);
+    }
+
     // =========================================================================
     // Step 5: Start Accept Thread
     // =========================================================================
@@ -515,6 +544,9 @@ void P2pProxyServer::Stop() {
     os::WaitThread(&m_accept_thread);
     os::DestroyThread(&m_accept_thread);
 
+    // The accept thread polled it: only closed once that thread is gone
+    m_lan_responder.close();
+
     LOG_INFO("P2P server stopped");
 }
 
@@ -528,13 +560,16 @@ bool P2pProxyServer::IsRunning() const {
 }
 
 // =============================================================================
-// UPnP NAT Punch
+// NAT Punch
 // =============================================================================
 
 /**
- * @brief Open a public port via UPnP for NAT traversal
+ * @brief Open a public port via NAT-PMP/PCP or UPnP for NAT traversal
+ *
+ * @return The public port number if successful, 0 if no mapping could be made
  *
- * @return The public port number if successful, 0 if UPnP failed
+ * The flow below is for UPnP. NAT-PMP and PCP replace discovery and
+ * AddPortMapping with a single UDP request to the gateway on port 5351.
  *
  * ## UPnP Port Mapping Flow
  *
@@ -566,19 +601,20 @@ bool P2pProxyServer::IsRunning() const {
  */
 uint16_t P2pProxyServer::NatPunch() {
     // =========================================================================
-    // Step 1: Discover UPnP Gateway
+    // Step 1: Discover a Port Mapping Protocol
     // =========================================================================
-    // UpnpPortMapper::Discover() sends an SSDP multicast query to find
-    // UPnP-capable routers on the network. Timeout is 2500ms (like Ryujinx).
+    // PortMappingService races NAT-PMP/PCP (one UDP round trip to the
+    // gateway) against UPnP (SSDP multicast, 2500ms like Ryujinx) and
+    // returns as soon as either answers.
 
-    auto& mapper = UpnpPortMapper::GetInstance();
+    auto& mapper = PortMappingService::GetInstance();
 
     if (!mapper.Discover()) {
-        // UPnP not available - this is common:
-        // - Router doesn't support UPnP
-        // - UPnP is disabled in router settings
-        // - Network firewall blocks SSDP
-        LOG_WARN("UPnP discovery failed - P2P may not work through NAT");
+        // No port mapping protocol available - this is common:
+        // - Router supports neither UPnP nor NAT-PMP/PCP
+        // - Both are disabled in router settings
+        // - Network firewall blocks SSDP and port 5351
+        LOG_WARN("Port mapping discovery failed - P2P may not work through NAT");
         return 0;
     }
 
@@ -586,55 +622,56 @@ uint16_t P2pProxyServer::NatPunch() {
     // Step 2: Try Port Mappings
     // =========================================================================
     // Like Ryujinx, try ports 39990-39999 until one succeeds.
-    // We use PORT_LEASE_LENGTH (60 seconds) as the lease duration.
+    // We request PORT_LEASE_LENGTH (60 seconds) as the lease duration.
 
     for (int i = 0; i < PUBLIC_PORT_RANGE; i++) {
         uint16_t try_port = PUBLIC_PORT_BASE + static_cast<uint16_t>(i);
 
         // Attempt to create port mapping:
         // - Internal (private) port: m_private_port (what we're listening on)
-        // - External (public) port: try_port (what remote clients connect to)
-        // - Description: "ryu_ldn_nx P2P" (visible in router admin page)
+        // - External (public) port: try_port (a suggestion for NAT-PMP/PCP,
+        //   which may assign another port)
         // - Lease: 60 seconds (must be renewed)
-        if (mapper.AddPortMapping(m_private_port, try_port,
-                                  "ryu_ldn_nx P2P", PORT_LEASE_LENGTH)) {
-            m_public_port = try_port;
+        uint16_t mapped_port = mapper.AddPortMapping(m_private_port, try_port);
+        if (mapped_port != 0) {
+            m_public_port = mapped_port;
 
             // Log the mapping for debugging
             // Getting external IP is optional but helpful for troubleshooting
             char external_ip[16] = {0};
             if (mapper.GetExternalIPAddress(external_ip, sizeof(external_ip))) {
-                LOG_INFO("UPnP port mapping: %s:%u -> local:%u",
+                LOG_INFO("%s port mapping: %s:%u -> local:%u", mapper.GetActiveProtocolName(),
                          external_ip, m_public_port, m_private_port);
             } else {
-                LOG_INFO("UPnP port mapping: public:%u -> local:%u",
+                LOG_INFO("%s port mapping: public:%u -> local:%u", mapper.GetActiveProtocolName(),
                          m_public_port, m_private_port);
             }
 
             // ================================================================
             // Step 3: Start Lease Renewal Thread
             // ================================================================
-            // The mapping expires after PORT_LEASE_LENGTH (60s).
-            // We need to refresh it every PORT_LEASE_RENEW (50s) to
-            // maintain the mapping.
+            // The mapping expires after PORT_LEASE_LENGTH (60s) or whatever
+            // shorter lease the gateway granted, so it has to be refreshed
+            // before then to stay open.
             StartLeaseRenewal();
 
             return m_public_port;
         }
 
-        // Common UPnP errors:
-        // - 718: ConflictInMappingEntry (port already mapped to another host)
-        // - 725: OnlyPermanentLeasesSupported (router doesn't support timed leases)
-        LOG_VERBOSE("UPnP port %u failed, trying next...", try_port);
+        // Common refusals:
+        // - UPnP 718: ConflictInMappingEntry (port already mapped to another host)
+        // - UPnP 725: OnlyPermanentLeasesSupported (router doesn't support timed leases)
+        // - NAT-PMP/PCP 2: NOT_AUTHORIZED (mapping disabled on the gateway)
+        LOG_VERBOSE("Port mapping %u failed, trying next...", try_port);
     }
 
-    LOG_WARN("UPnP failed to map any port in range %u-%u",
+    LOG_WARN("Port mapping failed for every port in range %u-%u",
              PUBLIC_PORT_BASE, PUBLIC_PORT_BASE + PUBLIC_PORT_RANGE - 1);
     return 0;
 }
 
 /**
- * @brief Release the UPnP port mapping and stop lease renewal
+ * @brief Release the port mapping and stop lease renewal
  *
  * Called during server shutdown to:
  * 1. Stop the lease renewal thread
@@ -663,22 +700,22 @@ void P2pProxyServer::ReleaseNatPunch() {
     // =========================================================================
 
     if (m_public_port != 0) {
-        auto& mapper = UpnpPortMapper::GetInstance();
-        if (mapper.DeletePortMapping(m_public_port)) {
-            LOG_INFO("UPnP port mapping released: %u", m_public_port);
+        auto& mapper = PortMappingService::GetInstance();
+        if (mapper.DeletePortMapping(m_private_port, m_public_port)) {
+            LOG_INFO("Port mapping released: %u", m_public_port);
         } else {
-            LOG_WARN("Failed to release UPnP port mapping: %u", m_public_port);
+            LOG_WARN("Failed to release port mapping: %u", m_public_port);
         }
         m_public_port = 0;
     }
 }
 
 /**
- * @brief Start the UPnP lease renewal background thread
+ * @brief Start the port mapping lease renewal background thread
  *
  * Internal helper called after successful NatPunch().
  * Creates a low-priority thread that periodically refreshes
- * the UPnP port mapping.
+ * the port mapping.
  */
 void P2pProxyServer::StartLeaseRenewal() {
     if (m_lease_thread_running) {
@@ -705,7 +742,8 @@ void P2pProxyServer::StartLeaseRenewal() {
  *
  * Runs continuously until m_lease_thread_running is set to false.
  * Wakes up every PORT_LEASE_RENEW seconds (50s) to refresh the
- * UPnP port mapping.
+ * port mapping. If a NAT-PMP/PCP gateway granted a shorter lease, it
+ * wakes up halfway through that lease instead (RFC 6886 section 3.3).
  *
  * ## Why 50 seconds?
  *
@@ -716,12 +754,12 @@ void P2pProxyServer::StartLeaseRenewal() {
  * This matches Ryujinx's timing exactly for compatibility.
  */
 void P2pProxyServer::LeaseRenewalLoop() {
-    // Sleep duration: PORT_LEASE_RENEW seconds = 50 seconds
-    const auto renew_ns = TimeSpan::FromSeconds(PORT_LEASE_RENEW).GetNanoSeconds();
+    auto& mapper = PortMappingService::GetInstance();
 
     while (m_lease_thread_running && !m_disposed) {
-        // Sleep for renewal interval
-        svc::SleepThread(renew_ns);
+        // Sleep for renewal interval (50s, or half of a shorter granted lease)
+        svc::SleepThread(TimeSpan::FromSeconds(mapper.GetRenewIntervalSeconds()).GetNanoSeconds());
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
 
         // Check if we should exit (server might have stopped during sleep)
         if (!m_lease_thread_running || m_disposed) {
@@ -729,14 +767,13 @@ void P2pProxyServer::LeaseRenewalLoop() {
         }
 
         // Attempt to renew the lease
-        auto& mapper = UpnpPortMapper::GetInstance();
-        if (mapper.RefreshPortMapping(m_private_port, m_public_port, "ryu_ldn_nx P2P")) {
-            LOG_VERBOSE("UPnP lease renewed for port %u", m_public_port);
+        if (mapper.RefreshPortMapping(m_private_port, m_public_port)) {
+            LOG_VERBOSE("Port mapping lease renewed for port %u", m_public_port);
         } else {
             // Renewal failed - mapping might expire!
             // We log a warning but don't abort - the connection might
             // still work if we're on the same local network.
-            LOG_WARN("UPnP lease renewal failed for port %u", m_public_port);
+            LOG_WARN("Port mapping lease renewal failed for port %u", m_public_port);
         }
     }
 }
@@ -866,6 +903,16 @@ bool P2pProxyServer::TryRegisterUser(P2pProxySession* session,
             }
 
             bool ip_match = is_private;
+
+            // A joiner that dialed our private address (LAN discovery)
+            // comes from its LAN address, not the public one the master
+            // server saw. Only our own subnet is trusted that way, and the
+            // token still has to match.
+            if (!ip_match && m_lan_discovery &&
+                ryu_ldn::p2p::is_same_subnet(remote_ip, m_lan_ipv4, m_lan_netmask)) {
+                ip_match = true;
+            }
+
             if (!ip_match && token.address_family == 2) {  // AF_INET = 2 (IPv4)
                 // Extract IPv4 from the 16-byte array
                 // PhysicalIP is stored in network byte order (big-endian)
@@ -990,9 +1037,17 @@ void P2pProxyServer::Configure(const ryu_ldn::protocol::ProxyConfig& config) {
  * accept() is a blocking call. When Stop() closes the listen socket,
  * accept() returns with an error (EBADF or similar), which we detect
  * and break out of the loop.
+ *
+ * While the LAN responder is open, the loop first waits in
+ * WaitForConnection(), which answers discovery queries in between.
  */
 void P2pProxyServer::AcceptLoop() {
     while (m_running) {
+        // With LAN discovery, accept() only runs once a connection is pending
+        if (m_lan_responder.fd() >= 0 && !WaitForConnection()) {
+            continue;
+        }
+
         // Accept incoming connection
         sockaddr_in client_addr{};
         socklen_t client_len = sizeof(client_addr);
@@ -1000,6 +1055,7 @@ void P2pProxyServer::AcceptLoop() {
         int client_fd = accept(m_listen_fd,
                                reinterpret_cast<sockaddr*>(&client_addr),
                                &client_len);
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
 
         if (client_fd < 0) {
             // Check if we're shutting down
@@ -1059,6 +1115,54 @@ void P2pProxyServer::AcceptLoop() {
     }
 }
 
+/**
+ * @brief Wait for a connection while answering LAN discovery queries
+ *
+ * @return true if accept() will not block
+ *
+ * Wakes up every LAN_POLL_MS so a Stop() is noticed even where closing the
+ * listen socket does not interrupt poll().
+ */
+bool P2pProxyServer::WaitForConnection() {
+    pollfd fds[2] = {
+        {m_listen_fd, POLLIN, 0},
+        {m_lan_responder.fd(), POLLIN, 0},
+    };
+    int ready = ::poll(fds, 2, LAN_POLL_MS);
+
+    if (ready > 0 && fds[1].revents != 0) {
+        size_t replies = m_lan_responder.poll(m_private_port, LanTokenLookup, this);
+        if (replies > 0) {
+            LOG_INFO("Answered %zu LAN discovery quer%s", replies, replies == 1 ? "y" : "ies");
+        }
+    }
+
+    if (ready > 0 && fds[0].revents != 0) {
+        return true;  // accept() counts this wakeup
+    }
+    ryu_ldn::diagnostics::g_thread_registry.wakeup();
+    return false;
+}
+
+/**
+ * @brief Find the expected auth token a LAN discovery query is for
+ *
+ * @param digest lan_query_digest from the query
+ * @param token_out Receives the 16-byte token
+ */
+bool P2pProxyServer::FindWaitingToken(const uint8_t* digest, uint8_t* token_out) const {
+    std::scoped_lock lock(m_mutex);
+    for (int i = 0; i < m_waiting_token_count; i++) {
+        uint8_t expected[ryu_ldn::p2p::LAN_DIGEST_SIZE];
+        ryu_ldn::p2p::lan_query_digest(m_waiting_tokens[i].token, expected);
+        if (std::memcmp(expected, digest, sizeof(expected)) == 0) {
+            std::memcpy(token_out, m_waiting_tokens[i].token, sizeof(m_waiting_tokens[i].token));
+            return true;
+        }
+    }
+    return false;
+}
+
 // =============================================================================
 // Message Routing
 // =============================================================================
@@ -1152,14 +1256,68 @@ void P2pProxyServer::RouteMessage(P2pProxySession* sender,
 void P2pProxyServer::HandleProxyData(P2pProxySession* sender,
                                       ryu_ldn::protocol::ProxyDataHeader& header,
                                       const uint8_t* data, size_t data_len) {
+    uint64_t now_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
+
+    // Delegation control from a guest: consumed here, never routed to another guest
+    ryu_ldn::p2p::RelayControl control;
+    if (ryu_ldn::p2p::parse_relay_control(header.info, data, data_len, control)) {
+        std::scoped_lock lock(m_mutex);
+        if (sender->IsAuthenticated() && !IsLocalSession(sender)) {
+            m_relay.on_control(sender->GetVirtualIpAddress(), control, now_ms);
+        }
+        return;
+    }
+
+    // Called with m_mutex held by RouteMessage
     RouteMessage(sender, header.info, [&](P2pProxySession* target) {
-        // Encode and send to target
         uint8_t packet[0x10000];  // 64KB max packet
         size_t len = 0;
+
+        bool remote = !IsLocalSession(target);
+        bool broadcast = header.info.dest_ipv4 == m_broadcast_address ||
+                         header.info.dest_ipv4 == 0xc0a800ff;
+
+        if (remote && broadcast && data_len <= ryu_ldn::p2p::RELAY_MAX_PAYLOAD) {
+            uint32_t target_ip = target->GetVirtualIpAddress();
+
+            if (m_relay.is_delegated(target_ip)) {
+                // The delegate re-sends it
+                m_relay.on_copy(static_cast<uint32_t>(sizeof(ryu_ldn::protocol::LdnHeader) +
+                                                      sizeof(header) + data_len), false, now_ms);
+                ryu_ldn::diagnostics::g_metrics.p2p_fanout_delegated.Add();
+                return;
+            }
+
+            if (target_ip == m_relay.delegate()) {
+                uint32_t targets[ryu_ldn::p2p::RELAY_MAX_TARGETS];
+                size_t target_count = m_relay.active_targets(targets);
+                size_t wrapped_len = ryu_ldn::p2p::build_relay_forward(
+                    targets, target_count, header.info, data, data_len,
+                    m_relay_buffer, sizeof(m_relay_buffer));
+
+                ryu_ldn::protocol::ProxyDataHeader forward_header = header;
+                forward_header.info.dest_ipv4 = target_ip;
+                forward_header.info.dest_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+                forward_header.data_length = static_cast<uint32_t>(wrapped_len);
+                ryu_ldn::protocol::encode_with_data(packet, sizeof(packet),
+                                                    ryu_ldn::protocol::PacketId::ProxyData,
+                                                    forward_header, m_relay_buffer, wrapped_len, len);
+                target->Send(packet, len);
+                m_relay.on_copy(static_cast<uint32_t>(len), true, now_ms);
+                m_relay.count_forward();
+                return;
+            }
+        }
+
+        // Encode and send to target
         ryu_ldn::protocol::encode_with_data(packet, sizeof(packet),
                                             ryu_ldn::protocol::PacketId::ProxyData,
                                             header, data, data_len, len);
         target->Send(packet, len);
+
+        if (remote && broadcast) {
+            m_relay.on_copy(static_cast<uint32_t>(len), true, now_ms);
+        }
     });
 }
 
@@ -1250,10 +1408,97 @@ void P2pProxyServer::OnSessionDisconnected(P2pProxySession* session) {
 
     // Notify master server if session was authenticated
     if (found && session->IsAuthenticated()) {
+        // Back to direct fan-out at once if this guest was the delegate
+        uint32_t delegate_ip = m_relay.delegate();
+        m_relay.on_peer_lost(session->GetVirtualIpAddress(),
+                             armTicksToNs(armGetSystemTick()) / 1000000ULL);
+        if (delegate_ip != 0 && delegate_ip == session->GetVirtualIpAddress()) {
+            LOG_WARN("P2P fan-out delegate 0x%08X lost, sending directly", delegate_ip);
+        }
+
         NotifyMasterDisconnect(session->GetVirtualIpAddress());
     }
 }
 
+// =============================================================================
+// Broadcast Fan-out Delegation
+// =============================================================================
+
+void P2pProxyServer::ConfigureRelayDelegation(const ryu_ldn::p2p::RelayDelegationConfig& config) {
+    std::scoped_lock lock(m_mutex);
+    m_relay.configure(config);
+    m_relay.reset();
+}
+
+bool P2pProxyServer::IsLocalSession(const P2pProxySession* session) const {
+    uint32_t remote_ip = session->GetRemoteIp();
+    return (remote_ip >> 24) == 127 || (m_local_ip != 0 && remote_ip == m_local_ip);
+}
+
+/**
+ * @brief Periodic delegation work
+ *
+ * Counts the guests reached over the network, lets RelayDelegation time out
+ * silent guests and (re)plan, then sends the resulting Assign/Join/Release
+ * messages on each guest's session.
+ */
+void P2pProxyServer::UpdateRelayDelegation() {
+    // Outside m_mutex: takes the port mapper lock
+    uint32_t local_ip = PortMappingService::GetInstance().GetLocalIPv4();
+
+    std::scoped_lock lock(m_mutex);
+    if (!m_running) {
+        return;
+    }
+    m_local_ip = local_ip;
+
+    size_t remote_guests = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (m_sessions[i] != nullptr && m_sessions[i]->IsAuthenticated() &&
+            !IsLocalSession(m_sessions[i])) {
+            remote_guests++;
+        }
+    }
+
+    uint64_t now_ms = armTicksToNs(armGetSystemTick()) / 1000000ULL;
+    m_relay.update(remote_guests, now_ms);
+
+    ryu_ldn::p2p::RelayMessage messages[2 * ryu_ldn::p2p::RELAY_MAX_PEERS + 2];
+    size_t count = m_relay.take_messages(messages, sizeof(messages) / sizeof(messages[0]));
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i].control.type == ryu_ldn::p2p::RelayControlType::Assign) {
+            LOG_INFO("P2P fan-out: 0x%08X re-sends broadcasts to %u guests",
+                     messages[i].dest_ip, messages[i].control.count);
+        }
+        SendRelayControl(messages[i].dest_ip, messages[i].control);
+    }
+}
+
+void P2pProxyServer::SendRelayControl(uint32_t dest_ip, const ryu_ldn::p2p::RelayControl& control) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (m_sessions[i] == nullptr || !m_sessions[i]->IsAuthenticated() ||
+            m_sessions[i]->GetVirtualIpAddress() != dest_ip) {
+            continue;
+        }
+
+        ryu_ldn::protocol::ProxyDataHeader header{};
+        header.info.dest_ipv4 = dest_ip;
+        header.info.source_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+        header.info.dest_port = ryu_ldn::p2p::RELAY_CONTROL_PORT;
+        header.info.protocol = ryu_ldn::protocol::ProtocolType::Udp;
+        header.data_length = sizeof(control);
+
+        uint8_t packet[sizeof(ryu_ldn::protocol::LdnHeader) + sizeof(header) + sizeof(control)];
+        size_t len = 0;
+        ryu_ldn::protocol::encode_with_data(packet, sizeof(packet),
+                                            ryu_ldn::protocol::PacketId::ProxyData,
+                                            header, reinterpret_cast<const uint8_t*>(&control),
+                                            sizeof(control), len);
+        m_sessions[i]->Send(packet, len);
+        return;
+    }
+}
+
 /**
  * @brief Notify master server of a client disconnection
  *
@@ -1394,6 +1639,7 @@ void P2pProxySession::Disconnect(bool from_master) {
 void P2pProxySession::ReceiveLoop() {
     while (m_connected) {
         ssize_t received = recv(m_socket_fd, m_recv_buffer, RECV_BUFFER_SIZE, 0);
+        ryu_ldn::diagnostics::g_thread_registry.wakeup();
 
         if (received <= 0) {
             if (received < 0 && errno == EINTR) {
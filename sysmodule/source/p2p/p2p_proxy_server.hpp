@@ -24,11 +24,13 @@
  * ## Flow
  *
  * 1. Host calls Start() - begins listening on TCP port
- * 2. Host calls NatPunch() - UPnP opens public port
+ * 2. Host calls NatPunch() - NAT-PMP/PCP or UPnP opens public port
  * 3. Master server sends ExternalProxyToken for each joiner
  * 4. Joiner connects via TCP, sends ExternalProxyConfig
  * 5. TryRegisterUser() validates token, assigns virtual IP
  * 6. ProxyData/ProxyConnect/etc routed between sessions
+ * 7. Optionally, part of the broadcast fan-out is handed to a guest with
+ *    more upload (see relay_delegation.hpp)
  *
  * ## Ryujinx Compatibility
  *
@@ -47,7 +49,9 @@
 #include <stratosphere.hpp>
 #include "../protocol/types.hpp"
 #include "../protocol/ryu_protocol.hpp"
-#include "upnp_port_mapper.hpp"
+#include "port_mapping_service.hpp"
+#include "relay_delegation.hpp"
+#include "lan_discovery.hpp"
 
 namespace ams::mitm::p2p {
 
@@ -80,7 +84,7 @@ using MasterSendCallback = void(*)(const void* data, size_t size, void* user_dat
  *
  * 1. Create server
  * 2. Start(port) - begin listening
- * 3. NatPunch() - open UPnP port (optional but recommended)
+ * 3. NatPunch() - open public port (optional but recommended)
  * 4. Accept connections, validate tokens
  * 5. Route proxy messages between sessions
  * 6. Stop() - cleanup and close
@@ -99,6 +103,7 @@ public:
     static constexpr int PORT_LEASE_RENEW = 50;    // seconds
     static constexpr int AUTH_WAIT_SECONDS = 1;
     static constexpr int MAX_PLAYERS = 8;
+    static constexpr int LAN_POLL_MS = 500;        // accept loop tick while answering LAN queries
 
     // =========================================================================
     // Lifecycle
@@ -144,25 +149,42 @@ public:
      */
     bool IsRunning() const;
 
+    /**
+     * @brief Answer LAN discovery queries of expected joiners
+     * @param enabled Open the responder on the next Start()
+     * @param lan_ipv4 Our LAN address (host byte order)
+     * @param lan_netmask Its subnet mask (host byte order)
+     *
+     * See lan_discovery.hpp: joiners behind the same router then reach us
+     * on our private address when the router does not hairpin. Their auth
+     * is then accepted from any address of this subnet.
+     */
+    void SetLanDiscovery(bool enabled, uint32_t lan_ipv4, uint32_t lan_netmask) {
+        m_lan_discovery = enabled;
+        m_lan_ipv4 = lan_ipv4;
+        m_lan_netmask = lan_netmask;
+    }
+
     /**
      * @brief Get the private (local) port
      */
     uint16_t GetPrivatePort() const { return m_private_port; }
 
     /**
-     * @brief Get the public (UPnP) port
+     * @brief Get the public (port-mapped) port
      */
     uint16_t GetPublicPort() const { return m_public_port; }
 
     // =========================================================================
-    // UPnP NAT Punch
+    // NAT Punch
     // =========================================================================
 
     /**
-     * @brief Open a public port via UPnP
-     * @return Public port number, or 0 if UPnP failed
+     * @brief Open a public port via NAT-PMP/PCP or UPnP
+     * @return Public port number, or 0 if no mapping could be made
      *
-     * Attempts to open a port mapping on the router using UPnP.
+     * Races NAT-PMP/PCP against UPnP and maps a port with the first
+     * protocol the router answers.
      * Tries ports 39990-39999 until one succeeds.
      *
      * If successful, starts a lease renewal thread.
@@ -170,7 +192,7 @@ public:
     uint16_t NatPunch();
 
     /**
-     * @brief Release UPnP port mapping
+     * @brief Release the port mapping
      */
     void ReleaseNatPunch();
 
@@ -210,6 +232,19 @@ public:
      */
     void Configure(const ryu_ldn::protocol::ProxyConfig& config);
 
+    /**
+     * @brief Configure broadcast fan-out delegation
+     * @param config Host uplink and on/off switch
+     */
+    void ConfigureRelayDelegation(const ryu_ldn::p2p::RelayDelegationConfig& config);
+
+    /**
+     * @brief Run delegation decisions and send their control messages
+     *
+     * Called periodically (every 100ms) from the service background thread.
+     */
+    void UpdateRelayDelegation();
+
     // =========================================================================
     // Proxy Message Routing
     // =========================================================================
@@ -250,6 +285,7 @@ private:
     // =========================================================================
     friend void AcceptThreadEntry(void* arg);
     friend void LeaseThreadEntry(void* arg);
+    friend bool LanTokenLookup(const uint8_t* digest, uint8_t* token_out, void* user_data);
 
     // =========================================================================
     // Internal Methods
@@ -276,6 +312,32 @@ private:
      */
     void NotifyMasterDisconnect(uint32_t virtual_ip);
 
+    /**
+     * @brief Whether a session is this console's own client (costs no upload)
+     * @note Caller must hold m_mutex
+     */
+    bool IsLocalSession(const P2pProxySession* session) const;
+
+    /**
+     * @brief Wait for a connection while answering LAN discovery queries
+     * @return true if the listen socket is readable
+     */
+    bool WaitForConnection();
+
+    /**
+     * @brief Find the expected auth token a LAN discovery query is for
+     *
+     * @param digest lan_query_digest from the query
+     * @param token_out Receives the 16-byte token
+     */
+    bool FindWaitingToken(const uint8_t* digest, uint8_t* token_out) const;
+
+    /**
+     * @brief Send a delegation control message to a guest
+     * @note Caller must hold m_mutex
+     */
+    void SendRelayControl(uint32_t dest_ip, const ryu_ldn::p2p::RelayControl& control);
+
     /**
      * @brief Lease renewal thread function
      */
@@ -318,8 +380,19 @@ private:
     int m_waiting_token_count;
     os::ConditionVariable m_token_cv;
 
+    // LAN discovery (only touched by Start, Stop and the accept thread)
+    ryu_ldn::p2p::LanResponder m_lan_responder;
+    bool m_lan_discovery;
+    uint32_t m_lan_ipv4;     ///< Host byte order, 0 = unknown
+    uint32_t m_lan_netmask;  ///< Host byte order, 0 = unknown
+
     // Network config
     uint32_t m_broadcast_address;
+    uint32_t m_local_ip;    ///< LAN address (host byte order), refreshed by UpdateRelayDelegation
+
+    // Broadcast fan-out delegation
+    ryu_ldn::p2p::RelayDelegation m_relay;
+    uint8_t m_relay_buffer[ryu_ldn::p2p::RELAY_FORWARD_OVERHEAD + ryu_ldn::p2p::RELAY_MAX_PAYLOAD];
 
     // Master server callback
     MasterSendCallback m_master_callback;
@@ -0,0 +1,224 @@
+/**
+ * @file port_mapper.cpp
+ * @brief Port mapping abstraction racing several NAT traversal protocols
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "port_mapper.hpp"
+#include "../debug/log.hpp"
+
+namespace ryu_ldn::p2p {
+
+PortMapper::PortMapper()
+    : m_platform{}
+    , m_backends{}
+    , m_status{}
+    , m_backend_count(0)
+    , m_active(nullptr)
+    , m_granted_lifetime_s(PORT_LEASE_DURATION_S)
+{
+}
+
+void PortMapper::set_platform(const PortMapperPlatform& platform) {
+    m_platform = platform;
+}
+
+bool PortMapper::add_backend(PortMappingBackend* backend) {
+    if (backend == nullptr || m_backend_count >= PORT_MAPPER_MAX_BACKENDS) {
+        return false;
+    }
+    m_backends[m_backend_count] = backend;
+    m_status[m_backend_count] = DiscoverStatus::Idle;
+    m_backend_count++;
+    return true;
+}
+
+// ============================================================================
+// Discovery
+// ============================================================================
+
+bool PortMapper::discover(uint32_t timeout_ms) {
+    if (m_active != nullptr) {
+        return true;
+    }
+
+    uint64_t start = now_ms();
+    for (size_t i = 0; i < m_backend_count; i++) {
+        // Failed backends get another chance (the network may have changed)
+        if (m_status[i] == DiscoverStatus::Idle || m_status[i] == DiscoverStatus::Failed) {
+            m_backends[i]->begin_discover(start);
+            m_status[i] = DiscoverStatus::Pending;
+        }
+    }
+
+    while (true) {
+        poll_all();
+
+        bool any_pending = false;
+        for (size_t i = 0; i < m_backend_count; i++) {
+            if (m_status[i] == DiscoverStatus::Ready) {
+                m_active = m_backends[i];
+                LOG_INFO("PortMapper: %s ready after %lums", m_active->name(),
+                         static_cast<unsigned long>(now_ms() - start));
+                return true;
+            }
+            any_pending |= (m_status[i] == DiscoverStatus::Pending);
+        }
+
+        if (!any_pending || now_ms() - start >= timeout_ms) {
+            LOG_WARN("PortMapper: no NAT traversal protocol available");
+            return false;
+        }
+        sleep_ms(PORT_MAPPER_POLL_INTERVAL_MS);
+    }
+}
+
+const char* PortMapper::active_name() const {
+    return m_active != nullptr ? m_active->name() : "None";
+}
+
+void PortMapper::poll_all() {
+    uint64_t now = now_ms();
+    for (size_t i = 0; i < m_backend_count; i++) {
+        if (m_status[i] == DiscoverStatus::Pending) {
+            m_status[i] = m_backends[i]->poll_discover(now);
+        }
+    }
+}
+
+void PortMapper::wait_pending(uint32_t timeout_ms) {
+    uint64_t start = now_ms();
+    while (true) {
+        poll_all();
+
+        bool any_pending = false;
+        for (size_t i = 0; i < m_backend_count; i++) {
+            any_pending |= (m_status[i] == DiscoverStatus::Pending);
+        }
+        if (!any_pending || now_ms() - start >= timeout_ms) {
+            return;
+        }
+        sleep_ms(PORT_MAPPER_POLL_INTERVAL_MS);
+    }
+}
+
+// ============================================================================
+// Mappings
+// ============================================================================
+
+uint16_t PortMapper::add_mapping(uint16_t internal_port, uint16_t external_port,
+                                 uint32_t fallback_timeout_ms) {
+    if (m_active == nullptr) {
+        return 0;
+    }
+
+    uint16_t mapped = 0;
+    uint32_t granted = 0;
+    if (m_active->add_mapping(internal_port, external_port, PORT_LEASE_DURATION_S,
+                              mapped, granted)) {
+        m_granted_lifetime_s = granted;
+        return mapped;
+    }
+
+    // The winner of the race refused; let the others finish and try them
+    LOG_WARN("PortMapper: %s refused port %u, trying fallbacks",
+             m_active->name(), external_port);
+    wait_pending(fallback_timeout_ms);
+
+    for (size_t i = 0; i < m_backend_count; i++) {
+        PortMappingBackend* backend = m_backends[i];
+        if (backend == m_active || m_status[i] != DiscoverStatus::Ready) {
+            continue;
+        }
+        if (backend->add_mapping(internal_port, external_port, PORT_LEASE_DURATION_S,
+                                 mapped, granted)) {
+            LOG_INFO("PortMapper: switched to %s", backend->name());
+            m_active = backend;
+            m_granted_lifetime_s = granted;
+            return mapped;
+        }
+    }
+    return 0;
+}
+
+bool PortMapper::refresh_mapping(uint16_t internal_port, uint16_t external_port) {
+    if (m_active == nullptr) {
+        return false;
+    }
+
+    // Renewing is re-adding with the same parameters for every protocol
+    uint16_t mapped = 0;
+    uint32_t granted = 0;
+    if (!m_active->add_mapping(internal_port, external_port, PORT_LEASE_DURATION_S,
+                               mapped, granted)) {
+        return false;
+    }
+    m_granted_lifetime_s = granted;
+    return mapped == external_port;
+}
+
+bool PortMapper::delete_mapping(uint16_t internal_port, uint16_t external_port) {
+    if (m_active == nullptr) {
+        return false;
+    }
+    return m_active->delete_mapping(internal_port, external_port);
+}
+
+uint32_t PortMapper::renew_interval_s() const {
+    if (m_granted_lifetime_s >= PORT_LEASE_DURATION_S) {
+        return PORT_LEASE_RENEW_S;
+    }
+    // Short lease: renew halfway through, but not in a busy loop
+    uint32_t half = m_granted_lifetime_s / 2;
+    return half > 0 ? half : 1;
+}
+
+uint32_t PortMapper::get_external_ipv4() {
+    return m_active != nullptr ? m_active->get_external_ipv4() : 0;
+}
+
+uint32_t PortMapper::get_local_ipv4() {
+    if (m_active != nullptr) {
+        uint32_t ip = m_active->get_local_ipv4();
+        if (ip != 0) {
+            return ip;
+        }
+    }
+    for (size_t i = 0; i < m_backend_count; i++) {
+        if (m_status[i] == DiscoverStatus::Ready && m_backends[i] != m_active) {
+            uint32_t ip = m_backends[i]->get_local_ipv4();
+            if (ip != 0) {
+                return ip;
+            }
+        }
+    }
+    return 0;
+}
+
+void PortMapper::reset() {
+    m_active = nullptr;
+    m_granted_lifetime_s = PORT_LEASE_DURATION_S;
+    for (size_t i = 0; i < m_backend_count; i++) {
+        if (m_status[i] != DiscoverStatus::Pending) {
+            m_status[i] = DiscoverStatus::Idle;
+        }
+    }
+}
+
+// ============================================================================
+// Platform
+// ============================================================================
+
+uint64_t PortMapper::now_ms() const {
+    return m_platform.now_ms != nullptr ? m_platform.now_ms(m_platform.user_data) : 0;
+}
+
+void PortMapper::sleep_ms(uint32_t ms) const {
+    if (m_platform.sleep_ms != nullptr) {
+        m_platform.sleep_ms(ms, m_platform.user_data);
+    }
+}
+
+} // namespace ryu_ldn::p2p
@@ -0,0 +1,267 @@
+/**
+ * @file port_mapper.hpp
+ * @brief Port mapping abstraction racing several NAT traversal protocols
+ *
+ * Hosting a P2P session needs a public port. Routers expose this through
+ * different protocols with very different costs:
+ *
+ * | Protocol     | Discovery                         | Typical time |
+ * |--------------|-----------------------------------|--------------|
+ * | NAT-PMP/PCP  | One UDP request to the gateway    | < 10 ms      |
+ * | UPnP IGD     | SSDP multicast wait + HTTP/SOAP   | ~2.5 s       |
+ *
+ * PortMapper starts discovery on every registered backend at once and
+ * uses whichever answers first. The other backends keep running in the
+ * background and serve as fallback if the winner later refuses a mapping.
+ *
+ * ## Backends
+ *
+ * Each protocol implements PortMappingBackend. Discovery is split into
+ * begin_discover()/poll_discover() so that a slow backend (UPnP, which
+ * blocks inside miniupnpc) can run on a worker thread while a fast one
+ * (NAT-PMP/PCP) is polled on the caller's thread.
+ *
+ * ## Lease Handling
+ *
+ * Mappings are created with PORT_LEASE_DURATION_S and renewed by
+ * re-adding them. The renewal interval is PORT_LEASE_RENEW_S unless the
+ * gateway granted a shorter lease, in which case it is half the granted
+ * lifetime (RFC 6886 section 3.3).
+ *
+ * ## Platform Independence
+ *
+ * Only depends on the backend interface and a clock/sleep hook, so the
+ * race logic runs on the host with stand-in backends (see
+ * tests/natpmp_tests.cpp).
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ryu_ldn::p2p {
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+/// Requested mapping lifetime in seconds (matches Ryujinx)
+constexpr uint32_t PORT_LEASE_DURATION_S = 60;
+
+/// Renewal interval in seconds for a full-length lease (matches Ryujinx)
+constexpr uint32_t PORT_LEASE_RENEW_S = 50;
+
+/// Maximum number of backends a PortMapper can race
+constexpr size_t PORT_MAPPER_MAX_BACKENDS = 4;
+
+/// Sleep between backend polls during discovery
+constexpr uint32_t PORT_MAPPER_POLL_INTERVAL_MS = 2;
+
+// ============================================================================
+// Backend Interface
+// ============================================================================
+
+/**
+ * @brief Discovery progress of a backend
+ */
+enum class DiscoverStatus : uint8_t {
+    Idle    = 0,  ///< begin_discover() not called yet
+    Pending = 1,  ///< Waiting for the gateway
+    Ready   = 2,  ///< Gateway found, mappings can be requested
+    Failed  = 3,  ///< No gateway speaking this protocol
+};
+
+/**
+ * @brief One NAT traversal protocol
+ *
+ * add_mapping()/delete_mapping() may block for a bounded time (a few
+ * retransmissions or one HTTP request). poll_discover() must not block.
+ */
+class PortMappingBackend {
+public:
+    virtual ~PortMappingBackend() = default;
+
+    /// Short protocol name for logs and diagnostics ("NAT-PMP", "UPnP", ...)
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Start discovery
+     *
+     * Must return quickly. A backend that has already discovered its
+     * gateway may report Ready from the next poll without network traffic.
+     *
+     * @param now_ms Current time in milliseconds
+     */
+    virtual void begin_discover(uint64_t now_ms) = 0;
+
+    /**
+     * @brief Advance discovery (non-blocking)
+     *
+     * @param now_ms Current time in milliseconds
+     * @return Current discovery status
+     */
+    virtual DiscoverStatus poll_discover(uint64_t now_ms) = 0;
+
+    /**
+     * @brief Create or renew a TCP mapping
+     *
+     * @param internal_port Local port to forward to
+     * @param external_port Suggested public port
+     * @param lifetime_s Requested lease in seconds
+     * @param[out] mapped_port Public port the gateway actually assigned
+     * @param[out] granted_lifetime_s Lease the gateway actually granted
+     * @return true on success
+     */
+    virtual bool add_mapping(uint16_t internal_port, uint16_t external_port,
+                             uint32_t lifetime_s, uint16_t& mapped_port,
+                             uint32_t& granted_lifetime_s) = 0;
+
+    /**
+     * @brief Remove a TCP mapping
+     *
+     * @return true if the mapping no longer exists
+     */
+    virtual bool delete_mapping(uint16_t internal_port, uint16_t external_port) = 0;
+
+    /**
+     * @brief Public IPv4 address of the gateway (host byte order), 0 if unknown
+     */
+    virtual uint32_t get_external_ipv4() = 0;
+
+    /**
+     * @brief Our LAN IPv4 address as seen by the gateway (host byte order), 0 if unknown
+     */
+    virtual uint32_t get_local_ipv4() = 0;
+};
+
+/**
+ * @brief Clock and sleep hooks for PortMapper
+ */
+struct PortMapperPlatform {
+    uint64_t (*now_ms)(void* user_data);                ///< Monotonic milliseconds
+    void (*sleep_ms)(uint32_t ms, void* user_data);     ///< Yield the calling thread
+    void* user_data;                                    ///< Passed to every callback
+};
+
+// ============================================================================
+// PortMapper
+// ============================================================================
+
+/**
+ * @brief Races registered backends and manages one active mapping
+ *
+ * Not thread-safe; the owner serializes calls (the console wrapper holds a
+ * mutex around every call).
+ */
+class PortMapper {
+public:
+    PortMapper();
+
+    /**
+     * @brief Set clock and sleep hooks (required before discover())
+     */
+    void set_platform(const PortMapperPlatform& platform);
+
+    /**
+     * @brief Register a backend
+     *
+     * Registration order is the tie-break when several backends become
+     * ready during the same poll.
+     *
+     * @return false if PORT_MAPPER_MAX_BACKENDS is reached
+     */
+    bool add_backend(PortMappingBackend* backend);
+
+    /**
+     * @brief Race all backends and select the first one to become ready
+     *
+     * Returns as soon as one backend is ready, all have failed, or the
+     * timeout expires. Returns immediately if a backend is already active.
+     *
+     * @param timeout_ms Upper bound on the wait
+     * @return true if a backend is active
+     */
+    bool discover(uint32_t timeout_ms);
+
+    /**
+     * @brief Whether a backend has been selected
+     */
+    bool is_available() const { return m_active != nullptr; }
+
+    /**
+     * @brief Name of the selected backend, or "None"
+     */
+    const char* active_name() const;
+
+    /**
+     * @brief Create a mapping through the active backend
+     *
+     * If the active backend refuses, the remaining backends are given up
+     * to fallback_timeout_ms to finish discovery and are tried in turn;
+     * the first one that succeeds becomes active.
+     *
+     * @param internal_port Local port to forward to
+     * @param external_port Suggested public port
+     * @param fallback_timeout_ms Wait for pending backends on failure
+     * @return Assigned public port, or 0 on failure
+     */
+    uint16_t add_mapping(uint16_t internal_port, uint16_t external_port,
+                         uint32_t fallback_timeout_ms);
+
+    /**
+     * @brief Renew a mapping through the backend that created it
+     *
+     * @return true if the gateway accepted the renewal
+     */
+    bool refresh_mapping(uint16_t internal_port, uint16_t external_port);
+
+    /**
+     * @brief Remove a mapping through the backend that created it
+     */
+    bool delete_mapping(uint16_t internal_port, uint16_t external_port);
+
+    /**
+     * @brief Seconds to wait before the next refresh_mapping()
+     */
+    uint32_t renew_interval_s() const;
+
+    /**
+     * @brief Public IPv4 (host byte order) from the active backend, 0 if unknown
+     */
+    uint32_t get_external_ipv4();
+
+    /**
+     * @brief LAN IPv4 (host byte order), 0 if unknown
+     *
+     * Asks the active backend first, then any other ready backend.
+     */
+    uint32_t get_local_ipv4();
+
+    /**
+     * @brief Forget the active backend so the next discover() races again
+     */
+    void reset();
+
+private:
+    uint64_t now_ms() const;
+    void sleep_ms(uint32_t ms) const;
+
+    /// Poll every backend once and record status changes
+    void poll_all();
+
+    /// Wait until no backend is Pending, or timeout
+    void wait_pending(uint32_t timeout_ms);
+
+    PortMapperPlatform m_platform;
+    PortMappingBackend* m_backends[PORT_MAPPER_MAX_BACKENDS];
+    DiscoverStatus m_status[PORT_MAPPER_MAX_BACKENDS];
+    size_t m_backend_count;
+    PortMappingBackend* m_active;
+    uint32_t m_granted_lifetime_s;
+};
+
+} // namespace ryu_ldn::p2p
@@ -0,0 +1,228 @@
+/**
+ * @file port_mapping_service.cpp
+ * @brief Console port mapping service racing NAT-PMP/PCP against UPnP
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "port_mapping_service.hpp"
+#include "../debug/log.hpp"
+#include "../diagnostics/thread_stats.hpp"
+
+#include <arpa/inet.h>
+#include <cstdio>
+
+namespace ams::mitm::p2p {
+
+using ryu_ldn::p2p::DiscoverStatus;
+
+namespace {
+
+uint64_t PlatformNowMs(void*) {
+    return armTicksToNs(armGetSystemTick()) / 1000000ULL;
+}
+
+void PlatformSleepMs(uint32_t ms, void*) {
+    svc::SleepThread(TimeSpan::FromMilliSeconds(ms).GetNanoSeconds());
+}
+
+/**
+ * @brief Entry point for the UPnP discovery thread
+ *
+ * @param arg Pointer to UpnpMappingBackend instance
+ */
+void UpnpDiscoverThreadEntry(void* arg) {
+    ryu_ldn::diagnostics::ScopedThreadAccount account(ryu_ldn::diagnostics::ThreadRole::PortMapping);
+    static_cast<UpnpMappingBackend*>(arg)->DiscoverThreadFunc();
+}
+
+/**
+ * @brief Parse "a.b.c.d" into a host byte order IPv4, 0 on error
+ */
+uint32_t ParseIPv4(const char* str) {
+    unsigned int a, b, c, d;
+    if (std::sscanf(str, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 ||
+        a > 255 || b > 255 || c > 255 || d > 255) {
+        return 0;
+    }
+    return (a << 24) | (b << 16) | (c << 8) | d;
+}
+
+} // namespace
+
+// =============================================================================
+// UpnpMappingBackend
+// =============================================================================
+
+UpnpMappingBackend::UpnpMappingBackend()
+    : m_thread{}
+    , m_thread_created(false)
+    , m_done(false)
+    , m_result(false)
+{
+}
+
+void UpnpMappingBackend::begin_discover(uint64_t) {
+    if (m_thread_created) {
+        return;  // Previous discovery still running
+    }
+
+    m_done = false;
+    m_result = false;
+
+    // SSDP blocks for UPNP_DISCOVERY_TIMEOUT_MS inside miniupnpc, so it
+    // runs on its own thread while the caller polls NAT-PMP/PCP
+    R_ABORT_UNLESS(os::CreateThread(
+        &m_thread,
+        UpnpDiscoverThreadEntry,
+        this,
+        m_thread_stack,
+        sizeof(m_thread_stack),
+        os::LowestThreadPriority
+    ));
+    os::SetThreadNamePointer(&m_thread, "upnp_discover");
+    os::StartThread(&m_thread);
+    m_thread_created = true;
+}
+
+void UpnpMappingBackend::DiscoverThreadFunc() {
+    // Returns immediately if a previous discovery succeeded
+    m_result = UpnpPortMapper::GetInstance().Discover();
+    m_done = true;
+}
+
+DiscoverStatus UpnpMappingBackend::poll_discover(uint64_t) {
+    if (!m_thread_created) {
+        return DiscoverStatus::Failed;
+    }
+    if (!m_done) {
+        return DiscoverStatus::Pending;
+    }
+
+    os::WaitThread(&m_thread);
+    os::DestroyThread(&m_thread);
+    m_thread_created = false;
+    return m_result ? DiscoverStatus::Ready : DiscoverStatus::Failed;
+}
+
+bool UpnpMappingBackend::add_mapping(uint16_t internal_port, uint16_t external_port,
+                                     uint32_t lifetime_s, uint16_t& mapped_port,
+                                     uint32_t& granted_lifetime_s) {
+    // IGDs map the exact port requested and report no lease, so assume
+    // the requested one was granted
+    if (!UpnpPortMapper::GetInstance().AddPortMapping(internal_port, external_port,
+                                                      "ryu_ldn_nx P2P",
+                                                      static_cast<int>(lifetime_s))) {
+        return false;
+    }
+    mapped_port = external_port;
+    granted_lifetime_s = lifetime_s;
+    return true;
+}
+
+bool UpnpMappingBackend::delete_mapping(uint16_t, uint16_t external_port) {
+    return UpnpPortMapper::GetInstance().DeletePortMapping(external_port);
+}
+
+uint32_t UpnpMappingBackend::get_external_ipv4() {
+    char ip[16] = {};
+    if (!UpnpPortMapper::GetInstance().GetExternalIPAddress(ip, sizeof(ip))) {
+        return 0;
+    }
+    return ParseIPv4(ip);
+}
+
+uint32_t UpnpMappingBackend::get_local_ipv4() {
+    return UpnpPortMapper::GetInstance().GetLocalIPv4();
+}
+
+// =============================================================================
+// PortMappingService
+// =============================================================================
+
+PortMappingService& PortMappingService::GetInstance() {
+    static PortMappingService instance;
+    return instance;
+}
+
+PortMappingService::PortMappingService()
+    : m_gateway_ipv4(0)
+{
+    ryu_ldn::p2p::PortMapperPlatform platform{};
+    platform.now_ms = PlatformNowMs;
+    platform.sleep_ms = PlatformSleepMs;
+    m_mapper.set_platform(platform);
+
+    // Registration order breaks ties: prefer NAT-PMP/PCP if both are ready
+    m_mapper.add_backend(&m_natpmp);
+    m_mapper.add_backend(&m_upnp);
+}
+
+bool PortMappingService::Discover() {
+    std::scoped_lock lock(m_mutex);
+
+    // NAT-PMP/PCP always talk to the default gateway
+    u32 addr, netmask, gateway, primary_dns, secondary_dns;
+    if (R_SUCCEEDED(nifmGetCurrentIpConfigInfo(&addr, &netmask, &gateway,
+                                               &primary_dns, &secondary_dns))) {
+        uint32_t gateway_ipv4 = ntohl(gateway);
+        if (gateway_ipv4 != m_gateway_ipv4) {
+            // Different network: the previous winner may no longer apply
+            m_gateway_ipv4 = gateway_ipv4;
+            m_natpmp.set_gateway(gateway_ipv4);
+            m_mapper.reset();
+        }
+    }
+
+    return m_mapper.discover(PORT_MAPPING_FALLBACK_TIMEOUT_MS);
+}
+
+bool PortMappingService::IsAvailable() const {
+    std::scoped_lock lock(m_mutex);
+    return m_mapper.is_available();
+}
+
+const char* PortMappingService::GetActiveProtocolName() const {
+    std::scoped_lock lock(m_mutex);
+    return m_mapper.active_name();
+}
+
+uint16_t PortMappingService::AddPortMapping(uint16_t internal_port, uint16_t external_port) {
+    std::scoped_lock lock(m_mutex);
+    return m_mapper.add_mapping(internal_port, external_port, PORT_MAPPING_FALLBACK_TIMEOUT_MS);
+}
+
+bool PortMappingService::RefreshPortMapping(uint16_t internal_port, uint16_t external_port) {
+    std::scoped_lock lock(m_mutex);
+    return m_mapper.refresh_mapping(internal_port, external_port);
+}
+
+bool PortMappingService::DeletePortMapping(uint16_t internal_port, uint16_t external_port) {
+    std::scoped_lock lock(m_mutex);
+    return m_mapper.delete_mapping(internal_port, external_port);
+}
+
+uint32_t PortMappingService::GetRenewIntervalSeconds() const {
+    std::scoped_lock lock(m_mutex);
+    return m_mapper.renew_interval_s();
+}
+
+bool PortMappingService::GetExternalIPAddress(char* ip_out, size_t ip_len) {
+    std::scoped_lock lock(m_mutex);
+
+    uint32_t ip = m_mapper.get_external_ipv4();
+    if (ip == 0 || ip_out == nullptr || ip_len == 0) {
+        return false;
+    }
+    std::snprintf(ip_out, ip_len, "%u.%u.%u.%u",
+                  (ip >> 24) & 0xFF, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF);
+    return true;
+}
+
+uint32_t PortMappingService::GetLocalIPv4() {
+    std::scoped_lock lock(m_mutex);
+    return m_mapper.get_local_ipv4();
+}
+
+} // namespace ams::mitm::p2p
@@ -0,0 +1,164 @@
+/**
+ * @file port_mapping_service.hpp
+ * @brief Console port mapping service racing NAT-PMP/PCP against UPnP
+ *
+ * Owns the portable PortMapper and wires it to the console:
+ *
+ * - NatPmpClient talks to the default gateway reported by nifm
+ * - UPnP runs UpnpPortMapper::Discover() on a worker thread, since
+ *   miniupnpc blocks for the whole SSDP wait
+ * - The clock and sleep hooks use the system tick and svc::SleepThread
+ *
+ * ## Usage
+ *
+ * ```cpp
+ * auto& mapper = PortMappingService::GetInstance();
+ *
+ * if (mapper.Discover()) {
+ *     uint16_t port = mapper.AddPortMapping(39990, 39990);
+ *     // ... renew every mapper.GetRenewIntervalSeconds() ...
+ *     mapper.DeletePortMapping(39990, port);
+ * }
+ * ```
+ *
+ * On a router with NAT-PMP or PCP, Discover() returns after one LAN round
+ * trip instead of the 2.5 second UPnP wait. UPnP keeps discovering in the
+ * background and is used if the gateway refuses the NAT-PMP/PCP mapping.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <stratosphere.hpp>
+#include "port_mapper.hpp"
+#include "natpmp_client.hpp"
+#include "upnp_port_mapper.hpp"
+
+namespace ams::mitm::p2p {
+
+/**
+ * @brief Extra time given to a slower backend when the winner refuses a mapping
+ */
+constexpr uint32_t PORT_MAPPING_FALLBACK_TIMEOUT_MS = UPNP_DISCOVERY_TIMEOUT_MS + 500;
+
+/**
+ * @brief PortMappingBackend adapter around UpnpPortMapper
+ *
+ * begin_discover() starts UpnpPortMapper::Discover() on a dedicated
+ * low-priority thread; poll_discover() reports Pending until it returns.
+ */
+class UpnpMappingBackend : public ryu_ldn::p2p::PortMappingBackend {
+public:
+    UpnpMappingBackend();
+
+    const char* name() const override { return "UPnP"; }
+    void begin_discover(uint64_t now_ms) override;
+    ryu_ldn::p2p::DiscoverStatus poll_discover(uint64_t now_ms) override;
+    bool add_mapping(uint16_t internal_port, uint16_t external_port,
+                     uint32_t lifetime_s, uint16_t& mapped_port,
+                     uint32_t& granted_lifetime_s) override;
+    bool delete_mapping(uint16_t internal_port, uint16_t external_port) override;
+    uint32_t get_external_ipv4() override;
+    uint32_t get_local_ipv4() override;
+
+    /**
+     * @brief Discovery thread body (public for the thread entry point)
+     */
+    void DiscoverThreadFunc();
+
+private:
+    os::ThreadType m_thread;
+    alignas(0x1000) uint8_t m_thread_stack[0x4000];
+    bool m_thread_created;
+    std::atomic<bool> m_done;
+    std::atomic<bool> m_result;
+};
+
+/**
+ * @brief Port mapping singleton used by P2P hosting and diagnostics
+ *
+ * ## Thread Safety
+ *
+ * All methods are thread-safe (one mutex around the PortMapper).
+ */
+class PortMappingService {
+public:
+    /**
+     * @brief Get the singleton instance
+     */
+    static PortMappingService& GetInstance();
+
+    PortMappingService(const PortMappingService&) = delete;
+    PortMappingService& operator=(const PortMappingService&) = delete;
+
+    /**
+     * @brief Race NAT-PMP/PCP and UPnP discovery
+     *
+     * Refreshes the gateway address from nifm before racing, and returns
+     * as soon as one protocol is usable.
+     *
+     * @return true if a protocol is available
+     */
+    bool Discover();
+
+    /**
+     * @brief Whether Discover() selected a protocol
+     */
+    bool IsAvailable() const;
+
+    /**
+     * @brief Name of the selected protocol ("PCP", "NAT-PMP", "UPnP", "None")
+     */
+    const char* GetActiveProtocolName() const;
+
+    /**
+     * @brief Create a TCP mapping with a PORT_LEASE_DURATION lease
+     *
+     * @param internal_port Local port to forward to
+     * @param external_port Suggested public port
+     * @return Public port assigned by the gateway, or 0 on failure
+     */
+    uint16_t AddPortMapping(uint16_t internal_port, uint16_t external_port);
+
+    /**
+     * @brief Renew a mapping created by AddPortMapping()
+     */
+    bool RefreshPortMapping(uint16_t internal_port, uint16_t external_port);
+
+    /**
+     * @brief Remove a mapping created by AddPortMapping()
+     */
+    bool DeletePortMapping(uint16_t internal_port, uint16_t external_port);
+
+    /**
+     * @brief Seconds until the next RefreshPortMapping() is due
+     *
+     * PORT_LEASE_RENEW unless the gateway granted a shorter lease.
+     */
+    uint32_t GetRenewIntervalSeconds() const;
+
+    /**
+     * @brief Public IPv4 as a dotted string
+     *
+     * @return false if unknown
+     */
+    bool GetExternalIPAddress(char* ip_out, size_t ip_len);
+
+    /**
+     * @brief LAN IPv4 in host byte order, 0 if unknown
+     */
+    uint32_t GetLocalIPv4();
+
+private:
+    PortMappingService();
+
+    mutable os::Mutex m_mutex{false};
+    ryu_ldn::p2p::PortMapper m_mapper;
+    ryu_ldn::p2p::NatPmpClient m_natpmp;
+    UpnpMappingBackend m_upnp;
+    uint32_t m_gateway_ipv4;    ///< Gateway used by the last Discover()
+};
+
+} // namespace ams::mitm::p2p
@@ -0,0 +1,612 @@
+/**
+ * @file relay_delegation.cpp
+ * @brief Delegation of part of the P2P host broadcast fan-out to a guest
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include "relay_delegation.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ryu_ldn::p2p {
+
+namespace {
+
+bool contains(const uint32_t* list, size_t count, uint32_t ip) {
+    for (size_t i = 0; i < count; i++) {
+        if (list[i] == ip) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Idle windows after which a smoothed rate is considered zero
+ */
+constexpr uint64_t RATE_DECAY_WINDOWS = 16;
+
+} // namespace
+
+// ============================================================================
+// RelayRateMeter
+// ============================================================================
+
+void RelayRateMeter::reset() {
+    m_window_start_ms = 0;
+    m_window_bytes = 0;
+    m_kbps = 0;
+    m_started = false;
+}
+
+void RelayRateMeter::roll(uint64_t now_ms) {
+    if (!m_started) {
+        m_window_start_ms = now_ms;
+        m_started = true;
+        return;
+    }
+    if (now_ms < m_window_start_ms + RELAY_RATE_WINDOW_MS) {
+        return;
+    }
+
+    // bytes * 8 / ms = kbit/s
+    uint64_t windows = (now_ms - m_window_start_ms) / RELAY_RATE_WINDOW_MS;
+    uint64_t sample = m_window_bytes * 8 / RELAY_RATE_WINDOW_MS;
+    uint64_t kbps = (static_cast<uint64_t>(m_kbps) * 3 + sample) / 4;
+
+    // Windows without any add() since
+    for (uint64_t i = 1; i < windows && kbps != 0; i++) {
+        kbps = (i >= RATE_DECAY_WINDOWS) ? 0 : kbps * 3 / 4;
+    }
+
+    m_kbps = static_cast<uint32_t>(std::min<uint64_t>(kbps, UINT32_MAX));
+    m_window_start_ms += windows * RELAY_RATE_WINDOW_MS;
+    m_window_bytes = 0;
+}
+
+void RelayRateMeter::add(uint32_t bytes, uint64_t now_ms) {
+    roll(now_ms);
+    m_window_bytes += bytes;
+}
+
+uint32_t RelayRateMeter::kbps(uint64_t now_ms) {
+    roll(now_ms);
+    return m_kbps;
+}
+
+// ============================================================================
+// Wire Helpers
+// ============================================================================
+
+bool parse_relay_control(const protocol::ProxyInfo& info, const uint8_t* payload,
+                         size_t payload_size, RelayControl& out) {
+    if (info.dest_port != RELAY_CONTROL_PORT || payload_size < sizeof(RelayControl)) {
+        return false;
+    }
+
+    std::memcpy(&out, payload, sizeof(out));
+    if (out.magic != RELAY_CONTROL_MAGIC || out.version < 1) {
+        return false;
+    }
+    if (out.count > RELAY_MAX_TARGETS) {
+        out.count = RELAY_MAX_TARGETS;
+    }
+    return true;
+}
+
+RelayControl make_relay_control(RelayControlType type) {
+    RelayControl control{};
+    control.magic = RELAY_CONTROL_MAGIC;
+    control.version = RELAY_VERSION;
+    control.type = type;
+    return control;
+}
+
+size_t build_relay_forward(const uint32_t* targets, size_t target_count,
+                           const protocol::ProxyInfo& info, const uint8_t* payload,
+                           size_t payload_size, uint8_t* out, size_t out_size) {
+    size_t size = RELAY_FORWARD_OVERHEAD + payload_size;
+    if (size > out_size || target_count > RELAY_MAX_TARGETS) {
+        return 0;
+    }
+
+    RelayControl control = make_relay_control(RelayControlType::Forward);
+    control.count = static_cast<uint8_t>(target_count);
+    for (size_t i = 0; i < target_count; i++) {
+        control.targets[i] = targets[i];
+    }
+
+    std::memcpy(out, &control, sizeof(control));
+    std::memcpy(out + sizeof(control), &info, sizeof(info));
+    std::memcpy(out + RELAY_FORWARD_OVERHEAD, payload, payload_size);
+    return size;
+}
+
+bool parse_relay_forward(const uint8_t* payload, size_t payload_size, RelayControl& control,
+                         protocol::ProxyInfo& info, const uint8_t*& inner, uint32_t& inner_size) {
+    if (payload_size < RELAY_FORWARD_OVERHEAD) {
+        return false;
+    }
+
+    std::memcpy(&control, payload, sizeof(control));
+    if (control.magic != RELAY_CONTROL_MAGIC || control.type != RelayControlType::Forward) {
+        return false;
+    }
+    if (control.count > RELAY_MAX_TARGETS) {
+        control.count = RELAY_MAX_TARGETS;
+    }
+
+    std::memcpy(&info, payload + sizeof(control), sizeof(info));
+    inner = payload + RELAY_FORWARD_OVERHEAD;
+    inner_size = static_cast<uint32_t>(payload_size - RELAY_FORWARD_OVERHEAD);
+    return true;
+}
+
+// ============================================================================
+// RelayDelegation (host)
+// ============================================================================
+
+RelayDelegation::RelayDelegation()
+    : m_config{false, 0}
+{
+    reset();
+}
+
+void RelayDelegation::configure(const RelayDelegationConfig& config) {
+    m_config = config;
+}
+
+void RelayDelegation::reset() {
+    m_stats = RelayDelegationStats{};
+    std::memset(m_peers, 0, sizeof(m_peers));
+    m_peer_count = 0;
+    m_delegate_ip = 0;
+    m_delegate_accepted = false;
+    m_target_count = 0;
+    m_sent.reset();
+    m_demand.reset();
+    m_next_plan_ms = 0;
+    m_message_count = 0;
+}
+
+RelayDelegation::Peer* RelayDelegation::find_peer(uint32_t ip) {
+    for (size_t i = 0; i < m_peer_count; i++) {
+        if (m_peers[i].ip == ip) {
+            return &m_peers[i];
+        }
+    }
+    return nullptr;
+}
+
+RelayDelegation::Peer* RelayDelegation::add_peer(uint32_t ip) {
+    if (m_peer_count >= RELAY_MAX_PEERS) {
+        return nullptr;
+    }
+    Peer* peer = &m_peers[m_peer_count++];
+    *peer = Peer{};
+    peer->ip = ip;
+    return peer;
+}
+
+void RelayDelegation::remove_peer(uint32_t ip) {
+    for (size_t i = 0; i < m_peer_count; i++) {
+        if (m_peers[i].ip == ip) {
+            m_peers[i] = m_peers[--m_peer_count];
+            return;
+        }
+    }
+}
+
+uint32_t RelayDelegation::spare_kbps(const Peer& peer) const {
+    // What the guest uploads for itself; forwarding for us is ours to move
+    uint32_t own = peer.used_kbps - std::min(peer.used_kbps, peer.relay_kbps);
+    return peer.capacity_kbps - std::min(peer.capacity_kbps, own);
+}
+
+bool RelayDelegation::is_target(uint32_t ip) const {
+    return contains(m_targets, m_target_count, ip);
+}
+
+void RelayDelegation::queue(uint32_t dest_ip, const RelayControl& control) {
+    if (m_message_count >= MAX_MESSAGES) {
+        return;
+    }
+    m_messages[m_message_count++] = RelayMessage{dest_ip, control};
+}
+
+void RelayDelegation::assign(uint32_t delegate_ip, const uint32_t* targets, size_t count) {
+    bool changed = false;
+
+    if (delegate_ip != m_delegate_ip) {
+        end_delegation();
+        m_delegate_ip = delegate_ip;
+        m_delegate_accepted = false;
+        m_stats.elections++;
+        changed = true;
+    }
+
+    // Dropped targets go back to direct fan-out
+    for (size_t i = 0; i < m_target_count; i++) {
+        if (!contains(targets, count, m_targets[i])) {
+            queue(m_targets[i], make_relay_control(RelayControlType::Release));
+            if (Peer* peer = find_peer(m_targets[i])) {
+                peer->joined = false;
+            }
+            changed = true;
+        }
+    }
+
+    RelayControl join = make_relay_control(RelayControlType::Join);
+    join.peer_ip = delegate_ip;
+    for (size_t i = 0; i < count; i++) {
+        if (!is_target(targets[i])) {
+            queue(targets[i], join);
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    m_target_count = count;
+    std::memcpy(m_targets, targets, count * sizeof(uint32_t));
+
+    RelayControl assign = make_relay_control(RelayControlType::Assign);
+    assign.count = static_cast<uint8_t>(count);
+    std::memcpy(assign.targets, targets, count * sizeof(uint32_t));
+    queue(delegate_ip, assign);
+}
+
+void RelayDelegation::end_delegation() {
+    if (m_delegate_ip == 0) {
+        return;
+    }
+
+    // Targets first: they must stop accepting forwards before direct copies arrive
+    RelayControl release = make_relay_control(RelayControlType::Release);
+    for (size_t i = 0; i < m_target_count; i++) {
+        queue(m_targets[i], release);
+    }
+    queue(m_delegate_ip, release);
+
+    for (size_t i = 0; i < m_peer_count; i++) {
+        m_peers[i].joined = false;
+    }
+    m_delegate_ip = 0;
+    m_delegate_accepted = false;
+    m_target_count = 0;
+}
+
+void RelayDelegation::on_control(uint32_t source_ip, const RelayControl& control, uint64_t now_ms) {
+    switch (control.type) {
+        case RelayControlType::Report: {
+            Peer* peer = find_peer(source_ip);
+            if (peer == nullptr) {
+                peer = add_peer(source_ip);
+                if (peer == nullptr) {
+                    return;
+                }
+            }
+            peer->capacity_kbps = control.capacity_kbps;
+            peer->used_kbps = control.used_kbps;
+            peer->relay_kbps = control.relay_kbps;
+            peer->last_report_ms = now_ms;
+            break;
+        }
+
+        case RelayControlType::Accept:
+            if (source_ip == m_delegate_ip && m_delegate_ip != 0) {
+                m_delegate_accepted = true;
+            }
+            break;
+
+        case RelayControlType::Joined:
+            if (m_delegate_ip != 0 && control.peer_ip == m_delegate_ip && is_target(source_ip)) {
+                if (Peer* peer = find_peer(source_ip)) {
+                    peer->joined = true;
+                }
+            }
+            break;
+
+        default:
+            // Host-to-guest types are never accepted from a guest
+            break;
+    }
+}
+
+void RelayDelegation::on_peer_lost(uint32_t ip, uint64_t now_ms) {
+    (void)now_ms;
+
+    if (ip != 0 && ip == m_delegate_ip) {
+        end_delegation();
+        m_stats.failovers++;
+        // Elect again at once if the host is still saturated
+        m_next_plan_ms = 0;
+    } else if (is_target(ip)) {
+        uint32_t targets[RELAY_MAX_TARGETS];
+        size_t count = 0;
+        for (size_t i = 0; i < m_target_count; i++) {
+            if (m_targets[i] != ip) {
+                targets[count++] = m_targets[i];
+            }
+        }
+        if (count == 0) {
+            end_delegation();
+        } else {
+            // No Release to a guest that is gone
+            m_target_count = count;
+            std::memcpy(m_targets, targets, count * sizeof(uint32_t));
+            RelayControl assign = make_relay_control(RelayControlType::Assign);
+            assign.count = static_cast<uint8_t>(count);
+            std::memcpy(assign.targets, targets, count * sizeof(uint32_t));
+            queue(m_delegate_ip, assign);
+        }
+    }
+
+    remove_peer(ip);
+}
+
+void RelayDelegation::on_copy(uint32_t bytes, bool sent, uint64_t now_ms) {
+    m_demand.add(bytes, now_ms);
+    if (sent) {
+        m_sent.add(bytes, now_ms);
+    }
+}
+
+void RelayDelegation::update(size_t remote_guests, uint64_t now_ms) {
+    // Guests that stopped reporting: left, or their link to us is broken
+    for (size_t i = m_peer_count; i > 0; i--) {
+        const Peer& peer = m_peers[i - 1];
+        if (now_ms > peer.last_report_ms + RELAY_REPORT_TIMEOUT_MS) {
+            on_peer_lost(peer.ip, now_ms);
+        }
+    }
+
+    if (now_ms < m_next_plan_ms) {
+        return;
+    }
+    m_next_plan_ms = now_ms + RELAY_PLAN_INTERVAL_MS;
+
+    uint64_t host_kbps = m_config.uplink_kbps;
+    uint64_t demand = m_demand.kbps(now_ms);
+    bool engaged = m_config.enabled && host_kbps != 0 && remote_guests >= 2;
+    if (engaged) {
+        uint32_t percent = (m_delegate_ip == 0) ? RELAY_ENGAGE_PERCENT : RELAY_RELEASE_PERCENT;
+        engaged = demand * 100 >= host_kbps * percent;
+    }
+    if (!engaged) {
+        if (m_delegate_ip != 0) {
+            end_delegation();
+            m_stats.releases++;
+        }
+        return;
+    }
+
+    // Election: most spare uplink, ties to the lowest IP, the delegate stays
+    // unless a challenger has clearly more
+    const Peer* best = nullptr;
+    for (size_t i = 0; i < m_peer_count; i++) {
+        const Peer& peer = m_peers[i];
+        if (peer.capacity_kbps == 0) {
+            continue;
+        }
+        if (best == nullptr || spare_kbps(peer) > spare_kbps(*best) ||
+            (spare_kbps(peer) == spare_kbps(*best) && peer.ip < best->ip)) {
+            best = &peer;
+        }
+    }
+    const Peer* incumbent = find_peer(m_delegate_ip);
+    if (incumbent != nullptr && best != incumbent && incumbent->capacity_kbps != 0 &&
+        static_cast<uint64_t>(spare_kbps(*best)) * 100 <
+            static_cast<uint64_t>(spare_kbps(*incumbent)) * RELAY_SWITCH_PERCENT) {
+        best = incumbent;
+    }
+    if (best == nullptr || spare_kbps(*best) == 0) {
+        end_delegation();
+        return;
+    }
+    uint32_t delegate_ip = best->ip;
+    uint64_t delegate_kbps = spare_kbps(*best);
+
+    // Targets: reporting guests (they can unwrap a Forward), current ones first
+    uint32_t candidates[RELAY_MAX_PEERS];
+    size_t candidate_count = 0;
+    for (size_t i = 0; i < m_peer_count; i++) {
+        if (m_peers[i].ip != delegate_ip) {
+            candidates[candidate_count++] = m_peers[i].ip;
+        }
+    }
+    bool keep = (delegate_ip == m_delegate_ip);
+    auto before = [&](uint32_t a, uint32_t b) {
+        bool a_current = keep && is_target(a);
+        bool b_current = keep && is_target(b);
+        return a_current != b_current ? a_current : a < b;
+    };
+    for (size_t i = 1; i < candidate_count; i++) {
+        for (size_t j = i; j > 0 && before(candidates[j], candidates[j - 1]); j--) {
+            std::swap(candidates[j], candidates[j - 1]);
+        }
+    }
+
+    // Split: k targets cost the host (n - k) copies and the delegate k copies.
+    // Keep the smallest k that minimizes the busier of the two uplinks.
+    uint64_t n = remote_guests;
+    uint64_t copy_kbps = std::max<uint64_t>(demand / n, 1);
+    size_t max_k = std::min<size_t>(std::min<size_t>(candidate_count, RELAY_MAX_TARGETS), n - 1);
+    size_t best_k = 0;
+    double best_load = static_cast<double>(n * copy_kbps) / host_kbps;
+    for (size_t k = 1; k <= max_k; k++) {
+        double host_load = static_cast<double>((n - k) * copy_kbps) / host_kbps;
+        double delegate_load = static_cast<double>(k * copy_kbps) / delegate_kbps;
+        double load = std::max(host_load, delegate_load);
+        if (load < best_load) {
+            best_load = load;
+            best_k = k;
+        }
+    }
+
+    if (best_k == 0) {
+        if (m_delegate_ip != 0) {
+            end_delegation();
+            m_stats.releases++;
+        }
+        return;
+    }
+
+    assign(delegate_ip, candidates, best_k);
+}
+
+size_t RelayDelegation::take_messages(RelayMessage* out, size_t max) {
+    size_t count = std::min(max, m_message_count);
+    std::memcpy(out, m_messages, count * sizeof(RelayMessage));
+    std::memmove(m_messages, m_messages + count, (m_message_count - count) * sizeof(RelayMessage));
+    m_message_count -= count;
+    return count;
+}
+
+uint32_t RelayDelegation::delegate() const {
+    if (m_delegate_ip == 0 || !m_delegate_accepted) {
+        return 0;
+    }
+    for (size_t i = 0; i < m_target_count; i++) {
+        if (is_delegated(m_targets[i])) {
+            return m_delegate_ip;
+        }
+    }
+    return 0;
+}
+
+bool RelayDelegation::is_delegated(uint32_t ip) const {
+    if (m_delegate_ip == 0 || !m_delegate_accepted || !is_target(ip)) {
+        return false;
+    }
+    for (size_t i = 0; i < m_peer_count; i++) {
+        if (m_peers[i].ip == ip) {
+            return m_peers[i].joined;
+        }
+    }
+    return false;
+}
+
+size_t RelayDelegation::active_targets(uint32_t* out) const {
+    size_t count = 0;
+    for (size_t i = 0; i < m_target_count; i++) {
+        if (is_delegated(m_targets[i])) {
+            out[count++] = m_targets[i];
+        }
+    }
+    return count;
+}
+
+// ============================================================================
+// RelayMember (guest)
+// ============================================================================
+
+RelayMember::RelayMember()
+    : m_config{false, 0}
+{
+    reset();
+}
+
+void RelayMember::configure(const RelayDelegationConfig& config) {
+    m_config = config;
+}
+
+void RelayMember::reset() {
+    m_assigned_count = 0;
+    m_delegate_ip = 0;
+    m_former_delegate_ip = 0;
+    m_release_ms = 0;
+    m_relayed.reset();
+    m_last_tx_bytes = 0;
+    m_last_report_ms = 0;
+    m_used_kbps = 0;
+    m_reported = false;
+}
+
+bool RelayMember::make_report(uint64_t total_tx_bytes, uint64_t now_ms, RelayControl& out) {
+    if (!m_config.enabled || m_config.uplink_kbps == 0) {
+        return false;
+    }
+    if (m_reported && now_ms < m_last_report_ms + RELAY_REPORT_INTERVAL_MS) {
+        return false;
+    }
+
+    if (m_reported && now_ms > m_last_report_ms && total_tx_bytes >= m_last_tx_bytes) {
+        m_used_kbps = static_cast<uint32_t>((total_tx_bytes - m_last_tx_bytes) * 8 /
+                                            (now_ms - m_last_report_ms));
+    }
+    m_last_tx_bytes = total_tx_bytes;
+    m_last_report_ms = now_ms;
+    m_reported = true;
+
+    out = make_relay_control(RelayControlType::Report);
+    out.capacity_kbps = m_config.uplink_kbps;
+    out.used_kbps = m_used_kbps;
+    out.relay_kbps = m_relayed.kbps(now_ms);
+    return true;
+}
+
+bool RelayMember::on_host_control(const RelayControl& control, uint64_t now_ms, RelayControl& reply) {
+    switch (control.type) {
+        case RelayControlType::Assign:
+            if (!m_config.enabled) {
+                return false;
+            }
+            m_assigned_count = std::min<size_t>(control.count, RELAY_MAX_TARGETS);
+            std::memcpy(m_assigned, control.targets, m_assigned_count * sizeof(uint32_t));
+            reply = make_relay_control(RelayControlType::Accept);
+            return true;
+
+        case RelayControlType::Join:
+            if (!m_config.enabled || control.peer_ip == 0) {
+                return false;
+            }
+            if (m_delegate_ip != 0 && m_delegate_ip != control.peer_ip) {
+                m_former_delegate_ip = m_delegate_ip;
+                m_release_ms = now_ms;
+            }
+            m_delegate_ip = control.peer_ip;
+            reply = make_relay_control(RelayControlType::Joined);
+            reply.peer_ip = control.peer_ip;
+            return true;
+
+        case RelayControlType::Release:
+            m_assigned_count = 0;
+            if (m_delegate_ip != 0) {
+                m_former_delegate_ip = m_delegate_ip;
+                m_release_ms = now_ms;
+            }
+            m_delegate_ip = 0;
+            return false;
+
+        default:
+            return false;
+    }
+}
+
+bool RelayMember::accept_forward(uint32_t source_ip, uint64_t now_ms) const {
+    if (source_ip == 0) {
+        return false;
+    }
+    if (source_ip == m_delegate_ip) {
+        return true;
+    }
+    return source_ip == m_former_delegate_ip && now_ms < m_release_ms + RELAY_RELEASE_GRACE_MS;
+}
+
+size_t RelayMember::forward_targets(const RelayControl& control, uint32_t* out) const {
+    size_t count = 0;
+    for (size_t i = 0; i < control.count && i < RELAY_MAX_TARGETS; i++) {
+        if (contains(m_assigned, m_assigned_count, control.targets[i])) {
+            out[count++] = control.targets[i];
+        }
+    }
+    return count;
+}
+
+} // namespace ryu_ldn::p2p
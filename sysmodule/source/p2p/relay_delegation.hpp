@@ -0,0 +1,468 @@
+/**
+ * @file relay_delegation.hpp
+ * @brief Delegation of part of the P2P host broadcast fan-out to a guest
+ *
+ * P2pProxyServer is a star: every broadcast a player sends is uploaded by
+ * the hosting console once per guest. Home connections are asymmetric, so
+ * with 8 players the host uplink saturates long before any guest's does,
+ * and every player sees the host's queueing delay.
+ *
+ * When enabled, the host measures its own broadcast fan-out rate and each
+ * ryu_ldn_nx guest reports its uplink capacity and usage. Once the fan-out
+ * nears the host's uplink, the guest with the most spare uplink is elected
+ * delegate: the host sends it one wrapped copy of each broadcast and the
+ * delegate re-sends it, over its own server connection, to a subset of the
+ * guests. The game-level host (LDN access point) does not change.
+ *
+ * ## Wire Format
+ *
+ * ProxyData to port RELAY_CONTROL_PORT, only between ryu_ldn_nx consoles:
+ *
+ * ```
+ * 0x00    4     magic ("RLYC")
+ * 0x04    1     version
+ * 0x05    1     type
+ * 0x06    1     target count (Assign, Forward)
+ * 0x07    1     reserved
+ * 0x08    4     capacity_kbps (Report)
+ * 0x0C    4     used_kbps (Report)
+ * 0x10    4     relay_kbps (Report: part of used_kbps forwarded for the host)
+ * 0x14    4     peer_ip (Join: delegate)
+ * 0x18    28    targets (Assign, Forward)
+ *
+ * Forward: the control above, then the original ProxyInfo (16 bytes), then
+ * the original payload.
+ * ```
+ *
+ * ## Exchange
+ *
+ * ```
+ * Guest                     Host                      Delegate / Target
+ *   │── Report (1/s) ──────►│                              │
+ *   │                       │── Assign(targets) ──────────►│ delegate
+ *   │                       │◄─ Accept ────────────────────│
+ *   │                       │── Join(delegate) ───────────►│ target
+ *   │                       │◄─ Joined ────────────────────│
+ *   │                       │── Forward(targets) ─────────►│ delegate ──relay──► targets
+ *   │                       │── Release ──────────────────►│
+ * ```
+ *
+ * Direct sends to a target stop only once the delegate accepted and the
+ * target joined, and resume as soon as either is released or lost. Control
+ * messages travel on the P2P link to and from the host; the host never
+ * routes them between guests, and a target only accepts forwards from the
+ * delegate it joined. Forwards already on their way through the relay when
+ * a target is released are still accepted for RELAY_RELEASE_GRACE_MS: the
+ * host sent them instead of a direct copy.
+ *
+ * ## Thread Safety
+ *
+ * NOT thread-safe. P2pProxyServer and ICommunicationService serialize access.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "../protocol/types.hpp"
+
+namespace ryu_ldn::p2p {
+
+/**
+ * @brief Magic of a relay control message ("RLYC")
+ */
+constexpr uint32_t RELAY_CONTROL_MAGIC = 0x43594C52;
+
+/**
+ * @brief Protocol version carried in control messages
+ */
+constexpr uint8_t RELAY_VERSION = 1;
+
+/**
+ * @brief Destination port of control messages (never bound by a game)
+ */
+constexpr uint16_t RELAY_CONTROL_PORT = 0;
+
+/**
+ * @brief Guests tracked by the host (P2pProxyServer::MAX_PLAYERS)
+ */
+constexpr size_t RELAY_MAX_PEERS = 8;
+
+/**
+ * @brief Targets one delegate can serve
+ */
+constexpr size_t RELAY_MAX_TARGETS = 7;
+
+/**
+ * @brief Largest broadcast payload sent through the delegate
+ *
+ * Bigger payloads are sent directly to every guest.
+ */
+constexpr uint32_t RELAY_MAX_PAYLOAD = 1500;
+
+/**
+ * @brief Interval between two uplink reports of a guest
+ */
+constexpr uint64_t RELAY_REPORT_INTERVAL_MS = 1000;
+
+/**
+ * @brief Report age after which a guest is considered gone
+ */
+constexpr uint64_t RELAY_REPORT_TIMEOUT_MS = 3500;
+
+/**
+ * @brief Time a released target still accepts forwards from its former delegate
+ */
+constexpr uint64_t RELAY_RELEASE_GRACE_MS = 1000;
+
+/**
+ * @brief Interval between two delegation decisions
+ */
+constexpr uint64_t RELAY_PLAN_INTERVAL_MS = 1000;
+
+/**
+ * @brief Rate measurement window
+ */
+constexpr uint64_t RELAY_RATE_WINDOW_MS = 250;
+
+/**
+ * @brief Host fan-out, in percent of its uplink, that starts delegation
+ */
+constexpr uint32_t RELAY_ENGAGE_PERCENT = 80;
+
+/**
+ * @brief Host fan-out demand, in percent of its uplink, that ends delegation
+ */
+constexpr uint32_t RELAY_RELEASE_PERCENT = 50;
+
+/**
+ * @brief Spare uplink a challenger needs, in percent of the delegate's, to replace it
+ */
+constexpr uint32_t RELAY_SWITCH_PERCENT = 125;
+
+/**
+ * @brief Control message type
+ */
+enum class RelayControlType : uint8_t {
+    Report = 1,   ///< Guest -> host: uplink capacity and usage
+    Assign = 2,   ///< Host -> delegate: re-send broadcasts to targets
+    Accept = 3,   ///< Delegate -> host: reply to Assign
+    Join = 4,     ///< Host -> target: accept forwards from peer_ip
+    Joined = 5,   ///< Target -> host: reply to Join
+    Release = 6,  ///< Host -> delegate or target: back to direct fan-out
+    Forward = 7,  ///< Wrapped broadcast (host -> delegate -> targets)
+};
+
+/**
+ * @brief Control message - 52 bytes
+ */
+struct __attribute__((packed)) RelayControl {
+    uint32_t magic;
+    uint8_t  version;
+    RelayControlType type;
+    uint8_t  count;
+    uint8_t  reserved;
+    uint32_t capacity_kbps;
+    uint32_t used_kbps;
+    uint32_t relay_kbps;
+    uint32_t peer_ip;
+    uint32_t targets[RELAY_MAX_TARGETS];
+};
+static_assert(sizeof(RelayControl) == 52, "RelayControl must be 52 bytes");
+
+/**
+ * @brief Bytes a Forward adds in front of the original payload
+ */
+constexpr size_t RELAY_FORWARD_OVERHEAD = sizeof(RelayControl) + sizeof(protocol::ProxyInfo);
+
+/**
+ * @brief Options, shared by the host and guest sides
+ */
+struct RelayDelegationConfig {
+    bool     enabled;       ///< Delegate as host, volunteer as guest
+    uint32_t uplink_kbps;   ///< Own uplink capacity (0 = unknown: neither)
+};
+
+/**
+ * @brief Counters since the last reset()
+ */
+struct RelayDelegationStats {
+    uint64_t elections;     ///< Delegates assigned
+    uint64_t releases;      ///< Delegations ended because demand dropped
+    uint64_t failovers;     ///< Delegations ended because the delegate was lost
+    uint64_t forwarded;     ///< Broadcasts sent through the delegate
+};
+
+/**
+ * @brief Control message the host must send to a guest
+ */
+struct RelayMessage {
+    uint32_t dest_ip;
+    RelayControl control;
+};
+
+/**
+ * @brief Windowed byte rate with exponential smoothing
+ */
+class RelayRateMeter {
+public:
+    RelayRateMeter() { reset(); }
+
+    void reset();
+
+    void add(uint32_t bytes, uint64_t now_ms);
+
+    /**
+     * @brief Smoothed rate in kbit/s
+     */
+    uint32_t kbps(uint64_t now_ms);
+
+private:
+    void roll(uint64_t now_ms);
+
+    uint64_t m_window_start_ms;
+    uint64_t m_window_bytes;
+    uint32_t m_kbps;
+    bool     m_started;
+};
+
+/**
+ * @brief Whether a ProxyData is a relay control message
+ *
+ * @param info Addressing of the packet
+ * @param payload Payload as received
+ * @param payload_size Payload size
+ * @param out Control header (Forward: followed by ProxyInfo and payload)
+ */
+bool parse_relay_control(const protocol::ProxyInfo& info, const uint8_t* payload,
+                         size_t payload_size, RelayControl& out);
+
+/**
+ * @brief Build a control message
+ */
+RelayControl make_relay_control(RelayControlType type);
+
+/**
+ * @brief Wrap a broadcast into a Forward
+ *
+ * @param targets Guests the delegate re-sends to (none on the last hop)
+ * @param target_count Number of targets
+ * @param info Original addressing
+ * @param payload Original payload
+ * @param payload_size Original payload size
+ * @param out Output buffer
+ * @param out_size Output buffer size
+ * @return Forward size, 0 if it does not fit
+ */
+size_t build_relay_forward(const uint32_t* targets, size_t target_count,
+                           const protocol::ProxyInfo& info, const uint8_t* payload,
+                           size_t payload_size, uint8_t* out, size_t out_size);
+
+/**
+ * @brief Unwrap a Forward
+ *
+ * @param payload Forward as received
+ * @param payload_size Forward size
+ * @param control Out: control header (targets)
+ * @param info Out: original addressing
+ * @param inner Out: original payload (points into payload)
+ * @param inner_size Out: original payload size
+ * @return false if malformed
+ */
+bool parse_relay_forward(const uint8_t* payload, size_t payload_size, RelayControl& control,
+                         protocol::ProxyInfo& info, const uint8_t*& inner, uint32_t& inner_size);
+
+/**
+ * @brief Host side: measures the fan-out, elects the delegate, plans the split
+ */
+class RelayDelegation {
+public:
+    RelayDelegation();
+
+    void configure(const RelayDelegationConfig& config);
+
+    const RelayDelegationConfig& config() const { return m_config; }
+
+    /**
+     * @brief Forget guests and delegation (new network)
+     */
+    void reset();
+
+    /**
+     * @brief Handle a control message received from a guest
+     */
+    void on_control(uint32_t source_ip, const RelayControl& control, uint64_t now_ms);
+
+    /**
+     * @brief A guest left: fail over if it was involved in the delegation
+     */
+    void on_peer_lost(uint32_t ip, uint64_t now_ms);
+
+    /**
+     * @brief Account one copy of a broadcast toward a remote guest
+     *
+     * @param bytes Bytes the copy would take on the wire
+     * @param sent Whether the host uploaded it (false: the delegate did)
+     */
+    void on_copy(uint32_t bytes, bool sent, uint64_t now_ms);
+
+    /**
+     * @brief Elect, re-plan, release, time out guests
+     *
+     * @param remote_guests Authenticated guests reached over the network
+     * @param now_ms Monotonic time
+     */
+    void update(size_t remote_guests, uint64_t now_ms);
+
+    /**
+     * @brief Take the control messages to send
+     * @return Number of messages written
+     */
+    size_t take_messages(RelayMessage* out, size_t max);
+
+    /**
+     * @brief Delegate the host sends Forwards to, 0 while none is active
+     */
+    uint32_t delegate() const;
+
+    /**
+     * @brief Whether the delegate reaches this guest (skip the direct copy)
+     */
+    bool is_delegated(uint32_t ip) const;
+
+    /**
+     * @brief Active targets, for the Forward header
+     * @return Number of targets written
+     */
+    size_t active_targets(uint32_t* out) const;
+
+    /**
+     * @brief Host fan-out actually uploaded (kbit/s)
+     */
+    uint32_t sent_kbps(uint64_t now_ms) { return m_sent.kbps(now_ms); }
+
+    /**
+     * @brief Host fan-out without delegation (kbit/s)
+     */
+    uint32_t demand_kbps(uint64_t now_ms) { return m_demand.kbps(now_ms); }
+
+    void count_forward() { m_stats.forwarded++; }
+
+    const RelayDelegationStats& stats() const { return m_stats; }
+
+private:
+    struct Peer {
+        uint32_t ip;
+        uint32_t capacity_kbps;
+        uint32_t used_kbps;
+        uint32_t relay_kbps;
+        uint64_t last_report_ms;
+        bool     joined;        ///< Confirmed Join to the current delegate
+    };
+
+    Peer* find_peer(uint32_t ip);
+    Peer* add_peer(uint32_t ip);
+    void remove_peer(uint32_t ip);
+    uint32_t spare_kbps(const Peer& peer) const;
+    bool is_target(uint32_t ip) const;
+    void queue(uint32_t dest_ip, const RelayControl& control);
+    void assign(uint32_t delegate_ip, const uint32_t* targets, size_t count);
+    void end_delegation();
+
+    RelayDelegationConfig m_config;
+    RelayDelegationStats m_stats;
+
+    Peer m_peers[RELAY_MAX_PEERS];
+    size_t m_peer_count;
+
+    uint32_t m_delegate_ip;        ///< 0: direct fan-out
+    bool m_delegate_accepted;
+    uint32_t m_targets[RELAY_MAX_TARGETS];
+    size_t m_target_count;
+
+    RelayRateMeter m_sent;
+    RelayRateMeter m_demand;
+    uint64_t m_next_plan_ms;
+
+    static constexpr size_t MAX_MESSAGES = 2 * RELAY_MAX_PEERS + 2;
+    RelayMessage m_messages[MAX_MESSAGES];
+    size_t m_message_count;
+};
+
+/**
+ * @brief Guest side: reports the uplink, acts as delegate or target
+ */
+class RelayMember {
+public:
+    RelayMember();
+
+    void configure(const RelayDelegationConfig& config);
+
+    /**
+     * @brief Leave any delegation (new network or new host)
+     */
+    void reset();
+
+    /**
+     * @brief Build the periodic uplink report
+     *
+     * @param total_tx_bytes Bytes uploaded since boot (usage is its rate)
+     * @param now_ms Monotonic time
+     * @param out Report to send to the host
+     * @return true if a report is due
+     */
+    bool make_report(uint64_t total_tx_bytes, uint64_t now_ms, RelayControl& out);
+
+    /**
+     * @brief Handle a control message from the host
+     *
+     * @param control Assign, Join or Release
+     * @param now_ms Monotonic time
+     * @param reply Out: Accept or Joined
+     * @return true if reply must be sent to the host
+     */
+    bool on_host_control(const RelayControl& control, uint64_t now_ms, RelayControl& reply);
+
+    /**
+     * @brief Targets of a Forward from the host this delegate may re-send to
+     * @return Number of targets written
+     */
+    size_t forward_targets(const RelayControl& control, uint32_t* out) const;
+
+    /**
+     * @brief Account bytes re-sent for the host
+     */
+    void on_relayed(uint32_t bytes, uint64_t now_ms) { m_relayed.add(bytes, now_ms); }
+
+    /**
+     * @brief Whether a last-hop Forward from this source is accepted
+     */
+    bool accept_forward(uint32_t source_ip, uint64_t now_ms) const;
+
+    bool is_delegate() const { return m_assigned_count > 0; }
+
+    /**
+     * @brief Delegate this console joined, 0 if none
+     */
+    uint32_t delegate_ip() const { return m_delegate_ip; }
+
+private:
+    RelayDelegationConfig m_config;
+
+    uint32_t m_assigned[RELAY_MAX_TARGETS];
+    size_t m_assigned_count;
+    uint32_t m_delegate_ip;
+    uint32_t m_former_delegate_ip;  ///< Accepted until m_release_ms + grace
+    uint64_t m_release_ms;
+
+    RelayRateMeter m_relayed;
+    uint64_t m_last_tx_bytes;
+    uint64_t m_last_report_ms;
+    uint32_t m_used_kbps;
+    bool m_reported;
+};
+
+} // namespace ryu_ldn::p2p
@@ -0,0 +1,438 @@
+/**
+ * @file platform.hpp
+ * @brief Thin OS abstraction for code shared between the sysmodule and host builds
+ *
+ * The BSD/LDN data path only needs a handful of OS primitives. Routing
+ * them through this header lets the same sources build against
+ * libstratosphere on the console and against POSIX on a development
+ * machine, where they can be unit tested, benchmarked and run under perf
+ * or valgrind.
+ *
+ * | Primitive  | Console (__SWITCH__)          | Host (POSIX)                   |
+ * |------------|-------------------------------|--------------------------------|
+ * | Mutex      | os::SdkMutex                  | std::mutex                     |
+ * | Event      | os::Event                     | std::condition_variable + flag |
+ * | Thread     | os::ThreadType (caller stack) | pthread (own stack)            |
+ * | Tick       | armGetSystemTick()            | std::chrono::steady_clock      |
+ * | Sleep      | svc::SleepThread()            | std::this_thread::sleep_for    |
+ * | Thread CPU | InfoType_ThreadTickCount      | CLOCK_THREAD_CPUTIME_ID        |
+ * | Random     | os::GenerateRandomBytes()     | std::random_device             |
+ * | Socket     | network/socket.hpp (libnx BSD and POSIX share the API)          |
+ *
+ * On the host, stratosphere_compat.hpp also provides the small part of
+ * the libstratosphere vocabulary the data path uses (Result, R_SUCCEED,
+ * R_THROW, AMS_UNUSED, s32/u64...), so those files compile unchanged.
+ *
+ * Everything is inline: these wrappers sit on the per-packet path.
+ *
+ * On the host, VirtualClock can replace Tick and Sleep with a manually
+ * advanced clock, so soak runs cover hours of timers in seconds.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __SWITCH__
+#include <stratosphere.hpp>
+#else
+#include "stratosphere_compat.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace ryu_ldn::platform {
+
+// ============================================================================
+// Mutex
+// ============================================================================
+
+/**
+ * @brief Non-recursive mutex, usable with std::scoped_lock
+ */
+class Mutex {
+public:
+    Mutex() = default;
+    Mutex(const Mutex&) = delete;
+    Mutex& operator=(const Mutex&) = delete;
+
+    void lock() { m_mutex.lock(); }
+    void unlock() { m_mutex.unlock(); }
+    bool try_lock() { return m_mutex.try_lock(); }
+
+private:
+#ifdef __SWITCH__
+    ams::os::SdkMutex m_mutex;
+#else
+    std::mutex m_mutex;
+#endif
+};
+
+// ============================================================================
+// Event
+// ============================================================================
+
+/**
+ * @brief What happens to a signaled event when a waiter wakes up
+ */
+enum class EventClearMode : uint8_t {
+    Manual = 0,  ///< Stays signaled until Clear()
+    Auto   = 1,  ///< Cleared by the waiter that consumed the signal
+};
+
+/**
+ * @brief Binary event with optional timeout
+ */
+class Event {
+public:
+#ifdef __SWITCH__
+    explicit Event(EventClearMode mode)
+        : m_event(mode == EventClearMode::Auto ? ams::os::EventClearMode_AutoClear
+                                               : ams::os::EventClearMode_ManualClear) {}
+
+    void Signal() { m_event.Signal(); }
+    void Clear() { m_event.Clear(); }
+    void Wait() { m_event.Wait(); }
+    bool TryWait() { return m_event.TryWait(); }
+
+    /**
+     * @brief Wait until signaled or timeout_ms elapsed
+     * @return true if signaled
+     */
+    bool TimedWait(uint64_t timeout_ms) {
+        return m_event.TimedWait(ams::TimeSpan::FromMilliSeconds(timeout_ms));
+    }
+
+    /**
+     * @brief Wait until signaled or timeout_ns elapsed
+     * @return true if signaled
+     */
+    bool TimedWaitNs(uint64_t timeout_ns) {
+        return m_event.TimedWait(ams::TimeSpan::FromNanoSeconds(static_cast<int64_t>(timeout_ns)));
+    }
+
+private:
+    ams::os::Event m_event;
+#else
+    explicit Event(EventClearMode mode)
+        : m_auto_clear(mode == EventClearMode::Auto), m_signaled(false) {}
+
+    void Signal() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_signaled = true;
+        }
+        if (m_auto_clear) {
+            m_cond.notify_one();
+        } else {
+            m_cond.notify_all();
+        }
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_signaled = false;
+    }
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return m_signaled; });
+        Consume();
+    }
+
+    bool TryWait() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_signaled) {
+            return false;
+        }
+        Consume();
+        return true;
+    }
+
+    /**
+     * @brief Wait until signaled or timeout_ms elapsed
+     * @return true if signaled
+     */
+    bool TimedWait(uint64_t timeout_ms) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cond.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                             [this] { return m_signaled; })) {
+            return false;
+        }
+        Consume();
+        return true;
+    }
+
+    /**
+     * @brief Wait until signaled or timeout_ns elapsed
+     * @return true if signaled
+     */
+    bool TimedWaitNs(uint64_t timeout_ns) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cond.wait_for(lock, std::chrono::nanoseconds(timeout_ns),
+                             [this] { return m_signaled; })) {
+            return false;
+        }
+        Consume();
+        return true;
+    }
+
+private:
+    void Consume() {
+        if (m_auto_clear) {
+            m_signaled = false;
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_auto_clear;
+    bool m_signaled;
+#endif
+
+public:
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+};
+
+// ============================================================================
+// Thread
+// ============================================================================
+
+/// Thread entry point
+using ThreadFunction = void (*)(void* arg);
+
+#ifdef __SWITCH__
+constexpr int HighestThreadPriority = ams::os::HighestThreadPriority;
+constexpr int LowestThreadPriority = ams::os::LowestThreadPriority;
+#else
+constexpr int HighestThreadPriority = 28;
+constexpr int LowestThreadPriority = 59;
+#endif
+
+/**
+ * @brief Joinable thread running on a caller-provided stack
+ *
+ * The stack must stay valid until Join() returns. On the host the stack
+ * is ignored (PTHREAD_STACK_MIN is larger than the console stacks) and
+ * priorities are not applied.
+ */
+class Thread {
+public:
+    Thread() = default;
+    Thread(const Thread&) = delete;
+    Thread& operator=(const Thread&) = delete;
+
+    /**
+     * @brief Create and start the thread
+     *
+     * @param func Entry point
+     * @param arg Passed to func
+     * @param stack Stack memory (0x1000 aligned on the console)
+     * @param stack_size Stack size in bytes
+     * @param priority Console thread priority
+     * @param name Thread name for debuggers (must outlive the thread)
+     * @return false if the thread could not be created
+     */
+    bool Start(ThreadFunction func, void* arg, void* stack, size_t stack_size,
+               int priority, const char* name) {
+#ifdef __SWITCH__
+        if (R_FAILED(ams::os::CreateThread(&m_thread, func, arg, stack, stack_size, priority))) {
+            return false;
+        }
+        ams::os::SetThreadNamePointer(&m_thread, name);
+        ams::os::StartThread(&m_thread);
+#else
+        AMS_UNUSED(stack, stack_size, priority);
+        m_func = func;
+        m_arg = arg;
+        if (pthread_create(&m_thread, nullptr, &Thread::Trampoline, this) != 0) {
+            return false;
+        }
+#if defined(__linux__)
+        pthread_setname_np(m_thread, name);
+#else
+        AMS_UNUSED(name);
+#endif
+#endif
+        m_started = true;
+        return true;
+    }
+
+    /**
+     * @brief Wait for the thread to exit and release it
+     */
+    void Join() {
+        if (!m_started) {
+            return;
+        }
+#ifdef __SWITCH__
+        ams::os::WaitThread(&m_thread);
+        ams::os::DestroyThread(&m_thread);
+#else
+        pthread_join(m_thread, nullptr);
+#endif
+        m_started = false;
+    }
+
+    bool IsStarted() const { return m_started; }
+
+private:
+#ifdef __SWITCH__
+    ams::os::ThreadType m_thread{};
+#else
+    static void* Trampoline(void* self) {
+        auto* thread = static_cast<Thread*>(self);
+        thread->m_func(thread->m_arg);
+        return nullptr;
+    }
+
+    pthread_t m_thread{};
+    ThreadFunction m_func = nullptr;
+    void* m_arg = nullptr;
+#endif
+    bool m_started = false;
+};
+
+// ============================================================================
+// Time
+// ============================================================================
+
+#ifndef __SWITCH__
+/**
+ * @brief Accelerated time for host harnesses
+ *
+ * While enabled, GetTickNs() returns the virtual time and SleepNs()
+ * advances it instead of sleeping. Meant for single-threaded drivers:
+ * Event::TimedWait() and socket timeouts still use real time.
+ */
+class VirtualClock {
+public:
+    static void Enable(uint64_t start_ns) {
+        s_now_ns.store(start_ns);
+        s_enabled.store(true);
+    }
+    static void Disable() { s_enabled.store(false); }
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static uint64_t NowNs() { return s_now_ns.load(std::memory_order_relaxed); }
+    static void Advance(uint64_t ns) { s_now_ns.fetch_add(ns, std::memory_order_relaxed); }
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+    static inline std::atomic<uint64_t> s_now_ns{0};
+};
+#endif
+
+/**
+ * @brief Monotonic time in nanoseconds
+ */
+inline uint64_t GetTickNs() {
+#ifdef __SWITCH__
+    return armTicksToNs(armGetSystemTick());
+#else
+    if (VirtualClock::IsEnabled()) {
+        return VirtualClock::NowNs();
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * @brief Monotonic time in milliseconds
+ */
+inline uint64_t GetTickMs() {
+    return GetTickNs() / 1000000ULL;
+}
+
+/**
+ * @brief Sleep the calling thread
+ */
+inline void SleepNs(uint64_t ns) {
+#ifdef __SWITCH__
+    ams::svc::SleepThread(static_cast<int64_t>(ns));
+#else
+    if (VirtualClock::IsEnabled()) {
+        VirtualClock::Advance(ns);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+#endif
+}
+
+/**
+ * @brief Sleep the calling thread
+ */
+inline void SleepMs(uint32_t ms) {
+    SleepNs(static_cast<uint64_t>(ms) * 1000000ULL);
+}
+
+// ============================================================================
+// Thread Accounting
+// ============================================================================
+
+/**
+ * @brief Opaque id of the calling thread, never 0
+ */
+inline uint64_t GetCurrentThreadId() {
+#ifdef __SWITCH__
+    return reinterpret_cast<uintptr_t>(ams::os::GetCurrentThread());
+#else
+    return static_cast<uint64_t>((uintptr_t)pthread_self());
+#endif
+}
+
+/**
+ * @brief CPU time consumed by the calling thread, in nanoseconds
+ *
+ * The console kernel only reports this for the current thread, so a
+ * thread can only sample itself.
+ *
+ * @return CPU time since the thread started, 0 if unavailable
+ */
+inline uint64_t GetThreadCpuNs() {
+#ifdef __SWITCH__
+    u64 ticks = 0;
+    if (R_FAILED(svcGetInfo(&ticks, InfoType_ThreadTickCount, CUR_THREAD_HANDLE, UINT64_MAX))) {
+        return 0;
+    }
+    return armTicksToNs(ticks);
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+// ============================================================================
+// Random
+// ============================================================================
+
+/**
+ * @brief Fill a buffer with unpredictable bytes (nonces, not keys)
+ */
+inline void FillRandom(void* out, size_t size) {
+#ifdef __SWITCH__
+    ams::os::GenerateRandomBytes(out, size);
+#else
+    std::random_device device;
+    uint8_t* bytes = static_cast<uint8_t*>(out);
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = static_cast<uint8_t>(device());
+    }
+#endif
+}
+
+} // namespace ryu_ldn::platform
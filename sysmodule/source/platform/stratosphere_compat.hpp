@@ -0,0 +1,92 @@
+/**
+ * @file stratosphere_compat.hpp
+ * @brief Host stand-ins for the libstratosphere/libnx vocabulary used by portable code
+ *
+ * Only included by platform.hpp on non-Switch builds. Provides just enough
+ * for the data path to compile unchanged: libnx integer aliases,
+ * ams::Result with the R_* control macros, and AMS_UNUSED.
+ *
+ * Result values keep their raw meaning: a non-zero value is a failure and
+ * GetValue() returns whatever was thrown (the BSD code throws errno values).
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#pragma once
+
+#ifdef __SWITCH__
+#error "stratosphere_compat.hpp is for host builds only"
+#endif
+
+#include <cstdint>
+
+// ============================================================================
+// libnx Integer Aliases
+// ============================================================================
+
+using u8  = uint8_t;
+using u16 = uint16_t;
+using u32 = uint32_t;
+using u64 = uint64_t;
+using s8  = int8_t;
+using s16 = int16_t;
+using s32 = int32_t;
+using s64 = int64_t;
+
+// ============================================================================
+// Result
+// ============================================================================
+
+namespace ams {
+
+/**
+ * @brief Minimal ams::Result: 0 is success, anything else a failure
+ */
+class Result {
+public:
+    constexpr Result() : m_value(0) {}
+    constexpr Result(uint32_t value) : m_value(value) {}
+
+    constexpr bool IsSuccess() const { return m_value == 0; }
+    constexpr bool IsFailure() const { return m_value != 0; }
+    constexpr uint32_t GetValue() const { return m_value; }
+
+private:
+    uint32_t m_value;
+};
+
+constexpr Result ResultSuccess() { return Result(0); }
+
+} // namespace ams
+
+#define R_SUCCEEDED(res) (::ams::Result(res).IsSuccess())
+#define R_FAILED(res) (::ams::Result(res).IsFailure())
+
+#define R_SUCCEED() return ::ams::ResultSuccess()
+#define R_RETURN(res) return ::ams::Result(res)
+#define R_THROW(res) return ::ams::Result(static_cast<uint32_t>(res))
+
+#define R_TRY(res_expr)                                  \
+    do {                                                 \
+        const ::ams::Result _r_try_rc = (res_expr);      \
+        if (_r_try_rc.IsFailure()) {                     \
+            return _r_try_rc;                            \
+        }                                                \
+    } while (0)
+
+#define R_UNLESS(cond, res)                              \
+    do {                                                 \
+        if (!(cond)) {                                   \
+            R_THROW(res);                                \
+        }                                                \
+    } while (0)
+
+// ============================================================================
+// Misc
+// ============================================================================
+
+template <typename... Args>
+constexpr void ams_unused_impl(const Args&...) {}
+
+#define AMS_UNUSED(...) ams_unused_impl(__VA_ARGS__)
@@ -0,0 +1,635 @@
+/**
+ * @file alloc_guard_tests.cpp
+ * @brief Unit tests for the allocation tracker and the allocation-free data path
+ *
+ * This binary links diagnostics/alloc_guard.cpp, so every operator new of
+ * the process goes through the tracker, including the production data path
+ * from libryu_core.a.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Tracker Tests
+ * Counters, scopes, nesting, other threads, slot table, violation report
+ * and the default handler aborting with the call stack.
+ *
+ * ### Data Path Tests
+ * A cold socket seen allocating, then steady-state ProxyData receive and
+ * send (UDP and TCP), dispatch and the LdnProxyHandler connection table
+ * inside a NoAllocScope, after a warm-up lap that sizes the queues.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bsd/proxy_socket_manager.hpp"
+#include "diagnostics/alloc_guard.hpp"
+#include "ldn/ldn_packet_dispatcher.hpp"
+#include "ldn/ldn_proxy_handler.hpp"
+#include "protocol/ryu_protocol.hpp"
+
+using namespace ryu_ldn::diagnostics;
+using namespace ams::mitm::bsd;
+using ryu_ldn::bsd::SockAddrIn;
+using ryu_ldn::bsd::SocketType;
+using ryu_ldn::bsd::ProtocolType;
+namespace protocol = ryu_ldn::protocol;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t LOCAL_IP = 0x0A720001;  // 10.114.0.1
+constexpr uint32_t PEER_IP  = 0x0A720002;  // 10.114.0.2
+constexpr uint16_t GAME_PORT = 12345;
+
+/// Packets run inside the scope after warm-up
+constexpr int STEADY_PACKETS = 1000;
+
+/// Enough packets to take every queue slot once
+constexpr int WARMUP_PACKETS = static_cast<int>(PROXY_SOCKET_MAX_QUEUE_SIZE) * 2;
+
+// Last violation seen by RecordViolation
+struct Recorded {
+    int count;
+    size_t size;
+    size_t frame_count;
+};
+Recorded g_recorded;
+
+void RecordViolation(const AllocViolation& violation, void*) {
+    g_recorded.count++;
+    g_recorded.size = violation.size;
+    g_recorded.frame_count = violation.frame_count;
+}
+
+void AllocatingHandler(const AllocViolation& violation, void*) {
+    RecordViolation(violation, nullptr);
+    std::vector<int> scratch(16);
+    (void)scratch;
+}
+
+// Keeps new/delete from being paired away by the optimizer
+void* volatile g_sink;
+
+void AllocateOnce(size_t size) {
+    g_sink = ::operator new(size);
+    ::operator delete(g_sink);
+}
+
+SockAddrIn MakeAddr(uint32_t ip, uint16_t port) {
+    SockAddrIn addr{};
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    addr.sin_port = __builtin_bswap16(port);
+    addr.sin_addr = __builtin_bswap32(ip);
+    return addr;
+}
+
+// Same mapping as ICommunicationService::HandleServerPacket
+void OnProxyData(const protocol::LdnHeader&, const protocol::ProxyDataHeader& proxy_header,
+                 const uint8_t* data, size_t) {
+    ProtocolType proto = proxy_header.info.protocol == protocol::ProtocolType::Tcp
+                             ? ProtocolType::Tcp : ProtocolType::Udp;
+    ProxySocketManager::GetInstance().RouteIncomingData(
+        proxy_header.info.source_ipv4, proxy_header.info.source_port,
+        proxy_header.info.dest_ipv4, proxy_header.info.dest_port,
+        proto, data, proxy_header.data_length);
+}
+
+// Same framing as SendProxyDataCallback, into a fixed buffer
+uint8_t g_tx_wire[sizeof(protocol::LdnHeader) + sizeof(protocol::ProxyDataHeader) +
+                  PROXY_SOCKET_MAX_PAYLOAD];
+
+bool EncodeProxyData(uint32_t source_ip, uint16_t source_port,
+                     uint32_t dest_ip, uint16_t dest_port,
+                     ProtocolType proto, const void* data, size_t data_len) {
+    protocol::ProxyInfo info{};
+    info.source_ipv4 = source_ip;
+    info.source_port = source_port;
+    info.dest_ipv4 = dest_ip;
+    info.dest_port = dest_port;
+    info.protocol = proto == ProtocolType::Tcp ? protocol::ProtocolType::Tcp
+                                               : protocol::ProtocolType::Udp;
+    size_t size = 0;
+    return protocol::encode_proxy_data(g_tx_wire, sizeof(g_tx_wire), info,
+                                       static_cast<const uint8_t*>(data), data_len,
+                                       size) == protocol::EncodeResult::Success;
+}
+
+// Plays the server: accepts every ProxyConnect
+bool ReplyToConnect(uint32_t source_ip, uint16_t source_port,
+                    uint32_t dest_ip, uint16_t dest_port, ProtocolType) {
+    protocol::ProxyConnectResponse response{};
+    response.info.source_ipv4 = source_ip;
+    response.info.source_port = source_port;
+    response.info.dest_ipv4 = dest_ip;
+    response.info.dest_port = dest_port;
+    response.info.protocol = protocol::ProtocolType::Unspecified;
+    return ProxySocketManager::GetInstance().RouteConnectResponse(response);
+}
+
+size_t EncodeIncoming(uint8_t* wire, size_t wire_size, protocol::ProtocolType proto,
+                      size_t payload_size) {
+    uint8_t payload[PROXY_SOCKET_MAX_PAYLOAD];
+    std::memset(payload, 0xA5, payload_size);
+
+    protocol::ProxyInfo info{};
+    info.source_ipv4 = PEER_IP;
+    info.source_port = GAME_PORT;
+    info.dest_ipv4 = LOCAL_IP;
+    info.dest_port = GAME_PORT;
+    info.protocol = proto;
+
+    size_t size = 0;
+    protocol::encode_proxy_data(wire, wire_size, info, payload, payload_size, size);
+    return size;
+}
+
+/**
+ * @brief Decode and dispatch one server packet, as HandleServerPacket does
+ */
+void Dispatch(ryu_ldn::ldn::PacketDispatcher& dispatcher, const uint8_t* wire, size_t wire_size) {
+    protocol::LdnHeader header;
+    if (protocol::decode_header(wire, wire_size, header) != protocol::DecodeResult::Success) {
+        abort();
+    }
+    dispatcher.dispatch(header, wire + sizeof(protocol::LdnHeader),
+                        static_cast<size_t>(header.data_size));
+}
+
+/**
+ * @brief Restore the default handler and the socket manager after a test
+ */
+struct Cleanup {
+    ~Cleanup() {
+        set_alloc_violation_handler(nullptr, nullptr);
+        auto& manager = ProxySocketManager::GetInstance();
+        manager.SetSendCallback(nullptr);
+        manager.SetProxyConnectCallback(nullptr);
+        manager.CloseAllProxySockets();
+    }
+};
+
+} // namespace
+
+// ============================================================================
+// Tracker Tests
+// ============================================================================
+
+bool test_counts_allocations() {
+    const uint64_t count = alloc_guard_count();
+    const uint64_t bytes = alloc_guard_bytes();
+
+    AllocateOnce(40);
+
+    ASSERT_EQ(alloc_guard_count() - count, 1);
+    ASSERT_EQ(alloc_guard_bytes() - bytes, 40);
+    return true;
+}
+
+bool test_allocation_outside_scope_ignored() {
+    Cleanup cleanup;
+    g_recorded = {};
+    set_alloc_violation_handler(RecordViolation, nullptr);
+
+    {
+        NoAllocScope no_alloc;
+    }
+    AllocateOnce(16);
+
+    ASSERT_EQ(g_recorded.count, 0);
+    return true;
+}
+
+bool test_violation_reported() {
+    Cleanup cleanup;
+    g_recorded = {};
+    set_alloc_violation_handler(RecordViolation, nullptr);
+
+    NoAllocScope no_alloc;
+    ASSERT_TRUE(no_alloc.active());
+    ASSERT_EQ(no_alloc.violations(), 0);
+
+    AllocateOnce(24);
+    g_sink = new int[4];
+    delete[] static_cast<int*>(g_sink);
+
+    ASSERT_EQ(no_alloc.violations(), 2);
+    ASSERT_EQ(g_recorded.count, 2);
+    ASSERT_EQ(g_recorded.size, 4 * sizeof(int));
+    ASSERT_TRUE(g_recorded.frame_count > 0);
+    return true;
+}
+
+bool test_nested_scopes() {
+    Cleanup cleanup;
+    g_recorded = {};
+    set_alloc_violation_handler(RecordViolation, nullptr);
+
+    NoAllocScope outer;
+    {
+        NoAllocScope inner;
+        AllocateOnce(8);
+        ASSERT_EQ(inner.violations(), 1);
+    }
+    // Closing the inner scope keeps the thread guarded
+    AllocateOnce(8);
+
+    ASSERT_EQ(outer.violations(), 2);
+    ASSERT_EQ(g_recorded.count, 2);
+    return true;
+}
+
+bool test_other_thread_not_guarded() {
+    Cleanup cleanup;
+    g_recorded = {};
+    set_alloc_violation_handler(RecordViolation, nullptr);
+
+    std::atomic<bool> go{false};
+    std::atomic<bool> done{false};
+    std::thread other([&] {
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+        AllocateOnce(32);
+        done.store(true);
+    });
+
+    {
+        NoAllocScope no_alloc;
+        go.store(true);
+        while (!done.load()) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(no_alloc.violations(), 0);
+    }
+    other.join();
+
+    ASSERT_EQ(g_recorded.count, 0);
+    return true;
+}
+
+bool test_slot_table_full() {
+    Cleanup cleanup;
+    g_recorded = {};
+    set_alloc_violation_handler(RecordViolation, nullptr);
+
+    std::atomic<size_t> opened{0};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> holders;
+    for (size_t i = 0; i < ALLOC_GUARD_SLOTS; i++) {
+        holders.emplace_back([&] {
+            NoAllocScope held;
+            opened.fetch_add(1);
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    while (opened.load() < ALLOC_GUARD_SLOTS) {
+        std::this_thread::yield();
+    }
+
+    bool active = false;
+    {
+        NoAllocScope no_alloc;
+        active = no_alloc.active();
+        AllocateOnce(8);
+    }
+
+    release.store(true);
+    for (auto& holder : holders) {
+        holder.join();
+    }
+
+    ASSERT_FALSE(active);
+    ASSERT_EQ(g_recorded.count, 0);
+
+    // Slots are free again
+    NoAllocScope no_alloc;
+    ASSERT_TRUE(no_alloc.active());
+    return true;
+}
+
+bool test_handler_allocation_not_reported() {
+    Cleanup cleanup;
+    g_recorded = {};
+    set_alloc_violation_handler(AllocatingHandler, nullptr);
+
+    NoAllocScope no_alloc;
+    AllocateOnce(8);
+
+    ASSERT_EQ(g_recorded.count, 1);
+    ASSERT_EQ(no_alloc.violations(), 1);
+    return true;
+}
+
+bool test_default_handler_aborts_with_stack() {
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    ASSERT_TRUE(pid >= 0);
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDERR_FILENO);
+        close(pipe_fds[0]);
+        NoAllocScope no_alloc;
+        AllocateOnce(77);
+        _exit(0);
+    }
+
+    close(pipe_fds[1]);
+    char output[8192] = {};
+    size_t length = 0;
+    ssize_t got;
+    while ((got = read(pipe_fds[0], output + length, sizeof(output) - 1 - length)) > 0) {
+        length += static_cast<size_t>(got);
+    }
+    close(pipe_fds[0]);
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFSIGNALED(status));
+    ASSERT_EQ(WTERMSIG(status), SIGABRT);
+    ASSERT_TRUE(std::strstr(output, "77 byte allocation inside a NoAllocScope") != nullptr);
+    // Linked with -rdynamic: exported frames of the stack are named
+    ASSERT_TRUE(std::strstr(output, "test_default_handler_aborts_with_stack") != nullptr);
+    return true;
+}
+
+// ============================================================================
+// Data Path Tests
+// ============================================================================
+
+bool test_cold_socket_allocates() {
+    Cleanup cleanup;
+    g_recorded = {};
+    set_alloc_violation_handler(RecordViolation, nullptr);
+
+    auto& manager = ProxySocketManager::GetInstance();
+    auto socket = manager.CreateProxySocket(3, SocketType::Dgram, ProtocolType::Udp);
+    ASSERT_TRUE(socket != nullptr);
+    ASSERT_TRUE(R_SUCCEEDED(socket->Bind(MakeAddr(0, GAME_PORT))));
+
+    // The first datagram allocates the receive ring: the scope must see it
+    uint8_t payload[64] = {};
+    NoAllocScope no_alloc;
+    ASSERT_TRUE(manager.RouteIncomingData(PEER_IP, GAME_PORT, LOCAL_IP, GAME_PORT,
+                                          ProtocolType::Udp, payload, sizeof(payload)));
+    ASSERT_TRUE(no_alloc.violations() > 0);
+    ASSERT_EQ(g_recorded.count, no_alloc.violations());
+    return true;
+}
+
+bool test_udp_receive_steady_state() {
+    Cleanup cleanup;
+    auto& manager = ProxySocketManager::GetInstance();
+    auto socket = manager.CreateProxySocket(3, SocketType::Dgram, ProtocolType::Udp);
+    ASSERT_TRUE(socket != nullptr);
+    ASSERT_TRUE(R_SUCCEEDED(socket->Bind(MakeAddr(0, GAME_PORT))));
+
+    ryu_ldn::ldn::PacketDispatcher dispatcher;
+    dispatcher.set_proxy_data_handler(OnProxyData);
+
+    uint8_t wire[sizeof(g_tx_wire)];
+    const size_t wire_size = EncodeIncoming(wire, sizeof(wire), protocol::ProtocolType::Udp, 512);
+    uint8_t buffer[PROXY_SOCKET_MAX_PAYLOAD];
+    SockAddrIn from;
+
+    for (int i = 0; i < WARMUP_PACKETS; i++) {
+        Dispatch(dispatcher, wire, wire_size);
+        ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, &from), 512);
+    }
+
+    NoAllocScope no_alloc;
+    for (int i = 0; i < STEADY_PACKETS; i++) {
+        Dispatch(dispatcher, wire, wire_size);
+        ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, &from), 512);
+    }
+    ASSERT_EQ(no_alloc.violations(), 0);
+    return true;
+}
+
+bool test_udp_receive_burst_steady_state() {
+    Cleanup cleanup;
+    auto& manager = ProxySocketManager::GetInstance();
+    auto socket = manager.CreateProxySocket(3, SocketType::Dgram, ProtocolType::Udp);
+    ASSERT_TRUE(socket != nullptr);
+    ASSERT_TRUE(R_SUCCEEDED(socket->Bind(MakeAddr(0, GAME_PORT))));
+
+    uint8_t payload[PROXY_SOCKET_MAX_PAYLOAD] = {};
+    uint8_t buffer[PROXY_SOCKET_MAX_PAYLOAD];
+
+    // A full queue (oldest dropped) and variable sizes up to the largest
+    // datagram seen during warm-up
+    for (size_t i = 0; i < PROXY_SOCKET_MAX_QUEUE_SIZE + 8; i++) {
+        manager.RouteIncomingData(PEER_IP, GAME_PORT, LOCAL_IP, GAME_PORT, ProtocolType::Udp,
+                                  payload, PROXY_SOCKET_MAX_PAYLOAD);
+    }
+    while (socket->RecvFrom(buffer, sizeof(buffer), 0x40 /* MSG_DONTWAIT */, nullptr) > 0) {
+    }
+
+    NoAllocScope no_alloc;
+    for (int round = 0; round < 8; round++) {
+        for (size_t i = 0; i < PROXY_SOCKET_MAX_QUEUE_SIZE + 8; i++) {
+            manager.RouteIncomingData(PEER_IP, GAME_PORT, LOCAL_IP, GAME_PORT, ProtocolType::Udp,
+                                      payload, 64 + (i * 37) % (PROXY_SOCKET_MAX_PAYLOAD - 64));
+        }
+        while (socket->RecvFrom(buffer, sizeof(buffer), 0x40, nullptr) > 0) {
+        }
+    }
+    ASSERT_EQ(no_alloc.violations(), 0);
+    return true;
+}
+
+bool test_udp_send_steady_state() {
+    Cleanup cleanup;
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetSendCallback(EncodeProxyData);
+    auto socket = manager.CreateProxySocket(3, SocketType::Dgram, ProtocolType::Udp);
+    ASSERT_TRUE(socket != nullptr);
+    ASSERT_TRUE(R_SUCCEEDED(socket->Bind(MakeAddr(0, GAME_PORT))));
+
+    uint8_t payload[512] = {};
+    const SockAddrIn dest = MakeAddr(PEER_IP, GAME_PORT);
+    for (int i = 0; i < WARMUP_PACKETS; i++) {
+        ASSERT_EQ(socket->SendTo(payload, sizeof(payload), 0, dest), sizeof(payload));
+    }
+
+    NoAllocScope no_alloc;
+    for (int i = 0; i < STEADY_PACKETS; i++) {
+        ASSERT_EQ(socket->SendTo(payload, sizeof(payload), 0, dest), sizeof(payload));
+    }
+    ASSERT_EQ(no_alloc.violations(), 0);
+    return true;
+}
+
+bool test_tcp_stream_steady_state() {
+    Cleanup cleanup;
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetSendCallback(EncodeProxyData);
+    manager.SetProxyConnectCallback(ReplyToConnect);
+
+    auto socket = manager.CreateProxySocket(3, SocketType::Stream, ProtocolType::Tcp);
+    ASSERT_TRUE(socket != nullptr);
+    ASSERT_TRUE(R_SUCCEEDED(socket->Bind(MakeAddr(LOCAL_IP, GAME_PORT))));
+    ASSERT_TRUE(R_SUCCEEDED(socket->Connect(MakeAddr(PEER_IP, GAME_PORT))));
+
+    ryu_ldn::ldn::PacketDispatcher dispatcher;
+    dispatcher.set_proxy_data_handler(OnProxyData);
+
+    uint8_t wire[sizeof(g_tx_wire)];
+    const size_t wire_size = EncodeIncoming(wire, sizeof(wire), protocol::ProtocolType::Tcp, 1024);
+    uint8_t buffer[4096];
+    uint8_t request[256] = {};
+
+    // Warm-up grows the byte ring to the largest backlog of the loop
+    for (int i = 0; i < WARMUP_PACKETS; i++) {
+        Dispatch(dispatcher, wire, wire_size);
+        Dispatch(dispatcher, wire, wire_size);
+        ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), 2048);
+        ASSERT_EQ(socket->Send(request, sizeof(request), 0), sizeof(request));
+    }
+
+    NoAllocScope no_alloc;
+    for (int i = 0; i < STEADY_PACKETS; i++) {
+        Dispatch(dispatcher, wire, wire_size);
+        Dispatch(dispatcher, wire, wire_size);
+        ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), 2048);
+        ASSERT_EQ(socket->Send(request, sizeof(request), 0), sizeof(request));
+    }
+    ASSERT_EQ(no_alloc.violations(), 0);
+    return true;
+}
+
+bool test_proxy_handler_table_steady_state() {
+    Cleanup cleanup;
+    ryu_ldn::ldn::LdnProxyHandler handler;
+    handler.set_data_callback([](const protocol::ProxyInfo&, const uint8_t*, size_t) {});
+
+    protocol::LdnHeader header{};
+    protocol::ProxyConnectRequest connect{};
+    connect.info.source_ipv4 = PEER_IP;
+    connect.info.dest_ipv4 = LOCAL_IP;
+    connect.info.protocol = protocol::ProtocolType::Tcp;
+    protocol::ProxyDisconnectMessage disconnect{};
+    protocol::ProxyDataHeader data_header{};
+    data_header.info = connect.info;
+    data_header.data_length = 64;
+    uint8_t payload[64] = {};
+
+    // Connections come and go while data flows; the table keeps its capacity
+    auto churn = [&](int rounds) {
+        for (int i = 0; i < rounds; i++) {
+            for (uint16_t port = 1; port <= 8; port++) {
+                connect.info.source_port = port;
+                handler.handle_proxy_connect(header, connect);
+            }
+            for (uint16_t port = 1; port <= 8; port++) {
+                data_header.info.source_port = port;
+                handler.handle_proxy_data(header, data_header, payload, sizeof(payload));
+                disconnect.info = connect.info;
+                disconnect.info.source_port = port;
+                handler.handle_proxy_disconnect(header, disconnect);
+            }
+        }
+    };
+
+    churn(1);
+    NoAllocScope no_alloc;
+    churn(STEADY_PACKETS / 8);
+    ASSERT_EQ(no_alloc.violations(), 0);
+    ASSERT_EQ(handler.get_connection_count(), 0);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Alloc Guard Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Tracker Tests:\n");
+    RUN_TEST(test_counts_allocations);
+    RUN_TEST(test_allocation_outside_scope_ignored);
+    RUN_TEST(test_violation_reported);
+    RUN_TEST(test_nested_scopes);
+    RUN_TEST(test_other_thread_not_guarded);
+    RUN_TEST(test_slot_table_full);
+    RUN_TEST(test_handler_allocation_not_reported);
+    RUN_TEST(test_default_handler_aborts_with_stack);
+
+    printf("\nData Path Tests:\n");
+    RUN_TEST(test_cold_socket_allocates);
+    RUN_TEST(test_udp_receive_steady_state);
+    RUN_TEST(test_udp_receive_burst_steady_state);
+    RUN_TEST(test_udp_send_steady_state);
+    RUN_TEST(test_tcp_stream_steady_state);
+    RUN_TEST(test_proxy_handler_table_steady_state);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
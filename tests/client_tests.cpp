@@ -31,6 +31,11 @@
  * ### String Conversion Tests
  * Test result-to-string conversion functions.
  *
+ * ### Link State Tests
+ * Reconnect scheduling with a simulated link state source: no retry while
+ * the link is down, immediate retry when it returns (time-to-recover is
+ * measured against a loopback listener), backoff kept for server failures.
+ *
  * @note These tests run without a server, so they focus on client
  * behavior in disconnected state and configuration handling.
  */
@@ -39,8 +44,14 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include "network/client.hpp"
 #include "network/socket.hpp"
+#include "diagnostics/metrics.hpp"
 
 using namespace ryu_ldn;
 using namespace ryu_ldn::network;
@@ -294,6 +305,193 @@ bool test_connect_no_server() {
     return true;
 }
 
+/**
+ * @brief Test a failed connection is retried once the backoff expires
+ */
+bool test_backoff_expires_and_retries() {
+    socket_init();
+
+    RyuLdnClientConfig config;
+    std::strcpy(config.host, "127.0.0.1");
+    config.port = 19999;
+    config.connect_timeout_ms = 200;
+    config.auto_reconnect = true;
+    RyuLdnClient client(config);
+
+    client.connect();
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+    ASSERT_EQ(client.get_retry_count(), 1u);
+
+    // Backoff starts at the first update and has not expired yet
+    client.update(10000);
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+    ASSERT_EQ(client.get_retry_count(), 1u);
+
+    // Past the longest possible delay: retried, failed, backing off again
+    client.update(10000 + config.reconnect.max_delay_ms);
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+    ASSERT_EQ(client.get_retry_count(), 2u);
+
+    client.disconnect();
+    socket_exit();
+    return true;
+}
+
+// ============================================================================
+// Link State Tests
+// ============================================================================
+
+/**
+ * @brief Simulated link state source
+ */
+static LinkState g_simulated_link = LinkState::Unknown;
+
+static LinkState SimulatedLinkState(void*) {
+    return g_simulated_link;
+}
+
+/**
+ * @brief Loopback TCP listener standing in for the server coming back
+ *
+ * @return Listening fd, -1 on failure
+ */
+static int OpenListener(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 1) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static RyuLdnClientConfig LinkTestConfig(uint16_t port) {
+    RyuLdnClientConfig config;
+    std::strcpy(config.host, "127.0.0.1");
+    config.port = port;
+    config.connect_timeout_ms = 200;
+    config.auto_reconnect = true;
+    config.reconnect.initial_delay_ms = 4000;
+    config.reconnect.max_delay_ms = 32000;
+    config.reconnect.jitter_percent = 0;
+    return config;
+}
+
+/**
+ * @brief No retry is spent while the link is down
+ */
+bool test_link_down_holds_retries() {
+    socket_init();
+    g_simulated_link = LinkState::Down;
+
+    RyuLdnClient client(LinkTestConfig(19997));
+    client.set_link_state_source({SimulatedLinkState, nullptr});
+
+    client.connect();
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+    ASSERT_EQ(client.get_retry_count(), 1u);
+
+    // Far past any backoff: still waiting, nothing attempted
+    client.update(10000);
+    client.update(10000 + 100000);
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+    ASSERT_EQ(client.get_retry_count(), 1u);
+    ASSERT_EQ(client.get_link_state(), LinkState::Down);
+
+    client.disconnect();
+    socket_exit();
+    return true;
+}
+
+/**
+ * @brief The link coming back fires a reconnect without waiting for backoff
+ */
+bool test_link_return_reconnects_immediately() {
+    const uint16_t port = 19996;
+    socket_init();
+    g_simulated_link = LinkState::Up;
+
+    RyuLdnClient client(LinkTestConfig(port));
+    client.set_link_state_source({SimulatedLinkState, nullptr});
+
+    // Three failures with the link up: the next backoff is the 32 s cap
+    client.connect();
+    uint64_t now = 1000;
+    while (client.get_retry_count() < 3) {
+        client.update(now);
+        now += 1000;
+    }
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+    client.update(now);
+    uint64_t backoff_start = now;
+
+    // Wi-Fi drops, then comes back with the server reachable
+    g_simulated_link = LinkState::Down;
+    now += 100;
+    client.update(now);
+    int listener = OpenListener(port);
+    ASSERT_TRUE(listener >= 0);
+
+    uint64_t reconnects_before = diagnostics::g_metrics.server_link_reconnects.Load();
+    g_simulated_link = LinkState::Up;
+    uint64_t link_up = now + 100;
+    now = link_up;
+    while (client.get_state() == ConnectionState::Backoff && now < backoff_start + 32000) {
+        client.update(now);
+        if (client.get_state() == ConnectionState::Backoff) {
+            now += 100;
+        }
+    }
+    ::close(listener);
+
+    uint64_t recover_ms = now - link_up;
+    printf("(recovered %llu ms after link up, backoff left %llu ms) ",
+           static_cast<unsigned long long>(recover_ms),
+           static_cast<unsigned long long>(backoff_start + 32000 - link_up));
+    ASSERT_EQ(recover_ms, 0u);
+    ASSERT_EQ(client.get_state(), ConnectionState::Connected);
+    ASSERT_EQ(diagnostics::g_metrics.server_link_reconnects.Load(), reconnects_before + 1);
+
+    client.disconnect();
+    socket_exit();
+    return true;
+}
+
+/**
+ * @brief Failures with the link up keep the exponential backoff
+ */
+bool test_server_failure_keeps_backoff() {
+    socket_init();
+    g_simulated_link = LinkState::Up;
+
+    RyuLdnClient client(LinkTestConfig(19995));
+    client.set_link_state_source({SimulatedLinkState, nullptr});
+
+    client.connect();
+    client.update(1000);
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+
+    // Link stays up: no early retry (one failure doubles the 4 s initial delay)
+    client.update(1000 + 7999);
+    ASSERT_EQ(client.get_state(), ConnectionState::Backoff);
+    ASSERT_EQ(client.get_retry_count(), 1u);
+
+    client.update(1000 + 8000);
+    ASSERT_EQ(client.get_retry_count(), 2u);
+
+    client.disconnect();
+    socket_exit();
+    return true;
+}
+
 /**
  * @brief Test disconnect when already disconnected
  */
@@ -616,6 +814,7 @@ int main() {
     // Connection Tests
     printf("\nConnection:\n");
     RUN_TEST(test_connect_no_server);
+    RUN_TEST(test_backoff_expires_and_retries);
     RUN_TEST(test_disconnect_when_disconnected);
     RUN_TEST(test_multiple_disconnect_calls);
 
@@ -655,6 +854,12 @@ int main() {
     printf("\nPing/Keepalive:\n");
     RUN_TEST(test_get_last_rtt_initial);
 
+    // Link State Tests
+    printf("\nLink State:\n");
+    RUN_TEST(test_link_down_holds_retries);
+    RUN_TEST(test_link_return_reconnects_immediately);
+    RUN_TEST(test_server_failure_keeps_backoff);
+
     // Summary
     printf("\n========================================\n");
     printf("  Results: %d/%d passed\n",
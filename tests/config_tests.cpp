@@ -190,6 +190,108 @@ TEST(parse_ldn_section) {
     ASSERT_STREQ(config.ldn.passphrase, "secret123");
 }
 
+TEST(parse_redundant_udp_keys) {
+    const char* content =
+        "[ldn]\n"
+        "redundant_udp = 1\n"
+        "redundant_udp_titles = 0100152000022000,01003BC0000A0000\n"
+        "redundant_udp_ports = 11452,30000\n"
+        "redundant_udp_budget = 8192\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.ldn.redundant_udp, false);
+    ASSERT_STREQ(defaults.ldn.redundant_udp_titles, "");
+    ASSERT_STREQ(defaults.ldn.redundant_udp_ports, "");
+    ASSERT_EQ(defaults.ldn.redundant_udp_budget, DEFAULT_REDUNDANT_UDP_BUDGET);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.ldn.redundant_udp, true);
+    ASSERT_STREQ(config.ldn.redundant_udp_titles, "0100152000022000,01003BC0000A0000");
+    ASSERT_STREQ(config.ldn.redundant_udp_ports, "11452,30000");
+    ASSERT_EQ(config.ldn.redundant_udp_budget, 8192u);
+}
+
+TEST(parse_broadcast_dedup_keys) {
+    const char* content =
+        "[ldn]\n"
+        "broadcast_dedup = 1\n"
+        "broadcast_dedup_window = 500\n"
+        "broadcast_dedup_keepalive = 100\n"
+        "broadcast_dedup_exclude = 0100152000022000\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.ldn.broadcast_dedup, false);
+    ASSERT_EQ(defaults.ldn.broadcast_dedup_window_ms, DEFAULT_BROADCAST_DEDUP_WINDOW_MS);
+    ASSERT_EQ(defaults.ldn.broadcast_dedup_keepalive_ms, DEFAULT_BROADCAST_DEDUP_KEEPALIVE_MS);
+    ASSERT_STREQ(defaults.ldn.broadcast_dedup_exclude, "");
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.ldn.broadcast_dedup, true);
+    ASSERT_EQ(config.ldn.broadcast_dedup_window_ms, 500u);
+    ASSERT_EQ(config.ldn.broadcast_dedup_keepalive_ms, 100u);
+    ASSERT_STREQ(config.ldn.broadcast_dedup_exclude, "0100152000022000");
+}
+
+TEST(parse_relay_delegation_keys) {
+    const char* content =
+        "[ldn]\n"
+        "relay_delegation = 1\n"
+        "uplink_kbps = 20000\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.ldn.relay_delegation, false);
+    ASSERT_EQ(defaults.ldn.uplink_kbps, 0u);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.ldn.relay_delegation, true);
+    ASSERT_EQ(config.ldn.uplink_kbps, 20000u);
+}
+
+TEST(parse_rx_moderation_key) {
+    const char* content =
+        "[ldn]\n"
+        "rx_moderation_us = 500\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.ldn.rx_moderation_us, DEFAULT_RX_MODERATION_US);
+    ASSERT_EQ(defaults.ldn.rx_moderation_us, 0u);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.ldn.rx_moderation_us, 500u);
+}
+
+TEST(parse_lan_discovery_key) {
+    const char* content =
+        "[ldn]\n"
+        "lan_discovery = 1\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.ldn.lan_discovery, false);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.ldn.lan_discovery, true);
+}
+
 TEST(parse_debug_section) {
     const char* content =
         "[debug]\n"
@@ -207,6 +309,89 @@ TEST(parse_debug_section) {
     ASSERT_EQ(config.debug.log_to_file, true);
 }
 
+TEST(parse_metrics_keys) {
+    const char* content =
+        "[debug]\n"
+        "metrics = 1\n"
+        "metrics_port = 9200\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.debug.metrics_enabled, false);
+    ASSERT_EQ(defaults.debug.metrics_port, DEFAULT_METRICS_PORT);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.debug.metrics_enabled, true);
+    ASSERT_EQ(config.debug.metrics_port, 9200u);
+}
+
+TEST(parse_log_udp_keys) {
+    const char* content =
+        "[debug]\n"
+        "log_udp_host = 192.168.1.10\n"
+        "log_udp_port = 6000\n";
+
+    Config defaults = get_default_config();
+    ASSERT_STREQ(defaults.debug.log_udp_host, "");
+    ASSERT_EQ(defaults.debug.log_udp_port, DEFAULT_LOG_UDP_PORT);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_STREQ(config.debug.log_udp_host, "192.168.1.10");
+    ASSERT_EQ(config.debug.log_udp_port, 6000u);
+}
+
+TEST(parse_ipc_record_keys) {
+    const char* content =
+        "[debug]\n"
+        "ipc_record = 1\n"
+        "ipc_record_payload = 1\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.debug.ipc_record, false);
+    ASSERT_EQ(defaults.debug.ipc_record_payload, false);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.debug.ipc_record, true);
+    ASSERT_EQ(config.debug.ipc_record_payload, true);
+}
+
+TEST(parse_flight_recorder_keys) {
+    const char* content =
+        "[debug]\n"
+        "flight_recorder = 1\n"
+        "flight_rtt_ms = 400\n"
+        "flight_queue_us = 0\n"
+        "flight_ipc_us = 50000\n"
+        "flight_interval_s = 60\n";
+
+    Config defaults = get_default_config();
+    ASSERT_EQ(defaults.debug.flight_recorder, false);
+    ASSERT_EQ(defaults.debug.flight_rtt_ms, DEFAULT_FLIGHT_RTT_MS);
+    ASSERT_EQ(defaults.debug.flight_interval_s, DEFAULT_FLIGHT_INTERVAL_S);
+
+    TempConfigFile file(content);
+    Config config = get_default_config();
+    ConfigResult result = load_config(file.path(), config);
+
+    ASSERT_EQ(result, ConfigResult::Success);
+    ASSERT_EQ(config.debug.flight_recorder, true);
+    ASSERT_EQ(config.debug.flight_rtt_ms, 400u);
+    ASSERT_EQ(config.debug.flight_queue_us, 0u);
+    ASSERT_EQ(config.debug.flight_ipc_us, 50000u);
+    ASSERT_EQ(config.debug.flight_interval_s, 60u);
+}
+
 TEST(parse_comments_ignored) {
     const char* content =
         "; This is a comment\n"
@@ -0,0 +1,270 @@
+/**
+ * @file datapath_bench.cpp
+ * @brief Host benchmark of the LDN proxy data path
+ *
+ * Drives the production ProxyData path through libryu_core.a, the same
+ * sources the sysmodule builds, on top of the POSIX platform backend:
+ *
+ * - **rx**: encode ProxyData -> decode_header -> PacketDispatcher ->
+ *   ProxySocketManager::RouteIncomingData -> ProxySocket::RecvFrom
+ *   (what ICommunicationService does for every packet from the server)
+ * - **tx**: ProxySocket::SendTo -> manager send callback -> encode ProxyData
+ *   (what a game sendto() on an LDN address costs before hitting the wire)
+ * - **rx-threaded**: a producer thread routes while the main thread blocks
+ *   in RecvFrom, exercising the queue mutex and receive event handoff
+ *
+ * Each scenario also reports heap allocations per packet, counted by the
+ * operator new hook of diagnostics/alloc_guard.cpp. The first lap sizes the
+ * queues, so anything above 0.00 at a large packet count is a per-packet
+ * allocation (run_alloc_guard_tests shows where it comes from).
+ *
+ * ## Usage
+ *
+ * ```
+ * make bench                                   # build and run
+ * ./run_datapath_bench 1000000 1024            # packets, payload bytes
+ * perf record -g ./run_datapath_bench          # profile
+ * valgrind --tool=callgrind ./run_datapath_bench 20000
+ * ```
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "bsd/proxy_socket_manager.hpp"
+#include "diagnostics/alloc_guard.hpp"
+#include "ldn/ldn_packet_dispatcher.hpp"
+#include "protocol/ryu_protocol.hpp"
+
+using namespace ams::mitm::bsd;
+using ryu_ldn::bsd::SockAddrIn;
+using ryu_ldn::bsd::SocketType;
+using ryu_ldn::bsd::ProtocolType;
+namespace platform = ryu_ldn::platform;
+namespace protocol = ryu_ldn::protocol;
+
+namespace {
+
+constexpr uint32_t LOCAL_IP = 0x0A720001;  // 10.114.0.1
+constexpr uint32_t PEER_IP  = 0x0A720002;  // 10.114.0.2
+constexpr uint16_t GAME_PORT = 12345;
+constexpr s32 FD = 3;
+constexpr size_t WIRE_BUFFER_SIZE = sizeof(protocol::LdnHeader) +
+                                    sizeof(protocol::ProxyDataHeader) +
+                                    PROXY_SOCKET_MAX_PAYLOAD;
+
+uint8_t g_tx_wire[WIRE_BUFFER_SIZE];
+size_t g_tx_wire_size = 0;
+
+// Same mapping as ICommunicationService::HandleServerPacket
+void OnProxyData(const protocol::LdnHeader&, const protocol::ProxyDataHeader& proxy_header,
+                 const uint8_t* data, size_t) {
+    ProtocolType proto = proxy_header.info.protocol == protocol::ProtocolType::Tcp
+                             ? ProtocolType::Tcp : ProtocolType::Udp;
+    ProxySocketManager::GetInstance().RouteIncomingData(
+        proxy_header.info.source_ipv4, proxy_header.info.source_port,
+        proxy_header.info.dest_ipv4, proxy_header.info.dest_port,
+        proto, data, proxy_header.data_length);
+}
+
+// Same framing as SendProxyDataCallback, minus the socket write
+bool EncodeProxyData(uint32_t source_ip, uint16_t source_port,
+                     uint32_t dest_ip, uint16_t dest_port,
+                     ProtocolType proto, const void* data, size_t data_len) {
+    protocol::ProxyInfo info{};
+    info.source_ipv4 = source_ip;
+    info.source_port = source_port;
+    info.dest_ipv4 = dest_ip;
+    info.dest_port = dest_port;
+    info.protocol = proto == ProtocolType::Tcp ? protocol::ProtocolType::Tcp
+                                               : protocol::ProtocolType::Udp;
+    return protocol::encode_proxy_data(g_tx_wire, sizeof(g_tx_wire), info,
+                                       static_cast<const uint8_t*>(data), data_len,
+                                       g_tx_wire_size) == protocol::EncodeResult::Success;
+}
+
+size_t EncodeIncoming(uint8_t* wire, size_t payload_size) {
+    static uint8_t payload[PROXY_SOCKET_MAX_PAYLOAD];
+    std::memset(payload, 0xA5, payload_size);
+
+    protocol::ProxyInfo info{};
+    info.source_ipv4 = PEER_IP;
+    info.source_port = GAME_PORT;
+    info.dest_ipv4 = LOCAL_IP;
+    info.dest_port = GAME_PORT;
+    info.protocol = protocol::ProtocolType::Udp;
+
+    size_t size = 0;
+    protocol::encode_proxy_data(wire, WIRE_BUFFER_SIZE, info, payload, payload_size, size);
+    return size;
+}
+
+ProxySocket* CreateGameSocket() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.CloseAllProxySockets();
+
+    auto socket = manager.CreateProxySocket(FD, SocketType::Dgram, ProtocolType::Udp);
+    SockAddrIn addr{};
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    addr.sin_port = __builtin_bswap16(GAME_PORT);
+    socket->Bind(addr);
+    return socket.get();
+}
+
+/**
+ * @brief Elapsed time and allocations of one scenario run
+ */
+struct RunResult {
+    uint64_t elapsed_ns;
+    uint64_t allocations;
+};
+
+template <typename Scenario>
+RunResult Run(Scenario scenario, uint64_t packets, size_t payload_size) {
+    const uint64_t allocations = ryu_ldn::diagnostics::alloc_guard_count();
+    const uint64_t elapsed_ns = scenario(packets, payload_size);
+    return RunResult{elapsed_ns, ryu_ldn::diagnostics::alloc_guard_count() - allocations};
+}
+
+void Report(const char* name, uint64_t packets, size_t payload_size, const RunResult& result) {
+    double ns_per_packet = static_cast<double>(result.elapsed_ns) / static_cast<double>(packets);
+    double mpps = 1000.0 / ns_per_packet;
+    double mbps = mpps * static_cast<double>(payload_size) * 8.0;
+    double allocs = static_cast<double>(result.allocations) / static_cast<double>(packets);
+    printf("  %-12s %10.1f ns/pkt %8.3f Mpps %10.1f Mbit/s %8.2f alloc/pkt\n",
+           name, ns_per_packet, mpps, mbps, allocs);
+}
+
+// =============================================================================
+// Scenarios
+// =============================================================================
+
+uint64_t BenchRx(uint64_t packets, size_t payload_size) {
+    static uint8_t wire[WIRE_BUFFER_SIZE];
+    static uint8_t buffer[PROXY_SOCKET_MAX_PAYLOAD];
+    size_t wire_size = EncodeIncoming(wire, payload_size);
+
+    ryu_ldn::ldn::PacketDispatcher dispatcher;
+    dispatcher.set_proxy_data_handler(OnProxyData);
+    ProxySocket* socket = CreateGameSocket();
+
+    uint64_t start = platform::GetTickNs();
+    for (uint64_t i = 0; i < packets; i++) {
+        protocol::LdnHeader header;
+        if (protocol::decode_header(wire, wire_size, header) != protocol::DecodeResult::Success) {
+            abort();
+        }
+        dispatcher.dispatch(header, wire + sizeof(protocol::LdnHeader),
+                            static_cast<size_t>(header.data_size));
+
+        SockAddrIn from;
+        if (socket->RecvFrom(buffer, sizeof(buffer), 0, &from) != static_cast<s32>(payload_size)) {
+            abort();
+        }
+    }
+    return platform::GetTickNs() - start;
+}
+
+uint64_t BenchTx(uint64_t packets, size_t payload_size) {
+    static uint8_t payload[PROXY_SOCKET_MAX_PAYLOAD];
+    ProxySocket* socket = CreateGameSocket();
+    ProxySocketManager::GetInstance().SetSendCallback(EncodeProxyData);
+
+    SockAddrIn dest{};
+    dest.sin_len = sizeof(dest);
+    dest.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    dest.sin_port = __builtin_bswap16(GAME_PORT);
+    dest.sin_addr = __builtin_bswap32(PEER_IP);
+
+    uint64_t start = platform::GetTickNs();
+    for (uint64_t i = 0; i < packets; i++) {
+        if (socket->SendTo(payload, payload_size, 0, dest) != static_cast<s32>(payload_size)) {
+            abort();
+        }
+    }
+    uint64_t elapsed = platform::GetTickNs() - start;
+
+    ProxySocketManager::GetInstance().SetSendCallback(nullptr);
+    return elapsed;
+}
+
+struct ProducerArgs {
+    uint64_t packets;
+    size_t payload_size;
+    size_t wire_size;
+    const uint8_t* wire;
+    ProxySocket* socket;
+};
+
+void ProducerThread(void* arg) {
+    auto* args = static_cast<ProducerArgs*>(arg);
+    ryu_ldn::ldn::PacketDispatcher dispatcher;
+    dispatcher.set_proxy_data_handler(OnProxyData);
+
+    for (uint64_t i = 0; i < args->packets; i++) {
+        // Stay below the queue limit so nothing is dropped
+        while (args->socket->GetPendingDataSize() >=
+               (PROXY_SOCKET_MAX_QUEUE_SIZE / 2) * args->payload_size) {
+            platform::SleepNs(0);
+        }
+
+        protocol::LdnHeader header;
+        protocol::decode_header(args->wire, args->wire_size, header);
+        dispatcher.dispatch(header, args->wire + sizeof(protocol::LdnHeader),
+                            static_cast<size_t>(header.data_size));
+    }
+}
+
+uint64_t BenchRxThreaded(uint64_t packets, size_t payload_size) {
+    static uint8_t wire[WIRE_BUFFER_SIZE];
+    static uint8_t buffer[PROXY_SOCKET_MAX_PAYLOAD];
+    ProducerArgs args{packets, payload_size, EncodeIncoming(wire, payload_size), wire, CreateGameSocket()};
+
+    platform::Thread producer;
+    uint64_t start = platform::GetTickNs();
+    if (!producer.Start(ProducerThread, &args, nullptr, 0,
+                        platform::HighestThreadPriority, "bench_producer")) {
+        abort();
+    }
+
+    for (uint64_t i = 0; i < packets; i++) {
+        if (args.socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr) !=
+            static_cast<s32>(payload_size)) {
+            abort();
+        }
+    }
+    uint64_t elapsed = platform::GetTickNs() - start;
+
+    producer.Join();
+    return elapsed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t payload_size = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 512;
+    if (packets == 0 || payload_size == 0 || payload_size > PROXY_SOCKET_MAX_PAYLOAD) {
+        fprintf(stderr, "usage: %s [packets] [payload 1-%zu]\n", argv[0], PROXY_SOCKET_MAX_PAYLOAD);
+        return 1;
+    }
+
+    printf("\n========================================\n");
+    printf("  Data Path Benchmark - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+    printf("  %llu packets, %zu byte payload\n\n",
+           static_cast<unsigned long long>(packets), payload_size);
+
+    Report("rx", packets, payload_size, Run(BenchRx, packets, payload_size));
+    Report("tx", packets, payload_size, Run(BenchTx, packets, payload_size));
+    Report("rx-threaded", packets, payload_size, Run(BenchRxThreaded, packets, payload_size));
+
+    ProxySocketManager::GetInstance().CloseAllProxySockets();
+    printf("\n");
+    return 0;
+}
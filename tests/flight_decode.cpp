@@ -0,0 +1,275 @@
+/**
+ * @file flight_decode.cpp
+ * @brief Host decoder of flight recorder dumps
+ *
+ * Reads a flight_N.bin written by FlightRecorder (see
+ * diagnostics/flight_recorder.hpp) when a latency threshold was crossed,
+ * and prints the window as a timeline relative to the trigger, followed by
+ * a summary: events per type, proxy traffic, and the worst RTT, queueing
+ * delay and IPC call before the trigger.
+ *
+ * ```
+ *   -412.337 ms  ProxyRx      port 12345   1024 B  queued  3072 B
+ *   -411.902 ms  IpcCall      bsd RecvFrom       6 us (blocking)
+ *     -0.015 ms  Rtt          412 ms
+ *      0.000 ms  Trigger      Rtt 412 >= 250
+ * ```
+ *
+ * ## Usage
+ *
+ * ```
+ * make run_flight_decode
+ * ./run_flight_decode flight_0.bin               # whole window
+ * ./run_flight_decode flight_0.bin --last 200    # last 200 ms before the trigger
+ * ./run_flight_decode flight_0.bin --summary     # summary only
+ * ```
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "diagnostics/flight_recorder.hpp"
+#include "diagnostics/ipc_recorder.hpp"
+#include "network/connection_state.hpp"
+
+using namespace ryu_ldn::diagnostics;
+using ryu_ldn::network::ConnectionEvent;
+using ryu_ldn::network::ConnectionState;
+using ryu_ldn::network::ConnectionStateMachine;
+
+namespace {
+
+struct Options {
+    const char* path = nullptr;
+    long last_ms = -1;      ///< -1 = whole window
+    bool summary_only = false;
+};
+
+struct Summary {
+    uint32_t counts[16] = {};
+    uint64_t rx_bytes = 0;
+    uint64_t tx_bytes = 0;
+    uint32_t tx_failed = 0;
+    uint32_t max_rtt_ms = 0;
+    uint32_t max_queue_us = 0;
+    uint32_t max_ipc_us = 0;
+    uint16_t max_ipc_command = 0;
+    uint8_t max_ipc_service = 0;
+    int64_t first_us = 0;   ///< Oldest event shown (relative, <= 0)
+};
+
+std::vector<uint8_t> ReadFile(const char* path) {
+    std::vector<uint8_t> data;
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return data;
+    }
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    return data;
+}
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--last") == 0 && i + 1 < argc) {
+            options.last_ms = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--summary") == 0) {
+            options.summary_only = true;
+        } else if (argv[i][0] == '-' || options.path != nullptr) {
+            return false;
+        } else {
+            options.path = argv[i];
+        }
+    }
+    return options.path != nullptr;
+}
+
+const char* IpcName(uint8_t service, uint16_t command) {
+    if (service == static_cast<uint8_t>(IpcService::Ldn)) {
+        switch (command) {
+            case ldn_cmd::GetState:                   return "ldn GetState";
+            case ldn_cmd::GetNetworkInfo:             return "ldn GetNetworkInfo";
+            case ldn_cmd::GetIpv4Address:             return "ldn GetIpv4Address";
+            case ldn_cmd::GetNetworkInfoLatestUpdate: return "ldn GetNetworkInfoLatest";
+            case ldn_cmd::Scan:                       return "ldn Scan";
+            case ldn_cmd::CreateNetwork:              return "ldn CreateNetwork";
+            case ldn_cmd::CreateNetworkPrivate:       return "ldn CreateNetworkPrivate";
+            case ldn_cmd::DestroyNetwork:             return "ldn DestroyNetwork";
+            case ldn_cmd::SetAdvertiseData:           return "ldn SetAdvertiseData";
+            case ldn_cmd::Connect:                    return "ldn Connect";
+            case ldn_cmd::ConnectPrivate:             return "ldn ConnectPrivate";
+            case ldn_cmd::Disconnect:                 return "ldn Disconnect";
+            default:                                  return "ldn ?";
+        }
+    }
+    switch (command) {
+        case bsd_cmd::Socket:   return "bsd Socket";
+        case bsd_cmd::Select:   return "bsd Select";
+        case bsd_cmd::Poll:     return "bsd Poll";
+        case bsd_cmd::Recv:     return "bsd Recv";
+        case bsd_cmd::RecvFrom: return "bsd RecvFrom";
+        case bsd_cmd::Send:     return "bsd Send";
+        case bsd_cmd::SendTo:   return "bsd SendTo";
+        case bsd_cmd::Bind:     return "bsd Bind";
+        case bsd_cmd::Connect:  return "bsd Connect";
+        case bsd_cmd::Listen:   return "bsd Listen";
+        case bsd_cmd::Close:    return "bsd Close";
+        default:                return "bsd ?";
+    }
+}
+
+/**
+ * @brief CommState names (ldn_types.hpp numbering)
+ */
+const char* CommStateName(uint32_t state) {
+    static const char* const names[] = {
+        "None", "Initialized", "AccessPoint", "AccessPointCreated",
+        "Station", "StationConnected", "Error",
+    };
+    return state < sizeof(names) / sizeof(names[0]) ? names[state] : "?";
+}
+
+void PrintEvent(const FlightEvent& event, int64_t relative_us) {
+    std::printf("%11.3f ms  %-12s ", static_cast<double>(relative_us) / 1000.0,
+                flight_event_to_string(static_cast<FlightEventType>(event.type)));
+
+    switch (static_cast<FlightEventType>(event.type)) {
+        case FlightEventType::ProxyRx:
+            std::printf("port %-5u %6u B  queued %6u B\n", event.a, event.b, event.c);
+            break;
+        case FlightEventType::ProxyTx:
+            std::printf("port %-5u %6u B%s\n", event.a, event.b, event.sub != 0 ? "" : "  FAILED");
+            break;
+        case FlightEventType::QueueDelay:
+            std::printf("port %-5u waited %u us  queued %u B\n", event.a, event.b, event.c);
+            break;
+        case FlightEventType::IpcCall:
+            std::printf("%-24s %8u us%s\n", IpcName(event.sub, event.a), event.b,
+                        event.c != 0 ? " (blocking)" : "");
+            break;
+        case FlightEventType::Rtt:
+            std::printf("%u ms\n", event.b);
+            break;
+        case FlightEventType::StateChange:
+            if (event.sub == static_cast<uint8_t>(FlightStateMachine::Server)) {
+                std::printf("server %s -> %s (%s)\n",
+                            ConnectionStateMachine::state_to_string(static_cast<ConnectionState>(event.b)),
+                            ConnectionStateMachine::state_to_string(static_cast<ConnectionState>(event.c)),
+                            ConnectionStateMachine::event_to_string(static_cast<ConnectionEvent>(event.a)));
+            } else {
+                std::printf("ldn %s -> %s\n", CommStateName(event.b), CommStateName(event.c));
+            }
+            break;
+        case FlightEventType::Reconnect:
+            std::printf("retry %u\n", event.b);
+            break;
+        case FlightEventType::Trigger:
+            std::printf("%s %u >= %u\n",
+                        flight_trigger_to_string(static_cast<FlightTrigger>(event.sub)), event.b, event.c);
+            break;
+        default:
+            std::printf("sub=%u a=%u b=%u c=%u\n", event.sub, event.a, event.b, event.c);
+            break;
+    }
+}
+
+void Accumulate(Summary& summary, const FlightEvent& event, int64_t relative_us) {
+    if (event.type < 16) {
+        summary.counts[event.type]++;
+    }
+    if (relative_us < summary.first_us) {
+        summary.first_us = relative_us;
+    }
+
+    switch (static_cast<FlightEventType>(event.type)) {
+        case FlightEventType::ProxyRx:
+            summary.rx_bytes += event.b;
+            break;
+        case FlightEventType::ProxyTx:
+            summary.tx_bytes += event.b;
+            summary.tx_failed += event.sub == 0 ? 1 : 0;
+            break;
+        case FlightEventType::QueueDelay:
+            summary.max_queue_us = event.b > summary.max_queue_us ? event.b : summary.max_queue_us;
+            break;
+        case FlightEventType::IpcCall:
+            if (event.c == 0 && event.b > summary.max_ipc_us) {
+                summary.max_ipc_us = event.b;
+                summary.max_ipc_command = event.a;
+                summary.max_ipc_service = event.sub;
+            }
+            break;
+        case FlightEventType::Rtt:
+            summary.max_rtt_ms = event.b > summary.max_rtt_ms ? event.b : summary.max_rtt_ms;
+            break;
+        default:
+            break;
+    }
+}
+
+void PrintSummary(const Summary& summary) {
+    std::printf("\nSummary (%.3f ms before the trigger):\n", static_cast<double>(-summary.first_us) / 1000.0);
+    for (uint8_t type = 1; type < 16; type++) {
+        if (summary.counts[type] != 0) {
+            std::printf("  %-12s %u\n", flight_event_to_string(static_cast<FlightEventType>(type)),
+                        summary.counts[type]);
+        }
+    }
+    std::printf("  rx %llu B, tx %llu B (%u failed)\n",
+                static_cast<unsigned long long>(summary.rx_bytes),
+                static_cast<unsigned long long>(summary.tx_bytes), summary.tx_failed);
+    std::printf("  worst RTT %u ms, queueing delay %u us", summary.max_rtt_ms, summary.max_queue_us);
+    if (summary.max_ipc_us != 0) {
+        std::printf(", IPC %u us (%s)", summary.max_ipc_us,
+                    IpcName(summary.max_ipc_service, summary.max_ipc_command));
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s <flight_N.bin> [--last MS] [--summary]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> dump = ReadFile(options.path);
+    FlightDumpReader reader(dump.data(), dump.size());
+    if (!reader.valid()) {
+        std::fprintf(stderr, "%s: not a flight recorder dump (or truncated)\n", options.path);
+        return 2;
+    }
+
+    const FlightDumpHeader& header = reader.header();
+    std::printf("Flight dump: %s, %s %u >= %u at uptime %.3f s, %u events, %u spike(s) suppressed before it\n\n",
+                options.path, flight_trigger_to_string(static_cast<FlightTrigger>(header.reason)),
+                header.value, header.threshold, static_cast<double>(header.trigger_time_us) / 1e6,
+                header.event_count, header.suppressed);
+
+    Summary summary;
+    FlightEvent event;
+    while (reader.next(event)) {
+        int64_t relative_us = reader.relative_us(event);
+        if (options.last_ms >= 0 && relative_us < -options.last_ms * 1000) {
+            continue;
+        }
+        Accumulate(summary, event, relative_us);
+        if (!options.summary_only) {
+            PrintEvent(event, relative_us);
+        }
+    }
+
+    PrintSummary(summary);
+    return 0;
+}
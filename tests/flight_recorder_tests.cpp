@@ -0,0 +1,547 @@
+/**
+ * @file flight_recorder_tests.cpp
+ * @brief Unit tests for the latency-spike flight recorder
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Ring Tests
+ * Disabled recorder, event fields, wrap-around.
+ *
+ * ### Trigger Tests
+ * Thresholds, disabled triggers, blocking calls, freeze, rate limit.
+ *
+ * ### Dump Tests
+ * File round trip, reader validation, relative times.
+ *
+ * ### Source Tests
+ * Datagram queue timestamps, connection state machine events.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "diagnostics/flight_recorder.hpp"
+#include "bsd/proxy_socket_queue.hpp"
+#include "network/connection_state.hpp"
+
+using namespace ryu_ldn::diagnostics;
+namespace platform = ryu_ldn::platform;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+constexpr const char* DUMP_PATH = "/tmp/ryu_flight_test.bin";
+
+FlightThresholds Thresholds(uint32_t rtt_ms, uint32_t queue_us, uint32_t ipc_us, uint32_t interval_s) {
+    FlightThresholds thresholds{};
+    thresholds.rtt_ms = rtt_ms;
+    thresholds.queue_delay_us = queue_us;
+    thresholds.ipc_latency_us = ipc_us;
+    thresholds.min_interval_s = interval_s;
+    return thresholds;
+}
+
+/**
+ * @brief Serialize the frozen ring into events (empty if nothing is pending)
+ */
+std::vector<FlightEvent> Frozen(const FlightRecorder& recorder, FlightDumpHeader* header = nullptr) {
+    std::vector<uint8_t> buffer(sizeof(FlightDumpHeader) + FLIGHT_RECORDER_CAPACITY * sizeof(FlightEvent));
+    size_t size = recorder.serialize(buffer.data(), buffer.size());
+
+    std::vector<FlightEvent> events;
+    FlightDumpReader reader(buffer.data(), size);
+    if (header != nullptr) {
+        *header = reader.header();
+    }
+    FlightEvent event;
+    while (reader.next(event)) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+std::vector<uint8_t> ReadFile(const char* path) {
+    std::vector<uint8_t> data;
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return data;
+    }
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    return data;
+}
+
+} // namespace
+
+// ============================================================================
+// Ring Tests
+// ============================================================================
+
+bool test_disabled_records_nothing() {
+    FlightRecorder recorder;
+    recorder.proxy_rx(1234, 100, 0);
+    recorder.rtt(10000);
+    ASSERT_EQ(recorder.size(), 0);
+    ASSERT_FALSE(recorder.has_pending());
+
+    recorder.start(Thresholds(100, 0, 0, 0));
+    recorder.stop();
+    recorder.rtt(10000);
+    ASSERT_EQ(recorder.size(), 0);
+    ASSERT_FALSE(recorder.has_pending());
+    return true;
+}
+
+bool test_event_fields() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(100, 0, 0, 0));
+
+    recorder.proxy_rx(1234, 512, 2048);
+    recorder.proxy_tx(4321, 64, false);
+    recorder.ipc_call(1, 204, 1500000, false);
+    recorder.state_change(FlightStateMachine::Server, 1, 2, 3);
+    recorder.reconnect(4);
+    recorder.rtt(150);
+    ASSERT_TRUE(recorder.has_pending());
+
+    std::vector<FlightEvent> events = Frozen(recorder);
+    ASSERT_EQ(events.size(), 7);
+
+    ASSERT_EQ(events[0].type, FlightEventType::ProxyRx);
+    ASSERT_EQ(events[0].a, 1234);
+    ASSERT_EQ(events[0].b, 512);
+    ASSERT_EQ(events[0].c, 2048);
+
+    ASSERT_EQ(events[1].type, FlightEventType::ProxyTx);
+    ASSERT_EQ(events[1].sub, 0);
+    ASSERT_EQ(events[1].a, 4321);
+
+    ASSERT_EQ(events[2].type, FlightEventType::IpcCall);
+    ASSERT_EQ(events[2].sub, 1);
+    ASSERT_EQ(events[2].a, 204);
+    ASSERT_EQ(events[2].b, 1500);
+
+    ASSERT_EQ(events[3].type, FlightEventType::StateChange);
+    ASSERT_EQ(events[3].sub, FlightStateMachine::Server);
+    ASSERT_EQ(events[3].a, 3);
+    ASSERT_EQ(events[3].b, 1);
+    ASSERT_EQ(events[3].c, 2);
+
+    ASSERT_EQ(events[4].type, FlightEventType::Reconnect);
+    ASSERT_EQ(events[4].b, 4);
+
+    ASSERT_EQ(events[5].type, FlightEventType::Rtt);
+    ASSERT_EQ(events[5].b, 150);
+
+    ASSERT_EQ(events[6].type, FlightEventType::Trigger);
+    ASSERT_EQ(events[6].sub, FlightTrigger::Rtt);
+    ASSERT_EQ(events[6].b, 150);
+    ASSERT_EQ(events[6].c, 100);
+    return true;
+}
+
+bool test_ring_wraps() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(100, 0, 0, 0));
+
+    const size_t total = FLIGHT_RECORDER_CAPACITY + 100;
+    for (size_t i = 0; i < total; i++) {
+        recorder.proxy_rx(static_cast<uint16_t>(i), i, 0);
+    }
+    ASSERT_EQ(recorder.size(), FLIGHT_RECORDER_CAPACITY);
+    recorder.rtt(100);
+
+    // Oldest first, the trigger is the newest event
+    std::vector<FlightEvent> events = Frozen(recorder);
+    ASSERT_EQ(events.size(), FLIGHT_RECORDER_CAPACITY);
+    ASSERT_EQ(events[0].b, 102);
+    ASSERT_EQ(events[FLIGHT_RECORDER_CAPACITY - 3].b, total - 1);
+    ASSERT_EQ(events[FLIGHT_RECORDER_CAPACITY - 1].type, FlightEventType::Trigger);
+    return true;
+}
+
+// ============================================================================
+// Trigger Tests
+// ============================================================================
+
+bool test_thresholds() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(200, 5000, 10000, 0));
+
+    recorder.rtt(199);
+    recorder.queue_delay(1234, 4999000, 0);
+    recorder.ipc_call(0, 11, 9999000, false);
+    ASSERT_FALSE(recorder.has_pending());
+
+    recorder.queue_delay(1234, 5000000, 300);
+    ASSERT_TRUE(recorder.has_pending());
+
+    FlightDumpHeader header;
+    std::vector<FlightEvent> events = Frozen(recorder, &header);
+    ASSERT_EQ(header.reason, FlightTrigger::QueueDelay);
+    ASSERT_EQ(header.value, 5000);
+    ASSERT_EQ(header.threshold, 5000);
+    ASSERT_EQ(events.back().type, FlightEventType::Trigger);
+    ASSERT_EQ(events[events.size() - 2].type, FlightEventType::QueueDelay);
+    ASSERT_EQ(events[events.size() - 2].c, 300);
+    return true;
+}
+
+bool test_zero_threshold_disabled() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(0, 0, 0, 0));
+
+    recorder.rtt(UINT32_MAX);
+    recorder.queue_delay(1, UINT64_MAX, 0);
+    recorder.ipc_call(0, 0, UINT64_MAX, false);
+    ASSERT_FALSE(recorder.has_pending());
+    ASSERT_FALSE(recorder.check(FlightTrigger::None, UINT32_MAX));
+    ASSERT_FALSE(recorder.check(FlightTrigger::Count, UINT32_MAX));
+    ASSERT_EQ(recorder.size(), 3);
+    return true;
+}
+
+bool test_blocking_calls_never_trigger() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(0, 0, 1000, 0));
+
+    // A Recv that waited a second for data is not a slow handler
+    recorder.ipc_call(0, 9, 1000000000ULL, true);
+    ASSERT_FALSE(recorder.has_pending());
+
+    {
+        ScopedFlightIpc ipc(0, 11, false, recorder);
+        platform::SleepMs(5);
+    }
+    ASSERT_TRUE(recorder.has_pending());
+
+    std::vector<FlightEvent> events = Frozen(recorder);
+    ASSERT_EQ(events.size(), 3);
+    ASSERT_EQ(events[0].c, 1);
+    ASSERT_EQ(events[1].a, 11);
+    ASSERT_TRUE(events[1].b >= 5000);
+    return true;
+}
+
+bool test_frozen_drops_events() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(100, 0, 0, 0));
+
+    recorder.proxy_rx(1, 1, 0);
+    ASSERT_TRUE(recorder.check(FlightTrigger::Rtt, 500));
+    ASSERT_FALSE(recorder.check(FlightTrigger::Rtt, 900));
+    recorder.proxy_rx(2, 2, 0);
+
+    FlightDumpHeader header;
+    std::vector<FlightEvent> events = Frozen(recorder, &header);
+    ASSERT_EQ(events.size(), 2);
+    ASSERT_EQ(header.value, 500);
+
+    // Resumes with a fresh window
+    recorder.discard_pending();
+    ASSERT_FALSE(recorder.has_pending());
+    recorder.proxy_rx(3, 3, 0);
+    ASSERT_EQ(recorder.size(), 1);
+    return true;
+}
+
+bool test_rate_limit() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(100, 0, 0, 3600));
+
+    recorder.rtt(150);
+    ASSERT_TRUE(recorder.write_pending(DUMP_PATH));
+    ASSERT_EQ(recorder.dumps(), 1);
+
+    // Inside the interval: counted, not frozen
+    recorder.rtt(300);
+    recorder.rtt(400);
+    ASSERT_FALSE(recorder.has_pending());
+    ASSERT_FALSE(recorder.write_pending(DUMP_PATH));
+    ASSERT_EQ(recorder.dumps(), 1);
+
+    // No interval: every spike after a dump freezes again
+    FlightRecorder eager;
+    eager.start(Thresholds(100, 0, 0, 0));
+    eager.rtt(150);
+    ASSERT_TRUE(eager.write_pending(DUMP_PATH));
+    eager.rtt(150);
+    ASSERT_TRUE(eager.has_pending());
+    std::remove(DUMP_PATH);
+    return true;
+}
+
+// ============================================================================
+// Dump Tests
+// ============================================================================
+
+bool test_dump_round_trip() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(100, 0, 0, 0));
+
+    recorder.proxy_rx(1234, 512, 0);
+    platform::SleepMs(20);
+    recorder.rtt(250);
+    ASSERT_TRUE(recorder.write_pending(DUMP_PATH));
+    ASSERT_FALSE(recorder.has_pending());
+
+    std::vector<uint8_t> data = ReadFile(DUMP_PATH);
+    std::remove(DUMP_PATH);
+    ASSERT_EQ(data.size(), sizeof(FlightDumpHeader) + 3 * sizeof(FlightEvent));
+
+    FlightDumpReader reader(data.data(), data.size());
+    ASSERT_TRUE(reader.valid());
+    ASSERT_EQ(reader.header().magic, FLIGHT_DUMP_MAGIC);
+    ASSERT_EQ(reader.header().reason, FlightTrigger::Rtt);
+    ASSERT_EQ(reader.header().event_count, 3);
+
+    FlightEvent event;
+    ASSERT_TRUE(reader.next(event));
+    ASSERT_EQ(event.type, FlightEventType::ProxyRx);
+    int64_t rx_us = reader.relative_us(event);
+    ASSERT_TRUE(rx_us <= -20000);
+    ASSERT_TRUE(rx_us > -2000000);
+    ASSERT_TRUE(reader.next(event));
+    ASSERT_TRUE(reader.next(event));
+    ASSERT_EQ(event.type, FlightEventType::Trigger);
+    ASSERT_EQ(reader.relative_us(event), 0);
+    ASSERT_FALSE(reader.next(event));
+    return true;
+}
+
+bool test_suppressed_reported() {
+    FlightRecorder recorder;
+    recorder.start(Thresholds(100, 0, 0, 0));
+
+    // Frozen: a second spike before the dump is part of the same window
+    recorder.rtt(150);
+    recorder.rtt(900);
+    FlightDumpHeader header;
+    Frozen(recorder, &header);
+    ASSERT_EQ(header.value, 150);
+    ASSERT_EQ(header.suppressed, 0);
+
+    // Spikes inside the interval show up in the next dump
+    FlightRecorder limited;
+    limited.start(Thresholds(100, 0, 0, 1));
+    limited.rtt(150);
+    limited.discard_pending();
+    limited.rtt(200);
+    limited.rtt(300);
+    ASSERT_FALSE(limited.has_pending());
+
+    platform::SleepMs(1050);
+    limited.rtt(400);
+    ASSERT_TRUE(limited.has_pending());
+    Frozen(limited, &header);
+    ASSERT_EQ(header.value, 400);
+    ASSERT_EQ(header.suppressed, 2);
+    return true;
+}
+
+bool test_reader_rejects_bad_dumps() {
+    FlightDumpReader empty(nullptr, 0);
+    ASSERT_FALSE(empty.valid());
+
+    FlightDumpHeader header{};
+    header.magic = FLIGHT_DUMP_MAGIC;
+    header.version = FLIGHT_DUMP_VERSION;
+    header.event_size = sizeof(FlightEvent);
+    header.event_count = 2;
+
+    // Truncated: header promises 2 events, 1 present
+    std::vector<uint8_t> data(sizeof(header) + sizeof(FlightEvent));
+    std::memcpy(data.data(), &header, sizeof(header));
+    FlightDumpReader truncated(data.data(), data.size());
+    ASSERT_FALSE(truncated.valid());
+
+    header.event_count = 1;
+    header.magic = 0x12345678;
+    std::memcpy(data.data(), &header, sizeof(header));
+    FlightDumpReader wrong_magic(data.data(), data.size());
+    ASSERT_FALSE(wrong_magic.valid());
+
+    header.magic = FLIGHT_DUMP_MAGIC;
+    std::memcpy(data.data(), &header, sizeof(header));
+    FlightDumpReader ok(data.data(), data.size());
+    ASSERT_TRUE(ok.valid());
+
+    FlightEvent event;
+    ASSERT_FALSE(wrong_magic.next(event));
+    return true;
+}
+
+bool test_relative_time_wraps() {
+    FlightDumpHeader header{};
+    header.magic = FLIGHT_DUMP_MAGIC;
+    header.version = FLIGHT_DUMP_VERSION;
+    header.event_size = sizeof(FlightEvent);
+    header.trigger_time_us = 0x100000010ULL;  // low 32 bits wrapped to 0x10
+
+    FlightDumpReader reader(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    ASSERT_TRUE(reader.valid());
+
+    FlightEvent before{};
+    before.time_us = 0xFFFFFFF0u;  // 32 us before the trigger, before the wrap
+    ASSERT_EQ(reader.relative_us(before), -32);
+    return true;
+}
+
+// ============================================================================
+// Source Tests
+// ============================================================================
+
+bool test_packet_ring_queued_time() {
+    ams::mitm::bsd::PacketRing<4> ring;
+    ryu_ldn::bsd::SockAddrIn from{};
+    uint8_t payload[8] = {};
+    ASSERT_EQ(ring.FrontQueuedNs(), 0);
+
+    ring.Push(payload, sizeof(payload), from, 1000);
+    ring.Push(payload, sizeof(payload), from, 2000);
+    ring.Push(payload, sizeof(payload), from);
+    ASSERT_EQ(ring.FrontQueuedNs(), 1000);
+
+    uint8_t buffer[8];
+    ring.Read(buffer, sizeof(buffer), true, nullptr);
+    ASSERT_EQ(ring.FrontQueuedNs(), 1000);
+    ring.Read(buffer, sizeof(buffer), false, nullptr);
+    ASSERT_EQ(ring.FrontQueuedNs(), 2000);
+    ring.Read(buffer, sizeof(buffer), false, nullptr);
+    ASSERT_EQ(ring.FrontQueuedNs(), 0);
+    return true;
+}
+
+bool test_connection_state_events() {
+    using ryu_ldn::network::ConnectionEvent;
+    using ryu_ldn::network::ConnectionState;
+
+    ryu_ldn::network::ConnectionStateMachine machine;
+    machine.process_event(ConnectionEvent::Connect);
+    machine.process_event(ConnectionEvent::ConnectFailed);
+    machine.process_event(ConnectionEvent::BackoffExpired);
+
+    // Record only the second failed attempt
+    g_flight_recorder.start(Thresholds(1, 0, 0, 0));
+    machine.process_event(ConnectionEvent::ConnectFailed);
+    machine.process_event(ConnectionEvent::BackoffExpired);
+    g_flight_recorder.rtt(1);
+
+    std::vector<FlightEvent> events = Frozen(g_flight_recorder);
+    g_flight_recorder.stop();
+
+    // Retrying -> Backoff, retry 2, Backoff -> Retrying, Rtt, Trigger
+    ASSERT_EQ(events.size(), 5);
+    ASSERT_EQ(events[0].type, FlightEventType::StateChange);
+    ASSERT_EQ(events[0].sub, FlightStateMachine::Server);
+    ASSERT_EQ(events[0].a, ConnectionEvent::ConnectFailed);
+    ASSERT_EQ(events[0].b, ConnectionState::Retrying);
+    ASSERT_EQ(events[0].c, ConnectionState::Backoff);
+    ASSERT_EQ(events[1].type, FlightEventType::Reconnect);
+    ASSERT_EQ(events[1].b, 2);
+    ASSERT_EQ(events[2].type, FlightEventType::StateChange);
+    ASSERT_EQ(events[2].b, ConnectionState::Backoff);
+    ASSERT_EQ(events[2].c, ConnectionState::Retrying);
+    ASSERT_EQ(events[4].type, FlightEventType::Trigger);
+    return true;
+}
+
+bool test_names() {
+    ASSERT_TRUE(std::strcmp(flight_event_to_string(FlightEventType::QueueDelay), "QueueDelay") == 0);
+    ASSERT_TRUE(std::strcmp(flight_event_to_string(static_cast<FlightEventType>(0)), "Invalid") == 0);
+    ASSERT_TRUE(std::strcmp(flight_trigger_to_string(FlightTrigger::IpcLatency), "IpcLatency") == 0);
+    ASSERT_TRUE(std::strcmp(flight_trigger_to_string(FlightTrigger::Count), "Invalid") == 0);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Flight Recorder Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Ring Tests:\n");
+    RUN_TEST(test_disabled_records_nothing);
+    RUN_TEST(test_event_fields);
+    RUN_TEST(test_ring_wraps);
+
+    printf("\nTrigger Tests:\n");
+    RUN_TEST(test_thresholds);
+    RUN_TEST(test_zero_threshold_disabled);
+    RUN_TEST(test_blocking_calls_never_trigger);
+    RUN_TEST(test_frozen_drops_events);
+    RUN_TEST(test_rate_limit);
+
+    printf("\nDump Tests:\n");
+    RUN_TEST(test_dump_round_trip);
+    RUN_TEST(test_suppressed_reported);
+    RUN_TEST(test_reader_rejects_bad_dumps);
+    RUN_TEST(test_relative_time_wraps);
+
+    printf("\nSource Tests:\n");
+    RUN_TEST(test_packet_ring_queued_time);
+    RUN_TEST(test_connection_state_events);
+    RUN_TEST(test_names);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,325 @@
+/**
+ * @file ipc_recorder_tests.cpp
+ * @brief Unit tests for the IPC call recorder
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Recording Tests
+ * ScopedIpcRecord fields, watched results, payload capture, off state.
+ *
+ * ### Ring Tests
+ * Overwrite of the oldest records, clear, stop.
+ *
+ * ### File Format Tests
+ * serialize/write_file round trip, IpcTraceReader on foreign and
+ * truncated traces.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "diagnostics/ipc_recorder.hpp"
+#include "bsd/bsd_types.hpp"
+
+using namespace ryu_ldn::diagnostics;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+// 64 KiB, kept out of the stack
+IpcRecorder g_recorder;
+
+ryu_ldn::bsd::SockAddrIn MakeAddr(uint32_t ip, uint16_t port) {
+    ryu_ldn::bsd::SockAddrIn addr{};
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    addr.sin_port = __builtin_bswap16(port);
+    addr.sin_addr = __builtin_bswap32(ip);
+    return addr;
+}
+
+std::vector<uint8_t> Serialize(const IpcRecorder& recorder) {
+    std::vector<uint8_t> out(recorder.serialized_size());
+    out.resize(recorder.serialize(out.data(), out.size()));
+    return out;
+}
+
+void RecordSend(int32_t fd, int32_t arg0) {
+    ScopedIpcRecord record(IpcService::Bsd, bsd_cmd::Send, fd, g_recorder);
+    record.set_args(arg0, 0);
+}
+
+} // namespace
+
+// ============================================================================
+// Recording Tests
+// ============================================================================
+
+bool test_off_records_nothing() {
+    g_recorder.stop();
+    g_recorder.clear();
+
+    RecordSend(3, 0);
+    ASSERT_EQ(g_recorder.size(), 0);
+    ASSERT_FALSE(g_recorder.write_file("/tmp/ryu_ldn_ipc_trace_empty.bin"));
+    return true;
+}
+
+bool test_scoped_record_fields() {
+    g_recorder.start(false);
+
+    const char payload[] = "advertisement";
+    auto dest = MakeAddr(0x0A72FFFF, 12345);
+    int32_t out_size = 0;
+    int32_t out_errno = -1;
+    {
+        ScopedIpcRecord record(IpcService::Bsd, bsd_cmd::SendTo, 7, g_recorder);
+        record.set_args(0x80, 0);
+        record.set_buffer(payload, sizeof(payload));
+        record.set_sockaddr(&dest, sizeof(dest));
+        record.watch(&out_size, &out_errno);
+
+        // Set on the way out, read when the record leaves scope
+        out_size = sizeof(payload);
+        out_errno = 0;
+    }
+    {
+        ScopedIpcRecord record(IpcService::Ldn, ldn_cmd::Scan, -1, g_recorder);
+    }
+
+    auto trace = Serialize(g_recorder);
+    IpcTraceReader reader(trace.data(), trace.size());
+    ASSERT_TRUE(reader.valid());
+    ASSERT_EQ(reader.header().record_count, 2);
+
+    IpcRecord record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.service, IpcService::Bsd);
+    ASSERT_EQ(record.command, bsd_cmd::SendTo);
+    ASSERT_EQ(record.fd, 7);
+    ASSERT_EQ(record.arg0, 0x80);
+    ASSERT_EQ(record.size, sizeof(payload));
+    ASSERT_EQ(record.flags, IPC_RECORD_HAS_ADDR | IPC_RECORD_HAS_RESULT);
+    ASSERT_EQ(record.addr_ip, 0x0A72FFFF);
+    ASSERT_EQ(record.addr_port, 12345);
+    ASSERT_EQ(record.result, sizeof(payload));
+    ASSERT_EQ(record.error, 0);
+    ASSERT_EQ(record.payload_len, 0);
+
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.service, IpcService::Ldn);
+    ASSERT_EQ(record.command, ldn_cmd::Scan);
+    ASSERT_EQ(record.flags, 0);
+    ASSERT_FALSE(reader.next(record));
+    return true;
+}
+
+bool test_payload_capture_truncates() {
+    g_recorder.start(true);
+
+    uint8_t payload[40];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+    {
+        ScopedIpcRecord record(IpcService::Bsd, bsd_cmd::Send, 3, g_recorder);
+        record.set_buffer(payload, sizeof(payload));
+    }
+    {
+        // Receive buffers are sized, never copied
+        ScopedIpcRecord record(IpcService::Bsd, bsd_cmd::Recv, 3, g_recorder);
+        record.set_buffer(nullptr, 1500);
+    }
+
+    auto trace = Serialize(g_recorder);
+    IpcTraceReader reader(trace.data(), trace.size());
+    IpcRecord record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.size, sizeof(payload));
+    ASSERT_EQ(record.payload_len, IPC_RECORD_PAYLOAD);
+    ASSERT_TRUE(std::memcmp(record.payload, payload, IPC_RECORD_PAYLOAD) == 0);
+
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.size, 1500);
+    ASSERT_EQ(record.payload_len, 0);
+    return true;
+}
+
+// ============================================================================
+// Ring Tests
+// ============================================================================
+
+bool test_ring_keeps_newest() {
+    g_recorder.start(false);
+
+    for (int32_t i = 0; i < static_cast<int32_t>(IPC_RECORDER_CAPACITY) + 10; i++) {
+        RecordSend(3, i);
+    }
+    ASSERT_EQ(g_recorder.size(), IPC_RECORDER_CAPACITY);
+
+    auto trace = Serialize(g_recorder);
+    IpcTraceReader reader(trace.data(), trace.size());
+    ASSERT_TRUE(reader.valid());
+    ASSERT_EQ(reader.header().record_count, IPC_RECORDER_CAPACITY);
+    ASSERT_EQ(reader.header().overwritten, 10);
+
+    // Oldest first, times never go backwards
+    IpcRecord record;
+    int32_t expected = 10;
+    uint64_t last_time = 0;
+    while (reader.next(record)) {
+        ASSERT_EQ(record.arg0, expected);
+        ASSERT_TRUE(record.time_ns >= last_time);
+        last_time = record.time_ns;
+        expected++;
+    }
+    ASSERT_EQ(expected, static_cast<int32_t>(IPC_RECORDER_CAPACITY) + 10);
+    return true;
+}
+
+bool test_clear_and_stop() {
+    g_recorder.start(false);
+    RecordSend(3, 1);
+    g_recorder.clear();
+    ASSERT_EQ(g_recorder.size(), 0);
+    ASSERT_TRUE(g_recorder.is_recording());
+
+    RecordSend(3, 2);
+    g_recorder.stop();
+    RecordSend(3, 3);
+    ASSERT_EQ(g_recorder.size(), 1);
+    return true;
+}
+
+// ============================================================================
+// File Format Tests
+// ============================================================================
+
+bool test_write_file_round_trip() {
+    const char* path = "/tmp/ryu_ldn_ipc_trace_test.bin";
+    g_recorder.start(false);
+
+    // Wrapped ring: the file is written in two runs
+    for (int32_t i = 0; i < static_cast<int32_t>(IPC_RECORDER_CAPACITY) + 100; i++) {
+        RecordSend(3, i);
+    }
+    ASSERT_TRUE(g_recorder.write_file(path));
+    ASSERT_TRUE(g_recorder.is_recording());
+
+    std::FILE* file = std::fopen(path, "rb");
+    ASSERT_TRUE(file != nullptr);
+    std::vector<uint8_t> data(g_recorder.serialized_size() + 1);
+    size_t read = std::fread(data.data(), 1, data.size(), file);
+    std::fclose(file);
+    std::remove(path);
+
+    auto expected = Serialize(g_recorder);
+    ASSERT_EQ(read, expected.size());
+    ASSERT_TRUE(std::memcmp(data.data(), expected.data(), read) == 0);
+
+    IpcTraceReader reader(data.data(), read);
+    IpcRecord record;
+    ASSERT_TRUE(reader.valid());
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.arg0, 100);
+    return true;
+}
+
+bool test_reader_rejects_foreign_and_truncated() {
+    g_recorder.start(false);
+    RecordSend(3, 0);
+    RecordSend(3, 1);
+    auto trace = Serialize(g_recorder);
+
+    IpcTraceReader truncated(trace.data(), trace.size() - 1);
+    ASSERT_FALSE(truncated.valid());
+
+    IpcTraceReader too_short(trace.data(), sizeof(IpcTraceHeader) - 1);
+    ASSERT_FALSE(too_short.valid());
+
+    trace[0] ^= 0xFF;
+    IpcTraceReader foreign(trace.data(), trace.size());
+    ASSERT_FALSE(foreign.valid());
+
+    IpcRecord record;
+    ASSERT_FALSE(foreign.next(record));
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  IPC Recorder Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Recording Tests:\n");
+    RUN_TEST(test_off_records_nothing);
+    RUN_TEST(test_scoped_record_fields);
+    RUN_TEST(test_payload_capture_truncates);
+
+    printf("\nRing Tests:\n");
+    RUN_TEST(test_ring_keeps_newest);
+    RUN_TEST(test_clear_and_stop);
+
+    printf("\nFile Format Tests:\n");
+    RUN_TEST(test_write_file_round_trip);
+    RUN_TEST(test_reader_rejects_foreign_and_truncated);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,582 @@
+/**
+ * @file ipc_replay.cpp
+ * @brief Host replayer of IPC traces recorded on the console
+ *
+ * Reads an ipc_trace.bin written by IpcRecorder (`[debug] ipc_record = 1`)
+ * and drives the same bsd:u sequence through libryu_core.a, the sources
+ * the sysmodule builds:
+ *
+ * - Socket/Bind/Connect/SendTo create and bind ProxySockets with the same
+ *   rules as BsdMitmService (LDN destination, ephemeral auto-bind).
+ * - Sends go through ProxySocketManager into a ProxyData encoder (what
+ *   SendProxyDataCallback puts on the wire).
+ * - A receive that returned N bytes on the console is fed as an N byte
+ *   ProxyData through decode_header -> PacketDispatcher ->
+ *   RouteIncomingData, then the receive is replayed without blocking.
+ * - ProxyConnect is answered like the recorded Connect ended.
+ * - Select/Poll scan the proxy sockets for readiness.
+ *
+ * Calls on sockets that were forwarded to the real bsd:u and ldn:u
+ * commands are counted but not replayed (they need the console services).
+ *
+ * Every replayed call is timed, and its result is compared with the
+ * recorded one: a mismatch means the proxy layer now behaves differently
+ * for this title's call pattern.
+ *
+ * ## Usage
+ *
+ * ```
+ * make run_ipc_replay
+ * ./run_ipc_replay ipc_trace.bin              # back to back, report
+ * ./run_ipc_replay ipc_trace.bin --loop 100   # benchmark
+ * ./run_ipc_replay ipc_trace.bin --realtime   # keep the recorded pacing
+ * ./run_ipc_replay ipc_trace.bin --strict     # exit 1 on any mismatch
+ * ```
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "bsd/proxy_socket_manager.hpp"
+#include "diagnostics/ipc_recorder.hpp"
+#include "ldn/ldn_packet_dispatcher.hpp"
+#include "protocol/ryu_protocol.hpp"
+
+using namespace ams::mitm::bsd;
+using namespace ryu_ldn::diagnostics;
+using ryu_ldn::bsd::SockAddrIn;
+using ryu_ldn::bsd::SocketType;
+using ryu_ldn::bsd::ProtocolType;
+namespace platform = ryu_ldn::platform;
+namespace protocol = ryu_ldn::protocol;
+
+namespace {
+
+constexpr uint32_t DEFAULT_LOCAL_IP = 0x0A720001;  // 10.114.0.1
+constexpr uint32_t DEFAULT_PEER_IP  = 0x0A720002;  // 10.114.0.2
+constexpr size_t WIRE_BUFFER_SIZE = sizeof(protocol::LdnHeader) +
+                                    sizeof(protocol::ProxyDataHeader) +
+                                    PROXY_SOCKET_MAX_PAYLOAD;
+
+struct Options {
+    const char* path = nullptr;
+    int loops = 1;
+    bool realtime = false;
+    bool strict = false;
+};
+
+struct SocketInfo {
+    SocketType type;
+    ProtocolType protocol;
+    bool is_proxy;
+};
+
+struct CommandStats {
+    const char* name = "?";
+    uint64_t count = 0;
+    uint64_t replayed = 0;
+    uint64_t mismatches = 0;
+    uint64_t recorded_ns = 0;
+    std::vector<uint64_t> replay_ns;
+};
+
+std::map<int32_t, SocketInfo> g_sockets;
+std::map<uint32_t, CommandStats> g_stats;   // (service << 16) | command
+uint64_t g_tx_packets = 0;
+uint64_t g_tx_bytes = 0;
+bool g_accept_connect = true;
+
+// -----------------------------------------------------------------------------
+// Server side
+// -----------------------------------------------------------------------------
+
+// Same framing as SendProxyDataCallback, minus the socket write
+bool EncodeToServer(uint32_t source_ip, uint16_t source_port,
+                    uint32_t dest_ip, uint16_t dest_port,
+                    ProtocolType proto, const void* data, size_t data_len) {
+    static uint8_t wire[WIRE_BUFFER_SIZE];
+    protocol::ProxyInfo info{};
+    info.source_ipv4 = source_ip;
+    info.source_port = source_port;
+    info.dest_ipv4 = dest_ip;
+    info.dest_port = dest_port;
+    info.protocol = proto == ProtocolType::Tcp ? protocol::ProtocolType::Tcp
+                                               : protocol::ProtocolType::Udp;
+    size_t size = 0;
+    if (protocol::encode_proxy_data(wire, sizeof(wire), info, static_cast<const uint8_t*>(data),
+                                    data_len, size) != protocol::EncodeResult::Success) {
+        return false;
+    }
+    g_tx_packets++;
+    g_tx_bytes += size;
+    return true;
+}
+
+// Plays the server: the connect ends the way it ended on the console
+bool ReplyToConnect(uint32_t source_ip, uint16_t source_port,
+                    uint32_t dest_ip, uint16_t dest_port, ProtocolType) {
+    protocol::ProxyConnectResponse response{};
+    response.info.source_ipv4 = source_ip;
+    response.info.source_port = source_port;
+    response.info.dest_ipv4 = dest_ip;
+    response.info.dest_port = dest_port;
+    response.info.protocol = g_accept_connect ? protocol::ProtocolType::Unspecified
+                                              : protocol::ProtocolType::Tcp;
+    ProxySocketManager::GetInstance().RouteConnectResponse(response);
+    return true;
+}
+
+// Same mapping as ICommunicationService::HandleServerPacket
+void OnProxyData(const protocol::LdnHeader&, const protocol::ProxyDataHeader& proxy_header,
+                 const uint8_t* data, size_t) {
+    ProtocolType proto = proxy_header.info.protocol == protocol::ProtocolType::Tcp
+                             ? ProtocolType::Tcp : ProtocolType::Udp;
+    ProxySocketManager::GetInstance().RouteIncomingData(
+        proxy_header.info.source_ipv4, proxy_header.info.source_port,
+        proxy_header.info.dest_ipv4, proxy_header.info.dest_port,
+        proto, data, proxy_header.data_length);
+}
+
+// Deliver what the console received, through the LDN packet path
+void InjectIncoming(ryu_ldn::ldn::PacketDispatcher& dispatcher, const std::shared_ptr<ProxySocket>& socket, size_t size) {
+    static uint8_t payload[PROXY_SOCKET_MAX_PAYLOAD];
+    static uint8_t wire[WIRE_BUFFER_SIZE];
+
+    const SockAddrIn& local = socket->GetLocalAddr();
+    const SockAddrIn& remote = socket->GetRemoteAddr();
+    protocol::ProxyInfo info{};
+    info.source_ipv4 = remote.GetAddr() != 0 ? remote.GetAddr() : DEFAULT_PEER_IP;
+    info.source_port = remote.GetPort() != 0 ? remote.GetPort() : local.GetPort();
+    info.dest_ipv4 = local.GetAddr();
+    info.dest_port = local.GetPort();
+    info.protocol = socket->GetProtocol() == ProtocolType::Tcp ? protocol::ProtocolType::Tcp
+                                                               : protocol::ProtocolType::Udp;
+
+    size_t wire_size = 0;
+    size = std::min(size, sizeof(payload));
+    if (protocol::encode_proxy_data(wire, sizeof(wire), info, payload, size, wire_size) !=
+        protocol::EncodeResult::Success) {
+        return;
+    }
+
+    protocol::LdnHeader header;
+    if (protocol::decode_header(wire, wire_size, header) == protocol::DecodeResult::Success) {
+        dispatcher.dispatch(header, wire + sizeof(protocol::LdnHeader),
+                            static_cast<size_t>(header.data_size));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Replay
+// -----------------------------------------------------------------------------
+
+const char* CommandName(const IpcRecord& record) {
+    if (record.service == static_cast<uint8_t>(IpcService::Ldn)) {
+        switch (record.command) {
+            case ldn_cmd::GetState:                   return "ldn GetState";
+            case ldn_cmd::GetNetworkInfo:             return "ldn GetNetworkInfo";
+            case ldn_cmd::GetIpv4Address:             return "ldn GetIpv4Address";
+            case ldn_cmd::GetNetworkInfoLatestUpdate: return "ldn GetNetworkInfoLatest";
+            case ldn_cmd::Scan:                       return "ldn Scan";
+            case ldn_cmd::CreateNetwork:              return "ldn CreateNetwork";
+            case ldn_cmd::CreateNetworkPrivate:       return "ldn CreateNetworkPrivate";
+            case ldn_cmd::DestroyNetwork:             return "ldn DestroyNetwork";
+            case ldn_cmd::SetAdvertiseData:           return "ldn SetAdvertiseData";
+            case ldn_cmd::Connect:                    return "ldn Connect";
+            case ldn_cmd::ConnectPrivate:             return "ldn ConnectPrivate";
+            case ldn_cmd::Disconnect:                 return "ldn Disconnect";
+            default:                                  return "ldn ?";
+        }
+    }
+    switch (record.command) {
+        case bsd_cmd::Socket:   return "bsd Socket";
+        case bsd_cmd::Select:   return "bsd Select";
+        case bsd_cmd::Poll:     return "bsd Poll";
+        case bsd_cmd::Recv:     return "bsd Recv";
+        case bsd_cmd::RecvFrom: return "bsd RecvFrom";
+        case bsd_cmd::Send:     return "bsd Send";
+        case bsd_cmd::SendTo:   return "bsd SendTo";
+        case bsd_cmd::Bind:     return "bsd Bind";
+        case bsd_cmd::Connect:  return "bsd Connect";
+        case bsd_cmd::Listen:   return "bsd Listen";
+        case bsd_cmd::Close:    return "bsd Close";
+        default:                return "bsd ?";
+    }
+}
+
+SockAddrIn MakeAddr(uint32_t ip, uint16_t port) {
+    SockAddrIn addr{};
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    addr.sin_port = __builtin_bswap16(port);
+    addr.sin_addr = __builtin_bswap32(ip);
+    return addr;
+}
+
+SocketInfo& InfoFor(int32_t fd) {
+    auto it = g_sockets.find(fd);
+    if (it == g_sockets.end()) {
+        // Socket() happened before the ring window: assume UDP
+        it = g_sockets.emplace(fd, SocketInfo{SocketType::Dgram, ProtocolType::Udp, false}).first;
+    }
+    return it->second;
+}
+
+// Same rule as BsdMitmService::Connect/SendTo: create and auto-bind
+std::shared_ptr<ProxySocket> GetOrCreateBound(int32_t fd, SocketInfo& info) {
+    auto& manager = ProxySocketManager::GetInstance();
+    std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
+    if (proxy != nullptr) {
+        return proxy;
+    }
+    proxy = manager.CreateProxySocket(fd, info.type, info.protocol);
+    if (proxy == nullptr) {
+        return nullptr;
+    }
+    uint16_t ephemeral = manager.AllocatePort(info.protocol);
+    if (ephemeral != 0) {
+        proxy->Bind(MakeAddr(manager.GetLocalIp(), ephemeral));
+    }
+    return proxy;
+}
+
+/**
+ * @brief Replay one bsd:u record
+ *
+ * @param[out] result Replayed return value
+ * @param[out] error Replayed errno
+ * @return false if the call was forwarded on the console (not replayed)
+ */
+bool ReplayBsd(const IpcRecord& record, ryu_ldn::ldn::PacketDispatcher& dispatcher,
+               int32_t& result, int32_t& error) {
+    static uint8_t buffer[PROXY_SOCKET_MAX_PAYLOAD];
+    auto& manager = ProxySocketManager::GetInstance();
+    bool has_addr = (record.flags & IPC_RECORD_HAS_ADDR) != 0;
+    bool ldn_addr = has_addr && ryu_ldn::bsd::IsLdnAddress(record.addr_ip);
+    SockAddrIn addr = MakeAddr(record.addr_ip, record.addr_port);
+    result = 0;
+    error = 0;
+
+    auto from_send = [&](s32 rc) {
+        result = rc < 0 ? 0 : rc;
+        error = rc < 0 ? -rc : 0;
+    };
+
+    switch (record.command) {
+        case bsd_cmd::Socket: {
+            if (record.result >= 0) {
+                ProtocolType proto = static_cast<ProtocolType>(record.arg1);
+                if (record.arg1 == 0) {
+                    proto = record.arg0 == static_cast<int32_t>(SocketType::Stream) ? ProtocolType::Tcp
+                                                                                   : ProtocolType::Udp;
+                }
+                g_sockets[record.result] = SocketInfo{static_cast<SocketType>(record.arg0), proto, false};
+            }
+            return false;
+        }
+        case bsd_cmd::Bind: {
+            if (!ldn_addr) {
+                return false;
+            }
+            SocketInfo& info = InfoFor(record.fd);
+            std::shared_ptr<ProxySocket> proxy = manager.CreateProxySocket(record.fd, info.type, info.protocol);
+            if (proxy == nullptr) {
+                error = static_cast<int32_t>(ryu_ldn::bsd::BsdErrno::NoMem);
+                return true;
+            }
+            if (addr.GetPort() == 0) {
+                uint16_t ephemeral = manager.AllocatePort(info.protocol);
+                if (ephemeral == 0) {
+                    error = static_cast<int32_t>(ryu_ldn::bsd::BsdErrno::AddrInUse);
+                    return true;
+                }
+                addr.sin_port = __builtin_bswap16(ephemeral);
+            } else if (!manager.ReservePort(addr.GetPort(), info.protocol)) {
+                error = static_cast<int32_t>(ryu_ldn::bsd::BsdErrno::AddrInUse);
+                return true;
+            }
+            ams::Result rc = proxy->Bind(addr);
+            error = R_FAILED(rc) ? static_cast<int32_t>(rc.GetValue()) : 0;
+            info.is_proxy = R_SUCCEEDED(rc);
+            return true;
+        }
+        case bsd_cmd::Connect: {
+            if (!ldn_addr) {
+                return false;
+            }
+            SocketInfo& info = InfoFor(record.fd);
+            std::shared_ptr<ProxySocket> proxy = GetOrCreateBound(record.fd, info);
+            if (proxy == nullptr) {
+                error = static_cast<int32_t>(ryu_ldn::bsd::BsdErrno::NoMem);
+                return true;
+            }
+            g_accept_connect = record.error == 0 ||
+                               record.error == static_cast<int32_t>(ryu_ldn::bsd::BsdErrno::InProgress);
+            ams::Result rc = proxy->Connect(addr);
+            error = R_FAILED(rc) ? static_cast<int32_t>(rc.GetValue()) : 0;
+            info.is_proxy = true;
+            return true;
+        }
+        case bsd_cmd::SendTo:
+        case bsd_cmd::Send: {
+            SocketInfo& info = InfoFor(record.fd);
+            if (!info.is_proxy && !(record.command == bsd_cmd::SendTo && ldn_addr)) {
+                return false;
+            }
+            std::shared_ptr<ProxySocket> proxy = GetOrCreateBound(record.fd, info);
+            if (proxy == nullptr) {
+                return false;
+            }
+            info.is_proxy = true;
+
+            size_t size = std::min<size_t>(record.size, sizeof(buffer));
+            std::memset(buffer, 0, size);
+            std::memcpy(buffer, record.payload, std::min<size_t>(record.payload_len, size));
+            from_send(record.command == bsd_cmd::SendTo
+                          ? proxy->SendTo(buffer, record.size, record.arg0, addr)
+                          : proxy->Send(buffer, record.size, record.arg0));
+            return true;
+        }
+        case bsd_cmd::Recv:
+        case bsd_cmd::RecvFrom: {
+            std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(record.fd);
+            if (proxy == nullptr || !InfoFor(record.fd).is_proxy) {
+                return false;
+            }
+            if (record.result > 0) {
+                InjectIncoming(dispatcher, proxy, static_cast<size_t>(record.result));
+            }
+            size_t size = std::min<size_t>(record.size, sizeof(buffer));
+            s32 flags = record.arg0 | PROXY_SOCKET_MSG_DONTWAIT;
+            SockAddrIn from;
+            from_send(record.command == bsd_cmd::RecvFrom
+                          ? proxy->RecvFrom(buffer, size, flags, &from)
+                          : proxy->Recv(buffer, size, flags));
+            return true;
+        }
+        case bsd_cmd::Select:
+        case bsd_cmd::Poll: {
+            // Readiness scan only, the set of fds is not recorded
+            int32_t ready = 0;
+            bool any_proxy = false;
+            for (int32_t fd = 0; fd < record.arg0; fd++) {
+                std::shared_ptr<ProxySocket> proxy = manager.GetProxySocket(fd);
+                if (proxy != nullptr) {
+                    any_proxy = true;
+                    ready += proxy->HasPendingData() ? 1 : 0;
+                }
+            }
+            result = ready;
+            return any_proxy;
+        }
+        case bsd_cmd::Close: {
+            auto it = g_sockets.find(record.fd);
+            bool was_proxy = it != g_sockets.end() && it->second.is_proxy;
+            if (was_proxy) {
+                manager.CloseProxySocket(record.fd);
+            }
+            if (it != g_sockets.end()) {
+                g_sockets.erase(it);
+            }
+            return was_proxy;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Only outcomes the proxy layer decides are compared
+ */
+bool Matches(const IpcRecord& record, int32_t result, int32_t error) {
+    switch (record.command) {
+        case bsd_cmd::Bind:
+            return record.error == error;
+        case bsd_cmd::Connect:
+            // Non-blocking mode is not recorded, the replay always blocks
+            if (record.error == static_cast<int32_t>(ryu_ldn::bsd::BsdErrno::InProgress)) {
+                return error == 0;
+            }
+            return record.error == error;
+        case bsd_cmd::Send:
+        case bsd_cmd::SendTo:
+        case bsd_cmd::Recv:
+        case bsd_cmd::RecvFrom:
+            return record.error == error && (error != 0 || record.result == result);
+        default:
+            return true;
+    }
+}
+
+void PrintMismatch(const IpcRecord& record, int32_t result, int32_t error) {
+    static int printed = 0;
+    if (printed++ < 10) {
+        printf("  mismatch at %.3f ms: %s fd=%d recorded %d/errno %d, replayed %d/errno %d\n",
+               static_cast<double>(record.time_ns) / 1e6, CommandName(record), record.fd,
+               record.result, record.error, result, error);
+    }
+}
+
+uint64_t Percentile(std::vector<uint64_t>& values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+    return values[index];
+}
+
+bool ParseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--loop") == 0 && i + 1 < argc) {
+            options.loops = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--realtime") == 0) {
+            options.realtime = true;
+        } else if (std::strcmp(argv[i], "--strict") == 0) {
+            options.strict = true;
+        } else if (argv[i][0] != '-' && options.path == nullptr) {
+            options.path = argv[i];
+        } else {
+            return false;
+        }
+    }
+    return options.path != nullptr;
+}
+
+std::vector<uint8_t> ReadFile(const char* path) {
+    std::vector<uint8_t> data;
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return data;
+    }
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    return data;
+}
+
+// The console's LDN address is the first 10.114.x.x bind or send source
+uint32_t FindLocalIp(const std::vector<uint8_t>& trace) {
+    IpcTraceReader reader(trace.data(), trace.size());
+    IpcRecord record;
+    while (reader.next(record)) {
+        if (record.service == static_cast<uint8_t>(IpcService::Bsd) &&
+            record.command == bsd_cmd::Bind && (record.flags & IPC_RECORD_HAS_ADDR) &&
+            ryu_ldn::bsd::IsLdnAddress(record.addr_ip) && (record.addr_ip & 0xFF) != 0xFF) {
+            return record.addr_ip;
+        }
+    }
+    return DEFAULT_LOCAL_IP;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArgs(argc, argv, options)) {
+        fprintf(stderr, "usage: %s <ipc_trace.bin> [--loop N] [--realtime] [--strict]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> trace = ReadFile(options.path);
+    IpcTraceReader header_reader(trace.data(), trace.size());
+    if (!header_reader.valid()) {
+        fprintf(stderr, "%s: not an IPC trace (or truncated)\n", options.path);
+        return 2;
+    }
+
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetLocalIp(FindLocalIp(trace));
+    manager.SetSendCallback(EncodeToServer);
+    manager.SetProxyConnectCallback(ReplyToConnect);
+
+    ryu_ldn::ldn::PacketDispatcher dispatcher;
+    dispatcher.set_proxy_data_handler(OnProxyData);
+
+    printf("IPC replay: %s, %u records (%u overwritten before the window), %d pass(es)%s\n",
+           options.path, header_reader.header().record_count, header_reader.header().overwritten,
+           options.loops, options.realtime ? ", realtime" : "");
+
+    uint64_t total_mismatches = 0;
+    uint64_t start_ns = platform::GetTickNs();
+    for (int loop = 0; loop < options.loops; loop++) {
+        manager.CloseAllProxySockets();
+        g_sockets.clear();
+
+        IpcTraceReader reader(trace.data(), trace.size());
+        IpcRecord record;
+        uint64_t loop_start_ns = platform::GetTickNs();
+        uint64_t first_time_ns = UINT64_MAX;
+        while (reader.next(record)) {
+            if (options.realtime) {
+                first_time_ns = std::min(first_time_ns, record.time_ns);
+                uint64_t due = loop_start_ns + (record.time_ns - first_time_ns);
+                uint64_t now = platform::GetTickNs();
+                if (due > now) {
+                    platform::SleepNs(due - now);
+                }
+            }
+
+            CommandStats& stats = g_stats[(static_cast<uint32_t>(record.service) << 16) | record.command];
+            stats.name = CommandName(record);
+            stats.count++;
+            stats.recorded_ns += record.duration_ns;
+
+            if (record.service != static_cast<uint8_t>(IpcService::Bsd)) {
+                continue;
+            }
+
+            int32_t result;
+            int32_t error;
+            uint64_t call_start = platform::GetTickNs();
+            bool replayed = ReplayBsd(record, dispatcher, result, error);
+            uint64_t call_ns = platform::GetTickNs() - call_start;
+            if (!replayed) {
+                continue;
+            }
+
+            stats.replayed++;
+            stats.replay_ns.push_back(call_ns);
+            if ((record.flags & IPC_RECORD_HAS_RESULT) && !Matches(record, result, error)) {
+                stats.mismatches++;
+                total_mismatches++;
+                PrintMismatch(record, result, error);
+            }
+        }
+    }
+    uint64_t elapsed_ns = platform::GetTickNs() - start_ns;
+
+    printf("\n  %-26s %8s %8s %8s %12s %12s %12s\n",
+           "command", "calls", "replayed", "mismatch", "replay p50", "replay p99", "console avg");
+    for (auto& [key, stats] : g_stats) {
+        (void)key;
+        uint64_t p50 = Percentile(stats.replay_ns, 0.50);
+        uint64_t p99 = Percentile(stats.replay_ns, 0.99);
+        printf("  %-26s %8llu %8llu %8llu %9.2f us %9.2f us %9.2f us\n",
+               stats.name,
+               static_cast<unsigned long long>(stats.count),
+               static_cast<unsigned long long>(stats.replayed),
+               static_cast<unsigned long long>(stats.mismatches),
+               static_cast<double>(p50) / 1e3, static_cast<double>(p99) / 1e3,
+               static_cast<double>(stats.recorded_ns) / 1e3 / static_cast<double>(stats.count));
+    }
+    printf("\n  ProxyData sent: %llu packets, %llu wire bytes\n",
+           static_cast<unsigned long long>(g_tx_packets), static_cast<unsigned long long>(g_tx_bytes));
+    printf("  Wall time: %.3f ms, mismatches: %llu\n",
+           static_cast<double>(elapsed_ns) / 1e6, static_cast<unsigned long long>(total_mismatches));
+
+    manager.CloseAllProxySockets();
+    manager.SetSendCallback(nullptr);
+    manager.SetProxyConnectCallback(nullptr);
+    return options.strict && total_mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,700 @@
+/**
+ * @file lan_discovery_tests.cpp
+ * @brief Unit tests for LAN discovery of a P2P host and the dial race
+ *
+ * The "router" is played by two loopback aliases: a stand-in host answers
+ * auth on 127.0.0.1 (its external, port-mapped address) and on 127.0.0.2
+ * (its LAN address), where it also runs a LanResponder. The external path
+ * can be missing (router without hairpinning), slow, or silent.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Wire Format Tests
+ * Message encoding and validation, token digests, address helpers.
+ *
+ * ### LanResponder Tests
+ * Replies only for expected tokens, from the LAN address, proving the
+ * token for the query's nonce.
+ *
+ * ### P2pDialer Tests
+ * First authenticated path wins, the loser is refused, failures and the
+ * bytes following ProxyConfig.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "p2p/lan_discovery.hpp"
+#include "protocol/ryu_protocol.hpp"
+
+using namespace ryu_ldn::p2p;
+using namespace ryu_ldn::protocol;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static constexpr uint32_t EXTERNAL_IP = 0x7F000001;  // 127.0.0.1
+static constexpr uint32_t LAN_IP = 0x7F000002;       // 127.0.0.2
+static constexpr uint32_t VIRTUAL_IP = 0x0A720002;   // 10.114.0.2
+static constexpr uint32_t DIAL_TIMEOUT_MS = 2000;
+
+static const uint8_t TOKEN[16] = {
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+    0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xF0, 0x01,
+};
+
+static const uint8_t NONCE[LAN_NONCE_SIZE] = {
+    0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+};
+
+static uint64_t now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static sockaddr_in make_addr(uint32_t ip, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(ip);
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+static ExternalProxyConfig make_config(uint32_t ip, uint16_t port, const uint8_t* token = TOKEN) {
+    ExternalProxyConfig config{};
+    config.proxy_ip[0] = static_cast<uint8_t>(ip >> 24);
+    config.proxy_ip[1] = static_cast<uint8_t>(ip >> 16);
+    config.proxy_ip[2] = static_cast<uint8_t>(ip >> 8);
+    config.proxy_ip[3] = static_cast<uint8_t>(ip);
+    config.address_family = AF_INET;
+    config.proxy_port = port;
+    std::memcpy(config.token, token, sizeof(config.token));
+    return config;
+}
+
+/**
+ * @brief A port on 127.0.0.1 nothing listens on (connect is refused)
+ */
+static uint16_t closed_port() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = make_addr(EXTERNAL_IP, 0);
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+static bool recv_exact(int fd, uint8_t* buf, size_t size, int timeout_ms) {
+    size_t got = 0;
+    while (got < size) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0) return false;
+        ssize_t n = recv(fd, buf + got, size - got, 0);
+        if (n <= 0) return false;
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// ============================================================================
+// Stand-in Host
+// ============================================================================
+
+/**
+ * @brief How the external (hairpinned) path behaves
+ */
+enum class ExternalPath {
+    Direct,   ///< Router hairpins fine
+    Slow,     ///< Hairpin on a slow path: auth reaches the host late
+    Silent,   ///< Connection accepted, auth never arrives
+    Missing,  ///< No hairpinning: connect is refused
+};
+
+/**
+ * @brief P2P host reachable on 127.0.0.1 (external) and 127.0.0.2 (LAN)
+ *
+ * Like P2pProxyServer, the first auth with the expected token consumes it
+ * and gets ProxyConfig; any later one is closed.
+ */
+class StandInHost {
+public:
+    ExternalPath external = ExternalPath::Direct;
+    uint32_t slow_ms = 500;
+    bool lan_responder = true;
+    bool trailing_packet = false;   ///< Send a ProxyData right behind ProxyConfig
+
+    std::atomic<int> accepted{0};
+    std::atomic<int> refused{0};
+    std::atomic<uint32_t> winner_ip{0};
+
+    ~StandInHost() { stop(); }
+
+    bool start() {
+        if (external != ExternalPath::Missing) {
+            if (!listen_on(EXTERNAL_IP, m_external_fd, m_external_port)) return false;
+        } else {
+            m_external_port = closed_port();
+        }
+        if (!listen_on(LAN_IP, m_lan_fd, m_lan_port)) return false;
+        if (lan_responder && !m_responder.open(LAN_IP, 0)) return false;
+
+        m_running = true;
+        m_thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (m_running.exchange(false)) {
+            m_thread.join();
+        }
+        for (int fd : {m_external_fd, m_lan_fd}) {
+            if (fd >= 0) close(fd);
+        }
+        m_external_fd = m_lan_fd = -1;
+        for (int fd : m_held) close(fd);
+        m_held.clear();
+        m_responder.close();
+    }
+
+    uint16_t external_port() const { return m_external_port; }
+    uint16_t lan_port() const { return m_lan_port; }
+    uint16_t responder_port() const { return m_responder.port(); }
+
+private:
+    int m_external_fd = -1;
+    int m_lan_fd = -1;
+    uint16_t m_external_port = 0;
+    uint16_t m_lan_port = 0;
+    LanResponder m_responder;
+    std::vector<int> m_held;
+    bool m_consumed = false;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+
+    static bool listen_on(uint32_t ip, int& fd, uint16_t& port) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in addr = make_addr(ip, 0);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+        if (listen(fd, 4) != 0) return false;
+        socklen_t len = sizeof(addr);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        return true;
+    }
+
+    static bool expected(const uint8_t* digest, uint8_t* token_out, void* user_data) {
+        auto* self = static_cast<StandInHost*>(user_data);
+        uint8_t own[LAN_DIGEST_SIZE];
+        lan_query_digest(TOKEN, own);
+        if (self->m_consumed || std::memcmp(digest, own, sizeof(own)) != 0) {
+            return false;
+        }
+        std::memcpy(token_out, TOKEN, sizeof(TOKEN));
+        return true;
+    }
+
+    struct Pending {
+        int fd;
+        uint32_t ip;
+        uint64_t ready_ms;   ///< Slow path: auth "arrives" at this time
+    };
+
+    void run() {
+        std::vector<Pending> pending;
+        while (m_running) {
+            pollfd fds[3] = {
+                {m_external_fd, POLLIN, 0},
+                {m_lan_fd, POLLIN, 0},
+                {m_responder.fd(), POLLIN, 0},
+            };
+            poll(fds, 3, 10);
+
+            if (fds[2].revents != 0) {
+                m_responder.poll(m_lan_port, expected, this);
+            }
+            for (int i = 0; i < 2; i++) {
+                if (fds[i].fd < 0 || (fds[i].revents & POLLIN) == 0) continue;
+                int fd = accept(fds[i].fd, nullptr, nullptr);
+                if (fd < 0) continue;
+                accepted++;
+                bool is_external = i == 0;
+                if (is_external && external == ExternalPath::Silent) {
+                    m_held.push_back(fd);
+                    continue;
+                }
+                uint64_t delay = (is_external && external == ExternalPath::Slow) ? slow_ms : 0;
+                pending.push_back({fd, is_external ? EXTERNAL_IP : LAN_IP, now_ms() + delay});
+            }
+
+            for (auto it = pending.begin(); it != pending.end();) {
+                if (now_ms() < it->ready_ms) {
+                    ++it;
+                    continue;
+                }
+                authenticate(*it);
+                it = pending.erase(it);
+            }
+        }
+        for (const auto& p : pending) close(p.fd);
+    }
+
+    void authenticate(const Pending& p) {
+        uint8_t packet[sizeof(LdnHeader) + sizeof(ExternalProxyConfig)];
+        ExternalProxyConfig config;
+        bool ok = recv_exact(p.fd, packet, sizeof(packet), 1000);
+        std::memcpy(&config, packet + sizeof(LdnHeader), sizeof(config));
+        ok = ok && packet[4] == static_cast<uint8_t>(PacketId::ExternalProxy) &&
+             std::memcmp(config.token, TOKEN, sizeof(TOKEN)) == 0 && !m_consumed;
+        if (!ok) {
+            refused++;
+            close(p.fd);
+            return;
+        }
+
+        m_consumed = true;
+        winner_ip = p.ip;
+
+        uint8_t reply[256];
+        size_t len = 0;
+        ProxyConfig proxy_config{VIRTUAL_IP, 0xFFFF0000};
+        encode(reply, sizeof(reply), PacketId::ProxyConfig, proxy_config, len);
+        if (trailing_packet) {
+            size_t extra = 0;
+            ProxyDataHeader header{};
+            header.info.source_ipv4 = 0x0A720001;
+            header.data_length = 0;
+            encode(reply + len, sizeof(reply) - len, PacketId::ProxyData, header, extra);
+            len += extra;
+        }
+        send(p.fd, reply, len, 0);
+        m_held.push_back(p.fd);
+    }
+};
+
+// ============================================================================
+// Wire Format Tests
+// ============================================================================
+
+bool test_message_roundtrip() {
+    LanMessage message = make_lan_reply(TOKEN, NONCE, 39990);
+    LanMessage parsed;
+    ASSERT_TRUE(parse_lan_message(reinterpret_cast<const uint8_t*>(&message), sizeof(message), parsed));
+    ASSERT_TRUE(parsed.type == LanMessageType::Reply);
+    ASSERT_EQ(parsed.port, 39990);
+    ASSERT_TRUE(std::memcmp(parsed.nonce, NONCE, sizeof(NONCE)) == 0);
+
+    uint8_t proof[LAN_DIGEST_SIZE];
+    lan_reply_digest(TOKEN, NONCE, proof);
+    ASSERT_TRUE(std::memcmp(parsed.digest, proof, sizeof(proof)) == 0);
+    return true;
+}
+
+bool test_parse_rejects_invalid() {
+    LanMessage message = make_lan_query(TOKEN, NONCE);
+    LanMessage parsed;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&message);
+
+    ASSERT_TRUE(!parse_lan_message(bytes, sizeof(message) - 1, parsed));
+    ASSERT_TRUE(!parse_lan_message(nullptr, sizeof(message), parsed));
+
+    LanMessage bad = message;
+    bad.magic = 0x43594C52;  // A relay control message
+    ASSERT_TRUE(!parse_lan_message(reinterpret_cast<const uint8_t*>(&bad), sizeof(bad), parsed));
+
+    bad = message;
+    bad.version = LAN_DISCOVERY_VERSION + 1;
+    ASSERT_TRUE(!parse_lan_message(reinterpret_cast<const uint8_t*>(&bad), sizeof(bad), parsed));
+
+    bad = message;
+    bad.type = static_cast<LanMessageType>(9);
+    ASSERT_TRUE(!parse_lan_message(reinterpret_cast<const uint8_t*>(&bad), sizeof(bad), parsed));
+    return true;
+}
+
+bool test_sha256_vectors() {
+    // FIPS 180-2 examples: one block, and two blocks after padding
+    static const uint8_t ABC[32] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+    };
+    static const uint8_t LONG[32] = {
+        0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+        0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1,
+    };
+    const char* long_input = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    uint8_t hash[32];
+    sha256("abc", 3, hash);
+    ASSERT_TRUE(std::memcmp(hash, ABC, sizeof(hash)) == 0);
+    sha256(long_input, std::strlen(long_input), hash);
+    ASSERT_TRUE(std::memcmp(hash, LONG, sizeof(hash)) == 0);
+    return true;
+}
+
+bool test_query_hides_token() {
+    LanMessage query = make_lan_query(TOKEN, NONCE);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&query);
+    for (size_t i = 0; i + sizeof(TOKEN) <= sizeof(query); i++) {
+        ASSERT_TRUE(std::memcmp(bytes + i, TOKEN, sizeof(TOKEN)) != 0);
+    }
+
+    // The reply proof depends on the nonce and differs from the query digest
+    uint8_t other_nonce[LAN_NONCE_SIZE] = {};
+    uint8_t proof[LAN_DIGEST_SIZE];
+    uint8_t other_proof[LAN_DIGEST_SIZE];
+    lan_reply_digest(TOKEN, NONCE, proof);
+    lan_reply_digest(TOKEN, other_nonce, other_proof);
+    ASSERT_TRUE(std::memcmp(proof, other_proof, sizeof(proof)) != 0);
+    ASSERT_TRUE(std::memcmp(proof, query.digest, sizeof(proof)) != 0);
+    return true;
+}
+
+bool test_same_subnet() {
+    ASSERT_TRUE(is_same_subnet(0xC0A80105, 0xC0A80164, 0xFFFFFF00));    // 192.168.1.5
+    ASSERT_TRUE(!is_same_subnet(0xC0A80205, 0xC0A80164, 0xFFFFFF00));   // 192.168.2.5
+    ASSERT_TRUE(!is_same_subnet(0x0A000001, 0xC0A80164, 0xFFFFFF00));   // 10.0.0.1
+    ASSERT_TRUE(!is_same_subnet(0xC0A80105, 0, 0xFFFFFF00));
+    ASSERT_TRUE(!is_same_subnet(0xC0A80105, 0xC0A80164, 0));
+    return true;
+}
+
+bool test_broadcast_address() {
+    ASSERT_EQ(lan_broadcast_address(0xC0A80164, 0xFFFFFF00), 0xC0A801FF);
+    ASSERT_EQ(lan_broadcast_address(0x0A000105, 0xFFFF0000), 0x0A00FFFF);
+    ASSERT_EQ(lan_broadcast_address(0, 0xFFFFFF00), 0);
+    ASSERT_EQ(lan_broadcast_address(0xC0A80164, 0), 0);
+    return true;
+}
+
+// ============================================================================
+// LanResponder Tests
+// ============================================================================
+
+bool test_responder_answers_expected_token_only() {
+    StandInHost host;
+    ASSERT_TRUE(host.start());
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in to = make_addr(LAN_IP, host.responder_port());
+
+    uint8_t other[16] = {};
+    LanMessage query = make_lan_query(other, NONCE);
+    sendto(fd, &query, sizeof(query), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+    pollfd pfd{fd, POLLIN, 0};
+    ASSERT_EQ(poll(&pfd, 1, 150), 0);
+
+    query = make_lan_query(TOKEN, NONCE);
+    sendto(fd, &query, sizeof(query), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+    ASSERT_EQ(poll(&pfd, 1, 1000), 1);
+
+    uint8_t buf[64];
+    sockaddr_in from{};
+    socklen_t from_len = sizeof(from);
+    ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &from_len);
+    close(fd);
+
+    LanMessage reply;
+    ASSERT_TRUE(parse_lan_message(buf, static_cast<size_t>(n), reply));
+    ASSERT_TRUE(reply.type == LanMessageType::Reply);
+    ASSERT_EQ(reply.port, host.lan_port());
+    ASSERT_EQ(ntohl(from.sin_addr.s_addr), LAN_IP);
+
+    uint8_t proof[LAN_DIGEST_SIZE];
+    lan_reply_digest(TOKEN, NONCE, proof);
+    ASSERT_TRUE(std::memcmp(reply.digest, proof, sizeof(proof)) == 0);
+    return true;
+}
+
+// ============================================================================
+// P2pDialer Tests
+// ============================================================================
+
+bool test_dial_external_only() {
+    StandInHost host;
+    ASSERT_TRUE(host.start());
+
+    P2pDialer dialer;
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port()), 0, 0, DIAL_TIMEOUT_MS);
+    ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    ASSERT_EQ(dialer.candidate_count(), 1);
+    ASSERT_TRUE(!dialer.winner().lan);
+    ASSERT_EQ(dialer.winner().ipv4, EXTERNAL_IP);
+    ASSERT_EQ(dialer.proxy_config().proxy_ip, VIRTUAL_IP);
+    ASSERT_EQ(dialer.proxy_config().proxy_subnet_mask, 0xFFFF0000);
+    return true;
+}
+
+bool test_dial_lan_without_hairpin() {
+    StandInHost host;
+    host.external = ExternalPath::Missing;
+    ASSERT_TRUE(host.start());
+
+    P2pDialer dialer;
+    uint64_t start = now_ms();
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port()),
+                         LAN_IP, host.responder_port(), DIAL_TIMEOUT_MS);
+    uint64_t elapsed = now_ms() - start;
+    ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    ASSERT_EQ(dialer.candidate_count(), 2);
+    ASSERT_TRUE(dialer.winner().lan);
+    ASSERT_EQ(dialer.winner().ipv4, LAN_IP);
+    ASSERT_EQ(dialer.winner().port, host.lan_port());
+    ASSERT_EQ(host.winner_ip.load(), LAN_IP);
+    ASSERT_TRUE(elapsed < 500);
+    return true;
+}
+
+bool test_dial_ignores_forged_replies() {
+    StandInHost host;
+    ASSERT_TRUE(host.start());
+
+    // A device on the LAN answering every query without knowing the token:
+    // one reply for another token, one replayed from an earlier dial
+    constexpr uint32_t FORGER_IP = 0x7F000003;  // 127.0.0.3
+    int forger = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = make_addr(FORGER_IP, 0);
+    ASSERT_TRUE(bind(forger, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    socklen_t len = sizeof(addr);
+    getsockname(forger, reinterpret_cast<sockaddr*>(&addr), &len);
+    uint16_t forger_port = ntohs(addr.sin_port);
+
+    std::atomic<int> forged{0};
+    std::atomic<bool> running{true};
+    std::thread thread([&] {
+        uint8_t other[16] = {};
+        while (running) {
+            pollfd pfd{forger, POLLIN, 0};
+            if (poll(&pfd, 1, 10) <= 0) continue;
+
+            uint8_t buf[64];
+            sockaddr_in from{};
+            socklen_t from_len = sizeof(from);
+            ssize_t n = recvfrom(forger, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &from_len);
+            LanMessage query;
+            if (n <= 0 || !parse_lan_message(buf, static_cast<size_t>(n), query)) continue;
+
+            LanMessage wrong_token = make_lan_reply(other, query.nonce, forger_port);
+            LanMessage replayed = make_lan_reply(TOKEN, NONCE, forger_port);
+            sendto(forger, &wrong_token, sizeof(wrong_token), 0, reinterpret_cast<sockaddr*>(&from), from_len);
+            sendto(forger, &replayed, sizeof(replayed), 0, reinterpret_cast<sockaddr*>(&from), from_len);
+            forged += 2;
+        }
+    });
+
+    P2pDialer dialer;
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port()),
+                         FORGER_IP, forger_port, DIAL_TIMEOUT_MS);
+    running = false;
+    thread.join();
+    close(forger);
+    ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    ASSERT_TRUE(forged.load() > 0);
+    ASSERT_EQ(dialer.candidate_count(), 1);
+    ASSERT_EQ(dialer.winner().ipv4, EXTERNAL_IP);
+    return true;
+}
+
+bool test_dial_lan_beats_slow_hairpin() {
+    StandInHost host;
+    host.external = ExternalPath::Slow;
+    host.slow_ms = 400;
+    ASSERT_TRUE(host.start());
+
+    P2pDialer dialer;
+    uint64_t start = now_ms();
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port()),
+                         LAN_IP, host.responder_port(), DIAL_TIMEOUT_MS);
+    uint64_t elapsed = now_ms() - start;
+    ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    ASSERT_TRUE(dialer.winner().lan);
+    ASSERT_TRUE(elapsed < 300);
+
+    // The hairpinned auth arrives after the token was consumed
+    for (int i = 0; i < 100 && host.refused.load() == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(host.accepted.load(), 2);
+    ASSERT_EQ(host.refused.load(), 1);
+    ASSERT_EQ(host.winner_ip.load(), LAN_IP);
+    return true;
+}
+
+bool test_dial_external_without_lan_host() {
+    StandInHost host;
+    host.lan_responder = false;
+    ASSERT_TRUE(host.start());
+
+    // Nobody answers on the query port: only the external address is tried
+    P2pDialer dialer;
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port()),
+                         LAN_IP, closed_port(), DIAL_TIMEOUT_MS);
+    ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    ASSERT_EQ(dialer.candidate_count(), 1);
+    ASSERT_TRUE(!dialer.winner().lan);
+    return true;
+}
+
+bool test_dial_wrong_token_fails() {
+    StandInHost host;
+    ASSERT_TRUE(host.start());
+
+    uint8_t other[16] = {1};
+    P2pDialer dialer;
+    uint64_t start = now_ms();
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port(), other),
+                         LAN_IP, host.responder_port(), DIAL_TIMEOUT_MS);
+    uint64_t elapsed = now_ms() - start;
+    ASSERT_EQ(fd, -1);
+
+    // No LAN reply for a foreign token; the refusal ends the dial early
+    ASSERT_EQ(dialer.candidate_count(), 1);
+    ASSERT_TRUE(elapsed < DIAL_TIMEOUT_MS / 2);
+    return true;
+}
+
+bool test_dial_times_out_on_silent_path() {
+    StandInHost host;
+    host.external = ExternalPath::Silent;
+    ASSERT_TRUE(host.start());
+
+    P2pDialer dialer;
+    uint64_t start = now_ms();
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port()), 0, 0, 300);
+    uint64_t elapsed = now_ms() - start;
+    ASSERT_EQ(fd, -1);
+    ASSERT_TRUE(elapsed >= 300);
+    ASSERT_TRUE(elapsed < 1000);
+    return true;
+}
+
+bool test_winner_keeps_following_packets() {
+    StandInHost host;
+    host.external = ExternalPath::Missing;
+    host.trailing_packet = true;
+    ASSERT_TRUE(host.start());
+
+    P2pDialer dialer;
+    int fd = dialer.dial(make_config(EXTERNAL_IP, host.external_port()),
+                         LAN_IP, host.responder_port(), DIAL_TIMEOUT_MS);
+    ASSERT_TRUE(fd >= 0);
+
+    // The socket is handed back blocking, with the next packet unread
+    uint8_t packet[sizeof(LdnHeader) + sizeof(ProxyDataHeader)];
+    bool received = recv_exact(fd, packet, sizeof(packet), 1000);
+    close(fd);
+    ASSERT_TRUE(received);
+
+    LdnHeader header;
+    std::memcpy(&header, packet, sizeof(header));
+    ASSERT_EQ(header.magic, PROTOCOL_MAGIC);
+    ASSERT_EQ(header.type, static_cast<uint8_t>(PacketId::ProxyData));
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  LAN Discovery Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Wire Format Tests:\n");
+    RUN_TEST(test_message_roundtrip);
+    RUN_TEST(test_parse_rejects_invalid);
+    RUN_TEST(test_sha256_vectors);
+    RUN_TEST(test_query_hides_token);
+    RUN_TEST(test_same_subnet);
+    RUN_TEST(test_broadcast_address);
+
+    printf("\nLanResponder Tests:\n");
+    RUN_TEST(test_responder_answers_expected_token_only);
+
+    printf("\nP2pDialer Tests:\n");
+    RUN_TEST(test_dial_external_only);
+    RUN_TEST(test_dial_lan_without_hairpin);
+    RUN_TEST(test_dial_ignores_forged_replies);
+    RUN_TEST(test_dial_lan_beats_slow_hairpin);
+    RUN_TEST(test_dial_external_without_lan_host);
+    RUN_TEST(test_dial_wrong_token_fails);
+    RUN_TEST(test_dial_times_out_on_silent_path);
+    RUN_TEST(test_winner_keeps_following_packets);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
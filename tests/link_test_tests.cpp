@@ -0,0 +1,537 @@
+/**
+ * @file link_test_tests.cpp
+ * @brief Unit tests for the link quality test engine
+ *
+ * The engine is run end-to-end against a local stand-in server that
+ * speaks the RyuLdn framing on 127.0.0.1. The stand-in answers the
+ * handshake, echoes client pings, creates the throw-away access point and
+ * routes ProxyData back to the sender. It can also drop, duplicate or
+ * reorder echoes to check the loss accounting.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Statistics Tests
+ * compute_rtt_stats() and throughput_kbps() on known inputs.
+ *
+ * ### End-to-End Tests
+ * Full runs against the stand-in server: clean link, loss, reordering,
+ * duplication, server without echo support, and no server at all.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "diagnostics/link_test.hpp"
+#include "protocol/ryu_protocol.hpp"
+
+using namespace ryu_ldn;
+using namespace ryu_ldn::diagnostics;
+using namespace ryu_ldn::protocol;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Stand-in Server
+// ============================================================================
+
+/**
+ * @brief Minimal RyuLdn server for a single client
+ *
+ * Runs on its own thread and only implements what the link test needs.
+ */
+class StandInServer {
+public:
+    bool create_network = true;   ///< Answer CreateAccessPoint with Connected
+    bool echo_proxy = true;       ///< Route ProxyData back to the sender
+    uint32_t drop_every = 0;      ///< Drop every Nth echo (0 = never)
+    uint32_t duplicate_every = 0; ///< Send every Nth echo twice (0 = never)
+    bool swap_pairs = false;      ///< Echo probes pairwise in reverse order
+
+    static constexpr uint32_t VIRTUAL_IP = 0x0A720001;  // 10.114.0.1
+
+    StandInServer() = default;
+    ~StandInServer() { stop(); }
+
+    bool start() {
+        m_listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listen_fd < 0) return false;
+
+        int one = 1;
+        setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+        if (listen(m_listen_fd, 1) != 0) return false;
+
+        socklen_t len = sizeof(addr);
+        getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+
+        m_running = true;
+        m_thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        m_running = false;
+        if (m_thread.joinable()) m_thread.join();
+        if (m_listen_fd >= 0) { close(m_listen_fd); m_listen_fd = -1; }
+    }
+
+    uint16_t port() const { return m_port; }
+
+private:
+    int m_listen_fd = -1;
+    uint16_t m_port = 0;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+    uint32_t m_echo_count = 0;
+    std::vector<uint8_t> m_held;
+
+    void send_packet(int fd, PacketId type, const void* payload, size_t size) {
+        std::vector<uint8_t> buf(sizeof(LdnHeader) + size);
+        encode_header(buf.data(), type, static_cast<int32_t>(size));
+        if (size > 0) std::memcpy(buf.data() + sizeof(LdnHeader), payload, size);
+        size_t off = 0;
+        while (off < buf.size()) {
+            ssize_t n = ::send(fd, buf.data() + off, buf.size() - off, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            off += static_cast<size_t>(n);
+        }
+    }
+
+    void handle(int fd, PacketId type, const uint8_t* data, size_t size) {
+        switch (type) {
+            case PacketId::Initialize: {
+                InitializeMessage msg{};
+                msg.mac_address.data[0] = 0x02;
+                send_packet(fd, PacketId::Initialize, &msg, sizeof(msg));
+                break;
+            }
+            case PacketId::Ping: {
+                PingMessage ping{};
+                std::memcpy(&ping, data, sizeof(ping));
+                if (ping.requester != 0) {
+                    send_packet(fd, PacketId::Ping, &ping, sizeof(ping));
+                }
+                break;
+            }
+            case PacketId::CreateAccessPoint: {
+                if (!create_network) break;
+                NetworkInfo info{};
+                info.ldn.node_count = 1;
+                info.ldn.node_count_max = 1;
+                info.ldn.nodes[0].ipv4_address = VIRTUAL_IP;
+                info.ldn.nodes[0].is_connected = 1;
+                send_packet(fd, PacketId::Connected, &info, sizeof(info));
+                break;
+            }
+            case PacketId::ProxyData: {
+                if (!echo_proxy) break;
+                ProxyDataHeader header{};
+                std::memcpy(&header, data, sizeof(header));
+                if (header.info.dest_ipv4 != VIRTUAL_IP) break;
+
+                m_echo_count++;
+                if (drop_every != 0 && m_echo_count % drop_every == 0) break;
+
+                if (swap_pairs) {
+                    if (m_held.empty()) {
+                        m_held.assign(data, data + size);
+                        break;
+                    }
+                    send_packet(fd, PacketId::ProxyData, data, size);
+                    send_packet(fd, PacketId::ProxyData, m_held.data(), m_held.size());
+                    m_held.clear();
+                    break;
+                }
+
+                send_packet(fd, PacketId::ProxyData, data, size);
+                if (duplicate_every != 0 && m_echo_count % duplicate_every == 0) {
+                    send_packet(fd, PacketId::ProxyData, data, size);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void run() {
+        int fd = -1;
+        std::vector<uint8_t> buffer;
+        uint8_t chunk[8192];
+
+        while (m_running) {
+            if (fd < 0) {
+                pollfd pfd{m_listen_fd, POLLIN, 0};
+                if (poll(&pfd, 1, 20) > 0) {
+                    fd = accept(m_listen_fd, nullptr, nullptr);
+                }
+                continue;
+            }
+
+            pollfd pfd{fd, POLLIN, 0};
+            if (poll(&pfd, 1, 20) <= 0) continue;
+
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                close(fd);
+                fd = -1;
+                buffer.clear();
+                continue;
+            }
+            buffer.insert(buffer.end(), chunk, chunk + n);
+
+            while (buffer.size() >= sizeof(LdnHeader)) {
+                LdnHeader header;
+                std::memcpy(&header, buffer.data(), sizeof(header));
+                size_t total = sizeof(LdnHeader) + static_cast<size_t>(header.data_size);
+                if (buffer.size() < total) break;
+                handle(fd, static_cast<PacketId>(header.type),
+                       buffer.data() + sizeof(LdnHeader), total - sizeof(LdnHeader));
+                buffer.erase(buffer.begin(), buffer.begin() + total);
+            }
+        }
+
+        if (fd >= 0) close(fd);
+    }
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint64_t host_now_us(void*) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static bool probe_upnp_yes(void*) { return true; }
+static bool probe_p2p_follow_upnp(bool upnp_ok, void*) { return upnp_ok; }
+
+static LinkTestPlatform make_platform() {
+    LinkTestPlatform platform{};
+    platform.now_us = host_now_us;
+    platform.probe_upnp = probe_upnp_yes;
+    platform.probe_p2p = probe_p2p_follow_upnp;
+    return platform;
+}
+
+static LinkTestConfig make_fast_config() {
+    LinkTestConfig cfg;
+    cfg.ping_count = 10;
+    cfg.ping_interval_ms = 2;
+    cfg.ping_timeout_ms = 300;
+    cfg.echo_count = 64;
+    cfg.echo_payload_size = 512;
+    cfg.echo_window = 8;
+    cfg.echo_timeout_ms = 300;
+    cfg.phase_timeout_ms = 1000;
+    return cfg;
+}
+
+static network::RyuLdnClientConfig make_client_config(uint16_t port) {
+    network::RyuLdnClientConfig cfg;
+    std::strncpy(cfg.host, "127.0.0.1", sizeof(cfg.host) - 1);
+    cfg.port = port;
+    cfg.connect_timeout_ms = 1000;
+    return cfg;
+}
+
+/**
+ * @brief Drive a test until it finishes (bounded to 10 seconds)
+ */
+static void run_to_completion(LinkTest& test) {
+    uint64_t deadline = host_now_us(nullptr) + 10'000'000;
+    while (test.update() && host_now_us(nullptr) < deadline) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+// ============================================================================
+// Statistics Tests
+// ============================================================================
+
+bool test_rtt_stats_empty() {
+    RttStats stats;
+    compute_rtt_stats(nullptr, 0, stats);
+    ASSERT_EQ(stats.min_us, 0);
+    ASSERT_EQ(stats.max_us, 0);
+    ASSERT_EQ(stats.jitter_us, 0);
+    return true;
+}
+
+bool test_rtt_stats_known_values() {
+    // Arrival order matters for jitter, not for percentiles
+    const uint32_t samples[] = {300, 100, 200, 500, 400, 600, 700, 800, 900, 1000};
+    RttStats stats;
+    compute_rtt_stats(samples, 10, stats);
+
+    ASSERT_EQ(stats.min_us, 100);
+    ASSERT_EQ(stats.max_us, 1000);
+    ASSERT_EQ(stats.avg_us, 550);
+    ASSERT_EQ(stats.p50_us, 500);
+    ASSERT_EQ(stats.p95_us, 1000);
+    ASSERT_EQ(stats.p99_us, 1000);
+    // 200+100+300+100+200+100+100+100+100 = 1300 over 9 deltas
+    ASSERT_EQ(stats.jitter_us, 1300 / 9);
+    return true;
+}
+
+bool test_rtt_stats_single_sample() {
+    const uint32_t sample = 4242;
+    RttStats stats;
+    compute_rtt_stats(&sample, 1, stats);
+    ASSERT_EQ(stats.min_us, 4242);
+    ASSERT_EQ(stats.p50_us, 4242);
+    ASSERT_EQ(stats.p99_us, 4242);
+    ASSERT_EQ(stats.jitter_us, 0);
+    return true;
+}
+
+bool test_throughput_kbps() {
+    ASSERT_EQ(throughput_kbps(125000, 1000000), 1000);  // 1 Mbit in 1 s
+    ASSERT_EQ(throughput_kbps(1000, 0), 0);
+    ASSERT_EQ(throughput_kbps(0, 1000), 0);
+    return true;
+}
+
+// ============================================================================
+// End-to-End Tests
+// ============================================================================
+
+bool test_clean_link() {
+    StandInServer server;
+    ASSERT_TRUE(server.start());
+
+    LinkTest test;
+    ASSERT_TRUE(test.start(make_client_config(server.port()), make_fast_config(), make_platform()));
+    run_to_completion(test);
+
+    const LinkTestReport& r = test.get_report();
+    ASSERT_EQ(r.state, LinkTestState::Complete);
+    ASSERT_EQ(r.error, LinkTestError::None);
+    ASSERT_EQ(r.pings_sent, 10);
+    ASSERT_EQ(r.pings_received, 10);
+    ASSERT_TRUE(r.rtt.min_us <= r.rtt.p50_us);
+    ASSERT_TRUE(r.rtt.p50_us <= r.rtt.p95_us);
+    ASSERT_TRUE(r.rtt.p95_us <= r.rtt.max_us);
+    ASSERT_EQ(r.echo_available, 1);
+    ASSERT_EQ(r.echo_sent, 64);
+    ASSERT_EQ(r.echo_received, 64);
+    ASSERT_EQ(r.echo_lost, 0);
+    ASSERT_EQ(r.echo_reordered, 0);
+    ASSERT_EQ(r.echo_duplicated, 0);
+    ASSERT_TRUE(r.upload_kbps > 0);
+    ASSERT_TRUE(r.download_kbps > 0);
+    ASSERT_EQ(r.upnp_available, 1);
+    ASSERT_EQ(r.p2p_possible, 1);
+
+    server.stop();
+    return true;
+}
+
+bool test_lossy_link() {
+    StandInServer server;
+    server.drop_every = 8;
+    ASSERT_TRUE(server.start());
+
+    LinkTest test;
+    ASSERT_TRUE(test.start(make_client_config(server.port()), make_fast_config(), make_platform()));
+    run_to_completion(test);
+
+    const LinkTestReport& r = test.get_report();
+    ASSERT_EQ(r.state, LinkTestState::Complete);
+    ASSERT_EQ(r.echo_sent, 64);
+    ASSERT_EQ(r.echo_lost, 8);
+    ASSERT_EQ(r.echo_received, 56);
+
+    server.stop();
+    return true;
+}
+
+bool test_reordering_link() {
+    StandInServer server;
+    server.swap_pairs = true;
+    ASSERT_TRUE(server.start());
+
+    LinkTest test;
+    ASSERT_TRUE(test.start(make_client_config(server.port()), make_fast_config(), make_platform()));
+    run_to_completion(test);
+
+    const LinkTestReport& r = test.get_report();
+    ASSERT_EQ(r.state, LinkTestState::Complete);
+    ASSERT_EQ(r.echo_received, 64);
+    ASSERT_EQ(r.echo_lost, 0);
+    // Every pair arrives high-then-low
+    ASSERT_EQ(r.echo_reordered, 32);
+
+    server.stop();
+    return true;
+}
+
+bool test_duplicating_link() {
+    StandInServer server;
+    server.duplicate_every = 16;
+    ASSERT_TRUE(server.start());
+
+    LinkTest test;
+    ASSERT_TRUE(test.start(make_client_config(server.port()), make_fast_config(), make_platform()));
+    run_to_completion(test);
+
+    const LinkTestReport& r = test.get_report();
+    ASSERT_EQ(r.state, LinkTestState::Complete);
+    ASSERT_EQ(r.echo_received, 64);
+    ASSERT_EQ(r.echo_lost, 0);
+    ASSERT_TRUE(r.echo_duplicated >= 3);
+
+    server.stop();
+    return true;
+}
+
+bool test_server_without_echo() {
+    StandInServer server;
+    server.create_network = false;
+    ASSERT_TRUE(server.start());
+
+    LinkTestPlatform platform = make_platform();
+    platform.probe_upnp = nullptr;
+
+    LinkTest test;
+    ASSERT_TRUE(test.start(make_client_config(server.port()), make_fast_config(), platform));
+    run_to_completion(test);
+
+    const LinkTestReport& r = test.get_report();
+    ASSERT_EQ(r.state, LinkTestState::Complete);
+    ASSERT_EQ(r.pings_received, 10);
+    ASSERT_EQ(r.echo_available, 0);
+    ASSERT_EQ(r.echo_sent, 0);
+    ASSERT_EQ(r.upnp_available, 0);
+    ASSERT_EQ(r.p2p_possible, 0);
+
+    server.stop();
+    return true;
+}
+
+bool test_no_server() {
+    // Grab a free port, then close it so nothing is listening
+    StandInServer server;
+    ASSERT_TRUE(server.start());
+    uint16_t port = server.port();
+    server.stop();
+
+    LinkTest test;
+    ASSERT_TRUE(!test.start(make_client_config(port), make_fast_config(), make_platform()));
+    ASSERT_EQ(test.get_report().state, LinkTestState::Failed);
+    ASSERT_EQ(test.get_report().error, LinkTestError::ConnectFailed);
+    ASSERT_TRUE(!test.is_running());
+    return true;
+}
+
+bool test_restart_resets_report() {
+    StandInServer server;
+    ASSERT_TRUE(server.start());
+
+    LinkTest test;
+    ASSERT_TRUE(test.start(make_client_config(server.port()), make_fast_config(), make_platform()));
+    run_to_completion(test);
+    ASSERT_EQ(test.get_report().echo_received, 64);
+
+    LinkTestConfig cfg = make_fast_config();
+    cfg.echo_count = 0;
+    ASSERT_TRUE(test.start(make_client_config(server.port()), cfg, make_platform()));
+    run_to_completion(test);
+    ASSERT_EQ(test.get_report().state, LinkTestState::Complete);
+    ASSERT_EQ(test.get_report().echo_received, 0);
+    ASSERT_EQ(test.get_report().pings_received, 10);
+
+    server.stop();
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Link Test Engine Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Statistics Tests:\n");
+    RUN_TEST(test_rtt_stats_empty);
+    RUN_TEST(test_rtt_stats_known_values);
+    RUN_TEST(test_rtt_stats_single_sample);
+    RUN_TEST(test_throughput_kbps);
+
+    printf("\nEnd-to-End Tests:\n");
+    RUN_TEST(test_clean_link);
+    RUN_TEST(test_lossy_link);
+    RUN_TEST(test_reordering_link);
+    RUN_TEST(test_duplicating_link);
+    RUN_TEST(test_server_without_echo);
+    RUN_TEST(test_no_server);
+    RUN_TEST(test_restart_resets_report);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
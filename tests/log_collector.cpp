@@ -0,0 +1,139 @@
+/**
+ * @file log_collector.cpp
+ * @brief Host collector for the sysmodule UDP log stream
+ *
+ * Receives the datagrams sent by LogUdpSink (see debug/log_udp_sink.hpp)
+ * and prints one line per record. Gaps are reported inline:
+ *
+ * - `--- lost N datagram(s) ---`: sequence gap, datagrams lost on the network
+ * - `--- console dropped N record(s) ---`: the console staging buffer overflowed
+ *
+ * A sequence that goes back to 0 means the sysmodule restarted.
+ *
+ * ## Usage
+ *
+ * ```
+ * make run_log_collector
+ * ./run_log_collector                       # listen on 5140
+ * ./run_log_collector 5140 session.log      # also append to a file
+ * ```
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "debug/log_udp_sink.hpp"
+
+using namespace ryu_ldn::debug;
+
+namespace {
+
+FILE* g_output_file = nullptr;
+
+void Emit(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+void Emit(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    std::vprintf(format, args);
+    va_end(args);
+    std::fflush(stdout);
+
+    if (g_output_file != nullptr) {
+        va_start(args, format);
+        std::vfprintf(g_output_file, format, args);
+        va_end(args);
+        std::fflush(g_output_file);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint16_t port = LOG_UDP_DEFAULT_PORT;
+    if (argc > 1) {
+        port = static_cast<uint16_t>(std::atoi(argv[1]));
+    }
+    if (argc > 2) {
+        g_output_file = std::fopen(argv[2], "a");
+        if (g_output_file == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::perror("socket");
+        return 1;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::perror("bind");
+        return 1;
+    }
+
+    std::fprintf(stderr, "Listening for ryu_ldn_nx logs on UDP %u\n", port);
+
+    // Per-console state is overkill for a debugging tool: track the last sender
+    uint32_t last_source = 0;
+    uint32_t next_sequence = 0;
+    uint32_t last_dropped = 0;
+    bool have_sequence = false;
+
+    uint8_t datagram[LOG_UDP_MAX_DATAGRAM];
+    while (true) {
+        sockaddr_in from{};
+        socklen_t from_len = sizeof(from);
+        ssize_t received = ::recvfrom(fd, datagram, sizeof(datagram), 0,
+                                      reinterpret_cast<sockaddr*>(&from), &from_len);
+        if (received < 0) {
+            std::perror("recvfrom");
+            return 1;
+        }
+
+        LogDatagramReader reader(datagram, static_cast<size_t>(received));
+        if (!reader.valid()) {
+            continue;
+        }
+        const LogDatagramHeader& header = reader.header();
+
+        char source[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &from.sin_addr, source, sizeof(source));
+
+        if (!have_sequence || from.sin_addr.s_addr != last_source || header.sequence == 0) {
+            Emit("=== %s (sequence %u) ===\n", source, header.sequence);
+            last_dropped = 0;
+        } else if (header.sequence != next_sequence) {
+            Emit("--- lost %u datagram(s) ---\n", header.sequence - next_sequence);
+        }
+        if (header.dropped > last_dropped) {
+            Emit("--- console dropped %u record(s) ---\n", header.dropped - last_dropped);
+        }
+
+        last_source = from.sin_addr.s_addr;
+        next_sequence = header.sequence + 1;
+        last_dropped = header.dropped;
+        have_sequence = true;
+
+        LogRecordView record;
+        while (reader.next(record)) {
+            Emit("%10u.%03u %.*s\n", record.time_ms / 1000, record.time_ms % 1000,
+                 static_cast<int>(record.length), record.text);
+        }
+    }
+}
@@ -0,0 +1,395 @@
+/**
+ * @file log_udp_sink_tests.cpp
+ * @brief Unit tests for the UDP log sink
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Wire Format Tests
+ * LogDatagramReader on valid, foreign and truncated datagrams.
+ *
+ * ### Sink Tests
+ * Start/stop, loopback delivery, batching, sequence numbers, overflow
+ * accounting, Logger forwarding.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "debug/log_udp_sink.hpp"
+#include "config/config.hpp"
+
+using namespace ryu_ldn::debug;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+/**
+ * @brief UDP socket on 127.0.0.1 standing in for the collector
+ */
+class Collector {
+public:
+    Collector() {
+        m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+
+        int buffer = 1 << 20;
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    }
+    ~Collector() { ::close(m_fd); }
+
+    uint16_t port() const { return m_port; }
+
+    /**
+     * @brief Receive one datagram, empty on timeout
+     */
+    std::vector<uint8_t> receive(int timeout_ms) {
+        pollfd pfd{m_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, timeout_ms) <= 0) {
+            return {};
+        }
+        std::vector<uint8_t> data(LOG_UDP_MAX_DATAGRAM + 64);
+        ssize_t n = ::recv(m_fd, data.data(), data.size(), 0);
+        data.resize(n > 0 ? static_cast<size_t>(n) : 0);
+        return data;
+    }
+
+private:
+    int m_fd;
+    uint16_t m_port;
+};
+
+/**
+ * @brief Build a datagram by hand
+ */
+std::vector<uint8_t> MakeDatagram(uint32_t sequence, const std::vector<std::string>& messages) {
+    std::vector<uint8_t> data(sizeof(LogDatagramHeader));
+    LogDatagramHeader header{};
+    header.magic = LOG_UDP_MAGIC;
+    header.version = LOG_UDP_VERSION;
+    header.record_count = static_cast<uint16_t>(messages.size());
+    header.sequence = sequence;
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    for (const std::string& message : messages) {
+        LogRecordHeader record{};
+        record.time_ms = 1234;
+        record.level = static_cast<uint8_t>(LogLevel::Warning);
+        record.length = static_cast<uint16_t>(message.size());
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(&record);
+        data.insert(data.end(), raw, raw + sizeof(record));
+        data.insert(data.end(), message.begin(), message.end());
+    }
+    return data;
+}
+
+} // namespace
+
+// ============================================================================
+// Wire Format Tests
+// ============================================================================
+
+bool test_reader_decodes_records() {
+    std::vector<uint8_t> data = MakeDatagram(7, {"first", "second message"});
+    LogDatagramReader reader(data.data(), data.size());
+    ASSERT_TRUE(reader.valid());
+    ASSERT_EQ(reader.header().sequence, 7);
+    ASSERT_EQ(reader.header().record_count, 2);
+
+    LogRecordView record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.time_ms, 1234);
+    ASSERT_EQ(static_cast<int>(record.level), static_cast<int>(LogLevel::Warning));
+    ASSERT_TRUE(std::string(record.text, record.length) == "first");
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_TRUE(std::string(record.text, record.length) == "second message");
+    ASSERT_FALSE(reader.next(record));
+    return true;
+}
+
+bool test_reader_rejects_foreign_datagram() {
+    std::vector<uint8_t> data = MakeDatagram(0, {"x"});
+    data[0] ^= 0xFF;
+    LogDatagramReader bad_magic(data.data(), data.size());
+    ASSERT_FALSE(bad_magic.valid());
+
+    uint8_t tiny[4] = {};
+    LogDatagramReader too_short(tiny, sizeof(tiny));
+    ASSERT_FALSE(too_short.valid());
+    return true;
+}
+
+bool test_reader_stops_on_truncated_record() {
+    std::vector<uint8_t> data = MakeDatagram(0, {"complete", "truncated record"});
+    data.resize(data.size() - 4);
+    LogDatagramReader reader(data.data(), data.size());
+    ASSERT_TRUE(reader.valid());
+
+    LogRecordView record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_FALSE(reader.next(record));
+    ASSERT_FALSE(reader.next(record));
+    return true;
+}
+
+// ============================================================================
+// Sink Tests
+// ============================================================================
+
+bool test_start_rejects_bad_address() {
+    LogUdpSink sink;
+    ASSERT_FALSE(sink.start("not an address", 5140));
+    ASSERT_FALSE(sink.start("127.0.0.1", 0));
+    ASSERT_FALSE(sink.start(nullptr, 5140));
+    ASSERT_FALSE(sink.is_running());
+
+    // Writes to a stopped sink are ignored
+    sink.write(LogLevel::Error, "ignored");
+    ASSERT_EQ(sink.get_dropped_count(), 0);
+    return true;
+}
+
+bool test_delivers_over_loopback() {
+    Collector collector;
+    LogUdpSink sink;
+    ASSERT_TRUE(sink.start("127.0.0.1", collector.port()));
+
+    sink.write(LogLevel::Info, "[000001] [INFO] hello");
+    sink.write(LogLevel::Error, "[000002] [ERROR] world");
+
+    // Delivered within one flush period
+    std::vector<uint8_t> data = collector.receive(LOG_UDP_FLUSH_MS * 10);
+    sink.stop();
+
+    LogDatagramReader reader(data.data(), data.size());
+    ASSERT_TRUE(reader.valid());
+    ASSERT_EQ(reader.header().sequence, 0);
+    ASSERT_EQ(reader.header().dropped, 0);
+
+    LogRecordView record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(static_cast<int>(record.level), static_cast<int>(LogLevel::Info));
+    ASSERT_TRUE(std::string(record.text, record.length) == "[000001] [INFO] hello");
+
+    // Normally batched with the first, unless a flush fell in between
+    if (!reader.next(record)) {
+        data = collector.receive(200);
+        LogDatagramReader second(data.data(), data.size());
+        ASSERT_EQ(second.header().sequence, 1);
+        ASSERT_TRUE(second.next(record));
+    }
+    ASSERT_TRUE(std::string(record.text, record.length) == "[000002] [ERROR] world");
+    return true;
+}
+
+bool test_batches_into_sequenced_datagrams() {
+    Collector collector;
+    LogUdpSink sink;
+    ASSERT_TRUE(sink.start("127.0.0.1", collector.port()));
+
+    // 60 x ~120 byte records: fits the staging buffer, needs several datagrams
+    constexpr int kMessages = 60;
+    char message[MAX_LOG_MESSAGE_LENGTH];
+    for (int i = 0; i < kMessages; i++) {
+        std::snprintf(message, sizeof(message), "[%06d] [INFO] %090d", i, i);
+        sink.write(LogLevel::Info, message);
+    }
+    sink.stop();
+
+    int records = 0;
+    uint32_t expected_sequence = 0;
+    bool ordered = true;
+    std::vector<uint8_t> data;
+    while (!(data = collector.receive(200)).empty()) {
+        ASSERT_TRUE(data.size() <= LOG_UDP_MAX_DATAGRAM);
+        LogDatagramReader reader(data.data(), data.size());
+        ASSERT_TRUE(reader.valid());
+        ASSERT_EQ(reader.header().sequence, expected_sequence);
+        expected_sequence++;
+
+        LogRecordView record;
+        while (reader.next(record)) {
+            std::snprintf(message, sizeof(message), "[%06d] [INFO] %090d", records, records);
+            ordered = ordered && std::string(record.text, record.length) == message;
+            records++;
+        }
+    }
+
+    ASSERT_EQ(records, kMessages);
+    ASSERT_TRUE(ordered);
+    ASSERT_TRUE(expected_sequence > 1);
+    ASSERT_EQ(sink.get_sent_count(), expected_sequence);
+    return true;
+}
+
+bool test_overflow_drops_and_reports() {
+    Collector collector;
+    LogUdpSink sink;
+    ASSERT_TRUE(sink.start("127.0.0.1", collector.port()));
+
+    // Far more than the staging buffer between two flushes
+    std::string message(MAX_LOG_MESSAGE_LENGTH - 1, 'x');
+    constexpr int kMessages = 1000;
+    for (int i = 0; i < kMessages; i++) {
+        sink.write(LogLevel::Verbose, message.c_str());
+    }
+    uint32_t dropped = sink.get_dropped_count();
+    sink.stop();
+    ASSERT_TRUE(dropped > 0);
+
+    int records = 0;
+    uint32_t reported = 0;
+    std::vector<uint8_t> data;
+    while (!(data = collector.receive(200)).empty()) {
+        LogDatagramReader reader(data.data(), data.size());
+        ASSERT_TRUE(reader.valid());
+        reported = reader.header().dropped;
+        LogRecordView record;
+        while (reader.next(record)) {
+            records++;
+        }
+    }
+
+    // Every message is either delivered or counted as dropped
+    ASSERT_EQ(records + sink.get_dropped_count(), kMessages);
+    ASSERT_EQ(reported, sink.get_dropped_count());
+    return true;
+}
+
+bool test_long_message_truncated() {
+    Collector collector;
+    LogUdpSink sink;
+    ASSERT_TRUE(sink.start("127.0.0.1", collector.port()));
+
+    std::string message(MAX_LOG_MESSAGE_LENGTH * 2, 'y');
+    sink.write(LogLevel::Info, message.c_str());
+    sink.stop();
+
+    std::vector<uint8_t> data = collector.receive(200);
+    LogDatagramReader reader(data.data(), data.size());
+    LogRecordView record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.length, MAX_LOG_MESSAGE_LENGTH);
+    return true;
+}
+
+bool test_logger_forwards_to_sink() {
+    Collector collector;
+    LogUdpSink sink;
+    ASSERT_TRUE(sink.start("127.0.0.1", collector.port()));
+
+    ryu_ldn::config::DebugConfig config{};
+    config.enabled = true;
+    config.level = static_cast<uint32_t>(LogLevel::Info);
+    config.log_to_file = false;
+
+    Logger logger;
+    logger.init(config, "/tmp/ryu_log_udp_sink_tests.log");
+    logger.set_sink(&sink);
+    logger.log(LogLevel::Warning, "peer %d joined", 3);
+    logger.log(LogLevel::Verbose, "filtered out");
+    logger.set_sink(nullptr);
+    logger.log(LogLevel::Error, "not forwarded");
+    sink.stop();
+
+    std::vector<uint8_t> data = collector.receive(200);
+    LogDatagramReader reader(data.data(), data.size());
+    ASSERT_TRUE(reader.valid());
+    ASSERT_EQ(reader.header().record_count, 1);
+
+    LogRecordView record;
+    ASSERT_TRUE(reader.next(record));
+    std::string text(record.text, record.length);
+    ASSERT_TRUE(text.find("[WARN] peer 3 joined") != std::string::npos);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  UDP Log Sink Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Wire Format Tests:\n");
+    RUN_TEST(test_reader_decodes_records);
+    RUN_TEST(test_reader_rejects_foreign_datagram);
+    RUN_TEST(test_reader_stops_on_truncated_record);
+
+    printf("\nSink Tests:\n");
+    RUN_TEST(test_start_rejects_bad_address);
+    RUN_TEST(test_delivers_over_loopback);
+    RUN_TEST(test_batches_into_sequenced_datagrams);
+    RUN_TEST(test_overflow_drops_and_reports);
+    RUN_TEST(test_long_message_truncated);
+    RUN_TEST(test_logger_forwards_to_sink);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,407 @@
+/**
+ * @file metrics_history_tests.cpp
+ * @brief Unit tests for the metrics time-series store
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Rollup Tests
+ * Second points (min/avg/max/p99), empty seconds, minute merge.
+ *
+ * ### Ring Tests
+ * Wrap-around, long gaps, read order.
+ *
+ * ### Sampling Tests
+ * Counter deltas to rates, RTT from histogram observations, gauge.
+ *
+ * ### Serialization Tests
+ * Header, per-series layout, buffer too small.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "diagnostics/metrics_history.hpp"
+
+using namespace ryu_ldn::diagnostics;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+/// The store is ~92 KiB, keep it off the stack
+std::unique_ptr<MetricsHistory> NewHistory() {
+    return std::make_unique<MetricsHistory>();
+}
+
+HistoryPoint Newest(const MetricsHistory& history, HistoryResolution resolution, HistorySeries series) {
+    std::vector<HistoryPoint> points(HISTORY_SECOND_POINTS);
+    size_t count = history.read(resolution, series, points.data(), points.size());
+    return count > 0 ? points[count - 1] : HistoryPoint{};
+}
+
+} // namespace
+
+// ============================================================================
+// Rollup Tests
+// ============================================================================
+
+bool test_second_rollup() {
+    auto history = NewHistory();
+    // 100 samples in second 10: 1..100
+    for (uint64_t i = 1; i <= 100; i++) {
+        history->record(HistorySeries::RttMs, i, 10000 + i * 5);
+    }
+    ASSERT_EQ(history->size(HistoryResolution::Second), 0);
+
+    history->advance(11000);
+    ASSERT_EQ(history->size(HistoryResolution::Second), 1);
+
+    HistoryPoint point = Newest(*history, HistoryResolution::Second, HistorySeries::RttMs);
+    ASSERT_EQ(point.samples, 100);
+    ASSERT_EQ(point.min, 1);
+    ASSERT_EQ(point.max, 100);
+    ASSERT_EQ(point.avg, 50);
+    // Only the first HISTORY_SAMPLES_PER_SECOND samples are kept for the p99
+    ASSERT_EQ(point.p99, HISTORY_SAMPLES_PER_SECOND);
+
+    // Series without samples get an empty point in the same second
+    HistoryPoint other = Newest(*history, HistoryResolution::Second, HistorySeries::TxBytes);
+    ASSERT_EQ(other.samples, 0);
+    return true;
+}
+
+bool test_p99_nearest_rank() {
+    auto history = NewHistory();
+    for (uint64_t i = 0; i < 19; i++) {
+        history->record(HistorySeries::QueuedBytes, 10, 5000);
+    }
+    history->record(HistorySeries::QueuedBytes, 900, 5000);
+    history->advance(6000);
+
+    HistoryPoint point = Newest(*history, HistoryResolution::Second, HistorySeries::QueuedBytes);
+    ASSERT_EQ(point.p99, 900);
+    ASSERT_EQ(point.avg, (19 * 10 + 900) / 20);
+    return true;
+}
+
+bool test_empty_seconds_fill_gap() {
+    auto history = NewHistory();
+    history->record(HistorySeries::TxBytes, 5, 1000);
+    history->record(HistorySeries::TxBytes, 7, 5500);  // 4 seconds later
+
+    ASSERT_EQ(history->size(HistoryResolution::Second), 4);
+    HistoryPoint points[4];
+    ASSERT_EQ(history->read(HistoryResolution::Second, HistorySeries::TxBytes, points, 4), 4);
+    ASSERT_EQ(points[0].samples, 1);
+    ASSERT_EQ(points[0].max, 5);
+    ASSERT_EQ(points[1].samples, 0);
+    ASSERT_EQ(points[2].samples, 0);
+    ASSERT_EQ(points[3].samples, 0);
+    return true;
+}
+
+bool test_minute_rollup() {
+    auto history = NewHistory();
+    // Seconds 60..119: one sample of value = second - 59 (1..60), three at second 90
+    for (uint64_t second = 60; second < 120; second++) {
+        history->record(HistorySeries::Packets, second - 59, second * 1000);
+    }
+    history->record(HistorySeries::Packets, 31, 90 * 1000 + 500);
+    history->record(HistorySeries::Packets, 31, 90 * 1000 + 600);
+    history->advance(120 * 1000);
+
+    ASSERT_EQ(history->size(HistoryResolution::Second), 60);
+    ASSERT_EQ(history->size(HistoryResolution::Minute), 1);
+
+    HistoryPoint minute = Newest(*history, HistoryResolution::Minute, HistorySeries::Packets);
+    ASSERT_EQ(minute.samples, 62);
+    ASSERT_EQ(minute.min, 1);
+    ASSERT_EQ(minute.max, 60);
+    ASSERT_EQ(minute.avg, (60 * 61 / 2 + 62) / 62);
+    ASSERT_EQ(minute.p99, 60);
+    return true;
+}
+
+bool test_partial_first_minute() {
+    auto history = NewHistory();
+    // Start at second 50: the first minute point closes at second 60
+    history->record(HistorySeries::Drops, 3, 50 * 1000);
+    history->advance(59 * 1000);
+    ASSERT_EQ(history->size(HistoryResolution::Minute), 0);
+    history->advance(60 * 1000);
+    ASSERT_EQ(history->size(HistoryResolution::Minute), 1);
+
+    HistoryPoint minute = Newest(*history, HistoryResolution::Minute, HistorySeries::Drops);
+    ASSERT_EQ(minute.samples, 1);
+    ASSERT_EQ(minute.max, 3);
+    return true;
+}
+
+// ============================================================================
+// Ring Tests
+// ============================================================================
+
+bool test_second_ring_wraps() {
+    auto history = NewHistory();
+    const uint64_t seconds = HISTORY_SECOND_POINTS + 50;
+    for (uint64_t second = 0; second <= seconds; second++) {
+        history->record(HistorySeries::RxBytes, second, second * 1000);
+    }
+
+    ASSERT_EQ(history->size(HistoryResolution::Second), HISTORY_SECOND_POINTS);
+    std::vector<HistoryPoint> points(HISTORY_SECOND_POINTS);
+    ASSERT_EQ(history->read(HistoryResolution::Second, HistorySeries::RxBytes,
+                            points.data(), points.size()), HISTORY_SECOND_POINTS);
+    // Oldest first: seconds 50 .. seconds-1 (the last one is still open)
+    ASSERT_EQ(points.front().max, 50);
+    ASSERT_EQ(points.back().max, seconds - 1);
+
+    // Asking for fewer points returns the newest ones
+    HistoryPoint last[2];
+    ASSERT_EQ(history->read(HistoryResolution::Second, HistorySeries::RxBytes, last, 2), 2);
+    ASSERT_EQ(last[0].max, seconds - 2);
+    ASSERT_EQ(last[1].max, seconds - 1);
+    return true;
+}
+
+bool test_long_gap_resets() {
+    auto history = NewHistory();
+    history->record(HistorySeries::RttMs, 20, 1000);
+    history->advance(200 * 1000);
+    ASSERT_TRUE(history->size(HistoryResolution::Second) > 0);
+
+    // Longer than the minute ring: nothing stored would survive
+    const uint64_t later_ms = (200 + HISTORY_MINUTE_POINTS * 60 + 1) * 1000ULL;
+    history->record(HistorySeries::RttMs, 30, later_ms);
+    ASSERT_EQ(history->size(HistoryResolution::Second), 0);
+    ASSERT_EQ(history->size(HistoryResolution::Minute), 0);
+
+    history->advance(later_ms + 1000);
+    HistoryPoint point = Newest(*history, HistoryResolution::Second, HistorySeries::RttMs);
+    ASSERT_EQ(point.samples, 1);
+    ASSERT_EQ(point.max, 30);
+    return true;
+}
+
+bool test_invalid_series() {
+    auto history = NewHistory();
+    history->record(HistorySeries::Count, 1, 1000);
+    HistoryPoint point;
+    ASSERT_EQ(history->read(HistoryResolution::Second, HistorySeries::Count, &point, 1), 0);
+    ASSERT_TRUE(history_series_to_string(HistorySeries::Count)[0] == 'I');
+    return true;
+}
+
+// ============================================================================
+// Sampling Tests
+// ============================================================================
+
+bool test_sample_rates() {
+    auto history = NewHistory();
+    auto metrics = std::make_unique<Metrics>();
+
+    // Baseline only
+    history->sample(*metrics, 10000);
+
+    // 100 ms ticks: 1000 bytes and 2 packets each way per tick
+    for (uint64_t tick = 1; tick <= 10; tick++) {
+        metrics->proxy_rx_bytes.Add(1000);
+        metrics->proxy_tx_bytes.Add(500);
+        metrics->proxy_rx_packets.Add(2);
+        metrics->proxy_tx_packets.Add(2);
+        if (tick == 5) {
+            metrics->proxy_rx_dropped.Add(1);
+        }
+        metrics->proxy_queued_bytes.Set(static_cast<int64_t>(tick * 100));
+        history->sample(*metrics, 10000 + tick * 100 - 1);
+    }
+    history->advance(11000);
+
+    HistoryPoint rx = Newest(*history, HistoryResolution::Second, HistorySeries::RxBytes);
+    HistoryPoint tx = Newest(*history, HistoryResolution::Second, HistorySeries::TxBytes);
+    HistoryPoint packets = Newest(*history, HistoryResolution::Second, HistorySeries::Packets);
+    HistoryPoint drops = Newest(*history, HistoryResolution::Second, HistorySeries::Drops);
+    HistoryPoint queued = Newest(*history, HistoryResolution::Second, HistorySeries::QueuedBytes);
+
+    // The first tick is 99 ms long, the others 100 ms
+    ASSERT_EQ(rx.samples, 10);
+    ASSERT_EQ(rx.min, 10000);
+    ASSERT_EQ(rx.max, 1000 * 1000 / 99);
+    ASSERT_EQ(tx.min, 5000);
+    ASSERT_EQ(packets.min, 40);
+    ASSERT_EQ(drops.min, 0);
+    ASSERT_EQ(drops.max, 10);
+    ASSERT_EQ(queued.min, 100);
+    ASSERT_EQ(queued.max, 1000);
+    return true;
+}
+
+bool test_sample_rtt() {
+    auto history = NewHistory();
+    auto metrics = std::make_unique<Metrics>();
+    metrics->server_rtt_ms.Observe(500);  // Before the baseline, not counted
+
+    history->sample(*metrics, 1000);
+    history->sample(*metrics, 1100);      // No new ping
+    metrics->server_rtt_ms.Observe(40);
+    history->sample(*metrics, 1200);
+    metrics->server_rtt_ms.Observe(20);
+    metrics->server_rtt_ms.Observe(30);
+    history->sample(*metrics, 1300);      // Two pings: mean
+    history->advance(2000);
+
+    HistoryPoint rtt = Newest(*history, HistoryResolution::Second, HistorySeries::RttMs);
+    ASSERT_EQ(rtt.samples, 2);
+    ASSERT_EQ(rtt.min, 25);
+    ASSERT_EQ(rtt.max, 40);
+    return true;
+}
+
+// ============================================================================
+// Serialization Tests
+// ============================================================================
+
+bool test_serialize_layout() {
+    auto history = NewHistory();
+    for (uint64_t second = 0; second < 5; second++) {
+        history->record(HistorySeries::RttMs, 10 + second, second * 1000);
+        history->record(HistorySeries::Drops, 100 + second, second * 1000);
+    }
+    history->advance(5000);
+
+    std::vector<uint8_t> buffer(4096);
+    size_t written = history->serialize(HistoryResolution::Second, 3, buffer.data(), buffer.size());
+    const size_t series = static_cast<size_t>(HistorySeries::Count);
+    ASSERT_EQ(written, sizeof(HistoryHeader) + series * 3 * sizeof(HistoryPoint));
+
+    HistoryHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    ASSERT_EQ(header.resolution, 0);
+    ASSERT_EQ(header.series_count, series);
+    ASSERT_EQ(header.point_count, 3);
+    ASSERT_EQ(header.interval_s, 1);
+    ASSERT_EQ(header.newest_time_s, 5);
+
+    HistoryPoint points[3 * static_cast<size_t>(HistorySeries::Count)];
+    std::memcpy(points, buffer.data() + sizeof(header), sizeof(points));
+    // RttMs block first, newest three seconds (2, 3, 4)
+    ASSERT_EQ(points[0].max, 12);
+    ASSERT_EQ(points[2].max, 14);
+    // Drops block last
+    const size_t drops = static_cast<size_t>(HistorySeries::Drops) * 3;
+    ASSERT_EQ(points[drops].max, 102);
+    ASSERT_EQ(points[drops + 2].max, 104);
+    return true;
+}
+
+bool test_serialize_small_buffer() {
+    auto history = NewHistory();
+    for (uint64_t second = 0; second < 20; second++) {
+        history->record(HistorySeries::TxBytes, second, second * 1000);
+    }
+
+    uint8_t tiny[8];
+    ASSERT_EQ(history->serialize(HistoryResolution::Second, 10, tiny, sizeof(tiny)), 0);
+
+    // Room for the header and two points per series
+    const size_t series = static_cast<size_t>(HistorySeries::Count);
+    std::vector<uint8_t> buffer(sizeof(HistoryHeader) + series * 2 * sizeof(HistoryPoint) + 10);
+    size_t written = history->serialize(HistoryResolution::Second, 10, buffer.data(), buffer.size());
+    HistoryHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    ASSERT_EQ(header.point_count, 2);
+    ASSERT_EQ(written, sizeof(HistoryHeader) + series * 2 * sizeof(HistoryPoint));
+
+    // Minute ring still empty
+    written = history->serialize(HistoryResolution::Minute, 10, buffer.data(), buffer.size());
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    ASSERT_EQ(header.point_count, 0);
+    ASSERT_EQ(header.interval_s, 60);
+    ASSERT_EQ(written, sizeof(HistoryHeader));
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Metrics History Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Rollup Tests:\n");
+    RUN_TEST(test_second_rollup);
+    RUN_TEST(test_p99_nearest_rank);
+    RUN_TEST(test_empty_seconds_fill_gap);
+    RUN_TEST(test_minute_rollup);
+    RUN_TEST(test_partial_first_minute);
+
+    printf("\nRing Tests:\n");
+    RUN_TEST(test_second_ring_wraps);
+    RUN_TEST(test_long_gap_resets);
+    RUN_TEST(test_invalid_series);
+
+    printf("\nSampling Tests:\n");
+    RUN_TEST(test_sample_rates);
+    RUN_TEST(test_sample_rtt);
+
+    printf("\nSerialization Tests:\n");
+    RUN_TEST(test_serialize_layout);
+    RUN_TEST(test_serialize_small_buffer);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,407 @@
+/**
+ * @file metrics_tests.cpp
+ * @brief Unit tests for the metrics registry and the HTTP endpoint
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Metric Tests
+ * Counter, gauge and histogram updates.
+ *
+ * ### Rendering Tests
+ * Prometheus text format, histogram consistency, truncation.
+ *
+ * ### Endpoint Tests
+ * Plain HTTP client over loopback: /metrics, 404, 405, scrapes while the
+ * data path is updating.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "diagnostics/metrics.hpp"
+#include "diagnostics/metrics_server.hpp"
+
+using namespace ryu_ldn::diagnostics;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+/**
+ * @brief Value of the first sample line starting with name + ' '
+ */
+bool FindSample(const std::string& text, const std::string& name, long long& value) {
+    size_t pos = 0;
+    while ((pos = text.find(name + " ", pos)) != std::string::npos) {
+        if (pos == 0 || text[pos - 1] == '\n') {
+            value = std::atoll(text.c_str() + pos + name.size() + 1);
+            return true;
+        }
+        pos++;
+    }
+    return false;
+}
+
+/**
+ * @brief One HTTP request over loopback, returns the raw response
+ */
+std::string HttpRequest(uint16_t port, const char* request) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return "";
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return "";
+    }
+
+    ::send(fd, request, std::strlen(request), 0);
+
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return response;
+}
+
+std::string Body(const std::string& response) {
+    size_t pos = response.find("\r\n\r\n");
+    return pos == std::string::npos ? "" : response.substr(pos + 4);
+}
+
+} // namespace
+
+// ============================================================================
+// Metric Tests
+// ============================================================================
+
+bool test_counter_and_gauge() {
+    Metrics metrics;
+    metrics.proxy_rx_packets.Add();
+    metrics.proxy_rx_packets.Add(4);
+    ASSERT_EQ(metrics.proxy_rx_packets.Load(), 5);
+
+    metrics.proxy_queued_bytes.Add(100);
+    metrics.proxy_queued_bytes.Add(-40);
+    ASSERT_EQ(metrics.proxy_queued_bytes.Load(), 60);
+    metrics.proxy_sockets.Set(3);
+    ASSERT_EQ(metrics.proxy_sockets.Load(), 3);
+    return true;
+}
+
+bool test_histogram_buckets() {
+    Histogram histogram(1);
+    histogram.Observe(0);     // le 1
+    histogram.Observe(1);     // le 1
+    histogram.Observe(3);     // le 4
+    histogram.Observe(2048);  // le 2048 (last finite)
+    histogram.Observe(5000);  // +Inf
+
+    ASSERT_EQ(histogram.BucketCount(0), 2);
+    ASSERT_EQ(histogram.BucketCount(2), 1);
+    ASSERT_EQ(histogram.Bound(HISTOGRAM_BUCKETS - 1), 2048);
+    ASSERT_EQ(histogram.BucketCount(HISTOGRAM_BUCKETS - 1), 1);
+    ASSERT_EQ(histogram.BucketCount(HISTOGRAM_BUCKETS), 1);
+    ASSERT_EQ(histogram.Sum(), 0 + 1 + 3 + 2048 + 5000);
+    return true;
+}
+
+bool test_histogram_quantile_bound() {
+    Histogram histogram(8);
+    ASSERT_EQ(histogram.QuantileBound(99), 0);
+
+    for (int i = 0; i < 98; i++) {
+        histogram.Observe(100);   // le 128
+    }
+    histogram.Observe(400);       // le 512
+    histogram.Observe(100000);    // +Inf
+
+    ASSERT_EQ(histogram.QuantileBound(50), 128);
+    ASSERT_EQ(histogram.QuantileBound(99), 512);
+    ASSERT_TRUE(histogram.QuantileBound(100) == UINT64_MAX);
+    return true;
+}
+
+bool test_scoped_latency() {
+    Histogram histogram(16);
+    {
+        ScopedLatency timer(histogram);
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+        total += histogram.BucketCount(i);
+    }
+    ASSERT_EQ(total, 1);
+    return true;
+}
+
+// ============================================================================
+// Rendering Tests
+// ============================================================================
+
+bool test_render_format() {
+    Metrics metrics;
+    metrics.proxy_tx_bytes.Add(1234);
+    metrics.proxy_queued_bytes.Set(-1);  // Gauges may be negative
+    metrics.server_rtt_ms.Observe(30);
+
+    char buffer[METRICS_RESPONSE_SIZE];
+    size_t len = render_prometheus(metrics, buffer, sizeof(buffer));
+    ASSERT_TRUE(len > 0);
+    ASSERT_EQ(len, std::strlen(buffer));
+    std::string text(buffer, len);
+
+    long long value = 0;
+    ASSERT_TRUE(text.find("# TYPE ryu_ldn_proxy_tx_bytes_total counter\n") != std::string::npos);
+    ASSERT_TRUE(FindSample(text, "ryu_ldn_proxy_tx_bytes_total", value));
+    ASSERT_EQ(value, 1234);
+    ASSERT_TRUE(text.find("# TYPE ryu_ldn_proxy_queued_bytes gauge\n") != std::string::npos);
+    ASSERT_TRUE(FindSample(text, "ryu_ldn_proxy_queued_bytes", value));
+    ASSERT_EQ(value, -1);
+
+    // Histogram: cumulative buckets, +Inf equals _count
+    ASSERT_TRUE(text.find("# TYPE ryu_ldn_server_rtt_ms histogram\n") != std::string::npos);
+    ASSERT_TRUE(FindSample(text, "ryu_ldn_server_rtt_ms_bucket{le=\"16\"}", value));
+    ASSERT_EQ(value, 0);
+    ASSERT_TRUE(FindSample(text, "ryu_ldn_server_rtt_ms_bucket{le=\"32\"}", value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(FindSample(text, "ryu_ldn_server_rtt_ms_bucket{le=\"+Inf\"}", value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(FindSample(text, "ryu_ldn_server_rtt_ms_count", value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(FindSample(text, "ryu_ldn_server_rtt_ms_sum", value));
+    ASSERT_EQ(value, 30);
+
+    // Every line is terminated
+    ASSERT_TRUE(text.back() == '\n');
+    return true;
+}
+
+bool test_render_truncates_at_line() {
+    Metrics metrics;
+    char buffer[200];
+    size_t len = render_prometheus(metrics, buffer, sizeof(buffer));
+    ASSERT_TRUE(len > 0);
+    ASSERT_TRUE(len < sizeof(buffer));
+    ASSERT_EQ(buffer[len], '\0');
+    ASSERT_EQ(buffer[len - 1], '\n');
+    return true;
+}
+
+bool test_render_fits_response_buffer() {
+    Metrics metrics;
+    metrics.ipc_latency_us.Observe(UINT64_MAX / 4);
+    char buffer[METRICS_RESPONSE_SIZE];
+    size_t len = render_prometheus(metrics, buffer, sizeof(buffer));
+    std::string text(buffer, len);
+    // Last metric rendered means nothing was cut
+    ASSERT_TRUE(text.find("ryu_ldn_memory_used_bytes ") != std::string::npos);
+    return true;
+}
+
+// ============================================================================
+// Endpoint Tests
+// ============================================================================
+
+bool test_endpoint_serves_metrics() {
+    Metrics metrics;
+    metrics.proxy_rx_packets.Add(42);
+
+    MetricsServer server(metrics);
+    ASSERT_TRUE(server.Start(0, true));
+    ASSERT_TRUE(server.GetPort() != 0);
+
+    std::string response = HttpRequest(server.GetPort(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    server.Stop();
+
+    ASSERT_TRUE(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    ASSERT_TRUE(response.find("Content-Type: text/plain; version=0.0.4\r\n") != std::string::npos);
+
+    std::string body = Body(response);
+    long long value = 0;
+    ASSERT_TRUE(FindSample(body, "ryu_ldn_proxy_rx_packets_total", value));
+    ASSERT_EQ(value, 42);
+
+    // Memory is sampled at scrape time
+    ASSERT_TRUE(FindSample(body, "ryu_ldn_memory_used_bytes", value));
+    ASSERT_TRUE(value > 0);
+
+    // Content-Length matches the body
+    size_t pos = response.find("Content-Length: ");
+    ASSERT_TRUE(pos != std::string::npos);
+    ASSERT_EQ(std::atoll(response.c_str() + pos + 16), body.size());
+    return true;
+}
+
+bool test_endpoint_errors() {
+    Metrics metrics;
+    MetricsServer server(metrics);
+    ASSERT_TRUE(server.Start(0, true));
+
+    std::string not_found = HttpRequest(server.GetPort(), "GET /admin HTTP/1.1\r\n\r\n");
+    std::string not_allowed = HttpRequest(server.GetPort(), "POST /metrics HTTP/1.1\r\n\r\n");
+    std::string root = HttpRequest(server.GetPort(), "GET / HTTP/1.0\r\n\r\n");
+    uint64_t requests = server.GetRequestCount();
+    server.Stop();
+
+    ASSERT_TRUE(not_found.rfind("HTTP/1.1 404", 0) == 0);
+    ASSERT_TRUE(not_allowed.rfind("HTTP/1.1 405", 0) == 0);
+    ASSERT_TRUE(root.rfind("HTTP/1.1 200", 0) == 0);
+    ASSERT_EQ(requests, 3);
+    return true;
+}
+
+bool test_endpoint_stop_and_restart() {
+    Metrics metrics;
+    MetricsServer server(metrics);
+    ASSERT_TRUE(server.Start(0, true));
+    uint16_t port = server.GetPort();
+    server.Stop();
+    ASSERT_FALSE(server.IsRunning());
+    ASSERT_TRUE(HttpRequest(port, "GET /metrics HTTP/1.1\r\n\r\n").empty());
+
+    ASSERT_TRUE(server.Start(0, true));
+    ASSERT_TRUE(HttpRequest(server.GetPort(), "GET /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 200", 0) == 0);
+    server.Stop();
+    return true;
+}
+
+bool test_scrape_during_updates() {
+    Metrics metrics;
+    MetricsServer server(metrics);
+    ASSERT_TRUE(server.Start(0, true));
+
+    // Data path keeps updating while we scrape: values only grow
+    std::atomic<bool> stop{false};
+    std::thread writer([&]() {
+        while (!stop.load()) {
+            metrics.proxy_rx_packets.Add();
+            metrics.ipc_latency_us.Observe(100);
+        }
+    });
+
+    long long previous = -1;
+    bool monotonic = true;
+    bool consistent = true;
+    for (int i = 0; i < 20; i++) {
+        std::string body = Body(HttpRequest(server.GetPort(), "GET /metrics HTTP/1.1\r\n\r\n"));
+        long long value = 0;
+        long long inf = 0;
+        long long count = 0;
+        if (!FindSample(body, "ryu_ldn_proxy_rx_packets_total", value) ||
+            !FindSample(body, "ryu_ldn_ipc_latency_us_bucket{le=\"+Inf\"}", inf) ||
+            !FindSample(body, "ryu_ldn_ipc_latency_us_count", count)) {
+            consistent = false;
+            break;
+        }
+        monotonic = monotonic && value >= previous;
+        consistent = consistent && inf == count;
+        previous = value;
+    }
+
+    stop = true;
+    writer.join();
+    server.Stop();
+
+    ASSERT_TRUE(monotonic);
+    ASSERT_TRUE(consistent);
+    ASSERT_TRUE(previous > 0);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Metrics Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Metric Tests:\n");
+    RUN_TEST(test_counter_and_gauge);
+    RUN_TEST(test_histogram_buckets);
+    RUN_TEST(test_histogram_quantile_bound);
+    RUN_TEST(test_scoped_latency);
+
+    printf("\nRendering Tests:\n");
+    RUN_TEST(test_render_format);
+    RUN_TEST(test_render_truncates_at_line);
+    RUN_TEST(test_render_fits_response_buffer);
+
+    printf("\nEndpoint Tests:\n");
+    RUN_TEST(test_endpoint_serves_metrics);
+    RUN_TEST(test_endpoint_errors);
+    RUN_TEST(test_endpoint_stop_and_restart);
+    RUN_TEST(test_scrape_during_updates);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
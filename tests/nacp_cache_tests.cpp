@@ -0,0 +1,328 @@
+/**
+ * @file nacp_cache_tests.cpp
+ * @brief Unit tests for the NACP metadata cache
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Entry Tests
+ * Building entries from the raw NACP id array.
+ *
+ * ### Table Tests
+ * Lookup, replacement, dirty tracking and LRU eviction.
+ *
+ * ### Persistence Tests
+ * Serialization round trip, compactness, corruption handling and files.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "ldn/nacp_cache.hpp"
+
+using namespace ryu_ldn::ldn;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+constexpr uint64_t MK8_ID = 0x0100152000022000ULL;
+constexpr uint64_t SPLATOON_ID = 0x01003BC0000A0000ULL;
+
+NacpCacheEntry MakeEntry(uint64_t program_id, uint32_t version, uint64_t first_id) {
+    uint64_t ids[NACP_LOCAL_COMMUNICATION_ID_COUNT] = {first_id};
+    return NacpCacheEntry::FromNacp(program_id, version, ids);
+}
+
+} // namespace
+
+// ============================================================================
+// Entry Tests
+// ============================================================================
+
+bool test_entry_from_nacp() {
+    uint64_t ids[NACP_LOCAL_COMMUNICATION_ID_COUNT] = {0x1111, 0x2222, 0, 0x4444, 0, 0, 0, 0};
+    NacpCacheEntry entry = NacpCacheEntry::FromNacp(MK8_ID, 0x50000, ids);
+
+    ASSERT_EQ(entry.program_id, MK8_ID);
+    ASSERT_EQ(entry.title_version, 0x50000);
+    ASSERT_TRUE(entry.ldn_capable);
+    ASSERT_EQ(entry.id_count, 4);
+    ASSERT_EQ(entry.local_communication_ids[2], 0);
+    ASSERT_EQ(entry.local_communication_ids[3], 0x4444);
+    ASSERT_EQ(entry.primary_id(), 0x1111);
+    return true;
+}
+
+bool test_entry_without_ids_falls_back_to_program_id() {
+    uint64_t ids[NACP_LOCAL_COMMUNICATION_ID_COUNT] = {};
+    NacpCacheEntry entry = NacpCacheEntry::FromNacp(MK8_ID, 0, ids);
+
+    ASSERT_FALSE(entry.ldn_capable);
+    ASSERT_EQ(entry.id_count, 0);
+    ASSERT_EQ(entry.primary_id(), MK8_ID);
+
+    // Id 0 unset but others present: the SDK still uses index 0
+    uint64_t sparse[NACP_LOCAL_COMMUNICATION_ID_COUNT] = {0, 0x2222};
+    NacpCacheEntry sparse_entry = NacpCacheEntry::FromNacp(MK8_ID, 0, sparse);
+    ASSERT_TRUE(sparse_entry.ldn_capable);
+    ASSERT_EQ(sparse_entry.primary_id(), MK8_ID);
+    return true;
+}
+
+// ============================================================================
+// Table Tests
+// ============================================================================
+
+bool test_find_and_store() {
+    NacpCache cache;
+    ASSERT_TRUE(cache.find(MK8_ID) == nullptr);
+    ASSERT_FALSE(cache.dirty());
+
+    cache.store(MakeEntry(MK8_ID, 1, 0xAAAA));
+    ASSERT_TRUE(cache.dirty());
+
+    const NacpCacheEntry* entry = cache.find(MK8_ID);
+    ASSERT_TRUE(entry != nullptr);
+    ASSERT_EQ(entry->primary_id(), 0xAAAA);
+    ASSERT_EQ(cache.size(), 1);
+    return true;
+}
+
+bool test_store_replaces_on_update() {
+    NacpCache cache;
+    cache.store(MakeEntry(MK8_ID, 1, 0xAAAA));
+    cache.store(MakeEntry(MK8_ID, 2, 0xBBBB));
+
+    ASSERT_EQ(cache.size(), 1);
+    ASSERT_EQ(cache.find(MK8_ID)->title_version, 2);
+    ASSERT_EQ(cache.find(MK8_ID)->primary_id(), 0xBBBB);
+    return true;
+}
+
+bool test_store_unchanged_keeps_clean() {
+    NacpCache cache;
+    uint8_t buffer[NACP_CACHE_MAX_FILE_SIZE];
+
+    cache.store(MakeEntry(MK8_ID, 1, 0xAAAA));
+    ASSERT_TRUE(cache.serialize(buffer, sizeof(buffer)) > 0);
+    ASSERT_FALSE(cache.dirty());
+
+    cache.store(MakeEntry(MK8_ID, 1, 0xAAAA));
+    ASSERT_FALSE(cache.dirty());
+    return true;
+}
+
+bool test_lru_eviction() {
+    NacpCache cache;
+    for (uint64_t i = 0; i < NACP_CACHE_MAX_ENTRIES; i++) {
+        cache.store(MakeEntry(0x0100000000010000ULL + i, 0, i + 1));
+    }
+    ASSERT_EQ(cache.size(), NACP_CACHE_MAX_ENTRIES);
+
+    // Touch the oldest so the second oldest becomes the victim
+    ASSERT_TRUE(cache.find(0x0100000000010000ULL) != nullptr);
+    cache.store(MakeEntry(SPLATOON_ID, 0, 0x5555));
+
+    ASSERT_EQ(cache.size(), NACP_CACHE_MAX_ENTRIES);
+    ASSERT_TRUE(cache.find(SPLATOON_ID) != nullptr);
+    ASSERT_TRUE(cache.find(0x0100000000010000ULL) != nullptr);
+    ASSERT_TRUE(cache.find(0x0100000000010001ULL) == nullptr);
+    return true;
+}
+
+bool test_erase_and_clear() {
+    NacpCache cache;
+    cache.store(MakeEntry(MK8_ID, 0, 1));
+    cache.store(MakeEntry(SPLATOON_ID, 0, 2));
+
+    ASSERT_TRUE(cache.erase(MK8_ID));
+    ASSERT_FALSE(cache.erase(MK8_ID));
+    ASSERT_TRUE(cache.find(SPLATOON_ID) != nullptr);
+
+    cache.clear();
+    ASSERT_EQ(cache.size(), 0);
+    return true;
+}
+
+// ============================================================================
+// Persistence Tests
+// ============================================================================
+
+bool test_serialize_round_trip() {
+    NacpCache cache;
+    uint64_t ids[NACP_LOCAL_COMMUNICATION_ID_COUNT] = {0x1111, 0, 0x3333};
+    cache.store(NacpCacheEntry::FromNacp(MK8_ID, 0x60000, ids));
+    cache.store(MakeEntry(SPLATOON_ID, 7, 0));
+
+    uint8_t buffer[NACP_CACHE_MAX_FILE_SIZE];
+    size_t size = cache.serialize(buffer, sizeof(buffer));
+    ASSERT_TRUE(size > 0);
+
+    NacpCache loaded;
+    ASSERT_TRUE(loaded.deserialize(buffer, size));
+    ASSERT_EQ(loaded.size(), 2);
+    ASSERT_FALSE(loaded.dirty());
+
+    const NacpCacheEntry* mk8 = loaded.find(MK8_ID);
+    ASSERT_TRUE(mk8 != nullptr);
+    ASSERT_EQ(mk8->title_version, 0x60000);
+    ASSERT_EQ(mk8->id_count, 3);
+    ASSERT_EQ(mk8->local_communication_ids[0], 0x1111);
+    ASSERT_EQ(mk8->local_communication_ids[1], 0);
+    ASSERT_EQ(mk8->local_communication_ids[2], 0x3333);
+
+    const NacpCacheEntry* splatoon = loaded.find(SPLATOON_ID);
+    ASSERT_TRUE(splatoon != nullptr);
+    ASSERT_FALSE(splatoon->ldn_capable);
+    ASSERT_EQ(splatoon->primary_id(), SPLATOON_ID);
+    return true;
+}
+
+bool test_serialized_size_is_compact() {
+    NacpCache cache;
+    cache.store(MakeEntry(MK8_ID, 0, 0x1111));
+
+    uint8_t buffer[NACP_CACHE_MAX_FILE_SIZE];
+    ASSERT_EQ(cache.serialize(buffer, sizeof(buffer)),
+              NACP_CACHE_HEADER_SIZE + NACP_CACHE_ENTRY_FIXED_SIZE + 8);
+
+    // Too small a buffer is refused rather than truncated
+    ASSERT_EQ(cache.serialize(buffer, NACP_CACHE_HEADER_SIZE + 4), 0);
+    return true;
+}
+
+bool test_deserialize_rejects_corruption() {
+    NacpCache cache;
+    cache.store(MakeEntry(MK8_ID, 0, 0x1111));
+
+    uint8_t buffer[NACP_CACHE_MAX_FILE_SIZE];
+    size_t size = cache.serialize(buffer, sizeof(buffer));
+
+    NacpCache loaded;
+
+    // Flipped payload byte
+    buffer[NACP_CACHE_HEADER_SIZE + 3] ^= 0xFF;
+    ASSERT_FALSE(loaded.deserialize(buffer, size));
+    ASSERT_EQ(loaded.size(), 0);
+    buffer[NACP_CACHE_HEADER_SIZE + 3] ^= 0xFF;
+
+    // Truncated
+    ASSERT_FALSE(loaded.deserialize(buffer, size - 1));
+
+    // Bad magic
+    buffer[0] = 'X';
+    ASSERT_FALSE(loaded.deserialize(buffer, size));
+    return true;
+}
+
+bool test_save_and_load_file() {
+    char dir[] = "/tmp/nacp_cache_testXXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != nullptr);
+    char path[128];
+    std::snprintf(path, sizeof(path), "%s/sub/nacp_cache.bin", dir);
+
+    NacpCache cache;
+    cache.store(MakeEntry(MK8_ID, 3, 0xCAFE));
+    ASSERT_TRUE(cache.save(path));
+    ASSERT_FALSE(cache.dirty());
+
+    NacpCache loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_TRUE(loaded.find(MK8_ID) != nullptr);
+    ASSERT_EQ(loaded.find(MK8_ID)->primary_id(), 0xCAFE);
+
+    char missing[128];
+    std::snprintf(missing, sizeof(missing), "%s/missing.bin", dir);
+    ASSERT_FALSE(loaded.load(missing));
+    ASSERT_EQ(loaded.size(), 0);
+
+    std::remove(path);
+    char sub[128];
+    std::snprintf(sub, sizeof(sub), "%s/sub", dir);
+    rmdir(sub);
+    rmdir(dir);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  NACP Cache Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Entry Tests:\n");
+    RUN_TEST(test_entry_from_nacp);
+    RUN_TEST(test_entry_without_ids_falls_back_to_program_id);
+
+    printf("\nTable Tests:\n");
+    RUN_TEST(test_find_and_store);
+    RUN_TEST(test_store_replaces_on_update);
+    RUN_TEST(test_store_unchanged_keeps_clean);
+    RUN_TEST(test_lru_eviction);
+    RUN_TEST(test_erase_and_clear);
+
+    printf("\nPersistence Tests:\n");
+    RUN_TEST(test_serialize_round_trip);
+    RUN_TEST(test_serialized_size_is_compact);
+    RUN_TEST(test_deserialize_rejects_corruption);
+    RUN_TEST(test_save_and_load_file);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
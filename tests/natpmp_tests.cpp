@@ -0,0 +1,751 @@
+/**
+ * @file natpmp_tests.cpp
+ * @brief Unit tests for NAT-PMP/PCP port mapping and the PortMapper race
+ *
+ * NatPmpClient is exercised against a local stand-in gateway that listens
+ * on 127.0.0.1 and can speak PCP, NAT-PMP only, or nothing at all.
+ * PortMapper is raced against a scripted stand-in for the slow UPnP
+ * backend.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Wire Format Tests
+ * Request encoding and response decoding for both protocols.
+ *
+ * ### NatPmpClient Tests
+ * Discovery, version fallback, mapping, renewal and deletion against the
+ * stand-in gateway.
+ *
+ * ### PortMapper Tests
+ * First-to-answer selection, fallback when the winner refuses, and lease
+ * renewal interval.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "p2p/natpmp_client.hpp"
+#include "p2p/port_mapper.hpp"
+
+using namespace ryu_ldn::p2p;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static constexpr uint32_t LOOPBACK = 0x7F000001;
+static constexpr uint32_t STAND_IN_EXTERNAL_IP = 0xCB007107;  // 203.0.113.7
+
+static uint64_t host_now_ms(void*) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static void host_sleep_ms(uint32_t ms, void*) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static PortMapperPlatform make_platform() {
+    PortMapperPlatform platform{};
+    platform.now_ms = host_now_ms;
+    platform.sleep_ms = host_sleep_ms;
+    return platform;
+}
+
+static void put_u16(uint8_t* p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xFF; }
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24; p[1] = (v >> 16) & 0xFF; p[2] = (v >> 8) & 0xFF; p[3] = v & 0xFF;
+}
+static uint16_t get_u16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+/**
+ * @brief Drive discovery of a single backend to completion
+ */
+static DiscoverStatus discover_blocking(PortMappingBackend& backend) {
+    backend.begin_discover(host_now_ms(nullptr));
+    DiscoverStatus status;
+    while ((status = backend.poll_discover(host_now_ms(nullptr))) == DiscoverStatus::Pending) {
+        host_sleep_ms(1, nullptr);
+    }
+    return status;
+}
+
+// ============================================================================
+// Stand-in Gateway
+// ============================================================================
+
+/**
+ * @brief Minimal NAT-PMP/PCP gateway on 127.0.0.1
+ *
+ * Assigns the suggested external port (or internal port if none was
+ * suggested) and grants min(requested, grant_cap_s) seconds.
+ */
+class StandInGateway {
+public:
+    bool speaks_pcp = true;        ///< Answer PCP requests
+    bool speaks_natpmp = true;     ///< Answer NAT-PMP requests (and v2 with UNSUPP_VERSION)
+    bool refuse_mappings = false;  ///< Answer mappings with NOT_AUTHORIZED
+    uint32_t grant_cap_s = 3600;   ///< Maximum lifetime granted
+
+    std::atomic<int> pcp_announces{0};
+    std::atomic<int> pcp_maps{0};
+    std::atomic<int> natpmp_maps{0};
+    std::atomic<int> deletes{0};
+    std::atomic<uint32_t> last_lifetime{0};
+    std::atomic<uint32_t> last_client_ip{0};
+    uint8_t first_nonce[PCP_NONCE_SIZE] = {};
+    uint8_t last_nonce[PCP_NONCE_SIZE] = {};
+
+    ~StandInGateway() { stop(); }
+
+    bool start() {
+        m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_fd < 0) return false;
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(LOOPBACK);
+        addr.sin_port = 0;
+        if (bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+
+        socklen_t len = sizeof(addr);
+        getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+
+        m_running = true;
+        m_thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (m_running.exchange(false)) {
+            m_thread.join();
+        }
+        if (m_fd >= 0) {
+            close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    uint16_t port() const { return m_port; }
+
+private:
+    int m_fd = -1;
+    uint16_t m_port = 0;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+
+    uint32_t grant(uint32_t requested) const {
+        return requested < grant_cap_s ? requested : grant_cap_s;
+    }
+
+    size_t handle_pcp(const uint8_t* req, size_t size, uint8_t* resp) {
+        if (!speaks_pcp) {
+            if (!speaks_natpmp) return 0;
+            // NAT-PMP gateways answer unknown versions with UNSUPP_VERSION
+            resp[0] = 0;
+            resp[1] = static_cast<uint8_t>(128 + req[1]);
+            put_u16(resp + 2, NATPMP_RESULT_UNSUPPORTED_VERSION);
+            put_u32(resp + 4, 1000);
+            return 8;
+        }
+        if (size < 24) return 0;
+
+        last_client_ip = get_u32(req + 20);
+        std::memset(resp, 0, 60);
+        resp[0] = PCP_VERSION;
+        resp[1] = static_cast<uint8_t>(0x80 | req[1]);
+        put_u32(resp + 8, 1000);
+
+        if (req[1] == PCP_OP_ANNOUNCE) {
+            pcp_announces++;
+            return 24;
+        }
+        if (req[1] != PCP_OP_MAP || size < 60) return 0;
+
+        uint32_t lifetime = get_u32(req + 4);
+        if (pcp_maps++ == 0) std::memcpy(first_nonce, req + 24, PCP_NONCE_SIZE);
+        std::memcpy(last_nonce, req + 24, PCP_NONCE_SIZE);
+        last_lifetime = lifetime;
+        if (lifetime == 0) deletes++;
+
+        std::memcpy(resp + 24, req + 24, 36);  // Echo nonce, protocol, ports
+        if (refuse_mappings) {
+            resp[3] = 2;  // NOT_AUTHORIZED
+            return 60;
+        }
+        put_u32(resp + 4, grant(lifetime));
+        uint16_t internal = get_u16(req + 40);
+        uint16_t suggested = get_u16(req + 42);
+        put_u16(resp + 42, suggested != 0 ? suggested : internal);
+        resp[54] = 0xFF;
+        resp[55] = 0xFF;
+        put_u32(resp + 56, STAND_IN_EXTERNAL_IP);
+        return 60;
+    }
+
+    size_t handle_natpmp(const uint8_t* req, size_t size, uint8_t* resp) {
+        if (!speaks_natpmp) return 0;
+
+        resp[0] = 0;
+        resp[1] = static_cast<uint8_t>(128 + req[1]);
+        put_u16(resp + 2, 0);
+        put_u32(resp + 4, 1000);
+
+        if (req[1] == NATPMP_OP_EXTERNAL_ADDRESS) {
+            put_u32(resp + 8, STAND_IN_EXTERNAL_IP);
+            return 12;
+        }
+        if (req[1] != NATPMP_OP_MAP_TCP || size < 12) return 0;
+
+        natpmp_maps++;
+        uint16_t internal = get_u16(req + 4);
+        uint16_t suggested = get_u16(req + 6);
+        uint32_t lifetime = get_u32(req + 8);
+        last_lifetime = lifetime;
+        if (lifetime == 0) deletes++;
+
+        if (refuse_mappings) {
+            put_u16(resp + 2, 2);  // NOT_AUTHORIZED
+            return 8;
+        }
+        put_u16(resp + 8, internal);
+        put_u16(resp + 10, lifetime == 0 ? 0 : (suggested != 0 ? suggested : internal));
+        put_u32(resp + 12, grant(lifetime));
+        return 16;
+    }
+
+    void run() {
+        while (m_running) {
+            pollfd pfd{m_fd, POLLIN, 0};
+            if (poll(&pfd, 1, 20) <= 0) continue;
+
+            uint8_t req[128];
+            sockaddr_in from{};
+            socklen_t from_len = sizeof(from);
+            ssize_t n = recvfrom(m_fd, req, sizeof(req), 0,
+                                 reinterpret_cast<sockaddr*>(&from), &from_len);
+            if (n < 2) continue;
+
+            uint8_t resp[64];
+            size_t resp_size = 0;
+            if (req[0] == PCP_VERSION) {
+                resp_size = handle_pcp(req, static_cast<size_t>(n), resp);
+            } else if (req[0] == NATPMP_VERSION) {
+                resp_size = handle_natpmp(req, static_cast<size_t>(n), resp);
+            }
+            if (resp_size > 0) {
+                sendto(m_fd, resp, resp_size, 0,
+                       reinterpret_cast<sockaddr*>(&from), from_len);
+            }
+        }
+    }
+};
+
+// ============================================================================
+// Stand-in Backend
+// ============================================================================
+
+/**
+ * @brief Scripted backend standing in for UPnP
+ */
+class FakeBackend : public PortMappingBackend {
+public:
+    FakeBackend(const char* name, uint32_t ready_after_ms, bool discovers, bool accepts)
+        : m_name(name), m_ready_after_ms(ready_after_ms)
+        , m_discovers(discovers), m_accepts(accepts) {}
+
+    int mappings = 0;
+    int deletions = 0;
+
+    const char* name() const override { return m_name; }
+
+    void begin_discover(uint64_t now_ms) override {
+        m_begin_ms = now_ms;
+    }
+
+    DiscoverStatus poll_discover(uint64_t now_ms) override {
+        if (now_ms - m_begin_ms < m_ready_after_ms) return DiscoverStatus::Pending;
+        return m_discovers ? DiscoverStatus::Ready : DiscoverStatus::Failed;
+    }
+
+    bool add_mapping(uint16_t, uint16_t external_port, uint32_t lifetime_s,
+                     uint16_t& mapped_port, uint32_t& granted_lifetime_s) override {
+        if (!m_accepts) return false;
+        mappings++;
+        mapped_port = external_port;
+        granted_lifetime_s = lifetime_s;
+        return true;
+    }
+
+    bool delete_mapping(uint16_t, uint16_t) override {
+        deletions++;
+        return true;
+    }
+
+    uint32_t get_external_ipv4() override { return 0; }
+    uint32_t get_local_ipv4() override { return 0xC0A80002; }
+
+private:
+    const char* m_name;
+    uint32_t m_ready_after_ms;
+    bool m_discovers;
+    bool m_accepts;
+    uint64_t m_begin_ms = 0;
+};
+
+// ============================================================================
+// Wire Format Tests
+// ============================================================================
+
+bool test_encode_natpmp_map_request() {
+    uint8_t buf[NATPMP_MAX_PACKET];
+    size_t size = encode_natpmp_map_request(buf, 39990, 39991, 60);
+
+    ASSERT_EQ(size, 12);
+    ASSERT_EQ(buf[0], 0);
+    ASSERT_EQ(buf[1], NATPMP_OP_MAP_TCP);
+    ASSERT_EQ(get_u16(buf + 2), 0);
+    ASSERT_EQ(get_u16(buf + 4), 39990);
+    ASSERT_EQ(get_u16(buf + 6), 39991);
+    ASSERT_EQ(get_u32(buf + 8), 60);
+    return true;
+}
+
+bool test_encode_pcp_map_request() {
+    uint8_t nonce[PCP_NONCE_SIZE];
+    for (size_t i = 0; i < PCP_NONCE_SIZE; i++) nonce[i] = static_cast<uint8_t>(i + 1);
+
+    uint8_t buf[NATPMP_MAX_PACKET];
+    size_t size = encode_pcp_map_request(buf, nonce, 0xC0A80164, 39990, 39990, 60);
+
+    ASSERT_EQ(size, 60);
+    ASSERT_EQ(buf[0], PCP_VERSION);
+    ASSERT_EQ(buf[1], PCP_OP_MAP);
+    ASSERT_EQ(get_u32(buf + 4), 60);
+    // Client address as ::ffff:192.168.1.100
+    for (int i = 8; i < 18; i++) ASSERT_EQ(buf[i], 0);
+    ASSERT_EQ(buf[18], 0xFF);
+    ASSERT_EQ(buf[19], 0xFF);
+    ASSERT_EQ(get_u32(buf + 20), 0xC0A80164);
+    ASSERT_TRUE(std::memcmp(buf + 24, nonce, PCP_NONCE_SIZE) == 0);
+    ASSERT_EQ(buf[36], PCP_PROTOCOL_TCP);
+    ASSERT_EQ(get_u16(buf + 40), 39990);
+    ASSERT_EQ(get_u16(buf + 42), 39990);
+    return true;
+}
+
+bool test_decode_natpmp_map_response() {
+    uint8_t buf[16] = {};
+    buf[1] = 128 + NATPMP_OP_MAP_TCP;
+    put_u32(buf + 4, 77);
+    put_u16(buf + 8, 39990);
+    put_u16(buf + 10, 40000);
+    put_u32(buf + 12, 30);
+
+    NatPmpResponse resp;
+    ASSERT_TRUE(decode_natpmp_response(buf, sizeof(buf), resp));
+    ASSERT_EQ(resp.protocol, NatPmpProtocol::NatPmp);
+    ASSERT_EQ(resp.opcode, NATPMP_OP_MAP_TCP);
+    ASSERT_EQ(resp.result, 0);
+    ASSERT_EQ(resp.epoch, 77);
+    ASSERT_EQ(resp.internal_port, 39990);
+    ASSERT_EQ(resp.external_port, 40000);
+    ASSERT_EQ(resp.lifetime_s, 30);
+    return true;
+}
+
+bool test_decode_pcp_map_response() {
+    uint8_t buf[60] = {};
+    buf[0] = PCP_VERSION;
+    buf[1] = 0x80 | PCP_OP_MAP;
+    put_u32(buf + 4, 45);
+    put_u32(buf + 8, 12);
+    buf[24] = 0xAB;
+    put_u16(buf + 40, 39990);
+    put_u16(buf + 42, 39995);
+    buf[54] = 0xFF;
+    buf[55] = 0xFF;
+    put_u32(buf + 56, STAND_IN_EXTERNAL_IP);
+
+    NatPmpResponse resp;
+    ASSERT_TRUE(decode_natpmp_response(buf, sizeof(buf), resp));
+    ASSERT_EQ(resp.protocol, NatPmpProtocol::Pcp);
+    ASSERT_EQ(resp.opcode, PCP_OP_MAP);
+    ASSERT_EQ(resp.lifetime_s, 45);
+    ASSERT_EQ(resp.epoch, 12);
+    ASSERT_EQ(resp.nonce[0], 0xAB);
+    ASSERT_EQ(resp.external_port, 39995);
+    ASSERT_EQ(resp.external_ipv4, STAND_IN_EXTERNAL_IP);
+    return true;
+}
+
+bool test_decode_rejects_requests_and_truncated() {
+    NatPmpResponse resp;
+    uint8_t buf[NATPMP_MAX_PACKET];
+
+    // Requests are not responses
+    size_t size = encode_natpmp_map_request(buf, 1, 1, 60);
+    ASSERT_TRUE(!decode_natpmp_response(buf, size, resp));
+    uint8_t nonce[PCP_NONCE_SIZE] = {};
+    size = encode_pcp_map_request(buf, nonce, LOOPBACK, 1, 1, 60);
+    ASSERT_TRUE(!decode_natpmp_response(buf, size, resp));
+
+    // Successful PCP MAP response cut short
+    buf[1] = 0x80 | PCP_OP_MAP;
+    ASSERT_TRUE(!decode_natpmp_response(buf, 40, resp));
+
+    // Unknown version
+    buf[0] = 1;
+    ASSERT_TRUE(!decode_natpmp_response(buf, 60, resp));
+
+    // Short NAT-PMP error response is accepted
+    uint8_t err[8] = {0, 129, 0, 1, 0, 0, 0, 5};
+    ASSERT_TRUE(decode_natpmp_response(err, sizeof(err), resp));
+    ASSERT_EQ(resp.result, NATPMP_RESULT_UNSUPPORTED_VERSION);
+    return true;
+}
+
+// ============================================================================
+// NatPmpClient Tests
+// ============================================================================
+
+bool test_pcp_discover_and_map() {
+    StandInGateway gateway;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient client;
+    client.set_gateway(LOOPBACK, gateway.port());
+    ASSERT_EQ(discover_blocking(client), DiscoverStatus::Ready);
+    ASSERT_EQ(client.protocol(), NatPmpProtocol::Pcp);
+    ASSERT_EQ(gateway.pcp_announces.load(), 1);
+    ASSERT_EQ(client.get_local_ipv4(), LOOPBACK);
+    ASSERT_EQ(gateway.last_client_ip.load(), LOOPBACK);
+
+    uint16_t mapped = 0;
+    uint32_t granted = 0;
+    ASSERT_TRUE(client.add_mapping(39990, 39990, 60, mapped, granted));
+    ASSERT_EQ(mapped, 39990);
+    ASSERT_EQ(granted, 60);
+    ASSERT_EQ(client.get_external_ipv4(), STAND_IN_EXTERNAL_IP);
+    ASSERT_EQ(gateway.natpmp_maps.load(), 0);
+    return true;
+}
+
+bool test_pcp_renew_reuses_nonce_and_delete() {
+    StandInGateway gateway;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient client;
+    client.set_gateway(LOOPBACK, gateway.port());
+    ASSERT_EQ(discover_blocking(client), DiscoverStatus::Ready);
+
+    uint16_t mapped = 0;
+    uint32_t granted = 0;
+    ASSERT_TRUE(client.add_mapping(39990, 39990, 60, mapped, granted));
+    ASSERT_TRUE(client.add_mapping(39990, 39990, 60, mapped, granted));
+    ASSERT_EQ(gateway.pcp_maps.load(), 2);
+    ASSERT_TRUE(std::memcmp(gateway.first_nonce, gateway.last_nonce, PCP_NONCE_SIZE) == 0);
+
+    ASSERT_TRUE(client.delete_mapping(39990, 39990));
+    ASSERT_EQ(gateway.deletes.load(), 1);
+    ASSERT_EQ(gateway.last_lifetime.load(), 0);
+    return true;
+}
+
+bool test_natpmp_fallback_from_pcp() {
+    StandInGateway gateway;
+    gateway.speaks_pcp = false;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient client;
+    client.set_gateway(LOOPBACK, gateway.port());
+    uint64_t start = host_now_ms(nullptr);
+    ASSERT_EQ(discover_blocking(client), DiscoverStatus::Ready);
+    // UNSUPP_VERSION arrives immediately, no retransmission wait
+    ASSERT_TRUE(host_now_ms(nullptr) - start < NATPMP_INITIAL_TIMEOUT_MS);
+    ASSERT_EQ(client.protocol(), NatPmpProtocol::NatPmp);
+    ASSERT_EQ(client.get_external_ipv4(), STAND_IN_EXTERNAL_IP);
+
+    uint16_t mapped = 0;
+    uint32_t granted = 0;
+    ASSERT_TRUE(client.add_mapping(39990, 39992, 60, mapped, granted));
+    ASSERT_EQ(mapped, 39992);
+    ASSERT_EQ(gateway.natpmp_maps.load(), 1);
+
+    ASSERT_TRUE(client.delete_mapping(39990, 39992));
+    ASSERT_EQ(gateway.deletes.load(), 1);
+    return true;
+}
+
+bool test_silent_gateway_fails() {
+    StandInGateway gateway;
+    gateway.speaks_pcp = false;
+    gateway.speaks_natpmp = false;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient client;
+    client.set_gateway(LOOPBACK, gateway.port());
+    uint64_t start = host_now_ms(nullptr);
+    ASSERT_EQ(discover_blocking(client), DiscoverStatus::Failed);
+    uint64_t elapsed = host_now_ms(nullptr) - start;
+    // PCP 250+500, then NAT-PMP 250+500+1000
+    ASSERT_TRUE(elapsed >= 2400 && elapsed < 3500);
+
+    uint16_t mapped = 0;
+    uint32_t granted = 0;
+    ASSERT_TRUE(!client.add_mapping(39990, 39990, 60, mapped, granted));
+    return true;
+}
+
+bool test_mapping_refused() {
+    StandInGateway gateway;
+    gateway.refuse_mappings = true;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient client;
+    client.set_gateway(LOOPBACK, gateway.port());
+    ASSERT_EQ(discover_blocking(client), DiscoverStatus::Ready);
+
+    uint16_t mapped = 0;
+    uint32_t granted = 0;
+    ASSERT_TRUE(!client.add_mapping(39990, 39990, 60, mapped, granted));
+    return true;
+}
+
+bool test_no_gateway_configured() {
+    NatPmpClient client;
+    client.begin_discover(host_now_ms(nullptr));
+    ASSERT_EQ(client.poll_discover(host_now_ms(nullptr)), DiscoverStatus::Failed);
+    return true;
+}
+
+// ============================================================================
+// PortMapper Tests
+// ============================================================================
+
+bool test_race_natpmp_wins_over_slow_upnp() {
+    StandInGateway gateway;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient natpmp;
+    natpmp.set_gateway(LOOPBACK, gateway.port());
+    FakeBackend upnp("UPnP", 2500, true, true);
+
+    PortMapper mapper;
+    mapper.set_platform(make_platform());
+    ASSERT_TRUE(mapper.add_backend(&upnp));
+    ASSERT_TRUE(mapper.add_backend(&natpmp));
+
+    uint64_t start = host_now_ms(nullptr);
+    ASSERT_TRUE(mapper.discover(3000));
+    uint64_t elapsed = host_now_ms(nullptr) - start;
+    printf("(%llums) ", static_cast<unsigned long long>(elapsed));
+
+    ASSERT_TRUE(elapsed < 200);
+    ASSERT_TRUE(std::strcmp(mapper.active_name(), "PCP") == 0);
+    ASSERT_EQ(mapper.add_mapping(39990, 39990, 3000), 39990);
+    ASSERT_EQ(upnp.mappings, 0);
+    ASSERT_EQ(mapper.get_external_ipv4(), STAND_IN_EXTERNAL_IP);
+    ASSERT_EQ(mapper.get_local_ipv4(), LOOPBACK);
+    return true;
+}
+
+bool test_race_slow_backend_wins_when_gateway_silent() {
+    StandInGateway gateway;
+    gateway.speaks_pcp = false;
+    gateway.speaks_natpmp = false;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient natpmp;
+    natpmp.set_gateway(LOOPBACK, gateway.port());
+    FakeBackend upnp("UPnP", 50, true, true);
+
+    PortMapper mapper;
+    mapper.set_platform(make_platform());
+    mapper.add_backend(&natpmp);
+    mapper.add_backend(&upnp);
+
+    ASSERT_TRUE(mapper.discover(3000));
+    ASSERT_TRUE(std::strcmp(mapper.active_name(), "UPnP") == 0);
+    ASSERT_EQ(mapper.add_mapping(39990, 39990, 3000), 39990);
+    ASSERT_EQ(upnp.mappings, 1);
+    ASSERT_TRUE(mapper.delete_mapping(39990, 39990));
+    ASSERT_EQ(upnp.deletions, 1);
+    return true;
+}
+
+bool test_race_fallback_when_winner_refuses() {
+    StandInGateway gateway;
+    gateway.refuse_mappings = true;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient natpmp;
+    natpmp.set_gateway(LOOPBACK, gateway.port());
+    FakeBackend upnp("UPnP", 100, true, true);
+
+    PortMapper mapper;
+    mapper.set_platform(make_platform());
+    mapper.add_backend(&natpmp);
+    mapper.add_backend(&upnp);
+
+    ASSERT_TRUE(mapper.discover(3000));
+    ASSERT_TRUE(std::strcmp(mapper.active_name(), "PCP") == 0);
+
+    // PCP refuses, UPnP finishes discovery and takes over
+    ASSERT_EQ(mapper.add_mapping(39990, 39990, 3000), 39990);
+    ASSERT_TRUE(std::strcmp(mapper.active_name(), "UPnP") == 0);
+    ASSERT_EQ(upnp.mappings, 1);
+
+    // Renewal goes to the backend that owns the mapping
+    ASSERT_TRUE(mapper.refresh_mapping(39990, 39990));
+    ASSERT_EQ(upnp.mappings, 2);
+    return true;
+}
+
+bool test_discover_all_failed_returns_early() {
+    FakeBackend a("A", 10, false, false);
+    FakeBackend b("B", 20, false, false);
+
+    PortMapper mapper;
+    mapper.set_platform(make_platform());
+    mapper.add_backend(&a);
+    mapper.add_backend(&b);
+
+    uint64_t start = host_now_ms(nullptr);
+    ASSERT_TRUE(!mapper.discover(3000));
+    ASSERT_TRUE(host_now_ms(nullptr) - start < 500);
+    ASSERT_TRUE(!mapper.is_available());
+    ASSERT_TRUE(std::strcmp(mapper.active_name(), "None") == 0);
+    ASSERT_EQ(mapper.add_mapping(39990, 39990, 0), 0);
+    return true;
+}
+
+bool test_renew_interval_follows_granted_lifetime() {
+    StandInGateway gateway;
+    gateway.grant_cap_s = 20;
+    ASSERT_TRUE(gateway.start());
+
+    NatPmpClient natpmp;
+    natpmp.set_gateway(LOOPBACK, gateway.port());
+
+    PortMapper mapper;
+    mapper.set_platform(make_platform());
+    mapper.add_backend(&natpmp);
+    ASSERT_EQ(mapper.renew_interval_s(), PORT_LEASE_RENEW_S);
+
+    ASSERT_TRUE(mapper.discover(3000));
+    ASSERT_EQ(mapper.add_mapping(39990, 39990, 0), 39990);
+    ASSERT_EQ(mapper.renew_interval_s(), 10);
+
+    gateway.grant_cap_s = 3600;
+    ASSERT_TRUE(mapper.refresh_mapping(39990, 39990));
+    ASSERT_EQ(mapper.renew_interval_s(), PORT_LEASE_RENEW_S);
+    return true;
+}
+
+bool test_backend_limit() {
+    FakeBackend backend("X", 0, true, true);
+    PortMapper mapper;
+    for (size_t i = 0; i < PORT_MAPPER_MAX_BACKENDS; i++) {
+        ASSERT_TRUE(mapper.add_backend(&backend));
+    }
+    ASSERT_TRUE(!mapper.add_backend(&backend));
+    ASSERT_TRUE(!mapper.add_backend(nullptr));
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  NAT-PMP/PCP Port Mapping Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Wire Format Tests:\n");
+    RUN_TEST(test_encode_natpmp_map_request);
+    RUN_TEST(test_encode_pcp_map_request);
+    RUN_TEST(test_decode_natpmp_map_response);
+    RUN_TEST(test_decode_pcp_map_response);
+    RUN_TEST(test_decode_rejects_requests_and_truncated);
+
+    printf("\nNatPmpClient Tests:\n");
+    RUN_TEST(test_pcp_discover_and_map);
+    RUN_TEST(test_pcp_renew_reuses_nonce_and_delete);
+    RUN_TEST(test_natpmp_fallback_from_pcp);
+    RUN_TEST(test_silent_gateway_fails);
+    RUN_TEST(test_mapping_refused);
+    RUN_TEST(test_no_gateway_configured);
+
+    printf("\nPortMapper Tests:\n");
+    RUN_TEST(test_race_natpmp_wins_over_slow_upnp);
+    RUN_TEST(test_race_slow_backend_wins_when_gateway_silent);
+    RUN_TEST(test_race_fallback_when_winner_refuses);
+    RUN_TEST(test_discover_all_failed_returns_early);
+    RUN_TEST(test_renew_interval_follows_granted_lifetime);
+    RUN_TEST(test_backend_limit);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file platform_tests.cpp
+ * @brief Unit tests for the POSIX backend of the platform layer
+ *
+ * The console backend is a direct mapping onto libstratosphere; these
+ * tests pin down the semantics the data path relies on so the host
+ * backend behaves the same way.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Mutex Tests
+ * Mutual exclusion under contention, try_lock.
+ *
+ * ### Event Tests
+ * Manual and auto clear, timeouts, cross-thread wakeup.
+ *
+ * ### Thread Tests
+ * Start/Join and argument passing.
+ *
+ * ### Time Tests
+ * Monotonic tick and sleep duration, virtual clock.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include "platform/platform.hpp"
+
+using namespace ryu_ldn::platform;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+struct CounterArgs {
+    Mutex* mutex;
+    int* counter;
+    int iterations;
+};
+
+void IncrementThread(void* arg) {
+    auto* args = static_cast<CounterArgs*>(arg);
+    for (int i = 0; i < args->iterations; i++) {
+        std::scoped_lock lock(*args->mutex);
+        (*args->counter)++;
+    }
+}
+
+struct SignalArgs {
+    Event* event;
+    uint32_t delay_ms;
+};
+
+void SignalThread(void* arg) {
+    auto* args = static_cast<SignalArgs*>(arg);
+    SleepMs(args->delay_ms);
+    args->event->Signal();
+}
+
+} // namespace
+
+// ============================================================================
+// Mutex Tests
+// ============================================================================
+
+bool test_mutex_contention() {
+    Mutex mutex;
+    int counter = 0;
+    CounterArgs args{&mutex, &counter, 20000};
+
+    Thread threads[4];
+    for (auto& thread : threads) {
+        ASSERT_TRUE(thread.Start(IncrementThread, &args, nullptr, 0,
+                                 LowestThreadPriority, "test_inc"));
+    }
+    for (auto& thread : threads) {
+        thread.Join();
+    }
+
+    ASSERT_EQ(counter, 4 * 20000);
+    return true;
+}
+
+bool test_mutex_try_lock() {
+    Mutex mutex;
+    ASSERT_TRUE(mutex.try_lock());
+    ASSERT_FALSE(mutex.try_lock());
+    mutex.unlock();
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+    return true;
+}
+
+// ============================================================================
+// Event Tests
+// ============================================================================
+
+bool test_event_manual_stays_signaled() {
+    Event event(EventClearMode::Manual);
+    ASSERT_FALSE(event.TryWait());
+
+    event.Signal();
+    ASSERT_TRUE(event.TryWait());
+    ASSERT_TRUE(event.TryWait());
+    ASSERT_TRUE(event.TimedWait(0));
+
+    event.Clear();
+    ASSERT_FALSE(event.TryWait());
+    return true;
+}
+
+bool test_event_auto_clears() {
+    Event event(EventClearMode::Auto);
+
+    event.Signal();
+    ASSERT_TRUE(event.TryWait());
+    ASSERT_FALSE(event.TryWait());
+
+    event.Signal();
+    event.Wait();
+    ASSERT_FALSE(event.TryWait());
+    return true;
+}
+
+bool test_event_timed_wait_times_out() {
+    Event event(EventClearMode::Manual);
+
+    uint64_t start = GetTickMs();
+    ASSERT_FALSE(event.TimedWait(50));
+    uint64_t elapsed = GetTickMs() - start;
+
+    ASSERT_TRUE(elapsed >= 50);
+    ASSERT_TRUE(elapsed < 1000);
+    return true;
+}
+
+bool test_event_cross_thread_wakeup() {
+    Event event(EventClearMode::Auto);
+    SignalArgs args{&event, 20};
+
+    Thread thread;
+    ASSERT_TRUE(thread.Start(SignalThread, &args, nullptr, 0,
+                             HighestThreadPriority, "test_signal"));
+
+    ASSERT_TRUE(event.TimedWait(2000));
+    thread.Join();
+
+    ASSERT_FALSE(event.TryWait());
+    return true;
+}
+
+// ============================================================================
+// Thread Tests
+// ============================================================================
+
+bool test_thread_start_join() {
+    Mutex mutex;
+    int counter = 0;
+    CounterArgs args{&mutex, &counter, 1};
+
+    Thread thread;
+    ASSERT_FALSE(thread.IsStarted());
+    ASSERT_TRUE(thread.Start(IncrementThread, &args, nullptr, 0,
+                             LowestThreadPriority, "test_once"));
+    ASSERT_TRUE(thread.IsStarted());
+
+    thread.Join();
+    ASSERT_FALSE(thread.IsStarted());
+    ASSERT_EQ(counter, 1);
+
+    // Join on a stopped thread is a no-op
+    thread.Join();
+    return true;
+}
+
+// ============================================================================
+// Time Tests
+// ============================================================================
+
+bool test_tick_monotonic() {
+    uint64_t previous = GetTickNs();
+    for (int i = 0; i < 1000; i++) {
+        uint64_t now = GetTickNs();
+        ASSERT_TRUE(now >= previous);
+        previous = now;
+    }
+    return true;
+}
+
+bool test_sleep_duration() {
+    uint64_t start = GetTickNs();
+    SleepMs(20);
+    uint64_t elapsed_ms = (GetTickNs() - start) / 1000000ULL;
+
+    ASSERT_TRUE(elapsed_ms >= 20);
+    ASSERT_TRUE(elapsed_ms < 1000);
+    return true;
+}
+
+bool test_virtual_clock() {
+    VirtualClock::Enable(5000000000ULL);
+    ASSERT_EQ(GetTickMs(), 5000);
+
+    // Sleeping advances the clock instead of blocking
+    uint64_t real_start = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    SleepMs(60 * 60 * 1000);
+    ASSERT_EQ(GetTickMs(), 5000 + 60 * 60 * 1000);
+    uint64_t real_now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    ASSERT_TRUE(real_now - real_start < 1000);
+
+    VirtualClock::Advance(1000000ULL);
+    ASSERT_EQ(GetTickMs(), 5000 + 60 * 60 * 1000 + 1);
+
+    // Back to real time
+    VirtualClock::Disable();
+    uint64_t start = GetTickNs();
+    SleepMs(5);
+    ASSERT_TRUE(GetTickNs() - start >= 5000000ULL);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Platform Layer Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Mutex Tests:\n");
+    RUN_TEST(test_mutex_contention);
+    RUN_TEST(test_mutex_try_lock);
+
+    printf("\nEvent Tests:\n");
+    RUN_TEST(test_event_manual_stays_signaled);
+    RUN_TEST(test_event_auto_clears);
+    RUN_TEST(test_event_timed_wait_times_out);
+    RUN_TEST(test_event_cross_thread_wakeup);
+
+    printf("\nThread Tests:\n");
+    RUN_TEST(test_thread_start_join);
+
+    printf("\nTime Tests:\n");
+    RUN_TEST(test_tick_monotonic);
+    RUN_TEST(test_sleep_duration);
+    RUN_TEST(test_virtual_clock);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,1774 @@
+/**
+ * @file proxy_socket_tests.cpp
+ * @brief Unit tests for the BSD proxy socket data path on the host
+ *
+ * ProxySocket, ProxySocketManager and EphemeralPortPool are the production
+ * sources built against the POSIX backend of the platform layer. Outgoing
+ * traffic is captured through the manager callbacks, incoming traffic is
+ * injected the way ICommunicationService does when a ProxyData,
+ * ProxyConnect or ProxyConnectReply packet arrives.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### UDP Routing Tests
+ * Destination matching, broadcast, protocol and port filtering.
+ *
+ * ### Receive Tests
+ * Queue order, MSG_PEEK, MSG_DONTWAIT, overflow and blocking receive.
+ *
+ * ### Send Tests
+ * Outgoing ProxyData and error paths.
+ *
+ * ### TCP Tests
+ * Connect handshake, optimistic connect, listen and accept backlog.
+ *
+ * ### Stream Tests
+ * Byte stream reads, send segmentation, receive window, window updates
+ * throttling the sender, and socket types.
+ *
+ * ### Broadcast Filter Tests
+ * Suppression of identical broadcast repeats, keepalive copies, flows,
+ * and the manager send path reporting suppressed datagrams as sent.
+ *
+ * ### Receive Moderation Tests
+ * Immediate signal after idle, batched wakeup of a blocked reader, and a
+ * burst load comparing wakeups and delivery latency with and without
+ * moderation.
+ *
+ * ### Readiness Tests
+ * What select() and poll() report for proxy sockets (the shared part of
+ * BsdMitmService::Select/Poll), including moderated datagrams and a
+ * stream throttled by the peer's window.
+ *
+ * ### Two-Node Tests
+ * A connecting and a listening node exchanging one request/response
+ * through a relay with a fixed one-way delay, in virtual time: time to
+ * the first byte with and without optimistic connect, and a large
+ * transfer to a slow reader paced by window updates.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+
+#include "bsd/proxy_socket_manager.hpp"
+#include "bsd/proxy_readiness.hpp"
+
+using namespace ams::mitm::bsd;
+using ryu_ldn::bsd::SockAddrIn;
+using ryu_ldn::bsd::SocketType;
+using ryu_ldn::bsd::ProtocolType;
+using Errno = ryu_ldn::bsd::BsdErrno;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        ProxySocketManager::GetInstance().CloseAllProxySockets(); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t LOCAL_IP     = 0x0A720001;  // 10.114.0.1
+constexpr uint32_t PEER_IP      = 0x0A720002;  // 10.114.0.2
+constexpr uint32_t BROADCAST_IP = 0x0A72FFFF;  // 10.114.255.255
+constexpr s32 MSG_PEEK_FLAG     = 0x2;
+constexpr s32 MSG_DONTWAIT_FLAG = 0x40;
+
+SockAddrIn MakeAddr(uint32_t ip, uint16_t port) {
+    SockAddrIn addr{};
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    addr.sin_port = __builtin_bswap16(port);
+    addr.sin_addr = __builtin_bswap32(ip);
+    return addr;
+}
+
+ProxySocket* CreateBound(s32 fd, SocketType type, ProtocolType protocol,
+                         uint32_t ip, uint16_t port) {
+    auto socket = ProxySocketManager::GetInstance().CreateProxySocket(fd, type, protocol);
+    if (socket == nullptr || R_FAILED(socket->Bind(MakeAddr(ip, port)))) {
+        return nullptr;
+    }
+    return socket.get();
+}
+
+bool Route(uint32_t dest_ip, uint16_t dest_port, const char* payload,
+           ProtocolType protocol = ProtocolType::Udp) {
+    return ProxySocketManager::GetInstance().RouteIncomingData(
+        PEER_IP, 5000, dest_ip, dest_port, protocol, payload, std::strlen(payload));
+}
+
+// Last ProxyData handed to the send callback
+struct SentData {
+    int count;
+    uint32_t source_ip;
+    uint16_t source_port;
+    uint32_t dest_ip;
+    uint16_t dest_port;
+    ProtocolType protocol;
+    char data[PROXY_SOCKET_MAX_PAYLOAD];
+    size_t data_len;
+};
+SentData g_sent;
+
+bool CaptureSend(uint32_t source_ip, uint16_t source_port,
+                 uint32_t dest_ip, uint16_t dest_port,
+                 ProtocolType protocol, const void* data, size_t data_len) {
+    g_sent.count++;
+    g_sent.source_ip = source_ip;
+    g_sent.source_port = source_port;
+    g_sent.dest_ip = dest_ip;
+    g_sent.dest_port = dest_port;
+    g_sent.protocol = protocol;
+    g_sent.data_len = data_len;
+    std::memcpy(g_sent.data, data, data_len);
+    return true;
+}
+
+// Plays the server: answers every ProxyConnect with a ProxyConnectReply
+ryu_ldn::protocol::ProtocolType g_connect_reply_protocol;
+
+bool ReplyToConnect(uint32_t source_ip, uint16_t source_port,
+                    uint32_t dest_ip, uint16_t dest_port, ProtocolType) {
+    ryu_ldn::protocol::ProxyConnectResponse response{};
+    response.info.source_ipv4 = source_ip;
+    response.info.source_port = source_port;
+    response.info.dest_ipv4 = dest_ip;
+    response.info.dest_port = dest_port;
+    response.info.protocol = g_connect_reply_protocol;
+    return ProxySocketManager::GetInstance().RouteConnectResponse(response);
+}
+
+bool DropConnect(uint32_t, uint16_t, uint32_t, uint16_t, ProtocolType) {
+    return true;
+}
+
+bool AnyPeerOptimistic(uint32_t) {
+    return true;
+}
+
+ryu_ldn::protocol::ProxyConnectResponse MakeConnectResponse(uint16_t source_port, uint16_t dest_port,
+                                                            bool accepted) {
+    ryu_ldn::protocol::ProxyConnectResponse response{};
+    response.info.source_ipv4 = LOCAL_IP;
+    response.info.source_port = source_port;
+    response.info.dest_ipv4 = PEER_IP;
+    response.info.dest_port = dest_port;
+    response.info.protocol = accepted ? ryu_ldn::protocol::ProtocolType::Unspecified
+                                      : ryu_ldn::protocol::ProtocolType::Tcp;
+    return response;
+}
+
+s32 GetSocketError(ProxySocket* socket) {
+    s32 error = 0;
+    size_t error_len = sizeof(error);
+    socket->GetSockOpt(static_cast<s32>(ryu_ldn::bsd::SocketOptionLevel::Socket),
+                       static_cast<s32>(ryu_ldn::bsd::SocketOption::Error), &error, &error_len);
+    return error;
+}
+
+struct DelayedRouteArgs {
+    uint32_t delay_ms;
+    uint16_t dest_port;
+};
+
+void DelayedRouteThread(void* arg) {
+    auto* args = static_cast<DelayedRouteArgs*>(arg);
+    ryu_ldn::platform::SleepMs(args->delay_ms);
+    Route(LOCAL_IP, args->dest_port, "late");
+}
+
+// Last window update handed to the callback
+struct SentWindow {
+    int count;
+    uint32_t source_ip;
+    uint16_t source_port;
+    uint32_t dest_ip;
+    uint16_t dest_port;
+    uint32_t read_total;
+    bool accept;    // Peer has flow control
+};
+SentWindow g_window;
+
+bool CaptureWindow(uint32_t source_ip, uint16_t source_port,
+                   uint32_t dest_ip, uint16_t dest_port, uint32_t read_total) {
+    if (!g_window.accept) {
+        return false;
+    }
+    g_window.count++;
+    g_window.source_ip = source_ip;
+    g_window.source_port = source_port;
+    g_window.dest_ip = dest_ip;
+    g_window.dest_port = dest_port;
+    g_window.read_total = read_total;
+    return true;
+}
+
+struct DelayedWindowArgs {
+    uint32_t delay_ms;
+    uint32_t read_total;
+};
+
+void DelayedWindowThread(void* arg) {
+    auto* args = static_cast<DelayedWindowArgs*>(arg);
+    ryu_ldn::platform::SleepMs(args->delay_ms);
+    ProxySocketManager::GetInstance().RouteStreamWindow(PEER_IP, 5000, LOCAL_IP, 1000, args->read_total);
+}
+
+} // namespace
+
+// ============================================================================
+// UDP Routing Tests
+// ============================================================================
+
+bool test_route_exact_and_any() {
+    auto* exact = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    auto* any = CreateBound(11, SocketType::Dgram, ProtocolType::Udp, 0, 2000);
+    ASSERT_TRUE(exact != nullptr);
+    ASSERT_TRUE(any != nullptr);
+
+    ASSERT_TRUE(Route(LOCAL_IP, 1000, "a"));
+    ASSERT_TRUE(Route(LOCAL_IP, 2000, "b"));
+    ASSERT_EQ(exact->GetPendingDataSize(), 1);
+    ASSERT_EQ(any->GetPendingDataSize(), 1);
+    return true;
+}
+
+bool test_route_broadcast() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 3000);
+    ASSERT_TRUE(socket != nullptr);
+
+    ASSERT_TRUE(Route(BROADCAST_IP, 3000, "hello"));
+    ASSERT_TRUE(socket->HasPendingData());
+    return true;
+}
+
+bool test_route_rejects_port_and_protocol_mismatch() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 4000);
+    ASSERT_TRUE(socket != nullptr);
+
+    ASSERT_FALSE(Route(LOCAL_IP, 4001, "x"));
+    ASSERT_FALSE(Route(LOCAL_IP, 4000, "x", ProtocolType::Tcp));
+    ASSERT_FALSE(socket->HasPendingData());
+    return true;
+}
+
+// ============================================================================
+// Receive Tests
+// ============================================================================
+
+bool test_recv_order_and_source() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    Route(LOCAL_IP, 1000, "first");
+    Route(LOCAL_IP, 1000, "second");
+
+    char buffer[32] = {};
+    SockAddrIn from{};
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, &from), 5);
+    ASSERT_TRUE(std::memcmp(buffer, "first", 5) == 0);
+    ASSERT_EQ(from.GetAddr(), PEER_IP);
+    ASSERT_EQ(from.GetPort(), 5000);
+
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr), 6);
+    ASSERT_TRUE(std::memcmp(buffer, "second", 6) == 0);
+    ASSERT_FALSE(socket->HasPendingData());
+    return true;
+}
+
+bool test_recv_truncates_datagram() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    Route(LOCAL_IP, 1000, "truncated");
+
+    char buffer[4] = {};
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr), 4);
+    ASSERT_TRUE(std::memcmp(buffer, "trun", 4) == 0);
+    ASSERT_FALSE(socket->HasPendingData());
+    return true;
+}
+
+bool test_recv_peek_keeps_packet() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    Route(LOCAL_IP, 1000, "peek");
+
+    char buffer[16] = {};
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), MSG_PEEK_FLAG, nullptr), 4);
+    ASSERT_TRUE(socket->HasPendingData());
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr), 4);
+    ASSERT_FALSE(socket->HasPendingData());
+    return true;
+}
+
+bool test_recv_dontwait_empty() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    char buffer[16];
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), MSG_DONTWAIT_FLAG, nullptr),
+              -static_cast<s32>(Errno::Again));
+
+    socket->SetNonBlocking(true);
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr),
+              -static_cast<s32>(Errno::Again));
+    return true;
+}
+
+bool test_recv_queue_overflow_drops_oldest() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    char payload[8];
+    for (size_t i = 0; i < PROXY_SOCKET_MAX_QUEUE_SIZE + 3; i++) {
+        std::snprintf(payload, sizeof(payload), "%zu", i);
+        Route(LOCAL_IP, 1000, payload);
+    }
+
+    char buffer[8] = {};
+    s32 len = socket->RecvFrom(buffer, sizeof(buffer) - 1, MSG_DONTWAIT_FLAG, nullptr);
+    ASSERT_TRUE(len > 0);
+    buffer[len] = '\0';
+    ASSERT_EQ(std::atoi(buffer), 3);
+    return true;
+}
+
+bool test_recv_blocking_woken_by_route() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    DelayedRouteArgs args{30, 1000};
+    ryu_ldn::platform::Thread thread;
+    ASSERT_TRUE(thread.Start(DelayedRouteThread, &args, nullptr, 0,
+                             ryu_ldn::platform::HighestThreadPriority, "test_route"));
+
+    char buffer[16] = {};
+    s32 len = socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr);
+    thread.Join();
+
+    ASSERT_EQ(len, 4);
+    ASSERT_TRUE(std::memcmp(buffer, "late", 4) == 0);
+    return true;
+}
+
+bool test_wait_for_data_timeout() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    ASSERT_FALSE(socket->WaitForData(20));
+    Route(LOCAL_IP, 1000, "x");
+    ASSERT_TRUE(socket->WaitForData(20));
+    return true;
+}
+
+bool test_wait_for_data_shutdown() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    // An infinite wait woken by Shutdown() reports no data
+    ASSERT_TRUE(R_SUCCEEDED(socket->Shutdown(ryu_ldn::bsd::ShutdownHow::Read)));
+    ASSERT_FALSE(socket->WaitForData(0));
+    return true;
+}
+
+// ============================================================================
+// Send Tests
+// ============================================================================
+
+bool test_sendto_invokes_callback() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetSendCallback(CaptureSend);
+    g_sent = {};
+
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    ASSERT_EQ(socket->SendTo("ping", 4, 0, MakeAddr(PEER_IP, 2000)), 4);
+    manager.SetSendCallback(nullptr);
+
+    ASSERT_EQ(g_sent.count, 1);
+    ASSERT_EQ(g_sent.source_ip, LOCAL_IP);
+    ASSERT_EQ(g_sent.source_port, 1000);
+    ASSERT_EQ(g_sent.dest_ip, PEER_IP);
+    ASSERT_EQ(g_sent.dest_port, 2000);
+    ASSERT_EQ(g_sent.protocol, ProtocolType::Udp);
+    ASSERT_EQ(g_sent.data_len, 4);
+    ASSERT_TRUE(std::memcmp(g_sent.data, "ping", 4) == 0);
+    return true;
+}
+
+bool test_sendto_errors() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    // No server connection registered
+    manager.SetSendCallback(nullptr);
+    ASSERT_EQ(socket->SendTo("x", 1, 0, MakeAddr(PEER_IP, 2000)),
+              -static_cast<s32>(Errno::NetUnreach));
+
+    // Larger than one ProxyData payload
+    static char big[PROXY_SOCKET_MAX_PAYLOAD + 1];
+    manager.SetSendCallback(CaptureSend);
+    ASSERT_EQ(socket->SendTo(big, sizeof(big), 0, MakeAddr(PEER_IP, 2000)),
+              -static_cast<s32>(Errno::MsgSize));
+    manager.SetSendCallback(nullptr);
+    return true;
+}
+
+// ============================================================================
+// TCP Tests
+// ============================================================================
+
+bool test_tcp_connect_accepted() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetProxyConnectCallback(ReplyToConnect);
+    g_connect_reply_protocol = ryu_ldn::protocol::ProtocolType::Unspecified;
+
+    auto* socket = CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    ams::Result rc = socket->Connect(MakeAddr(PEER_IP, 2000));
+    manager.SetProxyConnectCallback(nullptr);
+
+    ASSERT_TRUE(R_SUCCEEDED(rc));
+    ASSERT_EQ(socket->GetState(), ProxySocketState::Connected);
+    return true;
+}
+
+bool test_tcp_connect_refused() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetProxyConnectCallback(ReplyToConnect);
+    g_connect_reply_protocol = ryu_ldn::protocol::ProtocolType::Tcp;
+
+    auto* socket = CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    ams::Result rc = socket->Connect(MakeAddr(PEER_IP, 2000));
+    manager.SetProxyConnectCallback(nullptr);
+
+    ASSERT_EQ(rc.GetValue(), Errno::ConnRefused);
+    ASSERT_EQ(socket->GetState(), ProxySocketState::Bound);
+    return true;
+}
+
+bool test_tcp_connect_nonblocking_in_progress() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetProxyConnectCallback(DropConnect);
+
+    auto* socket = CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+    socket->SetNonBlocking(true);
+
+    ams::Result rc = socket->Connect(MakeAddr(PEER_IP, 2000));
+    manager.SetProxyConnectCallback(nullptr);
+
+    ASSERT_EQ(rc.GetValue(), Errno::InProgress);
+    ASSERT_EQ(socket->GetState(), ProxySocketState::Connecting);
+    return true;
+}
+
+bool test_tcp_optimistic_connect_writable_at_once() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetOptimisticPeerCallback(AnyPeerOptimistic);
+    manager.SetProxyConnectCallback(DropConnect);
+    manager.SetSendCallback(CaptureSend);
+    g_sent = {};
+
+    auto* socket = CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    // Blocking socket, no reply yet: connected anyway
+    ams::Result rc = socket->Connect(MakeAddr(PEER_IP, 2000));
+    ASSERT_TRUE(R_SUCCEEDED(rc));
+    ASSERT_EQ(socket->GetState(), ProxySocketState::Connected);
+    ASSERT_TRUE(socket->IsAwaitingConnectResponse());
+    ASSERT_EQ(socket->Send("early", 5, 0), 5);
+    ASSERT_EQ(g_sent.count, 1);
+    ASSERT_EQ(g_sent.dest_port, 2000);
+
+    ASSERT_TRUE(manager.RouteConnectResponse(MakeConnectResponse(1000, 2000, true)));
+    ASSERT_FALSE(socket->IsAwaitingConnectResponse());
+    ASSERT_EQ(socket->Send("late", 4, 0), 4);
+
+    manager.SetSendCallback(nullptr);
+    manager.SetProxyConnectCallback(nullptr);
+    manager.SetOptimisticPeerCallback(nullptr);
+    return true;
+}
+
+bool test_tcp_optimistic_connect_rejected() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetOptimisticPeerCallback(AnyPeerOptimistic);
+    manager.SetProxyConnectCallback(DropConnect);
+    manager.SetSendCallback(CaptureSend);
+
+    auto* socket = CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+    ASSERT_TRUE(R_SUCCEEDED(socket->Connect(MakeAddr(PEER_IP, 2000))));
+
+    // The refusal surfaces on the next call, as a classic connect would have
+    ASSERT_TRUE(manager.RouteConnectResponse(MakeConnectResponse(1000, 2000, false)));
+    char buffer[8];
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), -static_cast<s32>(Errno::ConnRefused));
+    ASSERT_EQ(socket->Send("x", 1, 0), -static_cast<s32>(Errno::ConnRefused));
+    ASSERT_EQ(GetSocketError(socket), Errno::ConnRefused);
+
+    manager.SetSendCallback(nullptr);
+    manager.SetProxyConnectCallback(nullptr);
+    manager.SetOptimisticPeerCallback(nullptr);
+    return true;
+}
+
+bool test_tcp_optimistic_connect_times_out() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetOptimisticPeerCallback(AnyPeerOptimistic);
+    manager.SetProxyConnectCallback(DropConnect);
+    manager.SetSendCallback(CaptureSend);
+    ryu_ldn::platform::VirtualClock::Enable(1000000000ULL);
+
+    auto* socket = CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+    ASSERT_TRUE(R_SUCCEEDED(socket->Connect(MakeAddr(PEER_IP, 2000))));
+    ASSERT_EQ(socket->Send("x", 1, 0), 1);
+
+    ryu_ldn::platform::VirtualClock::Advance(PROXY_CONNECT_TIMEOUT_MS * 1000000ULL);
+    s32 sent = socket->Send("x", 1, 0);
+    ryu_ldn::platform::VirtualClock::Disable();
+
+    ASSERT_EQ(sent, -static_cast<s32>(Errno::TimedOut));
+    ASSERT_FALSE(socket->IsAwaitingConnectResponse());
+
+    manager.SetSendCallback(nullptr);
+    manager.SetProxyConnectCallback(nullptr);
+    manager.SetOptimisticPeerCallback(nullptr);
+    return true;
+}
+
+bool test_tcp_connect_nonblocking_completes() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetProxyConnectCallback(DropConnect);
+
+    auto* accepted = CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    auto* refused = CreateBound(11, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1001);
+    ASSERT_TRUE(accepted != nullptr && refused != nullptr);
+    accepted->SetNonBlocking(true);
+    refused->SetNonBlocking(true);
+    ASSERT_EQ(accepted->Connect(MakeAddr(PEER_IP, 2000)).GetValue(), Errno::InProgress);
+    ASSERT_EQ(refused->Connect(MakeAddr(PEER_IP, 2000)).GetValue(), Errno::InProgress);
+    manager.SetProxyConnectCallback(nullptr);
+
+    ASSERT_TRUE(manager.RouteConnectResponse(MakeConnectResponse(1000, 2000, true)));
+    ASSERT_TRUE(manager.RouteConnectResponse(MakeConnectResponse(1001, 2000, false)));
+    ASSERT_EQ(accepted->GetState(), ProxySocketState::Connected);
+    ASSERT_EQ(refused->GetState(), ProxySocketState::Bound);
+    ASSERT_EQ(GetSocketError(refused), Errno::ConnRefused);
+    return true;
+}
+
+bool test_tcp_listen_accept() {
+    auto& manager = ProxySocketManager::GetInstance();
+    ASSERT_TRUE(CreateBound(10, SocketType::Stream, ProtocolType::Tcp, 0, 1000) != nullptr);
+    std::shared_ptr<ListenerProxySocket> listener = manager.ListenProxySocket(10, 4);
+    ASSERT_TRUE(listener != nullptr);
+    ASSERT_TRUE(manager.GetProxySocket(10) == listener);
+    ASSERT_EQ(listener->GetState(), ProxySocketState::Listening);
+
+    ryu_ldn::protocol::ProxyConnectRequest request{};
+    request.info.source_ipv4 = PEER_IP;
+    request.info.source_port = 5000;
+    request.info.dest_ipv4 = LOCAL_IP;
+    request.info.dest_port = 1000;
+    request.info.protocol = ryu_ldn::protocol::ProtocolType::Tcp;
+    ASSERT_TRUE(manager.RouteConnectRequest(request));
+    ASSERT_TRUE(listener->HasPendingData());
+
+    SockAddrIn peer{};
+    auto accepted = listener->Accept(&peer);
+    ASSERT_TRUE(accepted != nullptr);
+    ASSERT_EQ(accepted->GetState(), ProxySocketState::Connected);
+    ASSERT_EQ(peer.GetAddr(), PEER_IP);
+    ASSERT_EQ(peer.GetPort(), 5000);
+
+    listener->SetNonBlocking(true);
+    ASSERT_TRUE(listener->Accept(nullptr) == nullptr);
+    return true;
+}
+
+bool test_tcp_listen_keeps_held_handle() {
+    auto& manager = ProxySocketManager::GetInstance();
+    ASSERT_TRUE(CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000) != nullptr);
+
+    // A concurrent Select/Recv still holding the stream socket of fd
+    std::shared_ptr<ProxySocket> held = manager.GetProxySocket(10);
+    ASSERT_TRUE(held != nullptr);
+
+    auto listener = manager.ListenProxySocket(10, 4);
+    ASSERT_TRUE(listener != nullptr);
+    ASSERT_TRUE(manager.GetProxySocket(10) == listener);
+
+    // Still a valid object, closed so blocked callers wake up
+    ASSERT_EQ(held->GetState(), ProxySocketState::Closed);
+    ASSERT_EQ(held->GetLocalAddr().GetPort(), 1000);
+    ASSERT_FALSE(held->HasPendingData());
+
+    // Same for a handle that outlives close()
+    std::shared_ptr<ProxySocket> held_listener = manager.GetProxySocket(10);
+    ASSERT_TRUE(manager.CloseProxySocket(10));
+    ASSERT_EQ(held_listener->GetState(), ProxySocketState::Closed);
+    return true;
+}
+
+bool test_tcp_listen_requires_bound_stream() {
+    auto& manager = ProxySocketManager::GetInstance();
+    ASSERT_TRUE(manager.CreateProxySocket(10, SocketType::Stream, ProtocolType::Tcp) != nullptr);
+    ASSERT_TRUE(CreateBound(11, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000) != nullptr);
+
+    ASSERT_TRUE(manager.ListenProxySocket(10, 4) == nullptr);   // not bound
+    ASSERT_TRUE(manager.ListenProxySocket(11, 4) == nullptr);   // datagram
+    ASSERT_TRUE(manager.ListenProxySocket(12, 4) == nullptr);   // unknown fd
+    return true;
+}
+
+bool test_tcp_listen_backlog_limit() {
+    auto& manager = ProxySocketManager::GetInstance();
+    ASSERT_TRUE(CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000) != nullptr);
+    std::shared_ptr<ListenerProxySocket> listener = manager.ListenProxySocket(10, 2);
+    ASSERT_TRUE(listener != nullptr);
+
+    ryu_ldn::protocol::ProxyConnectRequest request{};
+    request.info.source_ipv4 = PEER_IP;
+    request.info.dest_ipv4 = LOCAL_IP;
+    request.info.dest_port = 1000;
+    for (uint16_t port = 5000; port < 5003; port++) {
+        request.info.source_port = port;
+        ASSERT_EQ(manager.RouteConnectRequest(request), port < 5002);
+    }
+    ASSERT_EQ(listener->GetPendingConnectionCount(), 2);
+
+    // FIFO order
+    SockAddrIn peer{};
+    ASSERT_TRUE(listener->Accept(&peer) != nullptr);
+    ASSERT_EQ(peer.GetPort(), 5000);
+    ASSERT_TRUE(listener->Accept(&peer) != nullptr);
+    ASSERT_EQ(peer.GetPort(), 5001);
+    ASSERT_FALSE(listener->HasPendingData());
+    return true;
+}
+
+bool test_tcp_listen_early_data_before_accept() {
+    auto& manager = ProxySocketManager::GetInstance();
+    const uint16_t port = EPHEMERAL_PORT_MIN;
+    ASSERT_TRUE(manager.ReservePort(port, ProtocolType::Tcp));  // as BSD Bind does
+    ASSERT_TRUE(CreateBound(10, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, port) != nullptr);
+    std::shared_ptr<ListenerProxySocket> listener = manager.ListenProxySocket(10, 4);
+    ASSERT_TRUE(listener != nullptr);
+
+    // Optimistic peer: ProxyConnect immediately followed by its data
+    ryu_ldn::protocol::ProxyConnectRequest request{};
+    request.info.source_ipv4 = PEER_IP;
+    request.info.source_port = 5000;
+    request.info.dest_ipv4 = LOCAL_IP;
+    request.info.dest_port = port;
+    ASSERT_TRUE(manager.RouteConnectRequest(request));
+    ASSERT_TRUE(Route(LOCAL_IP, port, "abc", ProtocolType::Tcp));
+    ASSERT_TRUE(Route(LOCAL_IP, port, "def", ProtocolType::Tcp));
+
+    auto accepted = listener->Accept(nullptr);
+    ASSERT_TRUE(accepted != nullptr);
+    char buffer[16] = {};
+    ASSERT_EQ(accepted->Recv(buffer, sizeof(buffer), MSG_DONTWAIT_FLAG), 6);
+    ASSERT_TRUE(std::memcmp(buffer, "abcdef", 6) == 0);
+
+    // Once registered, the connection receives instead of the listener
+    StreamProxySocket* connection = manager.RegisterAcceptedSocket(11, std::move(accepted));
+    ASSERT_TRUE(connection != nullptr);
+    ASSERT_TRUE(Route(LOCAL_IP, port, "gh", ProtocolType::Tcp));
+    ASSERT_EQ(connection->GetPendingDataSize(), 2);
+
+    // Closing the connection keeps the listener's port
+    ASSERT_TRUE(manager.CloseProxySocket(11));
+    ASSERT_FALSE(manager.ReservePort(port, ProtocolType::Tcp));
+    ASSERT_TRUE(manager.CloseProxySocket(10));
+    ASSERT_TRUE(manager.ReservePort(port, ProtocolType::Tcp));
+    return true;
+}
+
+// ============================================================================
+// Stream Tests
+// ============================================================================
+
+ProxySocket* CreateConnectedStream(s32 fd) {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetProxyConnectCallback(ReplyToConnect);
+    g_connect_reply_protocol = ryu_ldn::protocol::ProtocolType::Unspecified;
+
+    auto* socket = CreateBound(fd, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 1000);
+    if (socket != nullptr && R_FAILED(socket->Connect(MakeAddr(PEER_IP, 5000)))) {
+        socket = nullptr;
+    }
+    manager.SetProxyConnectCallback(nullptr);
+    return socket;
+}
+
+bool test_stream_recv_joins_segments() {
+    auto* socket = CreateConnectedStream(10);
+    ASSERT_TRUE(socket != nullptr);
+
+    ASSERT_TRUE(Route(LOCAL_IP, 1000, "abc", ProtocolType::Tcp));
+    ASSERT_TRUE(Route(LOCAL_IP, 1000, "defgh", ProtocolType::Tcp));
+    ASSERT_EQ(socket->GetPendingDataSize(), 8);
+
+    // No message boundaries: partial reads then the rest in one call
+    char buffer[16] = {};
+    ASSERT_EQ(socket->Recv(buffer, 2, MSG_DONTWAIT_FLAG), 2);
+    ASSERT_TRUE(std::memcmp(buffer, "ab", 2) == 0);
+    ASSERT_EQ(socket->Recv(buffer, 4, MSG_PEEK_FLAG), 4);
+    ASSERT_TRUE(std::memcmp(buffer, "cdef", 4) == 0);
+
+    SockAddrIn from{};
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, &from), 6);
+    ASSERT_TRUE(std::memcmp(buffer, "cdefgh", 6) == 0);
+    ASSERT_EQ(from.GetAddr(), PEER_IP);
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), MSG_DONTWAIT_FLAG),
+              -static_cast<s32>(Errno::Again));
+    return true;
+}
+
+bool test_stream_send_segments_large_writes() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* socket = CreateConnectedStream(10);
+    ASSERT_TRUE(socket != nullptr);
+
+    manager.SetSendCallback(CaptureSend);
+    g_sent = {};
+    static char big[PROXY_SOCKET_MAX_PAYLOAD * 2 + 10];
+    ASSERT_EQ(socket->Send(big, sizeof(big), 0), static_cast<s32>(sizeof(big)));
+    manager.SetSendCallback(nullptr);
+
+    ASSERT_EQ(g_sent.count, 3);
+    ASSERT_EQ(g_sent.data_len, 10);
+    ASSERT_EQ(g_sent.dest_port, 5000);
+    ASSERT_EQ(g_sent.protocol, ProtocolType::Tcp);
+    return true;
+}
+
+bool test_stream_window_overflow_resets() {
+    auto* socket = CreateConnectedStream(10);
+    ASSERT_TRUE(socket != nullptr);
+    auto* stream = static_cast<StreamProxySocket*>(socket);
+    ASSERT_EQ(stream->GetReceiveWindow(), PROXY_STREAM_RECEIVE_WINDOW);
+
+    static char segment[PROXY_SOCKET_MAX_PAYLOAD];
+    std::memset(segment, 'x', sizeof(segment));
+    size_t queued = 0;
+    auto& manager = ProxySocketManager::GetInstance();
+    while (queued + sizeof(segment) <= PROXY_STREAM_RECEIVE_WINDOW) {
+        manager.RouteIncomingData(PEER_IP, 5000, LOCAL_IP, 1000, ProtocolType::Tcp,
+                                  segment, sizeof(segment));
+        queued += sizeof(segment);
+    }
+    ASSERT_EQ(socket->GetPendingDataSize(), queued);
+
+    // A peer without flow control overruns the window: the segment is dropped
+    // and the stream is broken
+    uint64_t dropped = ryu_ldn::diagnostics::g_metrics.proxy_rx_dropped.Load();
+    manager.RouteIncomingData(PEER_IP, 5000, LOCAL_IP, 1000, ProtocolType::Tcp,
+                              segment, sizeof(segment));
+    ASSERT_EQ(socket->GetPendingDataSize(), queued);
+    ASSERT_EQ(stream->GetReceiveWindow(), 0);
+    ASSERT_EQ(ryu_ldn::diagnostics::g_metrics.proxy_rx_dropped.Load(), dropped + 1);
+
+    // Later segments are ignored
+    ASSERT_TRUE(Route(LOCAL_IP, 1000, "abc", ProtocolType::Tcp));
+    ASSERT_EQ(socket->GetPendingDataSize(), queued);
+
+    // Buffered bytes are still delivered, then the reset
+    static char buffer[PROXY_STREAM_RECEIVE_WINDOW];
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), static_cast<s32>(queued));
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), -static_cast<s32>(Errno::ConnReset));
+
+    s32 error = -1;
+    size_t error_len = sizeof(error);
+    ASSERT_TRUE(R_SUCCEEDED(socket->GetSockOpt(
+        static_cast<s32>(ryu_ldn::bsd::SocketOptionLevel::Socket),
+        static_cast<s32>(ryu_ldn::bsd::SocketOption::Error), &error, &error_len)));
+    ASSERT_EQ(error, Errno::ConnReset);
+    return true;
+}
+
+bool test_stream_send_throttled_by_peer_window() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* socket = CreateConnectedStream(10);
+    ASSERT_TRUE(socket != nullptr);
+    auto* stream = static_cast<StreamProxySocket*>(socket);
+    socket->SetNonBlocking(true);
+    manager.SetSendCallback(CaptureSend);
+
+    // No update from the peer (Ryujinx): never throttled
+    static char big[PROXY_STREAM_RECEIVE_WINDOW + 1000];
+    ASSERT_EQ(stream->GetSendWindow(), SIZE_MAX);
+    ASSERT_EQ(socket->Send(big, sizeof(big), 0), static_cast<s32>(sizeof(big)));
+
+    // First update: the peer has read 1000 bytes, a full window is unread
+    ASSERT_TRUE(manager.RouteStreamWindow(PEER_IP, 5000, LOCAL_IP, 1000, 1000));
+    ASSERT_EQ(stream->GetSendWindow(), 0);
+    ASSERT_FALSE(socket->IsWritable());
+    ASSERT_EQ(socket->Send("x", 1, 0), -static_cast<s32>(Errno::Again));
+
+    // The peer's reads open the window, a larger send is partial
+    constexpr uint32_t STEP = PROXY_STREAM_WINDOW_UPDATE_STEP;
+    ASSERT_TRUE(manager.RouteStreamWindow(PEER_IP, 5000, LOCAL_IP, 1000, 1000 + STEP));
+    ASSERT_TRUE(socket->IsWritable());
+    ASSERT_EQ(socket->Send(big, 20000, 0), static_cast<s32>(STEP));
+    ASSERT_EQ(stream->GetSendWindow(), 0);
+
+    // An update overtaken on the other path is stale
+    ASSERT_TRUE(manager.RouteStreamWindow(PEER_IP, 5000, LOCAL_IP, 1000, 1000));
+    ASSERT_EQ(stream->GetSendWindow(), 0);
+    ASSERT_TRUE(manager.RouteStreamWindow(PEER_IP, 5000, LOCAL_IP, 1000, 1000 + STEP + 100));
+    ASSERT_EQ(stream->GetSendWindow(), 100);
+
+    // Updates only reach the connection they belong to
+    ASSERT_FALSE(manager.RouteStreamWindow(PEER_IP, 5001, LOCAL_IP, 1000, 0));
+    manager.SetSendCallback(nullptr);
+    return true;
+}
+
+bool test_stream_blocking_send_waits_for_window() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* socket = CreateConnectedStream(10);
+    ASSERT_TRUE(socket != nullptr);
+    manager.SetSendCallback(CaptureSend);
+
+    static char big[PROXY_STREAM_RECEIVE_WINDOW];
+    ASSERT_TRUE(manager.RouteStreamWindow(PEER_IP, 5000, LOCAL_IP, 1000, 0));
+    ASSERT_EQ(socket->Send(big, sizeof(big), 0), static_cast<s32>(sizeof(big)));
+
+    // Blocks until the update arrives, then sends what fits
+    DelayedWindowArgs args{30, 10};
+    ryu_ldn::platform::Thread thread;
+    ASSERT_TRUE(thread.Start(DelayedWindowThread, &args, nullptr, 0,
+                             ryu_ldn::platform::HighestThreadPriority, "test_window"));
+    ASSERT_EQ(socket->Send(big, 10, 0), 10);
+    thread.Join();
+    manager.SetSendCallback(nullptr);
+    return true;
+}
+
+bool test_stream_reader_sends_window_updates() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* socket = CreateConnectedStream(10);
+    ASSERT_TRUE(socket != nullptr);
+    manager.SetStreamWindowCallback(CaptureWindow);
+    g_window = {};
+
+    static char segment[1000];
+    for (int i = 0; i < 48; i++) {
+        manager.RouteIncomingData(PEER_IP, 5000, LOCAL_IP, 1000, ProtocolType::Tcp,
+                                  segment, sizeof(segment));
+    }
+
+    // Peer without flow control: nothing sent, retried on the next read
+    static char buffer[PROXY_STREAM_WINDOW_UPDATE_STEP];
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), MSG_PEEK_FLAG), static_cast<s32>(sizeof(buffer)));
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), static_cast<s32>(sizeof(buffer)));
+    ASSERT_EQ(g_window.count, 0);
+
+    g_window.accept = true;
+    ASSERT_EQ(socket->Recv(buffer, 1000, 0), 1000);
+    ASSERT_EQ(g_window.count, 1);
+    ASSERT_EQ(g_window.read_total, sizeof(buffer) + 1000);
+    ASSERT_EQ(g_window.source_ip, LOCAL_IP);
+    ASSERT_EQ(g_window.source_port, 1000);
+    ASSERT_EQ(g_window.dest_ip, PEER_IP);
+    ASSERT_EQ(g_window.dest_port, 5000);
+
+    // Then once per step
+    ASSERT_EQ(socket->Recv(buffer, 8000, 0), 8000);
+    ASSERT_EQ(g_window.count, 1);
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), static_cast<s32>(sizeof(buffer)));
+    ASSERT_EQ(g_window.count, 2);
+    ASSERT_EQ(g_window.read_total, 2 * sizeof(buffer) + 9000);
+
+    manager.SetStreamWindowCallback(nullptr);
+    return true;
+}
+
+bool test_stream_window_update_retried_when_drained() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* socket = CreateConnectedStream(10);
+    ASSERT_TRUE(socket != nullptr);
+    manager.SetStreamWindowCallback(CaptureWindow);
+    g_window = {};
+
+    // The update for the last step fails and the queue is drained
+    static char segment[PROXY_STREAM_WINDOW_UPDATE_STEP];
+    manager.RouteIncomingData(PEER_IP, 5000, LOCAL_IP, 1000, ProtocolType::Tcp,
+                              segment, sizeof(segment));
+    static char buffer[PROXY_STREAM_WINDOW_UPDATE_STEP];
+    ASSERT_EQ(socket->Recv(buffer, sizeof(buffer), 0), static_cast<s32>(sizeof(buffer)));
+    ASSERT_EQ(g_window.count, 0);
+    ASSERT_FALSE(socket->HasPendingData());
+
+    // No further read: the periodic retry sends it, once
+    g_window.accept = true;
+    manager.RetryStreamWindows();
+    ASSERT_EQ(g_window.count, 1);
+    ASSERT_EQ(g_window.read_total, sizeof(buffer));
+    ASSERT_EQ(g_window.dest_port, 5000);
+    manager.RetryStreamWindows();
+    ASSERT_EQ(g_window.count, 1);
+
+    manager.SetStreamWindowCallback(nullptr);
+    return true;
+}
+
+bool test_socket_types_by_kind() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto dgram = manager.CreateProxySocket(10, SocketType::Dgram, ProtocolType::Udp);
+    auto stream = manager.CreateProxySocket(11, SocketType::Stream, ProtocolType::Tcp);
+    ASSERT_TRUE(std::dynamic_pointer_cast<DatagramProxySocket>(dgram) != nullptr);
+    ASSERT_TRUE(std::dynamic_pointer_cast<StreamProxySocket>(stream) != nullptr);
+
+    // Datagram sockets no longer carry the TCP handshake state
+    ASSERT_TRUE(sizeof(DatagramProxySocket) < sizeof(StreamProxySocket));
+    return true;
+}
+
+// ============================================================================
+// Broadcast Filter Tests
+// ============================================================================
+
+namespace {
+
+BroadcastFilterConfig MakeFilterConfig(bool enabled) {
+    BroadcastFilterConfig config{};
+    config.enabled = enabled;
+    config.window_ms = 1000;
+    config.keepalive_ms = 200;
+    return config;
+}
+
+bool Suppressed(BroadcastFilter& filter, uint32_t dest_ip, uint16_t dest_port,
+                const char* payload, uint64_t now_ms, ProtocolType protocol = ProtocolType::Udp) {
+    return filter.ShouldSuppress(1000, dest_ip, dest_port, protocol,
+                                 payload, std::strlen(payload), now_ms);
+}
+
+} // namespace
+
+bool test_broadcast_filter_drops_repeats() {
+    BroadcastFilter filter;
+    filter.Configure(MakeFilterConfig(true));
+
+    // One advertisement per frame: first sent, then one copy per keepalive
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 0));
+    ASSERT_TRUE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 16));
+    ASSERT_TRUE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 183));
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 200));
+    ASSERT_TRUE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 216));
+
+    // Changed payload goes out at once
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert2", 233));
+    ASSERT_TRUE(Suppressed(filter, BROADCAST_IP, 2000, "advert2", 250));
+
+    // Unicast and TCP are never filtered
+    ASSERT_FALSE(Suppressed(filter, PEER_IP, 2000, "advert2", 266));
+    ASSERT_FALSE(Suppressed(filter, PEER_IP, 2000, "advert2", 283));
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert2", 300, ProtocolType::Tcp));
+
+    BroadcastFilterStats stats = filter.GetStats();
+    ASSERT_EQ(stats.suppressed_packets, 4);
+    ASSERT_EQ(stats.suppressed_bytes, 3 * 6 + 7);
+    ASSERT_EQ(stats.keepalives_sent, 1);
+    return true;
+}
+
+bool test_broadcast_filter_window_and_flows() {
+    BroadcastFilter filter;
+    filter.Configure(MakeFilterConfig(true));
+
+    // Silence longer than the window: the game resumed advertising
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 0));
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 1500));
+
+    // Same payload on another port is another flow
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2001, "advert", 1510));
+    ASSERT_TRUE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 1520));
+    ASSERT_TRUE(Suppressed(filter, BROADCAST_IP, 2001, "advert", 1530));
+
+    // More flows than the table: the oldest is recycled, newest kept
+    for (uint16_t port = 3000; port < 3000 + BROADCAST_FILTER_MAX_FLOWS; port++) {
+        ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, port, "advert", 1600 + port - 3000));
+    }
+    ASSERT_TRUE(Suppressed(filter, BROADCAST_IP, 3000 + BROADCAST_FILTER_MAX_FLOWS - 1, "advert", 1700));
+
+    // Disabled: everything is sent
+    filter.Configure(MakeFilterConfig(false));
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 1800));
+    ASSERT_FALSE(Suppressed(filter, BROADCAST_IP, 2000, "advert", 1801));
+
+    // Disabled before the payload is hashed: it is never read
+    ASSERT_FALSE(filter.ShouldSuppress(1000, BROADCAST_IP, 2000, ProtocolType::Udp, nullptr, 4096, 1802));
+    return true;
+}
+
+bool test_sendto_suppresses_broadcast_repeats() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto& metrics = ryu_ldn::diagnostics::g_metrics;
+    manager.SetSendCallback(CaptureSend);
+    manager.ConfigureBroadcastFilter(MakeFilterConfig(true));
+    g_sent = {};
+    uint64_t suppressed_before = metrics.proxy_tx_suppressed.Load();
+    uint64_t suppressed_bytes_before = metrics.proxy_tx_suppressed_bytes.Load();
+
+    ryu_ldn::platform::VirtualClock::Enable(1000000000ULL);
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+
+    // 60 frames of the same advertisement in one second
+    int sent_ok = 0;
+    for (int frame = 0; frame < 60; frame++) {
+        if (socket->SendTo("advert", 6, 0, MakeAddr(BROADCAST_IP, 2000)) == 6) {
+            sent_ok++;
+        }
+        ryu_ldn::platform::VirtualClock::Advance(16666667ULL);
+    }
+    ryu_ldn::platform::VirtualClock::Disable();
+    manager.ConfigureBroadcastFilter(MakeFilterConfig(false));
+    manager.SetSendCallback(nullptr);
+
+    // The game saw every send succeed, the server got one per keepalive
+    ASSERT_EQ(sent_ok, 60);
+    ASSERT_EQ(g_sent.count, 5);
+    ASSERT_EQ(metrics.proxy_tx_suppressed.Load() - suppressed_before, 55);
+    ASSERT_EQ(metrics.proxy_tx_suppressed_bytes.Load() - suppressed_bytes_before, 55 * 6);
+    return true;
+}
+
+// ============================================================================
+// Receive Moderation Tests
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t TEST_WINDOW_US = 20000;
+
+// Peers broadcasting every frame: bursts of datagrams a few dozen us apart
+struct BurstArgs {
+    int bursts;
+    int burst_size;
+    uint32_t spacing_us;
+    uint32_t period_us;
+};
+
+void BurstRouteThread(void* arg) {
+    auto* args = static_cast<BurstArgs*>(arg);
+    for (int b = 0; b < args->bursts; b++) {
+        for (int i = 0; i < args->burst_size; i++) {
+            uint64_t sent_ns = ryu_ldn::platform::GetTickNs();
+            ProxySocketManager::GetInstance().RouteIncomingData(
+                PEER_IP, 5000, LOCAL_IP, 1000, ProtocolType::Udp, &sent_ns, sizeof(sent_ns));
+            ryu_ldn::platform::SleepNs(static_cast<uint64_t>(args->spacing_us) * 1000ULL);
+        }
+        ryu_ldn::platform::SleepNs(static_cast<uint64_t>(args->period_us) * 1000ULL);
+    }
+}
+
+struct BurstResult {
+    uint64_t wakeups;
+    uint64_t coalesced;
+    uint64_t p50_us;
+    uint64_t p99_us;
+};
+
+// Blocking reader draining one burst load, delivery latency per datagram
+bool RunBurstLoad(uint32_t window_us, BurstResult& result) {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.CloseAllProxySockets();
+    manager.SetReceiveModeration(window_us);
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    if (socket == nullptr) {
+        return false;
+    }
+
+    BurstArgs args{100, 7, 30, 3000};
+    const int total = args.bursts * args.burst_size;
+    std::deque<uint64_t> latencies_us;
+
+    auto& metrics = ryu_ldn::diagnostics::g_metrics;
+    uint64_t wakeups_before = metrics.proxy_rx_wakeups.Load();
+    uint64_t coalesced_before = metrics.proxy_rx_coalesced.Load();
+    ryu_ldn::platform::Thread thread;
+    if (!thread.Start(BurstRouteThread, &args, nullptr, 0,
+                      ryu_ldn::platform::HighestThreadPriority, "test_burst")) {
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < total && ok; i++) {
+        uint64_t sent_ns = 0;
+        ok = socket->RecvFrom(&sent_ns, sizeof(sent_ns), 0, nullptr) == sizeof(sent_ns);
+        latencies_us.push_back((ryu_ldn::platform::GetTickNs() - sent_ns) / 1000ULL);
+    }
+    thread.Join();
+    if (!ok) {
+        return false;
+    }
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+    result.wakeups = metrics.proxy_rx_wakeups.Load() - wakeups_before;
+    result.coalesced = metrics.proxy_rx_coalesced.Load() - coalesced_before;
+    result.p50_us = latencies_us[latencies_us.size() / 2];
+    result.p99_us = latencies_us[(latencies_us.size() * 99) / 100];
+    manager.SetReceiveModeration(0);
+    return true;
+}
+
+// Same load in virtual time, drained between bursts: the wakeup counts no
+// longer depend on the scheduler
+bool CountBurstLoad(uint32_t window_us, BurstResult& result) {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.CloseAllProxySockets();
+    manager.SetReceiveModeration(window_us);
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    if (socket == nullptr) {
+        return false;
+    }
+
+    const BurstArgs args{100, 7, 30, 3000};
+    auto& metrics = ryu_ldn::diagnostics::g_metrics;
+    uint64_t wakeups_before = metrics.proxy_rx_wakeups.Load();
+    uint64_t coalesced_before = metrics.proxy_rx_coalesced.Load();
+    int received = 0;
+
+    ryu_ldn::platform::VirtualClock::Enable(1000000000ULL);
+    for (int b = 0; b < args.bursts; b++) {
+        for (int i = 0; i < args.burst_size; i++) {
+            uint64_t sent_ns = ryu_ldn::platform::GetTickNs();
+            manager.RouteIncomingData(PEER_IP, 5000, LOCAL_IP, 1000, ProtocolType::Udp,
+                                      &sent_ns, sizeof(sent_ns));
+            ryu_ldn::platform::VirtualClock::Advance(static_cast<uint64_t>(args.spacing_us) * 1000ULL);
+        }
+        uint64_t sent_ns;
+        while (socket->RecvFrom(&sent_ns, sizeof(sent_ns), MSG_DONTWAIT_FLAG, nullptr) == sizeof(sent_ns)) {
+            received++;
+        }
+        ryu_ldn::platform::VirtualClock::Advance(static_cast<uint64_t>(args.period_us) * 1000ULL);
+    }
+    ryu_ldn::platform::VirtualClock::Disable();
+
+    result.wakeups = metrics.proxy_rx_wakeups.Load() - wakeups_before;
+    result.coalesced = metrics.proxy_rx_coalesced.Load() - coalesced_before;
+    manager.SetReceiveModeration(0);
+    return received == args.bursts * args.burst_size;
+}
+
+} // namespace
+
+bool test_moderation_signals_first_packet() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+    socket->SetReceiveModeration(TEST_WINDOW_US);
+
+    // First datagram after idle: signaled at once
+    Route(LOCAL_IP, 1000, "a");
+    ASSERT_TRUE(socket->GetReceiveEvent().TryWait());
+
+    char buffer[8];
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), MSG_DONTWAIT_FLAG, nullptr), 1);
+    ASSERT_FALSE(socket->GetReceiveEvent().TryWait());
+
+    // Inside the window: queued without a signal, still readable by pollers
+    Route(LOCAL_IP, 1000, "b");
+    ASSERT_FALSE(socket->GetReceiveEvent().TryWait());
+    ASSERT_TRUE(socket->HasPendingData());
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), MSG_DONTWAIT_FLAG, nullptr), 1);
+    ASSERT_EQ(buffer[0], 'b');
+    return true;
+}
+
+bool test_moderation_blocked_reader_wakes_once() {
+    auto* socket = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 1000);
+    ASSERT_TRUE(socket != nullptr);
+    socket->SetReceiveModeration(TEST_WINDOW_US);
+    auto& metrics = ryu_ldn::diagnostics::g_metrics;
+
+    // Open a window, then read while a burst arrives inside it. The clock
+    // only moves 200 us, so the burst is inside the window whether the
+    // reader blocks before it or finds it queued
+    ryu_ldn::platform::VirtualClock::Enable(1000000000ULL);
+    Route(LOCAL_IP, 1000, "a");
+    char buffer[8];
+    ASSERT_EQ(socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr), 1);
+
+    BurstArgs args{1, 3, 100, 0};
+    uint64_t wakeups_before = metrics.proxy_rx_wakeups.Load();
+    uint64_t coalesced_before = metrics.proxy_rx_coalesced.Load();
+    ryu_ldn::platform::Thread thread;
+    bool started = thread.Start(BurstRouteThread, &args, nullptr, 0,
+                                ryu_ldn::platform::HighestThreadPriority, "test_burst");
+    s32 received = started ? socket->RecvFrom(buffer, sizeof(buffer), 0, nullptr) : -1;
+    if (started) {
+        thread.Join();
+    }
+    ryu_ldn::platform::VirtualClock::Disable();
+    ASSERT_EQ(received, 8);
+
+    // No signal for the burst: at most the one wakeup at the end of the window
+    ASSERT_EQ(metrics.proxy_rx_coalesced.Load() - coalesced_before, 3);
+    ASSERT_TRUE(metrics.proxy_rx_wakeups.Load() - wakeups_before <= 1);
+    ASSERT_FALSE(socket->GetReceiveEvent().TryWait());
+    ASSERT_EQ(socket->GetPendingDataSize(), 2 * sizeof(uint64_t));
+    return true;
+}
+
+bool test_moderation_burst_load() {
+    constexpr uint32_t WINDOW_US = 500;
+
+    // Real time, for the printed latencies only: they depend on the scheduler
+    BurstResult direct{};
+    BurstResult moderated{};
+    ASSERT_TRUE(RunBurstLoad(0, direct));
+    ASSERT_TRUE(RunBurstLoad(WINDOW_US, moderated));
+
+    printf("\n    every datagram: %lu wakeups, latency p50 %lu us p99 %lu us\n",
+           static_cast<unsigned long>(direct.wakeups), static_cast<unsigned long>(direct.p50_us),
+           static_cast<unsigned long>(direct.p99_us));
+    printf("    %u us window:  %lu wakeups, latency p50 %lu us p99 %lu us\n    ",
+           WINDOW_US, static_cast<unsigned long>(moderated.wakeups),
+           static_cast<unsigned long>(moderated.p50_us), static_cast<unsigned long>(moderated.p99_us));
+
+    // Every datagram signals without moderation
+    ASSERT_EQ(direct.wakeups, 700);
+
+    // 700 datagrams in bursts of 7, 180 us long and 3 ms apart: the first of
+    // each burst signals, the other 6 are coalesced
+    BurstResult counted{};
+    ASSERT_TRUE(CountBurstLoad(WINDOW_US, counted));
+    ASSERT_EQ(counted.wakeups, 100);
+    ASSERT_EQ(counted.coalesced, 600);
+    return true;
+}
+
+// ============================================================================
+// Readiness Tests
+// ============================================================================
+
+bool test_select_proxy_readiness() {
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* udp = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 2000);
+    ASSERT_TRUE(udp != nullptr);
+    auto* stream = CreateConnectedStream(11);
+    ASSERT_TRUE(stream != nullptr);
+    udp->SetReceiveModeration(TEST_WINDOW_US);
+    manager.SetSendCallback(CaptureSend);
+
+    // fd 12 is not a proxy socket: left to the real service
+    uint8_t read_in[2] = {0, static_cast<uint8_t>((1u << 2) | (1u << 4))};  // 10, 12
+    uint8_t write_in[2] = {0, static_cast<uint8_t>(1u << 3)};                // 11
+    uint8_t error_in[2] = {0, static_cast<uint8_t>(1u << 2)};                // 10
+    uint8_t read_out[2] = {};
+    uint8_t write_out[2] = {};
+    uint8_t error_out[2] = {};
+    const SelectFdSet read{read_in, sizeof(read_in), read_out, sizeof(read_out)};
+    const SelectFdSet write{write_in, sizeof(write_in), write_out, sizeof(write_out)};
+    const SelectFdSet error{error_in, sizeof(error_in), error_out, sizeof(error_out)};
+
+    // Nothing queued, the stream has no window limit yet
+    ProxyReadiness readiness = SelectProxySockets(manager, 13, read, write, error);
+    ASSERT_TRUE(readiness.has_proxy_sockets);
+    ASSERT_TRUE(readiness.has_real_sockets);
+    ASSERT_EQ(readiness.ready_count, 1);
+    ASSERT_FALSE(FdIsSet(10, read_out, sizeof(read_out)));
+    ASSERT_TRUE(FdIsSet(11, write_out, sizeof(write_out)));
+
+    // A datagram queued inside the moderation window signals no one, but
+    // select() sees it
+    char buffer[8];
+    ASSERT_TRUE(Route(LOCAL_IP, 2000, "a"));
+    ASSERT_EQ(udp->RecvFrom(buffer, sizeof(buffer), 0, nullptr), 1);
+    ASSERT_TRUE(Route(LOCAL_IP, 2000, "b"));
+    ASSERT_FALSE(udp->GetReceiveEvent().TryWait());
+
+    // The peer has a full window unread: not writable
+    ASSERT_TRUE(manager.RouteStreamWindow(PEER_IP, 5000, LOCAL_IP, 1000, 0));
+    static char big[PROXY_STREAM_RECEIVE_WINDOW];
+    ASSERT_EQ(stream->Send(big, sizeof(big), 0), static_cast<s32>(sizeof(big)));
+    ASSERT_FALSE(stream->IsWritable());
+
+    std::memset(read_out, 0, sizeof(read_out));
+    std::memset(write_out, 0, sizeof(write_out));
+    readiness = SelectProxySockets(manager, 13, read, write, error);
+    ASSERT_EQ(readiness.ready_count, 1);
+    ASSERT_TRUE(FdIsSet(10, read_out, sizeof(read_out)));
+    ASSERT_FALSE(FdIsSet(11, write_out, sizeof(write_out)));
+    ASSERT_FALSE(FdIsSet(12, read_out, sizeof(read_out)));
+
+    // Closed: reported in the error set
+    ASSERT_TRUE(R_SUCCEEDED(udp->Close()));
+    readiness = SelectProxySockets(manager, 13, read, write, error);
+    ASSERT_TRUE(FdIsSet(10, error_out, sizeof(error_out)));
+
+    // fds past the end of a short buffer are not set
+    uint8_t wide[3] = {};
+    FdSetBit(20, wide, 2);
+    ASSERT_EQ(wide[2], 0);
+    ASSERT_FALSE(FdIsSet(20, wide, 2));
+    FdSetBit(20, wide, 3);
+    ASSERT_TRUE(FdIsSet(20, wide, 3));
+    manager.SetSendCallback(nullptr);
+    return true;
+}
+
+bool test_poll_proxy_readiness() {
+    constexpr int16_t POLL_IN = static_cast<int16_t>(ryu_ldn::bsd::PollEvents::In);
+    constexpr int16_t POLL_OUT = static_cast<int16_t>(ryu_ldn::bsd::PollEvents::Out);
+    constexpr int16_t POLL_HUP = static_cast<int16_t>(ryu_ldn::bsd::PollEvents::Hup);
+
+    auto& manager = ProxySocketManager::GetInstance();
+    auto* udp = CreateBound(10, SocketType::Dgram, ProtocolType::Udp, LOCAL_IP, 2000);
+    ASSERT_TRUE(udp != nullptr);
+    auto* stream = CreateConnectedStream(11);
+    ASSERT_TRUE(stream != nullptr);
+
+    ryu_ldn::bsd::PollFd fds[3] = {
+        {10, POLL_IN, 0},
+        {11, static_cast<int16_t>(POLL_IN | POLL_OUT), 0},
+        {12, POLL_IN, POLL_IN},  // Real socket, answered by the real service
+    };
+
+    ProxyReadiness readiness = PollProxySockets(manager, fds, 3);
+    ASSERT_TRUE(readiness.has_proxy_sockets);
+    ASSERT_TRUE(readiness.has_real_sockets);
+    ASSERT_EQ(readiness.ready_count, 1);
+    ASSERT_EQ(fds[0].revents, 0);
+    ASSERT_EQ(fds[1].revents, POLL_OUT);
+    ASSERT_EQ(fds[2].revents, POLL_IN);
+
+    // Count is entries, not events
+    ASSERT_TRUE(Route(LOCAL_IP, 2000, "a"));
+    ASSERT_TRUE(Route(LOCAL_IP, 1000, "b", ProtocolType::Tcp));
+    readiness = PollProxySockets(manager, fds, 3);
+    ASSERT_EQ(readiness.ready_count, 2);
+    ASSERT_EQ(fds[0].revents, POLL_IN);
+    ASSERT_EQ(fds[1].revents, static_cast<int16_t>(POLL_IN | POLL_OUT));
+
+    // POLLHUP is reported even when not requested
+    ASSERT_TRUE(R_SUCCEEDED(udp->Close()));
+    ASSERT_EQ(PollProxySocket(*udp, 0), POLL_HUP);
+    return true;
+}
+
+// ============================================================================
+// Two-Node Tests
+// ============================================================================
+
+namespace {
+
+constexpr uint64_t RELAY_ONE_WAY_NS = 20 * 1000000ULL;
+constexpr uint64_t RELAY_STEP_NS = 1000000ULL;
+
+// One packet in flight through the relay
+struct RelayPacket {
+    uint64_t deliver_ns;
+    ryu_ldn::protocol::PacketId type;
+    ryu_ldn::protocol::ProxyInfo info;
+    char data[PROXY_SOCKET_MAX_PAYLOAD];
+    size_t data_len;
+};
+std::deque<RelayPacket> g_relay;
+
+ryu_ldn::protocol::ProxyInfo MakeInfo(uint32_t source_ip, uint16_t source_port,
+                                      uint32_t dest_ip, uint16_t dest_port) {
+    ryu_ldn::protocol::ProxyInfo info{};
+    info.source_ipv4 = source_ip;
+    info.source_port = source_port;
+    info.dest_ipv4 = dest_ip;
+    info.dest_port = dest_port;
+    info.protocol = ryu_ldn::protocol::ProtocolType::Tcp;
+    return info;
+}
+
+void RelayPush(ryu_ldn::protocol::PacketId type, const ryu_ldn::protocol::ProxyInfo& info,
+               const void* data, size_t data_len) {
+    RelayPacket packet{};
+    packet.deliver_ns = ryu_ldn::platform::VirtualClock::NowNs() + RELAY_ONE_WAY_NS;
+    packet.type = type;
+    packet.info = info;
+    packet.data_len = std::min(data_len, sizeof(packet.data));
+    std::memcpy(packet.data, data, packet.data_len);
+    g_relay.push_back(packet);
+}
+
+bool RelayConnect(uint32_t source_ip, uint16_t source_port,
+                  uint32_t dest_ip, uint16_t dest_port, ProtocolType) {
+    RelayPush(ryu_ldn::protocol::PacketId::ProxyConnect,
+              MakeInfo(source_ip, source_port, dest_ip, dest_port), nullptr, 0);
+    return true;
+}
+
+bool RelaySend(uint32_t source_ip, uint16_t source_port,
+               uint32_t dest_ip, uint16_t dest_port,
+               ProtocolType, const void* data, size_t data_len) {
+    RelayPush(ryu_ldn::protocol::PacketId::ProxyData,
+              MakeInfo(source_ip, source_port, dest_ip, dest_port), data, data_len);
+    return true;
+}
+
+bool RelayWindow(uint32_t source_ip, uint16_t source_port,
+                 uint32_t dest_ip, uint16_t dest_port, uint32_t read_total) {
+    ryu_ldn::protocol::ProxyInfo info = MakeInfo(source_ip, source_port, dest_ip, dest_port);
+    info.protocol = static_cast<ryu_ldn::protocol::ProtocolType>(
+        static_cast<int32_t>(info.protocol) | PROXY_STREAM_WINDOW_FLAG);
+    RelayPush(ryu_ldn::protocol::PacketId::ProxyData, info, &read_total, sizeof(read_total));
+    return true;
+}
+
+// Deliver what has arrived, the way ICommunicationService does on each node
+void RelayDeliver() {
+    auto& manager = ProxySocketManager::GetInstance();
+    while (!g_relay.empty() && g_relay.front().deliver_ns <= ryu_ldn::platform::VirtualClock::NowNs()) {
+        RelayPacket packet = g_relay.front();
+        g_relay.pop_front();
+
+        switch (packet.type) {
+            case ryu_ldn::protocol::PacketId::ProxyConnect: {
+                ryu_ldn::protocol::ProxyConnectRequest request{};
+                request.info = packet.info;
+                ryu_ldn::protocol::ProxyInfo reply = packet.info;
+                reply.protocol = manager.RouteConnectRequest(request)
+                    ? ryu_ldn::protocol::ProtocolType::Unspecified
+                    : ryu_ldn::protocol::ProtocolType::Tcp;
+                RelayPush(ryu_ldn::protocol::PacketId::ProxyConnectReply, reply, nullptr, 0);
+                break;
+            }
+            case ryu_ldn::protocol::PacketId::ProxyConnectReply: {
+                ryu_ldn::protocol::ProxyConnectResponse response{};
+                response.info = packet.info;
+                manager.RouteConnectResponse(response);
+                break;
+            }
+            default:
+                if ((static_cast<int32_t>(packet.info.protocol) & PROXY_STREAM_WINDOW_FLAG) != 0) {
+                    uint32_t read_total;
+                    std::memcpy(&read_total, packet.data, sizeof(read_total));
+                    manager.RouteStreamWindow(packet.info.source_ipv4, packet.info.source_port,
+                                              packet.info.dest_ipv4, packet.info.dest_port, read_total);
+                    break;
+                }
+                manager.RouteIncomingData(packet.info.source_ipv4, packet.info.source_port,
+                                          packet.info.dest_ipv4, packet.info.dest_port,
+                                          ProtocolType::Tcp, packet.data, packet.data_len);
+                break;
+        }
+    }
+}
+
+struct ExchangeTimes {
+    uint64_t first_byte_ns;   // connect() to the request readable on the listener
+    uint64_t response_ns;     // connect() to the response readable on the connector
+};
+
+// Connector on LOCAL_IP, listener on PEER_IP:7000: one request, one response
+bool RunExchange(bool optimistic, ExchangeTimes& times) {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.CloseAllProxySockets();
+    g_relay.clear();
+    times = {};
+
+    ASSERT_TRUE(CreateBound(20, SocketType::Stream, ProtocolType::Tcp, PEER_IP, 7000) != nullptr);
+    std::shared_ptr<ListenerProxySocket> listener = manager.ListenProxySocket(20, 4);
+    ASSERT_TRUE(listener != nullptr);
+    listener->SetNonBlocking(true);
+
+    auto* client = CreateBound(21, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 40000);
+    ASSERT_TRUE(client != nullptr);
+    client->SetNonBlocking(true);
+
+    manager.SetOptimisticPeerCallback(optimistic ? AnyPeerOptimistic : nullptr);
+    uint64_t start_ns = ryu_ldn::platform::VirtualClock::NowNs();
+    ams::Result rc = client->Connect(MakeAddr(PEER_IP, 7000));
+    ASSERT_TRUE(R_SUCCEEDED(rc) || rc.GetValue() == static_cast<uint32_t>(Errno::InProgress));
+
+    StreamProxySocket* server = nullptr;
+    bool request_sent = false;
+    char buffer[16];
+    for (int step = 0; step < 1000 && times.response_ns == 0; step++) {
+        RelayDeliver();
+
+        if (!request_sent && client->GetState() == ProxySocketState::Connected) {
+            ASSERT_EQ(client->Send("ping", 4, 0), 4);
+            request_sent = true;
+        }
+        if (server == nullptr) {
+            auto accepted = listener->Accept(nullptr);
+            if (accepted != nullptr) {
+                server = manager.RegisterAcceptedSocket(22, std::move(accepted));
+                ASSERT_TRUE(server != nullptr);
+            }
+        }
+        if (server != nullptr && times.first_byte_ns == 0 &&
+            server->Recv(buffer, sizeof(buffer), MSG_DONTWAIT_FLAG) == 4) {
+            times.first_byte_ns = ryu_ldn::platform::VirtualClock::NowNs() - start_ns;
+            ASSERT_EQ(server->Send("pong", 4, 0), 4);
+        }
+        if (request_sent && client->Recv(buffer, sizeof(buffer), MSG_DONTWAIT_FLAG) == 4) {
+            ASSERT_TRUE(std::memcmp(buffer, "pong", 4) == 0);
+            times.response_ns = ryu_ldn::platform::VirtualClock::NowNs() - start_ns;
+        }
+
+        ryu_ldn::platform::VirtualClock::Advance(RELAY_STEP_NS);
+    }
+
+    manager.SetOptimisticPeerCallback(nullptr);
+    ASSERT_TRUE(times.response_ns != 0);
+    ASSERT_FALSE(client->IsAwaitingConnectResponse());
+    return true;
+}
+
+} // namespace
+
+bool test_two_node_connect_latency() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetProxyConnectCallback(RelayConnect);
+    manager.SetSendCallback(RelaySend);
+    ryu_ldn::platform::VirtualClock::Enable(1000000000ULL);
+
+    ExchangeTimes classic{};
+    ExchangeTimes optimistic{};
+    bool classic_ok = RunExchange(false, classic);
+    bool optimistic_ok = RunExchange(true, optimistic);
+
+    ryu_ldn::platform::VirtualClock::Disable();
+    manager.SetSendCallback(nullptr);
+    manager.SetProxyConnectCallback(nullptr);
+    ASSERT_TRUE(classic_ok && optimistic_ok);
+
+    printf("(first byte %llu -> %llu ms, response %llu -> %llu ms) ",
+           static_cast<unsigned long long>(classic.first_byte_ns / 1000000ULL),
+           static_cast<unsigned long long>(optimistic.first_byte_ns / 1000000ULL),
+           static_cast<unsigned long long>(classic.response_ns / 1000000ULL),
+           static_cast<unsigned long long>(optimistic.response_ns / 1000000ULL));
+
+    // Classic: 1.5 RTT to the first byte, optimistic: 0.5 RTT
+    constexpr uint64_t RTT_NS = 2 * RELAY_ONE_WAY_NS;
+    ASSERT_EQ(classic.first_byte_ns, 3 * RELAY_ONE_WAY_NS);
+    ASSERT_EQ(optimistic.first_byte_ns, RELAY_ONE_WAY_NS);
+    ASSERT_EQ(classic.response_ns - optimistic.response_ns, RTT_NS);
+    return true;
+}
+
+bool test_two_node_slow_reader_stream() {
+    auto& manager = ProxySocketManager::GetInstance();
+    manager.SetProxyConnectCallback(RelayConnect);
+    manager.SetSendCallback(RelaySend);
+    manager.SetStreamWindowCallback(RelayWindow);
+    manager.SetOptimisticPeerCallback(AnyPeerOptimistic);
+    ryu_ldn::platform::VirtualClock::Enable(1000000000ULL);
+    g_relay.clear();
+
+    // 192 KB from LOCAL_IP to a ryu_ldn_nx listener reading 1 KB per ms
+    constexpr size_t TRANSFER = 192 * 1024;
+    static uint8_t source[TRANSFER];
+    static uint8_t received[TRANSFER];
+    for (size_t i = 0; i < TRANSFER; i++) {
+        source[i] = static_cast<uint8_t>(i * 7 + i / 251);
+    }
+
+    bool ok = CreateBound(20, SocketType::Stream, ProtocolType::Tcp, PEER_IP, 7000) != nullptr;
+    std::shared_ptr<ListenerProxySocket> listener = ok ? manager.ListenProxySocket(20, 4) : nullptr;
+    auto* client = CreateBound(21, SocketType::Stream, ProtocolType::Tcp, LOCAL_IP, 40000);
+    ok = listener != nullptr && client != nullptr;
+    if (ok) {
+        listener->SetNonBlocking(true);
+        client->SetNonBlocking(true);
+        ok = R_SUCCEEDED(client->Connect(MakeAddr(PEER_IP, 7000)));
+    }
+
+    uint64_t dropped = ryu_ldn::diagnostics::g_metrics.proxy_rx_dropped.Load();
+    StreamProxySocket* server = nullptr;
+    size_t sent = 0;
+    size_t read = 0;
+    size_t max_queued = 0;
+    int throttled = 0;
+    for (int step = 0; ok && step < 5000 && read < TRANSFER; step++) {
+        RelayDeliver();
+
+        if (sent < TRANSFER && client->GetState() == ProxySocketState::Connected) {
+            s32 result = client->Send(source + sent, TRANSFER - sent, 0);
+            if (result > 0) {
+                sent += static_cast<size_t>(result);
+            } else if (result == -static_cast<s32>(Errno::Again)) {
+                throttled++;
+            } else {
+                ok = false;
+            }
+        }
+        if (server == nullptr) {
+            auto accepted = listener->Accept(nullptr);
+            if (accepted != nullptr) {
+                server = manager.RegisterAcceptedSocket(22, std::move(accepted));
+                ok = server != nullptr;
+            }
+        }
+        if (server != nullptr) {
+            max_queued = std::max(max_queued, server->GetPendingDataSize());
+            s32 result = server->Recv(received + read, std::min<size_t>(1024, TRANSFER - read),
+                                      MSG_DONTWAIT_FLAG);
+            if (result > 0) {
+                read += static_cast<size_t>(result);
+            } else if (result != -static_cast<s32>(Errno::Again)) {
+                ok = false;
+            }
+        }
+
+        ryu_ldn::platform::VirtualClock::Advance(RELAY_STEP_NS);
+    }
+
+    ryu_ldn::platform::VirtualClock::Disable();
+    manager.SetOptimisticPeerCallback(nullptr);
+    manager.SetStreamWindowCallback(nullptr);
+    manager.SetSendCallback(nullptr);
+    manager.SetProxyConnectCallback(nullptr);
+    ASSERT_TRUE(ok);
+
+    printf("(throttled %d sends, peak queue %zu B) ", throttled, max_queued);
+
+    // Everything arrives in order, the sender waited instead of overrunning the reader
+    ASSERT_EQ(read, TRANSFER);
+    ASSERT_TRUE(std::memcmp(received, source, TRANSFER) == 0);
+    ASSERT_TRUE(throttled > 0);
+    ASSERT_TRUE(max_queued <= PROXY_STREAM_RECEIVE_WINDOW);
+    ASSERT_EQ(ryu_ldn::diagnostics::g_metrics.proxy_rx_dropped.Load(), dropped);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Proxy Socket Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("UDP Routing Tests:\n");
+    RUN_TEST(test_route_exact_and_any);
+    RUN_TEST(test_route_broadcast);
+    RUN_TEST(test_route_rejects_port_and_protocol_mismatch);
+
+    printf("\nReceive Tests:\n");
+    RUN_TEST(test_recv_order_and_source);
+    RUN_TEST(test_recv_truncates_datagram);
+    RUN_TEST(test_recv_peek_keeps_packet);
+    RUN_TEST(test_recv_dontwait_empty);
+    RUN_TEST(test_recv_queue_overflow_drops_oldest);
+    RUN_TEST(test_recv_blocking_woken_by_route);
+    RUN_TEST(test_wait_for_data_timeout);
+    RUN_TEST(test_wait_for_data_shutdown);
+
+    printf("\nSend Tests:\n");
+    RUN_TEST(test_sendto_invokes_callback);
+    RUN_TEST(test_sendto_errors);
+
+    printf("\nTCP Tests:\n");
+    RUN_TEST(test_tcp_connect_accepted);
+    RUN_TEST(test_tcp_connect_refused);
+    RUN_TEST(test_tcp_connect_nonblocking_in_progress);
+    RUN_TEST(test_tcp_optimistic_connect_writable_at_once);
+    RUN_TEST(test_tcp_optimistic_connect_rejected);
+    RUN_TEST(test_tcp_optimistic_connect_times_out);
+    RUN_TEST(test_tcp_connect_nonblocking_completes);
+    RUN_TEST(test_tcp_listen_accept);
+    RUN_TEST(test_tcp_listen_keeps_held_handle);
+    RUN_TEST(test_tcp_listen_requires_bound_stream);
+    RUN_TEST(test_tcp_listen_backlog_limit);
+    RUN_TEST(test_tcp_listen_early_data_before_accept);
+
+    printf("\nStream Tests:\n");
+    RUN_TEST(test_stream_recv_joins_segments);
+    RUN_TEST(test_stream_send_segments_large_writes);
+    RUN_TEST(test_stream_window_overflow_resets);
+    RUN_TEST(test_stream_send_throttled_by_peer_window);
+    RUN_TEST(test_stream_blocking_send_waits_for_window);
+    RUN_TEST(test_stream_reader_sends_window_updates);
+    RUN_TEST(test_stream_window_update_retried_when_drained);
+    RUN_TEST(test_socket_types_by_kind);
+
+    printf("\nBroadcast Filter Tests:\n");
+    RUN_TEST(test_broadcast_filter_drops_repeats);
+    RUN_TEST(test_broadcast_filter_window_and_flows);
+    RUN_TEST(test_sendto_suppresses_broadcast_repeats);
+
+    printf("\nReceive Moderation Tests:\n");
+    RUN_TEST(test_moderation_signals_first_packet);
+    RUN_TEST(test_moderation_blocked_reader_wakes_once);
+    RUN_TEST(test_moderation_burst_load);
+
+    printf("\nReadiness Tests:\n");
+    RUN_TEST(test_select_proxy_readiness);
+    RUN_TEST(test_poll_proxy_readiness);
+
+    printf("\nTwo-Node Tests:\n");
+    RUN_TEST(test_two_node_connect_latency);
+    RUN_TEST(test_two_node_slow_reader_stream);
+
+    ProxySocketManager::GetInstance().CloseAllProxySockets();
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
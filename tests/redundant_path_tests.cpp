@@ -0,0 +1,543 @@
+/**
+ * @file redundant_path_tests.cpp
+ * @brief Unit tests for dual-path redundant UDP transmission
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Selection Tests
+ * Title list, eligible packets, P2P availability.
+ *
+ * ### Discovery Tests
+ * Hello/Ack exchange, Ryujinx peers staying untagged.
+ *
+ * ### Duplicate Filter Tests
+ * Trailer stripping, second copy drop, reordering, flow restart.
+ *
+ * ### Budget Tests
+ * Extra upload bounded by the byte budget.
+ *
+ * ### Loss Simulation
+ * Delivery latency percentiles of one path vs both paths under loss.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "ldn/redundant_path.hpp"
+
+using namespace ryu_ldn::ldn;
+using ryu_ldn::protocol::ProxyInfo;
+using ryu_ldn::protocol::ProtocolType;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t IP_A = 0x0A720001;  // 10.114.0.1
+constexpr uint32_t IP_B = 0x0A720002;  // 10.114.0.2
+constexpr uint16_t GAME_PORT = 12345;
+
+ProxyInfo MakeInfo(uint32_t src, uint32_t dst, uint16_t dst_port = GAME_PORT,
+                   ProtocolType protocol = ProtocolType::Udp) {
+    ProxyInfo info{};
+    info.source_ipv4 = src;
+    info.source_port = GAME_PORT;
+    info.dest_ipv4 = dst;
+    info.dest_port = dst_port;
+    info.protocol = protocol;
+    return info;
+}
+
+RedundantPathConfig Enabled(uint32_t budget = REDUNDANT_DEFAULT_BUDGET) {
+    RedundantPathConfig config{};
+    config.enabled = true;
+    config.budget_bytes_per_sec = budget;
+    return config;
+}
+
+/**
+ * @brief Sender and receiver that already exchanged Hello/Ack
+ */
+struct Pair {
+    RedundantPath sender;
+    RedundantPath receiver;
+
+    explicit Pair(uint32_t budget = REDUNDANT_DEFAULT_BUDGET) {
+        sender.configure(Enabled(budget));
+        sender.reset();
+
+        auto hello = RedundantPath::make_control(RedundantControlType::Hello);
+        uint32_t size = sizeof(hello);
+        bool reply_ack = false;
+        receiver.on_receive(MakeInfo(IP_A, IP_B, REDUNDANT_CONTROL_PORT), false,
+                            reinterpret_cast<const uint8_t*>(&hello), size, reply_ack, 0);
+
+        auto ack = RedundantPath::make_control(RedundantControlType::Ack);
+        size = sizeof(ack);
+        sender.on_receive(MakeInfo(IP_B, IP_A, REDUNDANT_CONTROL_PORT), false,
+                          reinterpret_cast<const uint8_t*>(&ack), size, reply_ack, 0);
+    }
+};
+
+/**
+ * @brief Build the tagged payload the service would send
+ */
+std::vector<uint8_t> Tag(const uint8_t* payload, size_t size, const RedundantTrailer& trailer) {
+    std::vector<uint8_t> tagged(payload, payload + size);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&trailer);
+    tagged.insert(tagged.end(), bytes, bytes + sizeof(trailer));
+    return tagged;
+}
+
+/**
+ * @brief Small deterministic PRNG for the loss simulation
+ */
+struct Lcg {
+    uint64_t state;
+    double next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(state >> 11) / static_cast<double>(1ULL << 53);
+    }
+};
+
+double Percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+    return values[index];
+}
+
+} // namespace
+
+// ============================================================================
+// Selection Tests
+// ============================================================================
+
+bool test_title_list() {
+    ASSERT_TRUE(redundant_title_selected("", 0x0100152000022000ULL));
+    ASSERT_TRUE(redundant_title_selected(nullptr, 0x0100152000022000ULL));
+    ASSERT_TRUE(redundant_title_selected("0100152000022000", 0x0100152000022000ULL));
+    ASSERT_TRUE(redundant_title_selected("01003BC0000A0000, 0x0100152000022000", 0x0100152000022000ULL));
+    ASSERT_FALSE(redundant_title_selected("01003BC0000A0000", 0x0100152000022000ULL));
+    return true;
+}
+
+bool test_disabled_does_nothing() {
+    RedundantPath path;
+    auto plan = path.plan_send(MakeInfo(IP_A, IP_B), 32, true, 0);
+    ASSERT_FALSE(plan.duplicate);
+    ASSERT_FALSE(plan.send_hello);
+    return true;
+}
+
+bool test_only_small_unicast_udp() {
+    Pair pair;
+    auto& sender = pair.sender;
+
+    ASSERT_FALSE(sender.plan_send(MakeInfo(IP_A, IP_B, GAME_PORT, ProtocolType::Tcp), 32, true, 10).duplicate);
+    ASSERT_FALSE(sender.plan_send(MakeInfo(IP_A, IP_B), REDUNDANT_MAX_PAYLOAD + 1, true, 10).duplicate);
+    ASSERT_FALSE(sender.plan_send(MakeInfo(IP_A, 0x0A7200FF), 32, true, 10).duplicate);
+    ASSERT_FALSE(sender.plan_send(MakeInfo(IP_A, 0xFFFFFFFF), 32, true, 10).duplicate);
+    ASSERT_TRUE(sender.plan_send(MakeInfo(IP_A, IP_B), REDUNDANT_MAX_PAYLOAD, true, 10).duplicate);
+    return true;
+}
+
+bool test_port_list() {
+    Pair pair;
+    RedundantPathConfig config = Enabled();
+    redundant_parse_ports("30000, 11452,bogus,70000", config);
+    ASSERT_EQ(config.port_count, 2u);
+    ASSERT_EQ(config.ports[0], 30000);
+    ASSERT_EQ(config.ports[1], 11452);
+    pair.sender.configure(config);
+
+    // Either end of the flow selects it
+    ASSERT_TRUE(pair.sender.plan_send(MakeInfo(IP_A, IP_B, 11452), 32, true, 10).duplicate);
+    ProxyInfo reply = MakeInfo(IP_A, IP_B, 49152);
+    reply.source_port = 30000;
+    ASSERT_TRUE(pair.sender.plan_send(reply, 32, true, 10).duplicate);
+    ASSERT_FALSE(pair.sender.plan_send(MakeInfo(IP_A, IP_B, 49152), 32, true, 10).duplicate);
+
+    redundant_parse_ports("", config);
+    ASSERT_EQ(config.port_count, 0u);
+    return true;
+}
+
+bool test_needs_two_paths() {
+    Pair pair;
+    ASSERT_FALSE(pair.sender.plan_send(MakeInfo(IP_A, IP_B), 32, false, 10).duplicate);
+    ASSERT_TRUE(pair.sender.plan_send(MakeInfo(IP_A, IP_B), 32, true, 10).duplicate);
+    return true;
+}
+
+// ============================================================================
+// Discovery Tests
+// ============================================================================
+
+bool test_hello_before_tagging() {
+    RedundantPath path;
+    path.configure(Enabled());
+    path.reset();
+
+    auto plan = path.plan_send(MakeInfo(IP_A, IP_B), 32, true, 0);
+    ASSERT_TRUE(plan.send_hello);
+    ASSERT_FALSE(plan.duplicate);
+
+    // Not repeated before the interval
+    plan = path.plan_send(MakeInfo(IP_A, IP_B), 32, true, 100);
+    ASSERT_FALSE(plan.send_hello);
+    ASSERT_FALSE(plan.duplicate);
+    return true;
+}
+
+bool test_ryujinx_peer_never_tagged() {
+    RedundantPath path;
+    path.configure(Enabled());
+    path.reset();
+
+    // No Ack ever comes back: a few Hellos, then silence, never a duplicate
+    uint32_t hellos = 0;
+    for (uint64_t now = 0; now < 60000; now += 16) {
+        auto plan = path.plan_send(MakeInfo(IP_A, IP_B), 32, true, now);
+        ASSERT_FALSE(plan.duplicate);
+        hellos += plan.send_hello ? 1 : 0;
+    }
+    ASSERT_EQ(hellos, REDUNDANT_HELLO_ATTEMPTS);
+    ASSERT_FALSE(path.is_capable(IP_B));
+    return true;
+}
+
+bool test_hello_is_acked_and_consumed() {
+    RedundantPath receiver;  // Option off: still answers
+
+    auto hello = RedundantPath::make_control(RedundantControlType::Hello);
+    uint32_t size = sizeof(hello);
+    bool reply_ack = false;
+    auto verdict = receiver.on_receive(MakeInfo(IP_A, IP_B, REDUNDANT_CONTROL_PORT), false,
+                                       reinterpret_cast<const uint8_t*>(&hello), size, reply_ack, 0);
+    ASSERT_TRUE(verdict == RedundantVerdict::Control);
+    ASSERT_TRUE(reply_ack);
+    ASSERT_TRUE(receiver.is_capable(IP_A));
+
+    auto ack = RedundantPath::make_control(RedundantControlType::Ack);
+    size = sizeof(ack);
+    RedundantPath sender;
+    verdict = sender.on_receive(MakeInfo(IP_B, IP_A, REDUNDANT_CONTROL_PORT), false,
+                                reinterpret_cast<const uint8_t*>(&ack), size, reply_ack, 0);
+    ASSERT_TRUE(verdict == RedundantVerdict::Control);
+    ASSERT_FALSE(reply_ack);
+    ASSERT_TRUE(sender.is_capable(IP_B));
+    return true;
+}
+
+bool test_hello_for_tcp_with_option_off() {
+    RedundantPath path;  // Duplication off: discovery still runs for optimistic connect
+
+    ASSERT_TRUE(path.plan_hello(IP_B, 0));
+    ASSERT_FALSE(path.plan_hello(IP_B, 100));
+    ASSERT_FALSE(path.plan_hello(0x0A72FFFF, 0));
+
+    auto ack = RedundantPath::make_control(RedundantControlType::Ack);
+    uint32_t size = sizeof(ack);
+    bool reply_ack = false;
+    path.on_receive(MakeInfo(IP_B, IP_A, REDUNDANT_CONTROL_PORT), false,
+                    reinterpret_cast<const uint8_t*>(&ack), size, reply_ack, 200);
+    ASSERT_TRUE(path.is_capable(IP_B));
+    ASSERT_FALSE(path.plan_hello(IP_B, REDUNDANT_HELLO_INTERVAL_MS + 200));
+    return true;
+}
+
+// ============================================================================
+// Duplicate Filter Tests
+// ============================================================================
+
+bool test_second_copy_dropped() {
+    Pair pair;
+    const uint8_t payload[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+    auto plan = pair.sender.plan_send(MakeInfo(IP_A, IP_B), sizeof(payload), true, 10);
+    ASSERT_TRUE(plan.duplicate);
+    auto tagged = Tag(payload, sizeof(payload), plan.trailer);
+
+    bool reply_ack;
+    uint32_t size = static_cast<uint32_t>(tagged.size());
+    auto verdict = pair.receiver.on_receive(MakeInfo(IP_A, IP_B), true, tagged.data(), size, reply_ack, 12);
+    ASSERT_TRUE(verdict == RedundantVerdict::Deliver);
+    ASSERT_EQ(size, sizeof(payload));
+    ASSERT_TRUE(std::memcmp(tagged.data(), payload, sizeof(payload)) == 0);
+
+    size = static_cast<uint32_t>(tagged.size());
+    verdict = pair.receiver.on_receive(MakeInfo(IP_A, IP_B), true, tagged.data(), size, reply_ack, 40);
+    ASSERT_TRUE(verdict == RedundantVerdict::Duplicate);
+    ASSERT_EQ(pair.receiver.stats().duplicates_dropped, 1);
+    return true;
+}
+
+bool test_reordered_copies_delivered_once() {
+    Pair pair;
+    const uint8_t payload[8] = {};
+    std::vector<std::vector<uint8_t>> packets;
+    for (int i = 0; i < 5; i++) {
+        auto plan = pair.sender.plan_send(MakeInfo(IP_A, IP_B), sizeof(payload), true, 10 + i);
+        ASSERT_TRUE(plan.duplicate);
+        packets.push_back(Tag(payload, sizeof(payload), plan.trailer));
+    }
+
+    // Path 1 delivers 0, 2, 4; path 2 delivers everything in reverse
+    const int order[] = {0, 2, 4, 4, 3, 2, 1, 0};
+    int delivered = 0;
+    bool reply_ack;
+    for (int index : order) {
+        uint32_t size = static_cast<uint32_t>(packets[index].size());
+        if (pair.receiver.on_receive(MakeInfo(IP_A, IP_B), true, packets[index].data(), size, reply_ack, 20) ==
+            RedundantVerdict::Deliver) {
+            delivered++;
+        }
+    }
+    ASSERT_EQ(delivered, 5);
+    return true;
+}
+
+bool test_untagged_from_unknown_peer_untouched() {
+    RedundantPath receiver;
+
+    // A Ryujinx payload that happens to end with the trailer magic
+    RedundantTrailer fake{};
+    fake.magic = REDUNDANT_TRAILER_MAGIC;
+    const uint8_t payload[4] = {9, 9, 9, 9};
+    auto packet = Tag(payload, sizeof(payload), fake);
+
+    bool reply_ack;
+    uint32_t size = static_cast<uint32_t>(packet.size());
+    auto verdict = receiver.on_receive(MakeInfo(IP_A, IP_B), false, packet.data(), size, reply_ack, 0);
+    ASSERT_TRUE(verdict == RedundantVerdict::Deliver);
+    ASSERT_EQ(size, packet.size());
+    return true;
+}
+
+bool test_untagged_magic_tail_from_capable_peer_untouched() {
+    Pair pair;
+
+    // Broadcast, oversized or over-budget sends go out untagged to a capable peer
+    RedundantTrailer fake{};
+    fake.magic = REDUNDANT_TRAILER_MAGIC;
+    const uint8_t payload[4] = {9, 9, 9, 9};
+    auto packet = Tag(payload, sizeof(payload), fake);
+
+    bool reply_ack;
+    uint32_t size = static_cast<uint32_t>(packet.size());
+    auto verdict = pair.receiver.on_receive(MakeInfo(IP_A, IP_B), false, packet.data(), size, reply_ack, 10);
+    ASSERT_TRUE(verdict == RedundantVerdict::Deliver);
+    ASSERT_EQ(size, packet.size());
+    return true;
+}
+
+bool test_tag_flag_round_trip() {
+    ProxyInfo info = MakeInfo(IP_A, IP_B);
+    info.protocol = redundant_tagged_protocol(info.protocol);
+    ASSERT_TRUE(info.protocol != ProtocolType::Udp);
+
+    ASSERT_TRUE(redundant_take_tag(info));
+    ASSERT_TRUE(info.protocol == ProtocolType::Udp);
+    ASSERT_FALSE(redundant_take_tag(info));
+    ASSERT_TRUE(info.protocol == ProtocolType::Udp);
+    return true;
+}
+
+bool test_flow_restarts_after_idle() {
+    Pair pair;
+    const uint8_t payload[8] = {};
+    auto plan = pair.sender.plan_send(MakeInfo(IP_A, IP_B), sizeof(payload), true, 10);
+    auto packet = Tag(payload, sizeof(payload), plan.trailer);
+
+    bool reply_ack;
+    uint32_t size = static_cast<uint32_t>(packet.size());
+    pair.receiver.on_receive(MakeInfo(IP_A, IP_B), true, packet.data(), size, reply_ack, 10);
+
+    // Same sequence after a long pause (sender restarted): delivered again
+    size = static_cast<uint32_t>(packet.size());
+    auto verdict = pair.receiver.on_receive(MakeInfo(IP_A, IP_B), true, packet.data(), size, reply_ack,
+                                            10 + REDUNDANT_FLOW_IDLE_MS + 1);
+    ASSERT_TRUE(verdict == RedundantVerdict::Deliver);
+    return true;
+}
+
+// ============================================================================
+// Budget Tests
+// ============================================================================
+
+bool test_budget_bounds_overhead() {
+    constexpr uint32_t BUDGET = 4096;
+    Pair pair(BUDGET);
+
+    // 60 packets/s of 64 bytes for 10 s: ~7 KB/s wanted, 4 KB/s allowed
+    for (uint64_t now = 0; now < 10000; now += 16) {
+        pair.sender.plan_send(MakeInfo(IP_A, IP_B), 64, true, now);
+    }
+
+    const auto& stats = pair.sender.stats();
+    ASSERT_TRUE(stats.duplicated > 0);
+    ASSERT_TRUE(stats.budget_limited > 0);
+    // One second of burst plus ten seconds of refill
+    ASSERT_TRUE(stats.duplicated_bytes <= BUDGET * 11ULL);
+    return true;
+}
+
+// ============================================================================
+// Loss Simulation
+// ============================================================================
+
+/**
+ * @brief Tail latency of one path vs both under independent loss
+ *
+ * P2P: 15 ms, relay: 45 ms, each with 3% loss costing a 200 ms TCP
+ * retransmission. One path sees the retransmissions in its p99; with both,
+ * a packet is only late when both copies are.
+ */
+bool test_loss_simulation_tail_latency() {
+    constexpr int PACKETS = 20000;
+    constexpr double LOSS = 0.03;
+    constexpr double RTO_MS = 200.0;
+    constexpr double P2P_MS = 15.0;
+    constexpr double RELAY_MS = 45.0;
+
+    Pair pair(1024 * 1024);
+    Lcg rng{42};
+    const uint8_t payload[32] = {};
+
+    std::vector<double> single;
+    std::vector<double> dual;
+    int delivered_twice = 0;
+
+    for (int i = 0; i < PACKETS; i++) {
+        uint64_t now = static_cast<uint64_t>(i) * 16;
+        double p2p = P2P_MS + (rng.next() < LOSS ? RTO_MS : 0.0) + rng.next() * 2.0;
+        double relay = RELAY_MS + (rng.next() < LOSS ? RTO_MS : 0.0) + rng.next() * 4.0;
+        single.push_back(p2p);
+
+        auto plan = pair.sender.plan_send(MakeInfo(IP_A, IP_B), sizeof(payload), true, now);
+        ASSERT_TRUE(plan.duplicate);
+        auto packet = Tag(payload, sizeof(payload), plan.trailer);
+
+        // Copies arrive in latency order, the receiver keeps the first
+        double first = std::min(p2p, relay);
+        double second = std::max(p2p, relay);
+        bool reply_ack;
+        uint32_t size = static_cast<uint32_t>(packet.size());
+        auto v1 = pair.receiver.on_receive(MakeInfo(IP_A, IP_B), true, packet.data(), size, reply_ack,
+                                           now + static_cast<uint64_t>(first));
+        size = static_cast<uint32_t>(packet.size());
+        auto v2 = pair.receiver.on_receive(MakeInfo(IP_A, IP_B), true, packet.data(), size, reply_ack,
+                                           now + static_cast<uint64_t>(second));
+        ASSERT_TRUE(v1 == RedundantVerdict::Deliver);
+        if (v2 == RedundantVerdict::Deliver) {
+            delivered_twice++;
+        }
+        dual.push_back(first);
+    }
+
+    double single_p99 = Percentile(single, 0.99);
+    double dual_p99 = Percentile(dual, 0.99);
+    printf("\n    single: p50 %.1f p99 %.1f p99.9 %.1f ms\n",
+           Percentile(single, 0.50), single_p99, Percentile(single, 0.999));
+    printf("    dual:   p50 %.1f p99 %.1f p99.9 %.1f ms, overhead %.1f B/pkt... ",
+           Percentile(dual, 0.50), dual_p99, Percentile(dual, 0.999),
+           static_cast<double>(pair.sender.stats().duplicated_bytes) / PACKETS);
+
+    ASSERT_EQ(delivered_twice, 0);
+    ASSERT_TRUE(dual_p99 < single_p99);
+    ASSERT_TRUE(dual_p99 < RELAY_MS + 10.0);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Redundant Path Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Selection Tests:\n");
+    RUN_TEST(test_title_list);
+    RUN_TEST(test_disabled_does_nothing);
+    RUN_TEST(test_only_small_unicast_udp);
+    RUN_TEST(test_port_list);
+    RUN_TEST(test_needs_two_paths);
+
+    printf("\nDiscovery Tests:\n");
+    RUN_TEST(test_hello_before_tagging);
+    RUN_TEST(test_ryujinx_peer_never_tagged);
+    RUN_TEST(test_hello_is_acked_and_consumed);
+    RUN_TEST(test_hello_for_tcp_with_option_off);
+
+    printf("\nDuplicate Filter Tests:\n");
+    RUN_TEST(test_second_copy_dropped);
+    RUN_TEST(test_reordered_copies_delivered_once);
+    RUN_TEST(test_untagged_from_unknown_peer_untouched);
+    RUN_TEST(test_untagged_magic_tail_from_capable_peer_untouched);
+    RUN_TEST(test_tag_flag_round_trip);
+    RUN_TEST(test_flow_restarts_after_idle);
+
+    printf("\nBudget Tests:\n");
+    RUN_TEST(test_budget_bounds_overhead);
+
+    printf("\nLoss Simulation:\n");
+    RUN_TEST(test_loss_simulation_tail_latency);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,946 @@
+/**
+ * @file relay_delegation_tests.cpp
+ * @brief Unit tests for P2P host fan-out delegation
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Wire Tests
+ * Control parsing, Forward wrap/unwrap, rate meter.
+ *
+ * ### Election Tests
+ * Threshold, most spare uplink, tie break, hysteresis, release.
+ *
+ * ### Handshake Tests
+ * Direct fan-out until Accept and Joined, guest side replies and filters.
+ *
+ * ### Failover Tests
+ * Delegate lost or silent, target lost.
+ *
+ * ### Capped Uplink Simulation
+ * 8 nodes, host uplink below its fan-out: delivery latency and backlog with
+ * and without delegation, and with the delegate dropping mid-session.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <vector>
+
+#include "p2p/relay_delegation.hpp"
+
+using namespace ryu_ldn::p2p;
+using ryu_ldn::protocol::ProxyInfo;
+using ryu_ldn::protocol::ProtocolType;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t IP_BASE = 0x0A720001;  // 10.114.0.1, the host
+
+uint32_t Ip(int node) {
+    return IP_BASE + static_cast<uint32_t>(node);
+}
+
+RelayDelegationConfig Enabled(uint32_t uplink_kbps) {
+    RelayDelegationConfig config{};
+    config.enabled = true;
+    config.uplink_kbps = uplink_kbps;
+    return config;
+}
+
+RelayControl Report(uint32_t capacity_kbps, uint32_t used_kbps = 0, uint32_t relay_kbps = 0) {
+    RelayControl report = make_relay_control(RelayControlType::Report);
+    report.capacity_kbps = capacity_kbps;
+    report.used_kbps = used_kbps;
+    report.relay_kbps = relay_kbps;
+    return report;
+}
+
+/**
+ * @brief Feed the host fan-out at a steady rate, reports every second
+ */
+void Load(RelayDelegation& host, uint32_t kbps, uint64_t from_ms, uint64_t to_ms,
+          const uint32_t* capacities, int guests, size_t remote_guests = 7) {
+    for (uint64_t now = from_ms; now < to_ms; now += 10) {
+        host.on_copy(kbps * 10 / 8, true, now);
+        if (now % RELAY_REPORT_INTERVAL_MS == 0) {
+            for (int g = 0; g < guests; g++) {
+                host.on_control(Ip(g + 1), Report(capacities[g]), now);
+            }
+        }
+        host.update(remote_guests, now);
+    }
+}
+
+/**
+ * @brief Answer every pending message as a guest would
+ */
+void AnswerAll(RelayDelegation& host, uint64_t now) {
+    RelayMessage messages[32];
+    size_t count = host.take_messages(messages, 32);
+    for (size_t i = 0; i < count; i++) {
+        const auto& control = messages[i].control;
+        if (control.type == RelayControlType::Assign) {
+            host.on_control(messages[i].dest_ip, make_relay_control(RelayControlType::Accept), now);
+        } else if (control.type == RelayControlType::Join) {
+            RelayControl joined = make_relay_control(RelayControlType::Joined);
+            joined.peer_ip = control.peer_ip;
+            host.on_control(messages[i].dest_ip, joined, now);
+        }
+    }
+}
+
+double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+    return values[index];
+}
+
+} // namespace
+
+// ============================================================================
+// Wire Tests
+// ============================================================================
+
+bool test_control_parsing() {
+    RelayControl control = Report(10000);
+    ProxyInfo info{};
+    info.dest_port = RELAY_CONTROL_PORT;
+    info.protocol = ProtocolType::Udp;
+
+    RelayControl parsed;
+    ASSERT_TRUE(parse_relay_control(info, reinterpret_cast<const uint8_t*>(&control),
+                                    sizeof(control), parsed));
+    ASSERT_EQ(parsed.capacity_kbps, 10000);
+
+    // Game port, short payload, foreign magic
+    info.dest_port = 12345;
+    ASSERT_FALSE(parse_relay_control(info, reinterpret_cast<const uint8_t*>(&control),
+                                     sizeof(control), parsed));
+    info.dest_port = RELAY_CONTROL_PORT;
+    ASSERT_FALSE(parse_relay_control(info, reinterpret_cast<const uint8_t*>(&control),
+                                     sizeof(control) - 1, parsed));
+    control.magic = 0x43504452;  // "RDPC" (redundant path)
+    ASSERT_FALSE(parse_relay_control(info, reinterpret_cast<const uint8_t*>(&control),
+                                     sizeof(control), parsed));
+    return true;
+}
+
+bool test_forward_round_trip() {
+    ProxyInfo info{};
+    info.source_ipv4 = Ip(3);
+    info.source_port = 12345;
+    info.dest_ipv4 = 0x0A72FFFF;
+    info.dest_port = 12345;
+    info.protocol = ProtocolType::Udp;
+    const uint8_t payload[] = "state";
+    const uint32_t targets[] = {Ip(4), Ip(5)};
+
+    uint8_t wrapped[RELAY_FORWARD_OVERHEAD + sizeof(payload)];
+    ASSERT_EQ(build_relay_forward(targets, 2, info, payload, sizeof(payload), wrapped, sizeof(wrapped) - 1), 0);
+    size_t size = build_relay_forward(targets, 2, info, payload, sizeof(payload), wrapped, sizeof(wrapped));
+    ASSERT_EQ(size, sizeof(wrapped));
+
+    RelayControl control;
+    ProxyInfo inner_info;
+    const uint8_t* inner = nullptr;
+    uint32_t inner_size = 0;
+    ASSERT_TRUE(parse_relay_forward(wrapped, size, control, inner_info, inner, inner_size));
+    ASSERT_EQ(control.count, 2);
+    ASSERT_EQ(control.targets[1], Ip(5));
+    ASSERT_EQ(inner_info.source_ipv4, Ip(3));
+    ASSERT_EQ(inner_info.dest_ipv4, 0x0A72FFFF);
+    ASSERT_EQ(inner_size, sizeof(payload));
+    ASSERT_TRUE(std::memcmp(inner, payload, sizeof(payload)) == 0);
+
+    ASSERT_FALSE(parse_relay_forward(wrapped, RELAY_FORWARD_OVERHEAD - 1, control, inner_info, inner, inner_size));
+    return true;
+}
+
+bool test_rate_meter() {
+    RelayRateMeter meter;
+
+    // 125 bytes every ms = 1000 kbit/s
+    for (uint64_t now = 0; now < 5000; now++) {
+        meter.add(125, now);
+    }
+    uint32_t busy = meter.kbps(5000);
+    ASSERT_TRUE(busy > 950 && busy <= 1000);
+
+    // Decays to zero once idle
+    ASSERT_TRUE(meter.kbps(5500) < busy);
+    ASSERT_EQ(meter.kbps(10000), 0);
+    return true;
+}
+
+// ============================================================================
+// Election Tests
+// ============================================================================
+
+bool test_no_delegation_below_threshold() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+    const uint32_t capacities[] = {10000, 10000, 10000};
+
+    // 70% of the uplink
+    Load(host, 700, 0, 5000, capacities, 3);
+    RelayMessage messages[16];
+    ASSERT_EQ(host.take_messages(messages, 16), 0);
+    ASSERT_EQ(host.stats().elections, 0);
+
+    // Disabled: never, whatever the load
+    RelayDelegation off;
+    off.configure(RelayDelegationConfig{false, 1000});
+    Load(off, 5000, 0, 5000, capacities, 3);
+    ASSERT_EQ(off.stats().elections, 0);
+    return true;
+}
+
+bool test_elects_most_spare_uplink() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    // Guest 3 has the most spare uplink; guest 4 never reported capacity
+    const uint32_t capacities[] = {2000, 5000, 20000, 0};
+    Load(host, 2000, 0, 3000, capacities, 4);
+    ASSERT_EQ(host.stats().elections, 1);
+
+    RelayMessage messages[16];
+    size_t count = host.take_messages(messages, 16);
+    ASSERT_TRUE(count >= 2);
+    bool assigned = false;
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i].control.type == RelayControlType::Assign) {
+            ASSERT_EQ(messages[i].dest_ip, Ip(3));
+            assigned = true;
+        } else {
+            ASSERT_TRUE(messages[i].control.type == RelayControlType::Join);
+            ASSERT_EQ(messages[i].control.peer_ip, Ip(3));
+            ASSERT_TRUE(messages[i].dest_ip != Ip(3));
+        }
+    }
+    ASSERT_TRUE(assigned);
+    return true;
+}
+
+bool test_tie_goes_to_lowest_ip() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    const uint32_t capacities[] = {10000, 10000, 10000};
+    // Reports arrive from the highest IP first
+    for (int g = 3; g >= 1; g--) {
+        host.on_control(Ip(g), Report(capacities[g - 1]), 0);
+    }
+    Load(host, 2000, 0, 3000, capacities, 3);
+
+    RelayMessage messages[16];
+    size_t count = host.take_messages(messages, 16);
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i].control.type == RelayControlType::Assign) {
+            ASSERT_EQ(messages[i].dest_ip, Ip(1));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool test_hysteresis_keeps_delegate() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    uint32_t capacities[] = {10000, 8000, 1000};
+    Load(host, 2000, 0, 3000, capacities, 3);
+    AnswerAll(host, 3000);
+    ASSERT_EQ(host.delegate(), Ip(1));
+
+    // Guest 2 becomes 20% better than the delegate: not enough to switch
+    capacities[1] = 12000;
+    Load(host, 2000, 3000, 8000, capacities, 3);
+    ASSERT_EQ(host.delegate(), Ip(1));
+    ASSERT_EQ(host.stats().elections, 1);
+
+    // 50% better: switch, the old delegate and its targets are released
+    capacities[1] = 15000;
+    Load(host, 2000, 8000, 10000, capacities, 3);
+    ASSERT_EQ(host.stats().elections, 2);
+    RelayMessage messages[32];
+    size_t count = host.take_messages(messages, 32);
+    bool old_released = false;
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i].dest_ip == Ip(1) && messages[i].control.type == RelayControlType::Release) {
+            old_released = true;
+        }
+    }
+    ASSERT_TRUE(old_released);
+    ASSERT_EQ(host.delegate(), 0);
+    return true;
+}
+
+bool test_release_when_demand_drops() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    const uint32_t capacities[] = {10000, 10000, 10000};
+    Load(host, 2000, 0, 3000, capacities, 3);
+    AnswerAll(host, 3000);
+    ASSERT_TRUE(host.delegate() != 0);
+
+    // 60%: above the release threshold, kept
+    Load(host, 600, 3000, 8000, capacities, 3);
+    ASSERT_TRUE(host.delegate() != 0);
+
+    // 30%: back to direct fan-out
+    Load(host, 300, 8000, 13000, capacities, 3);
+    ASSERT_EQ(host.delegate(), 0);
+    ASSERT_EQ(host.stats().releases, 1);
+    return true;
+}
+
+// ============================================================================
+// Handshake Tests
+// ============================================================================
+
+bool test_direct_until_accept_and_join() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    const uint32_t capacities[] = {10000, 1000, 1000};
+    Load(host, 2000, 0, 3000, capacities, 3);
+
+    RelayMessage messages[16];
+    size_t count = host.take_messages(messages, 16);
+    ASSERT_EQ(count, 3);  // Join x2, Assign
+
+    // Nothing skipped before the delegate accepted
+    ASSERT_EQ(host.delegate(), 0);
+    ASSERT_FALSE(host.is_delegated(Ip(2)));
+
+    host.on_control(Ip(1), make_relay_control(RelayControlType::Accept), 3000);
+    ASSERT_EQ(host.delegate(), 0);  // No target joined yet
+
+    RelayControl joined = make_relay_control(RelayControlType::Joined);
+    joined.peer_ip = Ip(1);
+    host.on_control(Ip(2), joined, 3000);
+    ASSERT_EQ(host.delegate(), Ip(1));
+    ASSERT_TRUE(host.is_delegated(Ip(2)));
+    ASSERT_FALSE(host.is_delegated(Ip(3)));
+
+    // A Joined naming another delegate is ignored
+    joined.peer_ip = Ip(2);
+    host.on_control(Ip(3), joined, 3000);
+    ASSERT_FALSE(host.is_delegated(Ip(3)));
+
+    uint32_t targets[RELAY_MAX_TARGETS];
+    ASSERT_EQ(host.active_targets(targets), 1);
+    ASSERT_EQ(targets[0], Ip(2));
+    return true;
+}
+
+bool test_member_replies_and_filters() {
+    RelayMember member;
+    member.configure(Enabled(10000));
+
+    RelayControl assign = make_relay_control(RelayControlType::Assign);
+    assign.count = 2;
+    assign.targets[0] = Ip(2);
+    assign.targets[1] = Ip(3);
+    RelayControl reply;
+    ASSERT_TRUE(member.on_host_control(assign, 0, reply));
+    ASSERT_TRUE(reply.type == RelayControlType::Accept);
+    ASSERT_TRUE(member.is_delegate());
+
+    // Only assigned targets are re-sent to
+    RelayControl forward = make_relay_control(RelayControlType::Forward);
+    forward.count = 3;
+    forward.targets[0] = Ip(2);
+    forward.targets[1] = Ip(4);
+    forward.targets[2] = Ip(3);
+    uint32_t targets[RELAY_MAX_TARGETS];
+    ASSERT_EQ(member.forward_targets(forward, targets), 2);
+    ASSERT_EQ(targets[0], Ip(2));
+    ASSERT_EQ(targets[1], Ip(3));
+
+    ASSERT_FALSE(member.on_host_control(make_relay_control(RelayControlType::Release), 0, reply));
+    ASSERT_FALSE(member.is_delegate());
+    ASSERT_EQ(member.forward_targets(forward, targets), 0);
+    return true;
+}
+
+bool test_target_accepts_only_its_delegate() {
+    RelayMember member;
+    member.configure(Enabled(1000));
+    ASSERT_FALSE(member.accept_forward(Ip(1), 0));
+
+    RelayControl join = make_relay_control(RelayControlType::Join);
+    join.peer_ip = Ip(1);
+    RelayControl reply;
+    ASSERT_TRUE(member.on_host_control(join, 0, reply));
+    ASSERT_TRUE(reply.type == RelayControlType::Joined);
+    ASSERT_EQ(reply.peer_ip, Ip(1));
+
+    ASSERT_TRUE(member.accept_forward(Ip(1), 100));
+    ASSERT_FALSE(member.accept_forward(Ip(2), 100));
+
+    // Forwards already in the relay are still accepted for a while
+    member.on_host_control(make_relay_control(RelayControlType::Release), 1000, reply);
+    ASSERT_TRUE(member.accept_forward(Ip(1), 1000 + RELAY_RELEASE_GRACE_MS - 1));
+    ASSERT_FALSE(member.accept_forward(Ip(1), 1000 + RELAY_RELEASE_GRACE_MS));
+    return true;
+}
+
+bool test_member_reports() {
+    RelayMember off;
+    off.configure(RelayDelegationConfig{true, 0});
+    RelayControl report;
+    ASSERT_FALSE(off.make_report(0, 0, report));
+
+    RelayMember member;
+    member.configure(Enabled(10000));
+    ASSERT_TRUE(member.make_report(0, 0, report));
+    ASSERT_EQ(report.capacity_kbps, 10000);
+    ASSERT_FALSE(member.make_report(1000, 500, report));
+
+    // 125000 bytes in one second = 1000 kbit/s
+    ASSERT_TRUE(member.make_report(125000, 1000, report));
+    ASSERT_EQ(report.used_kbps, 1000);
+    return true;
+}
+
+// ============================================================================
+// Failover Tests
+// ============================================================================
+
+bool test_failover_on_delegate_loss() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    const uint32_t capacities[] = {10000, 8000, 1000};
+    Load(host, 2000, 0, 3000, capacities, 3);
+    AnswerAll(host, 3000);
+    ASSERT_EQ(host.delegate(), Ip(1));
+    ASSERT_TRUE(host.is_delegated(Ip(3)));
+
+    // Session closed: direct fan-out at once, targets released
+    host.on_peer_lost(Ip(1), 3000);
+    ASSERT_EQ(host.delegate(), 0);
+    ASSERT_FALSE(host.is_delegated(Ip(3)));
+    ASSERT_EQ(host.stats().failovers, 1);
+
+    // Next update elects the runner-up
+    host.update(7, 3010);
+    RelayMessage messages[32];
+    size_t count = host.take_messages(messages, 32);
+    bool released = false;
+    bool assigned = false;
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i].control.type == RelayControlType::Release && messages[i].dest_ip == Ip(3)) {
+            released = true;
+        }
+        if (messages[i].control.type == RelayControlType::Assign) {
+            ASSERT_EQ(messages[i].dest_ip, Ip(2));
+            assigned = true;
+        }
+    }
+    ASSERT_TRUE(released);
+    ASSERT_TRUE(assigned);
+    return true;
+}
+
+bool test_failover_on_silent_delegate() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    const uint32_t capacities[] = {10000, 8000};
+    Load(host, 2000, 0, 3000, capacities, 2);
+    AnswerAll(host, 3000);
+    ASSERT_EQ(host.delegate(), Ip(1));
+
+    // Guest 1 stops reporting, guest 2 keeps going
+    const uint32_t silent[] = {8000};
+    for (uint64_t now = 3000; now < 3000 + RELAY_REPORT_TIMEOUT_MS + 1000; now += 10) {
+        host.on_copy(2000 * 10 / 8, true, now);
+        if (now % RELAY_REPORT_INTERVAL_MS == 0) {
+            host.on_control(Ip(2), Report(silent[0]), now);
+        }
+        host.update(7, now);
+    }
+    ASSERT_EQ(host.stats().failovers, 1);
+    ASSERT_FALSE(host.is_delegated(Ip(2)));
+    return true;
+}
+
+bool test_target_loss_shrinks_assignment() {
+    RelayDelegation host;
+    host.configure(Enabled(1000));
+
+    const uint32_t capacities[] = {10000, 1000, 1000};
+    Load(host, 2000, 0, 3000, capacities, 3);
+    AnswerAll(host, 3000);
+    ASSERT_TRUE(host.is_delegated(Ip(2)));
+    ASSERT_TRUE(host.is_delegated(Ip(3)));
+
+    host.on_peer_lost(Ip(2), 3000);
+    ASSERT_EQ(host.delegate(), Ip(1));
+    ASSERT_TRUE(host.is_delegated(Ip(3)));
+
+    RelayMessage messages[16];
+    size_t count = host.take_messages(messages, 16);
+    ASSERT_EQ(count, 1);
+    ASSERT_TRUE(messages[0].control.type == RelayControlType::Assign);
+    ASSERT_EQ(messages[0].control.count, 1);
+    ASSERT_EQ(messages[0].control.targets[0], Ip(3));
+    return true;
+}
+
+// ============================================================================
+// Capped Uplink Simulation
+// ============================================================================
+
+namespace {
+
+/**
+ * @brief 8 consoles on capped uplinks, the host fanning out every broadcast
+ *
+ * Virtual time. Each node has one FIFO uplink: a packet leaves once the
+ * previous ones are serialized at the node's rate, then takes the path
+ * latency. Downlinks and the relay server are not limiting. Every node
+ * broadcasts a 100 byte state packet at 30 Hz; the host sends each one to
+ * all 7 guests, like P2pProxyServer::RouteMessage.
+ */
+class UplinkSim {
+public:
+    static constexpr int NODES = 8;
+    static constexpr uint32_t WIRE_OVERHEAD = 30;   // Packet + ProxyData headers
+    static constexpr uint32_t PAYLOAD = 100;
+    static constexpr uint64_t BROADCAST_INTERVAL_MS = 33;
+    static constexpr double P2P_MS = 10.0;          // Guest <-> host
+    static constexpr double RELAY_MS = 30.0;        // Delegate -> server -> target
+    static constexpr uint64_t IN_FLIGHT_MS = 100;   // Lost with a dropped delegate
+
+    struct Result {
+        double p50;
+        double p99;
+        double max_backlog_ms;
+        uint64_t missing;
+        uint64_t duplicates;
+    };
+
+    UplinkSim(bool delegation, const uint32_t* uplinks_kbps) {
+        for (int i = 0; i < NODES; i++) {
+            m_uplink[i] = uplinks_kbps[i];
+            m_next_free[i] = 0.0;
+            m_tx_bytes[i] = 0;
+            m_alive[i] = true;
+            m_member[i].configure(RelayDelegationConfig{delegation, uplinks_kbps[i]});
+        }
+        m_host.configure(RelayDelegationConfig{delegation, uplinks_kbps[0]});
+    }
+
+    /**
+     * @brief Run, measuring broadcasts sent in [measure_from, measure_to)
+     *
+     * @param drop_node Guest that disappears at drop_ms (0: none)
+     */
+    Result run(uint64_t duration_ms, uint64_t measure_from, uint64_t measure_to,
+               int drop_node = 0, uint64_t drop_ms = 0) {
+        m_measure_from = measure_from;
+        m_measure_to = measure_to;
+        m_drop_node = drop_node;
+        m_drop_ms = drop_ms;
+
+        for (uint64_t now = 0; now < duration_ms; now++) {
+            deliver_until(static_cast<double>(now));
+
+            if (drop_node != 0 && now == drop_ms) {
+                // P2P session closed: the host fails over at once
+                m_alive[drop_node] = false;
+                m_host.on_peer_lost(Ip(drop_node), now);
+            }
+
+            for (int node = 0; node < NODES; node++) {
+                if (m_alive[node] && now % BROADCAST_INTERVAL_MS == static_cast<uint64_t>(node) * 4) {
+                    broadcast(node, now);
+                }
+            }
+
+            if (now % 100 == 0) {
+                tick(now);
+            }
+            m_max_backlog = std::max(m_max_backlog, m_next_free[0] - static_cast<double>(now));
+        }
+        deliver_until(1e18);
+
+        Result result{};
+        result.p50 = Percentile(m_latencies, 0.50);
+        result.p99 = Percentile(m_latencies, 0.99);
+        result.max_backlog_ms = m_max_backlog;
+        for (const auto& b : m_broadcasts) {
+            if (b.born < measure_from || b.born >= measure_to) {
+                continue;
+            }
+            for (int node = 1; node < NODES; node++) {
+                if (excluded(b, node)) {
+                    continue;
+                }
+                if (b.received[node] == 0) {
+                    result.missing++;
+                } else if (b.received[node] > 1) {
+                    result.duplicates += b.received[node] - 1;
+                }
+            }
+        }
+        return result;
+    }
+
+    const RelayDelegationStats& host_stats() const { return m_host.stats(); }
+
+private:
+    enum class Kind { ToHost, Direct, Forward, RelayLeg, Control };
+
+    struct Packet {
+        double arrival;
+        int from;
+        int to;
+        Kind kind;
+        size_t broadcast;
+        RelayControl control;
+
+        bool operator>(const Packet& other) const { return arrival > other.arrival; }
+    };
+
+    struct Broadcast {
+        uint64_t born;
+        int origin;
+        uint8_t received[NODES];
+    };
+
+    bool excluded(const Broadcast& b, int node) const {
+        // The dropped guest neither receives nor sends after the drop, and
+        // what was in flight through it at that moment is lost with it
+        if (m_drop_node == 0) {
+            return false;
+        }
+        if (node == m_drop_node || b.origin == m_drop_node) {
+            return b.born + IN_FLIGHT_MS >= m_drop_ms;
+        }
+        return b.born + IN_FLIGHT_MS >= m_drop_ms && b.born < m_drop_ms;
+    }
+
+    void send(int from, int to, uint32_t bytes, double latency, Packet packet, double now) {
+        double start = std::max(now, m_next_free[from]);
+        double done = start + static_cast<double>(bytes) * 8.0 / m_uplink[from];
+        m_next_free[from] = done;
+        m_tx_bytes[from] += bytes;
+        packet.from = from;
+        packet.to = to;
+        packet.arrival = done + latency;
+        m_events.push(packet);
+    }
+
+    void send_control(int from, int to, const RelayControl& control, double now) {
+        Packet packet{};
+        packet.kind = Kind::Control;
+        packet.control = control;
+        send(from, to, sizeof(RelayControl) + WIRE_OVERHEAD, P2P_MS, packet, now);
+    }
+
+    void broadcast(int node, uint64_t now) {
+        Broadcast b{};
+        b.born = now;
+        b.origin = node;
+        m_broadcasts.push_back(b);
+
+        Packet packet{};
+        packet.broadcast = m_broadcasts.size() - 1;
+        if (node == 0) {
+            fan_out(packet.broadcast, static_cast<double>(now));
+        } else {
+            packet.kind = Kind::ToHost;
+            send(node, 0, PAYLOAD + WIRE_OVERHEAD, P2P_MS, packet, static_cast<double>(now));
+        }
+    }
+
+    void fan_out(size_t broadcast, double now) {
+        uint64_t now_ms = static_cast<uint64_t>(now);
+        uint32_t bytes = PAYLOAD + WIRE_OVERHEAD;
+        uint32_t delegate = m_host.delegate();
+
+        for (int node = 1; node < NODES; node++) {
+            if (!m_alive[node]) {
+                continue;
+            }
+            Packet packet{};
+            packet.broadcast = broadcast;
+
+            if (m_host.is_delegated(Ip(node))) {
+                m_host.on_copy(bytes, false, now_ms);
+            } else if (Ip(node) == delegate) {
+                packet.kind = Kind::Forward;
+                packet.control = make_relay_control(RelayControlType::Forward);
+                uint32_t targets[RELAY_MAX_TARGETS];
+                packet.control.count = static_cast<uint8_t>(m_host.active_targets(targets));
+                std::memcpy(packet.control.targets, targets, sizeof(targets));
+                send(0, node, bytes + RELAY_FORWARD_OVERHEAD, P2P_MS, packet, now);
+                m_host.on_copy(bytes + RELAY_FORWARD_OVERHEAD, true, now_ms);
+                m_host.count_forward();
+            } else {
+                packet.kind = Kind::Direct;
+                send(0, node, bytes, P2P_MS, packet, now);
+                m_host.on_copy(bytes, true, now_ms);
+            }
+        }
+    }
+
+    void tick(uint64_t now) {
+        double t = static_cast<double>(now);
+        size_t remote = 0;
+        for (int node = 1; node < NODES; node++) {
+            remote += m_alive[node] ? 1 : 0;
+        }
+        m_host.update(remote, now);
+
+        RelayMessage messages[32];
+        size_t count = m_host.take_messages(messages, 32);
+        for (size_t i = 0; i < count; i++) {
+            int node = static_cast<int>(messages[i].dest_ip - IP_BASE);
+            if (node > 0 && node < NODES && m_alive[node]) {
+                send_control(0, node, messages[i].control, t);
+            }
+        }
+
+        for (int node = 1; node < NODES; node++) {
+            RelayControl report;
+            if (m_alive[node] && m_member[node].make_report(m_tx_bytes[node], now, report)) {
+                send_control(node, 0, report, t);
+            }
+        }
+    }
+
+    void receive(const Packet& packet) {
+        double now = packet.arrival;
+        uint64_t now_ms = static_cast<uint64_t>(now);
+        if (!m_alive[packet.to] || !m_alive[packet.from]) {
+            return;
+        }
+
+        switch (packet.kind) {
+            case Kind::ToHost:
+                fan_out(packet.broadcast, now);
+                break;
+
+            case Kind::Direct:
+                record(packet.broadcast, packet.to, now);
+                break;
+
+            case Kind::Forward: {
+                record(packet.broadcast, packet.to, now);
+                uint32_t targets[RELAY_MAX_TARGETS];
+                size_t count = m_member[packet.to].forward_targets(packet.control, targets);
+                for (size_t i = 0; i < count; i++) {
+                    Packet leg{};
+                    leg.kind = Kind::RelayLeg;
+                    leg.broadcast = packet.broadcast;
+                    uint32_t bytes = PAYLOAD + WIRE_OVERHEAD + RELAY_FORWARD_OVERHEAD;
+                    send(packet.to, static_cast<int>(targets[i] - IP_BASE), bytes, RELAY_MS, leg, now);
+                    m_member[packet.to].on_relayed(bytes, now_ms);
+                }
+                break;
+            }
+
+            case Kind::RelayLeg:
+                if (m_member[packet.to].accept_forward(Ip(packet.from), now_ms)) {
+                    record(packet.broadcast, packet.to, now);
+                }
+                break;
+
+            case Kind::Control:
+                if (packet.to == 0) {
+                    m_host.on_control(Ip(packet.from), packet.control, now_ms);
+                } else {
+                    RelayControl reply;
+                    if (m_member[packet.to].on_host_control(packet.control, now_ms, reply)) {
+                        send_control(packet.to, 0, reply, now);
+                    }
+                }
+                break;
+        }
+    }
+
+    void record(size_t broadcast, int node, double now) {
+        Broadcast& b = m_broadcasts[broadcast];
+        b.received[node]++;
+        if (b.born >= m_measure_from && b.born < m_measure_to && b.received[node] == 1 &&
+            !excluded(b, node)) {
+            m_latencies.push_back(now - static_cast<double>(b.born));
+        }
+    }
+
+    void deliver_until(double now) {
+        while (!m_events.empty() && m_events.top().arrival <= now) {
+            Packet packet = m_events.top();
+            m_events.pop();
+            receive(packet);
+        }
+    }
+
+    double m_uplink[NODES];
+    double m_next_free[NODES];
+    uint64_t m_tx_bytes[NODES];
+    bool m_alive[NODES];
+
+    RelayDelegation m_host;
+    RelayMember m_member[NODES];
+
+    std::priority_queue<Packet, std::vector<Packet>, std::greater<Packet>> m_events;
+    std::vector<Broadcast> m_broadcasts;
+    std::vector<double> m_latencies;
+    double m_max_backlog = 0.0;
+    uint64_t m_measure_from = 0;
+    uint64_t m_measure_to = 0;
+    int m_drop_node = 0;
+    uint64_t m_drop_ms = 0;
+};
+
+// Host on 1.2 Mbit/s upload (fan-out needs ~1.75), three guests on fiber
+constexpr uint32_t SIM_UPLINKS[UplinkSim::NODES] = {1200, 10000, 10000, 10000, 1000, 1000, 1000, 1000};
+
+} // namespace
+
+bool test_capped_uplink_fanout_gain() {
+    UplinkSim direct(false, SIM_UPLINKS);
+    auto off = direct.run(20000, 5000, 18000);
+
+    UplinkSim delegated(true, SIM_UPLINKS);
+    auto on = delegated.run(20000, 5000, 18000);
+
+    printf("\n    direct:    p50 %.0f p99 %.0f ms, host backlog %.0f ms, missing %llu\n",
+           off.p50, off.p99, off.max_backlog_ms, static_cast<unsigned long long>(off.missing));
+    printf("    delegated: p50 %.0f p99 %.0f ms, host backlog %.0f ms, missing %llu, "
+           "forwarded %llu... ",
+           on.p50, on.p99, on.max_backlog_ms, static_cast<unsigned long long>(on.missing),
+           static_cast<unsigned long long>(delegated.host_stats().forwarded));
+
+    // Without delegation the host queue grows for the whole session
+    ASSERT_TRUE(off.p99 > 1000.0);
+
+    // With it, latency stays at path latency plus serialization
+    ASSERT_EQ(delegated.host_stats().elections, 1);
+    ASSERT_TRUE(on.p99 < 100.0);
+    ASSERT_TRUE(on.p99 * 10.0 < off.p99);
+    ASSERT_EQ(on.missing, 0);
+    ASSERT_EQ(on.duplicates, 0);
+    return true;
+}
+
+bool test_capped_uplink_delegate_drop() {
+    UplinkSim sim(true, SIM_UPLINKS);
+    auto result = sim.run(20000, 5000, 18000, 1, 10000);
+
+    printf("\n    delegate lost at 10 s: p50 %.0f p99 %.0f ms, missing %llu, elections %llu... ",
+           result.p50, result.p99, static_cast<unsigned long long>(result.missing),
+           static_cast<unsigned long long>(sim.host_stats().elections));
+
+    // Direct fan-out bridges the gap, then the runner-up takes over
+    ASSERT_EQ(sim.host_stats().failovers, 1);
+    ASSERT_EQ(sim.host_stats().elections, 2);
+    ASSERT_EQ(result.missing, 0);
+    ASSERT_EQ(result.duplicates, 0);
+    ASSERT_TRUE(result.p99 < 1000.0);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Relay Delegation Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Wire Tests:\n");
+    RUN_TEST(test_control_parsing);
+    RUN_TEST(test_forward_round_trip);
+    RUN_TEST(test_rate_meter);
+
+    printf("\nElection Tests:\n");
+    RUN_TEST(test_no_delegation_below_threshold);
+    RUN_TEST(test_elects_most_spare_uplink);
+    RUN_TEST(test_tie_goes_to_lowest_ip);
+    RUN_TEST(test_hysteresis_keeps_delegate);
+    RUN_TEST(test_release_when_demand_drops);
+
+    printf("\nHandshake Tests:\n");
+    RUN_TEST(test_direct_until_accept_and_join);
+    RUN_TEST(test_member_replies_and_filters);
+    RUN_TEST(test_target_accepts_only_its_delegate);
+    RUN_TEST(test_member_reports);
+
+    printf("\nFailover Tests:\n");
+    RUN_TEST(test_failover_on_delegate_loss);
+    RUN_TEST(test_failover_on_silent_delegate);
+    RUN_TEST(test_target_loss_shrinks_assignment);
+
+    printf("\nCapped Uplink Simulation:\n");
+    RUN_TEST(test_capped_uplink_fanout_gain);
+    RUN_TEST(test_capped_uplink_delegate_drop);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}
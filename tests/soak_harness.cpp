@@ -0,0 +1,972 @@
+/**
+ * @file soak_harness.cpp
+ * @brief Accelerated-time soak run of the network, LDN and proxy layers
+ *
+ * Leaks, slowly growing queues, port pool exhaustion and reconnect storms
+ * only show up after hours of play. This harness compresses those hours
+ * into seconds with platform::VirtualClock: every tick and sleep in the
+ * code under test reads a clock the harness advances by STEP_MS per step,
+ * while sockets and copies still do real work.
+ *
+ * ## What Runs
+ *
+ * - **Server**: a single-threaded stand-in RyuLDN server on loopback.
+ *   Answers Initialize and Ping, replies to ProxyConnect, and pushes
+ *   ProxyData and ProxyConnect at the game sockets
+ * - **Client**: RyuLdnClient -> PacketDispatcher -> ProxySocketManager,
+ *   the same path ICommunicationService wires up on the console
+ * - **Game**: UDP sockets bound to ephemeral ports and closed/reopened
+ *   at random, readers that stall so queues fill and drop, a TCP
+ *   listener accepting proxied connections, outgoing TCP connects
+ * - **Faults**: the server drops the connection every DROP_PERIOD_MIN,
+ *   and every STORM_PERIOD_MIN refuses all connections for STORM_MS
+ *
+ * ## What Is Checked
+ *
+ * Every SAMPLE_MS of virtual time the harness records the lowest live
+ * heap bytes and allocations (global operator new, the host stand-in for
+ * the sysmodule heap), the highest queued proxy bytes, the ephemeral port
+ * pool and the real time spent per step. The run fails when the last quarter drifts
+ * from the first quarter past the thresholds below, when a port leaks,
+ * or when the client reconnects faster than its backoff allows or does
+ * not come back after a fault.
+ *
+ * ## Usage
+ *
+ * ```
+ * make soak                        # 8 virtual hours
+ * ./run_soak_harness 480 7         # virtual minutes, random seed
+ * ```
+ *
+ * Not part of `make test`: even a short pass takes longer than all the
+ * unit tests together. Run it before touching the data path or reconnect
+ * logic.
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bsd/proxy_socket_manager.hpp"
+#include "bsd/listener_proxy_socket.hpp"
+#include "bsd/stream_proxy_socket.hpp"
+#include "diagnostics/metrics.hpp"
+#include "ldn/ldn_packet_dispatcher.hpp"
+#include "network/client.hpp"
+#include "protocol/ryu_protocol.hpp"
+
+using namespace ams::mitm::bsd;
+using ryu_ldn::bsd::SockAddrIn;
+using ryu_ldn::bsd::SocketType;
+using ryu_ldn::bsd::ProtocolType;
+using ryu_ldn::diagnostics::g_metrics;
+namespace platform = ryu_ldn::platform;
+namespace protocol = ryu_ldn::protocol;
+namespace network = ryu_ldn::network;
+
+// =============================================================================
+// Heap Accounting
+// =============================================================================
+
+namespace {
+
+std::atomic<int64_t> g_live_bytes{0};
+std::atomic<int64_t> g_live_allocations{0};
+
+// Keeps the payload max-aligned
+constexpr size_t ALLOC_HEADER = alignof(std::max_align_t);
+
+void* CountedAlloc(size_t size) {
+    auto* block = static_cast<uint8_t*>(std::malloc(size + ALLOC_HEADER));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(block, &size, sizeof(size));
+    g_live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    g_live_allocations.fetch_add(1, std::memory_order_relaxed);
+    return block + ALLOC_HEADER;
+}
+
+void CountedFree(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    uint8_t* block = static_cast<uint8_t*>(ptr) - ALLOC_HEADER;
+    size_t size;
+    std::memcpy(&size, block, sizeof(size));
+    g_live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    g_live_allocations.fetch_sub(1, std::memory_order_relaxed);
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    void* ptr = CountedAlloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAlloc(size); }
+void operator delete(void* ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+
+namespace {
+
+// =============================================================================
+// Scenario
+// =============================================================================
+
+constexpr uint32_t LOCAL_IP = 0x0A720001;  // 10.114.0.1 (this console)
+constexpr uint32_t PEER_IP  = 0x0A720002;  // 10.114.0.2 (the other player)
+constexpr uint16_t PEER_PORT = 12345;
+constexpr uint16_t LISTEN_PORT = 7000;
+
+constexpr uint64_t STEP_MS = 10;
+constexpr uint64_t SAMPLE_MS = 60 * 1000;
+constexpr uint64_t DROP_PERIOD_MIN = 10;      ///< Server drops the connection
+constexpr uint64_t STORM_PERIOD_MIN = 25;     ///< Server refuses everyone...
+constexpr uint64_t STORM_MS = 90 * 1000;      ///< ...for this long
+
+constexpr size_t UDP_SOCKETS = 8;
+constexpr uint32_t UDP_RX_PER_STEP_PERMILLE = 400;  ///< Inbound packets per socket per step
+constexpr uint32_t UDP_TX_PER_STEP_PERMILLE = 250;  ///< Outbound packets per socket per step
+constexpr uint64_t UDP_MEAN_LIFETIME_MS = 45 * 1000;
+constexpr uint32_t STALL_PER_STEP_PERMILLE = 2;     ///< Reader stops reading...
+constexpr uint64_t STALL_MS = 3 * 1000;             ///< ...for this long
+
+constexpr size_t TCP_OUTGOING = 4;
+constexpr uint64_t TCP_OUTGOING_LIFETIME_MS = 5 * 1000;
+constexpr uint32_t TCP_INCOMING_PER_STEP_PERMILLE = 5;
+
+constexpr uint64_t START_NS = 1000000000ULL;  ///< Virtual clock starts at 1 s
+
+// Thresholds (late quarter vs early quarter)
+constexpr int64_t HEAP_DRIFT_BYTES = 16 * 1024;
+constexpr int64_t ALLOCATION_DRIFT = 64;
+constexpr int64_t QUEUE_SLACK_BYTES = 16 * 1024;
+constexpr uint64_t LATENCY_SLACK_NS = 100 * 1000;
+constexpr uint32_t LATENCY_FACTOR = 3;
+constexpr uint32_t STORM_MAX_ATTEMPTS = 12;   ///< 1+2+4+...+30 s backoff fits ~8 in 90 s
+constexpr uint64_t RECOVERY_MS = 45 * 1000;   ///< Max backoff plus handshake
+
+/**
+ * @brief Deterministic PRNG (xorshift64)
+ */
+class Random {
+public:
+    explicit Random(uint64_t seed) : m_state(seed != 0 ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+    uint64_t next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 7;
+        m_state ^= m_state << 17;
+        return m_state;
+    }
+
+    uint32_t below(uint32_t bound) { return static_cast<uint32_t>(next() % bound); }
+    bool permille(uint32_t chance) { return below(1000) < chance; }
+
+private:
+    uint64_t m_state;
+};
+
+SockAddrIn MakeAddr(uint32_t ip, uint16_t port) {
+    SockAddrIn addr{};
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = static_cast<uint8_t>(ryu_ldn::bsd::AddressFamily::Inet);
+    addr.sin_port = __builtin_bswap16(port);
+    addr.sin_addr = __builtin_bswap32(ip);
+    return addr;
+}
+
+// =============================================================================
+// Stand-in Server
+// =============================================================================
+
+/**
+ * @brief Non-blocking RyuLDN server stepped from the main loop
+ *
+ * Runs on the harness thread so virtual time stays single-threaded.
+ */
+class SoakServer {
+public:
+    bool refusing = false;    ///< Close every connection right after accept
+
+    uint32_t accepted = 0;
+    uint32_t refused = 0;
+    uint32_t proxy_data_received = 0;
+    uint32_t send_overruns = 0;
+
+    ~SoakServer() {
+        drop();
+        if (m_listen_fd >= 0) {
+            ::close(m_listen_fd);
+        }
+    }
+
+    bool start() {
+        m_listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listen_fd < 0) return false;
+
+        int one = 1;
+        setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+        if (::listen(m_listen_fd, 4) != 0) return false;
+        set_non_blocking(m_listen_fd);
+
+        socklen_t len = sizeof(addr);
+        getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+        return true;
+    }
+
+    uint16_t port() const { return m_port; }
+    bool has_client() const { return m_client_fd >= 0; }
+
+    void drop() {
+        if (m_client_fd >= 0) {
+            ::close(m_client_fd);
+            m_client_fd = -1;
+        }
+        m_rx_size = 0;
+    }
+
+    void step() {
+        int fd = ::accept(m_listen_fd, nullptr, nullptr);
+        if (fd >= 0) {
+            if (refusing) {
+                ::close(fd);
+                refused++;
+            } else {
+                drop();
+                set_non_blocking(fd);
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, 1 /* TCP_NODELAY */, &one, sizeof(one));
+                m_client_fd = fd;
+                accepted++;
+            }
+        }
+
+        if (m_client_fd < 0) {
+            return;
+        }
+
+        while (true) {
+            ssize_t n = ::recv(m_client_fd, m_rx + m_rx_size, sizeof(m_rx) - m_rx_size, 0);
+            if (n == 0) {
+                drop();
+                return;
+            }
+            if (n < 0) {
+                break;
+            }
+            m_rx_size += static_cast<size_t>(n);
+            parse();
+            if (m_client_fd < 0) {
+                return;
+            }
+        }
+    }
+
+    void send_proxy_data(uint16_t dest_port, const uint8_t* payload, size_t size) {
+        protocol::ProxyInfo info{};
+        info.source_ipv4 = PEER_IP;
+        info.source_port = PEER_PORT;
+        info.dest_ipv4 = LOCAL_IP;
+        info.dest_port = dest_port;
+        info.protocol = protocol::ProtocolType::Udp;
+
+        size_t wire_size = 0;
+        if (protocol::encode_proxy_data(m_tx, sizeof(m_tx), info, payload, size, wire_size) ==
+            protocol::EncodeResult::Success) {
+            send_wire(m_tx, wire_size);
+        }
+    }
+
+    void send_proxy_connect(uint16_t source_port) {
+        protocol::ProxyConnectRequest request{};
+        request.info.source_ipv4 = PEER_IP;
+        request.info.source_port = source_port;
+        request.info.dest_ipv4 = LOCAL_IP;
+        request.info.dest_port = LISTEN_PORT;
+        request.info.protocol = protocol::ProtocolType::Tcp;
+        send_packet(protocol::PacketId::ProxyConnect, &request, sizeof(request));
+    }
+
+private:
+    int m_listen_fd = -1;
+    int m_client_fd = -1;
+    uint16_t m_port = 0;
+    uint8_t m_rx[64 * 1024];
+    size_t m_rx_size = 0;
+    uint8_t m_tx[4096];
+
+    static void set_non_blocking(int fd) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void send_wire(const uint8_t* data, size_t size) {
+        if (m_client_fd < 0) {
+            return;
+        }
+        // A full socket buffer means the client fell behind: drop the
+        // connection like a server write timeout would, never block
+        ssize_t n = ::send(m_client_fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n != static_cast<ssize_t>(size)) {
+            send_overruns++;
+            drop();
+        }
+    }
+
+    void send_packet(protocol::PacketId type, const void* payload, size_t size) {
+        protocol::encode_header(m_tx, type, static_cast<int32_t>(size));
+        std::memcpy(m_tx + sizeof(protocol::LdnHeader), payload, size);
+        send_wire(m_tx, sizeof(protocol::LdnHeader) + size);
+    }
+
+    void parse() {
+        size_t offset = 0;
+        while (m_rx_size - offset >= sizeof(protocol::LdnHeader)) {
+            protocol::LdnHeader header;
+            if (protocol::decode_header(m_rx + offset, m_rx_size - offset, header) !=
+                protocol::DecodeResult::Success) {
+                break;
+            }
+            size_t total = sizeof(header) + static_cast<size_t>(header.data_size);
+            if (m_rx_size - offset < total) {
+                break;
+            }
+            handle(static_cast<protocol::PacketId>(header.type),
+                   m_rx + offset + sizeof(header), static_cast<size_t>(header.data_size));
+            if (m_client_fd < 0) {
+                return;
+            }
+            offset += total;
+        }
+        std::memmove(m_rx, m_rx + offset, m_rx_size - offset);
+        m_rx_size -= offset;
+    }
+
+    void handle(protocol::PacketId type, const uint8_t* data, size_t size) {
+        switch (type) {
+            case protocol::PacketId::Initialize: {
+                protocol::InitializeMessage msg{};
+                msg.mac_address.data[0] = 0x02;
+                send_packet(protocol::PacketId::Initialize, &msg, sizeof(msg));
+                break;
+            }
+            case protocol::PacketId::Ping: {
+                protocol::PingMessage ping{};
+                std::memcpy(&ping, data, std::min(size, sizeof(ping)));
+                if (ping.requester != 0) {
+                    send_packet(protocol::PacketId::Ping, &ping, sizeof(ping));
+                }
+                break;
+            }
+            case protocol::PacketId::ProxyConnect: {
+                // Accept every outgoing connect (protocol Unspecified = success)
+                protocol::ProxyConnectResponse response{};
+                std::memcpy(&response, data, std::min(size, sizeof(response)));
+                response.info.protocol = protocol::ProtocolType::Unspecified;
+                send_packet(protocol::PacketId::ProxyConnectReply, &response, sizeof(response));
+                break;
+            }
+            case protocol::PacketId::ProxyData:
+                proxy_data_received++;
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+// =============================================================================
+// Client Side Wiring
+// =============================================================================
+
+network::RyuLdnClient* g_client = nullptr;
+ryu_ldn::ldn::PacketDispatcher g_dispatcher;
+uint8_t g_tx_wire[4096];
+uint32_t g_tx_not_ready = 0;
+
+// Same mapping as ICommunicationService::HandleServerPacket
+void OnProxyData(const protocol::LdnHeader&, const protocol::ProxyDataHeader& proxy_header,
+                 const uint8_t* data, size_t) {
+    ProtocolType proto = proxy_header.info.protocol == protocol::ProtocolType::Tcp
+                             ? ProtocolType::Tcp : ProtocolType::Udp;
+    ProxySocketManager::GetInstance().RouteIncomingData(
+        proxy_header.info.source_ipv4, proxy_header.info.source_port,
+        proxy_header.info.dest_ipv4, proxy_header.info.dest_port,
+        proto, data, proxy_header.data_length);
+}
+
+void OnProxyConnect(const protocol::LdnHeader&, const protocol::ProxyConnectRequest& request) {
+    ProxySocketManager::GetInstance().RouteConnectRequest(request);
+}
+
+void OnProxyConnectReply(const protocol::LdnHeader&, const protocol::ProxyConnectResponse& response) {
+    ProxySocketManager::GetInstance().RouteConnectResponse(response);
+}
+
+void OnServerPacket(protocol::PacketId id, const uint8_t* data, size_t size, void*) {
+    protocol::LdnHeader header{};
+    header.magic = protocol::PROTOCOL_MAGIC;
+    header.version = protocol::PROTOCOL_VERSION;
+    header.type = static_cast<uint8_t>(id);
+    header.data_size = static_cast<int32_t>(size);
+    g_dispatcher.dispatch(header, data, size);
+}
+
+bool SendProxyData(uint32_t source_ip, uint16_t source_port, uint32_t dest_ip, uint16_t dest_port,
+                   ProtocolType proto, const void* data, size_t data_len) {
+    if (!g_client->is_ready()) {
+        g_tx_not_ready++;
+        return false;
+    }
+    protocol::ProxyInfo info{};
+    info.source_ipv4 = source_ip;
+    info.source_port = source_port;
+    info.dest_ipv4 = dest_ip;
+    info.dest_port = dest_port;
+    info.protocol = proto == ProtocolType::Tcp ? protocol::ProtocolType::Tcp
+                                               : protocol::ProtocolType::Udp;
+    size_t size = 0;
+    if (protocol::encode_proxy_data(g_tx_wire, sizeof(g_tx_wire), info,
+                                    static_cast<const uint8_t*>(data), data_len, size) !=
+        protocol::EncodeResult::Success) {
+        return false;
+    }
+    return g_client->send_raw_packet(g_tx_wire, size) == network::ClientOpResult::Success;
+}
+
+bool SendProxyConnect(uint32_t source_ip, uint16_t source_port, uint32_t dest_ip, uint16_t dest_port,
+                      ProtocolType proto) {
+    if (!g_client->is_ready()) {
+        return false;
+    }
+    protocol::ProxyConnectRequest request{};
+    request.info.source_ipv4 = source_ip;
+    request.info.source_port = source_port;
+    request.info.dest_ipv4 = dest_ip;
+    request.info.dest_port = dest_port;
+    request.info.protocol = proto == ProtocolType::Tcp ? protocol::ProtocolType::Tcp
+                                                       : protocol::ProtocolType::Udp;
+    size_t size = 0;
+    if (protocol::encode(g_tx_wire, sizeof(g_tx_wire), protocol::PacketId::ProxyConnect,
+                         request, size) != protocol::EncodeResult::Success) {
+        return false;
+    }
+    return g_client->send_raw_packet(g_tx_wire, size) == network::ClientOpResult::Success;
+}
+
+// =============================================================================
+// Game Side
+// =============================================================================
+
+struct GameSocket {
+    s32 fd = -1;
+    std::shared_ptr<ProxySocket> socket;
+    uint16_t port = 0;
+    uint64_t close_at_ms = 0;
+    uint64_t stall_until_ms = 0;
+};
+
+struct Sample {
+    uint64_t minute;
+    int64_t heap_bytes;         ///< Min seen during the window (queues swing the rest)
+    int64_t allocations;        ///< Min seen during the window
+    int64_t queued_bytes;       ///< Max seen during the window
+    int64_t proxy_sockets;
+    size_t ports_available;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+};
+
+constexpr size_t MAX_SAMPLES = 24 * 60;
+constexpr size_t MAX_STEP_TIMES = SAMPLE_MS / STEP_MS;
+
+class Soak {
+public:
+    Soak(uint64_t minutes, uint64_t seed) : m_minutes(minutes), m_random(seed) {}
+
+    bool run();
+
+private:
+    uint64_t m_minutes;
+    Random m_random;
+    SoakServer m_server;
+    std::unique_ptr<network::RyuLdnClient> m_client;
+
+    GameSocket m_udp[UDP_SOCKETS];
+    GameSocket m_tcp_out[TCP_OUTGOING];
+    s32 m_listener_fd = -1;
+    s32 m_next_fd = 100;
+    uint16_t m_next_peer_port = 50000;
+
+    uint8_t m_payload[PROXY_SOCKET_MAX_PAYLOAD];
+    uint8_t m_buffer[PROXY_SOCKET_MAX_PAYLOAD];
+
+    Sample m_samples[MAX_SAMPLES];
+    size_t m_sample_count = 0;
+    uint64_t m_step_ns[MAX_STEP_TIMES];
+    size_t m_step_count = 0;
+    int64_t m_window_queue_max = 0;
+    int64_t m_window_heap_min = INT64_MAX;
+    int64_t m_window_allocations_min = INT64_MAX;
+
+    uint64_t m_udp_opened = 0;
+    uint64_t m_tcp_connects = 0;
+    uint64_t m_tcp_accepted = 0;
+    uint64_t m_rx_packets = 0;
+    uint64_t m_tx_packets = 0;
+
+    uint64_t m_fault_at_ms = 0;         ///< Last drop or storm start (0 = none pending)
+    uint64_t m_storm_end_ms = 0;
+    uint32_t m_storm_attempts_base = 0;
+    uint32_t m_worst_storm_attempts = 0;
+    uint64_t m_worst_recovery_ms = 0;
+    uint32_t m_faults = 0;
+    bool m_failed = false;
+
+    void fail(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    void open_udp(GameSocket& game, uint64_t now_ms);
+    void close_socket(GameSocket& game);
+    void step_udp(GameSocket& game, uint64_t now_ms);
+    void step_tcp(uint64_t now_ms);
+    void step_faults(uint64_t now_ms);
+    void take_sample(uint64_t now_ms);
+    void check_ports();
+    void check_drift();
+};
+
+void Soak::fail(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    printf("  FAIL: ");
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+    m_failed = true;
+}
+
+void Soak::open_udp(GameSocket& game, uint64_t now_ms) {
+    auto& manager = ProxySocketManager::GetInstance();
+    game.fd = m_next_fd++;
+    game.socket = manager.CreateProxySocket(game.fd, SocketType::Dgram, ProtocolType::Udp);
+    game.port = manager.AllocatePort(ProtocolType::Udp);
+    if (game.socket == nullptr || game.port == 0) {
+        fail("cannot open UDP socket (port pool has %zu ports left)",
+             manager.GetAvailablePortCount(ProtocolType::Udp));
+        return;
+    }
+    game.socket->Bind(MakeAddr(LOCAL_IP, game.port));
+    game.socket->SetNonBlocking(true);
+    game.close_at_ms = now_ms + 1 + m_random.below(2 * UDP_MEAN_LIFETIME_MS);
+    game.stall_until_ms = 0;
+    m_udp_opened++;
+}
+
+void Soak::close_socket(GameSocket& game) {
+    if (game.socket != nullptr) {
+        // Releases the local port, like BsdMitmService::Close
+        ProxySocketManager::GetInstance().CloseProxySocket(game.fd);
+    }
+    game = GameSocket{};
+}
+
+void Soak::step_udp(GameSocket& game, uint64_t now_ms) {
+    if (now_ms >= game.close_at_ms) {
+        close_socket(game);
+        open_udp(game, now_ms);
+        if (game.socket == nullptr) {
+            return;
+        }
+    }
+
+    // Inbound traffic from the peer, pushed by the server
+    if (m_server.has_client() && m_random.permille(UDP_RX_PER_STEP_PERMILLE)) {
+        size_t size = 32 + m_random.below(PROXY_SOCKET_MAX_PAYLOAD - 32);
+        m_server.send_proxy_data(game.port, m_payload, size);
+    }
+
+    // Outbound traffic from the game
+    if (m_random.permille(UDP_TX_PER_STEP_PERMILLE)) {
+        size_t size = 32 + m_random.below(512);
+        if (game.socket->SendTo(m_payload, size, 0, MakeAddr(PEER_IP, PEER_PORT)) > 0) {
+            m_tx_packets++;
+        }
+    }
+
+    // The game reads, unless it is stalled (loading screen, hitch)
+    if (game.stall_until_ms == 0 && m_random.permille(STALL_PER_STEP_PERMILLE)) {
+        game.stall_until_ms = now_ms + STALL_MS;
+    }
+    if (game.stall_until_ms != 0) {
+        if (now_ms < game.stall_until_ms) {
+            return;
+        }
+        game.stall_until_ms = 0;
+    }
+    SockAddrIn from;
+    while (game.socket->RecvFrom(m_buffer, sizeof(m_buffer), 0, &from) > 0) {
+        m_rx_packets++;
+    }
+}
+
+void Soak::step_tcp(uint64_t now_ms) {
+    auto& manager = ProxySocketManager::GetInstance();
+
+    // Incoming connections: server forwards a ProxyConnect, the game
+    // accepts, exchanges a little data and hangs up
+    if (m_server.has_client() && m_random.permille(TCP_INCOMING_PER_STEP_PERMILLE)) {
+        m_server.send_proxy_connect(m_next_peer_port++);
+        if (m_next_peer_port == 0) {
+            m_next_peer_port = 50000;
+        }
+    }
+    auto listener = std::static_pointer_cast<ListenerProxySocket>(manager.GetProxySocket(m_listener_fd));
+    SockAddrIn from;
+    while (auto accepted = listener->Accept(&from)) {
+        accepted->Send(m_payload, 64, 0);
+        m_tcp_accepted++;
+    }
+
+    // Outgoing connections, each kept for a few seconds
+    for (auto& game : m_tcp_out) {
+        if (game.socket != nullptr && now_ms < game.close_at_ms) {
+            continue;
+        }
+        close_socket(game);
+
+        game.fd = m_next_fd++;
+        game.socket = manager.CreateProxySocket(game.fd, SocketType::Stream, ProtocolType::Tcp);
+        game.port = manager.AllocatePort(ProtocolType::Tcp);
+        if (game.socket == nullptr || game.port == 0) {
+            fail("cannot open TCP socket (port pool has %zu ports left)",
+                 manager.GetAvailablePortCount(ProtocolType::Tcp));
+            return;
+        }
+        game.socket->Bind(MakeAddr(LOCAL_IP, game.port));
+        game.socket->SetNonBlocking(true);
+        game.socket->Connect(MakeAddr(PEER_IP, LISTEN_PORT));
+        game.close_at_ms = now_ms + 1 + m_random.below(2 * TCP_OUTGOING_LIFETIME_MS);
+        m_tcp_connects++;
+    }
+}
+
+void Soak::step_faults(uint64_t now_ms) {
+    uint64_t minute_ms = 60 * 1000;
+    uint32_t attempts = m_server.accepted + m_server.refused;
+
+    if (now_ms % (STORM_PERIOD_MIN * minute_ms) == 0) {
+        m_server.refusing = true;
+        m_server.drop();
+        m_storm_end_ms = now_ms + STORM_MS;
+        m_storm_attempts_base = attempts;
+        m_fault_at_ms = now_ms;
+        m_faults++;
+    } else if (now_ms % (DROP_PERIOD_MIN * minute_ms) == 0 && !m_server.refusing) {
+        m_server.drop();
+        m_fault_at_ms = now_ms;
+        m_faults++;
+    }
+
+    if (m_server.refusing && now_ms >= m_storm_end_ms) {
+        m_server.refusing = false;
+        uint32_t storm_attempts = attempts - m_storm_attempts_base;
+        m_worst_storm_attempts = std::max(m_worst_storm_attempts, storm_attempts);
+        if (storm_attempts > STORM_MAX_ATTEMPTS) {
+            fail("%u connection attempts during a %llu s outage (max %u)", storm_attempts,
+                 static_cast<unsigned long long>(STORM_MS / 1000), STORM_MAX_ATTEMPTS);
+        }
+        // Recovery is timed from the end of the outage
+        m_fault_at_ms = now_ms;
+    }
+
+    if (m_fault_at_ms != 0 && !m_server.refusing) {
+        if (m_client->is_ready() && m_server.has_client() && now_ms > m_fault_at_ms) {
+            m_worst_recovery_ms = std::max(m_worst_recovery_ms, now_ms - m_fault_at_ms);
+            m_fault_at_ms = 0;
+        } else if (now_ms - m_fault_at_ms > RECOVERY_MS) {
+            fail("client not back %llu s after a server fault (state %s)",
+                 static_cast<unsigned long long>(RECOVERY_MS / 1000),
+                 network::ConnectionStateMachine::state_to_string(m_client->get_state()));
+            m_fault_at_ms = 0;
+        }
+    }
+}
+
+uint64_t Percentile(uint64_t* values, size_t count, uint32_t percent) {
+    if (count == 0) {
+        return 0;
+    }
+    size_t index = (count - 1) * percent / 100;
+    std::nth_element(values, values + index, values + count);
+    return values[index];
+}
+
+void Soak::take_sample(uint64_t now_ms) {
+    if (m_sample_count >= MAX_SAMPLES) {
+        return;
+    }
+    Sample& sample = m_samples[m_sample_count++];
+    sample.minute = now_ms / 60000;
+    sample.heap_bytes = m_window_heap_min;
+    sample.allocations = m_window_allocations_min;
+    sample.queued_bytes = m_window_queue_max;
+    sample.proxy_sockets = g_metrics.proxy_sockets.Load();
+    sample.ports_available = ProxySocketManager::GetInstance().GetAvailablePortCount(ProtocolType::Udp);
+    sample.p50_ns = Percentile(m_step_ns, m_step_count, 50);
+    sample.p99_ns = Percentile(m_step_ns, m_step_count, 99);
+
+    printf("  %5llu min  heap %7lld B / %4lld allocs  queued %6lld B  sockets %2lld"
+           "  ports %5zu  step p50 %5llu us p99 %5llu us  %s\n",
+           static_cast<unsigned long long>(sample.minute),
+           static_cast<long long>(sample.heap_bytes), static_cast<long long>(sample.allocations),
+           static_cast<long long>(sample.queued_bytes), static_cast<long long>(sample.proxy_sockets),
+           sample.ports_available,
+           static_cast<unsigned long long>(sample.p50_ns / 1000),
+           static_cast<unsigned long long>(sample.p99_ns / 1000),
+           network::ConnectionStateMachine::state_to_string(m_client->get_state()));
+
+    m_step_count = 0;
+    m_window_queue_max = 0;
+    m_window_heap_min = INT64_MAX;
+    m_window_allocations_min = INT64_MAX;
+    check_ports();
+}
+
+void Soak::check_ports() {
+    // Every ephemeral port is either free or held by an open socket
+    auto& manager = ProxySocketManager::GetInstance();
+    size_t udp_held = 0;
+    for (auto& game : m_udp) {
+        udp_held += game.socket != nullptr ? 1 : 0;
+    }
+    size_t tcp_held = 0;
+    for (auto& game : m_tcp_out) {
+        tcp_held += game.socket != nullptr ? 1 : 0;
+    }
+    size_t udp_free = manager.GetAvailablePortCount(ProtocolType::Udp);
+    size_t tcp_free = manager.GetAvailablePortCount(ProtocolType::Tcp);
+    if (udp_free + udp_held != EPHEMERAL_PORT_COUNT || tcp_free + tcp_held != EPHEMERAL_PORT_COUNT) {
+        fail("port leak: udp %zu free + %zu held, tcp %zu free + %zu held (pool %zu)",
+             udp_free, udp_held, tcp_free, tcp_held, EPHEMERAL_PORT_COUNT);
+    }
+}
+
+void Soak::check_drift() {
+    // Skip the first sample (warm-up: pools and queues filling for the first time)
+    size_t first = std::min<size_t>(1, m_sample_count);
+    size_t usable = m_sample_count - first;
+    if (usable < 4) {
+        fail("run too short to compare (%zu samples)", usable);
+        return;
+    }
+    size_t window = usable / 4;
+    const Sample* early = m_samples + first;
+    const Sample* late = m_samples + m_sample_count - window;
+
+    int64_t early_heap = 0, late_heap = 0, early_allocs = 0, late_allocs = 0;
+    int64_t early_queue = 0, late_queue = 0;
+    uint64_t early_p99 = 0, late_p99 = 0;
+    for (size_t i = 0; i < window; i++) {
+        early_heap += early[i].heap_bytes;
+        late_heap += late[i].heap_bytes;
+        early_allocs += early[i].allocations;
+        late_allocs += late[i].allocations;
+        early_queue = std::max(early_queue, early[i].queued_bytes);
+        late_queue = std::max(late_queue, late[i].queued_bytes);
+        early_p99 = std::max(early_p99, early[i].p99_ns);
+        late_p99 = std::max(late_p99, late[i].p99_ns);
+    }
+    early_heap /= static_cast<int64_t>(window);
+    late_heap /= static_cast<int64_t>(window);
+    early_allocs /= static_cast<int64_t>(window);
+    late_allocs /= static_cast<int64_t>(window);
+
+    printf("\n  early/late quarter (%zu samples each):\n", window);
+    printf("    heap        %8lld -> %8lld B      (max drift %lld)\n",
+           static_cast<long long>(early_heap), static_cast<long long>(late_heap),
+           static_cast<long long>(HEAP_DRIFT_BYTES));
+    printf("    allocations %8lld -> %8lld        (max drift %lld)\n",
+           static_cast<long long>(early_allocs), static_cast<long long>(late_allocs),
+           static_cast<long long>(ALLOCATION_DRIFT));
+    printf("    queue max   %8lld -> %8lld B\n",
+           static_cast<long long>(early_queue), static_cast<long long>(late_queue));
+    printf("    step p99    %8llu -> %8llu us\n",
+           static_cast<unsigned long long>(early_p99 / 1000),
+           static_cast<unsigned long long>(late_p99 / 1000));
+
+    if (late_heap - early_heap > HEAP_DRIFT_BYTES) {
+        fail("heap grew by %lld bytes", static_cast<long long>(late_heap - early_heap));
+    }
+    if (late_allocs - early_allocs > ALLOCATION_DRIFT) {
+        fail("%lld more live allocations", static_cast<long long>(late_allocs - early_allocs));
+    }
+    if (late_queue > early_queue + early_queue / 2 + QUEUE_SLACK_BYTES) {
+        fail("proxy queues grew from %lld to %lld bytes",
+             static_cast<long long>(early_queue), static_cast<long long>(late_queue));
+    }
+    if (late_p99 > early_p99 * LATENCY_FACTOR + LATENCY_SLACK_NS) {
+        fail("step p99 grew from %llu to %llu us",
+             static_cast<unsigned long long>(early_p99 / 1000),
+             static_cast<unsigned long long>(late_p99 / 1000));
+    }
+}
+
+bool Soak::run() {
+    auto& manager = ProxySocketManager::GetInstance();
+    std::memset(m_payload, 0xA5, sizeof(m_payload));
+
+    if (!m_server.start()) {
+        printf("  cannot start the stand-in server\n");
+        return false;
+    }
+
+    platform::VirtualClock::Enable(START_NS);
+
+    network::RyuLdnClientConfig config;
+    std::snprintf(config.host, sizeof(config.host), "127.0.0.1");
+    config.port = m_server.port();
+    config.connect_timeout_ms = 1000;
+    config.recv_timeout_ms = 0;
+    config.ping_interval_ms = 10 * 1000;
+    config.auto_reconnect = true;
+
+    m_client = std::make_unique<network::RyuLdnClient>(config);
+    g_client = m_client.get();
+    m_client->set_packet_callback(OnServerPacket, nullptr);
+    g_dispatcher.set_proxy_data_handler(OnProxyData);
+    g_dispatcher.set_proxy_connect_handler(OnProxyConnect);
+    g_dispatcher.set_proxy_connect_reply_handler(OnProxyConnectReply);
+    manager.SetSendCallback(SendProxyData);
+    manager.SetProxyConnectCallback(SendProxyConnect);
+
+    m_listener_fd = m_next_fd++;
+    manager.CreateProxySocket(m_listener_fd, SocketType::Stream, ProtocolType::Tcp)
+        ->Bind(MakeAddr(LOCAL_IP, LISTEN_PORT));
+    manager.ListenProxySocket(m_listener_fd, 4)->SetNonBlocking(true);
+
+    m_client->connect();
+
+    uint64_t now_ms = platform::GetTickMs();
+    for (auto& game : m_udp) {
+        open_udp(game, now_ms);
+    }
+
+    uint64_t end_ms = now_ms + m_minutes * 60 * 1000;
+    while (now_ms < end_ms && !m_failed) {
+        m_server.step();
+        step_faults(now_ms);
+
+        auto start = std::chrono::steady_clock::now();
+        m_client->update(now_ms);
+        for (auto& game : m_udp) {
+            step_udp(game, now_ms);
+        }
+        step_tcp(now_ms);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (m_step_count < MAX_STEP_TIMES) {
+            m_step_ns[m_step_count++] = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+        m_window_queue_max = std::max(m_window_queue_max, g_metrics.proxy_queued_bytes.Load());
+        m_window_heap_min = std::min(m_window_heap_min, g_live_bytes.load());
+        m_window_allocations_min = std::min(m_window_allocations_min, g_live_allocations.load());
+
+        platform::SleepMs(STEP_MS);
+        now_ms = platform::GetTickMs();
+        if ((now_ms - START_NS / 1000000) % SAMPLE_MS == 0) {
+            take_sample(now_ms);
+        }
+    }
+
+    if (!m_failed) {
+        check_drift();
+    }
+
+    printf("\n  %llu UDP sockets opened, %llu rx / %llu tx packets, %llu TCP connects, %llu accepts\n",
+           static_cast<unsigned long long>(m_udp_opened), static_cast<unsigned long long>(m_rx_packets),
+           static_cast<unsigned long long>(m_tx_packets), static_cast<unsigned long long>(m_tcp_connects),
+           static_cast<unsigned long long>(m_tcp_accepted));
+    printf("  %u faults, %u server accepts, worst outage %u attempts, worst recovery %llu ms\n",
+           m_faults, m_server.accepted, m_worst_storm_attempts,
+           static_cast<unsigned long long>(m_worst_recovery_ms));
+
+    // Everything goes back to the pool on teardown
+    m_client->disconnect();
+    manager.CloseAllProxySockets();
+    for (auto& game : m_udp) game = GameSocket{};
+    for (auto& game : m_tcp_out) game = GameSocket{};
+    check_ports();
+    if (manager.GetActiveSocketCount() != 0 || g_metrics.proxy_queued_bytes.Load() != 0) {
+        fail("%zu sockets and %lld queued bytes left after CloseAll", manager.GetActiveSocketCount(),
+             static_cast<long long>(g_metrics.proxy_queued_bytes.Load()));
+    }
+
+    manager.SetSendCallback(nullptr);
+    manager.SetProxyConnectCallback(nullptr);
+    g_client = nullptr;
+    m_client.reset();
+    platform::VirtualClock::Disable();
+    return !m_failed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t minutes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 480;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    if (minutes == 0 || minutes > MAX_SAMPLES) {
+        printf("usage: %s [virtual_minutes 1..%zu] [seed]\n", argv[0], MAX_SAMPLES);
+        return 2;
+    }
+
+    printf("\n========================================\n");
+    printf("  Soak: %llu virtual minutes, seed %llu\n",
+           static_cast<unsigned long long>(minutes), static_cast<unsigned long long>(seed));
+    printf("========================================\n\n");
+
+    auto start = std::chrono::steady_clock::now();
+    auto* soak = new Soak(minutes, seed);
+    bool ok = soak->run();
+    delete soak;
+    auto seconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count() / 1000.0;
+
+    printf("\n========================================\n");
+    printf("  Soak %s in %.1f s\n", ok ? "PASSED" : "FAILED", seconds);
+    printf("========================================\n\n");
+    return ok ? 0 : 1;
+}
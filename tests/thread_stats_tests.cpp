@@ -0,0 +1,333 @@
+/**
+ * @file thread_stats_tests.cpp
+ * @brief Unit tests for per-thread CPU time and wakeup accounting
+ *
+ * @copyright Copyright (c) 2026 ryu_ldn_nx contributors
+ * @license GPL-2.0-or-later
+ *
+ * @section Test Categories
+ *
+ * ### Platform Tests
+ * Thread id and thread CPU clock.
+ *
+ * ### Registry Tests
+ * Registration, table full, wakeups, sampling interval.
+ *
+ * ### Role Tests
+ * Totals across threads, exited threads kept, busy vs idle role.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "diagnostics/thread_stats.hpp"
+
+using namespace ryu_ldn::diagnostics;
+namespace platform = ryu_ldn::platform;
+
+// ============================================================================
+// Test Framework (Minimal)
+// ============================================================================
+
+static int g_tests_passed = 0;
+static int g_tests_failed = 0;
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("    FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            return false; \
+        } \
+    } while(0)
+
+#define ASSERT_FALSE(cond) ASSERT_TRUE(!(cond))
+
+#define ASSERT_EQ(a, b) \
+    do { \
+        auto _a = static_cast<long long>(a); \
+        auto _b = static_cast<long long>(b); \
+        if (_a != _b) { \
+            printf("    FAIL: %s:%d: %s == %s (%lld != %lld)\n", \
+                   __FILE__, __LINE__, #a, #b, _a, _b); \
+            return false; \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("  [TEST] %s... ", #test_func); \
+        fflush(stdout); \
+        if (test_func()) { \
+            printf("PASS\n"); \
+            g_tests_passed++; \
+        } else { \
+            g_tests_failed++; \
+        } \
+    } while(0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+
+/**
+ * @brief Spin on the CPU for about duration_ms of thread CPU time
+ */
+void Burn(uint64_t duration_ms) {
+    const uint64_t end_ns = platform::GetThreadCpuNs() + duration_ms * 1000000ULL;
+    volatile uint64_t sink = 0;
+    while (platform::GetThreadCpuNs() < end_ns) {
+        for (int i = 0; i < 1000; i++) {
+            sink = sink + static_cast<uint64_t>(i);
+        }
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Platform Tests
+// ============================================================================
+
+bool test_thread_id_distinct() {
+    const uint64_t main_id = platform::GetCurrentThreadId();
+    uint64_t other_id = 0;
+    std::thread other([&] { other_id = platform::GetCurrentThreadId(); });
+    other.join();
+
+    ASSERT_TRUE(main_id != 0);
+    ASSERT_TRUE(other_id != 0);
+    ASSERT_TRUE(main_id != other_id);
+    ASSERT_EQ(platform::GetCurrentThreadId(), main_id);
+    return true;
+}
+
+bool test_thread_cpu_clock() {
+    const uint64_t before = platform::GetThreadCpuNs();
+    Burn(20);
+    const uint64_t busy = platform::GetThreadCpuNs() - before;
+
+    // Sleeping costs no CPU time
+    const uint64_t sleep_start = platform::GetThreadCpuNs();
+    platform::SleepMs(50);
+    const uint64_t idle = platform::GetThreadCpuNs() - sleep_start;
+
+    ASSERT_TRUE(busy >= 20000000ULL);
+    ASSERT_TRUE(idle < 10000000ULL);
+    return true;
+}
+
+// ============================================================================
+// Registry Tests
+// ============================================================================
+
+bool test_register_and_unregister() {
+    ThreadRegistry registry;
+    ASSERT_EQ(registry.size(), 0);
+
+    ASSERT_TRUE(registry.register_current(ThreadRole::LdnBackground));
+    ASSERT_FALSE(registry.register_current(ThreadRole::LdnBackground));
+    ASSERT_FALSE(registry.register_current(ThreadRole::Count));
+    ASSERT_EQ(registry.size(), 1);
+    ASSERT_EQ(registry.role_stats(ThreadRole::LdnBackground).threads, 1);
+
+    registry.unregister_current();
+    ASSERT_EQ(registry.size(), 0);
+    ASSERT_EQ(registry.role_stats(ThreadRole::LdnBackground).threads, 0);
+
+    // Unregistering twice is harmless
+    registry.unregister_current();
+    return true;
+}
+
+bool test_unregistered_wakeup_ignored() {
+    ThreadRegistry registry;
+    registry.wakeup();
+    registry.sample_current();
+
+    ThreadRoleStats stats = registry.role_stats(ThreadRole::MitmIpc);
+    ASSERT_EQ(stats.wakeups, 0);
+    ASSERT_EQ(stats.threads, 0);
+    ASSERT_EQ(registry.role_stats(ThreadRole::Count).threads, 0);
+    return true;
+}
+
+bool test_table_full() {
+    ThreadRegistry registry;
+    std::atomic<int> registered{0};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < THREAD_REGISTRY_SLOTS; i++) {
+        threads.emplace_back([&] {
+            ScopedThreadAccount account(ThreadRole::P2pSession, registry);
+            registered++;
+            while (!release.load()) {
+                platform::SleepMs(1);
+            }
+        });
+    }
+    while (registered.load() < static_cast<int>(THREAD_REGISTRY_SLOTS)) {
+        platform::SleepMs(1);
+    }
+
+    ASSERT_EQ(registry.size(), THREAD_REGISTRY_SLOTS);
+    bool extra = registry.register_current(ThreadRole::MitmIpc);
+
+    release = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_FALSE(extra);
+    ASSERT_EQ(registry.size(), 0);
+    return true;
+}
+
+bool test_wakeups_counted() {
+    ThreadRegistry registry;
+    ASSERT_TRUE(registry.register_current(ThreadRole::ConfigServer));
+    for (int i = 0; i < 100; i++) {
+        registry.wakeup();
+    }
+    ASSERT_EQ(registry.role_stats(ThreadRole::ConfigServer).wakeups, 100);
+    ASSERT_EQ(registry.role_stats(ThreadRole::MitmIpc).wakeups, 0);
+    registry.unregister_current();
+    return true;
+}
+
+bool test_sample_interval() {
+    // One hour interval: wakeups never sample, only explicit samples do
+    ThreadRegistry registry(3600ULL * 1000000000ULL);
+    ASSERT_TRUE(registry.register_current(ThreadRole::LinkTest));
+    const uint64_t registered_cpu = registry.role_stats(ThreadRole::LinkTest).cpu_ns;
+
+    Burn(10);
+    registry.wakeup();
+    ASSERT_EQ(registry.role_stats(ThreadRole::LinkTest).cpu_ns, registered_cpu);
+
+    registry.sample_current();
+    ASSERT_TRUE(registry.role_stats(ThreadRole::LinkTest).cpu_ns >= registered_cpu + 10000000ULL);
+    registry.unregister_current();
+
+    // Zero interval: every wakeup samples
+    ThreadRegistry eager(0);
+    ASSERT_TRUE(eager.register_current(ThreadRole::LinkTest));
+    const uint64_t start_cpu = eager.role_stats(ThreadRole::LinkTest).cpu_ns;
+    Burn(10);
+    eager.wakeup();
+    ASSERT_TRUE(eager.role_stats(ThreadRole::LinkTest).cpu_ns >= start_cpu + 10000000ULL);
+    eager.unregister_current();
+    return true;
+}
+
+// ============================================================================
+// Role Tests
+// ============================================================================
+
+bool test_exited_threads_kept() {
+    ThreadRegistry registry(0);
+
+    for (int session = 0; session < 3; session++) {
+        std::thread thread([&] {
+            ScopedThreadAccount account(ThreadRole::P2pSession, registry);
+            for (int i = 0; i < 10; i++) {
+                registry.wakeup();
+            }
+            Burn(5);
+        });
+        thread.join();
+    }
+
+    ThreadRoleStats stats = registry.role_stats(ThreadRole::P2pSession);
+    ASSERT_EQ(stats.threads, 0);
+    ASSERT_EQ(stats.wakeups, 30);
+    // The last sample is taken on exit, so the burn after the wakeups counts
+    ASSERT_TRUE(stats.cpu_ns >= 15000000ULL);
+    return true;
+}
+
+bool test_busy_and_idle_roles() {
+    ThreadRegistry registry(0);
+    std::atomic<bool> stop{false};
+
+    // A poll loop that never sleeps, and a thread that sleeps 10 ms per wakeup
+    std::thread busy([&] {
+        ScopedThreadAccount account(ThreadRole::LdnBackground, registry);
+        while (!stop.load()) {
+            Burn(1);
+            registry.wakeup();
+        }
+    });
+    std::thread idle([&] {
+        ScopedThreadAccount account(ThreadRole::LogMaintenance, registry);
+        while (!stop.load()) {
+            platform::SleepMs(10);
+            registry.wakeup();
+        }
+    });
+
+    platform::SleepMs(200);
+    ThreadRoleStats busy_live = registry.role_stats(ThreadRole::LdnBackground);
+    ThreadRoleStats idle_live = registry.role_stats(ThreadRole::LogMaintenance);
+    stop = true;
+    busy.join();
+    idle.join();
+
+    printf("\n    busy: %llu us / %llu wakeups, idle: %llu us / %llu wakeups... ",
+           static_cast<unsigned long long>(busy_live.cpu_ns / 1000),
+           static_cast<unsigned long long>(busy_live.wakeups),
+           static_cast<unsigned long long>(idle_live.cpu_ns / 1000),
+           static_cast<unsigned long long>(idle_live.wakeups));
+
+    ASSERT_EQ(busy_live.threads, 1);
+    ASSERT_EQ(idle_live.threads, 1);
+    ASSERT_TRUE(busy_live.cpu_ns > 10 * idle_live.cpu_ns);
+    ASSERT_TRUE(busy_live.wakeups > idle_live.wakeups);
+    ASSERT_TRUE(idle_live.wakeups >= 5);
+    return true;
+}
+
+bool test_role_names() {
+    ASSERT_TRUE(thread_role_to_string(ThreadRole::MitmIpc)[0] == 'M');
+    ASSERT_TRUE(thread_role_to_string(ThreadRole::LinkTest)[0] == 'L');
+    ASSERT_TRUE(thread_role_to_string(ThreadRole::Count)[0] == 'I');
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    printf("\n========================================\n");
+    printf("  Thread Stats Tests - ryu_ldn_nx\n");
+    printf("========================================\n\n");
+
+    printf("Platform Tests:\n");
+    RUN_TEST(test_thread_id_distinct);
+    RUN_TEST(test_thread_cpu_clock);
+
+    printf("\nRegistry Tests:\n");
+    RUN_TEST(test_register_and_unregister);
+    RUN_TEST(test_unregistered_wakeup_ignored);
+    RUN_TEST(test_table_full);
+    RUN_TEST(test_wakeups_counted);
+    RUN_TEST(test_sample_interval);
+
+    printf("\nRole Tests:\n");
+    RUN_TEST(test_exited_threads_kept);
+    RUN_TEST(test_busy_and_idle_roles);
+    RUN_TEST(test_role_names);
+
+    // Summary
+    printf("\n========================================\n");
+    printf("  Results: %d/%d passed\n",
+           g_tests_passed, g_tests_passed + g_tests_failed);
+    printf("========================================\n\n");
+
+    return g_tests_failed > 0 ? 1 : 0;
+}